@@ -29,8 +29,20 @@ cbuffer BloomParameters : register(b4)
 
   float bloom_sigma;
   float bloom_treshold;
+
+  float histogram_min_log;
+  float histogram_max_log;
+  float histogram_low;
+  float histogram_high;
+
+  // Texels of the HISTOGRAM_LEVEL mip inside the rendered viewport
+  float2 histogram_size;
 }
 
+// LUMINANCE_HISTOGRAM_BINS and LUMINANCE_HISTOGRAM_LEVEL on the CPU side, LuminanceHistogram is the reference
+#define HISTOGRAM_BINS 64
+#define HISTOGRAM_LEVEL 1
+
 float average_luminance()
 {
     return rt_pp_one.Load(uint3(0,0,0)).x;
@@ -59,72 +71,135 @@ float3 tone_map(in float4 color, in float average_lum, in float threshold, out f
 
 
 
-float ps_adapt_exposure(in PS_INPUT inp) : SV_Target
+uint histogram_bin(in float lum)
 {
-    //get medium brightness of scene
-	float curr_lum = luminance(rt_output.SampleLevel(StandardFilter, float2(0.5, 0.5), 10).rgb);
-    float last_lum = rt_pp_one.Load(uint3(0, 0, 0)).x;
+    float t = saturate((log2(max(lum, 0.00001f)) - histogram_min_log) / (histogram_max_log - histogram_min_log));
+    return min(uint(t * HISTOGRAM_BINS), HISTOGRAM_BINS - 1);
+}
 
-    float v = last_lum + (curr_lum - last_lum) * (1 - exp(-time_delta * exposure_speed));
-    return v;
+float histogram_bin_log_luminance(in uint bin)
+{
+    return histogram_min_log + (bin + 0.5f) / HISTOGRAM_BINS * (histogram_max_log - histogram_min_log);
 }
 
-float4 ps_bloom_treshold(in PS_INPUT inp) : SV_TARGET
+struct VS_HISTOGRAM_OUTPUT
 {
-    float4 color = rt_output.Sample(StandardFilter, inp.tex_coord);
+    float4 pos : SV_POSITION;
+};
 
-    float avg_lum = average_luminance();
-    float exposure = 0;
-    color.rgb = calc_exposed_color(color.rgb, avg_lum, bloom_treshold, exposure);
+// One point per texel of the pyramid level inside the viewport, drawn into its bin of a HISTOGRAM_BINS x 1 target with additive blending
+VS_HISTOGRAM_OUTPUT vs_luminance_histogram(in uint id : SV_VertexID)
+{
+    VS_HISTOGRAM_OUTPUT output;
 
-    if (dot(color.rgb, 0.333f) <= 0.01f)
-        color = 0.f;
+    uint x = id % uint(histogram_size.x);
+    uint y = id / uint(histogram_size.x);
+    float lum = luminance(rt_output.Load(uint3(x, y, HISTOGRAM_LEVEL)).rgb);
 
-    return float4(color.rgb, 1);
+    uint bin = histogram_bin(lum);
+    output.pos = float4((bin + 0.5f) / HISTOGRAM_BINS * 2.0f - 1.0f, 0.0f, 0.0f, 1.0f);
+
+    return output;
 }
 
-float4 ps_bloom(in PS_INPUT inp) : SV_TARGET
+float ps_luminance_histogram(in VS_HISTOGRAM_OUTPUT inp) : SV_Target
 {
-    float4 color = rt_output.SampleLevel(StandardFilter, inp.tex_coord, 0);
-    float avg_lum = average_luminance();
+    return 1.0f;
+}
 
-    float exposure = 0;
-    color.rgb = tone_map(color.rgba, avg_lum, 0, exposure);
+// Geometric mean of the histogram between the two percentiles, then eased towards it from the last value
+float ps_adapt_exposure(in PS_INPUT inp) : SV_Target
+{
+    float last_lum = rt_pp_one.Load(uint3(0, 0, 0)).x;
 
-    float4 bloom = rt_pp_two.Sample(ShadowFilter, inp.tex_coord);
+    float total = 0;
+    for (uint i = 0; i < HISTOGRAM_BINS; ++i)
+        total += rt_output.Load(uint3(i, 0, 0)).x;
 
-    return float4((color + bloom).rgb, color.a);
+    float low = total * histogram_low;
+    float high = total * histogram_high;
+
+    // Walk up from the dark end, each bin counts with the part of it between the two percentiles
+    float seen = 0;
+    float sum = 0;
+    float weight = 0;
+    for (uint b = 0; b < HISTOGRAM_BINS; ++b)
+    {
+        float count = rt_output.Load(uint3(b, 0, 0)).x;
+        float w = max(min(seen + count, high) - max(seen, low), 0);
+        seen += count;
+
+        sum += w * histogram_bin_log_luminance(b);
+        weight += w;
+    }
+
+    if (weight <= 0)
+        return last_lum;
+
+    float curr_lum = exp2(sum / weight);
+    float v = last_lum + (curr_lum - last_lum) * (1 - exp(-time_delta * exposure_speed));
+    return v;
 }
 
-float4 gauss(in PS_INPUT input, in float2 tex_scale, in float sigma)
+// Dual filter downsample, the center and the four diagonal taps one source texel away.
+// Bilinear taps, so each pixel gathers a 4x4 area of the level above with weights falling off outwards.
+float4 dual_downsample(in Texture2D tex, in float2 uv, in uint lod)
 {
-    float4 color = 0;
+    float w, h, levels;
+    tex.GetDimensions(lod, w, h, levels);
+    float2 texel = 1.0 / float2(w, h);
 
-	float w,h;
-	rt_output.GetDimensions(w,h);
+    float4 sum = tex.SampleLevel(StandardFilter, uv, lod) * 4.0;
+    sum += tex.SampleLevel(StandardFilter, uv - texel, lod);
+    sum += tex.SampleLevel(StandardFilter, uv + texel, lod);
+    sum += tex.SampleLevel(StandardFilter, uv + float2(texel.x, -texel.y), lod);
+    sum += tex.SampleLevel(StandardFilter, uv - float2(texel.x, -texel.y), lod);
 
-    for (int i = -6; i < 6; i++)
-    {
-		float weight = gauss_weight(i, sigma);
+    return sum / 8.0;
+}
+
+// Dual filter upsample, a tent of eight taps half a texel of the smaller level apart
+float4 dual_upsample(in Texture2D tex, in float2 uv)
+{
+    float w, h;
+    tex.GetDimensions(w, h);
+    float2 offset = 0.5 / float2(w, h);
+
+    float4 sum = tex.SampleLevel(StandardFilter, uv + float2(-offset.x * 2.0, 0.0), 0);
+    sum += tex.SampleLevel(StandardFilter, uv + float2(-offset.x, offset.y), 0) * 2.0;
+    sum += tex.SampleLevel(StandardFilter, uv + float2(0.0, offset.y * 2.0), 0);
+    sum += tex.SampleLevel(StandardFilter, uv + float2(offset.x, offset.y), 0) * 2.0;
+    sum += tex.SampleLevel(StandardFilter, uv + float2(offset.x * 2.0, 0.0), 0);
+    sum += tex.SampleLevel(StandardFilter, uv + float2(offset.x, -offset.y), 0) * 2.0;
+    sum += tex.SampleLevel(StandardFilter, uv + float2(0.0, -offset.y * 2.0), 0);
+    sum += tex.SampleLevel(StandardFilter, uv + float2(-offset.x, -offset.y), 0) * 2.0;
+
+    return sum / 12.0;
+}
 
-        // compute tap tc
-        float2 tc = input.tex_coord;
-		tc += (i / float2(w,h)) * tex_scale;
+// First level of the bloom chain at half resolution. The scene pyramid already has that size as its
+// first mip so the full resolution image is never read, only what passes the threshold goes on.
+float4 ps_bloom_prefilter(in PS_INPUT inp) : SV_TARGET
+{
+    float4 color = dual_downsample(rt_output, inp.tex_coord, 1);
 
-        // fetch tap
-		float4 tap = rt_output.Sample(ShadowFilter, tc);
-		color += tap * weight;
-    }
+    float avg_lum = average_luminance();
+    float exposure = 0;
+    color.rgb = calc_exposed_color(color.rgb, avg_lum, bloom_treshold, exposure);
 
-    return color;
+    if (dot(color.rgb, 0.333f) <= 0.01f)
+        color = 0.f;
+
+    return float4(color.rgb, 1);
 }
 
-float4 ps_gauss_bloom_h(in PS_INPUT inp) : SV_TARGET
+float4 ps_bloom_downsample(in PS_INPUT inp) : SV_TARGET
 {
-    return gauss(inp, float2(0, 1), bloom_sigma);
+    return dual_downsample(rt_output, inp.tex_coord, 0);
 }
 
-float4 ps_gauss_bloom_v(in PS_INPUT inp) : SV_TARGET
+// The level below brought up, plus the downsampled level of this size in rt_pp_two
+float4 ps_bloom_upsample(in PS_INPUT inp) : SV_TARGET
 {
-    return gauss(inp, float2(1, 0), bloom_sigma);
+    return dual_upsample(rt_output, inp.tex_coord) + rt_pp_two.SampleLevel(StandardFilter, inp.tex_coord, 0);
 }
@@ -102,7 +102,6 @@ PS_LPV_PROPAGATE LPVPropagatePs(in GS_LPV_PROPAGATE input)
     float4 new_sh_g = float4(0,0,0,0);
     float4 new_sh_b = float4(0,0,0,0);
 
-    // add own contribution
     float4 ppos = float4(lpv_pos, 0);
 
     // add adjecant contribution
@@ -153,6 +152,9 @@ PS_LPV_PROPAGATE LPVPropagatePs(in GS_LPV_PROPAGATE input)
         }
     }
 
+    // add own contribution
+    ppos = float4(lpv_pos, 0);
+
     if (iteration == 0)
     {
         new_sh_r += (lpv_sh_r.Load(ppos)) * famp;
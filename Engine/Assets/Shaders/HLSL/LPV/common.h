@@ -53,6 +53,7 @@
 #define USE_LPV
 #define GAMMA                           2.2
 #define SHADOW_BIAS                     0.015
+#define CASCADE_BIAS                    0.002
 #define LPV_SIZE                        32
 #define M_PI                            3.14159265358
 #define PCF_SAMPLES                     64
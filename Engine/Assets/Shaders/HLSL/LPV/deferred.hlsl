@@ -34,6 +34,16 @@ cbuffer light_ps                    : register(b2)
     float4x4 light_vp_tex			: packoffset(c11);
 }
 
+// Filled by ShadowCascades on the CPU, world space to each cascade's texture space
+cbuffer cascades_ps                 : register(b5)
+{
+    float4x4 cascade_vp_tex0		: packoffset(c0);
+    float4x4 cascade_vp_tex1		: packoffset(c4);
+    float4x4 cascade_vp_tex2		: packoffset(c8);
+    float4x4 cascade_vp_tex3		: packoffset(c12);
+    float num_cascades				: packoffset(c16);
+}
+
 cbuffer onetime_ps                  : register(b6)
 {
 	float4 scene_dim_max			: packoffset(c0);
@@ -45,11 +55,41 @@ Texture2D rt_specular				: register(t3);
 Texture2D rt_normals				: register(t4);
 Texture2D rt_lineardepth			: register(t5);
 Texture2D rt_rsm_lineardepth		: register(t6);
+Texture2D rt_cascades				: register(t10);
 
 Texture3D<float> noise_tex			: register(t14);
 
+// Cascades sit in a 2x2 atlas, the first one that covers the point wins
+float cascade_attenuation(in float3 pos, in float min_s, in float min_o)
+{
+    float4x4 cascade_vp_tex[4] = { cascade_vp_tex0, cascade_vp_tex1, cascade_vp_tex2, cascade_vp_tex3 };
+
+    // Half a texel in, so the filter never reads the neighbouring cascade
+    float2 atlas_size;
+    rt_cascades.GetDimensions(atlas_size.x, atlas_size.y);
+    float border = 1.0 / atlas_size.x;
+
+    for (uint i = 0; i < (uint)num_cascades; ++i)
+    {
+        float3 tc = mul(cascade_vp_tex[i], float4(pos, 1)).xyz;
+
+        if (any(tc.xy < border) || any(tc.xy > 1.0 - border) || tc.z > 1.0)
+            continue;
+
+        float2 atlas_tc = (tc.xy + float2(i % 2, i / 2)) * 0.5;
+        float z = tc.z - CASCADE_BIAS;
+
+        return min(1.0, vsm(atlas_tc, z, rt_cascades, ShadowFilter) + min_s);
+    }
+
+    return min_o;
+}
+
 float shadow_attenuation(in float3 pos, in float3 Ll, in Texture2D linear_shadowmap, in float min_s = 0.0, in float min_o = 0.0)
 {
+    if (num_cascades > 0)
+        return cascade_attenuation(pos, min_s, min_o);
+
     float4 tct = mul(light_vp_tex, float4(pos, 1));
     float2 tc = tct.xy/tct.w;
 
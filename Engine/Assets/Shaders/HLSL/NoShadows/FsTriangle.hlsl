@@ -16,7 +16,7 @@ cbuffer camera_vs : register(b0)
     float4x4 vp         : packoffset(c0);
     float4x4 vp_inv     : packoffset(c4);
     float3 camera_pos   : packoffset(c8);
-    float pad0          : packoffset(c8.w);
+    float resolution_scale : packoffset(c8.w);
 }
 
 // Note: could do way easier with SV_VertexID, but stupid HLSL debugger won't have it
@@ -26,8 +26,11 @@ PS_INPUT fs_triangle_vs(in float3 pos : POSITION)
 
     float4 position = float4(pos, 1.f);
 
+	// Unset scale means full resolution
+	float scale = resolution_scale > 0.f ? resolution_scale : 1.f;
+
 	outp.position  = position;
-	outp.tex_coord = position.xy * float2(0.5, -0.5) + 0.5;
+	outp.tex_coord = (position.xy * float2(0.5, -0.5) + 0.5) * scale;
     outp.view_ray  = mul(vp_inv, position).xyz;
 
 	return outp;
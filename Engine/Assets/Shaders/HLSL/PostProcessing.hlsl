@@ -36,7 +36,8 @@ cbuffer per_frame_ps : register(b5)
 {
 	float time                      : packoffset(c0.x);
     float time_delta                : packoffset(c0.y);
-    float2 pad0                     : packoffset(c0.z);
+    float frame_index               : packoffset(c0.z);
+    float pad0                      : packoffset(c0.w);
 }
 
 cbuffer light_ps : register(b2)
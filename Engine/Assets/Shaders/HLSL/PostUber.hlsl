@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : PostUber.hlsl
+// Date : <Date>
+// Comments : Every per pixel effect after the bloom chain in one pass, each behind its define
+//	UBER_DOF      - out of focus pixels read the scene pyramid in rt_blurred
+//	UBER_BLOOM    - the top of the bloom chain in rt_pp_two
+//	UBER_VIGNETTE - darkens towards the corners
+//	UBER_GRADING  - saturation, contrast and tint after the tonemapping
+//
+//----------------------------------------------------------------------------
+#include "Bloom.hlsl"
+
+// Mips of the pyramid the blur reaches at most, past this it is blocky
+#define DOF_MAX_LEVEL 5
+
+cbuffer UberParameters : register(b7)
+{
+  float bloom_intensity;
+  float vignette_intensity;
+  float vignette_power;
+  float grading_saturation;
+  float grading_contrast;
+  float dof_focal_plane;
+  float dof_coc_scale;
+  float dof_focal_range;
+  float4 grading_tint;
+}
+
+float4 ps_post_uber(in PS_INPUT inp) : SV_TARGET
+{
+    float4 color = rt_output.SampleLevel(StandardFilter, inp.tex_coord, 0);
+
+#ifdef UBER_DOF
+    float depth = rt_lineardepth.SampleLevel(StandardFilter, inp.tex_coord, 0).x;
+    // Sharp on the focal plane, fully blurred dof_focal_range away from it on either side
+    float coc = saturate(abs(depth - dof_focal_plane) / dof_focal_range) * dof_coc_scale;
+
+    // Level 0 of the pyramid is the frame itself, the blur grows a mip at a time.
+    // A scale above 1 reaches the full blur before the focal range, it never goes past it
+    float w, h, levels;
+    rt_blurred.GetDimensions(0, w, h, levels);
+    float level = saturate(coc) * min(levels - 1, DOF_MAX_LEVEL);
+    color.rgb = lerp(color.rgb, rt_blurred.SampleLevel(StandardFilter, inp.tex_coord, level).rgb, saturate(coc));
+#endif
+
+    float exposure = 0;
+    color.rgb = tone_map(color, average_luminance(), 0, exposure);
+
+#ifdef UBER_BLOOM
+    color.rgb += dual_upsample(rt_pp_two, inp.tex_coord).rgb * bloom_intensity;
+#endif
+
+#ifdef UBER_VIGNETTE
+    float2 d = inp.tex_coord - 0.5;
+    color.rgb *= 1 - vignette_intensity * pow(saturate(dot(d, d) * 2), vignette_power);
+#endif
+
+#ifdef UBER_GRADING
+    float luma = luminance(color.rgb);
+    color.rgb = lerp(luma.xxx, color.rgb, grading_saturation);
+    color.rgb = (color.rgb - 0.5) * grading_contrast + 0.5;
+    color.rgb = max(color.rgb * grading_tint.rgb, 0);
+#endif
+
+    return color;
+}
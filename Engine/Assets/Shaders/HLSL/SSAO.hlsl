@@ -19,7 +19,7 @@
 // Comments :
 //
 //----------------------------------------------------------------------------
-#include "PostProcessing.hlsl"
+#include "TemporalFilter.hlsl"
 
 cbuffer SsaoParameters : register(b4)
 {
@@ -43,14 +43,6 @@ cbuffer SsaoParameters : register(b4)
   bool debug_ao;
 }
 
-cbuffer camera_ps                   : register(b1)
-{
-    float4x4 vp						: packoffset(c0);
-    float4x4 vp_inv					: packoffset(c4);
-    float3 camera_pos				: packoffset(c8);
-    float z_far						: packoffset(c8.w);
-}
-
 Texture2D RandomVec : register(t5);
 
 
@@ -340,7 +332,9 @@ float4 ps_ssao(in PS_INPUT input) : SV_Target
       float3 dPdv = min_diff(P, Pt, Pb) * (g_Resolution.y * g_InvResolution.x);
 
       // (cos(alpha),sin(alpha),jitter)
-      float3 rand = RandomVec.Load(int3((int)input.position.x&63, (int)input.position.y&63, 0)).xyz;
+      // The tile moves every frame so the history averages different directions
+      int2 noise_offset = int2(uint(frame_index) * uint2(23, 41));
+      float3 rand = RandomVec.Load(int3(((int)input.position.x + noise_offset.x)&63, ((int)input.position.y + noise_offset.y)&63, 0)).xyz;
 
       float ao = 0;
       float d;
@@ -385,7 +379,9 @@ float4 ps_ssao(in PS_INPUT input) : SV_Target
 float4 ps_ssao_merge(in PS_INPUT input) : SV_Target
 {
   float4 finalBlurInput = rt_output.Sample(StandardFilter,input.tex_coord);
-  float occlusion = rt_blurred.Sample(StandardFilter, input.tex_coord);
+  // Computed at half resolution, brought up without bleeding across depth edges
+  float depth = rt_lineardepth.Load(int3(input.position.xy, 0)).r;
+  float occlusion = bilateral_upsample(rt_blurred, input.tex_coord, depth).r;
 
   if(debug_ao)
     return occlusion;
@@ -59,7 +59,7 @@ cbuffer cbSSLR : register(b4)
  float cb_numMips; // the number of mip levels in the convolved color buffer
  float cb_fadeStart; // determines where to start screen edge fading of effect
  float cb_fadeEnd; // determines where to end screen edge fading of effect
- float cb_sslr_padding0; // padding for alignment
+ float frame_index; // frame counter, alternates the stride jitter so the history averages both
 
  float4x4 viewToTextureSpaceMatrix;
 };
@@ -211,7 +211,7 @@ bool traceScreenSpaceRay(
 
 float4 ps_sslr_raytrace(in PS_INPUT inp) : SV_TARGET
 {
- int3 loadIndices = int3(inp.position.xy, 0);
+ int3 loadIndices = GBUFFER_TEXEL(inp.position.xy);
  float3 normalVS = rt_normals.Load(loadIndices).xyz;
  if(!any(normalVS))
  {
@@ -236,7 +236,7 @@ float4 ps_sslr_raytrace(in PS_INPUT inp) : SV_TARGET
  float2 hitPixel = float2(0.0f, 0.0f);
  float3 hitPoint = float3(0.0f, 0.0f, 0.0f);
 
- float jitter = cb_stride > 1.0f ? float(int(inp.position.x + inp.position.y) & 1) * 0.5f : 0.0f;
+ float jitter = cb_stride > 1.0f ? float((int(inp.position.x + inp.position.y) + int(frame_index)) & 1) * 0.5f : 0.0f;
 
  // perform ray tracing - true if hit found, false otherwise
  bool intersection = traceScreenSpaceRay(rayOriginVS, rayDirectionVS, jitter, hitPixel, hitPoint);
@@ -62,7 +62,7 @@ cbuffer cbSSLR : register(b4)
  float cb_numMips; // the number of mip levels in the convolved color buffer
  float cb_fadeStart; // determines where to start screen edge fading of effect
  float cb_fadeEnd; // determines where to end screen edge fading of effect
- float cb_sslr_padding0; // padding for alignment
+ float frame_index; // frame counter, alternates the stride jitter so the history averages both
 
  float4x4 viewToTextureSpaceMatrix;
 };
@@ -115,7 +115,7 @@ float isoscelesTriangleNextAdjacent(float adjacentLength, float incircleRadius)
 
 float3 viewSpacePositionFromDepth(in PS_INPUT inp)
 {
-  int3 loadIndices = int3(inp.position.xy, 0);
+  int3 loadIndices = GBUFFER_TEXEL(inp.position.xy);
   float depth = rt_lineardepth.Load(loadIndices).r;
   float3 rayOriginVS = inp.view_ray * (depth);
 
@@ -124,9 +124,9 @@ float3 viewSpacePositionFromDepth(in PS_INPUT inp)
 
 float4 ps_sslr(in PS_INPUT inp) : SV_TARGET
 {
- int3 loadIndices = int3(inp.position.xy, 0);
- // get screen-space ray intersection point
- float4 raySS = rayTracingBuffer.Load(loadIndices).xyzw;
+ int3 loadIndices = GBUFFER_TEXEL(inp.position.xy);
+ // get screen-space ray intersection point, traced at the resolution of this pass
+ float4 raySS = rayTracingBuffer.Load(int3(inp.position.xy, 0)).xyzw;
  //float3 fallbackColor = indirectSpecularBuffer.Load(loadIndices).rgb;
  float3 fallbackColor = float3(0.04,0.04,0.04);
  if(raySS.w <= 0.0f) // either means no hit or the ray faces back towards the camera
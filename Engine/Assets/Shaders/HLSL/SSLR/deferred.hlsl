@@ -48,6 +48,13 @@ Texture2D rt_rsm_lineardepth		: register(t6);
 
 Texture3D<float> noise_tex			: register(t14);
 
+// HALF_RES traces and resolves at half resolution, the G-Buffer stays full size
+#ifdef HALF_RES
+#define GBUFFER_TEXEL(p) int3(int2(p) * 2, 0)
+#else
+#define GBUFFER_TEXEL(p) int3(p, 0)
+#endif
+
 float shadow_attenuation(in float3 pos, in float3 Ll, in Texture2D linear_shadowmap, in float min_s = 0.0, in float min_o = 0.0)
 {
     float4 tct = mul(light_vp_tex, float4(pos, 1));
@@ -0,0 +1,72 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : ShadowCascade.hlsl
+// Date : <Date>
+// Comments : One cascade of the directional light, moments of the orthographic depth
+//
+//----------------------------------------------------------------------------
+struct VS_MESH_INPUT
+{
+    float3 pos                  : POSITION;
+    float3 norm                 : NORMAL;
+	float2 texcoord 	        : TEXCOORD0;
+	float3 tangent		        : TANGENT;
+};
+
+struct VS_CASCADE_OUTPUT
+{
+    float4 pos			        : SV_POSITION;
+    float depth                 : TEXCOORD0;
+};
+
+cbuffer camera_vs               : register(b0)
+{
+    float4x4 vp                 : packoffset(c0);
+    float4x4 vp_inv             : packoffset(c4);
+    float3 camera_pos           : packoffset(c8);
+    float resolution_scale      : packoffset(c8.w);
+}
+
+cbuffer meshdata_vs             : register(b1)
+{
+    float4x4 world              : packoffset(c0);
+}
+
+VS_CASCADE_OUTPUT CascadeVs(in VS_MESH_INPUT input)
+{
+	VS_CASCADE_OUTPUT output;
+
+    float4 pos_world = mul(world, float4(input.pos, 1.0));
+
+    output.pos = mul(vp, pos_world);
+    //Orthographic, w is 1 and z is already linear
+    output.depth = output.pos.z;
+
+	return output;
+}
+
+float2 CascadePs(in VS_CASCADE_OUTPUT input) : SV_Target0
+{
+    float z = saturate(input.depth);
+    return float2(z, z * z);
+}
+
+//Fills a cascade with the far plane before its casters are drawn
+float2 CascadeClearPs(in float4 pos : SV_POSITION) : SV_Target0
+{
+    return float2(1, 1);
+}
@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : TemporalFilter.hlsl
+// Date : <Date>
+// Comments : Half resolution depth, history accumulation and the depth aware upsample.
+//	TemporalFilter on the CPU side is the reference for the math here.
+//
+//----------------------------------------------------------------------------
+#ifndef TEMPORAL_FILTER_HLSL_
+#define TEMPORAL_FILTER_HLSL_
+
+#include "PostProcessing.hlsl"
+
+cbuffer camera_ps                   : register(b1)
+{
+    float4x4 vp						: packoffset(c0);
+    float4x4 vp_inv					: packoffset(c4);
+    float3 camera_pos				: packoffset(c8);
+    float z_far						: packoffset(c8.w);
+}
+
+cbuffer TemporalParameters : register(b7)
+{
+  float4x4 prev_vp;
+  float3 prev_camera_pos;
+  float temporal_max_history;
+  float temporal_depth_tolerance;
+  // Dynamic resolution of last frame and this one, the history only covers the scaled part of its target
+  float prev_resolution_scale;
+  float current_resolution_scale;
+  float pad_temporal;
+}
+
+// Depth the half resolution effect was computed with
+Texture2D rt_half_depth                : register(t10);
+// Last frame's accumulated result, the history length in alpha
+Texture2D rt_history                   : register(t11);
+Texture2D rt_history_depth             : register(t12);
+
+float2 reproject(in float3 position)
+{
+    float4 clip = mul(prev_vp, float4(position, 1.0f));
+
+    // Behind last frame's camera, there is nothing to reuse
+    if (clip.w <= 0.000001f)
+        return float2(-1.0f, -1.0f);
+
+    return clip.xy / clip.w * float2(0.5f, -0.5f) + 0.5f;
+}
+
+float depth_weight(in float sample_depth, in float depth)
+{
+    return saturate(1.0f - abs(sample_depth - depth) / (temporal_depth_tolerance * max(depth, 0.000001f)));
+}
+
+// Unset scale means full resolution
+float scale_or_one(in float scale)
+{
+    return scale > 0.0f ? scale : 1.0f;
+}
+
+// prev_uv is already scaled to the part of the history target last frame wrote to
+float history_length(in float2 prev_uv, in float expected_depth, in float prev_depth, in float prev_length)
+{
+    float prev_scale = scale_or_one(prev_resolution_scale);
+
+    // The history texels cover other pixels at another scale, start over
+    if (prev_scale != scale_or_one(current_resolution_scale))
+        return 1.0f;
+
+    if (any(prev_uv < 0.0f) || any(prev_uv > prev_scale))
+        return 1.0f;
+
+    // Something else was there, a disocclusion
+    if (depth_weight(prev_depth, expected_depth) <= 0.0f)
+        return 1.0f;
+
+    return min(prev_length + 1.0f, temporal_max_history);
+}
+
+// The 2x2 texels of the low resolution target around uv, bilinear weights scaled by how close their
+// depth is to the full resolution pixel. When none is close the one closest in depth takes it all.
+float4 bilateral_upsample(in Texture2D tex, in float2 uv, in float depth)
+{
+    float w, h;
+    rt_half_depth.GetDimensions(w, h);
+
+    float2 pos = uv * float2(w, h) - 0.5f;
+    int2 base = int2(floor(pos));
+    float2 f = pos - base;
+
+    const int2 offsets[4] = { int2(0, 0), int2(1, 0), int2(0, 1), int2(1, 1) };
+    float bilinear[4] = { (1 - f.x) * (1 - f.y), f.x * (1 - f.y), (1 - f.x) * f.y, f.x * f.y };
+
+    float4 sum = 0;
+    float total = 0;
+    int closest = 0;
+    float closest_diff = 1e30f;
+    float4 texels[4];
+
+    [unroll]
+    for (int i = 0; i < 4; ++i)
+    {
+        int3 texel = int3(clamp(base + offsets[i], int2(0, 0), int2(w, h) - 1), 0);
+        float d = rt_half_depth.Load(texel).r;
+        texels[i] = tex.Load(texel);
+
+        float weight = bilinear[i] * depth_weight(d, depth);
+        sum += texels[i] * weight;
+        total += weight;
+
+        float diff = abs(d - depth);
+        if (diff < closest_diff)
+        {
+            closest = i;
+            closest_diff = diff;
+        }
+    }
+
+    if (total > 0.0001f)
+        return sum / total;
+
+    return texels[closest];
+}
+
+// Closest of the 2x2 full resolution depths, the half resolution effects see the nearest surface.
+// Without HALF_RES the effect runs at full size and this is a plain copy.
+float ps_downsample_depth(in PS_INPUT inp) : SV_Target
+{
+#ifdef HALF_RES
+    int2 pixel = int2(inp.position.xy) * 2;
+
+    float d0 = rt_lineardepth.Load(int3(pixel, 0)).r;
+    float d1 = rt_lineardepth.Load(int3(pixel + int2(1, 0), 0)).r;
+    float d2 = rt_lineardepth.Load(int3(pixel + int2(0, 1), 0)).r;
+    float d3 = rt_lineardepth.Load(int3(pixel + int2(1, 1), 0)).r;
+
+    return min(min(d0, d1), min(d2, d3));
+#else
+    return rt_lineardepth.Load(int3(inp.position.xy, 0)).r;
+#endif
+}
+
+// Blends this frame into the history at the same point last frame, each frame weighing the same
+float4 ps_temporal_accumulate(in PS_INPUT inp) : SV_Target
+{
+    int3 texel = int3(inp.position.xy, 0);
+    float4 current = rt_output.Load(texel);
+    float depth = rt_half_depth.Load(texel).r;
+
+    float3 position = camera_pos + normalize(inp.view_ray) * depth;
+    float2 prev_uv = reproject(position) * scale_or_one(prev_resolution_scale);
+
+    float4 history = rt_history.SampleLevel(StandardFilter, prev_uv, 0);
+    float prev_depth = rt_history_depth.SampleLevel(StandardFilter, prev_uv, 0).r;
+
+    float len = history_length(prev_uv, length(position - prev_camera_pos), prev_depth, history.a);
+
+    return float4(lerp(history.rgb, current.rgb, 1.0f / len), len);
+}
+
+// rt_output at half resolution brought to the full resolution depth in rt_lineardepth
+float4 ps_bilateral_upsample(in PS_INPUT inp) : SV_Target
+{
+    float depth = rt_lineardepth.Load(int3(inp.position.xy, 0)).r;
+
+    return float4(bilateral_upsample(rt_output, inp.tex_coord, depth).rgb, 1.0f);
+}
+
+#endif
@@ -81,7 +81,10 @@ float4 deferred_lpv_ps(PS_INPUT inp) : SV_Target
     float3 reflectionColor = 0;
     float3 incident = -toEye;
     float3 reflection = reflect(incident,N);
-    Rr = EnvMap.Sample(StandardFilter,reflection);
+    //The probe mips are blurrier the smaller they get, rough surfaces read further down
+    uint env_width, env_height, env_levels;
+    EnvMap.GetDimensions(0, env_width, env_height, env_levels);
+    Rr = EnvMap.SampleLevel(StandardFilter,reflection,roughness * (env_levels - 1));
   }
 
 	// brdf
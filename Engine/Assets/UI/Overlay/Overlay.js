@@ -51,6 +51,40 @@ var CameraPanel = React.createClass({
   }
 });
 
+var ProfilerPanel = React.createClass({
+  getInitialState: function() {
+    return { zones: [], gpu: [], gpuFrame: "0" };
+  },
+  componentWillMount: function() {
+    OverlayGlobal.setProfilerInfo = (data) => {
+      this.setState( { zones: data.Zones, gpu: data.Gpu, gpuFrame: data.GpuFrame });
+    };
+  },
+  render: function() {
+    var zoneRow = function(zone,i) {
+      return (
+        <tr key={i}>
+          <td style={{paddingLeft: (zone.Depth * 10) + "px"}}>{zone.Name}</td><td>{parseFloat(zone.Avg).toFixed(2)}</td><td>{parseFloat(zone.Min).toFixed(2)}</td><td>{parseFloat(zone.Max).toFixed(2)}</td>
+        </tr>
+      );
+    };
+    var rows = this.state.zones.map(zoneRow);
+    var gpuRows = this.state.gpu.map(zoneRow);
+    return (
+      <div className="profilerPanel">
+        <table>
+          <thead><tr><th>Zone</th><th>Avg</th><th>Min</th><th>Max</th></tr></thead>
+          <tbody>{rows}</tbody>
+        </table>
+        <table>
+          <thead><tr><th>GPU {parseFloat(this.state.gpuFrame).toFixed(2)}</th><th>Avg</th><th>Min</th><th>Max</th></tr></thead>
+          <tbody>{gpuRows}</tbody>
+        </table>
+      </div>
+    );
+  }
+});
+
 var Overlay = React.createClass( {
   getInitialState: function() {
     return { fps:"199.23492482",ms:"",sampleName: "Sample Name",
@@ -278,6 +312,7 @@ var PostFxPanel = React.createClass({
  window.addEventListener('setMemoryInfo',handleMemoryInfo);
  window.addEventListener('setSampleName',handleSampleInfo);
  window.addEventListener('setCameraInfo',handleCameraInfo);
+ window.addEventListener('setProfilerInfo',handleProfilerInfo);
 
 function handleOverlay (e) {
    OverlayGlobal.setFrameInfo(e.detail);
@@ -291,6 +326,9 @@ function handleOverlay (e) {
 function handleCameraInfo (e) {
   OverlayGlobal.setCameraInfo(e.detail);
 }
+function handleProfilerInfo (e) {
+  OverlayGlobal.setProfilerInfo(e.detail);
+}
 
 
  document.addEventListener("DOMContentLoaded", function() {
@@ -307,6 +345,7 @@ var Root = React.createClass({
       <div>
       <Overlay />
       <CameraPanel />
+      <ProfilerPanel />
       <MemoryUsagePanel />
       <PostFxPanel />
       </div>
@@ -31,6 +31,8 @@ namespace YumeEngine
 {
 
 	YumeD3D11ConstantBuffer::YumeD3D11ConstantBuffer()
+		: shaderType_(VS),
+		slot_(0)
 	{
 	}
 
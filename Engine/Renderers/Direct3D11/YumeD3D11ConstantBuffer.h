@@ -24,6 +24,7 @@
 //----------------------------------------------------------------------------
 #include "YumeD3D11Required.h"
 #include "Renderer/YumeConstantBuffer.h"
+#include "Renderer/YumeRendererDefs.h"
 #include "YumeD3D11GpuResource.h"
 
 #include <boost/shared_array.hpp>
@@ -42,6 +43,15 @@ namespace YumeEngine
 		void Release();
 		bool SetSize(unsigned size);
 		void Apply();
+
+		//Constant buffers are created per shader stage and slot
+		void SetBinding(ShaderType type,unsigned slot) { shaderType_ = type; slot_ = slot; }
+		ShaderType GetShaderType() const { return shaderType_; }
+		unsigned GetSlot() const { return slot_; }
+
+	private:
+		ShaderType shaderType_;
+		unsigned slot_;
 	};
 
 }
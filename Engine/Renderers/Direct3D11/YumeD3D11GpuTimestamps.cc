@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeD3D11GpuTimestamps.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeD3D11GpuTimestamps.h"
+
+#include "Logging/logging.h"
+
+namespace YumeEngine
+{
+	YumeD3D11GpuTimestamps::YumeD3D11GpuTimestamps(ID3D11Device* device,ID3D11DeviceContext* context)
+		: device_(device),
+		context_(context),
+		failed_(false)
+	{
+		memset(disjoint_,0,sizeof disjoint_);
+		memset(timestamps_,0,sizeof timestamps_);
+	}
+
+	YumeD3D11GpuTimestamps::~YumeD3D11GpuTimestamps()
+	{
+		Release();
+	}
+
+	void YumeD3D11GpuTimestamps::Release()
+	{
+		for(unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+		{
+			D3D_SAFE_RELEASE(disjoint_[i]);
+			for(unsigned j = 0; j < MAX_GPU_TIMESTAMPS; ++j)
+				D3D_SAFE_RELEASE(timestamps_[i][j]);
+		}
+	}
+
+	ID3D11Query* YumeD3D11GpuTimestamps::GetQuery(unsigned slot,unsigned index)
+	{
+		ID3D11Query*& query = timestamps_[slot][index];
+		if(!query && !failed_)
+		{
+			D3D11_QUERY_DESC desc;
+			desc.Query = D3D11_QUERY_TIMESTAMP;
+			desc.MiscFlags = 0;
+
+			HRESULT hr = device_->CreateQuery(&desc,&query);
+			if(FAILED(hr))
+			{
+				//Once is enough to know, the timer keeps getting disjoint frames from here on
+				YUMELOG_ERROR("Failed to create timestamp query " << hr);
+				query = 0;
+				failed_ = true;
+			}
+		}
+
+		return query;
+	}
+
+	void YumeD3D11GpuTimestamps::BeginFrame(unsigned slot)
+	{
+		if(!disjoint_[slot] && !failed_)
+		{
+			D3D11_QUERY_DESC desc;
+			desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+			desc.MiscFlags = 0;
+
+			HRESULT hr = device_->CreateQuery(&desc,&disjoint_[slot]);
+			if(FAILED(hr))
+			{
+				YUMELOG_ERROR("Failed to create timestamp disjoint query " << hr);
+				disjoint_[slot] = 0;
+				failed_ = true;
+			}
+		}
+
+		if(disjoint_[slot])
+			context_->Begin(disjoint_[slot]);
+	}
+
+	void YumeD3D11GpuTimestamps::EndFrame(unsigned slot)
+	{
+		if(disjoint_[slot])
+			context_->End(disjoint_[slot]);
+	}
+
+	void YumeD3D11GpuTimestamps::Timestamp(unsigned slot,unsigned index)
+	{
+		//Timestamps only have an End
+		ID3D11Query* query = GetQuery(slot,index);
+		if(query)
+			context_->End(query);
+	}
+
+	GpuTimestampResult YumeD3D11GpuTimestamps::GetTimestamps(unsigned slot,unsigned count,unsigned long long* ticks,unsigned long long& frequency)
+	{
+		if(failed_ || !disjoint_[slot])
+			return GPU_TIMESTAMPS_DISJOINT;
+
+		//The disjoint query ends after every timestamp of the frame, once it is back so are they
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+		if(context_->GetData(disjoint_[slot],&disjoint,sizeof disjoint,D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			return GPU_TIMESTAMPS_PENDING;
+
+		if(disjoint.Disjoint)
+			return GPU_TIMESTAMPS_DISJOINT;
+
+		for(unsigned i = 0; i < count; ++i)
+		{
+			UINT64 tick = 0;
+			if(!timestamps_[slot][i] || context_->GetData(timestamps_[slot][i],&tick,sizeof tick,D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+				return GPU_TIMESTAMPS_PENDING;
+			ticks[i] = tick;
+		}
+
+		frequency = disjoint.Frequency;
+		return GPU_TIMESTAMPS_READY;
+	}
+}
@@ -0,0 +1,58 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeD3D11GpuTimestamps.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeD3D11GpuTimestamps_h__
+#define __YumeD3D11GpuTimestamps_h__
+//----------------------------------------------------------------------------
+#include "YumeD3D11Required.h"
+#include "Renderer/YumeGpuTimer.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//A disjoint query per frame in flight plus MAX_GPU_TIMESTAMPS timestamp queries each, created on first use
+	class YumeD3DExport YumeD3D11GpuTimestamps : public GpuTimestampSource
+	{
+	public:
+		YumeD3D11GpuTimestamps(ID3D11Device* device,ID3D11DeviceContext* context);
+		virtual ~YumeD3D11GpuTimestamps();
+
+		void Release();
+
+		virtual void BeginFrame(unsigned slot);
+		virtual void EndFrame(unsigned slot);
+		virtual void Timestamp(unsigned slot,unsigned index);
+		virtual GpuTimestampResult GetTimestamps(unsigned slot,unsigned count,unsigned long long* ticks,unsigned long long& frequency);
+
+	private:
+		ID3D11Query* GetQuery(unsigned slot,unsigned index);
+
+		ID3D11Device* device_;
+		ID3D11DeviceContext* context_;
+
+		ID3D11Query* disjoint_[GPU_TIMER_FRAMES];
+		ID3D11Query* timestamps_[GPU_TIMER_FRAMES][MAX_GPU_TIMESTAMPS];
+		bool failed_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
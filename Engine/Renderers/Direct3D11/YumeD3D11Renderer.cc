@@ -47,6 +47,7 @@
 #include "YumeD3D11Texture2D.h"
 #include "YumeD3D11Texture3D.h"
 #include "YumeD3D11TextureCube.h"
+#include "YumeD3D11GpuTimestamps.h"
 
 #include "Renderer/YumeRenderable.h"
 #include "Renderer/YumeGeometry.h"
@@ -66,6 +67,9 @@
 
 namespace YumeEngine
 {
+	//Per draw constants of a few frames, at 256 bytes each this is 16k draws
+	static const unsigned CONSTANT_RING_SIZE = 4 * 1024 * 1024;
+
 	static const char* addressModeNames[] =
 	{
 		"wrap",
@@ -218,6 +222,8 @@ namespace YumeEngine
 	//---------------------------------------------------------------------
 	YumeD3D11Renderer::YumeD3D11Renderer()
 		: initialized_(false),
+		constantRingMapped_(false),
+		gpuTimestamps_(0),
 		impl_(YumeAPINew YumeD3D11RendererImpl),
 		shaderProgram_(0)
 	{
@@ -253,6 +259,11 @@ namespace YumeEngine
 		numPrimitives_ = 0;
 		numBatches_ = 0;
 
+		stateCache_.BeginFrame();
+		constantRing_.BeginFrame();
+		DirtyRingBindings();
+		gpuTimer_.BeginFrame();
+
 		return true;
 	}
 
@@ -261,6 +272,8 @@ namespace YumeEngine
 		if(!IsInitialized())
 			return;
 
+		gpuTimer_.EndFrame();
+
 		impl_->swapChain_->Present(vsync_ ? 1 : 0,0);
 
 		CleanupScratchBuffers();
@@ -296,6 +309,9 @@ namespace YumeEngine
 		{
 			impl_->constantBuffers_[VS][i] = 0;
 			impl_->constantBuffers_[PS][i] = 0;
+
+			for(unsigned j = 0; j < 3; ++j)
+				boundConstantBuffers_[j][i] = 0;
 		}
 
 		depthStencil_ = 0;
@@ -349,6 +365,8 @@ namespace YumeEngine
 		firstDirtyTexture_ = lastDirtyTexture_ = M_MAX_UNSIGNED;
 		firstDirtyVB_ = lastDirtyVB_ = M_MAX_UNSIGNED;
 		dirtyConstantBuffers_.clear();
+
+		stateCache_.Invalidate();
 	}
 
 	void YumeD3D11Renderer::ClearDepthStencil(unsigned flags,float depth,unsigned stencil)
@@ -393,6 +411,8 @@ namespace YumeEngine
 			renderTargets_[i] = 0;
 
 		impl_->deviceContext_->OMSetRenderTargetsAndUnorderedAccessViews(numRtv,nullptr,nullptr,uavStart,numUAV,&uavs[0],nullptr);
+		stateCache_.InvalidateRenderTargets();
+		stateCache_.InvalidateShaderResources();
 
 		renderTargetsDirty_ = false;
 	}
@@ -519,7 +539,8 @@ namespace YumeEngine
 		d3dViewport.MinDepth = 0.0f;
 		d3dViewport.MaxDepth = 1.0f;
 
-		impl_->deviceContext_->RSSetViewports(1,&d3dViewport);
+		if(stateCache_.SetViewport(rectCopy))
+			impl_->deviceContext_->RSSetViewports(1,&d3dViewport);
 
 		viewport_ = rectCopy;
 
@@ -662,6 +683,13 @@ namespace YumeEngine
 		for(int i=0; i < size; ++i)
 			constantBuffers_[i].Reset();
 		constantBuffers_.clear();
+		dirtyConstantBuffers_.clear();
+
+		for(unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
+		{
+			for(unsigned j = 0; j < 3; ++j)
+				boundConstantBuffers_[j][i] = 0;
+		}
 		vertexDeclarations_.clear();
 
 		BlendStatesMap::iterator blendIt;
@@ -702,6 +730,13 @@ namespace YumeEngine
 		D3D_SAFE_RELEASE(impl_->defaultDepthTexture_);
 		D3D_SAFE_RELEASE(impl_->resolveTexture_);
 		D3D_SAFE_RELEASE(impl_->swapChain_);
+		D3D_SAFE_RELEASE(impl_->constantRingBuffer_);
+
+		gpuTimer_.SetSource(0);
+		delete gpuTimestamps_;
+		gpuTimestamps_ = 0;
+
+		D3D_SAFE_RELEASE(impl_->deviceContext1_);
 		D3D_SAFE_RELEASE(impl_->deviceContext_);
 		D3D_SAFE_RELEASE(impl_->device_);
 
@@ -870,6 +905,13 @@ namespace YumeEngine
 
 
 			CreateRendererCapabilities();
+			CreateConstantRing();
+
+#if YUME_PROFILING
+			//Render calls are timed on the GPU as well, shipping builds leave the queries out
+			gpuTimestamps_ = new YumeD3D11GpuTimestamps(impl_->device_,impl_->deviceContext_);
+			gpuTimer_.SetSource(gpuTimestamps_);
+#endif
 
 			SetFlushGPU(flushGpu_);
 		}
@@ -962,6 +1004,7 @@ namespace YumeEngine
 
 		ID3D11RenderTargetView* nullView = 0;
 		impl_->deviceContext_->OMSetRenderTargets(1,&nullView,0);
+		stateCache_.InvalidateRenderTargets();
 		if(impl_->defaultRenderTargetView_)
 		{
 			impl_->defaultRenderTargetView_->Release();
@@ -1095,7 +1138,7 @@ namespace YumeEngine
 				ps = ps->GetOwner()->GetVariation(PS,ps->GetDefines() + " CLIPPLANE");
 		}
 
-		if(vs == vertexShader_ && ps == pixelShader_)
+		if(!stateCache_.SetShaders(vs,ps,gs))
 			return;
 
 		if(vs != vertexShader_)
@@ -1186,49 +1229,46 @@ namespace YumeEngine
 				shaderProgram_ = newProgram;
 			}
 
-			bool vsBuffersChanged = false;
-			bool psBuffersChanged = false;
-			bool gsBuffersChanged = false;
-
 			for(unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
 			{
-				ID3D11Buffer* vsBuffer = shaderProgram_->vsConstantBuffers_[i] ? (ID3D11Buffer*)static_cast<YumeD3D11ConstantBuffer*>(shaderProgram_->vsConstantBuffers_[i])->
-					GetGPUObject() : 0;
+				boundConstantBuffers_[VS][i] = shaderProgram_->vsConstantBuffers_[i];
+				boundConstantBuffers_[PS][i] = shaderProgram_->psConstantBuffers_[i];
+				boundConstantBuffers_[GS][i] = geometryShader_ ? shaderProgram_->gsConstantBuffers_[i] : 0;
+
+				ID3D11Buffer* vsBuffer = GetConstantBufferBinding(shaderProgram_->vsConstantBuffers_[i]);
 				if(vsBuffer != impl_->constantBuffers_[VS][i])
 				{
 					impl_->constantBuffers_[VS][i] = vsBuffer;
 					shaderParameterSources_[i] = (const void*)0xffffffff;
-					vsBuffersChanged = true;
 				}
 
-				ID3D11Buffer* psBuffer = shaderProgram_->psConstantBuffers_[i] ? (ID3D11Buffer*)static_cast<YumeD3D11ConstantBuffer*>(shaderProgram_->psConstantBuffers_[i])->
-					GetGPUObject() : 0;
+				ID3D11Buffer* psBuffer = GetConstantBufferBinding(shaderProgram_->psConstantBuffers_[i]);
 				if(psBuffer != impl_->constantBuffers_[PS][i])
 				{
 					impl_->constantBuffers_[PS][i] = psBuffer;
 					shaderParameterSources_[i] = (const void*)0xffffffff;
-					psBuffersChanged = true;
 				}
 
 				if(geometryShader_)
 				{
-					ID3D11Buffer* gsBuffer = shaderProgram_->gsConstantBuffers_[i] ? (ID3D11Buffer*)static_cast<YumeD3D11ConstantBuffer*>(shaderProgram_->gsConstantBuffers_[i])->
-						GetGPUObject() : 0;
+					ID3D11Buffer* gsBuffer = GetConstantBufferBinding(shaderProgram_->gsConstantBuffers_[i]);
 					if(gsBuffer != impl_->constantBuffers_[GS][i])
 					{
 						impl_->constantBuffers_[GS][i] = gsBuffer;
 						shaderParameterSources_[i] = (const void*)0xffffffff;
-						gsBuffersChanged = true;
 					}
 				}
 			}
 
-			if(vsBuffersChanged)
-				impl_->deviceContext_->VSSetConstantBuffers(0,MAX_SHADER_PARAMETER_GROUPS,&impl_->constantBuffers_[VS][0]);
-			if(psBuffersChanged)
-				impl_->deviceContext_->PSSetConstantBuffers(0,MAX_SHADER_PARAMETER_GROUPS,&impl_->constantBuffers_[PS][0]);
-			if(gsBuffersChanged)
-				impl_->deviceContext_->GSSetConstantBuffers(0,MAX_SHADER_PARAMETER_GROUPS,&impl_->constantBuffers_[GS][0]);
+			unsigned first,numChanged;
+
+			if(stateCache_.SetConstantBuffers(VS,0,MAX_SHADER_PARAMETER_GROUPS,(const void* const*)&impl_->constantBuffers_[VS][0],first,numChanged))
+				impl_->deviceContext_->VSSetConstantBuffers(first,numChanged,&impl_->constantBuffers_[VS][first]);
+			if(stateCache_.SetConstantBuffers(PS,0,MAX_SHADER_PARAMETER_GROUPS,(const void* const*)&impl_->constantBuffers_[PS][0],first,numChanged))
+				impl_->deviceContext_->PSSetConstantBuffers(first,numChanged,&impl_->constantBuffers_[PS][first]);
+			if(geometryShader_ &&
+				stateCache_.SetConstantBuffers(GS,0,MAX_SHADER_PARAMETER_GROUPS,(const void* const*)&impl_->constantBuffers_[GS][0],first,numChanged))
+				impl_->deviceContext_->GSSetConstantBuffers(first,numChanged,&impl_->constantBuffers_[GS][first]);
 		}
 		else
 			shaderProgram_ = 0;
@@ -1716,68 +1756,85 @@ namespace YumeEngine
 
 	void YumeD3D11Renderer::BindSampler(ShaderType type,unsigned start,unsigned count,unsigned* samplers)
 	{
-		std::vector<ID3D11SamplerState*> samplerVector;
+		if(!count || (type != VS && type != PS))
+			return;
+
+		ID3D11SamplerState* samplerStates[MAX_TEXTURE_UNITS];
+		if(count > MAX_TEXTURE_UNITS)
+			count = MAX_TEXTURE_UNITS;
 
 		for(unsigned i = 0; i < count; ++i) {
 			if((*samplers) != M_MAX_UNSIGNED)
-				samplerVector.push_back(samplers_[*samplers]);
+				samplerStates[i] = samplers_[*samplers];
 			else
-				samplerVector.push_back(nullptr);
+				samplerStates[i] = nullptr;
 			samplers++;
 		}
 
+		unsigned first,numChanged;
+		if(!stateCache_.SetSamplers(type,start,count,(const void* const*)samplerStates,first,numChanged))
+			return;
+
 		if(type == VS)
-			impl_->deviceContext_->VSSetSamplers(start,count,
-			&samplerVector[0]);
+			impl_->deviceContext_->VSSetSamplers(first,numChanged,
+			&samplerStates[first - start]);
 		if(type == PS)
 		{
-			impl_->deviceContext_->PSSetSamplers(start,count,
-				&samplerVector[0]);
+			impl_->deviceContext_->PSSetSamplers(first,numChanged,
+				&samplerStates[first - start]);
 		}
 	}
 
-	void YumeD3D11Renderer::PSBindSRV(unsigned start,unsigned count,YumeVector<YumeTexture*>::type textures)
+	void YumeD3D11Renderer::PSBindSRV(unsigned start,unsigned count,const YumeVector<YumeTexture*>::type& textures)
 	{
-		for(int i=0; i< 16; ++i)
-			srvs_[i] = 0;
-
-		for(int i=start; i < 16; ++i)
+		//Slots below start are unbound, the rest are indexed directly into textures
+		for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
 		{
-			if(textures[i])
+			if(i >= start && i < textures.size() && textures[i])
 				srvs_[i] = ((ID3D11ShaderResourceView*)(textures[i])->GetShaderResourceView());
+			else
+				srvs_[i] = 0;
 		}
-		impl_->deviceContext_->PSSetShaderResources(0,MAX_TEXTURE_UNITS,&srvs_[0]);
+
+		unsigned first,numChanged;
+		if(stateCache_.SetShaderResources(PS,0,MAX_TEXTURE_UNITS,(const void* const*)&srvs_[0],first,numChanged))
+			impl_->deviceContext_->PSSetShaderResources(first,numChanged,&srvs_[first]);
 	}
 
 	void YumeD3D11Renderer::VSBindSRV(unsigned start,unsigned count,YumeTexture** textures)
 	{
-		std::vector<ID3D11ShaderResourceView*> srvs;
+		ID3D11ShaderResourceView* srvs[MAX_TEXTURE_UNITS];
+		if(count > MAX_TEXTURE_UNITS)
+			count = MAX_TEXTURE_UNITS;
 
-		for(int i=0; i < count; ++i)
+		for(unsigned i=0; i < count; ++i)
 		{
-			srvs.push_back((ID3D11ShaderResourceView*)(*textures)->GetShaderResourceView());
+			srvs[i] = *textures ? (ID3D11ShaderResourceView*)(*textures)->GetShaderResourceView() : 0;
 			textures++;
 		}
-		impl_->deviceContext_->VSSetShaderResources(start,count,&srvs[0]);
+
+		unsigned first,numChanged;
+		if(stateCache_.SetShaderResources(VS,start,count,(const void* const*)srvs,first,numChanged))
+			impl_->deviceContext_->VSSetShaderResources(first,numChanged,&srvs[first - start]);
 	}
 
 
 	void YumeD3D11Renderer::BindResetTextures(int start,int count,bool ps)
 	{
-		std::vector<ID3D11ShaderResourceView*> null_srv;
+		ID3D11ShaderResourceView* null_srv[MAX_TEXTURE_UNITS] = { 0 };
+		if(count > MAX_TEXTURE_UNITS)
+			count = MAX_TEXTURE_UNITS;
 
-		for(int i=0; i < count; ++i)
-			null_srv.push_back(nullptr);
+		unsigned first,numChanged;
+
+		if(stateCache_.SetShaderResources(PS,start,count,(const void* const*)null_srv,first,numChanged))
+			impl_->deviceContext_->PSSetShaderResources(first,numChanged,null_srv);
 
 		if(ps)
-		{
-			impl_->deviceContext_->PSSetShaderResources(start,count,&null_srv[0]);
 			return;
-		}
-		else
-			impl_->deviceContext_->PSSetShaderResources(start,count,&null_srv[0]);
 
-		impl_->deviceContext_->VSSetShaderResources(start,count,&null_srv[0]);
+		if(stateCache_.SetShaderResources(VS,start,count,(const void* const*)null_srv,first,numChanged))
+			impl_->deviceContext_->VSSetShaderResources(first,numChanged,null_srv);
 
 		for(int i=start; i < start + count; ++i)
 		{
@@ -1792,6 +1849,7 @@ namespace YumeEngine
 		{
 			impl_->renderTargetViews_[0] = impl_->defaultRenderTargetView_;
 			impl_->deviceContext_->OMSetRenderTargets(1,&impl_->defaultRenderTargetView_,nullptr);
+			stateCache_.InvalidateRenderTargets();
 		}
 	}
 
@@ -1806,6 +1864,7 @@ namespace YumeEngine
 				impl_->renderTargetViews_[i] = 0;
 			}
 			impl_->deviceContext_->OMSetRenderTargets(0,nullptr,nullptr);
+			stateCache_.InvalidateRenderTargets();
 			return;
 		}
 
@@ -1815,6 +1874,7 @@ namespace YumeEngine
 			null_views.push_back(nullptr);
 
 		impl_->deviceContext_->OMSetRenderTargets(count,&null_views[0],nullptr);
+		stateCache_.InvalidateRenderTargets();
 
 		for(int i=0; i < count ; ++i)
 		{
@@ -2193,7 +2253,8 @@ namespace YumeEngine
 			return i->second;
 		else
 		{
-			SharedPtr<YumeConstantBuffer> newConstantBuffer(new YumeD3D11ConstantBuffer());
+			SharedPtr<YumeD3D11ConstantBuffer> newConstantBuffer(new YumeD3D11ConstantBuffer());
+			newConstantBuffer->SetBinding(type,index);
 			newConstantBuffer->SetSize(size);
 			constantBuffers_[key] = newConstantBuffer;
 			return newConstantBuffer;
@@ -2382,7 +2443,12 @@ namespace YumeEngine
 			if(!renderTargets_[0] &&
 				(!depthStencil_ || (depthStencil_ && depthStencil_->GetWidth() == windowWidth_ && depthStencil_->GetHeight() == windowHeight_)))
 				impl_->renderTargetViews_[0] = impl_->defaultRenderTargetView_;
-			impl_->deviceContext_->OMSetRenderTargets(MAX_RENDERTARGETS,&impl_->renderTargetViews_[0],impl_->depthStencilView_);
+			if(stateCache_.SetRenderTargets(MAX_RENDERTARGETS,(const void* const*)&impl_->renderTargetViews_[0],impl_->depthStencilView_))
+			{
+				impl_->deviceContext_->OMSetRenderTargets(MAX_RENDERTARGETS,&impl_->renderTargetViews_[0],impl_->depthStencilView_);
+				//Binding a target unbinds any view of it from the shader stages
+				stateCache_.InvalidateShaderResources();
+			}
 			renderTargetsDirty_ = false;
 		}
 
@@ -2580,10 +2646,176 @@ namespace YumeEngine
 		}
 
 		for(unsigned i = 0; i < dirtyConstantBuffers_.size(); ++i)
-			dirtyConstantBuffers_[i]->Apply();
+		{
+			YumeD3D11ConstantBuffer* buffer = static_cast<YumeD3D11ConstantBuffer*>(dirtyConstantBuffers_[i]);
+			buffer->RecordUpload(constantRing_.GetFrameNumber());
+
+			if(!buffer->IsDynamic() || !impl_->constantRingBuffer_)
+			{
+				buffer->Apply();
+				continue;
+			}
+
+			//Another program took the slot since it was dirtied, it is uploaded again when it is bound next
+			if(boundConstantBuffers_[buffer->GetShaderType()][buffer->GetSlot()] != buffer)
+			{
+				buffer->ClearDirty();
+				continue;
+			}
+
+			//Ring is full for this frame, fall back to the buffer's own storage
+			if(!UploadToConstantRing(buffer))
+			{
+				buffer->Apply();
+				BindConstantBuffer(buffer->GetShaderType(),buffer->GetSlot(),(ID3D11Buffer*)buffer->GetGPUObject());
+			}
+		}
 		dirtyConstantBuffers_.clear();
 	}
 
+	ID3D11Buffer* YumeD3D11Renderer::GetConstantBufferBinding(YumeConstantBuffer* buffer)
+	{
+		if(!buffer)
+			return 0;
+
+		//Dynamic buffers live in the ring, their contents are re-uploaded from the shadow copy on every bind
+		if(buffer->IsDynamic() && impl_->constantRingBuffer_)
+		{
+			if(!buffer->IsDirty())
+			{
+				buffer->MarkDirty();
+				dirtyConstantBuffers_.push_back(buffer);
+			}
+			return impl_->constantRingBuffer_;
+		}
+
+		return (ID3D11Buffer*)static_cast<YumeD3D11ConstantBuffer*>(buffer)->GetGPUObject();
+	}
+
+	bool YumeD3D11Renderer::UploadToConstantRing(YumeD3D11ConstantBuffer* buffer)
+	{
+		bool wrapped;
+		unsigned offset = constantRing_.Allocate(buffer->GetSize(),wrapped);
+		if(offset == M_MAX_UNSIGNED)
+			return false;
+
+		//The allocator never hands out bytes the GPU may still read, so a wrap needs no discard either.
+		//Discarding would orphan the ranges other stages and slots are bound to. Only the first map discards
+		D3D11_MAPPED_SUBRESOURCE mappedData;
+		D3D11_MAP mapType = constantRingMapped_ ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD;
+
+		HRESULT hr = impl_->deviceContext_->Map(impl_->constantRingBuffer_,0,mapType,0,&mappedData);
+		if(FAILED(hr) || !mappedData.pData)
+		{
+			YUMELOG_ERROR("Failed to map constant ring " << hr);
+			return false;
+		}
+
+		memcpy((unsigned char*)mappedData.pData + offset,buffer->GetShadowData(),buffer->GetSize());
+		impl_->deviceContext_->Unmap(impl_->constantRingBuffer_,0);
+
+		constantRingMapped_ = true;
+		buffer->ClearDirty();
+
+		//Offsets and sizes are in 16 byte constants, sizes rounded up to 16 constants
+		UINT firstConstant = offset / 16;
+		UINT numConstants = (buffer->GetSize() + CONSTANT_RING_ALIGNMENT - 1) / CONSTANT_RING_ALIGNMENT * (CONSTANT_RING_ALIGNMENT / 16);
+
+		ShaderType type = buffer->GetShaderType();
+		unsigned slot = buffer->GetSlot();
+
+		if(type == VS)
+			impl_->deviceContext1_->VSSetConstantBuffers1(slot,1,&impl_->constantRingBuffer_,&firstConstant,&numConstants);
+		else if(type == PS)
+			impl_->deviceContext1_->PSSetConstantBuffers1(slot,1,&impl_->constantRingBuffer_,&firstConstant,&numConstants);
+		else
+			impl_->deviceContext1_->GSSetConstantBuffers1(slot,1,&impl_->constantRingBuffer_,&firstConstant,&numConstants);
+
+		impl_->constantBuffers_[type][slot] = impl_->constantRingBuffer_;
+
+		unsigned first,numChanged;
+		stateCache_.SetConstantBuffers(type,slot,1,(const void* const*)&impl_->constantRingBuffer_,first,numChanged);
+
+		return true;
+	}
+
+	void YumeD3D11Renderer::BindConstantBuffer(ShaderType type,unsigned slot,ID3D11Buffer* buffer)
+	{
+		impl_->constantBuffers_[type][slot] = buffer;
+
+		unsigned first,numChanged;
+		if(!stateCache_.SetConstantBuffers(type,slot,1,(const void* const*)&buffer,first,numChanged))
+			return;
+
+		if(type == VS)
+			impl_->deviceContext_->VSSetConstantBuffers(slot,1,&buffer);
+		else if(type == PS)
+			impl_->deviceContext_->PSSetConstantBuffers(slot,1,&buffer);
+		else
+			impl_->deviceContext_->GSSetConstantBuffers(slot,1,&buffer);
+	}
+
+	void YumeD3D11Renderer::DirtyRingBindings()
+	{
+		if(!impl_->constantRingBuffer_)
+			return;
+
+		for(unsigned type = 0; type < 3; ++type)
+		{
+			for(unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
+			{
+				YumeConstantBuffer* buffer = boundConstantBuffers_[type][i];
+				if(buffer && buffer->IsDynamic() && !buffer->IsDirty())
+				{
+					buffer->MarkDirty();
+					dirtyConstantBuffers_.push_back(buffer);
+				}
+			}
+		}
+	}
+
+	void YumeD3D11Renderer::CreateConstantRing()
+	{
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+		memset(&options,0,sizeof options);
+
+		HRESULT hr = impl_->device_->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS,&options,sizeof options);
+		if(FAILED(hr) || !options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer)
+		{
+			YUMELOG_INFO("Constant buffer offsetting not supported, per draw constants use their own buffers");
+			return;
+		}
+
+		hr = impl_->deviceContext_->QueryInterface(__uuidof(ID3D11DeviceContext1),(void**)&impl_->deviceContext1_);
+		if(FAILED(hr))
+		{
+			D3D_SAFE_RELEASE(impl_->deviceContext1_);
+			return;
+		}
+
+		D3D11_BUFFER_DESC bufferDesc;
+		memset(&bufferDesc,0,sizeof bufferDesc);
+
+		bufferDesc.ByteWidth = CONSTANT_RING_SIZE;
+		bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+
+		hr = impl_->device_->CreateBuffer(&bufferDesc,0,&impl_->constantRingBuffer_);
+		if(FAILED(hr))
+		{
+			D3D_SAFE_RELEASE(impl_->constantRingBuffer_);
+			D3D_SAFE_RELEASE(impl_->deviceContext1_);
+			YUMELOG_ERROR("Failed to create constant ring " << hr);
+			return;
+		}
+
+		constantRing_.SetSize(CONSTANT_RING_SIZE);
+		constantRingMapped_ = false;
+
+		YUMELOG_INFO("Created constant ring with size " << CONSTANT_RING_SIZE);
+	}
+
 	void YumeD3D11Renderer::Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount)
 	{
 		if(!vertexCount || !shaderProgram_)
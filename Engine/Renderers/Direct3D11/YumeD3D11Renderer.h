@@ -43,8 +43,10 @@ namespace YumeEngine
 {
 	class YumeGpuResource;
 	class YumeD3D11RendererImpl;
+	class YumeD3D11GpuTimestamps;
 	class YumeShaderVariation;
 	class YumeD3D11ShaderProgram;
+	class YumeD3D11ConstantBuffer;
 	class YumeTexture2D;
 	class YumeTexture3D;
 	class YumeTextureCube;
@@ -80,7 +82,7 @@ namespace YumeEngine
 		/* */
 
 		virtual void							BindSampler(ShaderType type,unsigned start,unsigned count,unsigned* samplers);
-		virtual void							PSBindSRV(unsigned start,unsigned count,YumeVector<YumeTexture*>::type);
+		virtual void							PSBindSRV(unsigned start,unsigned count,const YumeVector<YumeTexture*>::type& textures);
 		virtual void							VSBindSRV(unsigned start,unsigned count,YumeTexture** textures);
 		virtual void							BindBackbuffer();
 		virtual void							CreateStandardSampler();
@@ -191,6 +193,9 @@ namespace YumeEngine
 		virtual void 							SetViewport(const IntRect& rect);
 
 		void									PreDraw();
+		ID3D11Buffer*							GetConstantBufferBinding(YumeConstantBuffer* buffer);
+		bool									UploadToConstantRing(YumeD3D11ConstantBuffer* buffer);
+		void									BindConstantBuffer(ShaderType type,unsigned slot,ID3D11Buffer* buffer);
 		virtual void 							Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount);
 		virtual void 							Draw(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount);
 		virtual void 							DrawInstanced(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount,unsigned instanceCount);
@@ -244,10 +249,17 @@ namespace YumeEngine
 		void RegisterFactories();
 		void UnregisterFactories();
 		void CreateResolveTexture();
+		void CreateConstantRing();
+		//Ring offsets are only reserved for CONSTANT_RING_FRAMES_IN_FLIGHT frames, everything bound from it is uploaded again each frame
+		void DirtyRingBindings();
 	private:
 		YumeVector<Vector2>::type				GetScreenResolutions();
 	private:
 		bool									initialized_;
+		bool									constantRingMapped_;
+		//What the current shader program has at each stage and slot
+		YumeConstantBuffer*						boundConstantBuffers_[3][MAX_SHADER_PARAMETER_GROUPS];
+		YumeD3D11GpuTimestamps*					gpuTimestamps_;
 
 		YumeVector<ID3D11SamplerState*>::type	samplers_;
 		
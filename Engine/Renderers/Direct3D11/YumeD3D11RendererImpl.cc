@@ -30,6 +30,8 @@ namespace YumeEngine
 		: device_(0),
 		debug_(0),
 		deviceContext_(0),
+		deviceContext1_(0),
+		constantRingBuffer_(0),
 		swapChain_(0),
 		defaultRenderTargetView_(0),
 		defaultDepthTexture_(0),
@@ -55,6 +55,9 @@ namespace YumeEngine
 		ID3D11Device* device_;
 		ID3D11Debug* debug_;
 		ID3D11DeviceContext* deviceContext_;
+		//Only set when the runtime can bind constant buffer ranges
+		ID3D11DeviceContext1* deviceContext1_;
+		ID3D11Buffer* constantRingBuffer_;
 		IDXGISwapChain* swapChain_;
 		ID3D11RenderTargetView* defaultRenderTargetView_;
 		ID3D11Texture2D* defaultDepthTexture_;
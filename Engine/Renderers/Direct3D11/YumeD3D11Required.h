@@ -28,6 +28,7 @@
 #define NOMINMAX 
 
 #include <D3D11.h>
+#include <d3d11_1.h>
 #include <DXGI.h>
 #include <d3d9.h>
 #include <SDL.h>
@@ -150,6 +150,11 @@ namespace YumeEngine
 	}
 
 	bool YumeD3D11Texture2D::SetData(unsigned level,int x,int y,int width,int height,const void* data)
+	{
+		return SetSliceData(level,0,x,y,width,height,data);
+	}
+
+	bool YumeD3D11Texture2D::SetSliceData(unsigned level,unsigned slice,int x,int y,int width,int height,const void* data)
 	{
 		if(!object_)
 		{
@@ -169,6 +174,12 @@ namespace YumeEngine
 			return false;
 		}
 
+		if(slice >= arraySize_)
+		{
+			YUMELOG_ERROR("Illegal array slice for setting data");
+			return false;
+		}
+
 		int levelWidth = GetLevelWidth(level);
 		int levelHeight = GetLevelHeight(level);
 		if(x < 0 || x + width > levelWidth || y < 0 || y + height > levelHeight || width <= 0 || height <= 0)
@@ -191,7 +202,7 @@ namespace YumeEngine
 		unsigned char* src = (unsigned char*)data;
 		unsigned rowSize = GetRowDataSize(width);
 		unsigned rowStart = GetRowDataSize(x);
-		unsigned subResource = D3D11CalcSubresource(level,0,levels_);
+		unsigned subResource = D3D11CalcSubresource(level,slice,levels_);
 
 		if(usage_ == TEXTURE_DYNAMIC)
 		{
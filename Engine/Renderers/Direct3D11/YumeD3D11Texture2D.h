@@ -39,6 +39,7 @@ namespace YumeEngine
 		virtual void Release();
 		virtual bool SetSize(int width,int height,unsigned format,TextureUsage usage = TEXTURE_STATIC,int arraySize = 1,int mips = 1);
 		virtual bool SetData(unsigned level,int x,int y,int width,int height,const void* data);
+		virtual bool SetSliceData(unsigned level,unsigned slice,int x,int y,int width,int height,const void* data);
 		virtual bool SetData(unsigned level,int x,int y,int width,int height,unsigned f1,unsigned f2,unsigned f3,const void* data);
 		virtual bool SetData(SharedPtr<YumeImage> image,bool useAlpha = false);
 
@@ -48,6 +48,7 @@ namespace YumeEngine
 	//---------------------------------------------------------------------
 	YumeNullRenderer::YumeNullRenderer()
 	{
+		gpuTimer_.SetSource(&timestamps_);
 	}
 
 	YumeNullRenderer::~YumeNullRenderer()
@@ -50,8 +50,8 @@ namespace YumeEngine
 
 		virtual bool							SetGraphicsMode(int width,int height,bool fullscreen,bool borderless,bool resizable,bool vsync,bool tripleBuffer,int multiSample) { return true; };
 
-		virtual bool							BeginFrame() { return true; };
-		virtual void							EndFrame() { };
+		virtual bool							BeginFrame() { gpuTimer_.BeginFrame(); return true; };
+		virtual void							EndFrame() { gpuTimer_.EndFrame(); };
 		virtual void							Clear(unsigned flags,const YumeColor& color = YumeColor(0.0f,0.0f,0.0f,0.0f),float depth = 1.0f,unsigned stencil = 0) { };
 
 		virtual bool							IsInitialized() { return true; }
@@ -144,6 +144,10 @@ namespace YumeEngine
 		virtual void							ClearTransformSources() { };
 		virtual void 							CleanupShaderPrograms(YumeShaderVariation* variation) { };
 
+	private:
+		//Every timed scope reports a fixed cost so the timing report can be exercised without a GPU
+		SyntheticTimestampSource				timestamps_;
+
 	};
 }
 
@@ -258,6 +258,17 @@ namespace YumeEngine
 #endif
 	}
 
+	bool YumeGLTexture2D::SetSliceData(unsigned level,unsigned slice,int x,int y,int width,int height,const void* data)
+	{
+		if(slice)
+		{
+			YUMELOG_ERROR("Array textures are not supported");
+			return false;
+		}
+
+		return SetData(level,x,y,width,height,data);
+	}
+
 	bool YumeGLTexture2D::SetData(unsigned level,int x,int y,int width,int height,const void* data)
 	{
 		if(!object_)
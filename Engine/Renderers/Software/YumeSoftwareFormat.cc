@@ -0,0 +1,313 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareFormat.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeSoftwareRequired.h"
+
+#include "Renderer/SoftwareRasterizer.h"
+#include "Math/YumeMath.h"
+
+
+namespace YumeEngine
+{
+	static unsigned EncodeUnorm(float value,unsigned maxValue)
+	{
+		return (unsigned)(Clamp(value,0.0f,1.0f) * (float)maxValue + 0.5f);
+	}
+
+	static float DecodeUnorm(unsigned value,unsigned maxValue)
+	{
+		return (float)value / (float)maxValue;
+	}
+
+	unsigned GetSoftwareFormatSize(unsigned format)
+	{
+		switch(format)
+		{
+		case SWFMT_R8:
+		case SWFMT_A8:
+			return 1;
+
+		case SWFMT_RG8:
+		case SWFMT_R16:
+		case SWFMT_R16F:
+		case SWFMT_R16_TYPELESS:
+			return 2;
+
+		case SWFMT_RGBA8:
+		case SWFMT_BGRA8:
+		case SWFMT_RGB10A2:
+		case SWFMT_RG16:
+		case SWFMT_RG16F:
+		case SWFMT_R32F:
+		case SWFMT_R32_TYPELESS:
+		case SWFMT_R24G8_TYPELESS:
+		case SWFMT_D24S8:
+			return 4;
+
+		case SWFMT_RGBA16:
+		case SWFMT_RGBA16F:
+		case SWFMT_RG32F:
+			return 8;
+
+		case SWFMT_RGBA32F:
+			return 16;
+
+		default:
+			return 0;
+		}
+	}
+
+	bool IsSoftwareDepthFormat(unsigned format)
+	{
+		return format == SWFMT_R24G8_TYPELESS || format == SWFMT_D24S8 || format == SWFMT_R16_TYPELESS || format == SWFMT_R32_TYPELESS;
+	}
+
+	bool IsSoftwareNormalizedFormat(unsigned format)
+	{
+		switch(format)
+		{
+		case SWFMT_R8:
+		case SWFMT_A8:
+		case SWFMT_RG8:
+		case SWFMT_R16:
+		case SWFMT_RG16:
+		case SWFMT_RGBA8:
+		case SWFMT_BGRA8:
+		case SWFMT_RGB10A2:
+		case SWFMT_RGBA16:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	Vector4 DecodeSoftwareTexel(unsigned format,const unsigned char* src)
+	{
+		const unsigned short* src16 = (const unsigned short*)src;
+		const float* src32 = (const float*)src;
+		unsigned packed = 0;
+
+		switch(format)
+		{
+		case SWFMT_R8:
+			return Vector4(DecodeUnorm(src[0],255),0.0f,0.0f,1.0f);
+
+		case SWFMT_A8:
+			return Vector4(0.0f,0.0f,0.0f,DecodeUnorm(src[0],255));
+
+		case SWFMT_RG8:
+			return Vector4(DecodeUnorm(src[0],255),DecodeUnorm(src[1],255),0.0f,1.0f);
+
+		case SWFMT_RGBA8:
+			return Vector4(DecodeUnorm(src[0],255),DecodeUnorm(src[1],255),DecodeUnorm(src[2],255),DecodeUnorm(src[3],255));
+
+		case SWFMT_BGRA8:
+			return Vector4(DecodeUnorm(src[2],255),DecodeUnorm(src[1],255),DecodeUnorm(src[0],255),DecodeUnorm(src[3],255));
+
+		case SWFMT_RGB10A2:
+			memcpy(&packed,src,sizeof packed);
+			return Vector4(DecodeUnorm(packed & 0x3ff,1023),DecodeUnorm((packed >> 10) & 0x3ff,1023),DecodeUnorm((packed >> 20) & 0x3ff,1023),
+				DecodeUnorm(packed >> 30,3));
+
+		case SWFMT_R16:
+		case SWFMT_R16_TYPELESS:
+			return Vector4(DecodeUnorm(src16[0],65535),0.0f,0.0f,1.0f);
+
+		case SWFMT_RG16:
+			return Vector4(DecodeUnorm(src16[0],65535),DecodeUnorm(src16[1],65535),0.0f,1.0f);
+
+		case SWFMT_RGBA16:
+			return Vector4(DecodeUnorm(src16[0],65535),DecodeUnorm(src16[1],65535),DecodeUnorm(src16[2],65535),DecodeUnorm(src16[3],65535));
+
+		case SWFMT_R16F:
+			return Vector4(HalfToFloat(src16[0]),0.0f,0.0f,1.0f);
+
+		case SWFMT_RG16F:
+			return Vector4(HalfToFloat(src16[0]),HalfToFloat(src16[1]),0.0f,1.0f);
+
+		case SWFMT_RGBA16F:
+			return Vector4(HalfToFloat(src16[0]),HalfToFloat(src16[1]),HalfToFloat(src16[2]),HalfToFloat(src16[3]));
+
+		case SWFMT_R32F:
+		case SWFMT_R32_TYPELESS:
+			return Vector4(src32[0],0.0f,0.0f,1.0f);
+
+		case SWFMT_RG32F:
+			return Vector4(src32[0],src32[1],0.0f,1.0f);
+
+		case SWFMT_RGBA32F:
+			return Vector4(src32[0],src32[1],src32[2],src32[3]);
+
+		//Depth in x and stencil in y, like SoftwareSurface::Load
+		case SWFMT_R24G8_TYPELESS:
+		case SWFMT_D24S8:
+			memcpy(&packed,src,sizeof packed);
+			return Vector4(DecodeUnorm(packed & 0xffffff,0xffffff),(float)(packed >> 24),0.0f,1.0f);
+
+		default:
+			return Vector4(0.0f,0.0f,0.0f,1.0f);
+		}
+	}
+
+	void EncodeSoftwareTexel(unsigned format,const Vector4& color,unsigned char* dest)
+	{
+		unsigned short* dest16 = (unsigned short*)dest;
+		float* dest32 = (float*)dest;
+		unsigned packed = 0;
+
+		switch(format)
+		{
+		case SWFMT_R8:
+			dest[0] = (unsigned char)EncodeUnorm(color.x_,255);
+			break;
+
+		case SWFMT_A8:
+			dest[0] = (unsigned char)EncodeUnorm(color.w_,255);
+			break;
+
+		case SWFMT_RG8:
+			dest[0] = (unsigned char)EncodeUnorm(color.x_,255);
+			dest[1] = (unsigned char)EncodeUnorm(color.y_,255);
+			break;
+
+		case SWFMT_RGBA8:
+			dest[0] = (unsigned char)EncodeUnorm(color.x_,255);
+			dest[1] = (unsigned char)EncodeUnorm(color.y_,255);
+			dest[2] = (unsigned char)EncodeUnorm(color.z_,255);
+			dest[3] = (unsigned char)EncodeUnorm(color.w_,255);
+			break;
+
+		case SWFMT_BGRA8:
+			dest[0] = (unsigned char)EncodeUnorm(color.z_,255);
+			dest[1] = (unsigned char)EncodeUnorm(color.y_,255);
+			dest[2] = (unsigned char)EncodeUnorm(color.x_,255);
+			dest[3] = (unsigned char)EncodeUnorm(color.w_,255);
+			break;
+
+		case SWFMT_RGB10A2:
+			packed = EncodeUnorm(color.x_,1023) | (EncodeUnorm(color.y_,1023) << 10) | (EncodeUnorm(color.z_,1023) << 20) | (EncodeUnorm(color.w_,3) << 30);
+			memcpy(dest,&packed,sizeof packed);
+			break;
+
+		case SWFMT_R16:
+		case SWFMT_R16_TYPELESS:
+			dest16[0] = (unsigned short)EncodeUnorm(color.x_,65535);
+			break;
+
+		case SWFMT_RG16:
+			dest16[0] = (unsigned short)EncodeUnorm(color.x_,65535);
+			dest16[1] = (unsigned short)EncodeUnorm(color.y_,65535);
+			break;
+
+		case SWFMT_RGBA16:
+			dest16[0] = (unsigned short)EncodeUnorm(color.x_,65535);
+			dest16[1] = (unsigned short)EncodeUnorm(color.y_,65535);
+			dest16[2] = (unsigned short)EncodeUnorm(color.z_,65535);
+			dest16[3] = (unsigned short)EncodeUnorm(color.w_,65535);
+			break;
+
+		case SWFMT_R16F:
+			dest16[0] = FloatToHalf(color.x_);
+			break;
+
+		case SWFMT_RG16F:
+			dest16[0] = FloatToHalf(color.x_);
+			dest16[1] = FloatToHalf(color.y_);
+			break;
+
+		case SWFMT_RGBA16F:
+			dest16[0] = FloatToHalf(color.x_);
+			dest16[1] = FloatToHalf(color.y_);
+			dest16[2] = FloatToHalf(color.z_);
+			dest16[3] = FloatToHalf(color.w_);
+			break;
+
+		case SWFMT_R32F:
+		case SWFMT_R32_TYPELESS:
+			dest32[0] = color.x_;
+			break;
+
+		case SWFMT_RG32F:
+			dest32[0] = color.x_;
+			dest32[1] = color.y_;
+			break;
+
+		case SWFMT_RGBA32F:
+			dest32[0] = color.x_;
+			dest32[1] = color.y_;
+			dest32[2] = color.z_;
+			dest32[3] = color.w_;
+			break;
+
+		case SWFMT_R24G8_TYPELESS:
+		case SWFMT_D24S8:
+			packed = EncodeUnorm(color.x_,0xffffff) | ((unsigned)Clamp((int)color.y_,0,255) << 24);
+			memcpy(dest,&packed,sizeof packed);
+			break;
+
+		default: break;
+		}
+	}
+
+	void WriteSoftwareSurface(SoftwareSurface& surface,unsigned format,int x,int y,int width,int height,const void* data)
+	{
+		unsigned texelSize = GetSoftwareFormatSize(format);
+		const unsigned char* src = (const unsigned char*)data;
+
+		for(int row = 0; row < height; ++row)
+		{
+			for(int column = 0; column < width; ++column)
+			{
+				Vector4 texel = DecodeSoftwareTexel(format,src);
+				src += texelSize;
+
+				if(surface.IsDepthStencil())
+				{
+					surface.SetDepth(x + column,y + row,texel.x_);
+					surface.SetStencil(x + column,y + row,(unsigned)texel.y_);
+				}
+				else
+					surface.SetPixel(x + column,y + row,texel);
+			}
+		}
+	}
+
+	void ReadSoftwareSurface(const SoftwareSurface& surface,unsigned format,unsigned level,void* dest)
+	{
+		unsigned texelSize = GetSoftwareFormatSize(format);
+		unsigned char* dst = (unsigned char*)dest;
+		int levelWidth = Max(surface.GetWidth() >> level,1);
+		int levelHeight = Max(surface.GetHeight() >> level,1);
+
+		for(int y = 0; y < levelHeight; ++y)
+		{
+			for(int x = 0; x < levelWidth; ++x)
+			{
+				//Bilinear between the texels of the top level averages the 2x2 block under the texel
+				Vector4 texel = level ? surface.Sample(Vector2((x + 0.5f) / levelWidth,(y + 0.5f) / levelHeight)) : surface.Load(x,y);
+				EncodeSoftwareTexel(format,texel,dst);
+				dst += texelSize;
+			}
+		}
+	}
+}
@@ -0,0 +1,199 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareIndexBuffer.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeSoftwareIndexBuffer.h"
+
+#include "Renderer/YumeRHI.h"
+#include "Engine/YumeEngine.h"
+
+#include "Logging/logging.h"
+
+
+namespace YumeEngine
+{
+
+	YumeSoftwareIndexBuffer::YumeSoftwareIndexBuffer()
+	{
+		shadowed_ = true;
+	}
+
+	YumeSoftwareIndexBuffer::~YumeSoftwareIndexBuffer()
+	{
+		Release();
+	}
+
+	void YumeSoftwareIndexBuffer::Release()
+	{
+		Unlock();
+
+		if(gYume->pRHI && gYume->pRHI->GetIndexBuffer() == this)
+			gYume->pRHI->SetIndexBuffer(0);
+	}
+
+	bool YumeSoftwareIndexBuffer::SetSize(unsigned indexCount,bool largeIndices,bool dynamic)
+	{
+		Unlock();
+
+		dynamic_ = dynamic;
+		indexCount_ = indexCount;
+		indexSize_ = (unsigned)(largeIndices ? sizeof(unsigned) : sizeof(unsigned short));
+
+		if(indexCount_ && indexSize_)
+			shadowData_ = boost::shared_array<unsigned char>(new unsigned char[indexCount_ * indexSize_]);
+		else
+			shadowData_.reset();
+
+		return Create();
+	}
+
+	bool YumeSoftwareIndexBuffer::SetData(const void* data)
+	{
+		if(!data)
+		{
+			YUMELOG_ERROR("Null pointer for index buffer data");
+			return false;
+		}
+
+		if(!indexSize_)
+		{
+			YUMELOG_ERROR("Index size not defined, can not set index buffer data");
+			return false;
+		}
+
+		if(shadowData_ && data != shadowData_.get())
+			memcpy(shadowData_.get(),data,indexCount_ * indexSize_);
+
+		return true;
+	}
+
+	bool YumeSoftwareIndexBuffer::SetDataRange(const void* data,unsigned start,unsigned count,bool discard)
+	{
+		if(start == 0 && count == indexCount_)
+			return SetData(data);
+
+		if(!data)
+		{
+			YUMELOG_ERROR("Null pointer for index buffer data");
+			return false;
+		}
+
+		if(!indexSize_)
+		{
+			YUMELOG_ERROR("Index size not defined, can not set index buffer data");
+			return false;
+		}
+
+		if(start + count > indexCount_)
+		{
+			YUMELOG_ERROR("Illegal range for setting new index buffer data");
+			return false;
+		}
+
+		if(!count)
+			return true;
+
+		if(shadowData_ && shadowData_.get() + start * indexSize_ != data)
+			memcpy(shadowData_.get() + start * indexSize_,data,count * indexSize_);
+
+		return true;
+	}
+
+	void* YumeSoftwareIndexBuffer::Lock(unsigned start,unsigned count,bool discard)
+	{
+		if(lockState_ != LOCK_NONE)
+		{
+			YUMELOG_ERROR("Index buffer already locked");
+			return 0;
+		}
+
+		if(!indexSize_)
+		{
+			YUMELOG_ERROR("Index size not defined, can not lock index buffer");
+			return 0;
+		}
+
+		if(start + count > indexCount_)
+		{
+			YUMELOG_ERROR("Illegal range for locking index buffer");
+			return 0;
+		}
+
+		if(!count || !shadowData_)
+			return 0;
+
+		lockStart_ = start;
+		lockCount_ = count;
+		lockState_ = LOCK_SHADOW;
+		return shadowData_.get() + start * indexSize_;
+	}
+
+	void YumeSoftwareIndexBuffer::Unlock()
+	{
+		lockState_ = LOCK_NONE;
+	}
+
+	bool YumeSoftwareIndexBuffer::GetUsedVertexRange(unsigned start,unsigned count,unsigned& minVertex,unsigned& vertexCount)
+	{
+		if(!shadowData_)
+		{
+			YUMELOG_ERROR("Used vertex range can only be queried from an index buffer with shadow data");
+			return false;
+		}
+
+		if(start + count > indexCount_)
+		{
+			YUMELOG_ERROR("Illegal index range for querying used vertices");
+			return false;
+		}
+
+		minVertex = M_MAX_UNSIGNED;
+		unsigned maxVertex = 0;
+
+		if(indexSize_ == sizeof(unsigned))
+		{
+			unsigned* indices = ((unsigned*)shadowData_.get()) + start;
+
+			for(unsigned i = 0; i < count; ++i)
+			{
+				if(indices[i] < minVertex)
+					minVertex = indices[i];
+				if(indices[i] > maxVertex)
+					maxVertex = indices[i];
+			}
+		}
+		else
+		{
+			unsigned short* indices = ((unsigned short*)shadowData_.get()) + start;
+
+			for(unsigned i = 0; i < count; ++i)
+			{
+				if(indices[i] < minVertex)
+					minVertex = indices[i];
+				if(indices[i] > maxVertex)
+					maxVertex = indices[i];
+			}
+		}
+
+		vertexCount = maxVertex - minVertex + 1;
+		return true;
+	}
+}
@@ -0,0 +1,61 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareIndexBuffer.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareIndexBuffer_h__
+#define __YumeSoftwareIndexBuffer_h__
+//----------------------------------------------------------------------------
+#include "YumeSoftwareRequired.h"
+#include "Renderer/YumeRendererDefs.h"
+#include "Renderer/YumeIndexBuffer.h"
+
+#include <boost/shared_array.hpp>
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Index buffer that is only its shadow data, like YumeSoftwareVertexBuffer
+	class YumeSoftwareExport YumeSoftwareIndexBuffer : public YumeIndexBuffer
+	{
+	public:
+		YumeSoftwareIndexBuffer();
+		virtual ~YumeSoftwareIndexBuffer();
+
+		virtual void Release();
+
+		//Shadowing is always on
+		virtual void SetShadowed(bool enable) { }
+		virtual bool SetSize(unsigned indexCount,bool largeIndices,bool dynamic = false);
+		virtual bool SetData(const void* data);
+		virtual bool SetDataRange(const void* data,unsigned start,unsigned count,bool discard = false);
+		virtual void* Lock(unsigned start,unsigned count,bool discard = false);
+		virtual void Unlock();
+
+		virtual bool GetUsedVertexRange(unsigned start,unsigned count,unsigned& minVertex,unsigned& vertexCount);
+
+		virtual bool Create() { return true; }
+		virtual bool UpdateToGPU() { return true; }
+		virtual void* MapBuffer(unsigned start,unsigned count,bool discard) { return 0; }
+		virtual void UnmapBuffer() { }
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
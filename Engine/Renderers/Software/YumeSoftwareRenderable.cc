@@ -14,44 +14,49 @@
 //51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
 //----------------------------------------------------------------------------
 //
-// File : <Filename>
+// File : YumeSoftwareRenderable.cc
 // Date : <Date>
 // Comments :
 //
 //----------------------------------------------------------------------------
-#include "PostProcessing.hlsl"
-#include "Blur.hlsl"
+#include "YumeHeaders.h"
+#include "YumeSoftwareRenderable.h"
+#include "Renderer/YumeRHI.h"
+#include "Renderer/YumeTexture.h"
 
-cbuffer DoFParams : register(b6)
-{
-  float dof_focal_plane;
-  float dof_coc_scale;
-}
+#include "Engine/YumeEngine.h"
 
-float4 ps_gauss_dof_h(in PS_INPUT inp) : SV_TARGET
-{
-    return bilateral_gauss_far(inp, float2(0, 1), dof_coc_scale);
-}
 
-float4 ps_gauss_dof_v(in PS_INPUT inp) : SV_TARGET
+namespace YumeEngine
 {
-    return bilateral_gauss_far(inp, float2(1, 0), dof_coc_scale);
-}
 
-float blur_factor(in float depth)
-{
-	return smoothstep(0, dof_focal_plane, abs(depth));
-}
+	YumeSoftwareRenderable::YumeSoftwareRenderable(YumeTexture* parentTexture):
+		YumeRenderable(parentTexture)
+	{
+	}
 
-float4 ps_depth_of_field(in PS_INPUT inp) : SV_Target
-{
-    float4 blurred = rt_pp_one.Sample(StandardFilter, inp.tex_coord);
-    float4 full = rt_output.Sample(StandardFilter, inp.tex_coord);
-    float depth = rt_lineardepth.Sample(StandardFilter, inp.tex_coord).x;
+	YumeSoftwareRenderable::~YumeSoftwareRenderable()
+	{
+		Release();
+	}
+
+	void YumeSoftwareRenderable::Release()
+	{
+		YumeRHI* graphics = gYume->pRHI;
+		if(graphics && renderTargetView_)
+		{
+			for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+			{
+				if(graphics->GetRenderTarget(i) == this)
+					graphics->ResetRenderTarget(i);
+			}
 
-    // TODO: a should be 0 or 1, but gets interpolated in between somewhere
-    if (full.a < 0.5)
-        return full;
+			if(graphics->GetDepthStencil() == this)
+				graphics->ResetDepthStencil();
+		}
 
-    return lerp(full, blurred, saturate(blur_factor(depth)));
+		//The surface belongs to the parent texture
+		renderTargetView_ = 0;
+		readOnlyView_ = 0;
+	}
 }
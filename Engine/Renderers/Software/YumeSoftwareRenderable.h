@@ -0,0 +1,50 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareRenderable.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareRenderable_h__
+#define __YumeSoftwareRenderable_h__
+//----------------------------------------------------------------------------
+#include "YumeSoftwareRequired.h"
+#include "Renderer/YumeRendererDefs.h"
+#include "Renderer/YumeRenderable.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class YumeTexture;
+	class SoftwareSurface;
+
+	//Render target or depth stencil of a software texture, the view is the SoftwareSurface of the slice or face
+	class YumeSoftwareExport YumeSoftwareRenderable : public YumeRenderable
+	{
+	public:
+		YumeSoftwareRenderable(YumeTexture* parentTexture);
+		~YumeSoftwareRenderable();
+
+		virtual void Release();
+
+		void SetSurface(SoftwareSurface* surface) { renderTargetView_ = surface; readOnlyView_ = surface; }
+		SoftwareSurface* GetSurface() const { return static_cast<SoftwareSurface*>(renderTargetView_); }
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
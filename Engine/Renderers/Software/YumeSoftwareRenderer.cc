@@ -0,0 +1,1359 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareRenderer.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeRequired.h"
+#include "YumeSoftwareRenderer.h"
+
+#include "YumeSoftwareShaderVariation.h"
+#include "YumeSoftwareVertexBuffer.h"
+#include "YumeSoftwareIndexBuffer.h"
+#include "YumeSoftwareRenderable.h"
+#include "YumeSoftwareTexture2D.h"
+#include "YumeSoftwareTexture3D.h"
+#include "YumeSoftwareTextureCube.h"
+
+#include "Renderer/YumeRendererDefs.h"
+#include "Renderer/YumeRenderable.h"
+#include "Renderer/YumeTexture.h"
+
+#include "Math/YumeMatrix3.h"
+#include "Math/YumeMatrix4.h"
+#include "Math/YumeMath.h"
+#include "Math/YumeRect.h"
+#include "Math/YumePlane.h"
+
+#include "Core/YumeBase.h"
+#include "Core/YumeDefaults.h"
+#include "Core/YumeVariant.h"
+
+#include "Logging/logging.h"
+
+#include "Engine/YumeEngine.h"
+
+namespace YumeEngine
+{
+	extern "C" void YumeSoftwareExport LoadModule(YumeEngine3D* engine) throw()
+	{
+		YumeSoftwareRenderer* renderer = (new YumeSoftwareRenderer);
+		engine->SetRenderer(renderer);
+	}
+	//---------------------------------------------------------------------
+	extern "C" void YumeSoftwareExport UnloadModule(YumeEngine3D* engine) throw()
+	{
+		YumeRHI* renderer = gYume->pRHI;
+		delete renderer;
+	}
+	//---------------------------------------------------------------------
+	static unsigned GetPrimitiveCount(unsigned elementCount,PrimitiveType type)
+	{
+		switch(type)
+		{
+		case TRIANGLE_LIST:
+			return elementCount / 3;
+
+		case LINE_LIST:
+			return elementCount / 2;
+
+		case POINT_LIST:
+			return elementCount;
+
+		case TRIANGLE_STRIP:
+			return elementCount > 2 ? elementCount - 2 : 0;
+
+		case LINE_STRIP:
+			return elementCount > 1 ? elementCount - 1 : 0;
+
+		default:
+			return 0;
+		}
+	}
+
+	static SoftwareSurface* GetSoftwareSurface(YumeRenderable* renderable)
+	{
+		return renderable ? static_cast<YumeSoftwareRenderable*>(renderable)->GetSurface() : 0;
+	}
+
+	static YumeString GetShaderKey(ShaderType type,const YumeString& name,const YumeString& entryPoint)
+	{
+		static const char* typeNames[] = { "VS:","PS:","GS:" };
+		return YumeString(typeNames[type]) + name + ":" + entryPoint;
+	}
+
+	SoftwareShaderConstants::SoftwareShaderConstants()
+	{
+		for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+			textures_[i] = 0;
+	}
+
+	const float* SoftwareShaderConstants::GetParameter(YumeHash param,unsigned count) const
+	{
+		YumeMap<YumeHash,YumePodVector<float>::type>::const_iterator i = parameters_.find(param);
+		if(i == parameters_.end() || !i->second.size() || i->second.size() < count)
+			return 0;
+
+		return &i->second[0];
+	}
+
+	float SoftwareShaderConstants::GetFloat(YumeHash param,float defaultValue) const
+	{
+		const float* data = GetParameter(param);
+		return data ? data[0] : defaultValue;
+	}
+
+	Vector4 SoftwareShaderConstants::GetVector4(YumeHash param) const
+	{
+		float values[4] = { 0.0f,0.0f,0.0f,0.0f };
+
+		YumeMap<YumeHash,YumePodVector<float>::type>::const_iterator i = parameters_.find(param);
+		if(i != parameters_.end())
+		{
+			for(unsigned j = 0; j < 4 && j < i->second.size(); ++j)
+				values[j] = i->second[j];
+		}
+
+		return Vector4(values);
+	}
+
+	Matrix4 SoftwareShaderConstants::GetMatrix4(YumeHash param) const
+	{
+		if(const float* data = GetParameter(param,16))
+			return Matrix4(data);
+		if(const float* data = GetParameter(param,12))
+			return Matrix3x4(data).ToMatrix4();
+
+		return Matrix4::IDENTITY;
+	}
+
+	const SoftwareSurface* SoftwareShaderConstants::GetSurface(unsigned unit) const
+	{
+		YumeTexture* texture = GetTexture(unit);
+		return texture ? static_cast<const SoftwareSurface*>(texture->GetShaderResourceView()) : 0;
+	}
+
+	Vector4 SoftwareShaderConstants::Sample(unsigned unit,const Vector2& uv) const
+	{
+		const SoftwareSurface* surface = GetSurface(unit);
+		return surface ? surface->Sample(uv) : Vector4::ZERO;
+	}
+
+	YumeSoftwareRenderer::YumeSoftwareRenderer()
+		: initialized_(false)
+	{
+		apiName_ = "Software";
+		shaderPath_ = "";
+		shaderExtension_ = "";
+
+		ResetCache();
+
+		//Tiles are split over every hardware thread and run on the engine's work queue
+		rasterizer_.SetNumThreads(0);
+
+		RegisterFactories();
+		RegisterEngineShaders();
+	}
+
+	YumeSoftwareRenderer::~YumeSoftwareRenderer()
+	{
+
+	}
+
+	bool YumeSoftwareRenderer::SetGraphicsMode(int width,int height,bool fullscreen,bool borderless,bool resizable,bool vsync,bool tripleBuffer,
+		int multiSample)
+	{
+		if(!width || !height)
+		{
+			width = 1024;
+			height = 768;
+		}
+
+		// If nothing changes, do not recreate the backbuffer
+		if(initialized_ && width == windowWidth_ && height == windowHeight_ && fullscreen == fullscreen_ && borderless == borderless_ &&
+			resizable == resizeable_ && vsync == vsync_ && tripleBuffer == tripleBuffer_)
+			return true;
+
+		windowWidth_ = width;
+		windowHeight_ = height;
+		fullscreen_ = fullscreen;
+		borderless_ = borderless;
+		resizeable_ = resizable;
+		vsync_ = vsync;
+		tripleBuffer_ = tripleBuffer;
+		//No multisampling on the CPU
+		multiSample_ = 1;
+
+		backbuffer_.SetSize(width,height);
+		backbuffer_.SetNormalized(true);
+		defaultDepthStencil_.SetSize(width,height,true);
+
+		YumeRHI::SetGraphicsMode(width,height,fullscreen,borderless,resizable,vsync,tripleBuffer,multiSample_);
+
+		CreateRendererCapabilities();
+
+		ResetRenderTargets();
+		SetViewport(IntRect(0,0,width,height));
+		Clear(CLEAR_COLOR | CLEAR_DEPTH | CLEAR_STENCIL);
+
+		YUMELOG_INFO("Graphics Mode: ");
+		YUMELOG_INFO("Width: " << width);
+		YUMELOG_INFO("Height: " << height);
+		YUMELOG_INFO("Threads: " << rasterizer_.GetNumThreads());
+
+		initialized_ = true;
+		return true;
+	}
+
+	bool YumeSoftwareRenderer::BeginFrame()
+	{
+		if(!IsInitialized())
+			return false;
+
+		ResetRenderTargets();
+
+		for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+			SetTexture(i,0);
+
+		numPrimitives_ = 0;
+		numBatches_ = 0;
+
+		stateCache_.BeginFrame();
+		constantRing_.BeginFrame();
+		gpuTimer_.BeginFrame();
+
+		return true;
+	}
+
+	void YumeSoftwareRenderer::EndFrame()
+	{
+		if(!IsInitialized())
+			return;
+
+		gpuTimer_.EndFrame();
+
+		//Nothing to present, the frame stays in the backbuffer until the next one draws over it
+		CleanupScratchBuffers();
+	}
+
+	void YumeSoftwareRenderer::ResetCache()
+	{
+		for(unsigned i = 0; i < MAX_VERTEX_STREAMS; ++i)
+		{
+			vertexBuffers_[i] = 0;
+			elementMasks_[i] = 0;
+			vertexOffsets_[i] = 0;
+		}
+
+		for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+		{
+			textures_[i] = 0;
+			constants_.textures_[i] = 0;
+		}
+
+		for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+		{
+			renderTargets_[i] = 0;
+			rasterizer_.SetRenderTarget(i,0);
+		}
+
+		depthStencil_ = 0;
+		rasterizer_.SetDepthStencil(0);
+		viewport_ = IntRect(0,0,windowWidth_,windowHeight_);
+		rasterizer_.SetViewport(viewport_);
+
+		noDs_ = false;
+		noBlendState_ = false;
+		bindReadOnlyDepthStencil_ = false;
+		depthEnable_ = true;
+
+		indexBuffer_ = 0;
+		vertexDeclarationHash_ = 0;
+		primitiveType_ = 0;
+		vertexShader_ = 0;
+		pixelShader_ = 0;
+		geometryShader_ = 0;
+		blendMode_ = BLEND_REPLACE;
+		textureAnisotropy_ = 1;
+		colorWrite_ = true;
+		cullMode_ = CULL_CCW;
+		constantDepthBias_ = 0.0f;
+		slopeScaledDepthBias_ = 0.0f;
+		depthTestMode_ = CMP_LESSEQUAL;
+		depthWrite_ = true;
+		fillMode_ = FILL_SOLID;
+		scissorTest_ = false;
+		scissorRect_ = IntRect::ZERO;
+		stencilTest_ = false;
+		stencilTestMode_ = CMP_ALWAYS;
+		stencilPass_ = OP_KEEP;
+		stencilFail_ = OP_KEEP;
+		stencilZFail_ = OP_KEEP;
+		stencilZFailBack_ = OP_KEEP;
+		stencilRef_ = 0;
+		stencilCompareMask_ = M_MAX_UNSIGNED;
+		stencilWriteMask_ = M_MAX_UNSIGNED;
+		useClipPlane_ = false;
+		renderTargetsDirty_ = true;
+		texturesDirty_ = true;
+		vertexDeclarationDirty_ = true;
+		blendStateDirty_ = true;
+		depthStateDirty_ = true;
+		rasterizerStateDirty_ = true;
+		scissorRectDirty_ = true;
+		stencilRefDirty_ = true;
+		blendStateHash_ = M_MAX_UNSIGNED;
+		depthStateHash_ = M_MAX_UNSIGNED;
+		rasterizerStateHash_ = M_MAX_UNSIGNED;
+		firstDirtyTexture_ = lastDirtyTexture_ = M_MAX_UNSIGNED;
+		firstDirtyVB_ = lastDirtyVB_ = M_MAX_UNSIGNED;
+		dirtyConstantBuffers_.clear();
+
+		rasterizer_.SetShaders(0,0,0);
+		rasterizer_.SetConstants(&constants_);
+
+		stateCache_.Invalidate();
+	}
+
+	void YumeSoftwareRenderer::Clear(unsigned flags,const YumeColor& color,float depth,unsigned stencil)
+	{
+		PreDraw();
+
+		if((flags & CLEAR_COLOR) && rasterizer_.GetRenderTarget(0))
+		{
+			for(int i=0; i < MAX_RENDERTARGETS;++i)
+			{
+				if(rasterizer_.GetRenderTarget(i))
+					rasterizer_.GetRenderTarget(i)->Clear(color.ToVector4());
+			}
+		}
+
+		if((flags & (CLEAR_DEPTH | CLEAR_STENCIL)) && rasterizer_.GetDepthStencil())
+			rasterizer_.GetDepthStencil()->ClearDepthStencil(flags,depth,stencil);
+	}
+
+	void YumeSoftwareRenderer::ClearRenderTarget(unsigned index,unsigned flags,const YumeColor& color,float depth,unsigned stencil)
+	{
+		SoftwareSurface* surface = index < MAX_RENDERTARGETS ? GetSoftwareSurface(renderTargets_[index]) : 0;
+		if(surface && (flags & CLEAR_COLOR))
+			surface->Clear(color.ToVector4());
+
+		if(flags & (CLEAR_DEPTH | CLEAR_STENCIL))
+			ClearDepthStencil(flags,depth,stencil);
+	}
+
+	void YumeSoftwareRenderer::ClearDepthStencil(unsigned flags,float depth,unsigned stencil)
+	{
+		SoftwareSurface* surface = depthStencil_ ? GetSoftwareSurface(depthStencil_) : &defaultDepthStencil_;
+		if(surface)
+			surface->ClearDepthStencil(flags,depth,stencil);
+	}
+
+	void YumeSoftwareRenderer::CreateRendererCapabilities()
+	{
+		lightPrepassSupport_ = true;
+		deferredSupport_ = true;
+		//No comparison samplers, shadow callbacks compare the depth they sample themselves
+		hardwareShadowSupport_ = false;
+		instancingSupport_ = true;
+		shadowMapFormat_ = SWFMT_R16_TYPELESS;
+		hiresShadowMapFormat_ = SWFMT_R32_TYPELESS;
+		dummyColorFormat_ = SWFMT_UNKNOWN;
+		sRGBSupport_ = false;
+		sRGBWriteSupport_ = false;
+	}
+
+	void YumeSoftwareRenderer::SetViewport(const IntRect& rect)
+	{
+		IntVector2 size = GetRenderTargetDimensions();
+
+		IntRect rectCopy = rect;
+
+		if(rectCopy.right_ <= rectCopy.left_)
+			rectCopy.right_ = rectCopy.left_ + 1;
+		if(rectCopy.bottom_ <= rectCopy.top_)
+			rectCopy.bottom_ = rectCopy.top_ + 1;
+		rectCopy.left_ = Clamp(rectCopy.left_,0,size.x_);
+		rectCopy.top_ = Clamp(rectCopy.top_,0,size.y_);
+		rectCopy.right_ = Clamp(rectCopy.right_,0,size.x_);
+		rectCopy.bottom_ = Clamp(rectCopy.bottom_,0,size.y_);
+
+		if(stateCache_.SetViewport(rectCopy))
+			rasterizer_.SetViewport(rectCopy);
+
+		viewport_ = rectCopy;
+
+		// Disable scissor test, needs to be re-enabled by the user
+		SetScissorTest(false);
+	}
+
+	IntVector2 YumeSoftwareRenderer::GetRenderTargetDimensions() const
+	{
+		int width,height;
+
+		if(renderTargets_[0])
+		{
+			width = renderTargets_[0]->GetWidth();
+			height = renderTargets_[0]->GetHeight();
+		}
+		else if(depthStencil_) // Depth-only rendering
+		{
+			width = depthStencil_->GetWidth();
+			height = depthStencil_->GetHeight();
+		}
+		else
+		{
+			width = windowWidth_;
+			height = windowHeight_;
+		}
+
+		return IntVector2(width,height);
+	}
+
+	YumeVector<int>::type YumeSoftwareRenderer::GetMultiSampleLevels() const
+	{
+		YumeVector<int>::type levelsVector;
+		levelsVector.push_back(1);
+		return levelsVector;
+	}
+
+	void YumeSoftwareRenderer::SetWindowPos(const Vector2& pos)
+	{
+		windowPos_ = IntVector2(pos.x_,pos.y_);
+	}
+
+	void YumeSoftwareRenderer::SetWindowTitle(const YumeString& title)
+	{
+		windowTitle_ = title;
+	}
+
+	void YumeSoftwareRenderer::Close()
+	{
+		{
+			MutexLock lock(gpuResourceMutex_);
+
+			for(int i=0; i < gpuResources_.size(); ++i)
+			{
+				if(gpuResources_[i])
+					gpuResources_[i]->Release();
+			}
+
+			gpuResources_.clear();
+		}
+
+		constantBuffers_.clear();
+		vertexDeclarations_.clear();
+		shaders_.clear();
+
+		ResetCache();
+		initialized_ = false;
+
+		UnregisterFactories();
+	}
+
+	void YumeSoftwareRenderer::RegisterVertexShader(const YumeString& name,const YumeString& entryPoint,SoftwareVertexShader shader,unsigned numVaryings)
+	{
+		GetOrCreateShader(VS,name,entryPoint)->SetVertexShader(shader,Min((int)numVaryings,(int)MAX_SOFTWARE_VARYINGS));
+	}
+
+	void YumeSoftwareRenderer::RegisterPixelShader(const YumeString& name,const YumeString& entryPoint,SoftwarePixelShader shader)
+	{
+		GetOrCreateShader(PS,name,entryPoint)->SetPixelShader(shader);
+	}
+
+	YumeSoftwareShaderVariation* YumeSoftwareRenderer::GetOrCreateShader(ShaderType type,const YumeString& name,const YumeString& entryPoint)
+	{
+		YumeString key = GetShaderKey(type,name,entryPoint);
+
+		SoftwareShaderMap::iterator i = shaders_.find(key);
+		if(i != shaders_.end())
+			return i->second;
+
+		SharedPtr<YumeSoftwareShaderVariation> variation(new YumeSoftwareShaderVariation(type,name,entryPoint));
+		shaders_[key] = variation;
+		return variation;
+	}
+
+	YumeShaderVariation* YumeSoftwareRenderer::GetShader(ShaderType type,const YumeString& name,const YumeString& defines,const YumeString& entryPoint) const
+	{
+		return GetShader(type,name.c_str(),defines.c_str(),entryPoint);
+	}
+
+	YumeShaderVariation* YumeSoftwareRenderer::GetShader(ShaderType type,const char* name,const char* defines,const YumeString& entryPoint) const
+	{
+		//Defines pick between variations of a compiled shader, a callback has only the one
+		SoftwareShaderMap::const_iterator i = shaders_.find(GetShaderKey(type,name,entryPoint));
+		if(i == shaders_.end() || !i->second->Create())
+			return 0;
+
+		return i->second;
+	}
+
+	bool YumeSoftwareRenderer::HasShaderParameter(YumeHash param)
+	{
+		//Any parameter can be set, the callbacks read the ones they know
+		return vertexShader_ || pixelShader_;
+	}
+
+	void YumeSoftwareRenderer::SetShaders(YumeShaderVariation* vs,YumeShaderVariation* ps,YumeShaderVariation* gs)
+	{
+		if(!stateCache_.SetShaders(vs,ps,gs))
+			return;
+
+		vertexShader_ = vs;
+		pixelShader_ = ps;
+		geometryShader_ = gs;
+
+		YumeSoftwareShaderVariation* vsVar = static_cast<YumeSoftwareShaderVariation*>(vs);
+		YumeSoftwareShaderVariation* psVar = static_cast<YumeSoftwareShaderVariation*>(ps);
+
+		rasterizer_.SetShaders(vsVar ? vsVar->GetVertexShader() : 0,psVar ? psVar->GetPixelShader() : 0,vsVar ? vsVar->GetNumVaryings() : 0);
+	}
+
+	void YumeSoftwareRenderer::SetParameterData(YumeHash param,const float* data,unsigned count)
+	{
+		YumePodVector<float>::type& values = constants_.parameters_[param];
+		values.resize(count);
+		if(count)
+			memcpy(&values[0],data,count * sizeof(float));
+	}
+
+#ifdef _WIN32
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const DirectX::XMMATRIX& matrix)
+	{
+		DirectX::XMFLOAT4X4 values;
+		DirectX::XMStoreFloat4x4(&values,matrix);
+		SetParameterData(param,&values._11,16);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const DirectX::XMFLOAT3& vector)
+	{
+		SetParameterData(param,&vector.x,3);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const DirectX::XMFLOAT4& vector)
+	{
+		SetParameterData(param,&vector.x,4);
+	}
+#endif
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const float* data,unsigned count)
+	{
+		SetParameterData(param,data,count);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,float value)
+	{
+		SetParameterData(param,&value,1);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,bool value)
+	{
+		float data = value ? 1.0f : 0.0f;
+		SetParameterData(param,&data,1);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const YumeColor& color)
+	{
+		SetParameterData(param,color.Data(),4);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Vector2& vector)
+	{
+		SetParameterData(param,vector.Data(),2);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Matrix3& matrix)
+	{
+		//Rows padded to float4 like the Vector3 array a constant buffer takes
+		SetParameterData(param,Matrix3x4(matrix).Data(),12);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Matrix3x4& matrix)
+	{
+		SetParameterData(param,matrix.Data(),12);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Vector4Vector::type& vectorArray)
+	{
+		if(vectorArray.size())
+			SetParameterData(param,vectorArray[0].Data(),vectorArray.size() * 4);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Vector3& vector)
+	{
+		SetParameterData(param,vector.Data(),3);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Matrix4& matrix)
+	{
+		SetParameterData(param,matrix.Data(),16);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Vector4& vector)
+	{
+		SetParameterData(param,vector.Data(),4);
+	}
+
+	void YumeSoftwareRenderer::SetShaderParameter(YumeHash param,const Variant& value)
+	{
+		switch(value.GetType())
+		{
+		case VAR_BOOL:
+			SetShaderParameter(param,value.GetBool());
+			break;
+
+		case VAR_FLOAT:
+			SetShaderParameter(param,value.GetFloat());
+			break;
+
+		case VAR_VECTOR2:
+			SetShaderParameter(param,value.GetVector2());
+			break;
+
+		case VAR_VECTOR3:
+			SetShaderParameter(param,value.GetVector3());
+			break;
+
+		case VAR_VECTOR4:
+			SetShaderParameter(param,value.GetVector4());
+			break;
+
+		case VAR_COLOR:
+			SetShaderParameter(param,value.GetColor());
+			break;
+
+		case VAR_MATRIX3:
+			SetShaderParameter(param,value.GetMatrix3());
+			break;
+
+		case VAR_MATRIX3X4:
+			SetShaderParameter(param,value.GetMatrix3x4());
+			break;
+
+		case VAR_MATRIX4:
+			SetShaderParameter(param,value.GetMatrix4());
+			break;
+
+		case VAR_VECTOR4VECTOR:
+			SetShaderParameter(param,value.GetVector4Array());
+			break;
+
+		case VAR_BUFFER:
+		{
+			const YumeVector<unsigned char>::type& buffer = value.GetBuffer();
+			if(buffer.size() >= sizeof(float))
+				SetShaderParameter(param,reinterpret_cast<const float*>(&buffer[0]),buffer.size() / sizeof(float));
+		}
+		break;
+		default:
+			// Unsupported parameter type, do nothing
+			break;
+		}
+	}
+
+	void YumeSoftwareRenderer::BindDefaultDepthStencil()
+	{
+		depthStencil_ = 0;
+		rasterizer_.SetDepthStencil(&defaultDepthStencil_);
+	}
+
+	void YumeSoftwareRenderer::BindDepthStateEnable()
+	{
+		//The default depth state, less and write without stencil
+		rasterizer_.SetDepthTest(CMP_LESS);
+		rasterizer_.SetDepthWrite(true);
+		rasterizer_.SetStencilTest(false);
+	}
+
+	void YumeSoftwareRenderer::BindDepthStateDisable()
+	{
+		rasterizer_.SetDepthTest(CMP_ALWAYS);
+		rasterizer_.SetDepthWrite(false);
+	}
+
+	void YumeSoftwareRenderer::BindNullBlendState()
+	{
+		rasterizer_.SetBlendMode(BLEND_REPLACE);
+		rasterizer_.SetColorWrite(true);
+	}
+
+	void YumeSoftwareRenderer::BindPsuedoBuffer()
+	{
+		vertexDeclarationDirty_ = false;
+		vertexDeclarationHash_ = M_MAX_UNSIGNED;
+
+		for(int i=0; i < MAX_VERTEX_STREAMS; ++i)
+		{
+			vertexBuffers_[i] = 0;
+			elementMasks_[i] = 0;
+			vertexOffsets_[i] = 0;
+		}
+	}
+
+	void YumeSoftwareRenderer::BindNullIndexBuffer()
+	{
+		indexBuffer_ = 0;
+	}
+
+	void YumeSoftwareRenderer::PSBindSRV(unsigned start,unsigned count,const YumeVector<YumeTexture*>::type& textures)
+	{
+		//Both stages share the one texture table of the constants
+		//Slots below start are unbound, the rest are indexed directly into textures
+		for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+		{
+			if(i >= start && i < textures.size() && textures[i])
+				constants_.textures_[i] = textures[i];
+			else
+				constants_.textures_[i] = 0;
+		}
+	}
+
+	void YumeSoftwareRenderer::VSBindSRV(unsigned start,unsigned count,YumeTexture** textures)
+	{
+		for(unsigned i = 0; i < count && start + i < MAX_TEXTURE_UNITS; ++i)
+			constants_.textures_[start + i] = textures[i];
+	}
+
+	void YumeSoftwareRenderer::BindResetTextures(int start,int count,bool ps)
+	{
+		for(int i=start; i < start + count && i < MAX_TEXTURE_UNITS; ++i)
+			constants_.textures_[i] = 0;
+
+		if(ps)
+			return;
+
+		for(int i=start; i < start + count && i < MAX_TEXTURE_UNITS; ++i)
+			textures_[i] = 0;
+	}
+
+	void YumeSoftwareRenderer::BindBackbuffer()
+	{
+		rasterizer_.SetRenderTarget(0,&backbuffer_);
+		for(unsigned i = 1; i < MAX_RENDERTARGETS; ++i)
+			rasterizer_.SetRenderTarget(i,0);
+		rasterizer_.SetDepthStencil(0);
+	}
+
+	void YumeSoftwareRenderer::BindResetRenderTargets(int count)
+	{
+		for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+			rasterizer_.SetRenderTarget(i,0);
+		rasterizer_.SetDepthStencil(0);
+
+		if(count == 0)
+		{
+			for(int i=0; i < MAX_RENDERTARGETS ; ++i)
+				renderTargets_[i] = 0;
+			return;
+		}
+
+		for(int i=0; i < count && i < MAX_RENDERTARGETS; ++i)
+			renderTargets_[i] = 0;
+
+		renderTargetsDirty_ = true;
+	}
+
+	void YumeSoftwareRenderer::SetTexture(unsigned index,YumeTexture* texture)
+	{
+		if(index >= MAX_TEXTURE_UNITS)
+			return;
+
+		// Check if texture is currently bound as a rendertarget. In that case, use its backup texture, or blank if not defined
+		if(texture)
+		{
+			if(renderTargets_[0] && renderTargets_[0]->GetParentTexture() == texture)
+				texture = texture->GetBackupTexture();
+		}
+
+		if(texture && texture->GetParametersDirty())
+		{
+			texture->UpdateParameters();
+			textures_[index] = 0; // Force reassign
+		}
+
+		if(texture != textures_[index])
+		{
+			if(firstDirtyTexture_ == M_MAX_UNSIGNED)
+				firstDirtyTexture_ = lastDirtyTexture_ = index;
+			else
+			{
+				if(index < firstDirtyTexture_)
+					firstDirtyTexture_ = index;
+				if(index > lastDirtyTexture_)
+					lastDirtyTexture_ = index;
+			}
+
+			textures_[index] = texture;
+			texturesDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetRenderTarget(unsigned index,YumeRenderable* renderTarget)
+	{
+		if(index >= MAX_RENDERTARGETS)
+			return;
+
+		if(renderTarget != renderTargets_[index])
+		{
+			renderTargets_[index] = renderTarget;
+			renderTargetsDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetDepthStencil(YumeRenderable* depthStencil)
+	{
+		depthStencil_ = depthStencil;
+		renderTargetsDirty_ = true;
+	}
+
+	void YumeSoftwareRenderer::SetDepthStencil(YumeTexture2D* texture)
+	{
+		YumeRenderable* depthStencil = 0;
+		if(texture)
+			depthStencil = texture->GetRenderSurface();
+
+		SetDepthStencil(depthStencil);
+	}
+
+	void YumeSoftwareRenderer::SetBlendMode(BlendMode mode)
+	{
+		if(mode != blendMode_)
+		{
+			blendMode_ = mode;
+			blendStateDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetColorWrite(bool enable)
+	{
+		if(enable != colorWrite_)
+		{
+			colorWrite_ = enable;
+			blendStateDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetCullMode(CullMode mode)
+	{
+		if(mode != cullMode_)
+		{
+			cullMode_ = mode;
+			rasterizerStateDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetDepthBias(float constantBias,float slopeScaledBias)
+	{
+		constantDepthBias_ = constantBias;
+		slopeScaledDepthBias_ = slopeScaledBias;
+	}
+
+	void YumeSoftwareRenderer::SetDepthTest(CompareMode mode)
+	{
+		if(mode != depthTestMode_)
+		{
+			depthTestMode_ = mode;
+			depthStateDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetDepthWrite(bool enable)
+	{
+		if(enable != depthWrite_)
+		{
+			depthWrite_ = enable;
+			depthStateDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetFillMode(FillMode mode)
+	{
+		fillMode_ = mode;
+	}
+
+	void YumeSoftwareRenderer::SetScissorTest(bool enable,const Rect& rect,bool borderInclusive)
+	{
+		// During some light rendering loops, a full rect is toggled on/off repeatedly.
+		// Disable scissor in that case to reduce state changes
+		if(rect.min_.x_ <= 0.0f && rect.min_.y_ <= 0.0f && rect.max_.x_ >= 1.0f && rect.max_.y_ >= 1.0f)
+			enable = false;
+
+		if(enable)
+		{
+			IntVector2 rtSize(GetRenderTargetDimensions());
+			IntVector2 viewSize(viewport_.Size());
+			IntVector2 viewPos(viewport_.left_,viewport_.top_);
+			IntRect intRect;
+			int expand = borderInclusive ? 1 : 0;
+
+			intRect.left_ = Clamp((int)((rect.min_.x_ + 1.0f) * 0.5f * viewSize.x_) + viewPos.x_,0,rtSize.x_ - 1);
+			intRect.top_ = Clamp((int)((-rect.max_.y_ + 1.0f) * 0.5f * viewSize.y_) + viewPos.y_,0,rtSize.y_ - 1);
+			intRect.right_ = Clamp((int)((rect.max_.x_ + 1.0f) * 0.5f * viewSize.x_) + viewPos.x_ + expand,0,rtSize.x_);
+			intRect.bottom_ = Clamp((int)((-rect.min_.y_ + 1.0f) * 0.5f * viewSize.y_) + viewPos.y_ + expand,0,rtSize.y_);
+
+			if(intRect.right_ == intRect.left_)
+				intRect.right_++;
+			if(intRect.bottom_ == intRect.top_)
+				intRect.bottom_++;
+
+			if(intRect.right_ < intRect.left_ || intRect.bottom_ < intRect.top_)
+				enable = false;
+
+			if(enable && intRect != scissorRect_)
+			{
+				scissorRect_ = intRect;
+				scissorRectDirty_ = true;
+			}
+		}
+
+		if(enable != scissorTest_)
+		{
+			scissorTest_ = enable;
+			rasterizerStateDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetScissorTest(bool enable,const IntRect& rect)
+	{
+		IntVector2 rtSize(GetRenderTargetDimensions());
+		IntVector2 viewPos(viewport_.left_,viewport_.top_);
+
+		if(enable)
+		{
+			IntRect intRect;
+			intRect.left_ = Clamp(rect.left_ + viewPos.x_,0,rtSize.x_ - 1);
+			intRect.top_ = Clamp(rect.top_ + viewPos.y_,0,rtSize.y_ - 1);
+			intRect.right_ = Clamp(rect.right_ + viewPos.x_,0,rtSize.x_);
+			intRect.bottom_ = Clamp(rect.bottom_ + viewPos.y_,0,rtSize.y_);
+
+			if(intRect.right_ == intRect.left_)
+				intRect.right_++;
+			if(intRect.bottom_ == intRect.top_)
+				intRect.bottom_++;
+
+			if(intRect.right_ < intRect.left_ || intRect.bottom_ < intRect.top_)
+				enable = false;
+
+			if(enable && intRect != scissorRect_)
+			{
+				scissorRect_ = intRect;
+				scissorRectDirty_ = true;
+			}
+		}
+
+		if(enable != scissorTest_)
+		{
+			scissorTest_ = enable;
+			rasterizerStateDirty_ = true;
+		}
+	}
+
+	void YumeSoftwareRenderer::SetStencilTest(bool enable,CompareMode mode,StencilOp pass,StencilOp fail,StencilOp zFail,StencilOp zFailBack,unsigned stencilRef,
+		unsigned compareMask,unsigned writeMask)
+	{
+		if(enable != stencilTest_)
+		{
+			stencilTest_ = enable;
+			depthStateDirty_ = true;
+		}
+
+		if(enable)
+		{
+			if(mode != stencilTestMode_ || pass != stencilPass_ || fail != stencilFail_ || zFail != stencilZFail_ || zFailBack != stencilZFailBack_ ||
+				compareMask != stencilCompareMask_ || writeMask != stencilWriteMask_ || stencilRef != stencilRef_)
+			{
+				stencilTestMode_ = mode;
+				stencilPass_ = pass;
+				stencilFail_ = fail;
+				stencilZFail_ = zFail;
+				stencilZFailBack_ = zFailBack;
+				stencilCompareMask_ = compareMask;
+				stencilWriteMask_ = writeMask;
+				stencilRef_ = stencilRef;
+				depthStateDirty_ = true;
+			}
+		}
+	}
+
+	void YumeSoftwareRenderer::SetClipPlane(bool enable,const Plane& clipPlane,const Matrix3x4& view,const Matrix4& projection)
+	{
+		useClipPlane_ = enable;
+
+		//Not clipped against, the vertex callback gets the plane to do it itself
+		if(enable)
+		{
+			Matrix4 viewProj = projection * view;
+			clipPlane_ = clipPlane.Transformed(viewProj).ToVector4();
+			SetShaderParameter(VSP_CLIPPLANE,clipPlane_);
+		}
+	}
+
+	void YumeSoftwareRenderer::ClearParameterSource(ShaderParameterGroup group)
+	{
+		shaderParameterSources_[group] = (const void*)M_MAX_UNSIGNED;
+	}
+
+	void YumeSoftwareRenderer::ClearParameterSources()
+	{
+		for(unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
+			shaderParameterSources_[i] = (const void*)M_MAX_UNSIGNED;
+	}
+
+	void YumeSoftwareRenderer::ClearTransformSources()
+	{
+		shaderParameterSources_[SP_CAMERA] = (const void*)M_MAX_UNSIGNED;
+		shaderParameterSources_[SP_OBJECT] = (const void*)M_MAX_UNSIGNED;
+	}
+
+	YumeVertexBuffer* YumeSoftwareRenderer::CreateVertexBuffer()
+	{
+		return YumeAPINew YumeSoftwareVertexBuffer();
+	}
+
+	YumeIndexBuffer* YumeSoftwareRenderer::CreateIndexBuffer()
+	{
+		return YumeAPINew YumeSoftwareIndexBuffer();
+	}
+
+	YumeTexture2D* YumeSoftwareRenderer::CreateTexture2D()
+	{
+		return YumeAPINew YumeSoftwareTexture2D();
+	}
+
+	YumeTexture3D* YumeSoftwareRenderer::CreateTexture3D()
+	{
+		return YumeAPINew YumeSoftwareTexture3D();
+	}
+
+	YumeTextureCube* YumeSoftwareRenderer::CreateTextureCube()
+	{
+		return YumeAPINew YumeSoftwareTextureCube();
+	}
+
+	void YumeSoftwareRenderer::SetVertexBuffer(YumeVertexBuffer* buffer)
+	{
+		static YumeVector<YumeVertexBuffer*>::type vertexBuffers(1);
+		static YumeVector<unsigned>::type elementMasks(1);
+		vertexBuffers[0] = buffer;
+		elementMasks[0] = MASK_DEFAULT;
+		SetVertexBuffers(vertexBuffers,elementMasks);
+	}
+
+	bool YumeSoftwareRenderer::SetVertexBuffers(const YumeVector<YumeVertexBuffer*>::type& buffers,const YumeVector<unsigned>::type& elementMasks,unsigned instanceOffset)
+	{
+		if(buffers.size() > MAX_VERTEX_STREAMS)
+		{
+			YUMELOG_ERROR("Too many vertex buffers");
+			return false;
+		}
+		if(buffers.size() != elementMasks.size())
+		{
+			YUMELOG_ERROR("Amount of element masks and vertex buffers does not match");
+			return false;
+		}
+
+		for(unsigned i = 0; i < MAX_VERTEX_STREAMS; ++i)
+		{
+			YumeVertexBuffer* buffer = i < buffers.size() ? buffers[i] : 0;
+			if(buffer)
+			{
+				unsigned elementMask = buffer->GetElementMask() & elementMasks[i];
+				unsigned offset = (elementMask & MASK_INSTANCEMATRIX1) ? instanceOffset * buffer->GetVertexSize() : 0;
+
+				vertexBuffers_[i] = buffer;
+				elementMasks_[i] = elementMask;
+				vertexOffsets_[i] = offset;
+			}
+			else
+			{
+				vertexBuffers_[i] = 0;
+				elementMasks_[i] = 0;
+				vertexOffsets_[i] = 0;
+			}
+		}
+
+		vertexDeclarationDirty_ = true;
+		return true;
+	}
+
+	bool YumeSoftwareRenderer::SetVertexBuffers(const YumeVector<SharedPtr<YumeVertexBuffer> >::type& buffers,const YumeVector<unsigned>::type& elementMasks,unsigned instanceOffset)
+	{
+		YumeVector<YumeVertexBuffer*>::type rawBuffers(buffers.size());
+		for(unsigned i = 0; i < buffers.size(); ++i)
+			rawBuffers[i] = buffers[i];
+
+		return SetVertexBuffers(rawBuffers,elementMasks,instanceOffset);
+	}
+
+	void YumeSoftwareRenderer::SetIndexBuffer(YumeIndexBuffer* buffer)
+	{
+		indexBuffer_ = buffer;
+	}
+
+	bool YumeSoftwareRenderer::NeedParameterUpdate(ShaderParameterGroup group,const void* source)
+	{
+		if((unsigned)(size_t)shaderParameterSources_[group] == M_MAX_UNSIGNED || shaderParameterSources_[group] != source)
+		{
+			shaderParameterSources_[group] = source;
+			return true;
+		}
+		else
+			return false;
+	}
+
+	void YumeSoftwareRenderer::PreDraw()
+	{
+		if(renderTargetsDirty_)
+		{
+			SoftwareSurface* depthStencil = 0;
+			if(!noDs_)
+				depthStencil = depthStencil_ ? GetSoftwareSurface(depthStencil_) : &defaultDepthStencil_;
+
+			SoftwareSurface* surfaces[MAX_RENDERTARGETS];
+			for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+				surfaces[i] = GetSoftwareSurface(renderTargets_[i]);
+			// If rendertarget 0 is null and not doing depth-only rendering, render to the backbuffer
+			// Special case: if rendertarget 0 is null and depth stencil has same size as backbuffer, assume the intention is to do
+			// backbuffer rendering with a custom depth stencil
+			if(!renderTargets_[0] &&
+				(!depthStencil_ || (depthStencil_ && depthStencil_->GetWidth() == windowWidth_ && depthStencil_->GetHeight() == windowHeight_)))
+				surfaces[0] = &backbuffer_;
+
+			for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+				rasterizer_.SetRenderTarget(i,surfaces[i]);
+			rasterizer_.SetDepthStencil(depthStencil);
+
+			renderTargetsDirty_ = false;
+		}
+
+		if(texturesDirty_ && firstDirtyTexture_ < M_MAX_UNSIGNED)
+		{
+			for(unsigned i = firstDirtyTexture_; i <= lastDirtyTexture_; ++i)
+				constants_.textures_[i] = textures_[i];
+
+			firstDirtyTexture_ = lastDirtyTexture_ = M_MAX_UNSIGNED;
+			texturesDirty_ = false;
+		}
+
+		//Shadow data can move when a buffer is resized, so the pointers are taken every draw. Every stream
+		//goes to the rasterizer, Data and InstanceData are the first of each kind.
+		const unsigned char* vertexData = 0;
+		unsigned vertexSize = 0;
+		const unsigned char* instanceData = 0;
+		unsigned instanceSize = 0;
+
+		for(unsigned i = 0; i < MAX_VERTEX_STREAMS; ++i)
+		{
+			YumeVertexBuffer* buffer = vertexBuffers_[i];
+			if(!buffer || !buffer->GetShadowData())
+			{
+				if(buffer)
+					YUMELOG_ERROR("Vertex buffer bound to stream " << i << " has no shadow data, the Software renderer can not read it");
+				rasterizer_.SetVertexStream(i,0,0,false);
+				continue;
+			}
+
+			bool perInstance = (elementMasks_[i] & MASK_INSTANCEMATRIX1) != 0;
+			const unsigned char* data = buffer->GetShadowData() + vertexOffsets_[i];
+			rasterizer_.SetVertexStream(i,data,buffer->GetVertexSize(),perInstance);
+
+			if(perInstance)
+			{
+				if(!instanceData)
+				{
+					instanceData = data;
+					instanceSize = buffer->GetVertexSize();
+				}
+			}
+			else if(!vertexData)
+			{
+				vertexData = data;
+				vertexSize = buffer->GetVertexSize();
+			}
+		}
+
+		rasterizer_.SetVertexData(vertexData,vertexSize);
+		rasterizer_.SetInstanceData(instanceData,instanceSize);
+		vertexDeclarationDirty_ = false;
+
+		if(blendStateDirty_)
+		{
+			//No blend state binds the default one once, like a null blend state on the device
+			rasterizer_.SetBlendMode(noBlendState_ ? BLEND_REPLACE : blendMode_);
+			rasterizer_.SetColorWrite(colorWrite_);
+			noBlendState_ = false;
+			blendStateDirty_ = false;
+		}
+
+		if(depthStateDirty_)
+		{
+			rasterizer_.SetDepthTest(depthEnable_ ? depthTestMode_ : CMP_ALWAYS);
+			rasterizer_.SetDepthWrite(depthEnable_ && depthWrite_);
+			rasterizer_.SetStencilTest(stencilTest_,stencilTestMode_,stencilPass_,stencilFail_,stencilZFail_,stencilZFailBack_,stencilRef_,
+				stencilCompareMask_,stencilWriteMask_);
+			depthStateDirty_ = false;
+			stencilRefDirty_ = false;
+		}
+
+		if(rasterizerStateDirty_ || scissorRectDirty_)
+		{
+			rasterizer_.SetCullMode(cullMode_);
+			rasterizer_.SetScissorTest(scissorTest_,scissorRect_);
+			rasterizerStateDirty_ = false;
+			scissorRectDirty_ = false;
+		}
+	}
+
+	void YumeSoftwareRenderer::Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount)
+	{
+		if(!vertexCount || !vertexShader_)
+			return;
+
+		PreDraw();
+
+		if(fillMode_ == FILL_POINT)
+			type = POINT_LIST;
+
+		rasterizer_.Draw(type,vertexStart,vertexCount);
+
+		numPrimitives_ += GetPrimitiveCount(vertexCount,type);
+		++numBatches_;
+	}
+
+	void YumeSoftwareRenderer::Draw(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount)
+	{
+		if(!vertexCount || !vertexShader_ || !indexBuffer_ || !indexBuffer_->GetShadowData())
+			return;
+
+		PreDraw();
+
+		if(fillMode_ == FILL_POINT)
+			type = POINT_LIST;
+
+		rasterizer_.SetIndexData(indexBuffer_->GetShadowData(),indexBuffer_->GetIndexSize());
+		rasterizer_.DrawIndexed(type,indexStart,indexCount);
+
+		numPrimitives_ += GetPrimitiveCount(indexCount,type);
+		++numBatches_;
+	}
+
+	void YumeSoftwareRenderer::DrawInstanced(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount,
+		unsigned instanceCount)
+	{
+		if(!indexCount || !instanceCount || !vertexShader_ || !indexBuffer_ || !indexBuffer_->GetShadowData())
+			return;
+
+		PreDraw();
+
+		if(fillMode_ == FILL_POINT)
+			type = POINT_LIST;
+
+		rasterizer_.SetIndexData(indexBuffer_->GetShadowData(),indexBuffer_->GetIndexSize());
+		rasterizer_.DrawIndexed(type,indexStart,indexCount,instanceCount);
+
+		numPrimitives_ += instanceCount * GetPrimitiveCount(indexCount,type);
+		++numBatches_;
+	}
+
+	void YumeSoftwareRenderer::DrawFullscreen()
+	{
+		if(!pixelShader_)
+			return;
+
+		PreDraw();
+
+		rasterizer_.DrawFullscreen();
+
+		++numPrimitives_;
+		++numBatches_;
+	}
+
+	bool YumeSoftwareRenderer::ResolveToTexture(YumeTexture2D* destination,const IntRect& viewport)
+	{
+		if(!destination || !destination->GetRenderSurface())
+			return false;
+
+		SoftwareSurface* dest = static_cast<YumeSoftwareTexture2D*>(destination)->GetSurface();
+		if(!dest || dest->IsDepthStencil())
+			return false;
+
+		IntRect vpCopy = viewport;
+		if(vpCopy.right_ <= vpCopy.left_)
+			vpCopy.right_ = vpCopy.left_ + 1;
+		if(vpCopy.bottom_ <= vpCopy.top_)
+			vpCopy.bottom_ = vpCopy.top_ + 1;
+
+		int left = Clamp(vpCopy.left_,0,windowWidth_);
+		int top = Clamp(vpCopy.top_,0,windowHeight_);
+		int right = Min(Clamp(vpCopy.right_,0,windowWidth_),left + dest->GetWidth());
+		int bottom = Min(Clamp(vpCopy.bottom_,0,windowHeight_),top + dest->GetHeight());
+
+		//Copied to the top left of the destination like CopySubresourceRegion
+		for(int y = top; y < bottom; ++y)
+		{
+			for(int x = left; x < right; ++x)
+				dest->SetPixel(x - left,y - top,backbuffer_.GetPixel(x,y));
+		}
+
+		return true;
+	}
+
+	unsigned YumeSoftwareRenderer::GetFormat(CompressedFormat format) const
+	{
+		//Compressed images are decompressed when they are uploaded
+		return format == CF_RGBA ? SWFMT_RGBA8 : 0;
+	}
+
+	void YumeSoftwareRenderer::AddGpuResource(YumeGpuResource* gpuRes)
+	{
+		MutexLock lock(gpuResourceMutex_);
+
+		gpuResources_.push_back(gpuRes);
+	}
+
+	void YumeSoftwareRenderer::RemoveGpuResource(YumeGpuResource* gpuRes)
+	{
+		MutexLock lock(gpuResourceMutex_);
+
+		//Check if valid
+		GpuResourceVector::iterator It = gpuResources_.find(gpuRes);
+
+		if(It != gpuResources_.end())
+			gpuResources_.erase(It);
+	}
+
+	void YumeSoftwareRenderer::RegisterFactories()
+	{
+		gYume->pObjFactory->RegisterFactoryFunction(("Texture2D"),[this](void) -> YumeBase * { return new YumeSoftwareTexture2D();});
+		gYume->pObjFactory->RegisterFactoryFunction(("Texture3D"),[this](void) -> YumeBase * { return new YumeSoftwareTexture3D();});
+		gYume->pObjFactory->RegisterFactoryFunction(("TextureCube"),[this](void) -> YumeBase * { return new YumeSoftwareTextureCube();});
+		gYume->pObjFactory->RegisterFactoryFunction(("IndexBuffer"),[this](void) -> YumeBase * { return new YumeSoftwareIndexBuffer();});
+		gYume->pObjFactory->RegisterFactoryFunction(("VertexBuffer"),[this](void) -> YumeBase * { return new YumeSoftwareVertexBuffer();});
+	}
+
+	void YumeSoftwareRenderer::UnregisterFactories()
+	{
+		gYume->pObjFactory->UnRegisterFactoryFunction(("Texture2D"));
+		gYume->pObjFactory->UnRegisterFactoryFunction(("Texture3D"));
+		gYume->pObjFactory->UnRegisterFactoryFunction(("TextureCube"));
+		gYume->pObjFactory->UnRegisterFactoryFunction(("IndexBuffer"));
+		gYume->pObjFactory->UnRegisterFactoryFunction(("VertexBuffer"));
+	}
+}
@@ -0,0 +1,269 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareRenderer.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareRenderer_h__
+#define __YumeSoftwareRenderer_h__
+//----------------------------------------------------------------------------
+#include "YumeSoftwareRequired.h"
+#include "Renderer/YumeRendererDefs.h"
+
+#include "Math/YumeRect.h"
+#include "Math/YumeColor.h"
+#include "Math/YumeVector2.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeVector4.h"
+#include "Math/YumeMatrix4.h"
+
+#include "Math/YumeMatrix3x4.h"
+
+#include "Renderer/YumeRHI.h"
+#include "Renderer/SoftwareRasterizer.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class YumeGpuResource;
+	class YumeShaderVariation;
+	class YumeSoftwareShaderVariation;
+	class YumeTexture;
+	class YumeTexture2D;
+	class YumeTexture3D;
+	class YumeTextureCube;
+
+	//What the software renderer hands the shader callbacks as their constants. Parameters are kept as the
+	//floats they were set with, a Matrix3 as three rows padded to float4 like a constant buffer.
+	class YumeSoftwareExport SoftwareShaderConstants
+	{
+	public:
+		SoftwareShaderConstants();
+
+		//Null when the parameter was not set or has fewer floats than count
+		const float* GetParameter(YumeHash param,unsigned count = 1) const;
+		float GetFloat(YumeHash param,float defaultValue = 0.0f) const;
+		//Missing components read as 0
+		Vector4 GetVector4(YumeHash param) const;
+		//A Matrix3x4 parameter reads as its Matrix4, anything else not set as identity
+		Matrix4 GetMatrix4(YumeHash param) const;
+
+		YumeTexture* GetTexture(unsigned unit) const { return unit < MAX_TEXTURE_UNITS ? textures_[unit] : 0; }
+		//The first slice or face of the texture on the unit
+		const SoftwareSurface* GetSurface(unsigned unit) const;
+		//Bilinear and clamped, black when nothing is bound
+		Vector4 Sample(unsigned unit,const Vector2& uv) const;
+
+	private:
+		friend class YumeSoftwareRenderer;
+
+		YumeMap<YumeHash,YumePodVector<float>::type>::type parameters_;
+		YumeTexture* textures_[MAX_TEXTURE_UNITS];
+	};
+
+	typedef YumeMap<YumeString,SharedPtr<YumeSoftwareShaderVariation> > SoftwareShaderMap;
+
+	//RHI that renders on the CPU through SoftwareRasterizer, for headless runs and pixel exact tests of the
+	//pipeline without a GPU. There is no window, the backbuffer is a SoftwareSurface of the graphics mode's size.
+	//Shaders are C++ callbacks registered under the name and entry point GetShader is called with, defines are
+	//ignored. Draws execute immediately, tile parallel, and give the same pixels for any thread count.
+	class YumeSoftwareExport YumeSoftwareRenderer : public YumeRHI
+	{
+	public:
+		YumeSoftwareRenderer();
+		virtual ~YumeSoftwareRenderer();
+
+		virtual bool							SetGraphicsMode(int width,int height,bool fullscreen,bool borderless,bool resizable,bool vsync,bool tripleBuffer,int multiSample);
+
+		virtual bool							BeginFrame();
+		virtual void							EndFrame();
+		virtual void							Clear(unsigned flags,const YumeColor& color = YumeColor(0.0f,0.0f,0.0f,0.0f),float depth = 1.0f,unsigned stencil = 0);
+		virtual void							ClearRenderTarget(unsigned index,unsigned flags,const YumeColor& color = YumeColor(0.0f,0.0f,0.0f,0.0f),float depth = 1.0f,unsigned stencil = 0);
+		virtual void							ClearDepthStencil(unsigned flags,float depth,unsigned stencil);
+		virtual bool							IsInitialized() { return initialized_; }
+
+		/* Software Only */
+		void									RegisterVertexShader(const YumeString& name,const YumeString& entryPoint,SoftwareVertexShader shader,unsigned numVaryings);
+		void									RegisterPixelShader(const YumeString& name,const YumeString& entryPoint,SoftwarePixelShader shader);
+		//Callbacks for the engine shaders a deferred frame of YumeMiscRenderer draws with, the G-buffer fill,
+		//fs_triangle, the copy and the directional light. Registered on construction, before render paths load.
+		void									RegisterEngineShaders();
+		//0 uses every hardware thread
+		void									SetNumThreads(unsigned threads) { rasterizer_.SetNumThreads(threads); }
+		//The pixel shader over the viewport with no vertices, depth or stencil
+		void									DrawFullscreen();
+		SoftwareSurface&						GetBackbuffer() { return backbuffer_; }
+		SoftwareRasterizer&						GetRasterizer() { return rasterizer_; }
+		/* */
+
+		virtual void							PSBindSRV(unsigned start,unsigned count,const YumeVector<YumeTexture*>::type& textures);
+		virtual void							VSBindSRV(unsigned start,unsigned count,YumeTexture** textures);
+		virtual void							BindBackbuffer();
+		virtual void							BindResetRenderTargets(int count);
+		virtual void							BindResetTextures(int start,int count,bool ps = false);
+		virtual void							BindPsuedoBuffer();
+		virtual void							BindNullIndexBuffer();
+		virtual void							BindDefaultDepthStencil();
+		virtual void							BindNullBlendState();
+		virtual void							BindDepthStateEnable();
+		virtual void							BindDepthStateDisable();
+		//Textures are sampled bilinear and clamped whatever the sampler, so there is nothing to create
+		virtual unsigned						CreateSamplerState(const SamplerStateDesc& sampler) { return 0; }
+
+		virtual IntVector2						GetRenderTargetDimensions() const;
+		virtual void							CreateRendererCapabilities();
+		virtual YumeVector<int>::type			GetMultiSampleLevels() const;
+
+
+		virtual void							Close();
+		virtual void							AdjustWindow(int& newWidth,int& newHeight,bool& newFullscreen,bool& newBorderless) { }
+		virtual void							Maximize() { }
+		virtual void 							SetWindowPos(const Vector2& pos);
+		virtual void							SetWindowTitle(const YumeString& string);
+
+		virtual void							AddGpuResource(YumeGpuResource* object);
+		virtual void							RemoveGpuResource(YumeGpuResource* object);
+
+
+		virtual YumeConstantBuffer*				GetOrCreateConstantBuffer(ShaderType type,unsigned index,unsigned size) { return 0; }
+		virtual YumeConstantBuffer*				GetOrCreateConstantBuffer(unsigned bindingIndex,unsigned size) { return 0; }
+
+		virtual void							ResetCache();
+
+		virtual bool							IsDeviceLost() const { return false; }
+
+
+		virtual YumeVertexBuffer*				CreateVertexBuffer();
+		virtual YumeIndexBuffer* 				CreateIndexBuffer();
+		virtual YumeTexture2D*					CreateTexture2D();
+		virtual YumeTexture3D*					CreateTexture3D();
+		virtual YumeTextureCube*				CreateTextureCube();
+		//Vertex layouts are whatever the vertex callback reads
+		virtual YumeInputLayout* 				CreateInputLayout(YumeShaderVariation* vertexShader,YumeVertexBuffer** buffers,unsigned* elementMasks) { return 0; }
+
+
+		virtual YumeShaderVariation* 			GetShader(ShaderType type,const YumeString& name,const YumeString& defines = "",const YumeString& entryPoint = "") const;
+		virtual YumeShaderVariation* 			GetShader(ShaderType type,const char* name,const char* defines,const YumeString& entryPoint = "") const;
+
+		virtual unsigned						GetFormat(CompressedFormat format) const;
+
+		//The geometry shader is ignored
+		virtual void						    SetShaders(YumeShaderVariation* vs,YumeShaderVariation* ps,YumeShaderVariation* gs = 0);
+
+
+		virtual bool							HasShaderParameter(YumeHash param);
+		virtual void  							SetShaderParameter(YumeHash param,const float* data,unsigned count);
+		virtual void  							SetShaderParameter(YumeHash param,float value);
+		virtual void  							SetShaderParameter(YumeHash param,bool value);
+		virtual void  							SetShaderParameter(YumeHash param,const YumeColor& color);
+		virtual void  							SetShaderParameter(YumeHash param,const Vector2& vector);
+		virtual void  							SetShaderParameter(YumeHash param,const Matrix3& matrix);
+		virtual void  							SetShaderParameter(YumeHash param,const Matrix3x4& matrix);
+		virtual void  							SetShaderParameter(YumeHash param,const Vector3& vector);
+		virtual void  							SetShaderParameter(YumeHash param,const Matrix4& matrix);
+		virtual void  							SetShaderParameter(YumeHash param,const Vector4& vector);
+		virtual void  							SetShaderParameter(YumeHash param,const Variant& value);
+		virtual void  							SetShaderParameter(YumeHash param,const Vector4Vector::type& vectorArray);
+
+#ifdef _WIN32
+		virtual void  							SetShaderParameter(YumeHash param,const DirectX::XMMATRIX& matrix);
+		virtual void  							SetShaderParameter(YumeHash param,const DirectX::XMFLOAT3& vector);
+		virtual void  							SetShaderParameter(YumeHash param,const DirectX::XMFLOAT4& vector);
+#endif
+
+		virtual void  							SetVertexBuffer(YumeVertexBuffer* buffer);
+		virtual void  							SetIndexBuffer(YumeIndexBuffer* buffer);
+		virtual bool  							SetVertexBuffers(const YumeVector<YumeVertexBuffer*>::type& buffers,const YumeVector<unsigned>::type& elementMasks,unsigned instanceOffset = 0);
+		virtual bool  							SetVertexBuffers(const YumeVector<SharedPtr<YumeVertexBuffer> >::type& buffers,const YumeVector<unsigned>::type& elementMasks,unsigned instanceOffset = 0);
+
+		virtual bool							NeedParameterUpdate(ShaderParameterGroup group,const void* source);
+		virtual void							SetFlushGPU(bool flushGpu) { flushGpu_ = flushGpu; }
+		virtual void  							SetBlendMode(BlendMode mode);
+		virtual void  							SetColorWrite(bool enable);
+		virtual void  							SetCullMode(CullMode mode);
+		//Depth bias and fill modes other than points are stored but not rasterized
+		virtual void  							SetDepthBias(float constantBias,float slopeScaledBias);
+		virtual void  							SetDepthTest(CompareMode mode);
+		virtual void  							SetDepthWrite(bool enable);
+		virtual void  							SetFillMode(FillMode mode);
+		virtual void  							SetScissorTest(bool enable,const Rect& rect = Rect::FULL,bool borderInclusive = true);
+		virtual void  							SetScissorTest(bool enable,const IntRect& rect);
+		virtual void  							SetStencilTest(bool enable,CompareMode mode = CMP_ALWAYS,StencilOp pass = OP_KEEP,StencilOp fail = OP_KEEP,StencilOp zFail = OP_KEEP,StencilOp zFailBack = OP_KEEP,unsigned stencilRef = 0,unsigned compareMask = M_MAX_UNSIGNED,unsigned writeMask = M_MAX_UNSIGNED);
+
+
+		virtual void  							SetClipPlane(bool enable,const Plane& clipPlane,const Matrix3x4& view,const Matrix4& projection);
+		virtual void  							SetTexture(unsigned index,YumeTexture* texture);
+
+		virtual void 							SetRenderTarget(unsigned index,YumeRenderable* renderTarget);
+		virtual void 							SetDepthStencil(YumeRenderable* depthStencil);
+		virtual void 							SetDepthStencil(YumeTexture2D* texture);
+
+		virtual void 							SetViewport(const IntRect& rect);
+
+		void									PreDraw();
+		virtual void 							Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount);
+		virtual void 							Draw(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount);
+		virtual void 							DrawInstanced(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount,unsigned instanceCount);
+		virtual bool							ResolveToTexture(YumeTexture2D* destination,const IntRect& viewport);
+		virtual void							ClearParameterSource(ShaderParameterGroup group);
+		virtual void							ClearParameterSources();
+		virtual void							ClearTransformSources();
+		virtual void 							CleanupShaderPrograms(YumeShaderVariation* variation) { }
+
+		virtual const Vector2&					GetPixelUVOffset() { return pixelUVOffset; }
+		virtual bool							GetGL3SupportNs() { return false; }
+		virtual unsigned						GetOpenGLOnlyTextureDataType(unsigned format) { return 0; };
+
+		//Non-static version
+		unsigned								GetAlphaFormatNs() { return SWFMT_A8; }
+		unsigned								GetLuminanceFormatNs() { return SWFMT_R8; }
+		unsigned								GetLuminanceAlphaFormatNs() { return SWFMT_RG8; }
+		unsigned								GetRGBFormatNs() { return SWFMT_RGBA8; }
+		unsigned								GetRGBAFormatNs() { return SWFMT_RGBA8; }
+		unsigned								GetBGRAFormatNs() { return SWFMT_BGRA8; }
+		unsigned								GetRGBA16FormatNs() { return SWFMT_RGBA16; }
+		unsigned								GetRGBAFloat16FormatNs() { return SWFMT_RGBA16F; }
+		unsigned								GetRGBAFloat32FormatNs() { return SWFMT_RGBA32F; }
+		unsigned								GetRG16FormatNs() { return SWFMT_RG16; }
+		unsigned								GetRGFloat16FormatNs() { return SWFMT_RG16F; }
+		unsigned								GetRGFloat32FormatNs() { return SWFMT_RG32F; }
+		unsigned								GetFloat16FormatNs() { return SWFMT_R16F; }
+		unsigned								GetFloat32FormatNs() { return SWFMT_R32F; }
+		unsigned								GetLinearDepthFormatNs() { return SWFMT_R32F; }
+		unsigned								GetDepthStencilFormatNs() { return SWFMT_R24G8_TYPELESS; }
+		unsigned								GetReadableDepthFormatNs() { return SWFMT_R24G8_TYPELESS; }
+	private:
+		void RegisterFactories();
+		void UnregisterFactories();
+		void SetParameterData(YumeHash param,const float* data,unsigned count);
+		YumeSoftwareShaderVariation* GetOrCreateShader(ShaderType type,const YumeString& name,const YumeString& entryPoint);
+	private:
+		bool									initialized_;
+
+		SoftwareRasterizer						rasterizer_;
+		SoftwareShaderConstants					constants_;
+		SoftwareSurface							backbuffer_;
+		SoftwareSurface							defaultDepthStencil_;
+		SoftwareShaderMap::type					shaders_;
+
+		unsigned								vertexOffsets_[MAX_VERTEX_STREAMS];
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
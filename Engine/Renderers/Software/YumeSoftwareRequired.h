@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareRequired.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareRequired_h__
+#define __YumeSoftwareRequired_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector4.h"
+
+#	if YUME_PLATFORM == YUME_PLATFORM_WIN32
+#		if defined(BUILDING_YUME_SOFTWARE)
+#			define YumeSoftwareExport __declspec( dllexport )
+#		else
+#			define YumeSoftwareExport __declspec( dllimport )
+#		endif
+#	else
+#	define YumeSoftwareExport
+#	endif
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class SoftwareSurface;
+
+	//Texture formats are the DXGI numbers, so format ids the pipeline and the D3D11 backend hard code mean the same here
+	enum SoftwareFormat
+	{
+		SWFMT_UNKNOWN = 0,
+		SWFMT_RGBA32F = 2,
+		SWFMT_RGBA16F = 10,
+		SWFMT_RGBA16 = 11,
+		SWFMT_RG32F = 16,
+		SWFMT_RGB10A2 = 24,
+		SWFMT_RGBA8 = 28,
+		SWFMT_RG16F = 34,
+		SWFMT_RG16 = 35,
+		SWFMT_R32_TYPELESS = 39,
+		SWFMT_R32F = 41,
+		SWFMT_R24G8_TYPELESS = 44,
+		SWFMT_D24S8 = 45,
+		SWFMT_RG8 = 49,
+		SWFMT_R16_TYPELESS = 53,
+		SWFMT_R16F = 54,
+		SWFMT_R16 = 56,
+		SWFMT_R8 = 61,
+		SWFMT_A8 = 65,
+		SWFMT_BGRA8 = 87
+	};
+
+	//Bytes a texel of the format takes, 0 for the ones the software backend does not know
+	YumeSoftwareExport unsigned GetSoftwareFormatSize(unsigned format);
+	//Typeless depth formats, these are depth stencil surfaces when used as a target
+	YumeSoftwareExport bool IsSoftwareDepthFormat(unsigned format);
+	//Formats that clamp what is written to 0-1
+	YumeSoftwareExport bool IsSoftwareNormalizedFormat(unsigned format);
+	//Texel bytes to the float RGBA the surfaces hold, missing channels read as 0 and alpha as 1 like a sampler
+	YumeSoftwareExport Vector4 DecodeSoftwareTexel(unsigned format,const unsigned char* src);
+	YumeSoftwareExport void EncodeSoftwareTexel(unsigned format,const Vector4& color,unsigned char* dest);
+	//Texel rows in the format into a rectangle of the surface, a depth surface takes depth from x and stencil from y
+	YumeSoftwareExport void WriteSoftwareSurface(SoftwareSurface& surface,unsigned format,int x,int y,int width,int height,const void* data);
+	//The whole surface as texel rows in the format. Levels past the first are filtered down from it, only the top level is stored.
+	YumeSoftwareExport void ReadSoftwareSurface(const SoftwareSurface& surface,unsigned format,unsigned level,void* dest);
+}
+
+
+//----------------------------------------------------------------------------
+#endif
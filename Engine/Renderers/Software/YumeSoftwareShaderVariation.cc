@@ -0,0 +1,57 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareShaderVariation.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeSoftwareShaderVariation.h"
+
+
+namespace YumeEngine
+{
+	YumeSoftwareShaderVariation::YumeSoftwareShaderVariation(ShaderType type,const YumeString& name,const YumeString& entryPoint)
+		: entryPoint_(entryPoint),
+		vertexShader_(0),
+		pixelShader_(0),
+		numVaryings_(0)
+	{
+		owner_ = 0;
+		type_ = type;
+		name_ = name;
+
+		for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+			useTextureUnit_[i] = true;
+	}
+
+	YumeSoftwareShaderVariation::~YumeSoftwareShaderVariation()
+	{
+	}
+
+	bool YumeSoftwareShaderVariation::Create()
+	{
+		return type_ == VS ? vertexShader_ != 0 : pixelShader_ != 0;
+	}
+
+	const unsigned* YumeSoftwareShaderVariation::GetConstantBufferSizes() const
+	{
+		//Parameters live on the renderer, there are no constant buffers to size
+		static const unsigned sizes[MAX_SHADER_PARAMETER_GROUPS] = { 0 };
+		return sizes;
+	}
+}
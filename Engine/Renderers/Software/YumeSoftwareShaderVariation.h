@@ -0,0 +1,64 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareShaderVariation.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareShaderVariation_h__
+#define __YumeSoftwareShaderVariation_h__
+//----------------------------------------------------------------------------
+#include "YumeSoftwareRequired.h"
+
+#include "Renderer/YumeRendererDefs.h"
+#include "Renderer/YumeShaderVariation.h"
+#include "Renderer/SoftwareRasterizer.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Vertex or pixel shader of the software backend. There is nothing to compile, the variation is the C++
+	//callback registered on the renderer under the name and entry point the pipeline asks for.
+	class YumeSoftwareExport YumeSoftwareShaderVariation : public YumeShaderVariation
+	{
+	public:
+		YumeSoftwareShaderVariation(ShaderType type,const YumeString& name,const YumeString& entryPoint);
+		virtual ~YumeSoftwareShaderVariation();
+
+		virtual bool Create();
+
+		const unsigned* GetConstantBufferSizes() const;
+
+		void SetVertexShader(SoftwareVertexShader shader,unsigned numVaryings) { vertexShader_ = shader; numVaryings_ = numVaryings; }
+		void SetPixelShader(SoftwarePixelShader shader) { pixelShader_ = shader; }
+
+		SoftwareVertexShader GetVertexShader() const { return vertexShader_; }
+		SoftwarePixelShader GetPixelShader() const { return pixelShader_; }
+		unsigned GetNumVaryings() const { return numVaryings_; }
+		const YumeString& GetEntryPoint() const { return entryPoint_; }
+
+	private:
+		YumeString entryPoint_;
+
+		SoftwareVertexShader vertexShader_;
+		SoftwarePixelShader pixelShader_;
+		unsigned numVaryings_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,264 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareShaders.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeRequired.h"
+#include "YumeSoftwareRenderer.h"
+
+#include "Math/YumeMath.h"
+
+
+namespace YumeEngine
+{
+	static const YumeHash PARAM_VP("vp");
+	static const YumeHash PARAM_VP_INV("vp_inv");
+	static const YumeHash PARAM_CAMERA_POS("camera_pos");
+	static const YumeHash PARAM_WORLD("world");
+	static const YumeHash PARAM_RESOLUTION_SCALE("resolution_scale");
+	static const YumeHash PARAM_DIFFUSE_COLOR("DiffuseColor");
+	static const YumeHash PARAM_SPECULAR_COLOR("SpecularColor");
+	static const YumeHash PARAM_EMISSIVE_COLOR("EmissiveColor");
+	static const YumeHash PARAM_HAS_DIFFUSE_TEX("has_diffuse_tex");
+	static const YumeHash PARAM_SHADING_MODE("ShadingMode");
+	static const YumeHash PARAM_ROUGHNESS("Roughness");
+	static const YumeHash PARAM_MAIN_LIGHT("main_light");
+	static const YumeHash PARAM_LIGHT_DIRECTION("LightDirection");
+	static const YumeHash PARAM_LIGHT_POSITION("LightPosition");
+	static const YumeHash PARAM_LIGHT_COLOR("LightColor");
+	static const YumeHash PARAM_VOLUME_TRANSFORM("volume_transform");
+
+	//Same as common.h
+	static const float SHADER_GAMMA = 2.2f;
+
+	static const unsigned GBUFFER_COLORS = 2;
+	static const unsigned GBUFFER_NORMALS = 4;
+	static const unsigned GBUFFER_LINEARDEPTH = 5;
+
+	static const SoftwareShaderConstants* GetConstants(const void* constants)
+	{
+		return static_cast<const SoftwareShaderConstants*>(constants);
+	}
+
+	//The renderer sets its matrices as XMMATRIX, which mul(m, v) in the shaders reads transposed
+	static Vector4 Mul(const SoftwareShaderConstants* constants,YumeHash param,const Vector4& v)
+	{
+		return constants->GetMatrix4(param).Transpose() * v;
+	}
+
+	//Texture.Load, the texel under the pixel
+	static Vector4 Load(const SoftwareShaderConstants* constants,unsigned unit,const SoftwarePixel& pixel)
+	{
+		const SoftwareSurface* surface = constants->GetSurface(unit);
+		return surface ? surface->Load(pixel.X,pixel.Y) : Vector4::ZERO;
+	}
+
+	static Vector3 ReadFloat3(const unsigned char* data,unsigned offset)
+	{
+		const float* v = reinterpret_cast<const float*>(data + offset);
+		return Vector3(v[0],v[1],v[2]);
+	}
+
+	//DeferredSolid MeshVs. The vertex is VS_MESH_INPUT: position, normal, texcoord and tangent.
+	//Varyings are the world normal, the texcoord and the camera to vertex vector.
+	static void DeferredSolidVS(const SoftwareVertexInput& input,const void* constants,SoftwareVertex& output)
+	{
+		const SoftwareShaderConstants* c = GetConstants(constants);
+
+		Vector3 position = ReadFloat3(input.Data,0);
+		Vector3 normal = ReadFloat3(input.Data,3 * sizeof(float));
+		const float* texcoord = reinterpret_cast<const float*>(input.Data + 6 * sizeof(float));
+
+		Vector4 worldPos = Mul(c,PARAM_WORLD,Vector4(position,1.0f));
+		Vector4 worldNormal = Mul(c,PARAM_WORLD,Vector4(normal,0.0f));
+		Vector3 n = Vector3(worldNormal.x_,worldNormal.y_,worldNormal.z_).Normalized();
+		Vector4 cameraPos = c->GetVector4(PARAM_CAMERA_POS);
+
+		output.Position = Mul(c,PARAM_VP,worldPos);
+		output.Varyings[0] = n.x_;
+		output.Varyings[1] = n.y_;
+		output.Varyings[2] = n.z_;
+		output.Varyings[3] = texcoord[0];
+		output.Varyings[4] = texcoord[1];
+		output.Varyings[5] = worldPos.x_ - cameraPos.x_;
+		output.Varyings[6] = worldPos.y_ - cameraPos.y_;
+		output.Varyings[7] = worldPos.z_ - cameraPos.z_;
+	}
+
+	//DeferredSolid MeshPs without the normal, specular, alpha and roughness maps
+	static bool DeferredSolidPS(const SoftwarePixel& pixel,const void* constants,Vector4* colors)
+	{
+		const SoftwareShaderConstants* c = GetConstants(constants);
+
+		Vector3 normal = Vector3(pixel.Varyings[0],pixel.Varyings[1],pixel.Varyings[2]).Normalized();
+		Vector2 texcoord(pixel.Varyings[3],pixel.Varyings[4]);
+		float z = Vector3(pixel.Varyings[5],pixel.Varyings[6],pixel.Varyings[7]).Length();
+
+		Vector4 color;
+		bool hasDiffuseTex = c->GetFloat(PARAM_HAS_DIFFUSE_TEX) != 0.0f;
+		if(hasDiffuseTex)
+		{
+			Vector4 sample = c->Sample(0,texcoord);
+			color = Vector4(powf(Abs(sample.x_),SHADER_GAMMA),powf(Abs(sample.y_),SHADER_GAMMA),powf(Abs(sample.z_),SHADER_GAMMA),
+				powf(Abs(sample.w_),SHADER_GAMMA));
+		}
+		else
+			color = c->GetVector4(PARAM_DIFFUSE_COLOR);
+
+		Vector4 emissive = c->GetVector4(PARAM_EMISSIVE_COLOR);
+		if(Vector3(emissive.x_,emissive.y_,emissive.z_).Length() > 0.0f)
+			color = hasDiffuseTex ? color * emissive : color + emissive;
+
+		Vector4 specular = c->GetVector4(PARAM_SPECULAR_COLOR);
+		specular.w_ = c->GetFloat(PARAM_ROUGHNESS,1.0f);
+
+		colors[0] = color;
+		colors[1] = Vector4(normal * 0.5f + Vector3(0.5f,0.5f,0.5f),c->GetFloat(PARAM_SHADING_MODE) / 2.0f);
+		colors[2] = Vector4(z,z * z,0.0f,0.0f);
+		colors[3] = specular;
+		return true;
+	}
+
+	//fs_triangle_vs of LPV/fs_triangle and NoShadows/FsTriangle. Varyings are the texcoord, scaled to the
+	//rendered part of the target, and the view ray.
+	static void FsTriangleVS(const SoftwareVertexInput& input,const void* constants,SoftwareVertex& output)
+	{
+		const SoftwareShaderConstants* c = GetConstants(constants);
+
+		Vector4 position(ReadFloat3(input.Data,0),1.0f);
+		float scale = c->GetFloat(PARAM_RESOLUTION_SCALE);
+		if(scale <= 0.0f)
+			scale = 1.0f;
+
+		Vector4 viewRay = Mul(c,PARAM_VP_INV,position);
+
+		output.Position = position;
+		output.Varyings[0] = (position.x_ * 0.5f + 0.5f) * scale;
+		output.Varyings[1] = (position.y_ * -0.5f + 0.5f) * scale;
+		output.Varyings[2] = viewRay.x_;
+		output.Varyings[3] = viewRay.y_;
+		output.Varyings[4] = viewRay.z_;
+	}
+
+	//Copy ps_copy
+	static bool CopyPS(const SoftwarePixel& pixel,const void* constants,Vector4* colors)
+	{
+		colors[0] = GetConstants(constants)->Sample(0,Vector2(pixel.Varyings[0],pixel.Varyings[1]));
+		return true;
+	}
+
+	//NoShadows/DeferredLightPS ps_df_pbr with the brdf reduced to its Lambert term
+	static bool DeferredDirectionalLightPS(const SoftwarePixel& pixel,const void* constants,Vector4* colors)
+	{
+		const SoftwareShaderConstants* c = GetConstants(constants);
+
+		Vector2 texcoord(pixel.Varyings[0],pixel.Varyings[1]);
+		Vector4 albedo = c->Sample(GBUFFER_COLORS,texcoord);
+		Vector4 packedNormal = c->Sample(GBUFFER_NORMALS,texcoord);
+
+		//main_light is position, direction and color
+		const float* mainLight = c->GetParameter(PARAM_MAIN_LIGHT,12);
+		Vector3 lightColor = mainLight ? Vector3(mainLight[8],mainLight[9],mainLight[10]) : Vector3::ONE;
+
+		if(packedNormal.DotProduct(packedNormal) == 0.0f)
+		{
+			colors[0] = albedo * Vector4(lightColor,1.0f);
+			return true;
+		}
+
+		if((int)(packedNormal.w_ * 10.0f + 0.5f) == 10)
+		{
+			colors[0] = albedo;
+			return true;
+		}
+
+		Vector3 n = (Vector3(packedNormal.x_,packedNormal.y_,packedNormal.z_) * 2.0f - Vector3::ONE).Normalized();
+		Vector4 lightDirection = c->GetVector4(PARAM_LIGHT_DIRECTION);
+		Vector3 l = -Vector3(lightDirection.x_,lightDirection.y_,lightDirection.z_);
+		float NoL = Clamp(n.DotProduct(l),0.0f,1.0f);
+
+		//Li is PI * color / |L|^2 and the diffuse brdf albedo / PI
+		Vector3 diffuse = Vector3(albedo.x_,albedo.y_,albedo.z_) * lightColor * (NoL / l.LengthSquared());
+		colors[0] = Vector4(diffuse,1.0f);
+		return true;
+	}
+
+	//NoShadows/DeferredLightVS vs_df. The light volume scaled to the range, the varying is the view ray.
+	static void DeferredPointLightVS(const SoftwareVertexInput& input,const void* constants,SoftwareVertex& output)
+	{
+		const SoftwareShaderConstants* c = GetConstants(constants);
+
+		Vector4 worldPos = Mul(c,PARAM_VOLUME_TRANSFORM,Vector4(ReadFloat3(input.Data,0),1.0f));
+		Vector4 cameraPos = c->GetVector4(PARAM_CAMERA_POS);
+
+		output.Position = Mul(c,PARAM_VP,worldPos);
+		output.Varyings[0] = worldPos.x_ - cameraPos.x_;
+		output.Varyings[1] = worldPos.y_ - cameraPos.y_;
+		output.Varyings[2] = worldPos.z_ - cameraPos.z_;
+	}
+
+	//NoShadows/DeferredLightPS ps_df, Lambert with the linear falloff of the POINTLIGHT path
+	static bool DeferredPointLightPS(const SoftwarePixel& pixel,const void* constants,Vector4* colors)
+	{
+		const SoftwareShaderConstants* c = GetConstants(constants);
+
+		Vector4 packedNormal = Load(c,GBUFFER_NORMALS,pixel);
+		if(packedNormal.DotProduct(packedNormal) == 0.0f)
+			return false;
+
+		Vector4 albedo = Load(c,GBUFFER_COLORS,pixel);
+		float depth = Load(c,GBUFFER_LINEARDEPTH,pixel).x_;
+
+		Vector4 cameraPos = c->GetVector4(PARAM_CAMERA_POS);
+		Vector3 viewRay = Vector3(pixel.Varyings[0],pixel.Varyings[1],pixel.Varyings[2]).Normalized();
+		Vector3 position = Vector3(cameraPos.x_,cameraPos.y_,cameraPos.z_) + viewRay * depth;
+
+		Vector4 lightPosition = c->GetVector4(PARAM_LIGHT_POSITION);
+		float range = c->GetVector4(PARAM_LIGHT_DIRECTION).w_;
+		Vector3 l = Vector3(lightPosition.x_,lightPosition.y_,lightPosition.z_) - position;
+		float dist = l.Length();
+		if(dist <= 0.0f || range <= 0.0f)
+			return false;
+
+		float att = Max(0.0f,1.0f - dist / range);
+		Vector3 n = (Vector3(packedNormal.x_,packedNormal.y_,packedNormal.z_) * 2.0f - Vector3::ONE).Normalized();
+		float NoL = Clamp(n.DotProduct(l / dist),0.0f,1.0f);
+
+		Vector4 lightColor = c->GetVector4(PARAM_LIGHT_COLOR);
+		Vector3 diffuse = Vector3(albedo.x_,albedo.y_,albedo.z_) * Vector3(lightColor.x_,lightColor.y_,lightColor.z_) * (NoL * att);
+		colors[0] = Vector4(diffuse,1.0f);
+		return true;
+	}
+
+	void YumeSoftwareRenderer::RegisterEngineShaders()
+	{
+		RegisterVertexShader("DeferredSolid","MeshVs",DeferredSolidVS,8);
+		RegisterPixelShader("DeferredSolid","MeshPs",DeferredSolidPS);
+
+		RegisterVertexShader("LPV/fs_triangle","fs_triangle_vs",FsTriangleVS,5);
+		RegisterVertexShader("NoShadows/FsTriangle","fs_triangle_vs",FsTriangleVS,5);
+
+		RegisterPixelShader("Copy","ps_copy",CopyPS);
+		RegisterPixelShader("NoShadows/DeferredLightPS","ps_df_pbr",DeferredDirectionalLightPS);
+
+		RegisterVertexShader("NoShadows/DeferredLightVS","vs_df",DeferredPointLightVS,3);
+		RegisterPixelShader("NoShadows/DeferredLightPS","ps_df",DeferredPointLightPS);
+	}
+}
@@ -0,0 +1,279 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareTexture2D.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeSoftwareTexture2D.h"
+#include "YumeSoftwareRenderable.h"
+
+#include "Renderer/YumeRHI.h"
+#include "Renderer/YumeImage.h"
+#include "Engine/YumeEngine.h"
+
+#include "Logging/logging.h"
+
+
+namespace YumeEngine
+{
+
+	YumeSoftwareTexture2D::YumeSoftwareTexture2D()
+	{
+		format_ = SWFMT_UNKNOWN;
+		mips_ = 1;
+	}
+
+	YumeSoftwareTexture2D::~YumeSoftwareTexture2D()
+	{
+		Release();
+	}
+
+	void YumeSoftwareTexture2D::Release()
+	{
+		if(gYume->pRHI && shaderResourceView_)
+		{
+			for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+			{
+				if(gYume->pRHI->GetTexture(i) == this)
+					gYume->pRHI->SetTexture(i,0);
+			}
+		}
+
+		if(renderSurface_)
+			renderSurface_->Release();
+
+		shaderResourceView_ = 0;
+		slices_.clear();
+	}
+
+	bool YumeSoftwareTexture2D::SetSize(int width,int height,unsigned format,TextureUsage usage,int arraySize,int mips)
+	{
+		if(width <= 0 || height <= 0)
+		{
+			YUMELOG_ERROR("Zero or negative texture dimensions");
+			return false;
+		}
+
+		renderSurface_.Reset();
+		usage_ = usage;
+		arraySize_ = arraySize;
+		mips_ = mips;
+
+		if(mips_ == 0)
+		{
+			double dim = std::max(width,height);
+			mips_ = static_cast<int>(std::log(dim) / std::log(2.0));
+		}
+		if(usage_ == TEXTURE_RENDERTARGET || usage_ == TEXTURE_DEPTHSTENCIL || usage_ == TEXTURE_DEPTHSTENCIL_READONLY)
+		{
+			renderSurface_ = (new YumeSoftwareRenderable(this));
+
+			addressMode_[COORD_U] = ADDRESS_CLAMP;
+			addressMode_[COORD_V] = ADDRESS_CLAMP;
+			filterMode_ = FILTER_NEAREST;
+			requestedLevels_ = 1;
+		}
+		else if(usage_ == TEXTURE_DYNAMIC)
+			requestedLevels_ = 1;
+
+		width_ = width;
+		height_ = height;
+		format_ = format;
+
+		return Create();
+	}
+
+	bool YumeSoftwareTexture2D::SetData(unsigned level,int x,int y,int width,int height,const void* data)
+	{
+		return SetSliceData(level,0,x,y,width,height,data);
+	}
+
+	bool YumeSoftwareTexture2D::SetSliceData(unsigned level,unsigned slice,int x,int y,int width,int height,const void* data)
+	{
+		if(slices_.empty())
+		{
+			YUMELOG_ERROR("No texture created, can not set data");
+			return false;
+		}
+
+		if(!data)
+		{
+			YUMELOG_ERROR("Null source for setting data");
+			return false;
+		}
+
+		if(level >= levels_)
+		{
+			YUMELOG_ERROR("Illegal mip level for setting data");
+			return false;
+		}
+
+		if(slice >= arraySize_)
+		{
+			YUMELOG_ERROR("Illegal array slice for setting data");
+			return false;
+		}
+
+		int levelWidth = GetLevelWidth(level);
+		int levelHeight = GetLevelHeight(level);
+		if(x < 0 || x + width > levelWidth || y < 0 || y + height > levelHeight || width <= 0 || height <= 0)
+		{
+			YUMELOG_ERROR("Illegal dimensions for setting data");
+			return false;
+		}
+
+		//Lower levels are made from the top one when needed
+		if(level)
+			return true;
+
+		WriteSoftwareSurface(slices_[slice],format_,x,y,width,height,data);
+		return true;
+	}
+
+	bool YumeSoftwareTexture2D::SetData(unsigned level,int x,int y,int width,int height,unsigned f1,unsigned f2,unsigned f3,const void* data)
+	{
+		return false;
+	}
+
+	bool YumeSoftwareTexture2D::SetData(SharedPtr<YumeImage> image,bool useAlpha)
+	{
+		if(!image)
+		{
+			YUMELOG_ERROR("Null image, can not load texture");
+			return false;
+		}
+
+		unsigned memoryUse = sizeof(YumeSoftwareTexture2D);
+
+		int quality = QUALITY_HIGH;
+
+		if(!image->IsCompressed())
+		{
+			unsigned components = image->GetComponents();
+			if((components == 1 && !useAlpha) || components == 2 || components == 3)
+			{
+				image = image->ConvertToRGBA();
+				if(!image)
+					return false;
+				components = image->GetComponents();
+			}
+
+			for(unsigned i = 0; i < mipsToSkip_[quality]; ++i)
+				image = image->GetNextLevel();
+
+			unsigned format = components == 1 ? SWFMT_A8 : SWFMT_RGBA8;
+
+			SetSize(image->GetWidth(),image->GetHeight(),format);
+			SetData(0,0,0,image->GetWidth(),image->GetHeight(),image->GetData());
+			memoryUse += image->GetWidth() * image->GetHeight() * components;
+		}
+		else
+		{
+			//Block compressed images are always decompressed, there is no sampler to read them
+			int width = image->GetWidth();
+			int height = image->GetHeight();
+			unsigned levels = image->GetNumCompressedLevels();
+
+			unsigned mipsToSkip = mipsToSkip_[quality];
+			if(mipsToSkip >= levels)
+				mipsToSkip = levels - 1;
+			while(mipsToSkip && (width / (1 << mipsToSkip) < 4 || height / (1 << mipsToSkip) < 4))
+				--mipsToSkip;
+
+			CompressedLevel level = image->GetCompressedLevel(mipsToSkip);
+			SetSize(level.width_,level.height_,SWFMT_RGBA8);
+
+			unsigned char* rgbaData = new unsigned char[level.width_ * level.height_ * 4];
+			level.Decompress(rgbaData);
+			SetData(0,0,0,level.width_,level.height_,rgbaData);
+			memoryUse += level.width_ * level.height_ * 4;
+			delete[] rgbaData;
+		}
+
+		SetMemoryUsage(memoryUse);
+		return true;
+	}
+
+	bool YumeSoftwareTexture2D::GetData(unsigned level,void* dest) const
+	{
+		if(slices_.empty())
+		{
+			YUMELOG_ERROR("No texture created, can not get data");
+			return false;
+		}
+
+		if(!dest)
+		{
+			YUMELOG_ERROR("Null destination for getting data");
+			return false;
+		}
+
+		if(level >= levels_)
+		{
+			YUMELOG_ERROR("Illegal mip level for getting data");
+			return false;
+		}
+
+		ReadSoftwareSurface(slices_[0],format_,level,dest);
+		return true;
+	}
+
+	bool YumeSoftwareTexture2D::Create()
+	{
+		Release();
+
+		if(!gYume->pRHI || !width_ || !height_)
+			return false;
+
+		if(!GetSoftwareFormatSize(format_))
+		{
+			YUMELOG_ERROR("Texture format " << format_ << " is not supported by the software renderer");
+			return false;
+		}
+
+		levels_ = CheckMaxLevels(width_,height_,requestedLevels_);
+
+		if(mips_ != 1)
+			levels_ = mips_;
+
+		bool depthStencil = usage_ == TEXTURE_DEPTHSTENCIL || usage_ == TEXTURE_DEPTHSTENCIL_READONLY || IsSoftwareDepthFormat(format_);
+
+		slices_.resize(arraySize_ ? arraySize_ : 1);
+		for(unsigned i = 0; i < slices_.size(); ++i)
+		{
+			slices_[i].SetNormalized(!depthStencil && IsSoftwareNormalizedFormat(format_));
+			slices_[i].SetSize(width_,height_,depthStencil);
+		}
+
+		shaderResourceView_ = &slices_[0];
+
+		if(renderSurface_)
+		{
+			unsigned slice = (unsigned)arraySlice_ < slices_.size() ? arraySlice_ : 0;
+			static_cast<YumeSoftwareRenderable*>(renderSurface_.Get())->SetSurface(&slices_[slice]);
+		}
+
+		return true;
+	}
+
+	unsigned YumeSoftwareTexture2D::GetRowDataSize(int width) const
+	{
+		return GetSoftwareFormatSize(format_) * width;
+	}
+}
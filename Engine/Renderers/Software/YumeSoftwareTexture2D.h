@@ -0,0 +1,71 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareTexture2D.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareTexture2D_h__
+#define __YumeSoftwareTexture2D_h__
+//----------------------------------------------------------------------------
+#include "YumeSoftwareRequired.h"
+#include "Renderer/YumeTexture2D.h"
+#include "Renderer/SoftwareRasterizer.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//A SoftwareSurface per array slice, the shader resource view is the first one.
+	//Only the top mip level is stored, lower levels are filtered from it when read back.
+	class YumeSoftwareExport YumeSoftwareTexture2D : public YumeTexture2D
+	{
+	public:
+		YumeSoftwareTexture2D();
+		virtual ~YumeSoftwareTexture2D();
+
+		virtual void Release();
+		virtual bool SetSize(int width,int height,unsigned format,TextureUsage usage = TEXTURE_STATIC,int arraySize = 1,int mips = 1);
+		virtual bool SetData(unsigned level,int x,int y,int width,int height,const void* data);
+		virtual bool SetSliceData(unsigned level,unsigned slice,int x,int y,int width,int height,const void* data);
+		virtual bool SetData(unsigned level,int x,int y,int width,int height,unsigned f1,unsigned f2,unsigned f3,const void* data);
+		virtual bool SetData(SharedPtr<YumeImage> image,bool useAlpha = false);
+
+		virtual bool GetData(unsigned level,void* dest) const;
+
+		virtual bool Create();
+
+		virtual unsigned GetRowDataSize(int width) const;
+		virtual void UpdateParameters() { parametersDirty_ = false; }
+		virtual void CheckTextureBudget(YumeHash type) { }
+		virtual unsigned GetDataSize(int width,int height) const { return GetRowDataSize(width) * height; }
+		virtual unsigned GetSRVFormat(unsigned format) { return format; }
+		virtual unsigned GetDSVFormat(unsigned format) { return format; }
+		virtual unsigned GetSRGBFormat(unsigned format) { return format; }
+		virtual bool IsCompressed() const { return false; }
+
+		virtual bool IsDataLost() { return false; };
+		virtual void ClearDataLost() {}
+
+		SoftwareSurface* GetSurface(unsigned slice = 0) { return slice < slices_.size() ? &slices_[slice] : 0; }
+
+	private:
+		YumeVector<SoftwareSurface>::type slices_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
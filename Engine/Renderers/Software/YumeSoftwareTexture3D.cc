@@ -0,0 +1,219 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareTexture3D.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeSoftwareTexture3D.h"
+
+#include "Renderer/YumeRHI.h"
+#include "Renderer/YumeImage.h"
+#include "Engine/YumeEngine.h"
+
+#include "Logging/logging.h"
+
+
+namespace YumeEngine
+{
+
+	YumeSoftwareTexture3D::YumeSoftwareTexture3D()
+	{
+		format_ = SWFMT_UNKNOWN;
+	}
+
+	YumeSoftwareTexture3D::~YumeSoftwareTexture3D()
+	{
+		Release();
+	}
+
+	void YumeSoftwareTexture3D::Release()
+	{
+		if(gYume->pRHI && shaderResourceView_)
+		{
+			for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+			{
+				if(gYume->pRHI->GetTexture(i) == this)
+					gYume->pRHI->SetTexture(i,0);
+			}
+		}
+
+		shaderResourceView_ = 0;
+		slices_.clear();
+	}
+
+	bool YumeSoftwareTexture3D::SetSize(int width,int height,int depth,unsigned format,TextureUsage usage)
+	{
+		if(width <= 0 || height <= 0 || depth <= 0)
+		{
+			YUMELOG_ERROR("Zero or negative 3D texture dimensions");
+			return false;
+		}
+
+		usage_ = usage;
+		if(usage_ == TEXTURE_DYNAMIC)
+			requestedLevels_ = 1;
+
+		width_ = width;
+		height_ = height;
+		depth_ = depth;
+		format_ = format;
+
+		return Create();
+	}
+
+	bool YumeSoftwareTexture3D::SetData(unsigned level,int x,int y,int z,int width,int height,int depth,const void* data)
+	{
+		if(slices_.empty())
+		{
+			YUMELOG_ERROR("No texture created, can not set data");
+			return false;
+		}
+
+		if(!data)
+		{
+			YUMELOG_ERROR("Null source for setting data");
+			return false;
+		}
+
+		if(level >= levels_)
+		{
+			YUMELOG_ERROR("Illegal mip level for setting data");
+			return false;
+		}
+
+		int levelWidth = GetLevelWidth(level);
+		int levelHeight = GetLevelHeight(level);
+		int levelDepth = GetLevelDepth(level);
+		if(x < 0 || x + width > levelWidth || y < 0 || y + height > levelHeight || z < 0 || z + depth > levelDepth || width <= 0 ||
+			height <= 0 || depth <= 0)
+		{
+			YUMELOG_ERROR("Illegal dimensions for setting data");
+			return false;
+		}
+
+		if(level)
+			return true;
+
+		const unsigned char* src = (const unsigned char*)data;
+		unsigned sliceSize = GetDataSize(width,height);
+		for(int i = 0; i < depth; ++i)
+			WriteSoftwareSurface(slices_[z + i],format_,x,y,width,height,src + i * sliceSize);
+
+		return true;
+	}
+
+	bool YumeSoftwareTexture3D::SetData(SharedPtr<YumeImage> image,bool useAlpha)
+	{
+		if(!image)
+		{
+			YUMELOG_ERROR("Null image, can not load texture");
+			return false;
+		}
+
+		if(image->IsCompressed())
+		{
+			YUMELOG_ERROR("Compressed 3D textures are not supported by the software renderer");
+			return false;
+		}
+
+		int quality = QUALITY_HIGH;
+
+		unsigned components = image->GetComponents();
+		if((components == 1 && !useAlpha) || components == 2 || components == 3)
+		{
+			image = image->ConvertToRGBA();
+			if(!image)
+				return false;
+			components = image->GetComponents();
+		}
+
+		for(unsigned i = 0; i < mipsToSkip_[quality]; ++i)
+			image = image->GetNextLevel();
+
+		int width = image->GetWidth();
+		int height = image->GetHeight();
+		int depth = image->GetDepth();
+
+		if(!SetSize(width,height,depth,components == 1 ? SWFMT_A8 : SWFMT_RGBA8))
+			return false;
+		SetData(0,0,0,0,width,height,depth,image->GetData());
+
+		SetMemoryUsage(sizeof(YumeSoftwareTexture3D) + width * height * depth * components);
+		return true;
+	}
+
+	bool YumeSoftwareTexture3D::GetData(unsigned level,void* dest) const
+	{
+		if(slices_.empty())
+		{
+			YUMELOG_ERROR("No texture created, can not get data");
+			return false;
+		}
+
+		if(!dest)
+		{
+			YUMELOG_ERROR("Null destination for getting data");
+			return false;
+		}
+
+		if(level)
+		{
+			YUMELOG_ERROR("Only the top mip level of a software 3D texture can be read");
+			return false;
+		}
+
+		unsigned char* dst = (unsigned char*)dest;
+		unsigned sliceSize = GetDataSize(width_,height_);
+		for(unsigned i = 0; i < slices_.size(); ++i)
+			ReadSoftwareSurface(slices_[i],format_,0,dst + i * sliceSize);
+
+		return true;
+	}
+
+	bool YumeSoftwareTexture3D::Create()
+	{
+		Release();
+
+		if(!gYume->pRHI || !width_ || !height_ || !depth_)
+			return false;
+
+		if(!GetSoftwareFormatSize(format_) || IsSoftwareDepthFormat(format_))
+		{
+			YUMELOG_ERROR("3D texture format " << format_ << " is not supported by the software renderer");
+			return false;
+		}
+
+		levels_ = CheckMaxLevels(width_,height_,depth_,requestedLevels_);
+
+		slices_.resize(depth_);
+		for(unsigned i = 0; i < slices_.size(); ++i)
+		{
+			slices_[i].SetNormalized(IsSoftwareNormalizedFormat(format_));
+			slices_[i].SetSize(width_,height_);
+		}
+
+		shaderResourceView_ = &slices_[0];
+		return true;
+	}
+
+	unsigned YumeSoftwareTexture3D::GetRowDataSize(int width) const
+	{
+		return GetSoftwareFormatSize(format_) * width;
+	}
+}
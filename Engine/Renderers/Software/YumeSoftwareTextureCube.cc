@@ -0,0 +1,292 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareTextureCube.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeSoftwareTextureCube.h"
+#include "YumeSoftwareRenderable.h"
+
+#include "Renderer/YumeRHI.h"
+#include "Renderer/YumeImage.h"
+#include "Engine/YumeEngine.h"
+
+#include "Logging/logging.h"
+
+
+namespace YumeEngine
+{
+
+	YumeSoftwareTextureCube::YumeSoftwareTextureCube()
+	{
+		format_ = SWFMT_UNKNOWN;
+
+		for(unsigned i = 0; i < MAX_CUBEMAP_FACES; ++i)
+			faceMemoryUse_[i] = 0;
+	}
+
+	YumeSoftwareTextureCube::~YumeSoftwareTextureCube()
+	{
+		Release();
+	}
+
+	void YumeSoftwareTextureCube::Release()
+	{
+		if(gYume->pRHI && shaderResourceView_)
+		{
+			for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+			{
+				if(gYume->pRHI->GetTexture(i) == this)
+					gYume->pRHI->SetTexture(i,0);
+			}
+		}
+
+		for(unsigned i = 0; i < MAX_CUBEMAP_FACES; ++i)
+		{
+			if(renderSurfaces_[i])
+				renderSurfaces_[i]->Release();
+		}
+
+		shaderResourceView_ = 0;
+		faces_.clear();
+	}
+
+	bool YumeSoftwareTextureCube::SetSize(int size,unsigned format,TextureUsage usage)
+	{
+		if(size <= 0)
+		{
+			YUMELOG_ERROR("Zero or negative cube texture size");
+			return false;
+		}
+		if(usage == TEXTURE_DEPTHSTENCIL)
+		{
+			YUMELOG_ERROR("Depth-stencil usage not supported for cube maps");
+			return false;
+		}
+
+		for(unsigned i = 0; i < MAX_CUBEMAP_FACES; ++i)
+		{
+			renderSurfaces_[i].Reset();
+			faceMemoryUse_[i] = 0;
+		}
+
+		usage_ = usage;
+		if(usage_ == TEXTURE_RENDERTARGET)
+		{
+			for(unsigned i = 0; i < MAX_CUBEMAP_FACES; ++i)
+				renderSurfaces_[i] = SharedPtr<YumeSoftwareRenderable>(new YumeSoftwareRenderable(this));
+		}
+		else if(usage_ == TEXTURE_DYNAMIC)
+			requestedLevels_ = 1;
+
+		width_ = size;
+		height_ = size;
+		format_ = format;
+
+		return Create();
+	}
+
+	bool YumeSoftwareTextureCube::SetData(CubeMapFace face,unsigned level,int x,int y,int width,int height,const void* data)
+	{
+		if(faces_.empty())
+		{
+			YUMELOG_ERROR("No texture created, can not set data");
+			return false;
+		}
+
+		if(!data)
+		{
+			YUMELOG_ERROR("Null source for setting data");
+			return false;
+		}
+
+		if(level >= levels_)
+		{
+			YUMELOG_ERROR("Illegal mip level for setting data");
+			return false;
+		}
+
+		int levelWidth = GetLevelWidth(level);
+		int levelHeight = GetLevelHeight(level);
+		if(x < 0 || x + width > levelWidth || y < 0 || y + height > levelHeight || width <= 0 || height <= 0)
+		{
+			YUMELOG_ERROR("Illegal dimensions for setting data");
+			return false;
+		}
+
+		if(level)
+			return true;
+
+		WriteSoftwareSurface(faces_[face],format_,x,y,width,height,data);
+		return true;
+	}
+
+	bool YumeSoftwareTextureCube::SetData(CubeMapFace face,YumeFile& source)
+	{
+		SharedPtr<YumeImage> image(new YumeImage);
+		if(!image->Load(source))
+			return false;
+
+		return SetData(face,image);
+	}
+
+	bool YumeSoftwareTextureCube::SetData(CubeMapFace face,SharedPtr<YumeImage> image,bool useAlpha)
+	{
+		if(!image)
+		{
+			YUMELOG_ERROR("Null image, can not load texture");
+			return false;
+		}
+
+		if(image->GetWidth() != image->GetHeight())
+		{
+			YUMELOG_ERROR("Cube texture width not equal to height");
+			return false;
+		}
+
+		int quality = QUALITY_HIGH;
+		unsigned char* levelData = 0;
+		unsigned char* rgbaData = 0;
+		int levelSize = 0;
+		unsigned format = SWFMT_RGBA8;
+		unsigned components = 4;
+
+		if(!image->IsCompressed())
+		{
+			components = image->GetComponents();
+			if((components == 1 && !useAlpha) || components == 2 || components == 3)
+			{
+				image = image->ConvertToRGBA();
+				if(!image)
+					return false;
+				components = image->GetComponents();
+			}
+
+			for(unsigned i = 0; i < mipsToSkip_[quality]; ++i)
+				image = image->GetNextLevel();
+
+			levelData = image->GetData();
+			levelSize = image->GetWidth();
+			format = components == 1 ? SWFMT_A8 : SWFMT_RGBA8;
+		}
+		else
+		{
+			unsigned levels = image->GetNumCompressedLevels();
+			unsigned mipsToSkip = mipsToSkip_[quality];
+			if(mipsToSkip >= levels)
+				mipsToSkip = levels - 1;
+			while(mipsToSkip && image->GetWidth() / (1 << mipsToSkip) < 4)
+				--mipsToSkip;
+
+			CompressedLevel level = image->GetCompressedLevel(mipsToSkip);
+			rgbaData = new unsigned char[level.width_ * level.height_ * 4];
+			level.Decompress(rgbaData);
+			levelData = rgbaData;
+			levelSize = level.width_;
+		}
+
+		//Face 0 creates the texture, the rest must match it
+		bool success = true;
+		if(!face)
+			success = SetSize(levelSize,format);
+		else if(faces_.empty())
+		{
+			YUMELOG_ERROR("Cube texture face 0 must be loaded first");
+			success = false;
+		}
+		else if(levelSize != width_ || format != format_)
+		{
+			YUMELOG_ERROR("Cube texture face does not match size or format of face 0");
+			success = false;
+		}
+
+		if(success)
+			success = SetData(face,0,0,0,levelSize,levelSize,levelData);
+		delete[] rgbaData;
+
+		if(!success)
+			return false;
+
+		faceMemoryUse_[face] = levelSize * levelSize * components;
+		unsigned totalMemoryUse = sizeof(YumeSoftwareTextureCube);
+		for(unsigned i = 0; i < MAX_CUBEMAP_FACES; ++i)
+			totalMemoryUse += faceMemoryUse_[i];
+		SetMemoryUsage(totalMemoryUse);
+
+		return true;
+	}
+
+	bool YumeSoftwareTextureCube::GetData(CubeMapFace face,unsigned level,void* dest) const
+	{
+		if(faces_.empty())
+		{
+			YUMELOG_ERROR("No texture created, can not get data");
+			return false;
+		}
+
+		if(!dest)
+		{
+			YUMELOG_ERROR("Null destination for getting data");
+			return false;
+		}
+
+		if(level >= levels_)
+		{
+			YUMELOG_ERROR("Illegal mip level for getting data");
+			return false;
+		}
+
+		ReadSoftwareSurface(faces_[face],format_,level,dest);
+		return true;
+	}
+
+	bool YumeSoftwareTextureCube::Create()
+	{
+		Release();
+
+		if(!gYume->pRHI || !width_ || !height_)
+			return false;
+
+		if(!GetSoftwareFormatSize(format_) || IsSoftwareDepthFormat(format_))
+		{
+			YUMELOG_ERROR("Cube texture format " << format_ << " is not supported by the software renderer");
+			return false;
+		}
+
+		levels_ = CheckMaxLevels(width_,height_,requestedLevels_);
+
+		faces_.resize(MAX_CUBEMAP_FACES);
+		for(unsigned i = 0; i < MAX_CUBEMAP_FACES; ++i)
+		{
+			faces_[i].SetNormalized(IsSoftwareNormalizedFormat(format_));
+			faces_[i].SetSize(width_,height_);
+
+			if(renderSurfaces_[i])
+				static_cast<YumeSoftwareRenderable*>(renderSurfaces_[i].Get())->SetSurface(&faces_[i]);
+		}
+
+		shaderResourceView_ = &faces_[0];
+		return true;
+	}
+
+	unsigned YumeSoftwareTextureCube::GetRowDataSize(int width) const
+	{
+		return GetSoftwareFormatSize(format_) * width;
+	}
+}
@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareTextureCube.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareTextureCube_h__
+#define __YumeSoftwareTextureCube_h__
+//----------------------------------------------------------------------------
+#include "YumeSoftwareRequired.h"
+#include "Renderer/YumeTextureCube.h"
+#include "Renderer/SoftwareRasterizer.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class YumeImage;
+
+	//A SoftwareSurface per face, top mip level only like YumeSoftwareTexture2D
+	class YumeSoftwareExport YumeSoftwareTextureCube : public YumeTextureCube
+	{
+	public:
+		YumeSoftwareTextureCube();
+		virtual ~YumeSoftwareTextureCube();
+
+		virtual void Release();
+
+		virtual bool SetSize(int size,unsigned format,TextureUsage usage = TEXTURE_STATIC);
+		virtual bool SetData(CubeMapFace face,unsigned level,int x,int y,int width,int height,const void* data);
+		virtual bool SetData(CubeMapFace face,YumeFile& source);
+		virtual bool SetData(CubeMapFace face,SharedPtr<YumeImage> image,bool useAlpha = false);
+		virtual bool GetData(CubeMapFace face,unsigned level,void* dest) const;
+		virtual bool Create();
+
+		virtual bool IsCompressed() const { return false; }
+		virtual unsigned GetDataSize(int width,int height) const { return GetRowDataSize(width) * height; }
+		virtual unsigned GetRowDataSize(int width) const;
+		virtual void UpdateParameters() { parametersDirty_ = false; }
+		virtual void CheckTextureBudget(YumeHash type) { }
+		virtual unsigned GetSRVFormat(unsigned format) { return format; }
+		virtual unsigned GetDSVFormat(unsigned format) { return format; }
+		virtual unsigned GetSRGBFormat(unsigned format) { return format; }
+
+		virtual bool IsDataLost() { return false; };
+		virtual void ClearDataLost() { }
+
+		SoftwareSurface* GetSurface(CubeMapFace face) { return (unsigned)face < faces_.size() ? &faces_[face] : 0; }
+
+	private:
+		YumeVector<SoftwareSurface>::type faces_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
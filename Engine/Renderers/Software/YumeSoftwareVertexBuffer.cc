@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareVertexBuffer.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeSoftwareVertexBuffer.h"
+
+#include "Renderer/YumeRHI.h"
+#include "Engine/YumeEngine.h"
+
+#include "Logging/logging.h"
+
+
+namespace YumeEngine
+{
+
+	YumeSoftwareVertexBuffer::YumeSoftwareVertexBuffer()
+	{
+		shadowed_ = true;
+		UpdateOffsets();
+	}
+
+	YumeSoftwareVertexBuffer::~YumeSoftwareVertexBuffer()
+	{
+		Release();
+	}
+
+	void YumeSoftwareVertexBuffer::Release()
+	{
+		Unlock();
+
+		if(gYume->pRHI)
+		{
+			for(unsigned i = 0; i < MAX_VERTEX_STREAMS; ++i)
+			{
+				if(gYume->pRHI->GetVertexBuffer(i) == this)
+					gYume->pRHI->SetVertexBuffer(0);
+			}
+		}
+	}
+
+	bool YumeSoftwareVertexBuffer::SetSize(unsigned vertexCount,unsigned elementMask,bool dynamic)
+	{
+		Unlock();
+
+		dynamic_ = dynamic;
+		vertexCount_ = vertexCount;
+		elementMask_ = elementMask;
+
+		UpdateOffsets();
+
+		if(vertexCount_ && vertexSize_)
+			shadowData_ = boost::shared_array<unsigned char>(new unsigned char[vertexCount_ * vertexSize_]);
+		else
+			shadowData_.reset();
+
+		return Create();
+	}
+
+	bool YumeSoftwareVertexBuffer::SetData(const void* data)
+	{
+		if(!data)
+		{
+			YUMELOG_ERROR("Null pointer for vertex buffer data");
+			return false;
+		}
+
+		if(!vertexSize_)
+		{
+			YUMELOG_ERROR("Vertex elements not defined, can not set vertex buffer data");
+			return false;
+		}
+
+		if(shadowData_ && data != shadowData_.get())
+			memcpy(shadowData_.get(),data,vertexCount_ * vertexSize_);
+
+		return true;
+	}
+
+	bool YumeSoftwareVertexBuffer::SetDataRange(const void* data,unsigned start,unsigned count,bool discard)
+	{
+		if(start == 0 && count == vertexCount_)
+			return SetData(data);
+
+		if(!data)
+		{
+			YUMELOG_ERROR("Null pointer for vertex buffer data");
+			return false;
+		}
+
+		if(!vertexSize_)
+		{
+			YUMELOG_ERROR("Vertex elements not defined, can not set vertex buffer data");
+			return false;
+		}
+
+		if(start + count > vertexCount_)
+		{
+			YUMELOG_ERROR("Illegal range for setting new vertex buffer data");
+			return false;
+		}
+
+		if(!count)
+			return true;
+
+		if(shadowData_ && shadowData_.get() + start * vertexSize_ != data)
+			memcpy(shadowData_.get() + start * vertexSize_,data,count * vertexSize_);
+
+		return true;
+	}
+
+	void* YumeSoftwareVertexBuffer::Lock(unsigned start,unsigned count,bool discard)
+	{
+		if(lockState_ != LOCK_NONE)
+		{
+			YUMELOG_ERROR("Vertex buffer already locked");
+			return 0;
+		}
+
+		if(!vertexSize_)
+		{
+			YUMELOG_ERROR("Vertex elements not defined, can not lock vertex buffer");
+			return 0;
+		}
+
+		if(start + count > vertexCount_)
+		{
+			YUMELOG_ERROR("Illegal range for locking vertex buffer");
+			return 0;
+		}
+
+		if(!count || !shadowData_)
+			return 0;
+
+		lockStart_ = start;
+		lockCount_ = count;
+		lockState_ = LOCK_SHADOW;
+		return shadowData_.get() + start * vertexSize_;
+	}
+
+	void YumeSoftwareVertexBuffer::Unlock()
+	{
+		//Writes went straight to the shadow data
+		lockState_ = LOCK_NONE;
+	}
+
+	void YumeSoftwareVertexBuffer::UpdateOffsets()
+	{
+		unsigned elementOffset = 0;
+		for(unsigned i = 0; i < MAX_VERTEX_ELEMENTS; ++i)
+		{
+			if(elementMask_ & (1 << i))
+			{
+				elementOffset_[i] = elementOffset;
+				elementOffset += elementSize[i];
+			}
+			else
+				elementOffset_[i] = NO_ELEMENT;
+		}
+		vertexSize_ = elementOffset;
+	}
+}
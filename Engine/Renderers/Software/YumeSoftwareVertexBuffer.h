@@ -0,0 +1,58 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeSoftwareVertexBuffer.h
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSoftwareVertexBuffer_h__
+#define __YumeSoftwareVertexBuffer_h__
+//----------------------------------------------------------------------------
+#include "YumeSoftwareRequired.h"
+#include "Renderer/YumeRendererDefs.h"
+#include "Renderer/YumeVertexBuffer.h"
+
+#include <boost/shared_array.hpp>
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Vertex buffer that is only its shadow data, the rasterizer reads the vertices from there
+	class YumeSoftwareExport YumeSoftwareVertexBuffer : public YumeVertexBuffer
+	{
+	public:
+		YumeSoftwareVertexBuffer();
+		virtual ~YumeSoftwareVertexBuffer();
+
+		virtual void Release();
+
+		//Shadowing is always on
+		virtual void SetShadowed(bool enable) { }
+		virtual bool SetSize(unsigned vertexCount,unsigned elementMask,bool dynamic = false);
+		virtual bool SetData(const void* data);
+		virtual bool SetDataRange(const void* data,unsigned start,unsigned count,bool discard = false);
+		virtual void* Lock(unsigned start,unsigned count,bool discard = false);
+		virtual void Unlock();
+
+		virtual void UpdateOffsets();
+		virtual bool Create() { return true; }
+		virtual bool UpdateToGPU() { return true; }
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
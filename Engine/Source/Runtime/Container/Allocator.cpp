@@ -31,7 +31,9 @@ AllocatorBlock* AllocatorReserveBlock(AllocatorBlock* allocator, unsigned nodeSi
     if (!capacity)
         capacity = 1;
 
-    unsigned char* blockPtr = new unsigned char[sizeof(AllocatorBlock) + capacity * (sizeof(AllocatorNode) + nodeSize)];
+    unsigned blockSize = sizeof(AllocatorBlock) + capacity * (sizeof(AllocatorNode) + nodeSize);
+    unsigned char* blockPtr = new unsigned char[blockSize];
+    YUME_TRACK_ALLOC(blockPtr, blockSize, YUME_MEM_CONTAINERS);
     AllocatorBlock* newBlock = reinterpret_cast<AllocatorBlock*>(blockPtr);
     newBlock->nodeSize_ = nodeSize;
     newBlock->capacity_ = capacity;
@@ -78,6 +80,7 @@ void AllocatorUninitialize(AllocatorBlock* allocator)
     while (allocator)
     {
         AllocatorBlock* next = allocator->next_;
+        YUME_TRACK_DEALLOC(allocator);
         delete[] reinterpret_cast<unsigned char*>(allocator);
         allocator = next;
     }
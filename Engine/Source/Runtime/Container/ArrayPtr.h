@@ -162,10 +162,10 @@ public:
     T* Get() const { return ptr_; }
 
     /// Return the array's reference count, or 0 if the pointer is null.
-    int Refs() const { return refCount_ ? refCount_->refs_ : 0; }
+    int Refs() const { return refCount_ ? refCount_->Refs() : 0; }
 
     /// Return the array's weak reference count, or 0 if the pointer is null.
-    int WeakRefs() const { return refCount_ ? refCount_->weakRefs_ : 0; }
+    int WeakRefs() const { return refCount_ ? refCount_->WeakRefs() : 0; }
 
     /// Return pointer to the RefCount structure.
     RefCount* RefCountPtr() const { return refCount_; }
@@ -183,7 +183,7 @@ private:
         if (refCount_)
         {
             assert(refCount_->refs_ >= 0);
-            ++(refCount_->refs_);
+            refCount_->AddRef();
         }
     }
 
@@ -193,8 +193,7 @@ private:
         if (refCount_)
         {
             assert(refCount_->refs_ > 0);
-            --(refCount_->refs_);
-            if (!refCount_->refs_)
+            if (!refCount_->ReleaseRef())
             {
                 refCount_->refs_ = -1;
                 delete[] ptr_;
@@ -379,10 +378,10 @@ public:
     bool NotNull() const { return refCount_ != 0; }
 
     /// Return the array's reference count, or 0 if null pointer or if array has expired.
-    int Refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_ : 0; }
+    int Refs() const { return (refCount_ && refCount_->Refs() >= 0) ? refCount_->Refs() : 0; }
 
     /// Return the array's weak reference count.
-    int WeakRefs() const { return refCount_ ? refCount_->weakRefs_ : 0; }
+    int WeakRefs() const { return refCount_ ? refCount_->WeakRefs() : 0; }
 
     /// Return whether the array has expired. If null pointer, always return true.
     bool Expired() const { return refCount_ ? refCount_->refs_ < 0 : true; }
@@ -403,7 +402,7 @@ private:
         if (refCount_)
         {
             assert(refCount_->weakRefs_ >= 0);
-            ++(refCount_->weakRefs_);
+            refCount_->AddWeakRef();
         }
     }
 
@@ -415,7 +414,7 @@ private:
             assert(refCount_->weakRefs_ >= 0);
 
             if (refCount_->weakRefs_ > 0)
-                --(refCount_->weakRefs_);
+                refCount_->ReleaseWeakRef();
 
             if (Expired() && !refCount_->weakRefs_)
                 delete refCount_;
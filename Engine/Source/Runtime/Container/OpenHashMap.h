@@ -0,0 +1,540 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : OpenHashMap.h
+// Date : <Date>
+// Comments : Robin Hood open addressing map with the HashMap interface
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeOpenHashMap_h__
+#define __YumeOpenHashMap_h__
+//----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Hash.h"
+#include "Pair.h"
+#include "Vector.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+namespace YumeEngine
+{
+
+/// Open addressing hash map template class. Pairs live inline in one array, a byte per slot holds the probe distance.
+/// Unlike HashMap, iteration order is unspecified and any insert or erase may move pairs and invalidate iterators and pointers.
+template <class T, class U> class OpenHashMap
+{
+public:
+    typedef T KeyType;
+    typedef U ValueType;
+
+    /// Minimum number of slots.
+    static const unsigned MIN_SLOTS = 8;
+    /// Longest probe sequence before the table is grown regardless of load.
+    static const unsigned MAX_PROBE_DISTANCE = 255;
+
+    /// Key-value pair. The key must not be modified through an iterator.
+    struct KeyValue
+    {
+        /// Construct with key and value.
+        KeyValue(const T& first, const U& second) :
+            first(first),
+            second(second)
+        {
+        }
+
+        /// Test for equality with another pair.
+        bool operator ==(const KeyValue& rhs) const { return first == rhs.first && second == rhs.second; }
+
+        /// Test for inequality with another pair.
+        bool operator !=(const KeyValue& rhs) const { return first != rhs.first || second != rhs.second; }
+
+        /// Key.
+        T first;
+        /// Value.
+        U second;
+    };
+
+    /// Iterator over the occupied slots.
+    struct Iterator
+    {
+        /// Construct.
+        Iterator() :
+            map_(0),
+            index_(0)
+        {
+        }
+
+        /// Construct at a slot.
+        Iterator(const OpenHashMap* map, unsigned index) :
+            map_(map),
+            index_(index)
+        {
+        }
+
+        /// Point to the pair.
+        KeyValue* operator ->() const { return map_->Slot(index_); }
+
+        /// Dereference the pair.
+        KeyValue& operator *() const { return *map_->Slot(index_); }
+
+        /// Preincrement the pointer.
+        Iterator& operator ++()
+        {
+            index_ = map_->NextOccupied(index_ + 1);
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        Iterator operator ++(int)
+        {
+            Iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const Iterator& rhs) const { return index_ == rhs.index_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const Iterator& rhs) const { return index_ != rhs.index_; }
+
+        /// Map.
+        const OpenHashMap* map_;
+        /// Slot index, equal to the capacity at the end.
+        unsigned index_;
+    };
+
+    /// Const iterator over the occupied slots.
+    struct ConstIterator
+    {
+        /// Construct.
+        ConstIterator() :
+            map_(0),
+            index_(0)
+        {
+        }
+
+        /// Construct at a slot.
+        ConstIterator(const OpenHashMap* map, unsigned index) :
+            map_(map),
+            index_(index)
+        {
+        }
+
+        /// Construct from a non-const iterator.
+        ConstIterator(const Iterator& rhs) :
+            map_(rhs.map_),
+            index_(rhs.index_)
+        {
+        }
+
+        /// Point to the pair.
+        const KeyValue* operator ->() const { return map_->Slot(index_); }
+
+        /// Dereference the pair.
+        const KeyValue& operator *() const { return *map_->Slot(index_); }
+
+        /// Preincrement the pointer.
+        ConstIterator& operator ++()
+        {
+            index_ = map_->NextOccupied(index_ + 1);
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        ConstIterator operator ++(int)
+        {
+            ConstIterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const ConstIterator& rhs) const { return index_ == rhs.index_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const ConstIterator& rhs) const { return index_ != rhs.index_; }
+
+        /// Map.
+        const OpenHashMap* map_;
+        /// Slot index, equal to the capacity at the end.
+        unsigned index_;
+    };
+
+    /// Construct empty.
+    OpenHashMap() :
+        buffer_(0),
+        slots_(0),
+        distances_(0),
+        capacity_(0),
+        size_(0),
+        shift_(32)
+    {
+    }
+
+    /// Construct from another map.
+    OpenHashMap(const OpenHashMap<T, U>& map) :
+        buffer_(0),
+        slots_(0),
+        distances_(0),
+        capacity_(0),
+        size_(0),
+        shift_(32)
+    {
+        insert(map);
+    }
+
+    /// Destruct.
+    ~OpenHashMap()
+    {
+        clear();
+        delete[] buffer_;
+    }
+
+    /// Assign a map.
+    OpenHashMap& operator =(const OpenHashMap<T, U>& rhs)
+    {
+        if (&rhs != this)
+        {
+            clear();
+            insert(rhs);
+        }
+        return *this;
+    }
+
+    /// Test for equality with another map.
+    bool operator ==(const OpenHashMap<T, U>& rhs) const
+    {
+        if (rhs.size() != size())
+            return false;
+
+        for (ConstIterator i = begin(); i != end(); ++i)
+        {
+            const U* value = rhs[i->first];
+            if (!value || *value != i->second)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another map.
+    bool operator !=(const OpenHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        unsigned index = FindSlot(key);
+        if (index != capacity_)
+            return slots_[index].second;
+
+        return Slot(InsertNew(key, U()))->second;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned index = FindSlot(key);
+        return index != capacity_ ? &slots_[index].second : 0;
+    }
+
+    /// Insert a pair. Return an iterator to it.
+    Iterator insert(const Pair<T, U>& pair)
+    {
+        unsigned index = FindSlot(pair.first_);
+        if (index != capacity_)
+        {
+            slots_[index].second = pair.second_;
+            return Iterator(this, index);
+        }
+
+        return Iterator(this, InsertNew(pair.first_, pair.second_));
+    }
+
+    /// Insert a map.
+    void insert(const OpenHashMap<T, U>& map)
+    {
+        for (ConstIterator i = map.begin(); i != map.end(); ++i)
+            (*this)[i->first] = i->second;
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool erase(const T& key)
+    {
+        unsigned index = FindSlot(key);
+        if (index == capacity_)
+            return false;
+
+        EraseSlot(index);
+        return true;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the next pair. A pair shifted back over the end of the table may be visited twice.
+    Iterator erase(const Iterator& it)
+    {
+        unsigned index = it.index_;
+        EraseSlot(index);
+        //The following pair may have shifted back into this slot
+        return Iterator(this, NextOccupied(index));
+    }
+
+    /// Clear the map. Keeps the allocated slots.
+    void clear()
+    {
+        for (unsigned i = 0; i < capacity_ && size_; ++i)
+        {
+            if (distances_[i])
+            {
+                slots_[i].~KeyValue();
+                distances_[i] = 0;
+                --size_;
+            }
+        }
+    }
+
+    /// Grow so that at least numPairs fit without rehashing. Slot count is always a power of two.
+    void Reserve(unsigned numPairs)
+    {
+        unsigned numSlots = MIN_SLOTS;
+        while (numSlots - numSlots / 8 < numPairs)
+            numSlots <<= 1;
+
+        if (numSlots > capacity_)
+            Rehash(numSlots);
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator find(const T& key) { return Iterator(this, FindSlot(key)); }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator find(const T& key) const { return ConstIterator(this, FindSlot(key)); }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindSlot(key) != capacity_; }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.reserve(size_);
+        for (ConstIterator i = begin(); i != end(); ++i)
+            result.push_back(i->first);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.reserve(size_);
+        for (ConstIterator i = begin(); i != end(); ++i)
+            result.push_back(i->second);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator begin() { return Iterator(this, NextOccupied(0)); }
+
+    /// Return iterator to the beginning.
+    ConstIterator begin() const { return ConstIterator(this, NextOccupied(0)); }
+
+    /// Return iterator to the end.
+    Iterator end() { return Iterator(this, capacity_); }
+
+    /// Return iterator to the end.
+    ConstIterator end() const { return ConstIterator(this, capacity_); }
+
+    /// Return number of pairs.
+    unsigned size() const { return size_; }
+
+    /// Return number of slots.
+    unsigned NumSlots() const { return capacity_; }
+
+    /// Return whether the map is empty.
+    bool empty() const { return size_ == 0; }
+
+private:
+    /// Return the pair in a slot.
+    KeyValue* Slot(unsigned index) const { return &slots_[index]; }
+
+    /// Return the first occupied slot at or after index, or the capacity.
+    unsigned NextOccupied(unsigned index) const
+    {
+        while (index < capacity_ && !distances_[index])
+            ++index;
+        return index;
+    }
+
+    /// Return the home slot of a key. Fibonacci hashing spreads the weak pointer and integer hashes over the table.
+    unsigned HomeSlot(const T& key) const { return (MakeHash(key) * 2654435769U) >> shift_; }
+
+    /// Return the slot holding key, or the capacity if not found.
+    unsigned FindSlot(const T& key) const
+    {
+        if (!size_)
+            return capacity_;
+
+        unsigned mask = capacity_ - 1;
+        unsigned index = HomeSlot(key);
+        unsigned distance = 1;
+
+        //Robin Hood invariant, once the probe is longer than the resident's the key can not be further on
+        while (distances_[index] >= distance)
+        {
+            if (distances_[index] == distance && slots_[index].first == key)
+                return index;
+
+            index = (index + 1) & mask;
+            ++distance;
+        }
+
+        return capacity_;
+    }
+
+    /// Insert a key known not to be present. Return its slot.
+    unsigned InsertNew(const T& key, const U& value)
+    {
+        if (size_ + 1 > capacity_ - capacity_ / 8)
+            Rehash(capacity_ ? capacity_ * 2 : MIN_SLOTS);
+
+        KeyValue pair(key, value);
+        unsigned mask = capacity_ - 1;
+        unsigned index = HomeSlot(key);
+        unsigned distance = 1;
+        unsigned result = capacity_;
+
+        for (;;)
+        {
+            if (!distances_[index])
+            {
+                new(&slots_[index]) KeyValue(pair);
+                distances_[index] = (unsigned char)distance;
+                ++size_;
+                return result != capacity_ ? result : index;
+            }
+
+            //Take the slot from a pair that is closer to home and carry that one on
+            if (distances_[index] < distance)
+            {
+                KeyValue displaced(slots_[index]);
+                slots_[index] = pair;
+                pair = displaced;
+
+                unsigned displacedDistance = distances_[index];
+                distances_[index] = (unsigned char)distance;
+                distance = displacedDistance;
+
+                if (result == capacity_)
+                    result = index;
+            }
+
+            index = (index + 1) & mask;
+            if (++distance >= MAX_PROBE_DISTANCE)
+            {
+                //Pathological clustering, grow and place the pair still being carried
+                Rehash(capacity_ * 2);
+                InsertNew(pair.first, pair.second);
+                return FindSlot(key);
+            }
+        }
+    }
+
+    /// Erase the pair in a slot and shift the following cluster back.
+    void EraseSlot(unsigned index)
+    {
+        unsigned mask = capacity_ - 1;
+        slots_[index].~KeyValue();
+        --size_;
+
+        unsigned next = (index + 1) & mask;
+        while (distances_[next] > 1)
+        {
+            new(&slots_[index]) KeyValue(slots_[next]);
+            distances_[index] = distances_[next] - 1;
+            slots_[next].~KeyValue();
+
+            index = next;
+            next = (next + 1) & mask;
+        }
+
+        distances_[index] = 0;
+    }
+
+    /// Reallocate to numSlots, a power of two, and reinsert every pair.
+    void Rehash(unsigned numSlots)
+    {
+        assert(numSlots >= MIN_SLOTS && !(numSlots & (numSlots - 1)));
+
+        unsigned char* oldBuffer = buffer_;
+        KeyValue* oldSlots = slots_;
+        unsigned char* oldDistances = distances_;
+        unsigned oldCapacity = capacity_;
+
+        //Over allocate to align the pairs, operator new[] on unsigned char only guarantees the platform default
+        unsigned alignment = __alignof(KeyValue) > sizeof(void*) ? __alignof(KeyValue) : sizeof(void*);
+        buffer_ = new unsigned char[numSlots * sizeof(KeyValue) + numSlots + alignment];
+        slots_ = reinterpret_cast<KeyValue*>(((size_t)buffer_ + alignment - 1) & ~(size_t)(alignment - 1));
+        distances_ = reinterpret_cast<unsigned char*>(slots_ + numSlots);
+        memset(distances_, 0, numSlots);
+
+        capacity_ = numSlots;
+        size_ = 0;
+        shift_ = 32;
+        for (unsigned i = numSlots; i > 1; i >>= 1)
+            --shift_;
+
+        for (unsigned i = 0; i < oldCapacity; ++i)
+        {
+            if (oldDistances[i])
+            {
+                InsertNew(oldSlots[i].first, oldSlots[i].second);
+                oldSlots[i].~KeyValue();
+            }
+        }
+
+        delete[] oldBuffer;
+    }
+
+    /// Allocation holding the pairs followed by the distances.
+    unsigned char* buffer_;
+    /// Aligned pair array.
+    KeyValue* slots_;
+    /// Probe distance plus one for every slot, zero when empty.
+    unsigned char* distances_;
+    /// Number of slots.
+    unsigned capacity_;
+    /// Number of pairs.
+    unsigned size_;
+    /// Right shift that maps a 32 bit hash to a slot.
+    unsigned shift_;
+};
+
+}
+
+template <class T, class U> typename YumeEngine::OpenHashMap<T, U>::ConstIterator begin(const YumeEngine::OpenHashMap<T, U>& v) { return v.begin(); }
+
+template <class T, class U> typename YumeEngine::OpenHashMap<T, U>::ConstIterator end(const YumeEngine::OpenHashMap<T, U>& v) { return v.end(); }
+
+template <class T, class U> typename YumeEngine::OpenHashMap<T, U>::Iterator begin(YumeEngine::OpenHashMap<T, U>& v) { return v.begin(); }
+
+template <class T, class U> typename YumeEngine::OpenHashMap<T, U>::Iterator end(YumeEngine::OpenHashMap<T, U>& v) { return v.end(); }
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,466 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : SmallVector.h
+// Date : <Date>
+// Comments : Vector with inline storage for its first elements
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeSmallVector_h__
+#define __YumeSmallVector_h__
+//----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Vector.h"
+
+#include <cassert>
+#include <new>
+#include <type_traits>
+
+namespace YumeEngine
+{
+
+/// %Vector template class that keeps up to N elements inside the object and only allocates once it grows past that.
+/// Same interface as Vector. Swapping or moving a small vector copies its elements while they are inline.
+template <class T, unsigned N> class SmallVector : public VectorBase
+{
+public:
+    typedef T ValueType;
+    typedef RandomAccessIterator<T> Iterator;
+    typedef RandomAccessConstIterator<T> ConstIterator;
+
+    /// Construct empty.
+    SmallVector()
+    {
+        UseInlineBuffer();
+    }
+
+    /// Construct with initial size.
+    explicit SmallVector(unsigned size)
+    {
+        UseInlineBuffer();
+        resize(size, 0);
+    }
+
+    /// Construct with initial data.
+    SmallVector(const T* data, unsigned size)
+    {
+        UseInlineBuffer();
+        resize(size, data);
+    }
+
+    /// Construct from another small vector.
+    SmallVector(const SmallVector<T, N>& vector)
+    {
+        UseInlineBuffer();
+        resize(vector.size_, vector.Buffer());
+    }
+
+    /// Construct from a vector.
+    SmallVector(const Vector<T>& vector)
+    {
+        UseInlineBuffer();
+        resize(vector.size(), vector.size() ? &vector.front() : 0);
+    }
+
+    /// Destruct.
+    ~SmallVector()
+    {
+        clear();
+        if (!IsInline())
+            FreeBuffer(buffer_);
+    }
+
+    /// Assign from another small vector.
+    SmallVector<T, N>& operator =(const SmallVector<T, N>& rhs)
+    {
+        if (&rhs != this)
+        {
+            clear();
+            resize(rhs.size_, rhs.Buffer());
+        }
+        return *this;
+    }
+
+    /// Assign from a vector.
+    SmallVector<T, N>& operator =(const Vector<T>& rhs)
+    {
+        clear();
+        resize(rhs.size(), rhs.size() ? &rhs.front() : 0);
+        return *this;
+    }
+
+    /// Add-assign an element.
+    SmallVector<T, N>& operator +=(const T& rhs)
+    {
+        push_back(rhs);
+        return *this;
+    }
+
+    /// Add-assign another small vector.
+    SmallVector<T, N>& operator +=(const SmallVector<T, N>& rhs)
+    {
+        push_back(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another small vector.
+    bool operator ==(const SmallVector<T, N>& rhs) const
+    {
+        if (rhs.size_ != size_)
+            return false;
+
+        T* buffer = Buffer();
+        T* rhsBuffer = rhs.Buffer();
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            if (buffer[i] != rhsBuffer[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another small vector.
+    bool operator !=(const SmallVector<T, N>& rhs) const { return !(*this == rhs); }
+
+    /// Return element at index.
+    T& operator [](unsigned index)
+    {
+        assert(index < size_);
+        return Buffer()[index];
+    }
+
+    /// Return const element at index.
+    const T& operator [](unsigned index) const
+    {
+        assert(index < size_);
+        return Buffer()[index];
+    }
+
+    /// Return element at index.
+    T& At(unsigned index)
+    {
+        assert(index < size_);
+        return Buffer()[index];
+    }
+
+    /// Return const element at index.
+    const T& At(unsigned index) const
+    {
+        assert(index < size_);
+        return Buffer()[index];
+    }
+
+    /// Add an element at the end.
+    void push_back(const T& value) { resize(size_ + 1, &value); }
+
+    /// Add another small vector at the end.
+    void push_back(const SmallVector<T, N>& vector) { resize(size_ + vector.size_, vector.Buffer()); }
+
+    /// Remove the last element.
+    void Pop()
+    {
+        if (size_)
+            resize(size_ - 1, 0);
+    }
+
+    /// insert an element at position.
+    void insert(unsigned pos, const T& value)
+    {
+        if (pos > size_)
+            pos = size_;
+
+        // Copy first, value may live in the buffer that is about to move
+        T copy(value);
+        unsigned oldSize = size_;
+        resize(size_ + 1, 0);
+        MoveRange(pos + 1, pos, oldSize - pos);
+        Buffer()[pos] = copy;
+    }
+
+    /// insert an element by iterator.
+    Iterator insert(const Iterator& dest, const T& value)
+    {
+        unsigned pos = (unsigned)(dest - begin());
+        if (pos > size_)
+            pos = size_;
+        insert(pos, value);
+
+        return begin() + pos;
+    }
+
+    /// Erase a range of elements.
+    void erase(unsigned pos, unsigned length = 1)
+    {
+        // Return if the range is illegal
+        if (pos + length > size_ || !length)
+            return;
+
+        MoveRange(pos, pos + length, size_ - pos - length);
+        resize(size_ - length, 0);
+    }
+
+    /// Erase an element by iterator. Return iterator to the next element.
+    Iterator erase(const Iterator& it)
+    {
+        unsigned pos = (unsigned)(it - begin());
+        if (pos >= size_)
+            return end();
+        erase(pos);
+
+        return begin() + pos;
+    }
+
+    /// Erase a range by iterators. Return iterator to the next element.
+    Iterator erase(const Iterator& start, const Iterator& end)
+    {
+        unsigned pos = (unsigned)(start - begin());
+        if (pos >= size_)
+            return this->end();
+        unsigned length = (unsigned)(end - start);
+        erase(pos, length);
+
+        return begin() + pos;
+    }
+
+    /// Erase an element if found.
+    bool Remove(const T& value)
+    {
+        Iterator i = find(value);
+        if (i != end())
+        {
+            erase(i);
+            return true;
+        }
+        else
+            return false;
+    }
+
+    /// Clear the vector.
+    void clear() { resize(0); }
+
+    /// Resize the vector.
+    void resize(unsigned newSize) { resize(newSize, 0); }
+
+    /// Set new capacity. Never goes below the inline capacity.
+    void reserve(unsigned newCapacity)
+    {
+        if (newCapacity < size_)
+            newCapacity = size_;
+        if (newCapacity < N)
+            newCapacity = N;
+
+        if (newCapacity != capacity_)
+            Reallocate(newCapacity, 0, 0);
+    }
+
+    /// Reallocate so that no extra memory is used, moving back to the inline storage if the elements fit.
+    void Compact() { reserve(size_); }
+
+    /// Swap with another small vector.
+    void Swap(SmallVector<T, N>& rhs)
+    {
+        if (IsInline() || rhs.IsInline())
+        {
+            SmallVector<T, N> temp(rhs);
+            rhs = *this;
+            *this = temp;
+        }
+        else
+            VectorBase::Swap(rhs);
+    }
+
+    /// Return iterator to value, or to the end if not found.
+    Iterator find(const T& value)
+    {
+        Iterator it = begin();
+        while (it != end() && *it != value)
+            ++it;
+        return it;
+    }
+
+    /// Return const iterator to value, or to the end if not found.
+    ConstIterator find(const T& value) const
+    {
+        ConstIterator it = begin();
+        while (it != end() && *it != value)
+            ++it;
+        return it;
+    }
+
+    /// Return whether contains a specific value.
+    bool Contains(const T& value) const { return find(value) != end(); }
+
+    /// Return iterator to the beginning.
+    Iterator begin() { return Iterator(Buffer()); }
+
+    /// Return const iterator to the beginning.
+    ConstIterator begin() const { return ConstIterator(Buffer()); }
+
+    /// Return iterator to the end.
+    Iterator end() { return Iterator(Buffer() + size_); }
+
+    /// Return const iterator to the end.
+    ConstIterator end() const { return ConstIterator(Buffer() + size_); }
+
+    /// Return first element.
+    T& front()
+    {
+        assert(size_);
+        return Buffer()[0];
+    }
+
+    /// Return const first element.
+    const T& front() const
+    {
+        assert(size_);
+        return Buffer()[0];
+    }
+
+    /// Return last element.
+    T& back()
+    {
+        assert(size_);
+        return Buffer()[size_ - 1];
+    }
+
+    /// Return const last element.
+    const T& back() const
+    {
+        assert(size_);
+        return Buffer()[size_ - 1];
+    }
+
+    /// Return size of vector.
+    unsigned size() const { return size_; }
+
+    /// Return capacity of vector.
+    unsigned capacity() const { return capacity_; }
+
+    /// Return whether vector is empty.
+    bool empty() const { return size_ == 0; }
+
+    /// Return whether the elements are still in the inline storage.
+    bool IsInline() const { return buffer_ == reinterpret_cast<const unsigned char*>(&inline_); }
+
+    /// Return the inline capacity.
+    static unsigned InlineCapacity() { return N; }
+
+private:
+    /// Return the buffer with right type.
+    T* Buffer() const { return reinterpret_cast<T*>(buffer_); }
+
+    /// Point the buffer at the inline storage.
+    void UseInlineBuffer()
+    {
+        buffer_ = reinterpret_cast<unsigned char*>(&inline_);
+        capacity_ = N;
+    }
+
+    /// Move the elements to a buffer of newCapacity, then construct count elements from src after them.
+    void Reallocate(unsigned newCapacity, const T* src, unsigned count)
+    {
+        unsigned char* newBuffer = newCapacity > N ? AllocateBuffer((unsigned)(newCapacity * sizeof(T))) :
+            reinterpret_cast<unsigned char*>(&inline_);
+        if (newBuffer == buffer_)
+            return;
+
+        T* newElements = reinterpret_cast<T*>(newBuffer);
+        ConstructElements(newElements, Buffer(), size_);
+        // Source may point into the old buffer, so it is released last
+        if (count)
+            ConstructElements(newElements + size_, src, count);
+        DestructElements(Buffer(), size_);
+        if (!IsInline())
+            FreeBuffer(buffer_);
+
+        buffer_ = newBuffer;
+        capacity_ = newCapacity > N ? newCapacity : N;
+    }
+
+    /// Resize the vector and create/remove new elements as necessary.
+    void resize(unsigned newSize, const T* src)
+    {
+        // If size shrinks, destruct the removed elements
+        if (newSize < size_)
+            DestructElements(Buffer() + newSize, size_ - newSize);
+        else if (newSize > capacity_)
+        {
+            unsigned newCapacity = capacity_;
+            while (newCapacity < newSize)
+                newCapacity += (newCapacity + 1) >> 1;
+
+            Reallocate(newCapacity, src, newSize - size_);
+        }
+        else
+        {
+            // Initialize the new elements
+            ConstructElements(Buffer() + size_, src, newSize - size_);
+        }
+
+        size_ = newSize;
+    }
+
+    /// Move a range of elements within the vector.
+    void MoveRange(unsigned dest, unsigned src, unsigned count)
+    {
+        T* buffer = Buffer();
+        if (src < dest)
+        {
+            for (unsigned i = count - 1; i < count; --i)
+                buffer[dest + i] = buffer[src + i];
+        }
+        if (src > dest)
+        {
+            for (unsigned i = 0; i < count; ++i)
+                buffer[dest + i] = buffer[src + i];
+        }
+    }
+
+    /// Construct elements, optionally with source data.
+    static void ConstructElements(T* dest, const T* src, unsigned count)
+    {
+        if (!src)
+        {
+            for (unsigned i = 0; i < count; ++i)
+                new(dest + i) T();
+        }
+        else
+        {
+            for (unsigned i = 0; i < count; ++i)
+                new(dest + i) T(*(src + i));
+        }
+    }
+
+    // Call the elements' destructors.
+    static void DestructElements(T* dest, unsigned count)
+    {
+        while (count--)
+        {
+            dest->~T();
+            ++dest;
+        }
+    }
+
+    /// Inline storage for N elements.
+    typename std::aligned_storage<sizeof(T) * N, std::alignment_of<T>::value>::type inline_;
+};
+
+}
+
+#endif
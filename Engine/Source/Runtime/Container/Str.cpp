@@ -41,7 +41,8 @@ const String String::EMPTY;
 String::String(const WString& str) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     SetUTF8FromWChar(str.c_str());
 }
@@ -49,7 +50,8 @@ String::String(const WString& str) :
 String::String(int value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%d", value);
@@ -59,7 +61,8 @@ String::String(int value) :
 String::String(short value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%d", value);
@@ -69,7 +72,8 @@ String::String(short value) :
 String::String(long value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%ld", value);
@@ -79,7 +83,8 @@ String::String(long value) :
 String::String(long long value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%lld", value);
@@ -89,7 +94,8 @@ String::String(long long value) :
 String::String(unsigned value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%u", value);
@@ -99,7 +105,8 @@ String::String(unsigned value) :
 String::String(unsigned short value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%u", value);
@@ -109,7 +116,8 @@ String::String(unsigned short value) :
 String::String(unsigned long value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%lu", value);
@@ -119,7 +127,8 @@ String::String(unsigned long value) :
 String::String(unsigned long long value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%llu", value);
@@ -129,7 +138,8 @@ String::String(unsigned long long value) :
 String::String(float value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%g", value);
@@ -139,7 +149,8 @@ String::String(float value) :
 String::String(double value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     char tempBuffer[CONVERSION_BUFFER_LENGTH];
     sprintf(tempBuffer, "%.15g", value);
@@ -149,7 +160,8 @@ String::String(double value) :
 String::String(bool value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     if (value)
         *this = "true";
@@ -160,7 +172,8 @@ String::String(bool value) :
 String::String(char value) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     resize(1);
     buffer_[0] = value;
@@ -169,7 +182,8 @@ String::String(char value) :
 String::String(char value, unsigned length) :
     length_(0),
     capacity_(0),
-    buffer_(&endZero)
+    buffer_(&endZero),
+    inlineBuffer_(0)
 {
     resize(length);
     for (unsigned i = 0; i < length; ++i)
@@ -441,7 +455,8 @@ void String::resize(unsigned newLength)
             // Move the existing data to the new buffer, then delete the old buffer
             if (length_)
                 CopyChars(newBuffer, buffer_, length_);
-            delete[] buffer_;
+            if (buffer_ != inlineBuffer_)
+                delete[] buffer_;
 
             buffer_ = newBuffer;
         }
@@ -457,11 +472,14 @@ void String::Reserve(unsigned newCapacity)
         newCapacity = length_ + 1;
     if (newCapacity == capacity_)
         return;
+    // Inline storage can not shrink, and keeping it beats allocating a smaller buffer
+    if (buffer_ == inlineBuffer_ && newCapacity < capacity_)
+        return;
 
     char* newBuffer = new char[newCapacity];
     // Move the existing data to the new buffer, then delete the old buffer
     CopyChars(newBuffer, buffer_, length_ + 1);
-    if (capacity_)
+    if (OwnsBuffer())
         delete[] buffer_;
 
     capacity_ = newCapacity;
@@ -481,6 +499,15 @@ void String::Clear()
 
 void String::Swap(String& str)
 {
+    // Inline storage stays with its object, so small strings swap by copy
+    if (buffer_ == inlineBuffer_ || str.buffer_ == str.inlineBuffer_)
+    {
+        String temp(str);
+        str = *this;
+        *this = temp;
+        return;
+    }
+
     YumeEngine::Swap(length_, str.length_);
     YumeEngine::Swap(capacity_, str.capacity_);
     YumeEngine::Swap(buffer_, str.buffer_);
@@ -49,7 +49,8 @@ public:
     String() :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
     }
 
@@ -57,7 +58,8 @@ public:
     String(const String& str) :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
         *this = str;
     }
@@ -66,7 +68,8 @@ public:
     String(const char* str) :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
         *this = str;
     }
@@ -75,7 +78,8 @@ public:
     String(char* str) :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
         *this = (const char*)str;
     }
@@ -84,7 +88,8 @@ public:
     String(const char* str, unsigned length) :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
         resize(length);
         CopyChars(buffer_, str, length);
@@ -94,7 +99,8 @@ public:
     String(const wchar_t* str) :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
         SetUTF8FromWChar(str);
     }
@@ -103,7 +109,8 @@ public:
     String(wchar_t* str) :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
         SetUTF8FromWChar(str);
     }
@@ -142,7 +149,8 @@ public:
     template <class T> explicit String(const T& value) :
         length_(0),
         capacity_(0),
-        buffer_(&endZero)
+        buffer_(&endZero),
+        inlineBuffer_(0)
     {
         *this = value.ToString();
     }
@@ -150,7 +158,7 @@ public:
     /// Destruct.
     ~String()
     {
-        if (capacity_)
+        if (OwnsBuffer())
             delete[] buffer_;
     }
 
@@ -509,7 +517,21 @@ public:
     /// Empty string.
     static const String EMPTY;
 
+protected:
+    /// Construct empty over storage owned by a derived class. The string uses it until it grows past inlineCapacity - 1 characters.
+    String(char* inlineBuffer, unsigned inlineCapacity) :
+        length_(0),
+        capacity_(inlineCapacity),
+        buffer_(inlineBuffer),
+        inlineBuffer_(inlineBuffer)
+    {
+        buffer_[0] = 0;
+    }
+
 private:
+    /// Return whether the buffer was allocated by the string and must be deleted.
+    bool OwnsBuffer() const { return capacity_ && buffer_ != inlineBuffer_; }
+
     /// Move a range of characters within the string.
     void MoveRange(unsigned dest, unsigned src, unsigned count)
     {
@@ -543,11 +565,71 @@ private:
     unsigned capacity_;
     /// String buffer, null if not allocated.
     char* buffer_;
+    /// Storage of a SmallString, null otherwise.
+    char* inlineBuffer_;
 
     /// End zero for empty strings.
     static char endZero;
 };
 
+/// %String with inline storage for up to N - 1 characters. Only allocates once it grows longer, so short names and tokens can be built without touching the heap.
+template <unsigned N> class SmallString : public String
+{
+public:
+    using String::operator =;
+
+    /// Construct empty.
+    SmallString() :
+        String(inline_, N)
+    {
+    }
+
+    /// Construct from another small string.
+    SmallString(const SmallString<N>& str) :
+        String(inline_, N)
+    {
+        String::operator =(str);
+    }
+
+    /// Construct from a string.
+    SmallString(const String& str) :
+        String(inline_, N)
+    {
+        String::operator =(str);
+    }
+
+    /// Construct from a C string.
+    SmallString(const char* str) :
+        String(inline_, N)
+    {
+        String::operator =(str);
+    }
+
+    /// Construct from a char array and length.
+    SmallString(const char* str, unsigned length) :
+        String(inline_, N)
+    {
+        append(str, length);
+    }
+
+    /// Assign another small string.
+    SmallString<N>& operator =(const SmallString<N>& rhs)
+    {
+        String::operator =(rhs);
+        return *this;
+    }
+
+    /// Return as a plain string. Lets the String templates that take any convertable value accept a small string.
+    const String& ToString() const { return *this; }
+
+    /// Return whether the characters are still in the inline storage.
+    bool IsInline() const { return c_str() == inline_; }
+
+private:
+    /// Inline storage.
+    char inline_[N];
+};
+
 /// Add a string to a C string.
 inline String operator +(const char* lhs, const String& rhs)
 {
@@ -73,7 +73,7 @@ public:
     ~Vector()
     {
         clear();
-        delete[] buffer_;
+        FreeBuffer(buffer_);
     }
 
     /// Assign from another vector.
@@ -352,7 +352,7 @@ public:
 
             // Delete the old buffer
             DestructElements(Buffer(), size_);
-            delete[] buffer_;
+            FreeBuffer(buffer_);
             buffer_ = reinterpret_cast<unsigned char*>(newBuffer);
         }
     }
@@ -458,7 +458,7 @@ private:
                 {
                     ConstructElements(reinterpret_cast<T*>(newBuffer), Buffer(), size_);
                     DestructElements(Buffer(), size_);
-                    delete[] buffer_;
+                    FreeBuffer(buffer_);
                 }
                 buffer_ = newBuffer;
             }
@@ -554,7 +554,7 @@ public:
     /// Destruct.
     ~PODVector()
     {
-        delete[] buffer_;
+        FreeBuffer(buffer_);
     }
 
     /// Assign from another vector.
@@ -827,7 +827,7 @@ public:
             if (buffer_)
             {
                 CopyElements(reinterpret_cast<T*>(newBuffer), Buffer(), size_);
-                delete[] buffer_;
+                FreeBuffer(buffer_);
             }
             buffer_ = newBuffer;
         }
@@ -854,7 +854,7 @@ public:
             }
 
             // Delete the old buffer
-            delete[] buffer_;
+            FreeBuffer(buffer_);
             buffer_ = newBuffer;
         }
     }
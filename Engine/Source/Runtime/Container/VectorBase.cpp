@@ -29,7 +29,15 @@ namespace YumeEngine
 
 unsigned char* VectorBase::AllocateBuffer(unsigned size)
 {
-    return new unsigned char[size];
+    unsigned char* buffer = new unsigned char[size];
+    YUME_TRACK_ALLOC(buffer, size, YUME_MEM_CONTAINERS);
+    return buffer;
+}
+
+void VectorBase::FreeBuffer(unsigned char* buffer)
+{
+    YUME_TRACK_DEALLOC(buffer);
+    delete[] buffer;
 }
 
 }
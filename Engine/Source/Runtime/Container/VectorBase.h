@@ -259,6 +259,8 @@ public:
 
 protected:
     static unsigned char* AllocateBuffer(unsigned size);
+    /// Free a buffer returned by AllocateBuffer.
+    static void FreeBuffer(unsigned char* buffer);
 
     /// Size of vector.
     unsigned size_;
@@ -69,6 +69,7 @@ struct YumeAPIExport GlobalSystems : public YumeEngine::RefCounted
 	YumeEngine::SharedPtr<YumeEngine::YumeTime>								pTimer;
 	YumeEngine::SharedPtr<YumeEngine::YumeUI>								pUI;
 	YumeEngine::SharedPtr<YumeEngine::YumeWorkQueue>						pWorkSystem;
+	YumeEngine::SharedPtr<YumeEngine::YumeFrameArena>						pFrameArena;
 	YumeEngine::SharedPtr<YumeEngine::YumeEnvironment>						pEnv;
 	YumeEngine::SharedPtr<YumeEngine::YumeInput>							pInput;
 	YumeEngine::SharedPtr<YumeEngine::YumeObjectFactory>					pObjFactory;
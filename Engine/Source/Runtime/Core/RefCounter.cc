@@ -27,11 +27,11 @@
 namespace YumeEngine
 {
 
-	RefCounted::RefCounted():
-		refCount_(new RefCount())
+	RefCounted::RefCounted(RefCountMode mode):
+		refCount_(new RefCount(mode))
 	{
 		// Hold a weak ref to self to avoid possible double delete of the refcount
-		(refCount_->weakRefs_)++;
+		refCount_->AddWeakRef();
 	}
 
 	RefCounted::~RefCounted()
@@ -41,9 +41,8 @@ namespace YumeEngine
 		assert(refCount_->weakRefs_ > 0);
 
 		// Mark object as expired, release the self weak ref and delete the refcount if no other weak refs exist
-		refCount_->refs_ = -1;
-		(refCount_->weakRefs_)--;
-		if(!refCount_->weakRefs_)
+		refCount_->refs_.store(-1,std::memory_order_release);
+		if(!refCount_->ReleaseWeakRef())
 			delete refCount_;
 
 		refCount_ = 0;
@@ -52,14 +51,13 @@ namespace YumeEngine
 	void RefCounted::AddRef()
 	{
 		assert(refCount_->refs_ >= 0);
-		(refCount_->refs_)++;
+		refCount_->AddRef();
 	}
 
 	void RefCounted::ReleaseRef()
 	{
 		assert(refCount_->refs_ > 0);
-		(refCount_->refs_)--;
-		if(!refCount_->refs_)
+		if(!refCount_->ReleaseRef())
 			delete this;
 	}
 
@@ -23,17 +23,28 @@
 #define __RefCounter_h__
 //----------------------------------------------------------------------------
 #include "YumeRequired.h"
+
+#include <atomic>
 //----------------------------------------------------------------------------
 namespace YumeEngine
 {
+	/// How a RefCounted object updates its counts.
+	enum RefCountMode
+	{
+		/// Atomic read-modify-write, the object may be shared between threads.
+		REFCOUNT_ATOMIC = 0,
+		/// Plain load and store, for objects that never leave the thread that created them.
+		REFCOUNT_THREAD_LOCAL
+	};
 
 	/// Reference count structure.
 	struct RefCount
 	{
 		/// Construct.
-		RefCount():
+		RefCount(RefCountMode mode = REFCOUNT_ATOMIC):
 			refs_(0),
-			weakRefs_(0)
+			weakRefs_(0),
+			mode_(mode)
 		{
 		}
 
@@ -41,14 +52,64 @@ namespace YumeEngine
 		~RefCount()
 		{
 			// Set reference counts below zero to fire asserts if this object is still accessed
-			refs_ = -1;
-			weakRefs_ = -1;
+			refs_.store(-1,std::memory_order_relaxed);
+			weakRefs_.store(-1,std::memory_order_relaxed);
+		}
+
+		/// Increment the reference count. Relaxed, a new reference is always made from one the caller already holds.
+		int AddRef() { return Add(refs_,1,std::memory_order_relaxed); }
+		/// Decrement the reference count and return the new value. Acquire-release, so whoever drops the last reference sees every write made through the others.
+		int ReleaseRef() { return Add(refs_,-1,std::memory_order_acq_rel); }
+		/// Increment the reference count only while it is above zero and return whether it did. Lets a weak pointer take a reference without reviving an object whose last reference is being released.
+		bool TryAddRef()
+		{
+			int refs = refs_.load(std::memory_order_relaxed);
+			if(mode_ != REFCOUNT_ATOMIC)
+			{
+				if(refs <= 0)
+					return false;
+				refs_.store(refs + 1,std::memory_order_relaxed);
+				return true;
+			}
+
+			while(refs > 0)
+			{
+				if(refs_.compare_exchange_weak(refs,refs + 1,std::memory_order_acquire,std::memory_order_relaxed))
+					return true;
+			}
+			return false;
 		}
+		/// Increment the weak reference count.
+		int AddWeakRef() { return Add(weakRefs_,1,std::memory_order_relaxed); }
+		/// Decrement the weak reference count and return the new value.
+		int ReleaseWeakRef() { return Add(weakRefs_,-1,std::memory_order_acq_rel); }
+
+		/// Return the reference count.
+		int Refs() const { return refs_.load(std::memory_order_relaxed); }
+		/// Return the weak reference count.
+		int WeakRefs() const { return weakRefs_.load(std::memory_order_relaxed); }
+		/// Return the update mode.
+		RefCountMode GetMode() const { return mode_; }
 
 		/// Reference count. If below zero, the object has been destroyed.
-		int refs_;
+		std::atomic<int> refs_;
 		/// Weak reference count.
-		int weakRefs_;
+		std::atomic<int> weakRefs_;
+
+	private:
+		/// Add to a count and return the new value.
+		int Add(std::atomic<int>& count,int delta,std::memory_order order)
+		{
+			if(mode_ == REFCOUNT_ATOMIC)
+				return count.fetch_add(delta,order) + delta;
+
+			int value = count.load(std::memory_order_relaxed) + delta;
+			count.store(value,std::memory_order_relaxed);
+			return value;
+		}
+
+		/// Update mode.
+		RefCountMode mode_;
 	};
 
 	/// Base class for intrusively reference-counted objects. These are noncopyable and non-assignable.
@@ -56,7 +117,8 @@ namespace YumeEngine
 	{
 	public:
 		/// Construct. Allocate the reference count structure and set an initial self weak reference.
-		RefCounted();
+		/// Atomic by default, pass REFCOUNT_THREAD_LOCAL only for objects that are never shared with another thread.
+		RefCounted(RefCountMode mode = REFCOUNT_ATOMIC);
 		/// Destruct. Mark as expired and also delete the reference count structure if no outside weak references exist.
 		virtual ~RefCounted();
 
@@ -149,9 +149,9 @@ namespace YumeEngine
 			if(ptr_)
 			{
 				RefCount* refCount = RefCountPtr();
-				++refCount->refs_; // 2 refs
+				refCount->AddRef(); // 2 refs
 				Reset(); // 1 ref
-				--refCount->refs_; // 0 refs
+				refCount->ReleaseRef(); // 0 refs
 			}
 		}
 
@@ -339,13 +339,16 @@ namespace YumeEngine
 			return *this;
 		}
 
-		/// Convert to a shared pointer. If expired, return a null shared pointer.
+		/// Convert to a shared pointer. If expired, or the last shared reference is being released, return a null shared pointer.
 		SharedPtr<T> Lock() const
 		{
-			if(Expired())
+			if(!refCount_ || !refCount_->TryAddRef())
 				return SharedPtr<T>();
-			else
-				return SharedPtr<T>(ptr_);
+
+			//The reference taken above keeps the object alive until the shared pointer holds its own
+			SharedPtr<T> ret(ptr_);
+			refCount_->ReleaseRef();
+			return ret;
 		}
 
 		/// Return raw pointer. If expired, return null.
@@ -427,7 +430,7 @@ namespace YumeEngine
 		bool NotNull() const { return refCount_ != 0; }
 
 		/// Return the object's reference count, or 0 if null pointer or if object has expired.
-		int Refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_ : 0; }
+		int Refs() const { return (refCount_ && refCount_->Refs() >= 0) ? refCount_->Refs() : 0; }
 
 		/// Return the object's weak reference count.
 		int WeakRefs() const
@@ -435,7 +438,7 @@ namespace YumeEngine
 			if(!Expired())
 				return ptr_->WeakRefs();
 			else
-				return refCount_ ? refCount_->weakRefs_ : 0;
+				return refCount_ ? refCount_->WeakRefs() : 0;
 		}
 
 		/// Return whether the object has expired. If null pointer, always return true.
@@ -456,7 +459,7 @@ namespace YumeEngine
 			if(refCount_)
 			{
 				assert(refCount_->weakRefs_ >= 0);
-				++(refCount_->weakRefs_);
+				refCount_->AddWeakRef();
 			}
 		}
 
@@ -466,9 +469,9 @@ namespace YumeEngine
 			if(refCount_)
 			{
 				assert(refCount_->weakRefs_ > 0);
-				--(refCount_->weakRefs_);
 
-				if(Expired() && !refCount_->weakRefs_)
+				// The object holds a weak ref to itself until it is destroyed, so reaching zero means it has expired
+				if(!refCount_->ReleaseWeakRef())
 					delete refCount_;
 			}
 
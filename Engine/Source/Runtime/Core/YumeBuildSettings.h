@@ -40,4 +40,6 @@
 
 #define YUME_USE_PCH
 
+/* #undef YUME_SHIPPING */
+
 #endif
@@ -43,7 +43,21 @@
 #define YUME_MEMORY_ALLOCATOR YUME_MEMORY_ALLOCATOR_NEDPOOLING
 #endif
 
-#define YUME_SSE
+//Per category heap accounting and leak report, costs a lock and a map insert per tracked allocation
+#ifndef YUME_MEMORY_TRACKING
+#define YUME_MEMORY_TRACKING 0
+#endif
+
+//Scoped CPU profiler zones, compiled out of shipping builds
+#ifndef YUME_PROFILING
+#ifdef YUME_SHIPPING
+#define YUME_PROFILING 0
+#else
+#define YUME_PROFILING 1
+#endif
+#endif
+
+//YUME_SSE comes from the YUME_SSE option of the top level CMakeLists.txt
 #define YUME_THREADING
 //---------------------------------------------------------------------------------
 #endif
@@ -744,6 +744,27 @@ namespace YumeEngine
 		return dest;
 	}
 
+	void ParseFlags(const char* source,SmallStringVector::type& dest)
+	{
+		dest.clear();
+
+		const char* start = source;
+		while(*start)
+		{
+			while(*start == ' ')
+				++start;
+
+			const char* end = start;
+			while(*end && *end != ' ')
+				++end;
+
+			if(end != start)
+				dest.push_back(YumeSmallString(start,(unsigned)(end - start)));
+
+			start = end;
+		}
+	}
+
 
 	void BufferToString(YumeString& dest,const void* data,unsigned size)
 	{
@@ -81,6 +81,8 @@ namespace YumeEngine
 	YumeAPIExport DirectX::XMMATRIX ToMatrix4(const char* source);
 	YumeAPIExport YumeString ToString(void* value);
 	YumeAPIExport YumeVector<YumeString>::type ParseFlags(const char* source);
+	//Splits on spaces into inline storage, skips empty tokens
+	YumeAPIExport void ParseFlags(const char* source,SmallStringVector::type& dest);
 	YumeAPIExport YumeString ToStringHex(unsigned value);
 	YumeAPIExport void StringToBuffer(YumeVector<unsigned char>::type& dest,const YumeString& source);
 	YumeAPIExport void StringToBuffer(YumeVector<unsigned char>::type& dest,const char* source);
@@ -256,6 +256,13 @@ namespace YumeEngine
 	YumeString YumeFile::ReadString()
 	{
 		YumeString ret;
+		ReadString(ret);
+		return ret;
+	}
+
+	void YumeFile::ReadString(YumeString& dest)
+	{
+		dest.Clear();
 
 		while(!Eof())
 		{
@@ -263,10 +270,8 @@ namespace YumeEngine
 			if(!c)
 				break;
 			else
-				ret += c;
+				dest += c;
 		}
-
-		return ret;
 	}
 
 
@@ -73,6 +73,8 @@ namespace YumeEngine
 		bool WriteVariantData(const Variant& v);
 
 		YumeString ReadString();
+		//Reads into dest, keeps its storage so a YumeSmallString does not allocate for short strings
+		void ReadString(YumeString& dest);
 		signed char ReadByte();
 		unsigned ReadUInt();
 		int ReadInt();
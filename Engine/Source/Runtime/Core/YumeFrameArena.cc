@@ -0,0 +1,214 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeFrameArena.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeFrameArena.h"
+#include "YumeAlignedAllocator.h"
+
+#include "Math/YumeMath.h"
+
+#include "Logging/logging.h"
+
+namespace YumeEngine
+{
+	//Process wide so every arena agrees on which thread owns which slot
+	static Mutex threadSlotLock;
+	static unsigned nextThreadSlot = 0;
+	static thread_local unsigned threadSlot = M_MAX_UNSIGNED;
+
+	YumeLinearAllocator::YumeLinearAllocator()
+		: block_(0),
+		blockSize_(0),
+		capacity_(0),
+		offset_(0),
+		highWater_(0),
+		overflowBytes_(0),
+		numOverflows_(0)
+	{
+	}
+
+	YumeLinearAllocator::~YumeLinearAllocator()
+	{
+		Reset();
+		AlignedMemory::deallocate(block_);
+	}
+
+	void YumeLinearAllocator::SetCapacity(unsigned capacity)
+	{
+		capacity_ = capacity;
+	}
+
+	void* YumeLinearAllocator::Allocate(unsigned size,unsigned alignment)
+	{
+		if(!block_ && capacity_)
+		{
+			block_ = (unsigned char*)AlignedMemory::allocate(capacity_,FRAME_ARENA_ALIGNMENT);
+			blockSize_ = capacity_;
+		}
+
+		size_t address = (size_t)(block_ + offset_);
+		unsigned padding = (unsigned)(((address + alignment - 1) & ~(size_t)(alignment - 1)) - address);
+
+		void* ptr;
+		if(block_ && offset_ + padding + size <= blockSize_)
+		{
+			ptr = block_ + offset_ + padding;
+			offset_ += padding + size;
+		}
+		else
+		{
+			ptr = AlignedMemory::allocate(size,alignment);
+			overflow_.push_back(ptr);
+			overflowBytes_ += size;
+			++numOverflows_;
+		}
+
+		if(GetUsed() > highWater_)
+			highWater_ = GetUsed();
+
+		return ptr;
+	}
+
+	void YumeLinearAllocator::Reset()
+	{
+		for(unsigned i = 0; i < overflow_.size(); ++i)
+			AlignedMemory::deallocate(overflow_[i]);
+
+#if YUME_DEBUG_MODE
+		if(block_)
+			memset(block_,FRAME_ARENA_POISON,offset_);
+#endif
+
+		//Size the block for the worst frame so far, the next one will not spill
+		if(overflowBytes_ && highWater_ > capacity_)
+		{
+			capacity_ = highWater_ + highWater_ / 2;
+			AlignedMemory::deallocate(block_);
+			block_ = 0;
+			blockSize_ = 0;
+		}
+
+		overflow_.clear();
+		overflowBytes_ = 0;
+		offset_ = 0;
+	}
+
+	YumeFrameArena::YumeFrameArena(unsigned threadCapacity)
+		: buffer_(0),
+		frameNumber_(0),
+		reportedHighWater_(0)
+	{
+		for(unsigned i = 0; i < FRAME_ARENA_BUFFERS; ++i)
+		{
+			for(unsigned j = 0; j < MAX_FRAME_ARENA_THREADS; ++j)
+				allocators_[i][j].SetCapacity(threadCapacity);
+		}
+	}
+
+	YumeFrameArena::~YumeFrameArena()
+	{
+	}
+
+	void YumeFrameArena::BeginFrame()
+	{
+		++frameNumber_;
+		buffer_ = frameNumber_ % FRAME_ARENA_BUFFERS;
+
+		for(unsigned i = 0; i < MAX_FRAME_ARENA_THREADS; ++i)
+			allocators_[buffer_][i].Reset();
+
+#if YUME_DEBUG_MODE
+		unsigned highWater = GetHighWater();
+		if(highWater > reportedHighWater_)
+		{
+			reportedHighWater_ = highWater;
+			YUMELOG_DEBUG("Frame arena high water mark " << highWater << " bytes at frame " << frameNumber_);
+		}
+#endif
+	}
+
+	unsigned YumeFrameArena::GetThreadSlot()
+	{
+		if(threadSlot == M_MAX_UNSIGNED)
+		{
+			MutexLock lock(threadSlotLock);
+			threadSlot = nextThreadSlot < MAX_FRAME_ARENA_THREADS ? nextThreadSlot++ : MAX_FRAME_ARENA_THREADS - 1;
+		}
+
+		return threadSlot;
+	}
+
+	void* YumeFrameArena::Allocate(unsigned size,unsigned alignment)
+	{
+		unsigned slot = GetThreadSlot();
+
+		if(slot == MAX_FRAME_ARENA_THREADS - 1)
+		{
+			MutexLock lock(sharedSlotLock_);
+			return allocators_[buffer_][slot].Allocate(size,alignment);
+		}
+
+		return allocators_[buffer_][slot].Allocate(size,alignment);
+	}
+
+	unsigned YumeFrameArena::GetUsed() const
+	{
+		unsigned used = 0;
+		for(unsigned i = 0; i < MAX_FRAME_ARENA_THREADS; ++i)
+			used += allocators_[buffer_][i].GetUsed();
+		return used;
+	}
+
+	unsigned YumeFrameArena::GetHighWater() const
+	{
+		unsigned highWater = 0;
+		for(unsigned i = 0; i < FRAME_ARENA_BUFFERS; ++i)
+		{
+			for(unsigned j = 0; j < MAX_FRAME_ARENA_THREADS; ++j)
+			{
+				if(allocators_[i][j].GetHighWater() > highWater)
+					highWater = allocators_[i][j].GetHighWater();
+			}
+		}
+		return highWater;
+	}
+
+	unsigned YumeFrameArena::GetNumOverflows() const
+	{
+		unsigned overflows = 0;
+		for(unsigned i = 0; i < FRAME_ARENA_BUFFERS; ++i)
+		{
+			for(unsigned j = 0; j < MAX_FRAME_ARENA_THREADS; ++j)
+				overflows += allocators_[i][j].GetNumOverflows();
+		}
+		return overflows;
+	}
+
+	void YumeFrameArena::LogStats() const
+	{
+		YUMELOG_INFO("Frame arena: frames " << frameNumber_ << " high water " << GetHighWater() << " bytes, heap overflows " << GetNumOverflows());
+	}
+
+	void* FrameArenaAllocPolicy::allocateBytes(size_t count,const char*,int,const char*)
+	{
+		return gYume->pFrameArena->Allocate((unsigned)count);
+	}
+}
@@ -0,0 +1,198 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeFrameArena.h
+// Date : <Date>
+// Comments : Per thread linear allocators for memory that only lives for a frame
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeFrameArena_h__
+#define __YumeFrameArena_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Core/YumeMutex.h"
+
+#include <vector>
+#include <limits>
+#include <type_traits>
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	static const unsigned FRAME_ARENA_ALIGNMENT = 16;
+	static const unsigned FRAME_ARENA_BUFFERS = 2;
+	static const unsigned MAX_FRAME_ARENA_THREADS = 32;
+	static const unsigned DEFAULT_FRAME_ARENA_SIZE = 1024 * 1024;
+
+	//Debug builds fill released memory with this so stale frame pointers show up quickly
+	static const unsigned char FRAME_ARENA_POISON = 0xDD;
+
+	//Bump allocator over one block, never frees individual allocations.
+	//Requests that do not fit go to the heap until the next Reset, which grows the block to cover them.
+	class YumeAPIExport YumeLinearAllocator
+	{
+	public:
+		YumeLinearAllocator();
+		~YumeLinearAllocator();
+
+		//The block is allocated on first use
+		void SetCapacity(unsigned capacity);
+
+		//Alignment must be a power of two up to 128
+		void* Allocate(unsigned size,unsigned alignment = FRAME_ARENA_ALIGNMENT);
+
+		//Releases every allocation at once
+		void Reset();
+
+		unsigned GetCapacity() const { return capacity_; }
+		unsigned GetUsed() const { return offset_ + overflowBytes_; }
+		unsigned GetHighWater() const { return highWater_; }
+		unsigned GetNumOverflows() const { return numOverflows_; }
+
+	private:
+		unsigned char* block_;
+		unsigned blockSize_;
+		unsigned capacity_;
+		unsigned offset_;
+		unsigned highWater_;
+
+		YumePodVector<void*>::type overflow_;
+		unsigned overflowBytes_;
+		unsigned numOverflows_;
+	};
+
+	//One linear allocator per thread and per buffer. BeginFrame flips the buffer and resets it,
+	//so memory handed out in frame N stays valid through frame N + 1 for pipelined consumers.
+	//BeginFrame must not run while other threads are allocating.
+	class YumeAPIExport YumeFrameArena : public RefCounted
+	{
+	public:
+		YumeFrameArena(unsigned threadCapacity = DEFAULT_FRAME_ARENA_SIZE);
+		virtual ~YumeFrameArena();
+
+		void BeginFrame();
+
+		//Allocates from the calling thread's allocator
+		void* Allocate(unsigned size,unsigned alignment = FRAME_ARENA_ALIGNMENT);
+
+		template <typename T> T* Allocate(unsigned count)
+		{
+			return static_cast<T*>(Allocate(count * sizeof(T),std::alignment_of<T>::value));
+		}
+
+		unsigned GetFrameNumber() const { return frameNumber_; }
+		unsigned GetBufferIndex() const { return buffer_; }
+
+		//Bytes allocated by every thread in the current buffer
+		unsigned GetUsed() const;
+		//Largest amount any single thread allocator had in use
+		unsigned GetHighWater() const;
+		unsigned GetNumOverflows() const;
+
+		void LogStats() const;
+
+	private:
+		unsigned GetThreadSlot();
+
+		YumeLinearAllocator allocators_[FRAME_ARENA_BUFFERS][MAX_FRAME_ARENA_THREADS];
+		unsigned buffer_;
+		unsigned frameNumber_;
+		unsigned reportedHighWater_;
+
+		//Threads past MAX_FRAME_ARENA_THREADS share the last slot under this lock
+		Mutex sharedSlotLock_;
+	};
+
+	//Standard library allocator over a frame arena, deallocate is a no-op
+	template <typename T>
+	class FrameArenaSTLAllocator
+	{
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template <typename U> struct rebind
+		{
+			typedef FrameArenaSTLAllocator<U> other;
+		};
+
+		FrameArenaSTLAllocator(YumeFrameArena* arena)
+			: arena_(arena)
+		{
+		}
+
+		template <typename U> FrameArenaSTLAllocator(const FrameArenaSTLAllocator<U>& rhs)
+			: arena_(rhs.GetArena())
+		{
+		}
+
+		T* allocate(size_t count,const void* = 0)
+		{
+			return arena_->template Allocate<T>((unsigned)count);
+		}
+
+		void deallocate(T*,size_t)
+		{
+		}
+
+		size_t max_size() const
+		{
+			return std::numeric_limits<unsigned>::max() / sizeof(T);
+		}
+
+		YumeFrameArena* GetArena() const { return arena_; }
+
+		template <typename U> bool operator ==(const FrameArenaSTLAllocator<U>& rhs) const { return arena_ == rhs.GetArena(); }
+		template <typename U> bool operator !=(const FrameArenaSTLAllocator<U>& rhs) const { return arena_ != rhs.GetArena(); }
+
+	private:
+		YumeFrameArena* arena_;
+	};
+
+	template <typename T>
+	struct YumeFrameVector
+	{
+		typedef std::vector<T,FrameArenaSTLAllocator<T> > type;
+	};
+
+	//Allocation policy for YumeAllocatedObject and YUME_ALLOC_T, draws from gYume->pFrameArena
+	class YumeAPIExport FrameArenaAllocPolicy
+	{
+	public:
+		static void* allocateBytes(size_t count,const char* = 0,int = 0,const char* = 0);
+
+		static inline void deallocateBytes(void*)
+		{
+		}
+
+		static inline size_t getMaxAllocationSize()
+		{
+			return std::numeric_limits<unsigned>::max();
+		}
+
+	private:
+		FrameArenaAllocPolicy()
+		{ }
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -38,12 +38,56 @@ namespace YumeEngine
 	enum MemoryCategory
 	{
 		YUME_MEM_GENERAL = 0,
-		YUME_MEM_RENDERERS = 1
+		YUME_MEM_RENDERERS = 1,
+		YUME_MEM_RESOURCES,
+		YUME_MEM_UI,
+		YUME_MEM_SCENE,
+		YUME_MEM_CONTAINERS,
+		MAX_MEMORY_CATEGORIES
 	};
 }
 //---------------------------------------------------------------------------------
 #include "YumeMallocObject.h"
 #include "YumeMemoryAllocatorSTL.h"
+#include "YumeMemoryTracker.h"
+
+#if YUME_MEMORY_TRACKING
+namespace YumeEngine
+{
+	//Forwards to Policy and reports to the memory tracker
+	template <class Policy,MemoryCategory Cat>
+	class YumeTrackedAllocPolicy
+	{
+	public:
+		static inline void* allocateBytes(size_t count,
+			const char* file = 0,int line = 0,const char* func = 0)
+		{
+			void* ptr = Policy::allocateBytes(count,file,line,func);
+			YumeMemoryTracker::Get().RecordAlloc(ptr,count,Cat,file,line);
+			return ptr;
+		}
+
+		static inline void deallocateBytes(void* ptr)
+		{
+			YumeMemoryTracker::Get().RecordDealloc(ptr);
+			Policy::deallocateBytes(ptr);
+		}
+
+		static inline size_t getMaxAllocationSize()
+		{
+			return Policy::getMaxAllocationSize();
+		}
+	private:
+		YumeTrackedAllocPolicy()
+		{ }
+	};
+}
+
+#	define YUME_CATEGORISED_POLICY(Policy,Cat) YumeTrackedAllocPolicy<Policy,Cat>
+#else
+//Without tracking the categorised policies are the plain policies, nothing sits between them and the allocator
+#	define YUME_CATEGORISED_POLICY(Policy,Cat) Policy
+#endif
 
 //---------------------------------------------------------------------------------
 #if YUME_MEMORY_ALLOCATOR == YUME_MEMORY_ALLOCATOR_NEDPOOLING
@@ -51,8 +95,8 @@ namespace YumeEngine
 #include "YumeMemoryAllocatorNedPooling.h"
 namespace YumeEngine
 {
-	template <MemoryCategory Cat> class YumeCategorisedAllocPolicy : public NedPoolingPolicy{};
-	template <MemoryCategory Cat, size_t align = 0> class YumeCategorisedAlignAllocPolicy : public NedPoolingAlignedPolicy<align>{};
+	template <MemoryCategory Cat> class YumeCategorisedAllocPolicy : public YUME_CATEGORISED_POLICY(NedPoolingPolicy,Cat){};
+	template <MemoryCategory Cat, size_t align = 0> class YumeCategorisedAlignAllocPolicy : public YUME_CATEGORISED_POLICY(NedPoolingAlignedPolicy<align>,Cat){};
 };
 #endif
 //---------------------------------------------------------------------------------
@@ -61,8 +105,8 @@ namespace YumeEngine
 #include "YumeMemoryAllocatorNed.h"
 namespace YumeEngine
 {
-	template <MemoryCategory Cat> class YumeCategorisedAllocPolicy : public NedAllocPolicy{};
-	template <MemoryCategory Cat, size_t align = 0> class YumeCategorisedAlignAllocPolicy : public NedAlignedAllocPolicy<align>{};
+	template <MemoryCategory Cat> class YumeCategorisedAllocPolicy : public YUME_CATEGORISED_POLICY(NedAllocPolicy,Cat){};
+	template <MemoryCategory Cat, size_t align = 0> class YumeCategorisedAlignAllocPolicy : public YUME_CATEGORISED_POLICY(NedAlignedAllocPolicy<align>,Cat){};
 };
 
 #endif
@@ -73,8 +117,8 @@ namespace YumeEngine
 
 namespace YumeEngine
 {
-	template <MemoryCategory Cat> class YumeCategorisedAllocPolicy : public StdAllocPolicy{};
-	template <MemoryCategory Cat,size_t align = 0> class YumeCategorisedAlignAllocPolicy : public StdAlignedAllocPolicy<align>{};
+	template <MemoryCategory Cat> class YumeCategorisedAllocPolicy : public YUME_CATEGORISED_POLICY(StdAllocPolicy,Cat){};
+	template <MemoryCategory Cat,size_t align = 0> class YumeCategorisedAlignAllocPolicy : public YUME_CATEGORISED_POLICY(StdAlignedAllocPolicy<align>,Cat){};
 };
 
 #endif
@@ -84,13 +128,22 @@ namespace YumeEngine
 {
 	typedef YumeCategorisedAlignAllocPolicy<YumeEngine::YUME_MEM_GENERAL> YumeGeneralAllocPolicy;
 	typedef YumeCategorisedAlignAllocPolicy<YumeEngine::YUME_MEM_RENDERERS> YumeRendererAllocPolicy;
+	typedef YumeCategorisedAlignAllocPolicy<YumeEngine::YUME_MEM_RESOURCES> YumeResourceAllocPolicy;
+	typedef YumeCategorisedAlignAllocPolicy<YumeEngine::YUME_MEM_UI> YumeUIAllocPolicy;
+	typedef YumeCategorisedAlignAllocPolicy<YumeEngine::YUME_MEM_SCENE> YumeSceneAllocPolicy;
 
 	typedef YumeAllocatedObject<YumeGeneralAllocPolicy> YumeGeneralAllocatedObject;
 	typedef YumeAllocatedObject<YumeRendererAllocPolicy> YumeRendererAllocatedObject;
+	typedef YumeAllocatedObject<YumeResourceAllocPolicy> YumeResourceAllocatedObject;
+	typedef YumeAllocatedObject<YumeUIAllocPolicy> YumeUIAllocatedObject;
+	typedef YumeAllocatedObject<YumeSceneAllocPolicy> YumeSceneAllocatedObject;
 
 	typedef YumeGeneralAllocatedObject GeneralObjAlloc;
 	typedef YumeGeneralAllocatedObject LogObjAlloc;
 	typedef YumeRendererAllocatedObject RenderObjAlloc;
+	typedef YumeResourceAllocatedObject ResourceObjAlloc;
+	typedef YumeUIAllocatedObject UIObjAlloc;
+	typedef YumeSceneAllocatedObject SceneObjAlloc;
 	typedef YumeGeneralAllocatedObject DynamicLibAlloc;
 }
 
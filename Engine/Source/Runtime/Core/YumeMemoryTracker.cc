@@ -0,0 +1,233 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeMemoryTracker.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeMemoryTracker.h"
+#include "YumeMutex.h"
+
+#include "Logging/logging.h"
+
+#include <unordered_map>
+#include <vector>
+
+#if YUME_PLATFORM == YUME_PLATFORM_WIN32
+#include <Windows.h>
+#else
+#include <execinfo.h>
+#endif
+
+namespace YumeEngine
+{
+	static const unsigned MAX_REPORTED_LEAKS = 64;
+
+	static const char* categoryNames[] =
+	{
+		"General",
+		"Renderer",
+		"Resources",
+		"UI",
+		"Scene",
+		"Containers"
+	};
+
+	//Book keeping lives on the global heap, which is never tracked, so recording can not recurse
+	class YumeMemoryTrackerImpl
+	{
+	public:
+		Mutex lock_;
+		std::unordered_map<void*,TrackedAllocation> allocations_;
+		MemoryCategoryStats stats_[MAX_MEMORY_CATEGORIES];
+	};
+
+	MemoryCategoryStats::MemoryCategoryStats()
+		: LiveBytes(0),
+		PeakBytes(0),
+		LiveAllocations(0),
+		TotalAllocations(0),
+		FrameAllocations(0),
+		FrameBytes(0)
+	{
+	}
+
+	YumeMemoryTracker& YumeMemoryTracker::Get()
+	{
+		//Never destroyed, containers in other statics are released after any destructor here would run
+		static YumeMemoryTracker* tracker = new YumeMemoryTracker;
+		return *tracker;
+	}
+
+	YumeMemoryTracker::YumeMemoryTracker()
+		: impl_(new YumeMemoryTrackerImpl),
+		callstackThreshold_(0)
+	{
+	}
+
+	YumeMemoryTracker::~YumeMemoryTracker()
+	{
+		delete impl_;
+	}
+
+	void YumeMemoryTracker::RecordAlloc(void* ptr,size_t size,MemoryCategory category,const char* file,int line)
+	{
+		if(!ptr)
+			return;
+
+		TrackedAllocation allocation;
+		allocation.Size = size;
+		allocation.Category = category;
+		allocation.File = file;
+		allocation.Line = line;
+		allocation.CallstackDepth = 0;
+
+		if(callstackThreshold_ && size >= callstackThreshold_)
+		{
+#if YUME_PLATFORM == YUME_PLATFORM_WIN32
+			allocation.CallstackDepth = CaptureStackBackTrace(1,MAX_TRACKED_CALLSTACK,allocation.Callstack,0);
+#else
+			int depth = backtrace(allocation.Callstack,MAX_TRACKED_CALLSTACK);
+			allocation.CallstackDepth = depth > 0 ? depth : 0;
+#endif
+		}
+
+		MutexLock lock(impl_->lock_);
+
+		impl_->allocations_[ptr] = allocation;
+
+		MemoryCategoryStats& stats = impl_->stats_[category];
+		stats.LiveBytes += size;
+		++stats.LiveAllocations;
+		++stats.TotalAllocations;
+		++stats.FrameAllocations;
+		stats.FrameBytes += size;
+		if(stats.LiveBytes > stats.PeakBytes)
+			stats.PeakBytes = stats.LiveBytes;
+	}
+
+	void YumeMemoryTracker::RecordDealloc(void* ptr)
+	{
+		if(!ptr)
+			return;
+
+		MutexLock lock(impl_->lock_);
+
+		std::unordered_map<void*,TrackedAllocation>::iterator i = impl_->allocations_.find(ptr);
+		if(i == impl_->allocations_.end())
+			return;
+
+		MemoryCategoryStats& stats = impl_->stats_[i->second.Category];
+		stats.LiveBytes -= i->second.Size;
+		--stats.LiveAllocations;
+
+		impl_->allocations_.erase(i);
+	}
+
+	void YumeMemoryTracker::SetCallstackThreshold(size_t bytes)
+	{
+		callstackThreshold_ = bytes;
+	}
+
+	void YumeMemoryTracker::BeginFrame()
+	{
+		MutexLock lock(impl_->lock_);
+
+		for(unsigned i = 0; i < MAX_MEMORY_CATEGORIES; ++i)
+		{
+			impl_->stats_[i].FrameAllocations = 0;
+			impl_->stats_[i].FrameBytes = 0;
+		}
+	}
+
+	MemoryCategoryStats YumeMemoryTracker::GetStats(MemoryCategory category) const
+	{
+		MutexLock lock(impl_->lock_);
+		return impl_->stats_[category];
+	}
+
+	unsigned YumeMemoryTracker::GetLiveAllocations(TrackedAllocation* dest,unsigned maxCount) const
+	{
+		MutexLock lock(impl_->lock_);
+
+		unsigned count = 0;
+		for(std::unordered_map<void*,TrackedAllocation>::const_iterator i = impl_->allocations_.begin(); i != impl_->allocations_.end() && count < maxCount; ++i)
+			dest[count++] = i->second;
+
+		return (unsigned)impl_->allocations_.size();
+	}
+
+	const char* YumeMemoryTracker::GetCategoryName(MemoryCategory category)
+	{
+		return category < MAX_MEMORY_CATEGORIES ? categoryNames[category] : "Unknown";
+	}
+
+	void YumeMemoryTracker::LogStats() const
+	{
+		//Copy first, logging allocates and would wait on our own lock
+		MemoryCategoryStats stats[MAX_MEMORY_CATEGORIES];
+		for(unsigned i = 0; i < MAX_MEMORY_CATEGORIES; ++i)
+			stats[i] = GetStats((MemoryCategory)i);
+
+		for(unsigned i = 0; i < MAX_MEMORY_CATEGORIES; ++i)
+		{
+			YUMELOG_INFO("Memory " << categoryNames[i] << ": live " << stats[i].LiveBytes << " bytes in " << stats[i].LiveAllocations <<
+				" allocations, peak " << stats[i].PeakBytes << " bytes, " << stats[i].FrameAllocations << " allocations last frame");
+		}
+	}
+
+	void YumeMemoryTracker::ReportLeaks() const
+	{
+		//Copy under the lock, log after releasing it
+		std::vector<TrackedAllocation> leaks;
+		unsigned numLeaks = 0;
+		{
+			MutexLock lock(impl_->lock_);
+
+			leaks.reserve(MAX_REPORTED_LEAKS);
+			for(std::unordered_map<void*,TrackedAllocation>::const_iterator i = impl_->allocations_.begin(); i != impl_->allocations_.end(); ++i)
+			{
+				if(i->second.Category == YUME_MEM_CONTAINERS)
+					continue;
+
+				if(leaks.size() < MAX_REPORTED_LEAKS)
+					leaks.push_back(i->second);
+				++numLeaks;
+			}
+		}
+
+		if(!numLeaks)
+		{
+			YUMELOG_INFO("No memory leaks detected");
+			return;
+		}
+
+		YUMELOG_ERROR("Memory leaks detected: " << numLeaks << " allocations still live");
+		LogStats();
+
+		for(unsigned i = 0; i < leaks.size(); ++i)
+		{
+			const TrackedAllocation& leak = leaks[i];
+			YUMELOG_ERROR("Leaked " << leak.Size << " bytes (" << categoryNames[leak.Category] << ") at " <<
+				(leak.File ? leak.File : "unknown") << ":" << leak.Line);
+
+			for(unsigned j = 0; j < leak.CallstackDepth; ++j)
+				YUMELOG_ERROR("    " << leak.Callstack[j]);
+		}
+	}
+}
@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeMemoryTracker.h
+// Date : <Date>
+// Comments : Per category heap accounting, compiled out unless YUME_MEMORY_TRACKING is set
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeMemoryTracker_h__
+#define __YumeMemoryTracker_h__
+//----------------------------------------------------------------------------
+//Included from YumeMemoryAllocatorConfig.h after MemoryCategory, so this header can not use Yume containers
+#include <cstddef>
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	static const unsigned MAX_TRACKED_CALLSTACK = 16;
+
+	struct YumeAPIExport MemoryCategoryStats
+	{
+		MemoryCategoryStats();
+
+		size_t LiveBytes;
+		size_t PeakBytes;
+		unsigned LiveAllocations;
+		unsigned TotalAllocations;
+		//Since the last BeginFrame
+		unsigned FrameAllocations;
+		size_t FrameBytes;
+	};
+
+	struct YumeAPIExport TrackedAllocation
+	{
+		size_t Size;
+		MemoryCategory Category;
+		const char* File;
+		int Line;
+		unsigned CallstackDepth;
+		void* Callstack[MAX_TRACKED_CALLSTACK];
+	};
+
+	class YumeMemoryTrackerImpl;
+
+	//Thread safe. Keyed by pointer so a block can be released from anywhere without knowing its category.
+	class YumeAPIExport YumeMemoryTracker
+	{
+	public:
+		static YumeMemoryTracker& Get();
+
+		void RecordAlloc(void* ptr,size_t size,MemoryCategory category,const char* file = 0,int line = 0);
+		void RecordDealloc(void* ptr);
+
+		//Allocations of at least this many bytes keep their callstack, 0 turns sampling off
+		void SetCallstackThreshold(size_t bytes);
+		size_t GetCallstackThreshold() const { return callstackThreshold_; }
+
+		//Starts a new window for the allocation rate
+		void BeginFrame();
+
+		MemoryCategoryStats GetStats(MemoryCategory category) const;
+
+		//Copies up to maxCount live allocations, returns how many there are in total
+		unsigned GetLiveAllocations(TrackedAllocation* dest,unsigned maxCount) const;
+
+		void LogStats() const;
+		//Everything still live is reported as a leak, call once the engine and application are torn down.
+		//Container buffers only show up in the totals, a leaked owner is listed under its own category.
+		void ReportLeaks() const;
+
+		static const char* GetCategoryName(MemoryCategory category);
+
+	private:
+		YumeMemoryTracker();
+		~YumeMemoryTracker();
+
+		YumeMemoryTrackerImpl* impl_;
+		size_t callstackThreshold_;
+	};
+}
+
+#if YUME_MEMORY_TRACKING
+#	define YUME_TRACK_ALLOC(ptr, size, category) ::YumeEngine::YumeMemoryTracker::Get().RecordAlloc(ptr, size, category, __FILE__, __LINE__)
+#	define YUME_TRACK_DEALLOC(ptr) ::YumeEngine::YumeMemoryTracker::Get().RecordDealloc(ptr)
+#else
+#	define YUME_TRACK_ALLOC(ptr, size, category) ((void)0)
+#	define YUME_TRACK_DEALLOC(ptr) ((void)0)
+#endif
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,559 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeProfiler.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeProfiler.h"
+#include "YumeMutex.h"
+
+#include "Logging/logging.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace YumeEngine
+{
+	static const unsigned MAX_THREAD_NAME = 32;
+	static const double NS_TO_MS = 1.0 / 1000000.0;
+
+	struct ProfilerEvent
+	{
+		const char* Name;
+		long long Begin;
+		//Zero while the zone is open
+		long long End;
+		unsigned Depth;
+	};
+
+	struct CapturedEvent
+	{
+		const char* Name;
+		long long Begin;
+		long long End;
+		unsigned Thread;
+	};
+
+	//Written by its own thread only, EndFrame takes the lock to move the closed zones out
+	class ProfilerThreadBuffer
+	{
+	public:
+		ProfilerThreadBuffer(unsigned index,const char* track = 0):
+			Track(track),
+			Depth(0),
+			Index(index),
+			Root(-1)
+		{
+			if(track)
+			{
+				strncpy(Name,track,MAX_THREAD_NAME - 1);
+				Name[MAX_THREAD_NAME - 1] = 0;
+			}
+			else
+				sprintf(Name,"Thread %u",index);
+		}
+
+		Mutex Lock;
+		std::vector<ProfilerEvent> Events;
+		//Indices of the open zones in Events, innermost last
+		std::vector<unsigned> Open;
+		char Name[MAX_THREAD_NAME];
+		//Set for zones added with AddZone, not owned by a thread
+		const char* Track;
+		//Deepest a track zone can go, one below the last one added
+		unsigned Depth;
+		unsigned Index;
+		int Root;
+	};
+
+	struct ProfilerNode
+	{
+		ProfilerNode(const char* name,int parent,unsigned depth,unsigned thread):
+			Name(name),
+			Parent(parent),
+			Depth(depth),
+			Thread(thread),
+			FrameTime(0),
+			FrameCalls(0),
+			LastFrameTime(0),
+			IntervalTotal(0),
+			IntervalMin(0),
+			IntervalMax(0),
+			IntervalFrames(0),
+			IntervalCalls(0)
+		{
+		}
+
+		const char* Name;
+		int Parent;
+		unsigned Depth;
+		unsigned Thread;
+		std::vector<int> Children;
+
+		long long FrameTime;
+		unsigned FrameCalls;
+		long long LastFrameTime;
+
+		long long IntervalTotal;
+		long long IntervalMin;
+		long long IntervalMax;
+		unsigned IntervalFrames;
+		unsigned IntervalCalls;
+
+		ProfilerZoneStats Stats;
+	};
+
+	//Book keeping only, never profiled itself
+	class YumeProfilerImpl
+	{
+	public:
+		int FindOrAddNode(int parent,const char* name,unsigned depth,unsigned thread)
+		{
+			if(parent >= 0)
+			{
+				const std::vector<int>& children = Nodes[parent].Children;
+				for(unsigned i = 0; i < children.size(); ++i)
+				{
+					if(Nodes[children[i]].Name == name)
+						return children[i];
+				}
+			}
+
+			int index = (int)Nodes.size();
+			Nodes.push_back(ProfilerNode(name,parent,depth,thread));
+			if(parent >= 0)
+				Nodes[parent].Children.push_back(index);
+			return index;
+		}
+
+		void CollectNodes(int node,unsigned maxDepth,YumeVector<ProfilerZoneStats>::type& dest) const
+		{
+			if(Nodes[node].Depth > maxDepth)
+				return;
+
+			dest.push_back(Nodes[node].Stats);
+			for(unsigned i = 0; i < Nodes[node].Children.size(); ++i)
+				CollectNodes(Nodes[node].Children[i],maxDepth,dest);
+		}
+
+		Mutex BuffersLock;
+		std::vector<ProfilerThreadBuffer*> Buffers;
+
+		//Owned by EndFrame, the readers take the lock too
+		mutable Mutex NodesLock;
+		std::vector<ProfilerNode> Nodes;
+		std::vector<ProfilerEvent> Scratch;
+
+		std::vector<CapturedEvent> Capture;
+		YumeString CaptureFile;
+	};
+
+	static thread_local ProfilerThreadBuffer* threadBuffer = 0;
+
+	static long long ProfilerTicks()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	long long YumeProfiler::GetTicks()
+	{
+		return ProfilerTicks();
+	}
+
+	static void AppendEscaped(YumeString& dest,const char* text)
+	{
+		for(; *text; ++text)
+		{
+			if(*text == '"' || *text == '\\')
+				dest += '\\';
+			dest += *text;
+		}
+	}
+
+	ProfilerZoneStats::ProfilerZoneStats()
+		: Name(0),
+		Depth(0),
+		Thread(0),
+		FrameMs(0),
+		MinMs(0),
+		AvgMs(0),
+		MaxMs(0),
+		Calls(0)
+	{
+	}
+
+	YumeProfiler& YumeProfiler::Get()
+	{
+		//Never destroyed, worker threads may still close zones during static destruction
+		static YumeProfiler* profiler = new YumeProfiler;
+		return *profiler;
+	}
+
+	YumeProfiler::YumeProfiler()
+		: impl_(new YumeProfilerImpl),
+		statsInterval_(60),
+		numFrames_(0),
+		captureFrames_(0)
+	{
+	}
+
+	YumeProfiler::~YumeProfiler()
+	{
+		for(unsigned i = 0; i < impl_->Buffers.size(); ++i)
+			delete impl_->Buffers[i];
+		delete impl_;
+	}
+
+	ProfilerThreadBuffer* YumeProfiler::GetThreadBuffer()
+	{
+		if(!threadBuffer)
+		{
+			MutexLock lock(impl_->BuffersLock);
+			threadBuffer = new ProfilerThreadBuffer((unsigned)impl_->Buffers.size());
+			impl_->Buffers.push_back(threadBuffer);
+		}
+
+		return threadBuffer;
+	}
+
+	ProfilerThreadBuffer* YumeProfiler::GetTrackBuffer(const char* track)
+	{
+		MutexLock lock(impl_->BuffersLock);
+		for(unsigned i = 0; i < impl_->Buffers.size(); ++i)
+		{
+			if(impl_->Buffers[i]->Track && !strcmp(impl_->Buffers[i]->Track,track))
+				return impl_->Buffers[i];
+		}
+
+		ProfilerThreadBuffer* buffer = new ProfilerThreadBuffer((unsigned)impl_->Buffers.size(),track);
+		impl_->Buffers.push_back(buffer);
+		return buffer;
+	}
+
+	void YumeProfiler::BeginZone(const char* name)
+	{
+		ProfilerThreadBuffer* buffer = GetThreadBuffer();
+
+		ProfilerEvent event;
+		event.Name = name;
+		event.End = 0;
+
+		MutexLock lock(buffer->Lock);
+		event.Depth = (unsigned)buffer->Open.size();
+		buffer->Open.push_back((unsigned)buffer->Events.size());
+		//Read last so the bookkeeping above is not part of the zone
+		event.Begin = ProfilerTicks();
+		buffer->Events.push_back(event);
+	}
+
+	void YumeProfiler::EndZone()
+	{
+		long long end = ProfilerTicks();
+		ProfilerThreadBuffer* buffer = GetThreadBuffer();
+
+		MutexLock lock(buffer->Lock);
+		assert(!buffer->Open.empty());
+		if(buffer->Open.empty())
+			return;
+
+		buffer->Events[buffer->Open.back()].End = end;
+		buffer->Open.pop_back();
+	}
+
+	void YumeProfiler::SetThreadName(const char* name)
+	{
+		ProfilerThreadBuffer* buffer = GetThreadBuffer();
+
+		MutexLock lock(buffer->Lock);
+		strncpy(buffer->Name,name,MAX_THREAD_NAME - 1);
+		buffer->Name[MAX_THREAD_NAME - 1] = 0;
+	}
+
+	void YumeProfiler::AddZone(const char* track,const char* name,unsigned depth,long long begin,long long end)
+	{
+		ProfilerThreadBuffer* buffer = GetTrackBuffer(track);
+
+		ProfilerEvent event;
+		event.Name = name;
+		event.Begin = begin;
+		//Zero marks an open zone
+		event.End = end > begin ? end : begin + 1;
+
+		MutexLock lock(buffer->Lock);
+		//Without its parent the zone would have nowhere to go in the tree
+		event.Depth = depth <= buffer->Depth ? depth : buffer->Depth;
+		buffer->Depth = event.Depth + 1;
+		buffer->Events.push_back(event);
+	}
+
+	void YumeProfiler::EndFrame()
+	{
+		YumeString traceFile;
+		EndFrame(traceFile);
+
+		//Outside the lock, GetChromeTrace takes it again
+		if(!traceFile.empty())
+			WriteChromeTrace(traceFile);
+	}
+
+	void YumeProfiler::EndFrame(YumeString& traceFile)
+	{
+		std::vector<ProfilerThreadBuffer*> buffers;
+		{
+			MutexLock lock(impl_->BuffersLock);
+			buffers = impl_->Buffers;
+		}
+
+		MutexLock lock(impl_->NodesLock);
+		std::vector<ProfilerNode>& nodes = impl_->Nodes;
+		std::vector<ProfilerEvent>& events = impl_->Scratch;
+
+		for(unsigned i = 0; i < buffers.size(); ++i)
+		{
+			ProfilerThreadBuffer* buffer = buffers[i];
+
+			{
+				//Keep only the open zones, they are folded in again once they close
+				MutexLock bufferLock(buffer->Lock);
+				events.swap(buffer->Events);
+				buffer->Events.clear();
+				for(unsigned j = 0; j < buffer->Open.size(); ++j)
+				{
+					buffer->Events.push_back(events[buffer->Open[j]]);
+					buffer->Open[j] = j;
+				}
+				buffer->Depth = 0;
+
+				if(buffer->Root < 0)
+					buffer->Root = impl_->FindOrAddNode(-1,buffer->Name,0,buffer->Index);
+				//The name may have been set after the root was created
+				nodes[buffer->Root].Name = buffer->Name;
+			}
+
+			//Index of the node of the zone open at each depth
+			int stack[64];
+			for(unsigned j = 0; j < events.size(); ++j)
+			{
+				const ProfilerEvent& event = events[j];
+				if(event.Depth >= 64)
+					continue;
+
+				int parent = event.Depth ? stack[event.Depth - 1] : buffer->Root;
+				int node = impl_->FindOrAddNode(parent,event.Name,event.Depth + 1,buffer->Index);
+				stack[event.Depth] = node;
+
+				if(!event.End)
+					continue;
+
+				nodes[node].FrameTime += event.End - event.Begin;
+				++nodes[node].FrameCalls;
+
+				if(captureFrames_)
+				{
+					CapturedEvent captured;
+					captured.Name = event.Name;
+					captured.Begin = event.Begin;
+					captured.End = event.End;
+					captured.Thread = buffer->Index;
+					impl_->Capture.push_back(captured);
+				}
+			}
+			events.clear();
+		}
+
+		++numFrames_;
+		bool publish = !(numFrames_ % statsInterval_);
+
+		for(unsigned i = 0; i < nodes.size(); ++i)
+		{
+			ProfilerNode& node = nodes[i];
+
+			node.LastFrameTime = node.FrameTime;
+			if(node.FrameCalls)
+			{
+				if(!node.IntervalFrames || node.FrameTime < node.IntervalMin)
+					node.IntervalMin = node.FrameTime;
+				if(node.FrameTime > node.IntervalMax)
+					node.IntervalMax = node.FrameTime;
+				node.IntervalTotal += node.FrameTime;
+				node.IntervalCalls += node.FrameCalls;
+				++node.IntervalFrames;
+			}
+			node.FrameTime = 0;
+			node.FrameCalls = 0;
+
+			node.Stats.Name = node.Name;
+			node.Stats.Depth = node.Depth;
+			node.Stats.Thread = node.Thread;
+			node.Stats.FrameMs = node.LastFrameTime * NS_TO_MS;
+
+			if(publish)
+			{
+				//Averaged over the frames the zone ran in
+				unsigned frames = node.IntervalFrames ? node.IntervalFrames : 1;
+				node.Stats.MinMs = node.IntervalMin * NS_TO_MS;
+				node.Stats.AvgMs = node.IntervalTotal * NS_TO_MS / frames;
+				node.Stats.MaxMs = node.IntervalMax * NS_TO_MS;
+				node.Stats.Calls = (double)node.IntervalCalls / frames;
+
+				node.IntervalTotal = 0;
+				node.IntervalMin = 0;
+				node.IntervalMax = 0;
+				node.IntervalFrames = 0;
+				node.IntervalCalls = 0;
+			}
+		}
+
+		if(captureFrames_ && !--captureFrames_)
+		{
+			traceFile = impl_->CaptureFile;
+			impl_->CaptureFile.Clear();
+		}
+	}
+
+	void YumeProfiler::SetStatsInterval(unsigned frames)
+	{
+		MutexLock lock(impl_->NodesLock);
+		statsInterval_ = frames ? frames : 1;
+	}
+
+	void YumeProfiler::ResetStats()
+	{
+		MutexLock lock(impl_->NodesLock);
+		for(unsigned i = 0; i < impl_->Nodes.size(); ++i)
+		{
+			ProfilerNode& node = impl_->Nodes[i];
+			node.IntervalTotal = 0;
+			node.IntervalMin = 0;
+			node.IntervalMax = 0;
+			node.IntervalFrames = 0;
+			node.IntervalCalls = 0;
+			node.Stats = ProfilerZoneStats();
+		}
+		numFrames_ = 0;
+	}
+
+	void YumeProfiler::GetStats(YumeVector<ProfilerZoneStats>::type& dest,unsigned maxDepth) const
+	{
+		dest.clear();
+
+		MutexLock lock(impl_->NodesLock);
+		for(unsigned i = 0; i < impl_->Nodes.size(); ++i)
+		{
+			if(impl_->Nodes[i].Parent < 0)
+				impl_->CollectNodes(i,maxDepth,dest);
+		}
+	}
+
+	void YumeProfiler::BeginCapture(unsigned numFrames,const YumeString& fileName)
+	{
+		MutexLock lock(impl_->NodesLock);
+		impl_->Capture.clear();
+		impl_->CaptureFile = fileName;
+		captureFrames_ = numFrames;
+	}
+
+	void YumeProfiler::GetChromeTrace(YumeString& dest) const
+	{
+		MutexLock lock(impl_->NodesLock);
+		const std::vector<CapturedEvent>& capture = impl_->Capture;
+
+		long long start = 0;
+		for(unsigned i = 0; i < capture.size(); ++i)
+		{
+			if(!i || capture[i].Begin < start)
+				start = capture[i].Begin;
+		}
+
+		dest.Clear();
+		dest.append("{\"traceEvents\":[");
+
+		bool first = true;
+		for(unsigned i = 0; i < impl_->Nodes.size(); ++i)
+		{
+			const ProfilerNode& node = impl_->Nodes[i];
+			if(node.Parent >= 0)
+				continue;
+
+			dest.append(first ? "\n" : ",\n");
+			dest.AppendWithFormat("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"",node.Thread);
+			AppendEscaped(dest,node.Name);
+			dest.append("\"}}");
+			first = false;
+		}
+
+		//Complete events, timestamps in microseconds from the first captured zone
+		for(unsigned i = 0; i < capture.size(); ++i)
+		{
+			const CapturedEvent& event = capture[i];
+
+			dest.append(first ? "\n" : ",\n");
+			dest.append("{\"name\":\"");
+			AppendEscaped(dest,event.Name);
+			//AppendWithFormat has no precision, microseconds need three decimals
+			char timing[128];
+			sprintf(timing,"\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}",
+				(event.Begin - start) / 1000.0,(event.End - event.Begin) / 1000.0,event.Thread);
+			dest.append(timing);
+			first = false;
+		}
+
+		dest.append("\n]}\n");
+	}
+
+	bool YumeProfiler::WriteChromeTrace(const YumeString& fileName) const
+	{
+		YumeString trace;
+		GetChromeTrace(trace);
+
+		FILE* file = fopen(fileName.c_str(),"wb");
+		if(!file)
+		{
+			YUMELOG_ERROR("Could not open " << fileName.c_str() << " for the profiler trace");
+			return false;
+		}
+
+		bool written = fwrite(trace.c_str(),1,trace.length(),file) == trace.length();
+		fclose(file);
+
+		if(written)
+			YUMELOG_INFO("Profiler trace written to " << fileName.c_str());
+		return written;
+	}
+
+	void YumeProfiler::LogStats(unsigned maxDepth) const
+	{
+		YumeVector<ProfilerZoneStats>::type stats;
+		GetStats(stats,maxDepth);
+
+		for(unsigned i = 0; i < stats.size(); ++i)
+		{
+			const ProfilerZoneStats& zone = stats[i];
+			YumeString indent(' ',zone.Depth * 2);
+
+			if(!zone.Depth)
+				YUMELOG_INFO("Profiler " << zone.Name);
+			else
+				YUMELOG_INFO(indent.c_str() << zone.Name << ": avg " << zone.AvgMs << " ms, min " << zone.MinMs << " ms, max " <<
+					zone.MaxMs << " ms, " << zone.Calls << " calls");
+		}
+	}
+}
@@ -0,0 +1,136 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeProfiler.h
+// Date : <Date>
+// Comments : Scoped CPU zones, per frame statistics and Chrome trace capture
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeProfiler_h__
+#define __YumeProfiler_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeMath.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Statistics of one zone, times in milliseconds over the last completed interval
+	struct YumeAPIExport ProfilerZoneStats
+	{
+		ProfilerZoneStats();
+
+		const char* Name;
+		//Zero for a thread root
+		unsigned Depth;
+		//Index of the thread the zone ran on, in the order threads first recorded
+		unsigned Thread;
+		//Last frame
+		double FrameMs;
+		double MinMs;
+		double AvgMs;
+		double MaxMs;
+		//Calls per frame on average
+		double Calls;
+	};
+
+	class YumeProfilerImpl;
+	class ProfilerThreadBuffer;
+
+	//Zones are recorded into a buffer per thread and folded into a tree at EndFrame. A zone is identified by its name pointer
+	//and its parent, so names have to be string literals or otherwise outlive the profiler.
+	class YumeAPIExport YumeProfiler
+	{
+	public:
+		static YumeProfiler& Get();
+
+		void BeginZone(const char* name);
+		void EndZone();
+
+		//Names the calling thread in the summary and the trace
+		void SetThreadName(const char* name);
+
+		//Zone timed elsewhere, e.g. on the GPU, shown under a track of its own. Times are on the GetTicks clock and
+		//a zone has to come after its parent. Names follow the same rules as zone names, folded in at the next EndFrame.
+		void AddZone(const char* track,const char* name,unsigned depth,long long begin,long long end);
+		//Nanoseconds
+		static long long GetTicks();
+
+		//Call once per frame on the main thread. Zones still open carry over to the next frame.
+		void EndFrame();
+
+		//Frames the min/avg/max are taken over before they are published
+		void SetStatsInterval(unsigned frames);
+		unsigned GetStatsInterval() const { return statsInterval_; }
+		void ResetStats();
+
+		//Zones in depth first order, children after their parent. Only zones up to maxDepth below the thread roots.
+		void GetStats(YumeVector<ProfilerZoneStats>::type& dest,unsigned maxDepth = M_MAX_UNSIGNED) const;
+		unsigned GetNumFrames() const { return numFrames_; }
+
+		//Records every zone of the next numFrames frames. Written to fileName as Chrome trace JSON once done if a name is given.
+		void BeginCapture(unsigned numFrames,const YumeString& fileName = YumeString());
+		bool IsCapturing() const { return captureFrames_ > 0; }
+		//Trace event format, loads in chrome://tracing and Perfetto
+		void GetChromeTrace(YumeString& dest) const;
+		bool WriteChromeTrace(const YumeString& fileName) const;
+
+		void LogStats(unsigned maxDepth = M_MAX_UNSIGNED) const;
+
+	private:
+		YumeProfiler();
+		~YumeProfiler();
+
+		ProfilerThreadBuffer* GetThreadBuffer();
+		ProfilerThreadBuffer* GetTrackBuffer(const char* track);
+		//Folds the zones into the tree, returns the file to write once a capture completes
+		void EndFrame(YumeString& traceFile);
+
+		YumeProfilerImpl* impl_;
+		unsigned statsInterval_;
+		unsigned numFrames_;
+		unsigned captureFrames_;
+	};
+
+	//Opens a zone for the rest of the scope
+	class YumeAPIExport YumeProfileScope
+	{
+	public:
+		explicit YumeProfileScope(const char* name) { YumeProfiler::Get().BeginZone(name); }
+		~YumeProfileScope() { YumeProfiler::Get().EndZone(); }
+	};
+}
+
+#if YUME_PROFILING
+#	define YUME_PROFILE_JOIN_IMPL(a, b) a##b
+#	define YUME_PROFILE_JOIN(a, b) YUME_PROFILE_JOIN_IMPL(a, b)
+#	define YUME_PROFILE(name) ::YumeEngine::YumeProfileScope YUME_PROFILE_JOIN(profileScope_, __LINE__)(name)
+#	if defined(_MSC_VER)
+#		define YUME_PROFILE_FUNCTION() YUME_PROFILE(__FUNCTION__)
+#	else
+#		define YUME_PROFILE_FUNCTION() YUME_PROFILE(__func__)
+#	endif
+#	define YUME_PROFILE_THREAD(name) ::YumeEngine::YumeProfiler::Get().SetThreadName(name)
+#	define YUME_PROFILE_END_FRAME() ::YumeEngine::YumeProfiler::Get().EndFrame()
+#else
+#	define YUME_PROFILE(name) ((void)0)
+#	define YUME_PROFILE_FUNCTION() ((void)0)
+#	define YUME_PROFILE_THREAD(name) ((void)0)
+#	define YUME_PROFILE_END_FRAME() ((void)0)
+#endif
+
+
+//----------------------------------------------------------------------------
+#endif
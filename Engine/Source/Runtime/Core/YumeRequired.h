@@ -44,6 +44,8 @@ namespace YumeEngine
 namespace YumeEngine
 {
 	typedef String YumeString;
+	//Short lived names and tokens, no heap allocation up to 31 characters
+	typedef SmallString<32> YumeSmallString;
 
 	static YumeString EmptyString = "";
 
@@ -54,6 +56,7 @@ namespace YumeEngine
 	class YumeIO;
 	class YumeTime;
 	class YumeWorkQueue;
+	class YumeFrameArena;
 	class YumeEnvironment;
 	class YumeDebugRenderer;
 	class YumeInput;
@@ -100,6 +103,24 @@ namespace YumeEngine
 		typedef typename HashMap<K,V>::ConstIterator const_iterator;
 	};
 
+	//Open addressing, for hot lookups that do not depend on insertion order
+	template <typename K,typename V >
+	struct YumeOpenMap
+	{
+		typedef typename OpenHashMap<K,V> type;
+		typedef typename OpenHashMap<K,V>::Iterator iterator;
+		typedef typename OpenHashMap<K,V>::ConstIterator const_iterator;
+	};
+
+	//Inline storage for the first N elements
+	template <typename T,unsigned N>
+	struct YumeSmallVector
+	{
+		typedef typename SmallVector<T,N> type;
+		typedef typename SmallVector<T,N>::Iterator iterator;
+		typedef typename SmallVector<T,N>::ConstIterator const_iterator;
+	};
+
 	template <typename T>
 	struct YumeHashSet
 	{
@@ -109,14 +130,11 @@ namespace YumeEngine
 	};
 
 	typedef YumeVector<YumeString> StringVector;
+	typedef YumeSmallVector<YumeSmallString,16> SmallStringVector;
 
 #define YUME_SAFE_RELEASE(p) if(p) { p->Release(); p = 0; }
 }
 
-#if YUME_PLATFORM != YUME_PLATFORM_APPLE
-#define YUME_SSE
-#endif
-
 #include <boost/shared_array.hpp>
 
 #include "Core/YumeBase.h"
@@ -4,7 +4,9 @@
 
 
 #include "Container/HashMap.h"
+#include "Container/OpenHashMap.h"
 #include "Container/Vector.h"
+#include "Container/SmallVector.h"
 #include "Container/HashSet.h"
 
 #include <string>
@@ -25,6 +25,7 @@
 #include "Logging/logging.h"
 #include "Core/YumeTimer.h"
 #include "Math/YumeMath.h"
+#include "Core/YumeProfiler.h"
 
 namespace YumeEngine
 {
@@ -40,6 +41,11 @@ namespace YumeEngine
 		}
 		virtual void ThreadRunner()
 		{
+#if YUME_PROFILING
+			char name[32];
+			sprintf(name,"Worker %u",index_);
+			YUME_PROFILE_THREAD(name);
+#endif
 			owner_->ProcessItems(index_);
 		}
 		unsigned GetIndex() const { return index_; }
@@ -57,7 +63,9 @@ namespace YumeEngine
 		lastSize_(0),
 		maxNonThreadedWorkMs_(5)
 	{
-		gYume->pTimer->AddTimeEventListener(this);
+		//Standalone queues, like the ones of the tests, have no frames to finish work on
+		if(gYume && gYume->pTimer)
+			gYume->pTimer->AddTimeEventListener(this);
 	}
 
 	YumeWorkQueue::~YumeWorkQueue()
@@ -303,6 +311,7 @@ namespace YumeEngine
 					WorkItem* item = queue_.front();
 					queue_.erase(queue_.begin());
 					queueMutex_.Release();
+					YUME_PROFILE("WorkItem");
 					item->workFunction_(item,threadIndex);
 					item->completed_ = true;
 				}
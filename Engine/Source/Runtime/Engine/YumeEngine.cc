@@ -44,6 +44,8 @@
 #include "Core/YumeXmlFile.h"
 #include "Core/YumeJsFile.h"
 #include "Core/YumeWorkQueue.h"
+#include "Core/YumeFrameArena.h"
+#include "Core/YumeProfiler.h"
 
 
 #include "Renderer/YumeShader.h"
@@ -53,6 +55,7 @@
 #include "UI/YumeUI.h"
 
 #include <boost/filesystem.hpp>
+#include <thread>
 #include <log4cplus/initializer.h>
 
 
@@ -65,13 +68,15 @@ namespace YumeEngine
 	typedef void(*DLL_UNLOAD_MODULE)(YumeEngine3D*);
 
 	YumeEngine3D::YumeEngine3D()
-		: exiting_(false),
+		: log4cplusinitializer_(0),
+		exiting_(false),
 		initialized_(false),
 		inactiveFps_(60),
 		maxFps_(200),
 		minFps_(10),
 		timeStepSmoothing_(2),
-		timeStep_(0)
+		timeStep_(0),
+		frameWorkTime_(0)
 	{
 		YumeEngineGlobal = this;
 
@@ -81,7 +86,18 @@ namespace YumeEngine
 
 	YumeEngine3D::~YumeEngine3D()
 	{
+		//The application has released its scene and resources by now, whatever the tracker still holds leaked
+#if YUME_MEMORY_TRACKING
+		if(initialized_)
+			YumeMemoryTracker::Get().ReportLeaks();
+#endif
 
+		if(log4cplusinitializer_)
+		{
+			Log::StopLogging();
+			delete log4cplusinitializer_;
+			log4cplusinitializer_ = 0;
+		}
 	}
 
 	bool YumeEngine3D::Initialize(const VariantMap::type& variants)
@@ -92,6 +108,8 @@ namespace YumeEngine
 
 		initialized_ = true;
 
+		YUME_PROFILE_THREAD("Main");
+
 		RegisterFactories();
 
 		assert(gYume);
@@ -100,6 +118,7 @@ namespace YumeEngine
 		gYume->pTimer = (YumeAPINew YumeTime);
 		gYume->pEnv = (YumeAPINew YumeEnvironment);
 		gYume->pWorkSystem = (YumeAPINew YumeWorkQueue);
+		gYume->pFrameArena = (YumeAPINew YumeFrameArena);
 		gYume->pResourceManager = YumeAPINew YumeResourceManager;
 
 		VariantMap::const_iterator It = variants.begin();
@@ -121,11 +140,32 @@ namespace YumeEngine
 			YumeEngine::Log::ToggleLogging(false);
 		}
 
-		unsigned NumThreads = 0;
+		//Workers for everything on pWorkSystem (occlusion, software rasterizer, light propagation).
+		//One per hardware thread but the main one, which takes work items too when it waits on them.
+		//WorkerThreads overrides the count, 0 runs every work item on the main thread.
+		unsigned NumThreads = std::thread::hardware_concurrency();
+		NumThreads = NumThreads > 1 ? NumThreads - 1 : 0;
+
+		const Variant& workerThreads = gYume->pEnv->GetVariant("WorkerThreads");
+		if(workerThreads.GetType() == VAR_INT)
+			NumThreads = (unsigned)Max(workerThreads.GetInt(),0);
+		else if(workerThreads.GetType() == VAR_STRING)
+			NumThreads = (unsigned)Max(atoi(workerThreads.GetString().c_str()),0);
+
+		YUMELOG_INFO("Work queue threads: " << NumThreads);
 		gYume->pWorkSystem->CreateThreads(NumThreads);
 
 		YUMELOG_INFO("Initialized environment...Current system time " << gYume->pTimer->GetTimeStamp().c_str());
 
+#if YUME_PROFILING
+		int profilerCapture = gYume->pEnv->GetVariant("ProfilerCapture").Get<int>();
+		if(profilerCapture > 0)
+		{
+			FsPath traceFile = gYume->pEnv->GetLogFile().parent_path() / "YumeProfile.json";
+			YumeProfiler::Get().BeginCapture(profilerCapture,traceFile.generic_string().c_str());
+		}
+#endif
+
 		String currentOs;
 
 #if YUME_PLATFORM == YUME_PLATFORM_WIN32
@@ -141,9 +181,10 @@ namespace YumeEngine
 
 		YumeString renderer = gYume->pEnv->GetVariant("Renderer").GetString();
 
+		//Headless and drawn on the CPU, so tests can read the pixels back
 		if(gYume->pEnv->GetVariant("testing").Get<bool>())
 		{
-			renderer = "Null";
+			renderer = "Software";
 		}
 
 #if YUME_PLATFORM == YUME_PLATFORM_WIN32
@@ -242,21 +283,33 @@ namespace YumeEngine
 		switch(evt)
 		{
 		case E_UPDATE:
+		{
+			YUME_PROFILE("Update listeners");
 			for(EngineEventListeners::Iterator i = engineListeners_.begin(); i != engineListeners_.end(); ++i)
 				(*i)->HandleUpdate(gYume->pTimer->GetTimeStep());
-			break;
+		}
+		break;
 		case E_POSTUPDATE:
+		{
+			YUME_PROFILE("PostUpdate listeners");
 			for(EngineEventListeners::Iterator i = engineListeners_.begin(); i != engineListeners_.end(); ++i)
 				(*i)->HandlePostUpdate(gYume->pTimer->GetTimeStep());
-			break;
+		}
+		break;
 		case R_UPDATE:
+		{
+			YUME_PROFILE("RenderUpdate listeners");
 			for(EngineEventListeners::Iterator i = engineListeners_.begin(); i != engineListeners_.end(); ++i)
 				(*i)->HandleRenderUpdate(gYume->pTimer->GetTimeStep());
-			break;
+		}
+		break;
 		case R_POSTUPDATE:
+		{
+			YUME_PROFILE("PostRenderUpdate listeners");
 			for(EngineEventListeners::Iterator i = engineListeners_.begin(); i != engineListeners_.end(); ++i)
 				(*i)->HandlePostRenderUpdate(gYume->pTimer->GetTimeStep());
-			break;
+		}
+		break;
 		}
 	}
 
@@ -273,6 +326,8 @@ namespace YumeEngine
 	}
 	void YumeEngine3D::Render()
 	{
+		YUME_PROFILE("YumeEngine3D::Render");
+
 		if(exiting_ || !gYume->pRHI || !gYume->pRHI->BeginFrame())
 			return;
 
@@ -283,12 +338,17 @@ namespace YumeEngine
 			gYume->pUI->Render();
 #endif
 
+		//Before Present, which waits for vsync and would count as work otherwise
+		frameWorkTime_ = frameTimer_.GetUSec(false) / 1000.0f;
+
 		gYume->pRHI->EndFrame();
 	}
 
 
 	void YumeEngine3D::Update()
 	{
+		YUME_PROFILE("YumeEngine3D::Update");
+
 		if(exiting_)
 			return;
 		FireEvent(E_UPDATE);
@@ -305,6 +365,10 @@ namespace YumeEngine
 			return;
 
 		gYume->pTimer->BeginFrame(timeStep_);
+		gYume->pFrameArena->BeginFrame();
+#if YUME_MEMORY_TRACKING
+		YumeMemoryTracker::Get().BeginFrame();
+#endif
 
 
 
@@ -314,6 +378,8 @@ namespace YumeEngine
 		LimitFrames();
 
 		gYume->pTimer->EndFrame();
+
+		YUME_PROFILE_END_FRAME();
 	}
 
 	void YumeEngine3D::LimitFrames()
@@ -463,6 +529,10 @@ namespace YumeEngine
 		if(gYume->pEnv->GetVariant("NoUI").Get<YumeString>() != "1")
 			gYume->pUI->Shutdown();
 #endif
+		gYume->pUI.Reset();
+
+		//Resources outlive the device, Close already released their GPU side
+		gYume->pResourceManager.Reset();
 
 		//UnloadExternalLibraries();
 		//YumeAPIDelete resourceManager_;
@@ -473,14 +543,13 @@ namespace YumeEngine
 		YUMELOG_INFO("Engine stats: ");
 		YUMELOG_INFO("Total frames: " << gYume->pTimer->GetFrameNumber());
 		YUMELOG_INFO("Time elapsed since start: " << gYume->pTimer->GetElapsedTime());
+		gYume->pFrameArena->LogStats();
 
-		YUMELOG_INFO("Exited at time " << gYume->pTimer->GetTimeStamp().c_str());
+#if YUME_PROFILING
+		YumeProfiler::Get().LogStats(2);
+#endif
 
-		if(!gYume->pEnv->GetVariant("turnOffLogging").Get<bool>())
-		{
-			Log::ToggleLogging(false);
-			delete log4cplusinitializer_;
-		}
+		YUMELOG_INFO("Exited at time " << gYume->pTimer->GetTimeStamp().c_str());
 
 	}
 }
@@ -77,6 +77,9 @@ namespace YumeEngine
 		void FireEvent(YumeEngineEvents evt);
 		
 		float GetSmoothedTimestep() const {return timeStep_; }
+		//CPU time of the last frame up to Present, in milliseconds. Excludes the vsync wait and the frame limiter.
+		float GetFrameWorkTime() const { return frameWorkTime_; }
+		unsigned GetMaxFps() const { return maxFps_; }
 		void RegisterFactories();
 
 	public:
@@ -90,6 +93,7 @@ namespace YumeEngine
 		unsigned minFps_;
 		float timeStep_;
 		float timeStepSmoothing_;
+		float frameWorkTime_;
 		YumeVector<float>::type lastTimeSteps_;
 		YumeHiresTimer frameTimer_;
 
@@ -34,10 +34,141 @@
 
 #include "Engine/YumeEngine.h"
 #include "Core/YumeEnvironment.h"
+#include "Logging/logqueue.h"
+#include "Core/YumeTimer.h"
+
+#include <csignal>
+#include <exception>
+
+#if YUME_PLATFORM == YUME_PLATFORM_WIN32
+#include <Windows.h>
+#endif
 
 static log4cplus::LogLevel translate_logLevel(YumeEngine::Log::LogLevel ll);
 
 static bool loggingEnabled = false;
+static int minLogLevel = YumeEngine::Log::LogLevel_Trace;
+//Null until InitLogging, messages are written on the calling thread meanwhile
+static std::atomic<YumeEngine::Log::LogQueue*> logQueue(0);
+//Threads currently using logQueue, StopLogging waits for them before freeing it
+static std::atomic<int> logQueueUsers(0);
+
+//Holds off StopLogging while in scope. The count goes up before the pointer is read,
+//so once StopLogging has swapped in null and seen no users nobody can still reach the old queue.
+struct LogQueueUse
+{
+	LogQueueUse():
+		queue(0)
+	{
+		logQueueUsers.fetch_add(1);
+		queue = logQueue.load();
+	}
+
+	~LogQueueUse()
+	{
+		logQueueUsers.fetch_sub(1);
+	}
+
+	YumeEngine::Log::LogQueue* queue;
+};
+
+static const unsigned CRASH_FLUSH_TIMEOUT = 2000;
+
+//Runs on the drain thread, same layout the synchronous calls used
+static void WriteRecord(const YumeEngine::Log::LogRecord& record,const char* message)
+{
+	log4cplus::Logger root = log4cplus::Logger::getRoot();
+
+	switch(record.Level)
+	{
+	case YumeEngine::Log::LogLevel_Trace:
+		LOG4CPLUS_TRACE(root,record.File << ":" << record.Line << " - " << record.Function << " - " << message);
+		break;
+	case YumeEngine::Log::LogLevel_Debug:
+		LOG4CPLUS_DEBUG(root,record.Function << " - " << message);
+		break;
+	case YumeEngine::Log::LogLevel_Info:
+		LOG4CPLUS_INFO(root,record.Function << " - " << message);
+		break;
+	case YumeEngine::Log::LogLevel_Warn:
+		LOG4CPLUS_WARN(root,record.Function << " - " << message);
+		break;
+	default:
+		LOG4CPLUS_ERROR(root,record.File << ":" << record.Line << " - " << record.Function << " - " << message);
+		break;
+	}
+}
+
+static void Write(YumeEngine::Log::LogLevel level,const std::string& msg,const char* file,int line,const char* fn)
+{
+	{
+		LogQueueUse use;
+		if(use.queue)
+		{
+			use.queue->Push(level,msg.c_str(),(unsigned)msg.length(),file,line,fn);
+			return;
+		}
+	}
+
+	YumeEngine::Log::LogRecord record;
+	record.Size = 0;
+	record.Level = level;
+	record.Line = line;
+	record.Length = (unsigned)msg.length();
+	record.Sequence = 0;
+	record.File = file;
+	record.Function = fn;
+	WriteRecord(record,msg.c_str());
+}
+
+//Whatever is still queued is written out before the process goes down
+static void FlushOnCrash()
+{
+	LogQueueUse use;
+	if(use.queue)
+		use.queue->Flush(CRASH_FLUSH_TIMEOUT);
+}
+
+static void CrashSignalHandler(int sig)
+{
+	FlushOnCrash();
+
+	signal(sig,SIG_DFL);
+	raise(sig);
+}
+
+static std::terminate_handler previousTerminate = 0;
+
+static void CrashTerminateHandler()
+{
+	FlushOnCrash();
+
+	if(previousTerminate)
+		previousTerminate();
+	abort();
+}
+
+#if YUME_PLATFORM == YUME_PLATFORM_WIN32
+static LONG WINAPI CrashExceptionFilter(EXCEPTION_POINTERS*)
+{
+	FlushOnCrash();
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+#endif
+
+static void InstallCrashHandlers()
+{
+	previousTerminate = std::set_terminate(CrashTerminateHandler);
+
+	signal(SIGSEGV,CrashSignalHandler);
+	signal(SIGABRT,CrashSignalHandler);
+	signal(SIGFPE,CrashSignalHandler);
+	signal(SIGILL,CrashSignalHandler);
+
+#if YUME_PLATFORM == YUME_PLATFORM_WIN32
+	SetUnhandledExceptionFilter(CrashExceptionFilter);
+#endif
+}
 
 void YumeEngine::Log::InitLogging(const char* loc)
 {
@@ -72,57 +203,91 @@ void YumeEngine::Log::InitLogging(const char* loc)
 		new log4cplus::PatternLayout(LOG4CPLUS_TEXT("[%-5p][%D{%Y/%m/%d %H:%M:%S:%q}][%t] %m%n"))));
 	log4cplus::Logger::getRoot().addAppender(fileAppender);
 
+	LogQueue* queue = new LogQueue(WriteRecord);
+	queue->Run();
+	logQueue.store(queue);
+
+	InstallCrashHandlers();
 }
 
 void YumeEngine::Log::StopLogging()
 {
-	log4cplus::Logger::shutdown();
-	
 	ToggleLogging(false);
-	
 
-	
+	//Appenders are shut down by the log4cplus initializer
+	LogQueue* queue = logQueue.exchange(0);
+	if(queue)
+	{
+		//Producers that picked up the queue before the swap may still be inside Push
+		while(logQueueUsers.load())
+			YumeTime::Sleep(0);
+
+		queue->Flush();
+		delete queue;
+	}
 }
+
 void YumeEngine::Log::ToggleLogging(bool b)
 {
 	loggingEnabled = b;
 }
 
+void YumeEngine::Log::FlushLogging()
+{
+	LogQueueUse use;
+	if(use.queue)
+		use.queue->Flush();
+}
+
+bool YumeEngine::Log::IsEnabled(LogLevel level)
+{
+	return loggingEnabled && level >= minLogLevel;
+}
+
+void YumeEngine::Log::SetLogLevel(LogLevel level)
+{
+	minLogLevel = level;
+}
+
+void YumeEngine::Log::SetDropPolicy(DropPolicy policy)
+{
+	LogQueueUse use;
+	if(use.queue)
+		use.queue->SetDropPolicy(policy);
+}
+
 void YumeEngine::Log::trace(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
 	if(loggingEnabled)
-		LOG4CPLUS_TRACE(log4cplus::Logger::getRoot(),
-			file << ":" << line << " - " << fn << " - " << msg.c_str());
+		Write(LogLevel_Trace,msg,file,line,fn);
 }
 void YumeEngine::Log::debug(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
 	if(loggingEnabled)
-		LOG4CPLUS_DEBUG(log4cplus::Logger::getRoot(),
-			fn << " - " << msg.c_str());
+		Write(LogLevel_Debug,msg,file,line,fn);
 }
 void YumeEngine::Log::info(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
 	if(loggingEnabled)
-		LOG4CPLUS_INFO(log4cplus::Logger::getRoot(),
-			fn << " - " << msg.c_str());
+		Write(LogLevel_Info,msg,file,line,fn);
 }
 void YumeEngine::Log::warn(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
 	if(loggingEnabled)
-		LOG4CPLUS_WARN(log4cplus::Logger::getRoot(),
-			fn << " - " << msg.c_str());
+		Write(LogLevel_Warn,msg,file,line,fn);
 }
 void YumeEngine::Log::error(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
 	if(loggingEnabled)
-		LOG4CPLUS_ERROR(log4cplus::Logger::getRoot(),
-			file << ":" << line << " - " << fn << " - " << msg.c_str());
+		Write(LogLevel_Error,msg,file,line,fn);
 }
 void YumeEngine::Log::fatal(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
 	if(loggingEnabled)
-		LOG4CPLUS_ERROR(log4cplus::Logger::getRoot(),
-			file << ":" << line << " - " << fn << " - " << msg.c_str());
+	{
+		Write(LogLevel_Fatal,msg,file,line,fn);
+		FlushLogging();
+	}
 }
 
 static log4cplus::LogLevel translate_logLevel(YumeEngine::Log::LogLevel ll){
@@ -138,6 +303,8 @@ static log4cplus::LogLevel translate_logLevel(YumeEngine::Log::LogLevel ll){
 		return log4cplus::WARN_LOG_LEVEL;
 	case(YumeEngine::Log::LogLevel_Error) :
 		return log4cplus::ERROR_LOG_LEVEL;
+	case(YumeEngine::Log::LogLevel_Fatal) :
+		return log4cplus::FATAL_LOG_LEVEL;
 	default:
 		return log4cplus::WARN_LOG_LEVEL;
 	}
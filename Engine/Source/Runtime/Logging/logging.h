@@ -31,21 +31,24 @@
 #  else
 #    define YUMELOG_FUNCTION() __func__
 #  endif
-#  define YUMELOG_LOG_BODY(type, src, msg) \
+//Level is checked first so disabled messages are never formatted
+#  define YUMELOG_LOG_BODY(type, level, src, msg) \
     do { \
-        std::ostringstream os; \
-        os << msg; \
-        YumeEngine::Log:: type (src, os.str(), __FILE__, __LINE__, YUMELOG_FUNCTION()); \
+        if(YumeEngine::Log::IsEnabled(YumeEngine::Log:: level)) { \
+            std::ostringstream os; \
+            os << msg; \
+            YumeEngine::Log:: type (src, os.str(), __FILE__, __LINE__, YUMELOG_FUNCTION()); \
+        } \
 		    } while(0)
 #endif
 
 #if !CHIIKA_NO_LOGGING_MACROS
-#  define YUMELOG_TRACE(msg) YUMELOG_LOG_BODY(trace, "Src", msg)
-#  define YUMELOG_DEBUG(msg) YUMELOG_LOG_BODY(debug, "Src", msg)
-#  define YUMELOG_INFO(msg) YUMELOG_LOG_BODY(info, "Src", msg)
-#  define YUMELOG_WARN(msg) YUMELOG_LOG_BODY(warn, "Src", msg)
-#  define YUMELOG_ERROR(msg) YUMELOG_LOG_BODY(error, "Src", msg)
-#  define YUMELOG_FATAL(msg) YUMELOG_LOG_BODY(fatal, "Src", msg)
+#  define YUMELOG_TRACE(msg) YUMELOG_LOG_BODY(trace, LogLevel_Trace, "Src", msg)
+#  define YUMELOG_DEBUG(msg) YUMELOG_LOG_BODY(debug, LogLevel_Debug, "Src", msg)
+#  define YUMELOG_INFO(msg) YUMELOG_LOG_BODY(info, LogLevel_Info, "Src", msg)
+#  define YUMELOG_WARN(msg) YUMELOG_LOG_BODY(warn, LogLevel_Warn, "Src", msg)
+#  define YUMELOG_ERROR(msg) YUMELOG_LOG_BODY(error, LogLevel_Error, "Src", msg)
+#  define YUMELOG_FATAL(msg) YUMELOG_LOG_BODY(fatal, LogLevel_Fatal, "Src", msg)
 #else 
 #  define YUMELOG_TRACE(src, msg) 
 #  define YUMELOG_DEBUG(src, msg)
@@ -59,17 +62,6 @@ namespace YumeEngine
 {
 	namespace Log
 	{
-		void YumeAPIExport InitLogging(const char* loc);
-		void StopLogging();
-		void ToggleLogging(bool b);
-
-		void YumeAPIExport trace(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
-		void YumeAPIExport debug(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
-		void YumeAPIExport info(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
-		void YumeAPIExport warn(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
-		void YumeAPIExport error(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
-		void YumeAPIExport fatal(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
-
 		enum LogLevel {
 			// All log messages, no matter how small
 			LogLevel_Trace = 0x01,
@@ -80,8 +72,38 @@ namespace YumeEngine
 			// Only log warning and worse messages
 			LogLevel_Warn = 0x08,
 			// Only log messages that are actual errors
-			LogLevel_Error = 0x10
+			LogLevel_Error = 0x10,
+			// Unrecoverable errors
+			LogLevel_Fatal = 0x20
+		};
+
+		// What a thread does when its log ring is full. Errors and fatals always wait.
+		enum DropPolicy {
+			// Discard the message and report the count later
+			LogDrop_Newest = 0,
+			// Wait for the drain thread to make room
+			LogDrop_Block
 		};
+
+		// Starts the drain thread, messages are written out asynchronously until StopLogging
+		void YumeAPIExport InitLogging(const char* loc);
+		// Writes out everything queued and stops the drain thread
+		void YumeAPIExport StopLogging();
+		void YumeAPIExport ToggleLogging(bool b);
+		// Blocks until every message logged so far is written out
+		void YumeAPIExport FlushLogging();
+
+		bool YumeAPIExport IsEnabled(LogLevel level);
+		// Messages below this level are skipped before formatting
+		void YumeAPIExport SetLogLevel(LogLevel level);
+		void YumeAPIExport SetDropPolicy(DropPolicy policy);
+
+		void YumeAPIExport trace(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
+		void YumeAPIExport debug(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
+		void YumeAPIExport info(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
+		void YumeAPIExport warn(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
+		void YumeAPIExport error(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
+		void YumeAPIExport fatal(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
 	}
 }
 //----------------------------------------------------------------------------
@@ -0,0 +1,318 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : logqueue.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "Logging/logqueue.h"
+
+#include "Core/YumeTimer.h"
+
+#include <cstring>
+#include <cstdio>
+
+namespace YumeEngine
+{
+	namespace Log
+	{
+		static const unsigned LOG_RECORD_ALIGNMENT = 8;
+
+		static std::atomic<unsigned> nextQueueId(1);
+
+		//Ring of the calling thread, retired when the thread exits
+		struct ThreadLogRing
+		{
+			ThreadLogRing():
+				ring(0),
+				queueId(0)
+			{
+			}
+
+			~ThreadLogRing()
+			{
+				if(ring)
+					ring->Retire();
+			}
+
+			LogRing* ring;
+			unsigned queueId;
+		};
+
+		static thread_local ThreadLogRing threadRing;
+
+		static unsigned AlignRecord(unsigned size)
+		{
+			return (size + LOG_RECORD_ALIGNMENT - 1) & ~(LOG_RECORD_ALIGNMENT - 1);
+		}
+
+		LogRing::LogRing(unsigned size):
+			buffer_(new unsigned char[size]),
+			size_(size),
+			head_(0),
+			tail_(0),
+			retired_(false),
+			refs_(2)
+		{
+			assert(IsPowerOfTwo(size));
+		}
+
+		LogRing::~LogRing()
+		{
+			delete[] buffer_;
+		}
+
+		void LogRing::Retire()
+		{
+			retired_.store(true,std::memory_order_release);
+			Release();
+		}
+
+		void LogRing::Release()
+		{
+			if(refs_.fetch_sub(1,std::memory_order_acq_rel) == 1)
+				delete this;
+		}
+
+		bool LogRing::Push(LogLevel level,unsigned sequence,const char* message,unsigned length,const char* file,int line,const char* function)
+		{
+			unsigned recordSize = AlignRecord(sizeof(LogRecord) + length + 1);
+
+			unsigned head = head_.load(std::memory_order_relaxed);
+			unsigned tail = tail_.load(std::memory_order_acquire);
+
+			//Records never wrap, the space left at the end is skipped with a padding record
+			unsigned offset = head & (size_ - 1);
+			unsigned contiguous = size_ - offset;
+			unsigned padding = contiguous < recordSize ? contiguous : 0;
+
+			if(head - tail + padding + recordSize > size_)
+				return false;
+
+			if(padding)
+			{
+				LogRecord* pad = reinterpret_cast<LogRecord*>(buffer_ + offset);
+				pad->Size = padding;
+				pad->Level = 0;
+				head += padding;
+				offset = 0;
+			}
+
+			LogRecord* record = reinterpret_cast<LogRecord*>(buffer_ + offset);
+			record->Size = recordSize;
+			record->Level = level;
+			record->Line = line;
+			record->Length = length;
+			record->Sequence = sequence;
+			record->File = file;
+			record->Function = function;
+
+			char* text = reinterpret_cast<char*>(record + 1);
+			memcpy(text,message,length);
+			text[length] = 0;
+
+			head_.store(head + recordSize,std::memory_order_release);
+			return true;
+		}
+
+		const LogRecord* LogRing::Peek()
+		{
+			unsigned tail = tail_.load(std::memory_order_relaxed);
+			unsigned head = head_.load(std::memory_order_acquire);
+
+			while(tail != head)
+			{
+				const LogRecord* record = reinterpret_cast<const LogRecord*>(buffer_ + (tail & (size_ - 1)));
+				if(record->Level)
+					return record;
+
+				tail += record->Size;
+				tail_.store(tail,std::memory_order_release);
+			}
+
+			return 0;
+		}
+
+		void LogRing::Advance()
+		{
+			unsigned tail = tail_.load(std::memory_order_relaxed);
+			const LogRecord* record = reinterpret_cast<const LogRecord*>(buffer_ + (tail & (size_ - 1)));
+			tail_.store(tail + record->Size,std::memory_order_release);
+		}
+
+		LogQueue::LogQueue(LogSink sink):
+			sink_(sink),
+			id_(nextQueueId.fetch_add(1,std::memory_order_relaxed)),
+			sequence_(0),
+			dropPolicy_(LogDrop_Newest),
+			dropped_(0),
+			totalDropped_(0)
+		{
+		}
+
+		LogQueue::~LogQueue()
+		{
+			Stop();
+			Drain();
+
+			//Rings of threads that are still running are freed by their owner when it exits
+			MutexLock lock(ringsLock_);
+			for(unsigned i = 0; i < rings_.size(); ++i)
+				rings_[i]->Release();
+			rings_.clear();
+		}
+
+		LogRing* LogQueue::GetThreadRing()
+		{
+			if(threadRing.queueId != id_)
+			{
+				//The previous queue keeps the old ring until it has written it out
+				if(threadRing.ring)
+					threadRing.ring->Retire();
+
+				LogRing* ring = new LogRing;
+
+				MutexLock lock(ringsLock_);
+				rings_.push_back(ring);
+
+				threadRing.ring = ring;
+				threadRing.queueId = id_;
+			}
+
+			return threadRing.ring;
+		}
+
+		void LogQueue::Push(LogLevel level,const char* message,unsigned length,const char* file,int line,const char* function)
+		{
+			if(length > MAX_LOG_MESSAGE)
+				length = MAX_LOG_MESSAGE;
+
+			LogRing* ring = GetThreadRing();
+			unsigned sequence = sequence_.fetch_add(1,std::memory_order_relaxed);
+
+			while(!ring->Push(level,sequence,message,length,file,line,function))
+			{
+				if(level < LogLevel_Error && GetDropPolicy() == LogDrop_Newest)
+				{
+					dropped_.fetch_add(1,std::memory_order_relaxed);
+					totalDropped_.fetch_add(1,std::memory_order_relaxed);
+					return;
+				}
+
+				//Back pressure, write out ourselves if there is no drain thread
+				if(IsStarted())
+					YumeTime::Sleep(0);
+				else
+					Drain();
+			}
+		}
+
+		bool LogQueue::Flush(unsigned timeoutMs)
+		{
+			//Waits in steps so a crash handler can give up on a drain thread that died holding the lock
+			for(unsigned waited = 0; !drainLock_.TryAcquire(); ++waited)
+			{
+				if(waited >= timeoutMs)
+					return false;
+				YumeTime::Sleep(1);
+			}
+			drainLock_.Release();
+
+			while(Drain())
+				;
+
+			return true;
+		}
+
+		unsigned LogQueue::Drain()
+		{
+			MutexLock drainLock(drainLock_);
+
+			std::vector<LogRing*> rings;
+			{
+				MutexLock lock(ringsLock_);
+				rings = rings_;
+			}
+
+			unsigned count = 0;
+			for(;;)
+			{
+				//Oldest head record across the rings
+				LogRing* oldest = 0;
+				const LogRecord* oldestRecord = 0;
+				for(unsigned i = 0; i < rings.size(); ++i)
+				{
+					const LogRecord* record = rings[i]->Peek();
+					if(record && (!oldestRecord || (int)(record->Sequence - oldestRecord->Sequence) < 0))
+					{
+						oldest = rings[i];
+						oldestRecord = record;
+					}
+				}
+
+				if(!oldest)
+					break;
+
+				sink_(*oldestRecord,reinterpret_cast<const char*>(oldestRecord + 1));
+				oldest->Advance();
+				++count;
+			}
+
+			unsigned dropped = dropped_.exchange(0,std::memory_order_relaxed);
+			if(dropped)
+			{
+				char message[64];
+				int length = sprintf(message,"%u log messages dropped, ring full",dropped);
+
+				LogRecord record;
+				record.Size = 0;
+				record.Level = LogLevel_Warn;
+				record.Line = __LINE__;
+				record.Length = (unsigned)length;
+				record.Sequence = 0;
+				record.File = __FILE__;
+				record.Function = "LogQueue::Drain";
+				sink_(record,message);
+			}
+
+			//Free the rings of threads that have exited
+			MutexLock lock(ringsLock_);
+			for(unsigned i = 0; i < rings_.size();)
+			{
+				if(rings_[i]->IsRetired() && rings_[i]->Empty())
+				{
+					rings_[i]->Release();
+					rings_.erase(rings_.begin() + i);
+				}
+				else
+					++i;
+			}
+
+			return count;
+		}
+
+		void LogQueue::ThreadRunner()
+		{
+			while(shouldRun_)
+			{
+				if(!Drain())
+					YumeTime::Sleep(1);
+			}
+		}
+	}
+}
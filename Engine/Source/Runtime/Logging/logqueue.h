@@ -0,0 +1,139 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : logqueue.h
+// Date : <Date>
+// Comments : Per thread log rings drained to the sinks by a background thread
+//
+//----------------------------------------------------------------------------
+#ifndef __logqueue_h__
+#define __logqueue_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Core/YumeThread.h"
+#include "Core/YumeMutex.h"
+#include "Math/YumeMath.h"
+#include "Logging/logging.h"
+
+#include <atomic>
+#include <vector>
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	namespace Log
+	{
+		static const unsigned LOG_RING_SIZE = 64 * 1024;
+		//Longer messages are truncated
+		static const unsigned MAX_LOG_MESSAGE = 4096;
+
+		//Header of a message in a ring, the null terminated text follows it.
+		//File and Function point at string literals so they are only read when the record is written out.
+		struct LogRecord
+		{
+			//Bytes taken in the ring including this header and padding
+			unsigned Size;
+			//Zero marks the unused tail of the ring before a wrap
+			unsigned Level;
+			int Line;
+			unsigned Length;
+			//Global order of the messages across threads
+			unsigned Sequence;
+			const char* File;
+			const char* Function;
+		};
+
+		//Single producer single consumer byte ring. The owning thread pushes, the drain thread peeks and advances.
+		class YumeAPIExport LogRing
+		{
+		public:
+			LogRing(unsigned size = LOG_RING_SIZE);
+			~LogRing();
+
+			//Returns false without writing anything if the record does not fit
+			bool Push(LogLevel level,unsigned sequence,const char* message,unsigned length,const char* file,int line,const char* function);
+
+			//Oldest record, null if empty. Stays valid until Advance.
+			const LogRecord* Peek();
+			void Advance();
+
+			bool Empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed); }
+
+			//Called when the owning thread exits or moves to another queue, drops the thread's reference
+			void Retire();
+			bool IsRetired() const { return retired_.load(std::memory_order_acquire); }
+
+			//The owning thread and the queue each hold a reference, whichever lets go last deletes the ring
+			void Release();
+
+		private:
+			unsigned char* buffer_;
+			unsigned size_;
+			//Free running byte counters, wrapped with size_ - 1
+			std::atomic<unsigned> head_;
+			std::atomic<unsigned> tail_;
+			std::atomic<bool> retired_;
+			std::atomic<int> refs_;
+		};
+
+		typedef void (*LogSink)(const LogRecord& record,const char* message);
+
+		//Formats nothing itself, the sink is called on the drain thread in sequence order.
+		class YumeAPIExport LogQueue : public YumeThreadWrapper
+		{
+		public:
+			LogQueue(LogSink sink);
+			virtual ~LogQueue();
+
+			//Copies the message into the calling thread's ring. Applies the drop policy when the ring is full,
+			//errors and fatals always wait for room.
+			void Push(LogLevel level,const char* message,unsigned length,const char* file,int line,const char* function);
+
+			//Writes out everything queued so far on the calling thread. Gives up after timeoutMs if the
+			//drain thread is stuck in a sink, which can happen when flushing from a crash handler.
+			bool Flush(unsigned timeoutMs = M_MAX_UNSIGNED);
+
+			void SetDropPolicy(DropPolicy policy) { dropPolicy_.store(policy,std::memory_order_relaxed); }
+			DropPolicy GetDropPolicy() const { return (DropPolicy)dropPolicy_.load(std::memory_order_relaxed); }
+
+			//Messages dropped since the queue was created
+			unsigned GetNumDropped() const { return totalDropped_.load(std::memory_order_relaxed); }
+
+			virtual void ThreadRunner();
+
+		private:
+			LogRing* GetThreadRing();
+			//Returns the number of records written
+			unsigned Drain();
+
+			LogSink sink_;
+			unsigned id_;
+
+			Mutex ringsLock_;
+			std::vector<LogRing*> rings_;
+			//Held while writing out, Flush and the drain thread take turns
+			Mutex drainLock_;
+
+			std::atomic<unsigned> sequence_;
+			std::atomic<int> dropPolicy_;
+			std::atomic<unsigned> dropped_;
+			std::atomic<unsigned> totalDropped_;
+		};
+	}
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : GIVolumeUpdate.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "GIVolumeUpdate.h"
+
+#include "Math/YumeMath.h"
+
+namespace YumeEngine
+{
+	GIVolumeUpdate::GIVolumeUpdate()
+		: valid_(false),
+		lightPos_(Vector3::ZERO),
+		lightDir_(Vector3::ZERO),
+		lightColor_(YumeColor::BLACK),
+		sceneChanges_(0),
+		iteration_(0),
+		numIterations_(0),
+		budget_(0),
+		threshold_(0),
+		firstEnergy_(0),
+		converged_(true)
+	{
+	}
+
+	bool GIVolumeUpdate::CheckInject(const Vector3& lightPos,const Vector3& lightDir,const YumeColor& lightColor,unsigned sceneChanges)
+	{
+		bool changed = !valid_ || sceneChanges != sceneChanges_ ||
+			lightPos != lightPos_ || lightDir != lightDir_ || lightColor != lightColor_;
+
+		valid_ = true;
+		lightPos_ = lightPos;
+		lightDir_ = lightDir;
+		lightColor_ = lightColor;
+		sceneChanges_ = sceneChanges;
+
+		return changed;
+	}
+
+	void GIVolumeUpdate::BeginPropagation(unsigned iterations)
+	{
+		iteration_ = 0;
+		numIterations_ = iterations;
+		firstEnergy_ = 0;
+		converged_ = !iterations;
+	}
+
+	unsigned GIVolumeUpdate::GetFrameIterations() const
+	{
+		if(converged_)
+			return 0;
+
+		unsigned remaining = numIterations_ - iteration_;
+		return budget_ ? (unsigned)Min((int)budget_,(int)remaining) : remaining;
+	}
+
+	void GIVolumeUpdate::Advance(unsigned iterations,float energy)
+	{
+		if(converged_)
+			return;
+
+		iteration_ = (unsigned)Min((int)(iteration_ + iterations),(int)numIterations_);
+
+		if(energy >= 0)
+		{
+			if(firstEnergy_ <= 0)
+				firstEnergy_ = energy;
+			else if(energy <= firstEnergy_ * threshold_)
+				converged_ = true;
+		}
+
+		if(iteration_ == numIterations_)
+			converged_ = true;
+	}
+}
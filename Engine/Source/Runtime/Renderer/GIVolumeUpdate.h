@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : GIVolumeUpdate.h
+// Date : <Date>
+// Comments : Decides when a GI volume is reinjected and how much of its propagation runs per frame
+//
+//----------------------------------------------------------------------------
+#ifndef __GIVolumeUpdate_h__
+#define __GIVolumeUpdate_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeColor.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Injection only has to be redone when the directional light or the geometry it lights changed.
+	//Propagation after an injection can be spread over frames, the accumulation is valid after every
+	//iteration so the bounce light fades in instead of stalling the frame. It stops when all iterations
+	//ran or, when the caller can tell how much energy an iteration moved, once that is negligible.
+	class YumeAPIExport GIVolumeUpdate
+	{
+	public:
+		GIVolumeUpdate();
+
+		//The next CheckInject reports a change whatever it is given
+		void Invalidate() { valid_ = false; }
+		//True when the light or the scene change count differs from the last call
+		bool CheckInject(const Vector3& lightPos,const Vector3& lightDir,const YumeColor& lightColor,unsigned sceneChanges);
+
+		//Called after injecting, propagation starts over from the first iteration
+		void BeginPropagation(unsigned iterations);
+		//0 runs every remaining iteration in one frame
+		void SetIterationBudget(unsigned perFrame) { budget_ = perFrame; }
+		//Fraction of the first iteration's energy below which the rest is skipped, 0 never stops early
+		void SetConvergenceThreshold(float threshold) { threshold_ = threshold; }
+
+		//Iterations to run this frame, the first one is GetIteration()
+		unsigned GetFrameIterations() const;
+		//Energy is what the last of them moved, negative when it is not known
+		void Advance(unsigned iterations,float energy = -1.0f);
+
+		bool IsConverged() const { return converged_; }
+		unsigned GetIteration() const { return iteration_; }
+		unsigned GetNumIterations() const { return numIterations_; }
+		unsigned GetIterationBudget() const { return budget_; }
+		float GetConvergenceThreshold() const { return threshold_; }
+
+	private:
+		bool valid_;
+		Vector3 lightPos_;
+		Vector3 lightDir_;
+		YumeColor lightColor_;
+		unsigned sceneChanges_;
+
+		unsigned iteration_;
+		unsigned numIterations_;
+		unsigned budget_;
+		float threshold_;
+		float firstEnergy_;
+		bool converged_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -23,6 +23,7 @@
 #define __GlobalIlluminationVolume_h__
 //----------------------------------------------------------------------------
 #include "YumeRequired.h"
+#include "GIVolumeUpdate.h"
 #include <DirectXMath.h>
 //----------------------------------------------------------------------------
 namespace YumeEngine
@@ -44,6 +45,12 @@ namespace YumeEngine
 		virtual YumeGeometry* GetVolumeGeometry() = 0;
 
 		virtual void SetModelMatrix(const DirectX::XMFLOAT4X4& model,const DirectX::XMFLOAT3& lpvMin,const DirectX::XMFLOAT3& lpvMax) = 0;
+
+		//When to reinject and how far propagation got, kept across frames
+		GIVolumeUpdate& GetUpdate() { return update_; }
+
+	protected:
+		GIVolumeUpdate update_;
 	};
 }
 
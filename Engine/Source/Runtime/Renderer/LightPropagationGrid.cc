@@ -0,0 +1,462 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : LightPropagationGrid.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "LightPropagationGrid.h"
+
+#include "Math/YumeMath.h"
+#include "Core/YumeStreamReader.h"
+#include "Core/YumeStreamWriter.h"
+#include "Core/YumeWorkQueue.h"
+#include "Logging/logging.h"
+
+#include <thread>
+
+#ifdef YUME_SSE
+#include <emmintrin.h>
+#endif
+
+namespace YumeEngine
+{
+	static const unsigned LPV_BAKE_VERSION = 2;
+
+	//Neighbour and face order of LPVPropagate.hlsl
+	static const int neighbourOffsets[6][3] =
+	{
+		{0,0,1},
+		{1,0,0},
+		{0,0,-1},
+		{-1,0,0},
+		{0,1,0},
+		{0,-1,0}
+	};
+
+	//What one neighbour sends to the faces of the cell. A neighbour reaches 5 faces, the one facing
+	//it has no solid angle. Padded to two groups of 4 with zero weights so SSE does 4 faces at once.
+	struct GatherTable
+	{
+		//[neighbour][group][coefficient][face]
+		float Weights[6][2][4][4];
+		//Clamped cosine lobe of each face the flux is reprojected onto
+		Vector4 Faces[6][8];
+	};
+
+	static void BuildGatherTable(float amplifier,GatherTable& table)
+	{
+		memset(&table,0,sizeof table);
+
+		for(unsigned n = 0; n < 6; ++n)
+		{
+			Vector3 neighbour((float)neighbourOffsets[n][0],(float)neighbourOffsets[n][1],(float)neighbourOffsets[n][2]);
+
+			unsigned lane = 0;
+			for(unsigned f = 0; f < 6; ++f)
+			{
+				Vector3 face((float)neighbourOffsets[f][0],(float)neighbourOffsets[f][1],(float)neighbourOffsets[f][2]);
+
+				Vector3 dir = face * 0.5f - neighbour;
+				float len = dir.Length();
+				if(len <= 0.5f)
+					continue;
+
+				float solidAngle = len >= 1.5f ? 22.95668f / (4 * 180.0f) : 24.26083f / (4 * 180.0f);
+				Vector4 weight = LpvShBasis(dir / len) * (amplifier * solidAngle);
+
+				float* w = &table.Weights[n][lane / 4][0][lane % 4];
+				w[0] = weight.x_;
+				w[4] = weight.y_;
+				w[8] = weight.z_;
+				w[12] = weight.w_;
+
+				table.Faces[n][lane] = LpvShClampedCosine(face);
+				++lane;
+			}
+		}
+	}
+
+#ifdef YUME_SSE
+	static inline __m128 Gather(const Vector4& sh,const GatherTable& table,unsigned n)
+	{
+		__m128 coeffs = _mm_loadu_ps(&sh.x_);
+		__m128 c0 = _mm_shuffle_ps(coeffs,coeffs,_MM_SHUFFLE(0,0,0,0));
+		__m128 c1 = _mm_shuffle_ps(coeffs,coeffs,_MM_SHUFFLE(1,1,1,1));
+		__m128 c2 = _mm_shuffle_ps(coeffs,coeffs,_MM_SHUFFLE(2,2,2,2));
+		__m128 c3 = _mm_shuffle_ps(coeffs,coeffs,_MM_SHUFFLE(3,3,3,3));
+
+		__m128 zero = _mm_setzero_ps();
+		__m128 sum = zero;
+		for(unsigned g = 0; g < 2; ++g)
+		{
+			//Intensity towards 4 faces, one per lane
+			const float* w = &table.Weights[n][g][0][0];
+			__m128 flux = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(c0,_mm_loadu_ps(w)),_mm_mul_ps(c1,_mm_loadu_ps(w + 4))),
+				_mm_add_ps(_mm_mul_ps(c2,_mm_loadu_ps(w + 8)),_mm_mul_ps(c3,_mm_loadu_ps(w + 12))));
+			flux = _mm_max_ps(flux,zero);
+
+			const float* face = &table.Faces[n][g * 4].x_;
+			sum = _mm_add_ps(sum,_mm_mul_ps(_mm_shuffle_ps(flux,flux,_MM_SHUFFLE(0,0,0,0)),_mm_loadu_ps(face)));
+			sum = _mm_add_ps(sum,_mm_mul_ps(_mm_shuffle_ps(flux,flux,_MM_SHUFFLE(1,1,1,1)),_mm_loadu_ps(face + 4)));
+			sum = _mm_add_ps(sum,_mm_mul_ps(_mm_shuffle_ps(flux,flux,_MM_SHUFFLE(2,2,2,2)),_mm_loadu_ps(face + 8)));
+			sum = _mm_add_ps(sum,_mm_mul_ps(_mm_shuffle_ps(flux,flux,_MM_SHUFFLE(3,3,3,3)),_mm_loadu_ps(face + 12)));
+		}
+		return sum;
+	}
+#else
+	static inline Vector4 Gather(const Vector4& sh,const GatherTable& table,unsigned n)
+	{
+		Vector4 sum = Vector4::ZERO;
+		for(unsigned g = 0; g < 2; ++g)
+		{
+			for(unsigned l = 0; l < 4; ++l)
+			{
+				const float (&w)[4][4] = table.Weights[n][g];
+				float flux = sh.x_ * w[0][l] + sh.y_ * w[1][l] + sh.z_ * w[2][l] + sh.w_ * w[3][l];
+				if(flux > 0)
+					sum += table.Faces[n][g * 4 + l] * flux;
+			}
+		}
+		return sum;
+	}
+#endif
+
+	Vector4 LpvShBasis(const Vector3& dir)
+	{
+		return Vector4(0.282094792f,-0.4886025119f * dir.y_,0.4886025119f * dir.z_,-0.4886025119f * dir.x_);
+	}
+
+	Vector4 LpvShClampedCosine(const Vector3& dir)
+	{
+		Vector4 v = LpvShBasis(dir);
+		float d = (2.0f * M_PI) / 3.0f;
+		return Vector4(M_PI * v.x_,d * v.y_,d * v.z_,d * v.w_);
+	}
+
+	LightPropagationGrid::LightPropagationGrid()
+		: size_(0),
+		numThreads_(1),
+		workQueue_(gYume ? gYume->pWorkSystem.Get() : 0),
+		firstIteration_(false),
+		iterations_(0),
+		fluxAmplifier_(4.0f),
+		min_(Vector3::ZERO),
+		max_(Vector3::ONE),
+		lightDirection_(Vector3::ZERO),
+		lightColor_(YumeColor::BLACK)
+	{
+		SetNumThreads(0);
+	}
+
+	void LightPropagationGrid::Create(unsigned size)
+	{
+		size_ = size;
+
+		unsigned numCells = GetNumCells();
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			cells_[c].resize(numCells);
+			next_[c].resize(numCells);
+			accum_[c].resize(numCells);
+		}
+		counts_.resize(numCells);
+
+		Clear();
+	}
+
+	void LightPropagationGrid::Clear()
+	{
+		unsigned numCells = GetNumCells();
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			for(unsigned i = 0; i < numCells; ++i)
+			{
+				cells_[c][i] = Vector4::ZERO;
+				next_[c][i] = Vector4::ZERO;
+				accum_[c][i] = Vector4::ZERO;
+			}
+		}
+		for(unsigned i = 0; i < numCells; ++i)
+			counts_[i] = 0;
+
+		iterations_ = 0;
+	}
+
+	void LightPropagationGrid::SetBounds(const Vector3& min,const Vector3& max)
+	{
+		min_ = min;
+		max_ = max;
+	}
+
+	void LightPropagationGrid::SetNumThreads(unsigned threads)
+	{
+		if(!threads)
+			threads = std::thread::hardware_concurrency();
+		numThreads_ = Max((int)threads,1);
+	}
+
+	void LightPropagationGrid::Inject(const LpvVpl* vpls,unsigned count,const Vector3& lightPos)
+	{
+		Vector3 diag = max_ - min_;
+		float size = (float)size_;
+
+		for(unsigned i = 0; i < count; ++i)
+		{
+			const LpvVpl& vpl = vpls[i];
+
+			//Texels the RSM did not cover
+			if(vpl.Normal == Vector3::ZERO)
+				continue;
+
+			//Same as moving the point out of the viewport, wrong sided normals do not inject
+			Vector3 toLight = (lightPos - vpl.Position).Normalized();
+			float cosine = vpl.Normal.DotProduct(toLight);
+			if(cosine < 0)
+				continue;
+
+			//Half a cell along the normal so the flux starts in front of the surface
+			Vector3 pos = (vpl.Position - min_) / diag;
+			Vector3 normal = (vpl.Normal / diag).Normalized();
+			pos += normal * (0.5f / size);
+
+			int x = (int)floorf(pos.x_ * size);
+			int y = (int)floorf(pos.y_ * size);
+			int z = (int)floorf(pos.z_ * size);
+			if(x < 0 || y < 0 || z < 0 || x >= (int)size_ || y >= (int)size_ || z >= (int)size_)
+				continue;
+
+			Vector3 color = vpl.Flux / M_PI * Min(cosine,1.0f);
+			Vector4 coeffs = LpvShClampedCosine(vpl.Normal.Normalized());
+
+			unsigned index = GetCellIndex(x,y,z);
+			cells_[0][index] += coeffs * color.x_;
+			cells_[1][index] += coeffs * color.y_;
+			cells_[2][index] += coeffs * color.z_;
+			counts_[index] += 1.0f;
+		}
+	}
+
+	void LightPropagationGrid::Normalize()
+	{
+		unsigned numCells = GetNumCells();
+		for(unsigned i = 0; i < numCells; ++i)
+		{
+			if(counts_[i] <= 0)
+				continue;
+
+			float scale = 1.0f / counts_[i];
+			for(unsigned c = 0; c < 3; ++c)
+				cells_[c][i] *= scale;
+		}
+	}
+
+	void LightPropagationGrid::Propagate(unsigned iterations)
+	{
+		unsigned numCells = GetNumCells();
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			for(unsigned i = 0; i < numCells; ++i)
+				accum_[c][i] = Vector4::ZERO;
+		}
+
+		iterations_ = 0;
+		ContinuePropagation(iterations);
+	}
+
+	void LightPropagationGrid::ContinuePropagation(unsigned iterations)
+	{
+		unsigned numThreads = Min((int)numThreads_,(int)size_);
+
+		for(unsigned i = 0; i < iterations; ++i)
+		{
+			bool firstIteration = iterations_ + i == 0;
+
+			//Slices only read the previous iteration, each work item writes its own
+			if(workQueue_ && numThreads > 1)
+			{
+				firstIteration_ = firstIteration;
+
+				float* counts = &counts_[0];
+				unsigned sliceSize = size_ * size_;
+				for(unsigned t = 0; t < numThreads; ++t)
+				{
+					SharedPtr<WorkItem> item = workQueue_->GetFreeItem();
+					item->priority_ = M_MAX_UNSIGNED;
+					item->workFunction_ = PropagateSlicesWork;
+					item->aux_ = this;
+					item->start_ = counts + size_ * t / numThreads * sliceSize;
+					item->end_ = counts + size_ * (t + 1) / numThreads * sliceSize;
+					workQueue_->AddWorkItem(item);
+				}
+				workQueue_->Complete(M_MAX_UNSIGNED);
+			}
+			else
+				PropagateSlices(0,size_,firstIteration);
+
+			for(unsigned c = 0; c < 3; ++c)
+				cells_[c].Swap(next_[c]);
+		}
+
+		iterations_ += iterations;
+	}
+
+	float LightPropagationGrid::GetEnergy() const
+	{
+		float energy = 0;
+		unsigned numCells = GetNumCells();
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			for(unsigned i = 0; i < numCells; ++i)
+				energy += Abs(cells_[c][i].x_);
+		}
+		return energy;
+	}
+
+	void LightPropagationGrid::PropagateSlicesWork(const WorkItem* item,unsigned threadIndex)
+	{
+		LightPropagationGrid* grid = reinterpret_cast<LightPropagationGrid*>(item->aux_);
+		const float* counts = &grid->counts_[0];
+		unsigned sliceSize = grid->size_ * grid->size_;
+		unsigned first = (unsigned)(reinterpret_cast<const float*>(item->start_) - counts) / sliceSize;
+		unsigned last = (unsigned)(reinterpret_cast<const float*>(item->end_) - counts) / sliceSize;
+		grid->PropagateSlices(first,last,grid->firstIteration_);
+	}
+
+	void LightPropagationGrid::PropagateSlices(unsigned first,unsigned last,bool firstIteration)
+	{
+		GatherTable table;
+		BuildGatherTable(fluxAmplifier_,table);
+
+		int size = (int)size_;
+
+		for(int z = (int)first; z < (int)last; ++z)
+		{
+			for(int y = 0; y < size; ++y)
+			{
+				for(int x = 0; x < size; ++x)
+				{
+					unsigned index = GetCellIndex(x,y,z);
+
+					//Neighbours outside the volume load as zero on the GPU
+					unsigned neighbours[6];
+					bool inside[6];
+					for(unsigned n = 0; n < 6; ++n)
+					{
+						int nx = x + neighbourOffsets[n][0];
+						int ny = y + neighbourOffsets[n][1];
+						int nz = z + neighbourOffsets[n][2];
+						inside[n] = nx >= 0 && ny >= 0 && nz >= 0 && nx < size && ny < size && nz < size;
+						neighbours[n] = inside[n] ? GetCellIndex(nx,ny,nz) : 0;
+					}
+
+					for(unsigned c = 0; c < 3; ++c)
+					{
+						const Vector4* cells = &cells_[c][0];
+						Vector4 result;
+#ifdef YUME_SSE
+						__m128 sum = _mm_setzero_ps();
+						for(unsigned n = 0; n < 6; ++n)
+						{
+							if(inside[n])
+								sum = _mm_add_ps(sum,Gather(cells[neighbours[n]],table,n));
+						}
+						if(firstIteration)
+							sum = _mm_add_ps(sum,_mm_mul_ps(_mm_loadu_ps(&cells[index].x_),_mm_set1_ps(fluxAmplifier_)));
+						_mm_storeu_ps(&result.x_,sum);
+#else
+						result = Vector4::ZERO;
+						for(unsigned n = 0; n < 6; ++n)
+						{
+							if(inside[n])
+								result += Gather(cells[neighbours[n]],table,n);
+						}
+						if(firstIteration)
+							result += cells[index] * fluxAmplifier_;
+#endif
+						next_[c][index] = result;
+						accum_[c][index] += result;
+					}
+				}
+			}
+		}
+	}
+
+	bool LightPropagationGrid::Save(StreamWriter& dest) const
+	{
+		bool success = true;
+		success &= dest.WriteFileID("YLPV");
+		success &= dest.WriteUInt(LPV_BAKE_VERSION);
+		success &= dest.WriteUInt(size_);
+		success &= dest.WriteVector3(min_);
+		success &= dest.WriteVector3(max_);
+		success &= dest.WriteFloat(fluxAmplifier_);
+		success &= dest.WriteUInt(iterations_);
+		success &= dest.WriteVector3(lightDirection_);
+		success &= dest.WriteColor(lightColor_);
+
+		unsigned bytes = GetNumCells() * sizeof(Vector4);
+		for(unsigned c = 0; c < 3; ++c)
+			success &= dest.Write(&accum_[c][0],bytes) == bytes;
+
+		return success;
+	}
+
+	bool LightPropagationGrid::Load(StreamReader& source)
+	{
+		if(source.ReadFileID() != "YLPV")
+		{
+			YUMELOG_ERROR("Not a light propagation volume bake");
+			return false;
+		}
+
+		unsigned version = source.ReadUInt();
+		if(version != LPV_BAKE_VERSION)
+		{
+			YUMELOG_ERROR("Light propagation volume bake version " << version << " is not supported");
+			return false;
+		}
+
+		unsigned size = source.ReadUInt();
+		Vector3 min = source.ReadVector3();
+		Vector3 max = source.ReadVector3();
+		float amplifier = source.ReadFloat();
+		unsigned iterations = source.ReadUInt();
+		Vector3 lightDirection = source.ReadVector3();
+		YumeColor lightColor = source.ReadColor();
+
+		unsigned bytes = size * size * size * sizeof(Vector4);
+		if(!size || source.GetSize() - source.GetPosition() < bytes * 3)
+		{
+			YUMELOG_ERROR("Light propagation volume bake is truncated");
+			return false;
+		}
+
+		Create(size);
+		SetBounds(min,max);
+		SetFluxAmplifier(amplifier);
+		SetLight(lightDirection,lightColor);
+
+		for(unsigned c = 0; c < 3; ++c)
+			source.Read(&accum_[c][0],bytes);
+
+		iterations_ = iterations;
+		return true;
+	}
+}
@@ -0,0 +1,132 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : LightPropagationGrid.h
+// Date : <Date>
+// Comments : Light propagation volume on the CPU, reference of the LPV passes and offline bake
+//
+//----------------------------------------------------------------------------
+#ifndef __LightPropagationGrid_h__
+#define __LightPropagationGrid_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeVector4.h"
+#include "Math/YumeColor.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class StreamReader;
+	class StreamWriter;
+	class YumeWorkQueue;
+	struct WorkItem;
+
+	//One texel of the reflective shadow map, what gen_vpl in LPV/Tools.hlsl returns.
+	//Position and normal are in world space, a zero normal marks a texel without geometry.
+	struct LpvVpl
+	{
+		Vector3 Position;
+		Vector3 Normal;
+		Vector3 Flux;
+	};
+
+	//First two SH bands of a direction, sh4 in the shaders
+	YumeAPIExport Vector4 LpvShBasis(const Vector3& dir);
+	//Clamped cosine lobe around a direction, sh_clamped_cos_coeff in the shaders
+	YumeAPIExport Vector4 LpvShClampedCosine(const Vector3& dir);
+
+	//Same passes as LightPropagationVolume.xml, cell for cell:
+	//	Inject    - LPVInject.hlsl, every VPL adds its cosine lobe to the cell it lands in
+	//	Normalize - LPVNormalize.hlsl, cells are divided by the number of VPLs they got
+	//	Propagate - LPVPropagate.hlsl, each iteration gathers from the 6 neighbours into the accumulation
+	//Cells are 4 SH coefficients per color channel laid out like the texture arrays, x fastest then y
+	//then the slice. Propagation runs with SSE when YUME_SSE is defined and splits the slices over work items.
+	class YumeAPIExport LightPropagationGrid
+	{
+	public:
+		LightPropagationGrid();
+
+		void Create(unsigned size);
+		void Clear();
+
+		//World space box the volume covers, same as LightPropagationVolume::SetModelMatrix with an identity model
+		void SetBounds(const Vector3& min,const Vector3& max);
+		void SetFluxAmplifier(float amplifier) { fluxAmplifier_ = amplifier; }
+		//Directional light the reflective shadow map was rendered with, only kept so a bake can tell it is out of date
+		void SetLight(const Vector3& direction,const YumeColor& color) { lightDirection_ = direction; lightColor_ = color; }
+		//Groups the slices are split into, 0 uses every hardware thread
+		void SetNumThreads(unsigned threads);
+		//Runs the slice groups, the engine's by default. Null propagates on the calling thread.
+		void SetWorkQueue(YumeWorkQueue* queue) { workQueue_ = queue; }
+
+		void Inject(const LpvVpl* vpls,unsigned count,const Vector3& lightPos);
+		void Normalize();
+		//Once after Normalize, the accumulation holds the sum of all iterations
+		void Propagate(unsigned iterations);
+		//More iterations on top of the ones already run, the result is the same as propagating them in one go
+		void ContinuePropagation(unsigned iterations);
+		//What the last iteration moved, the first SH coefficient summed over cells and channels.
+		//Before propagating it is what was injected.
+		float GetEnergy() const;
+
+		unsigned GetSize() const { return size_; }
+		unsigned GetNumCells() const { return size_ * size_ * size_; }
+		unsigned GetCellIndex(unsigned x,unsigned y,unsigned z) const { return x + size_ * (y + size_ * z); }
+		const Vector3& GetMin() const { return min_; }
+		const Vector3& GetMax() const { return max_; }
+		float GetFluxAmplifier() const { return fluxAmplifier_; }
+		const Vector3& GetLightDirection() const { return lightDirection_; }
+		const YumeColor& GetLightColor() const { return lightColor_; }
+		unsigned GetNumThreads() const { return numThreads_; }
+		YumeWorkQueue* GetWorkQueue() const { return workQueue_; }
+		unsigned GetIterations() const { return iterations_; }
+
+		//Channel 0 to 2 is red, green, blue. Cells are the injected values before propagating and the
+		//last iteration after, the accumulation is what deferred_lpv samples.
+		const Vector4* GetCells(unsigned channel) const { return &cells_[channel][0]; }
+		const Vector4* GetAccumulated(unsigned channel) const { return &accum_[channel][0]; }
+		float GetInjectCount(unsigned index) const { return counts_[index]; }
+
+		//Only the accumulation and what it was made with is kept, that is all a static scene needs
+		bool Save(StreamWriter& dest) const;
+		bool Load(StreamReader& source);
+
+	private:
+		void PropagateSlices(unsigned first,unsigned last,bool firstIteration);
+		static void PropagateSlicesWork(const WorkItem* item,unsigned threadIndex);
+
+		unsigned size_;
+		unsigned numThreads_;
+		YumeWorkQueue* workQueue_;
+		//Iteration the work items are running
+		bool firstIteration_;
+		unsigned iterations_;
+		float fluxAmplifier_;
+		Vector3 min_;
+		Vector3 max_;
+		Vector3 lightDirection_;
+		YumeColor lightColor_;
+
+		YumePodVector<Vector4>::type cells_[3];
+		YumePodVector<Vector4>::type next_[3];
+		YumePodVector<Vector4>::type accum_[3];
+		YumePodVector<float>::type counts_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -28,6 +28,14 @@
 
 #include "RenderPass.h"
 #include "YumeMiscRenderer.h"
+#include "LightPropagationGrid.h"
+#include "Light.h"
+#include "Scene.h"
+#include "Core/YumeProfiler.h"
+#include "Core/YumeFile.h"
+#include "Core/YumeVectorBuffer.h"
+
+#include <boost/filesystem.hpp>
 
 
 
@@ -99,6 +107,7 @@ namespace YumeEngine
 
 	void LightPropagationVolume::Inject()
 	{
+		YUME_PROFILE("LightPropagationVolume::Inject");
 		RHIEvent e("LPV_Inject");
 
 		unsigned int num_vpls = static_cast<unsigned int>(NUM_VPLS*NUM_VPLS);
@@ -164,4 +173,169 @@ namespace YumeEngine
 		rp->SetShaderParameter("lpv_size",(float)volume_size_);
 
 	}
+
+	//Stored in the bake, another light makes another reflective shadow map
+	static Vector3 GetBakeLightDirection(Light* light)
+	{
+		const DirectX::XMFLOAT4& dir = light->GetDirection();
+		return Vector3(dir.x,dir.y,dir.z);
+	}
+
+	bool LightPropagationVolume::LoadBake(const YumeString& file,unsigned iterations,float fluxAmplifier)
+	{
+		if(!boost::filesystem::exists(file.c_str()))
+			return false;
+
+		YumeFile source(file);
+		YumePodVector<unsigned char>::type data(source.GetSize());
+		if(data.empty() || source.Read(&data[0],data.size()) != data.size())
+			return false;
+
+		VectorBuffer buffer(&data[0],data.size());
+		LightPropagationGrid grid;
+		if(!grid.Load(buffer))
+			return false;
+
+		const DirectX::XMFLOAT3& bbMin = gYume->pRenderer->GetMinBb();
+		const DirectX::XMFLOAT3& bbMax = gYume->pRenderer->GetMaxBb();
+		Light* light = static_cast<Light*>(gYume->pRenderer->GetScene()->GetDirectionalLight());
+		if(grid.GetSize() != volume_size_ || grid.GetIterations() != iterations || grid.GetFluxAmplifier() != fluxAmplifier ||
+			grid.GetMin() != Vector3(bbMin.x,bbMin.y,bbMin.z) || grid.GetMax() != Vector3(bbMax.x,bbMax.y,bbMax.z) ||
+			!light || grid.GetLightDirection() != GetBakeLightDirection(light) || grid.GetLightColor() != light->GetColor())
+		{
+			YUMELOG_INFO("Light propagation volume bake " << file.c_str() << " is out of date");
+			return false;
+		}
+
+		UploadBake(grid);
+
+		YUMELOG_INFO("Loaded light propagation volume bake " << file.c_str());
+		return true;
+	}
+
+	bool LightPropagationVolume::Bake(const YumeString& file,unsigned iterations,float fluxAmplifier)
+	{
+		YUME_PROFILE("LightPropagationVolume::Bake");
+
+		RenderPass* rp = gYume->pRenderer->GetDefaultPass();
+		YumeTexture2D* colors = static_cast<YumeTexture2D*>(rp->GetTextureByName("RSM_COLORS"));
+		YumeTexture2D* normals = static_cast<YumeTexture2D*>(rp->GetTextureByName("RSM_NORMALS"));
+		YumeTexture2D* depths = static_cast<YumeTexture2D*>(rp->GetTextureByName("RSM_LINEARDEPTH"));
+		if(!colors || !normals || !depths)
+		{
+			YUMELOG_ERROR("Light propagation volume bake needs the reflective shadow map");
+			return false;
+		}
+
+		//rgba16f, rgba10u2 and rg32f, see ReflectiveShadowMap.xml
+		unsigned width = colors->GetWidth();
+		unsigned height = colors->GetHeight();
+		YumePodVector<unsigned short>::type colorData(width * height * 4);
+		YumePodVector<unsigned>::type normalData(width * height);
+		YumePodVector<float>::type depthData(width * height * 2);
+		if(!colors->GetData(0,&colorData[0]) || !normals->GetData(0,&normalData[0]) || !depths->GetData(0,&depthData[0]))
+			return false;
+
+		//Same matrices as Light::UpdateLightParameters
+		Light* light = static_cast<Light*>(gYume->pRenderer->GetScene()->GetDirectionalLight());
+		DirectX::XMMATRIX lightView = DirectX::XMMatrixLookToLH(DirectX::XMLoadFloat4(&light->GetPosition()),
+			DirectX::XMLoadFloat4(&light->GetDirection()),DirectX::XMLoadFloat4(&light->GetRotation()));
+		DirectX::XMMATRIX lightViewProjInv = DirectX::XMMatrixInverse(nullptr,lightView * gYume->pRenderer->MakeProjection());
+		const DirectX::XMFLOAT4& lightPos = light->GetPosition();
+
+		YumePodVector<LpvVpl>::type vpls;
+		vpls.reserve(width * height);
+		for(unsigned y = 0; y < height; ++y)
+		{
+			for(unsigned x = 0; x < width; ++x)
+			{
+				unsigned texel = y * width + x;
+
+				//gen_vpl, texels without geometry are skipped instead of getting a zero normal
+				float depth = depthData[texel * 2];
+				if(depth < 0.0001f)
+					continue;
+
+				unsigned packed = normalData[texel];
+				Vector3 normal(
+					(packed & 0x3ff) / 1023.0f * 2.0f - 1.0f,
+					((packed >> 10) & 0x3ff) / 1023.0f * 2.0f - 1.0f,
+					((packed >> 20) & 0x3ff) / 1023.0f * 2.0f - 1.0f);
+
+				//to_ray, w is not divided out and goes into the normalize like in the shader
+				float u = (float)x / width;
+				float v = (float)y / height;
+				DirectX::XMVECTOR ray = DirectX::XMVector4Transform(DirectX::XMVectorSet((u - 0.5f) * 2.0f,(v - 0.5f) * -2.0f,1.0f,1.0f),lightViewProjInv);
+				DirectX::XMFLOAT4 dir;
+				DirectX::XMStoreFloat4(&dir,DirectX::XMVector4Normalize(ray));
+
+				LpvVpl vpl;
+				vpl.Position = Vector3(lightPos.x + dir.x * depth,lightPos.y + dir.y * depth,lightPos.z + dir.z * depth);
+				vpl.Normal = normal;
+				vpl.Flux = Vector3(HalfToFloat(colorData[texel * 4]),HalfToFloat(colorData[texel * 4 + 1]),HalfToFloat(colorData[texel * 4 + 2]));
+				vpls.push_back(vpl);
+			}
+		}
+
+		const DirectX::XMFLOAT3& bbMin = gYume->pRenderer->GetMinBb();
+		const DirectX::XMFLOAT3& bbMax = gYume->pRenderer->GetMaxBb();
+
+		LightPropagationGrid grid;
+		grid.Create(volume_size_);
+		grid.SetBounds(Vector3(bbMin.x,bbMin.y,bbMin.z),Vector3(bbMax.x,bbMax.y,bbMax.z));
+		grid.SetFluxAmplifier(fluxAmplifier);
+		grid.SetLight(GetBakeLightDirection(light),light->GetColor());
+		if(vpls.size())
+			grid.Inject(&vpls[0],vpls.size(),Vector3(lightPos.x,lightPos.y,lightPos.z));
+		grid.Normalize();
+		grid.Propagate(iterations);
+
+		UploadBake(grid);
+
+		VectorBuffer buffer;
+		grid.Save(buffer);
+
+		YumeFile dest(file,FILEMODE_WRITE);
+		if(dest.Write(buffer.GetData(),buffer.GetSize()) != buffer.GetSize())
+			YUMELOG_ERROR("Could not write light propagation volume bake " << file.c_str());
+		else
+			YUMELOG_INFO("Baked light propagation volume from " << vpls.size() << " VPLs to " << file.c_str());
+
+		return true;
+	}
+
+	void LightPropagationVolume::UploadBake(const LightPropagationGrid& grid)
+	{
+		static const char* accumNames[] ={"LPV_ACCUM_R","LPV_ACCUM_G","LPV_ACCUM_B"};
+
+		RenderPass* rp = gYume->pRenderer->GetDefaultPass();
+
+		unsigned size = grid.GetSize();
+		unsigned sliceCells = size * size;
+		YumePodVector<unsigned short>::type slice(sliceCells * 4);
+
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			YumeTexture2D* texture = static_cast<YumeTexture2D*>(rp->GetTextureByName(accumNames[c]));
+			if(!texture)
+				continue;
+
+			//rgba16f, see LightPropagationVolume.xml
+			const Vector4* cells = grid.GetAccumulated(c);
+			for(unsigned z = 0; z < size; ++z)
+			{
+				const float* src = &cells[z * sliceCells].x_;
+				for(unsigned i = 0; i < sliceCells * 4; ++i)
+					slice[i] = FloatToHalf(src[i]);
+				texture->SetSliceData(0,z,0,0,size,size,&slice[0]);
+			}
+		}
+
+		DirectX::XMFLOAT4X4 identity;
+		DirectX::XMStoreFloat4x4(&identity,DirectX::XMMatrixIdentity());
+
+		const Vector3& min = grid.GetMin();
+		const Vector3& max = grid.GetMax();
+		SetModelMatrix(identity,DirectX::XMFLOAT3(min.x_,min.y_,min.z_),DirectX::XMFLOAT3(max.x_,max.y_,max.z_));
+	}
 }
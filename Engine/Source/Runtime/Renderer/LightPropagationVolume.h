@@ -31,6 +31,7 @@ namespace YumeEngine
 {
 	class YumeTexture2D;
 	class YumeVertexBuffer;
+	class LightPropagationGrid;
 
 	class YumeAPIExport LightPropagationVolume : public GIVolume
 	{
@@ -46,7 +47,15 @@ namespace YumeEngine
 		virtual void SetModelMatrix(const DirectX::XMFLOAT4X4& model,const DirectX::XMFLOAT3& lpvMin,const DirectX::XMFLOAT3& lpvMax);
 
 		virtual YumeGeometry* GetVolumeGeometry() { return lpv_volume_geo_; }
+
+		//Static lighting. Bake reads the reflective shadow map back and runs the passes on the CPU,
+		//both fill the accumulation textures so inject and propagate can be skipped.
+		//A bake made with other settings, another scene box or another directional light does not load.
+		bool LoadBake(const YumeString& file,unsigned iterations,float fluxAmplifier);
+		bool Bake(const YumeString& file,unsigned iterations,float fluxAmplifier);
 	private:
+		void UploadBake(const LightPropagationGrid& grid);
+
 		unsigned volume_size_;
 		unsigned curr_;
 		unsigned next_;
@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : LuminanceHistogram.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "LuminanceHistogram.h"
+
+#include "Math/YumeMath.h"
+
+#include <cmath>
+
+namespace YumeEngine
+{
+	//Black pixels would be -inf, they land in the first bin like the GPU clamps them
+	static const float MIN_HISTOGRAM_LUMINANCE = 0.00001f;
+
+	LuminanceHistogram::LuminanceHistogram()
+		: minLog_(-10.0f),
+		maxLog_(6.0f),
+		low_(0.5f),
+		high_(0.95f)
+	{
+		Clear();
+	}
+
+	void LuminanceHistogram::SetRange(float minLog,float maxLog)
+	{
+		minLog_ = minLog;
+		maxLog_ = Max(maxLog,minLog + M_EPSILON);
+	}
+
+	void LuminanceHistogram::SetPercentiles(float low,float high)
+	{
+		low_ = Clamp(low,0.0f,1.0f);
+		high_ = Clamp(high,low_,1.0f);
+	}
+
+	void LuminanceHistogram::Clear()
+	{
+		for(unsigned i = 0; i < LUMINANCE_HISTOGRAM_BINS; ++i)
+			bins_[i] = 0;
+	}
+
+	void LuminanceHistogram::AddSample(float luminance)
+	{
+		bins_[GetBin(luminance)] += 1.0f;
+	}
+
+	void LuminanceHistogram::AddSamples(const float* luminance,unsigned count)
+	{
+		for(unsigned i = 0; i < count; ++i)
+			AddSample(luminance[i]);
+	}
+
+	void LuminanceHistogram::SetCount(unsigned bin,float count)
+	{
+		if(bin < LUMINANCE_HISTOGRAM_BINS)
+			bins_[bin] = count;
+	}
+
+	unsigned LuminanceHistogram::GetBin(float luminance) const
+	{
+		float logLuminance = log2f(Max(luminance,MIN_HISTOGRAM_LUMINANCE));
+		float t = Clamp((logLuminance - minLog_) / (maxLog_ - minLog_),0.0f,1.0f);
+
+		return Min((int)(t * LUMINANCE_HISTOGRAM_BINS),(int)LUMINANCE_HISTOGRAM_BINS - 1);
+	}
+
+	float LuminanceHistogram::GetBinLogLuminance(unsigned bin) const
+	{
+		return minLog_ + (bin + 0.5f) / LUMINANCE_HISTOGRAM_BINS * (maxLog_ - minLog_);
+	}
+
+	float LuminanceHistogram::GetTotal() const
+	{
+		float total = 0;
+		for(unsigned i = 0; i < LUMINANCE_HISTOGRAM_BINS; ++i)
+			total += bins_[i];
+		return total;
+	}
+
+	float LuminanceHistogram::GetAverageLuminance() const
+	{
+		float total = GetTotal();
+		float low = total * low_;
+		float high = total * high_;
+
+		//Walk up from the dark end, each bin counts with the part of it between the two percentiles
+		float seen = 0;
+		float sum = 0;
+		float weight = 0;
+		for(unsigned i = 0; i < LUMINANCE_HISTOGRAM_BINS; ++i)
+		{
+			float count = bins_[i];
+			float w = Max(Min(seen + count,high) - Max(seen,low),0.0f);
+			seen += count;
+
+			sum += w * GetBinLogLuminance(i);
+			weight += w;
+		}
+
+		if(weight <= 0)
+			return 0;
+
+		return exp2f(sum / weight);
+	}
+
+	float LuminanceHistogram::GetAdaptedLuminance(float lastAdapted,float timeStep,float speed) const
+	{
+		float average = GetAverageLuminance();
+		if(average <= 0)
+			return lastAdapted;
+
+		return Adapt(lastAdapted,average,timeStep,speed);
+	}
+
+	float LuminanceHistogram::Adapt(float adapted,float target,float timeStep,float speed)
+	{
+		return adapted + (target - adapted) * (1.0f - expf(-timeStep * speed));
+	}
+
+	float LuminanceHistogram::GetExposure(float averageLuminance,float key)
+	{
+		return Max(key / Max(averageLuminance,0.001f),0.0001f);
+	}
+}
@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : LuminanceHistogram.h
+// Date : <Date>
+// Comments : CPU side of the auto exposure, the same math as the histogram passes in Bloom.hlsl
+//
+//----------------------------------------------------------------------------
+#ifndef __LuminanceHistogram_h__
+#define __LuminanceHistogram_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//HISTOGRAM_BINS in Bloom.hlsl
+	static const unsigned LUMINANCE_HISTOGRAM_BINS = 64;
+	//Mip of the scene pyramid the histogram reads, HISTOGRAM_LEVEL in Bloom.hlsl
+	static const unsigned LUMINANCE_HISTOGRAM_LEVEL = 1;
+
+	//Counts pixels into bins spread evenly over a log2 luminance range, darker and brighter pixels
+	//go to the first and the last bin. The average is the geometric mean of what is left after
+	//the darkest and the brightest shares of the samples are dropped, so a few very bright or
+	//very dark pixels do not move the exposure.
+	class YumeAPIExport LuminanceHistogram
+	{
+	public:
+		LuminanceHistogram();
+
+		//Log2 luminance of the low end of the first bin and the high end of the last one
+		void SetRange(float minLog,float maxLog);
+		//Shares of the samples from the dark end, the ones below low and above high are ignored
+		void SetPercentiles(float low,float high);
+
+		void Clear();
+		void AddSample(float luminance);
+		void AddSamples(const float* luminance,unsigned count);
+		//For counts read back from the GPU
+		void SetCount(unsigned bin,float count);
+
+		unsigned GetBin(float luminance) const;
+		//Log2 luminance at the center of the bin
+		float GetBinLogLuminance(unsigned bin) const;
+
+		//0 without samples
+		float GetAverageLuminance() const;
+		//What ps_adapt_exposure writes, the last value stays when there are no samples
+		float GetAdaptedLuminance(float lastAdapted,float timeStep,float speed) const;
+
+		//Moves towards the target the same share of the distance each second
+		static float Adapt(float adapted,float target,float timeStep,float speed);
+		//Linear scale calc_exposed_color applies to the scene
+		static float GetExposure(float averageLuminance,float key);
+
+		float GetCount(unsigned bin) const { return bins_[bin]; }
+		float GetTotal() const;
+		float GetMinLog() const { return minLog_; }
+		float GetMaxLog() const { return maxLog_; }
+		float GetLowPercentile() const { return low_; }
+		float GetHighPercentile() const { return high_; }
+
+	private:
+		float minLog_;
+		float maxLog_;
+		float low_;
+		float high_;
+
+		float bins_[LUMINANCE_HISTOGRAM_BINS];
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
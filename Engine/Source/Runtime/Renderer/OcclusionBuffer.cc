@@ -0,0 +1,364 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : OcclusionBuffer.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "OcclusionBuffer.h"
+
+#include "Math/YumeMath.h"
+#include "Core/YumeWorkQueue.h"
+
+#include <thread>
+
+#ifdef YUME_SSE
+#include <emmintrin.h>
+#endif
+
+namespace YumeEngine
+{
+	//A surface lying on the face of its own box must not hide the box, the interpolated depth
+	//is a few ulps off the one of the corners
+	static const float OCCLUSION_DEPTH_BIAS = 0.00001f;
+
+	OcclusionBuffer::OcclusionBuffer()
+		: width_(0),
+		height_(0),
+		numThreads_(1),
+		workQueue_(gYume ? gYume->pWorkSystem.Get() : 0),
+		viewProj_(Matrix4::IDENTITY)
+	{
+		SetSize(256,128);
+	}
+
+	void OcclusionBuffer::SetSize(unsigned width,unsigned height)
+	{
+		width_ = (Max((int)width,4) + 3) & ~3;
+		height_ = Max((int)height,1);
+
+		unsigned numLevels = 1;
+		while(GetLevelWidth(numLevels - 1) > 1 || GetLevelHeight(numLevels - 1) > 1)
+			++numLevels;
+
+		levels_.resize(numLevels);
+		for(unsigned i = 0; i < numLevels; ++i)
+			levels_[i].resize(GetLevelWidth(i) * GetLevelHeight(i));
+
+		Clear();
+	}
+
+	void OcclusionBuffer::SetNumThreads(unsigned threads)
+	{
+		if(!threads)
+			threads = std::thread::hardware_concurrency();
+		numThreads_ = Max((int)threads,1);
+	}
+
+	void OcclusionBuffer::SetView(const Matrix4& viewProj)
+	{
+		viewProj_ = viewProj;
+	}
+
+	void OcclusionBuffer::Clear()
+	{
+		triangles_.clear();
+
+		for(unsigned i = 0; i < levels_.size(); ++i)
+		{
+			YumePodVector<float>::type& level = levels_[i];
+			for(unsigned j = 0; j < level.size(); ++j)
+				level[j] = 1.0f;
+		}
+	}
+
+	void OcclusionBuffer::AddOccluder(const Vector3* vertices,unsigned numVertices,const unsigned* indices,unsigned numIndices,const Matrix3x4& world)
+	{
+		Matrix4 modelViewProj = viewProj_ * world;
+
+		clipVertices_.resize(numVertices);
+		for(unsigned i = 0; i < numVertices; ++i)
+			clipVertices_[i] = modelViewProj * Vector4(vertices[i],1.0f);
+
+		for(unsigned i = 0; i + 2 < numIndices; i += 3)
+		{
+			if(indices[i] >= numVertices || indices[i + 1] >= numVertices || indices[i + 2] >= numVertices)
+				continue;
+
+			const Vector4* in[3] ={&clipVertices_[indices[i]],&clipVertices_[indices[i + 1]],&clipVertices_[indices[i + 2]]};
+
+			//Clipped at the near plane, z >= 0, which leaves a triangle or a quad
+			Vector4 out[4];
+			unsigned numOut = 0;
+			for(unsigned j = 0; j < 3; ++j)
+			{
+				const Vector4& a = *in[j];
+				const Vector4& b = *in[(j + 1) % 3];
+
+				if(a.z_ >= 0)
+					out[numOut++] = a;
+				if((a.z_ >= 0) != (b.z_ >= 0))
+				{
+					float t = a.z_ / (a.z_ - b.z_);
+					out[numOut++] = a + (b - a) * t;
+				}
+			}
+
+			if(numOut >= 3)
+				AddTriangle(out[0],out[1],out[2]);
+			if(numOut == 4)
+				AddTriangle(out[0],out[2],out[3]);
+		}
+	}
+
+	void OcclusionBuffer::AddTriangle(const Vector4& a,const Vector4& b,const Vector4& c)
+	{
+		const Vector4* v[3] ={&a,&b,&c};
+		float x[3];
+		float y[3];
+		float z[3];
+
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			float invW = 1.0f / v[i]->w_;
+			x[i] = (v[i]->x_ * invW * 0.5f + 0.5f) * width_;
+			y[i] = (0.5f - v[i]->y_ * invW * 0.5f) * height_;
+			z[i] = v[i]->z_ * invW;
+		}
+
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+		if(Abs(area) < M_EPSILON)
+			return;
+
+		OcclusionTriangle t;
+
+		//Pixels whose center is inside the bounds
+		t.MinX = Max((int)ceilf(Min(x[0],Min(x[1],x[2])) - 0.5f),0);
+		t.MaxX = Min((int)floorf(Max(x[0],Max(x[1],x[2])) - 0.5f),(int)width_ - 1);
+		t.MinY = Max((int)ceilf(Min(y[0],Min(y[1],y[2])) - 0.5f),0);
+		t.MaxY = Min((int)floorf(Max(y[0],Max(y[1],y[2])) - 0.5f),(int)height_ - 1);
+		if(t.MinX > t.MaxX || t.MinY > t.MaxY)
+			return;
+
+		//Edge i is the one opposite of vertex i, flipped so either winding is positive inside.
+		//Occluders are two sided, whatever faces the camera hides what is behind it.
+		float sign = area > 0 ? 1.0f : -1.0f;
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			unsigned j = (i + 1) % 3;
+			unsigned k = (i + 2) % 3;
+			t.EdgeA[i] = -(y[k] - y[j]) * sign;
+			t.EdgeB[i] = (x[k] - x[j]) * sign;
+			t.EdgeC[i] = -(t.EdgeA[i] * x[j] + t.EdgeB[i] * y[j]);
+		}
+
+		//Barycentrics of vertex 1 and 2 are their edge functions over the area
+		float invArea = 1.0f / Abs(area);
+		float dz1 = (z[1] - z[0]) * invArea;
+		float dz2 = (z[2] - z[0]) * invArea;
+		t.DepthA = t.EdgeA[1] * dz1 + t.EdgeA[2] * dz2;
+		t.DepthB = t.EdgeB[1] * dz1 + t.EdgeB[2] * dz2;
+		t.DepthC = z[0] + t.EdgeC[1] * dz1 + t.EdgeC[2] * dz2;
+
+		triangles_.push_back(t);
+	}
+
+	void OcclusionBuffer::Rasterize()
+	{
+		unsigned numThreads = Min((int)numThreads_,(int)height_);
+
+		//Each work item writes its own rows, no triangle is binned or shared
+		if(workQueue_ && numThreads > 1 && triangles_.size())
+		{
+			float* depth = &levels_[0][0];
+			for(unsigned t = 0; t < numThreads; ++t)
+			{
+				SharedPtr<WorkItem> item = workQueue_->GetFreeItem();
+				item->priority_ = M_MAX_UNSIGNED;
+				item->workFunction_ = RasterizeRowsWork;
+				item->aux_ = this;
+				item->start_ = depth + height_ * t / numThreads * width_;
+				item->end_ = depth + height_ * (t + 1) / numThreads * width_;
+				workQueue_->AddWorkItem(item);
+			}
+			workQueue_->Complete(M_MAX_UNSIGNED);
+		}
+		else
+			RasterizeRows(0,height_);
+
+		BuildPyramid();
+	}
+
+	void OcclusionBuffer::RasterizeRowsWork(const WorkItem* item,unsigned threadIndex)
+	{
+		OcclusionBuffer* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
+		const float* depth = &buffer->levels_[0][0];
+		unsigned first = (unsigned)(reinterpret_cast<const float*>(item->start_) - depth) / buffer->width_;
+		unsigned last = (unsigned)(reinterpret_cast<const float*>(item->end_) - depth) / buffer->width_;
+		buffer->RasterizeRows(first,last);
+	}
+
+	void OcclusionBuffer::RasterizeRows(unsigned first,unsigned last)
+	{
+		float* depth = &levels_[0][0];
+
+		for(unsigned i = 0; i < triangles_.size(); ++i)
+		{
+			const OcclusionTriangle& t = triangles_[i];
+
+			int minY = Max(t.MinY,(int)first);
+			int maxY = Min(t.MaxY,(int)last - 1);
+
+			for(int y = minY; y <= maxY; ++y)
+			{
+				float py = y + 0.5f;
+				float row0 = t.EdgeB[0] * py + t.EdgeC[0];
+				float row1 = t.EdgeB[1] * py + t.EdgeC[1];
+				float row2 = t.EdgeB[2] * py + t.EdgeC[2];
+				float rowZ = t.DepthB * py + t.DepthC;
+				float* dest = depth + y * width_;
+
+#ifdef YUME_SSE
+				//Width is a multiple of 4, so starting on a multiple of 4 never runs past the row
+				__m128 offsets = _mm_set_ps(3.5f,2.5f,1.5f,0.5f);
+				__m128 zero = _mm_setzero_ps();
+
+				for(int x = t.MinX & ~3; x <= t.MaxX; x += 4)
+				{
+					__m128 px = _mm_add_ps(_mm_set1_ps((float)x),offsets);
+
+					__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.EdgeA[0]),px),_mm_set1_ps(row0));
+					__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.EdgeA[1]),px),_mm_set1_ps(row1));
+					__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.EdgeA[2]),px),_mm_set1_ps(row2));
+					__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0,zero),_mm_cmpge_ps(e1,zero)),_mm_cmpge_ps(e2,zero));
+					if(!_mm_movemask_ps(inside))
+						continue;
+
+					__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.DepthA),px),_mm_set1_ps(rowZ));
+					__m128 current = _mm_loadu_ps(dest + x);
+					__m128 nearest = _mm_min_ps(current,z);
+					_mm_storeu_ps(dest + x,_mm_or_ps(_mm_and_ps(inside,nearest),_mm_andnot_ps(inside,current)));
+				}
+#else
+				for(int x = t.MinX; x <= t.MaxX; ++x)
+				{
+					float px = x + 0.5f;
+					if(t.EdgeA[0] * px + row0 < 0 || t.EdgeA[1] * px + row1 < 0 || t.EdgeA[2] * px + row2 < 0)
+						continue;
+
+					float z = t.DepthA * px + rowZ;
+					if(z < dest[x])
+						dest[x] = z;
+				}
+#endif
+			}
+		}
+	}
+
+	void OcclusionBuffer::BuildPyramid()
+	{
+		for(unsigned level = 1; level < levels_.size(); ++level)
+		{
+			const YumePodVector<float>::type& src = levels_[level - 1];
+			YumePodVector<float>::type& dest = levels_[level];
+
+			unsigned srcWidth = GetLevelWidth(level - 1);
+			unsigned srcHeight = GetLevelHeight(level - 1);
+			unsigned width = GetLevelWidth(level);
+			unsigned height = GetLevelHeight(level);
+
+			for(unsigned y = 0; y < height; ++y)
+			{
+				unsigned y0 = y * 2;
+				unsigned y1 = Min((int)y0 + 1,(int)srcHeight - 1);
+
+				for(unsigned x = 0; x < width; ++x)
+				{
+					unsigned x0 = x * 2;
+					unsigned x1 = Min((int)x0 + 1,(int)srcWidth - 1);
+
+					//Farthest, so the texel never claims more than every pixel under it does
+					dest[y * width + x] = Max(Max(src[y0 * srcWidth + x0],src[y0 * srcWidth + x1]),
+						Max(src[y1 * srcWidth + x0],src[y1 * srcWidth + x1]));
+				}
+			}
+		}
+	}
+
+	bool OcclusionBuffer::IsVisible(const BoundingBox& worldBox) const
+	{
+		if(!triangles_.size())
+			return true;
+
+		float minX = M_INFINITY;
+		float minY = M_INFINITY;
+		float maxX = -M_INFINITY;
+		float maxY = -M_INFINITY;
+		float minZ = M_INFINITY;
+
+		for(unsigned i = 0; i < 8; ++i)
+		{
+			Vector3 corner(
+				i & 1 ? worldBox.max_.x_ : worldBox.min_.x_,
+				i & 2 ? worldBox.max_.y_ : worldBox.min_.y_,
+				i & 4 ? worldBox.max_.z_ : worldBox.min_.z_);
+			Vector4 clip = viewProj_ * Vector4(corner,1.0f);
+
+			//Crossing the near plane, the camera may be inside it
+			if(clip.w_ <= M_EPSILON || clip.z_ < 0)
+				return true;
+
+			float invW = 1.0f / clip.w_;
+			float x = (clip.x_ * invW * 0.5f + 0.5f) * width_;
+			float y = (0.5f - clip.y_ * invW * 0.5f) * height_;
+
+			minX = Min(minX,x);
+			maxX = Max(maxX,x);
+			minY = Min(minY,y);
+			maxY = Max(maxY,y);
+			minZ = Min(minZ,clip.z_ * invW);
+		}
+
+		if(maxX < 0 || maxY < 0 || minX >= width_ || minY >= height_)
+			return true;
+
+		int x0 = Max((int)floorf(minX),0);
+		int y0 = Max((int)floorf(minY),0);
+		int x1 = Min((int)floorf(maxX),(int)width_ - 1);
+		int y1 = Min((int)floorf(maxY),(int)height_ - 1);
+
+		//Coarsest level where the box still covers only a few texels
+		unsigned level = 0;
+		int size = Max(x1 - x0,y1 - y0);
+		while((size >> level) > 2 && level + 1 < levels_.size())
+			++level;
+
+		minZ -= OCCLUSION_DEPTH_BIAS;
+
+		for(int y = y0 >> level; y <= (y1 >> level); ++y)
+		{
+			for(int x = x0 >> level; x <= (x1 >> level); ++x)
+			{
+				if(GetDepth(x,y,level) >= minZ)
+					return true;
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : OcclusionBuffer.h
+// Date : <Date>
+// Comments : Software rasterized depth of the occluders and its hierarchical-Z pyramid
+//
+//----------------------------------------------------------------------------
+#ifndef __OcclusionBuffer_h__
+#define __OcclusionBuffer_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeVector4.h"
+#include "Math/YumeMatrix3x4.h"
+#include "Math/YumeMatrix4.h"
+#include "Math/YumeBoundingBox.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class YumeWorkQueue;
+	struct WorkItem;
+
+	//Screen space triangle with its edge and depth planes, ready to be scanned
+	struct OcclusionTriangle
+	{
+		//Edge functions, a * x + b * y + c is positive inside
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		//Depth plane, z = a * x + b * y + c
+		float DepthA;
+		float DepthB;
+		float DepthC;
+		//Pixel rectangle, inclusive
+		int MinX;
+		int MaxX;
+		int MinY;
+		int MaxY;
+	};
+
+	//Depth only rasterizer for the occlusion culling of the main view, entirely on the CPU so it runs
+	//the same on every backend:
+	//	AddOccluder - triangles go to clip space, are clipped at the near plane and set up in screen space
+	//	Rasterize   - rows are split over work items, each scans every triangle over its own rows, 4 pixels
+	//	              at a time with SSE when YUME_SSE is defined. Then the pyramid is built from the result.
+	//Depth is z / w like D3D, 0 near and 1 far. Level 0 keeps the nearest occluder of each pixel, every
+	//level above it the farthest of the 2x2 texels below, so one texel of a coarse level tells how far
+	//away the occluders are at worst over its whole area.
+	class YumeAPIExport OcclusionBuffer
+	{
+	public:
+		OcclusionBuffer();
+
+		//Width is rounded up to a multiple of 4
+		void SetSize(unsigned width,unsigned height);
+		//Bands the rows are split into, 0 uses every hardware thread
+		void SetNumThreads(unsigned threads);
+		//Runs the bands, the engine's by default. Null rasterizes on the calling thread.
+		void SetWorkQueue(YumeWorkQueue* queue) { workQueue_ = queue; }
+		//World to clip space, column vectors like the rest of Math
+		void SetView(const Matrix4& viewProj);
+
+		//Drops the occluders and resets the depth to the far plane
+		void Clear();
+		//Triangle list in model space
+		void AddOccluder(const Vector3* vertices,unsigned numVertices,const unsigned* indices,unsigned numIndices,const Matrix3x4& world);
+		void Rasterize();
+
+		//False when every texel the box covers has an occluder in front of the box's nearest point.
+		//Boxes crossing the near plane or off the screen are visible, that is for the frustum to decide.
+		bool IsVisible(const BoundingBox& worldBox) const;
+
+		unsigned GetWidth() const { return width_; }
+		unsigned GetHeight() const { return height_; }
+		unsigned GetNumThreads() const { return numThreads_; }
+		YumeWorkQueue* GetWorkQueue() const { return workQueue_; }
+		unsigned GetNumTriangles() const { return triangles_.size(); }
+		unsigned GetNumLevels() const { return levels_.size(); }
+		//Rounded up, a texel of level n covers pixels x << n to (x + 1) << n
+		unsigned GetLevelWidth(unsigned level) const { return (width_ + (1 << level) - 1) >> level; }
+		unsigned GetLevelHeight(unsigned level) const { return (height_ + (1 << level) - 1) >> level; }
+		float GetDepth(unsigned x,unsigned y,unsigned level = 0) const { return levels_[level][y * GetLevelWidth(level) + x]; }
+		const Matrix4& GetView() const { return viewProj_; }
+
+	private:
+		void AddTriangle(const Vector4& a,const Vector4& b,const Vector4& c);
+		void RasterizeRows(unsigned first,unsigned last);
+		static void RasterizeRowsWork(const WorkItem* item,unsigned threadIndex);
+		void BuildPyramid();
+
+		unsigned width_;
+		unsigned height_;
+		unsigned numThreads_;
+		YumeWorkQueue* workQueue_;
+		Matrix4 viewProj_;
+
+		YumePodVector<OcclusionTriangle>::type triangles_;
+		YumePodVector<Vector4>::type clipVertices_;
+		YumeVector<YumePodVector<float>::type>::type levels_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
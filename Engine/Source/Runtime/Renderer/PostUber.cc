@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : PostUber.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "PostUber.h"
+
+#include "Math/YumeMath.h"
+
+namespace YumeEngine
+{
+	PostUber::PostUber()
+		: focalPlane_(0.0f),
+		focalRange_(2000.0f),
+		cocScale_(1.5f),
+		bloomIntensity_(1.0f),
+		vignetteIntensity_(0.35f),
+		vignettePower_(1.5f),
+		saturation_(1.0f),
+		contrast_(1.0f),
+		tint_(1.0f,1.0f,1.0f,1.0f)
+	{
+	}
+
+	void PostUber::SetFocus(float plane,float range)
+	{
+		focalPlane_ = plane;
+		focalRange_ = Max(range,M_EPSILON);
+	}
+
+	void PostUber::SetCocScale(float scale)
+	{
+		cocScale_ = Max(scale,0.0f);
+	}
+
+	void PostUber::SetBloomIntensity(float intensity)
+	{
+		bloomIntensity_ = intensity;
+	}
+
+	void PostUber::SetVignette(float intensity,float power)
+	{
+		vignetteIntensity_ = intensity;
+		vignettePower_ = power;
+	}
+
+	void PostUber::SetGrading(float saturation,float contrast,const YumeColor& tint)
+	{
+		saturation_ = saturation;
+		contrast_ = contrast;
+		tint_ = tint;
+	}
+
+	float PostUber::GetCircleOfConfusion(float depth) const
+	{
+		return Clamp(Abs(depth - focalPlane_) / focalRange_,0.0f,1.0f) * cocScale_;
+	}
+
+	float PostUber::GetDofLevel(float coc,unsigned levels)
+	{
+		//Level 0 is the frame itself
+		float top = Min((float)(levels > 0 ? levels - 1 : 0),(float)POST_UBER_DOF_MAX_LEVEL);
+		return Clamp(coc,0.0f,1.0f) * top;
+	}
+
+	YumeColor PostUber::ApplyDepthOfField(const YumeColor& sharp,const YumeColor& blurred,float coc)
+	{
+		float t = Clamp(coc,0.0f,1.0f);
+		return YumeColor(Lerp(sharp.r_,blurred.r_,t),Lerp(sharp.g_,blurred.g_,t),Lerp(sharp.b_,blurred.b_,t),sharp.a_);
+	}
+
+	YumeColor PostUber::Compose(const YumeColor& tonemapped,const YumeColor& bloom,const Vector2& uv) const
+	{
+		YumeColor color(tonemapped.r_ + bloom.r_ * bloomIntensity_,
+			tonemapped.g_ + bloom.g_ * bloomIntensity_,
+			tonemapped.b_ + bloom.b_ * bloomIntensity_,
+			tonemapped.a_);
+
+		float vignette = GetVignette(uv);
+		color.r_ *= vignette;
+		color.g_ *= vignette;
+		color.b_ *= vignette;
+
+		return Grade(color);
+	}
+
+	float PostUber::GetVignette(const Vector2& uv) const
+	{
+		Vector2 d = uv - Vector2(0.5f,0.5f);
+		return 1.0f - vignetteIntensity_ * powf(Clamp(d.DotProduct(d) * 2.0f,0.0f,1.0f),vignettePower_);
+	}
+
+	YumeColor PostUber::Grade(const YumeColor& color) const
+	{
+		//luminance() in tools.hlsl
+		float luma = color.r_ * 0.3f + color.g_ * 0.59f + color.b_ * 0.11f;
+
+		float rgb[3] = { color.r_,color.g_,color.b_ };
+		const float tint[3] = { tint_.r_,tint_.g_,tint_.b_ };
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			float c = Lerp(luma,rgb[i],saturation_);
+			c = (c - 0.5f) * contrast_ + 0.5f;
+			rgb[i] = Max(c * tint[i],0.0f);
+		}
+
+		return YumeColor(rgb[0],rgb[1],rgb[2],color.a_);
+	}
+}
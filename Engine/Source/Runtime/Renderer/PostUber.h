@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : PostUber.h
+// Date : <Date>
+// Comments : CPU side of ps_post_uber, the same math as PostUber.hlsl
+//
+//----------------------------------------------------------------------------
+#ifndef __PostUber_h__
+#define __PostUber_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector2.h"
+#include "Math/YumeColor.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//DOF_MAX_LEVEL in PostUber.hlsl
+	static const unsigned POST_UBER_DOF_MAX_LEVEL = 5;
+
+	//The depth of field, bloom, vignette and grading of the PostUber pass in Bloom.xml.
+	//The parameters are the ones in UberParameters and start at the values the render call sets.
+	class YumeAPIExport PostUber
+	{
+	public:
+		PostUber();
+
+		//Linear depth that stays sharp and how far from it the blur is full
+		void SetFocus(float plane,float range);
+		void SetCocScale(float scale);
+		void SetBloomIntensity(float intensity);
+		void SetVignette(float intensity,float power);
+		void SetGrading(float saturation,float contrast,const YumeColor& tint);
+
+		//0 in focus, dof_coc_scale at the focal range and past it
+		float GetCircleOfConfusion(float depth) const;
+		//Mip of the scene pyramid the blur reads, levels is the mip count of the pyramid
+		static float GetDofLevel(float coc,unsigned levels);
+		//The frame before the tonemapping, blurred is what the pyramid has at GetDofLevel
+		static YumeColor ApplyDepthOfField(const YumeColor& sharp,const YumeColor& blurred,float coc);
+
+		//Everything after the tonemapping, uv is the texture coordinate of the pixel
+		YumeColor Compose(const YumeColor& tonemapped,const YumeColor& bloom,const Vector2& uv) const;
+		float GetVignette(const Vector2& uv) const;
+		YumeColor Grade(const YumeColor& color) const;
+
+		float GetFocalPlane() const { return focalPlane_; }
+		float GetFocalRange() const { return focalRange_; }
+		float GetCocScale() const { return cocScale_; }
+
+	private:
+		float focalPlane_;
+		float focalRange_;
+		float cocScale_;
+		float bloomIntensity_;
+		float vignetteIntensity_;
+		float vignettePower_;
+		float saturation_;
+		float contrast_;
+		YumeColor tint_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
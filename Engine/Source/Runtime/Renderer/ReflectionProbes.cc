@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : ReflectionProbes.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "ReflectionProbes.h"
+
+#include "Math/YumeMath.h"
+#include "Math/YumeMatrix3x4.h"
+
+namespace YumeEngine
+{
+	ReflectionProbes::ReflectionProbes()
+		: numProbes_(0),
+		facesPerFrame_(1),
+		frame_(0),
+		sceneChanges_(0)
+	{
+	}
+
+	unsigned ReflectionProbes::AddProbe(const Vector3& position,float radius,bool dynamic)
+	{
+		if(numProbes_ >= MAX_REFLECTION_PROBES)
+			return M_MAX_UNSIGNED;
+
+		ReflectionProbe& probe = probes_[numProbes_];
+		probe.Position = position;
+		probe.Radius = radius;
+		probe.Dynamic = dynamic;
+		probe.DirtyFaces = ALL_CUBEMAP_FACES;
+		probe.LastUpdate = frame_;
+		probe.Valid = false;
+		probe.NeedsFilter = false;
+
+		return numProbes_++;
+	}
+
+	void ReflectionProbes::RemoveAll()
+	{
+		numProbes_ = 0;
+		frameFaces_.clear();
+	}
+
+	void ReflectionProbes::SetPosition(unsigned probe,const Vector3& position)
+	{
+		if(probe >= numProbes_)
+			return;
+
+		//What it has is from somewhere else, fill it again at once
+		probes_[probe].Position = position;
+		probes_[probe].DirtyFaces = ALL_CUBEMAP_FACES;
+		probes_[probe].Valid = false;
+		probes_[probe].NeedsFilter = false;
+	}
+
+	void ReflectionProbes::Invalidate(unsigned probe)
+	{
+		if(probe < numProbes_)
+			probes_[probe].DirtyFaces = ALL_CUBEMAP_FACES;
+	}
+
+	void ReflectionProbes::SetFacesPerFrame(unsigned faces)
+	{
+		facesPerFrame_ = Clamp((int)faces,1,(int)(MAX_CUBEMAP_FACES * MAX_REFLECTION_PROBES));
+	}
+
+	void ReflectionProbes::Update(const Vector3& cameraPos,unsigned sceneChanges)
+	{
+		++frame_;
+		frameFaces_.clear();
+
+		bool changed = sceneChanges != sceneChanges_;
+		sceneChanges_ = sceneChanges;
+
+		unsigned pending[MAX_REFLECTION_PROBES];
+		float age[MAX_REFLECTION_PROBES];
+		float distance[MAX_REFLECTION_PROBES];
+
+		for(unsigned i = 0; i < numProbes_; ++i)
+		{
+			ReflectionProbe& probe = probes_[i];
+
+			if(changed || (probe.Dynamic && !probe.DirtyFaces))
+				probe.DirtyFaces = ALL_CUBEMAP_FACES;
+
+			pending[i] = probe.DirtyFaces;
+			age[i] = (float)(frame_ - probe.LastUpdate);
+			distance[i] = (probe.Position - cameraPos).Length();
+
+			if(!probe.Valid)
+			{
+				for(unsigned f = 0; f < MAX_CUBEMAP_FACES; ++f)
+				{
+					if(pending[i] & (1 << f))
+					{
+						ReflectionProbeFace face ={i,(CubeMapFace)f};
+						frameFaces_.push_back(face);
+					}
+				}
+				pending[i] = 0;
+			}
+		}
+
+		for(unsigned n = 0; n < facesPerFrame_; ++n)
+		{
+			unsigned best = M_MAX_UNSIGNED;
+			float bestPriority = -1.0f;
+
+			for(unsigned i = 0; i < numProbes_; ++i)
+			{
+				if(!pending[i])
+					continue;
+
+				float priority = age[i] / (distance[i] + 1.0f);
+				if(priority > bestPriority)
+				{
+					best = i;
+					bestPriority = priority;
+				}
+			}
+
+			if(best == M_MAX_UNSIGNED)
+				break;
+
+			unsigned f = 0;
+			while(!(pending[best] & (1 << f)))
+				++f;
+
+			ReflectionProbeFace face ={best,(CubeMapFace)f};
+			frameFaces_.push_back(face);
+
+			//As if it was just rendered, the next slot goes to whoever waited longer
+			pending[best] &= ~(1 << f);
+			age[best] = 0;
+		}
+	}
+
+	void ReflectionProbes::MarkRendered(unsigned probe,CubeMapFace face)
+	{
+		if(probe >= numProbes_)
+			return;
+
+		ReflectionProbe& p = probes_[probe];
+		unsigned bit = 1 << face;
+		if(!(p.DirtyFaces & bit))
+			return;
+
+		p.DirtyFaces &= ~bit;
+		p.LastUpdate = frame_;
+		if(!p.DirtyFaces)
+			p.NeedsFilter = true;
+	}
+
+	void ReflectionProbes::MarkFiltered(unsigned probe)
+	{
+		if(probe >= numProbes_)
+			return;
+
+		probes_[probe].NeedsFilter = false;
+		if(!probes_[probe].DirtyFaces)
+			probes_[probe].Valid = true;
+	}
+
+	unsigned ReflectionProbes::GetProbeAt(const Vector3& position) const
+	{
+		unsigned closest = M_MAX_UNSIGNED;
+		float closestDistance = M_INFINITY;
+
+		for(unsigned i = 0; i < numProbes_; ++i)
+		{
+			if(!probes_[i].Valid)
+				continue;
+
+			float distance = (probes_[i].Position - position).Length();
+			if(distance <= probes_[i].Radius && distance < closestDistance)
+			{
+				closest = i;
+				closestDistance = distance;
+			}
+		}
+
+		return closest;
+	}
+
+	Quaternion ReflectionProbes::GetFaceRotation(CubeMapFace face)
+	{
+		static const Vector3 directions[MAX_CUBEMAP_FACES] =
+		{
+			Vector3(1,0,0),
+			Vector3(-1,0,0),
+			Vector3(0,1,0),
+			Vector3(0,-1,0),
+			Vector3(0,0,1),
+			Vector3(0,0,-1)
+		};
+		static const Vector3 ups[MAX_CUBEMAP_FACES] =
+		{
+			Vector3(0,1,0),
+			Vector3(0,1,0),
+			Vector3(0,0,-1),
+			Vector3(0,0,1),
+			Vector3(0,1,0),
+			Vector3(0,1,0)
+		};
+
+		Quaternion rotation;
+		rotation.FromLookRotation(directions[face],ups[face]);
+		return rotation;
+	}
+
+	Frustum ReflectionProbes::GetFaceFrustum(unsigned probe,CubeMapFace face,float nearClip,float farClip) const
+	{
+		Frustum frustum;
+		frustum.Define(90.0f,1.0f,1.0f,nearClip,farClip,Matrix3x4(probes_[probe].Position,GetFaceRotation(face),1.0f));
+		return frustum;
+	}
+}
@@ -0,0 +1,110 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : ReflectionProbes.h
+// Date : <Date>
+// Comments : Which faces of which reflection probe to render each frame
+//
+//----------------------------------------------------------------------------
+#ifndef __ReflectionProbes_h__
+#define __ReflectionProbes_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeColor.h"
+#include "Math/YumeQuaternion.h"
+#include "Math/YumeFrustum.h"
+#include "Renderer/YumeRendererDefs.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	static const unsigned MAX_REFLECTION_PROBES = 8;
+	static const unsigned ALL_CUBEMAP_FACES = (1 << MAX_CUBEMAP_FACES) - 1;
+
+	struct ReflectionProbe
+	{
+		Vector3 Position;
+		//Influence radius, a point uses the closest probe it is inside of
+		float Radius;
+		//Dynamic probes start over once their last face is in, static ones wait for the scene to change
+		bool Dynamic;
+		//Bit per CubeMapFace still to render
+		unsigned DirtyFaces;
+		//Frame of the last face rendered
+		unsigned LastUpdate;
+		//All faces were rendered and filtered once, until then the probe is not used
+		bool Valid;
+		//Every face is in since the mips were last built
+		bool NeedsFilter;
+	};
+
+	struct ReflectionProbeFace
+	{
+		unsigned Probe;
+		CubeMapFace Face;
+	};
+
+	//Spreads the cube map updates over frames. Each frame the faces of the probe with the highest
+	//frames since its last face / (distance to the camera + 1) go first, so close probes refresh
+	//more often but a far one is never starved. A probe that was never filled renders all of its faces
+	//at once, half a cube map would show.
+	class YumeAPIExport ReflectionProbes
+	{
+	public:
+		ReflectionProbes();
+
+		//M_MAX_UNSIGNED when MAX_REFLECTION_PROBES are in use
+		unsigned AddProbe(const Vector3& position,float radius,bool dynamic);
+		void RemoveAll();
+		//Renders the probe again
+		void SetPosition(unsigned probe,const Vector3& position);
+		void Invalidate(unsigned probe);
+		//Faces of probes already in use rendered per frame
+		void SetFacesPerFrame(unsigned faces);
+
+		//Picks the faces of this frame
+		void Update(const Vector3& cameraPos,unsigned sceneChanges);
+		void MarkRendered(unsigned probe,CubeMapFace face);
+		//The mips were built from the faces
+		void MarkFiltered(unsigned probe);
+
+		//Closest valid probe position is inside of, M_MAX_UNSIGNED when there is none
+		unsigned GetProbeAt(const Vector3& position) const;
+
+		//Looking down the face with the same up vectors as the cube map cameras
+		static Quaternion GetFaceRotation(CubeMapFace face);
+		Frustum GetFaceFrustum(unsigned probe,CubeMapFace face,float nearClip,float farClip) const;
+
+		unsigned GetNumProbes() const { return numProbes_; }
+		const ReflectionProbe& GetProbe(unsigned probe) const { return probes_[probe]; }
+		unsigned GetFacesPerFrame() const { return facesPerFrame_; }
+		unsigned GetNumFrameFaces() const { return frameFaces_.size(); }
+		const ReflectionProbeFace& GetFrameFace(unsigned index) const { return frameFaces_[index]; }
+
+	private:
+		unsigned numProbes_;
+		unsigned facesPerFrame_;
+		unsigned frame_;
+		unsigned sceneChanges_;
+
+		ReflectionProbe probes_[MAX_REFLECTION_PROBES];
+		YumePodVector<ReflectionProbeFace>::type frameFaces_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
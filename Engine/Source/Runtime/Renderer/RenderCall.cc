@@ -30,9 +30,11 @@ namespace YumeEngine
 
 	RenderCall::RenderCall(CallType type,const YumeString& vs,const YumeString& ps,const YumeString& gs,const YumeString& vsEntry,
 		const YumeString& psEntry,
-		const YumeString& gsEntry):
+		const YumeString& gsEntry,
+		const YumeString& psDefines):
 		enabled_(true),
 		shadowPass_(false),
+		cascadePass_(false),
 		hasVsSampler_(false),
 		hasPsSampler_(false),
 		voxelizePass_(false),
@@ -56,7 +58,8 @@ namespace YumeEngine
 		numOutputs_(0)
 	{
 		vs_ = gYume->pRHI->GetShader(VS,vs,vsEntry,vsEntry);
-		ps_ = gYume->pRHI->GetShader(PS,ps,psEntry,psEntry);
+		//Extra defines pick a variant of the same entry, like the effects the post uber pass runs
+		ps_ = gYume->pRHI->GetShader(PS,ps,psDefines.length() ? psEntry + " " + psDefines : psEntry,psEntry);
 		gs_ = gYume->pRHI->GetShader(GS,gs,gsEntry,gsEntry);
 
 		for(int i=0; i < MAX_TEXTURE_UNITS;++i)
@@ -47,7 +47,8 @@ namespace YumeEngine
 	public:
 		RenderCall(CallType type,const YumeString& vs = "",const YumeString& ps = "",const YumeString& gs = "",const YumeString& vsEntry = "VS",
 			const YumeString& psEntry = "PS",
-			const YumeString& gsEntry = "GS");
+			const YumeString& gsEntry = "GS",
+			const YumeString& psDefines = "");
 		virtual ~RenderCall();
 
 		void SetShaderParameter(YumeHash param,const Variant& value);
@@ -79,10 +80,10 @@ namespace YumeEngine
 		YumeShaderVariation* GetPs() const { return ps_; }
 		YumeShaderVariation* GetGs() const { return gs_; }
 
-		const YumeMap<YumeHash,Variant>::type& GetShaderVariants() { return shaderVariants; }
-		const YumeMap<YumeHash,DirectX::XMFLOAT3>::type& GetShaderVectors3() { return shaderVectors3; }
-		const YumeMap<YumeHash,DirectX::XMFLOAT4>::type& GetShaderVectors4() { return shaderVectors4; }
-		const YumeMap<YumeHash,DirectX::XMMATRIX>::type& GetShaderMatrices() { return shaderMatrices; }
+		const YumeOpenMap<YumeHash,Variant>::type& GetShaderVariants() { return shaderVariants; }
+		const YumeOpenMap<YumeHash,DirectX::XMFLOAT3>::type& GetShaderVectors3() { return shaderVectors3; }
+		const YumeOpenMap<YumeHash,DirectX::XMFLOAT4>::type& GetShaderVectors4() { return shaderVectors4; }
+		const YumeOpenMap<YumeHash,DirectX::XMMATRIX>::type& GetShaderMatrices() { return shaderMatrices; }
 
 		const YumeString& GetPassName() const { return passName; }
 		const YumeString& GetIdentifier() const { return identifier_; }
@@ -107,6 +108,7 @@ namespace YumeEngine
 		bool HasVertexSampler() const { return hasVsSampler_; }
 		bool HasPixelSampler() const { return hasPsSampler_; }
 		bool IsShadowPass() const { return shadowPass_; }
+		bool IsCascadePass() const { return cascadePass_; }
 		bool IsVoxelizePass() const { return voxelizePass_; }
 		bool IsDeferredLightPass() const { return deferredLightPass_; }
 
@@ -114,6 +116,7 @@ namespace YumeEngine
 		unsigned GetClearFlags() const { return clearFlags; }
 
 		void SetShadowPass(bool b) { shadowPass_ = b; }
+		void SetCascadePass(bool b) { cascadePass_ = b; }
 		void SetVoxelizePass(bool b) { voxelizePass_ = b; }
 		void SetDeferredLightPass(bool b) { deferredLightPass_ = b; }
 
@@ -145,6 +148,7 @@ namespace YumeEngine
 	private:
 		bool enabled_;
 		bool shadowPass_;
+		bool cascadePass_;
 		bool voxelizePass_;
 		bool deferredLightPass_;
 		bool postProcessPass_;
@@ -171,10 +175,10 @@ namespace YumeEngine
 		YumeString identifier_;
 
 		CallType type_;
-		YumeMap<YumeHash,Variant>::type shaderVariants;
-		YumeMap<YumeHash,DirectX::XMFLOAT3>::type shaderVectors3;
-		YumeMap<YumeHash,DirectX::XMFLOAT4>::type shaderVectors4;
-		YumeMap<YumeHash,DirectX::XMMATRIX>::type shaderMatrices;
+		YumeOpenMap<YumeHash,Variant>::type shaderVariants;
+		YumeOpenMap<YumeHash,DirectX::XMFLOAT3>::type shaderVectors3;
+		YumeOpenMap<YumeHash,DirectX::XMFLOAT4>::type shaderVectors4;
+		YumeOpenMap<YumeHash,DirectX::XMMATRIX>::type shaderMatrices;
 		unsigned clearFlags;
 		unsigned addFlags_;
 
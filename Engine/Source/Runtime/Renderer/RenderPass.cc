@@ -28,6 +28,7 @@
 #include "Core/YumeXmlFile.h"
 #include "Core/YumeFile.h"
 #include "Core/YumeDefaults.h"
+#include "Core/YumeEnvironment.h"
 
 #include "Logging/logging.h"
 
@@ -122,6 +123,9 @@ namespace YumeEngine
 			unsigned rtCount = 0;
 			unsigned samplerCount = 0;
 
+			//Targets and calls marked HalfRes run at half size with HALF_RES defined, or at full size when FullResScreenEffects is set
+			bool halfRes = !gYume->pEnv->GetVariant("FullResScreenEffects").Get<bool>();
+
 
 			for(XmlNode child = Rts.first_child(); child; child = child.next_sibling())
 			{
@@ -153,12 +157,22 @@ namespace YumeEngine
 
 				if(strlen(size) > 0)
 				{
-					YumeVector<YumeString>::type sizeVector = ParseFlags(size);
+					SmallStringVector::type sizeVector;
+					ParseFlags(size,sizeVector);
 					int ws = atoi(sizeVector[0].c_str());
 					int hs = atoi(sizeVector[1].c_str());
 
 					desc.Width = gYume->pRHI->GetWidth() / ws;
 					desc.Height = gYume->pRHI->GetHeight() / hs;
+					desc.ScreenRelative = true;
+				}
+
+				if(child.attribute("HalfRes").as_bool())
+				{
+					int scale = halfRes ? 2 : 1;
+					desc.Width = gYume->pRHI->GetWidth() / scale;
+					desc.Height = gYume->pRHI->GetHeight() / scale;
+					desc.ScreenRelative = true;
 				}
 
 				desc.ArraySize = atoi(arraySize);
@@ -305,6 +319,9 @@ namespace YumeEngine
 
 				const char* pixelShader = child.attribute("Ps").as_string();
 				const char* pixelEntry = child.attribute("PsEntry").as_string();
+				YumeString pixelDefines = child.attribute("PsDefines").as_string();
+				if(halfRes && child.attribute("HalfRes").as_bool())
+					pixelDefines += pixelDefines.length() ? " HALF_RES" : "HALF_RES";
 
 				const char* geometryShader = child.attribute("Gs").as_string();
 				const char* geometryEntry = child.attribute("GsEntry").as_string();
@@ -315,7 +332,7 @@ namespace YumeEngine
 
 
 
-				RenderCallPtr renderCall = YumeAPINew RenderCall(ct,vertexShader,pixelShader,geometryShader,vertexEntry,pixelEntry,geometryEntry);
+				RenderCallPtr renderCall = YumeAPINew RenderCall(ct,vertexShader,pixelShader,geometryShader,vertexEntry,pixelEntry,geometryEntry,pixelDefines);
 				renderCall->SetIdentifier(identifier);
 				renderCall->SetPassName(passName);
 				renderCall->SetPostProcessPass(isPostProcess);
@@ -345,7 +362,7 @@ namespace YumeEngine
 				for(XmlNode param = Params.first_child(); param; param = param.next_sibling())
 				{
 					const char* name = param.attribute("Name").as_string();
-					YumeString value = param.attribute("Value").as_string();
+					YumeSmallString value = param.attribute("Value").as_string();
 
 					if(value.Contains(' ')) //Its a vector
 					{
@@ -422,7 +439,8 @@ namespace YumeEngine
 
 				const char* flags = child.attribute("Flags").as_string();
 
-				YumeVector<YumeString>::type flagsVector = ParseFlags(flags);
+				SmallStringVector::type flagsVector;
+				ParseFlags(flags,flagsVector);
 
 
 				for(XmlNode output = Outputs.first_child(); output; output = output.next_sibling())
@@ -474,6 +492,9 @@ namespace YumeEngine
 						if(!strcmp(flagsVector[i].c_str(),"SHADOW"))
 							renderCall->SetShadowPass(true);
 
+						if(!strcmp(flagsVector[i].c_str(),"CASCADES"))
+							renderCall->SetCascadePass(true);
+
 						if(!strcmp(flagsVector[i].c_str(),"VOXELIZE"))
 							renderCall->SetVoxelizePass(true);
 
@@ -516,7 +537,7 @@ namespace YumeEngine
 		{
 			if(calls_[i]->ContainsParameter(param))
 			{
-				const YumeMap<YumeHash,Variant>::const_iterator it= calls_[i]->GetShaderVariants().find(param);
+				const YumeOpenMap<YumeHash,Variant>::const_iterator it= calls_[i]->GetShaderVariants().find(param);
 
 				return it->second;
 			}
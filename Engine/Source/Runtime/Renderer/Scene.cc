@@ -29,6 +29,7 @@
 namespace YumeEngine
 {
 	Scene::Scene()
+		: changes_(0)
 	{
 	}
 
@@ -37,7 +38,7 @@ namespace YumeEngine
 		nodes_.clear();
 	}
 
-	SceneNodes::type Scene::GetRenderables()
+	const SceneNodes::type& Scene::GetRenderables()
 	{
 		renderables_.clear();
 
@@ -49,7 +50,7 @@ namespace YumeEngine
 		return renderables_;
 	}
 
-	SceneNodes::type Scene::GetLights()
+	const SceneNodes::type& Scene::GetLights()
 	{
 		lights_.clear();
 
@@ -80,5 +81,29 @@ namespace YumeEngine
 	void Scene::AddNode(SceneNode* node)
 	{
 		nodes_.push_back(node);
+		++changes_;
+	}
+
+	void Scene::RemoveNode(SceneNode* node)
+	{
+		if(!nodes_.Remove(node))
+			return;
+
+		//Keeps the sum growing, the node's own changes leave with it
+		if(node->GetType() == GT_STATIC)
+			changes_ += node->GetChangeCount();
+		++changes_;
+	}
+
+	unsigned Scene::GetChangeCount() const
+	{
+		//Node counters only grow, so the sum changes when any of them does
+		unsigned changes = changes_;
+		for(int i=0; i < nodes_.size(); ++i)
+		{
+			if(nodes_[i]->GetType() == GT_STATIC)
+				changes += nodes_[i]->GetChangeCount();
+		}
+		return changes;
 	}
 }
@@ -36,18 +36,25 @@ namespace YumeEngine
 		virtual ~Scene();
 
 
-		SceneNodes::type GetRenderables();
-		SceneNodes::type GetLights();
+		const SceneNodes::type& GetRenderables();
+		const SceneNodes::type& GetLights();
 
 
 		void AddNode(SceneNode* node);
+		//The node is not deleted, the scene never owns them
+		void RemoveNode(SceneNode* node);
 
 		SceneNode* GetDirectionalLight();
 
+		//Changes whenever a node is added or removed or a renderable moves, lights are not counted
+		unsigned GetChangeCount() const;
+
 	private:
 		SceneNodes::type renderables_;
 		SceneNodes::type lights_;
 		SceneNodes::type nodes_;
+
+		unsigned changes_;
 	};
 }
 
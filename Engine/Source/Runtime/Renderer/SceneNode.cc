@@ -31,7 +31,8 @@ namespace YumeEngine
 		pos_(XMFLOAT4(0,0,0,0)),
 		rot_(XMFLOAT4(0,0,0,0)),
 		dir_(XMFLOAT4(0,0,0,0)),
-		name_("SceneNode")
+		name_("SceneNode"),
+		changes_(0)
 	{
 		XMMATRIX I = XMMatrixIdentity();
 		XMStoreFloat4x4(&World,I);
@@ -64,26 +65,31 @@ namespace YumeEngine
 			DirectX::XMStoreFloat4(&initialPos_,v);
 		}
 		DirectX::XMStoreFloat4(&pos_,v);
+		++changes_;
 	}
 
 	void SceneNode::Translate(const DirectX::XMVECTOR& v)
 	{
 		XMStoreFloat4(&pos_, XMVectorAdd(XMLoadFloat4(&pos_),v));
+		++changes_;
 	}
 
 	void SceneNode::SetRotation(const DirectX::XMVECTOR& v)
 	{
 		DirectX::XMStoreFloat4(&rot_,v);
+		++changes_;
 	}
 
 	void SceneNode::SetDirection(const DirectX::XMVECTOR& v)
 	{
 		DirectX::XMStoreFloat4(&dir_,v);
+		++changes_;
 	}
 
 	void SceneNode::SetWorld(const DirectX::XMMATRIX& world)
 	{
 		DirectX::XMStoreFloat4x4(&World,world);
+		++changes_;
 	}
 
 	void SceneNode::SetScale(float x,float y,float z)
@@ -91,6 +97,7 @@ namespace YumeEngine
 		XMMATRIX scale = DirectX::XMMatrixScaling(x,y,z);
 
 		XMStoreFloat4x4(&Scale,scale);
+		++changes_;
 	}
 
 	void SceneNode::SetBoundingBox(const DirectX::XMFLOAT3& min,const DirectX::XMFLOAT3& max)
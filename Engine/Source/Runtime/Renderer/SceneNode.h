@@ -32,7 +32,7 @@ namespace YumeEngine
 		GT_STATIC,
 		GT_LIGHT
 	};
-	class YumeAPIExport SceneNode : public YumeBase
+	class YumeAPIExport SceneNode : public YumeBase,public SceneObjAlloc
 	{
 	public:
 		SceneNode(GeometryType type);
@@ -64,6 +64,9 @@ namespace YumeEngine
 
 		const DirectX::XMFLOAT3& GetBbMin() const { return bbMin; }
 		const DirectX::XMFLOAT3& GetBbMax() const { return bbMax; }
+
+		//Bumped by every transform change
+		unsigned GetChangeCount() const { return changes_; }
 	protected:
 		GeometryType type_;
 
@@ -79,6 +82,8 @@ namespace YumeEngine
 		DirectX::XMFLOAT4X4 World;
 
 		YumeString name_;
+
+		unsigned changes_;
 	};
 }
 
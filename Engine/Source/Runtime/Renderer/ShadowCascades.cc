@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : ShadowCascades.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "ShadowCascades.h"
+
+#include "Math/YumeMath.h"
+#include "Math/YumeQuaternion.h"
+
+namespace YumeEngine
+{
+	ShadowCascades::ShadowCascades()
+		: numCascades_(MAX_SHADOW_CASCADES),
+		resolution_(1024),
+		lambda_(0.75f),
+		shadowDistance_(0),
+		firstCached_(2),
+		cacheMargin_(0.25f),
+		sceneChanges_(0)
+	{
+		for(unsigned i = 0; i < MAX_SHADOW_CASCADES; ++i)
+		{
+			cascades_[i].Near = 0;
+			cascades_[i].Far = 0;
+			cascades_[i].Center = Vector3::ZERO;
+			cascades_[i].Radius = 0;
+			cascades_[i].View = Matrix3x4::IDENTITY;
+			cascades_[i].Projection = Matrix4::IDENTITY;
+			cascades_[i].ViewProj = Matrix4::IDENTITY;
+			renderedViewProj_[i] = Matrix4::IDENTITY;
+			renderedChanges_[i] = 0;
+			rendered_[i] = false;
+		}
+	}
+
+	void ShadowCascades::SetNumCascades(unsigned count)
+	{
+		numCascades_ = Clamp((int)count,1,(int)MAX_SHADOW_CASCADES);
+	}
+
+	void ShadowCascades::SetResolution(unsigned texels)
+	{
+		resolution_ = Max((int)texels,1);
+		for(unsigned i = 0; i < MAX_SHADOW_CASCADES; ++i)
+			rendered_[i] = false;
+	}
+
+	float ShadowCascades::GetSplitDistance(unsigned index,unsigned count,float nearClip,float farClip,float lambda)
+	{
+		if(!index)
+			return nearClip;
+		if(index >= count)
+			return farClip;
+
+		float t = (float)index / (float)count;
+		float uniform = nearClip + (farClip - nearClip) * t;
+		float logarithmic = nearClip * powf(farClip / nearClip,t);
+		return Lerp(uniform,logarithmic,lambda);
+	}
+
+	void ShadowCascades::Update(const Frustum& viewFrustum,float nearClip,float farClip,const Vector3& lightDir,const BoundingBox& sceneBox,unsigned sceneChanges)
+	{
+		sceneChanges_ = sceneChanges;
+
+		Vector3 dir = lightDir.Normalized();
+		Quaternion rotation;
+		rotation.FromLookRotation(dir,Abs(dir.y_) > 0.99f ? Vector3::FORWARD : Vector3::UP);
+		Matrix3x4 view(Vector3::ZERO,rotation.Inverse(),1.0f);
+
+		BoundingBox sceneLight = sceneBox.Transformed(view);
+
+		float shadowFar = shadowDistance_ > 0 ? Min(shadowDistance_,farClip) : farClip;
+		float depthRange = farClip - nearClip;
+
+		for(unsigned i = 0; i < numCascades_; ++i)
+		{
+			ShadowCascade& cascade = cascades_[i];
+			cascade.Near = GetSplitDistance(i,numCascades_,nearClip,shadowFar,lambda_);
+			cascade.Far = GetSplitDistance(i + 1,numCascades_,nearClip,shadowFar,lambda_);
+
+			//Frustum edges are straight, the slice corners are on them at the split distances
+			Vector3 corners[8];
+			float t0 = (cascade.Near - nearClip) / depthRange;
+			float t1 = (cascade.Far - nearClip) / depthRange;
+			Vector3 center = Vector3::ZERO;
+			for(unsigned k = 0; k < 4; ++k)
+			{
+				corners[k] = viewFrustum.vertices_[k].Lerp(viewFrustum.vertices_[k + 4],t0);
+				corners[k + 4] = viewFrustum.vertices_[k].Lerp(viewFrustum.vertices_[k + 4],t1);
+				center += corners[k] + corners[k + 4];
+			}
+			center /= 8.0f;
+
+			float radius = 0;
+			for(unsigned k = 0; k < 8; ++k)
+				radius = Max(radius,(corners[k] - center).Length());
+			//Rounded up so float noise from camera rotation never changes it
+			radius = ceilf(radius * 16.0f) / 16.0f;
+
+			//Snapping moves the center up to half a step, padding by that keeps the slice inside
+			bool cached = i >= firstCached_;
+			float pad = Max(cached ? radius * cacheMargin_ : 0.0f,2.0f * radius / resolution_);
+			radius += pad;
+			float texel = 2.0f * radius / resolution_;
+			float step = texel * Max(floorf(pad / texel),1.0f);
+
+			Vector3 lightCenter = view * center;
+			lightCenter.x_ = floorf(lightCenter.x_ / step + 0.5f) * step;
+			lightCenter.y_ = floorf(lightCenter.y_ / step + 0.5f) * step;
+			lightCenter.z_ = floorf(lightCenter.z_ / step + 0.5f) * step;
+
+			float zNear = Min(lightCenter.z_ - radius,sceneLight.min_.z_);
+			float zFar = lightCenter.z_ + radius;
+
+			cascade.Center = lightCenter;
+			cascade.Radius = radius;
+			cascade.View = view;
+			cascade.Projection = Matrix4(
+				1.0f / radius,0,0,-lightCenter.x_ / radius,
+				0,1.0f / radius,0,-lightCenter.y_ / radius,
+				0,0,1.0f / (zFar - zNear),-zNear / (zFar - zNear),
+				0,0,0,1.0f);
+			cascade.ViewProj = cascade.Projection * view;
+			cascade.CasterBox = BoundingBox(Vector3(lightCenter.x_ - radius,lightCenter.y_ - radius,zNear),
+				Vector3(lightCenter.x_ + radius,lightCenter.y_ + radius,zFar));
+		}
+	}
+
+	bool ShadowCascades::IsCaster(unsigned cascade,const BoundingBox& worldBox) const
+	{
+		const ShadowCascade& c = cascades_[cascade];
+		return c.CasterBox.IsInside(worldBox.Transformed(c.View)) != OUTSIDE;
+	}
+
+	bool ShadowCascades::NeedsRender(unsigned cascade) const
+	{
+		if(cascade >= numCascades_)
+			return false;
+		if(cascade < firstCached_ || !rendered_[cascade])
+			return true;
+
+		return renderedViewProj_[cascade] != cascades_[cascade].ViewProj || renderedChanges_[cascade] != sceneChanges_;
+	}
+
+	void ShadowCascades::MarkRendered(unsigned cascade)
+	{
+		renderedViewProj_[cascade] = cascades_[cascade].ViewProj;
+		renderedChanges_[cascade] = sceneChanges_;
+		rendered_[cascade] = true;
+	}
+
+	Matrix4 ShadowCascades::GetTextureMatrix(unsigned cascade) const
+	{
+		//Clip space to texture coordinates, y flipped like light_vp_tex
+		Matrix4 tex(
+			0.5f,0,0,0.5f,
+			0,-0.5f,0,0.5f,
+			0,0,1.0f,0,
+			0,0,0,1.0f);
+		return tex * cascades_[cascade].ViewProj;
+	}
+}
@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : ShadowCascades.h
+// Date : <Date>
+// Comments : Cascade splits, stable fitting, caster culling and caching for directional light shadows
+//
+//----------------------------------------------------------------------------
+#ifndef __ShadowCascades_h__
+#define __ShadowCascades_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeMatrix3x4.h"
+#include "Math/YumeMatrix4.h"
+#include "Math/YumeBoundingBox.h"
+#include "Math/YumeFrustum.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	static const unsigned MAX_SHADOW_CASCADES = 4;
+
+	struct ShadowCascade
+	{
+		//View distances the cascade covers
+		float Near;
+		float Far;
+		//Bounding sphere of the slice in light space, the center snapped to whole texels
+		Vector3 Center;
+		float Radius;
+		//World to light space. Only a rotation, so the snapping grid does not move with the camera.
+		Matrix3x4 View;
+		//Orthographic, depth runs from the nearest caster in the scene to the far side of the sphere
+		Matrix4 Projection;
+		Matrix4 ViewProj;
+		//Light space box a caster has to touch to shadow anything in the slice,
+		//the receivers extruded towards the light up to the scene bounds
+		BoundingBox CasterBox;
+	};
+
+	//Splits the view into slices with the practical scheme, a blend of uniform and logarithmic
+	//distances. Every slice gets a bounding sphere instead of a tight box so rotating the camera
+	//does not change the cascade size, and the sphere center moves in whole texels so moving it
+	//does not make the shadow edges crawl.
+	//Cached cascades are padded and snap to a coarser grid, their fit only changes once the camera
+	//moved a fraction of the cascade. Until then, or until the scene changes, they are not rendered again.
+	class YumeAPIExport ShadowCascades
+	{
+	public:
+		ShadowCascades();
+
+		void SetNumCascades(unsigned count);
+		//Texels along one side of a cascade
+		void SetResolution(unsigned texels);
+		//0 splits uniformly, 1 logarithmically
+		void SetSplitLambda(float lambda) { lambda_ = lambda; }
+		//Shadows end here even when the camera sees further, 0 uses the far clip
+		void SetShadowDistance(float distance) { shadowDistance_ = distance; }
+		//Cascades from this one on are cached, MAX_SHADOW_CASCADES caches none
+		void SetFirstCachedCascade(unsigned cascade) { firstCached_ = cascade; }
+		//How far the camera can move before a cached cascade is fitted again, relative to its radius
+		void SetCacheMargin(float margin) { cacheMargin_ = margin; }
+
+		//View distance where slice index starts, 0 is nearClip and count is farClip
+		static float GetSplitDistance(unsigned index,unsigned count,float nearClip,float farClip,float lambda);
+
+		//viewFrustum spans nearClip to farClip of the camera, sceneBox holds everything that can cast
+		void Update(const Frustum& viewFrustum,float nearClip,float farClip,const Vector3& lightDir,const BoundingBox& sceneBox,unsigned sceneChanges);
+
+		//worldBox is in world space
+		bool IsCaster(unsigned cascade,const BoundingBox& worldBox) const;
+		bool NeedsRender(unsigned cascade) const;
+		void MarkRendered(unsigned cascade);
+
+		//World space to the cascade's texture coordinates in xy and its depth in z
+		Matrix4 GetTextureMatrix(unsigned cascade) const;
+
+		unsigned GetNumCascades() const { return numCascades_; }
+		unsigned GetResolution() const { return resolution_; }
+		float GetSplitLambda() const { return lambda_; }
+		float GetShadowDistance() const { return shadowDistance_; }
+		unsigned GetFirstCachedCascade() const { return firstCached_; }
+		float GetCacheMargin() const { return cacheMargin_; }
+		const ShadowCascade& GetCascade(unsigned cascade) const { return cascades_[cascade]; }
+
+	private:
+		unsigned numCascades_;
+		unsigned resolution_;
+		float lambda_;
+		float shadowDistance_;
+		unsigned firstCached_;
+		float cacheMargin_;
+		unsigned sceneChanges_;
+
+		ShadowCascade cascades_[MAX_SHADOW_CASCADES];
+		//What each cascade was last rendered with
+		Matrix4 renderedViewProj_[MAX_SHADOW_CASCADES];
+		unsigned renderedChanges_[MAX_SHADOW_CASCADES];
+		bool rendered_[MAX_SHADOW_CASCADES];
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
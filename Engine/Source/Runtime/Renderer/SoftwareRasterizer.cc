@@ -0,0 +1,935 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : SoftwareRasterizer.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "SoftwareRasterizer.h"
+
+#include "Math/YumeMath.h"
+#include "Core/YumeWorkQueue.h"
+
+#include <cmath>
+#include <thread>
+
+namespace YumeEngine
+{
+	//Below this many tiles with work in them the draw stays on the calling thread
+	static const unsigned MIN_THREADED_TILES = 2;
+	//Work items per thread, neighbouring tiles often differ in cost so the threads pick up the slack
+	static const unsigned TILE_RANGES_PER_THREAD = 4;
+
+	enum SoftwareBlendFactor
+	{
+		FACTOR_ZERO = 0,
+		FACTOR_ONE,
+		FACTOR_SRC_ALPHA,
+		FACTOR_INV_SRC_ALPHA,
+		FACTOR_DEST_COLOR,
+		FACTOR_DEST_ALPHA,
+		FACTOR_INV_DEST_ALPHA
+	};
+
+	enum SoftwareBlendOp
+	{
+		BLENDOP_ADD = 0,
+		BLENDOP_REV_SUBTRACT,
+		BLENDOP_MAX
+	};
+
+	//The same tables the D3D11 backend builds its blend states from, indexed by BlendMode
+	static const SoftwareBlendFactor srcBlend[] =
+	{
+		FACTOR_ONE,
+		FACTOR_ONE,
+		FACTOR_DEST_COLOR,
+		FACTOR_SRC_ALPHA,
+		FACTOR_SRC_ALPHA,
+		FACTOR_ONE,
+		FACTOR_INV_DEST_ALPHA,
+		FACTOR_ONE,
+		FACTOR_SRC_ALPHA,
+		FACTOR_ONE
+	};
+
+	static const SoftwareBlendFactor destBlend[] =
+	{
+		FACTOR_ZERO,
+		FACTOR_ONE,
+		FACTOR_ZERO,
+		FACTOR_INV_SRC_ALPHA,
+		FACTOR_ONE,
+		FACTOR_INV_SRC_ALPHA,
+		FACTOR_DEST_ALPHA,
+		FACTOR_ONE,
+		FACTOR_ONE,
+		FACTOR_ONE
+	};
+
+	static const SoftwareBlendOp blendOp[] =
+	{
+		BLENDOP_ADD,
+		BLENDOP_ADD,
+		BLENDOP_ADD,
+		BLENDOP_ADD,
+		BLENDOP_ADD,
+		BLENDOP_ADD,
+		BLENDOP_ADD,
+		BLENDOP_REV_SUBTRACT,
+		BLENDOP_REV_SUBTRACT,
+		BLENDOP_MAX
+	};
+
+	template <class T> static bool PassesCompare(CompareMode mode,T value,T stored)
+	{
+		switch(mode)
+		{
+		case CMP_EQUAL:
+			return value == stored;
+		case CMP_NOTEQUAL:
+			return value != stored;
+		case CMP_LESS:
+			return value < stored;
+		case CMP_LESSEQUAL:
+			return value <= stored;
+		case CMP_GREATER:
+			return value > stored;
+		case CMP_GREATEREQUAL:
+			return value >= stored;
+		default:
+			return true;
+		}
+	}
+
+	//Increment and decrement saturate like D3D11_STENCIL_OP_INCR_SAT and DECR_SAT
+	static unsigned ApplyStencilOp(StencilOp op,unsigned stencil,unsigned ref)
+	{
+		switch(op)
+		{
+		case OP_ZERO:
+			return 0;
+		case OP_REF:
+			return ref;
+		case OP_INCR:
+			return stencil < 255 ? stencil + 1 : 255;
+		case OP_DECR:
+			return stencil > 0 ? stencil - 1 : 0;
+		default:
+			return stencil;
+		}
+	}
+
+	static void WriteStencil(SoftwareSurface* surface,int x,int y,unsigned stencil,unsigned value,unsigned writeMask)
+	{
+		surface->SetStencil(x,y,((stencil & ~writeMask) | (value & writeMask)) & 0xff);
+	}
+
+	static Vector4 GetBlendFactor(SoftwareBlendFactor factor,const Vector4& src,const Vector4& dest)
+	{
+		switch(factor)
+		{
+		case FACTOR_ONE:
+			return Vector4::ONE;
+		case FACTOR_SRC_ALPHA:
+			return Vector4(src.w_,src.w_,src.w_,src.w_);
+		case FACTOR_INV_SRC_ALPHA:
+			return Vector4::ONE - Vector4(src.w_,src.w_,src.w_,src.w_);
+		case FACTOR_DEST_COLOR:
+			return dest;
+		case FACTOR_DEST_ALPHA:
+			return Vector4(dest.w_,dest.w_,dest.w_,dest.w_);
+		case FACTOR_INV_DEST_ALPHA:
+			return Vector4::ONE - Vector4(dest.w_,dest.w_,dest.w_,dest.w_);
+		default:
+			return Vector4::ZERO;
+		}
+	}
+
+	static Vector4 Saturate(const Vector4& color)
+	{
+		return Vector4(Clamp(color.x_,0.0f,1.0f),Clamp(color.y_,0.0f,1.0f),Clamp(color.z_,0.0f,1.0f),Clamp(color.w_,0.0f,1.0f));
+	}
+
+	//A UNORM target clamps what the shader wrote before blending and the blended result
+	static Vector4 BlendColor(BlendMode mode,Vector4 src,const Vector4& dest,bool normalized)
+	{
+		if(normalized)
+			src = Saturate(src);
+
+		Vector4 result;
+		if(mode == BLEND_REPLACE)
+			result = src;
+		else if(blendOp[mode] == BLENDOP_MAX)
+			result = Vector4(Max(src.x_,dest.x_),Max(src.y_,dest.y_),Max(src.z_,dest.z_),Max(src.w_,dest.w_));
+		else
+		{
+			Vector4 s = src * GetBlendFactor(srcBlend[mode],src,dest);
+			Vector4 d = dest * GetBlendFactor(destBlend[mode],src,dest);
+			result = blendOp[mode] == BLENDOP_REV_SUBTRACT ? d - s : s + d;
+		}
+
+		return normalized ? Saturate(result) : result;
+	}
+
+	static unsigned ReadIndex(const unsigned char* indexData,unsigned indexSize,unsigned index)
+	{
+		if(indexSize == 4)
+			return ((const unsigned*)indexData)[index];
+		return ((const unsigned short*)indexData)[index];
+	}
+
+	static void LerpVertex(const SoftwareVertex& a,const SoftwareVertex& b,float t,unsigned numVaryings,SoftwareVertex& out)
+	{
+		out.Position = a.Position + (b.Position - a.Position) * t;
+		for(unsigned i = 0; i < numVaryings; ++i)
+			out.Varyings[i] = a.Varyings[i] + (b.Varyings[i] - a.Varyings[i]) * t;
+	}
+
+	SoftwareSurface::SoftwareSurface()
+		: width_(0),
+		height_(0),
+		depthStencil_(false),
+		normalized_(false)
+	{
+	}
+
+	void SoftwareSurface::SetSize(int width,int height,bool depthStencil)
+	{
+		width_ = Max(width,0);
+		height_ = Max(height,0);
+		depthStencil_ = depthStencil;
+
+		unsigned numPixels = width_ * height_;
+		color_.clear();
+		depth_.clear();
+		stencil_.clear();
+
+		if(depthStencil_)
+		{
+			depth_.resize(numPixels);
+			stencil_.resize(numPixels);
+			ClearDepthStencil(CLEAR_DEPTH | CLEAR_STENCIL,1.0f,0);
+		}
+		else
+		{
+			color_.resize(numPixels);
+			Clear(Vector4::ZERO);
+		}
+	}
+
+	void SoftwareSurface::Clear(const Vector4& color)
+	{
+		Vector4 value = normalized_ ? Saturate(color) : color;
+		for(unsigned i = 0; i < color_.size(); ++i)
+			color_[i] = value;
+	}
+
+	void SoftwareSurface::ClearDepthStencil(unsigned flags,float depth,unsigned stencil)
+	{
+		if(flags & CLEAR_DEPTH)
+		{
+			for(unsigned i = 0; i < depth_.size(); ++i)
+				depth_[i] = depth;
+		}
+		if(flags & CLEAR_STENCIL)
+		{
+			for(unsigned i = 0; i < stencil_.size(); ++i)
+				stencil_[i] = (unsigned char)stencil;
+		}
+	}
+
+	Vector4 SoftwareSurface::Load(int x,int y) const
+	{
+		if(!width_ || !height_)
+			return Vector4::ZERO;
+
+		unsigned index = Clamp(y,0,height_ - 1) * width_ + Clamp(x,0,width_ - 1);
+		if(depthStencil_)
+			return Vector4(depth_[index],(float)stencil_[index],0.0f,1.0f);
+		return color_[index];
+	}
+
+	Vector4 SoftwareSurface::Sample(const Vector2& uv) const
+	{
+		float x = uv.x_ * width_ - 0.5f;
+		float y = uv.y_ * height_ - 0.5f;
+		int x0 = (int)floorf(x);
+		int y0 = (int)floorf(y);
+		float fx = x - x0;
+		float fy = y - y0;
+
+		Vector4 top = Load(x0,y0).Lerp(Load(x0 + 1,y0),fx);
+		Vector4 bottom = Load(x0,y0 + 1).Lerp(Load(x0 + 1,y0 + 1),fx);
+		return top.Lerp(bottom,fy);
+	}
+
+	unsigned SoftwareSurface::Compare(const SoftwareSurface& other,float tolerance) const
+	{
+		if(width_ != other.width_ || height_ != other.height_ || depthStencil_ != other.depthStencil_)
+			return Max(width_ * height_,other.width_ * other.height_);
+
+		unsigned differing = 0;
+		unsigned numPixels = width_ * height_;
+		for(unsigned i = 0; i < numPixels; ++i)
+		{
+			if(depthStencil_)
+			{
+				if(Abs(depth_[i] - other.depth_[i]) > tolerance || stencil_[i] != other.stencil_[i])
+					++differing;
+				continue;
+			}
+
+			const Vector4& a = color_[i];
+			const Vector4& b = other.color_[i];
+			if(Abs(a.x_ - b.x_) > tolerance || Abs(a.y_ - b.y_) > tolerance || Abs(a.z_ - b.z_) > tolerance || Abs(a.w_ - b.w_) > tolerance)
+				++differing;
+		}
+		return differing;
+	}
+
+	SoftwareRasterizer::SoftwareRasterizer()
+		: numThreads_(1),
+		workQueue_(gYume ? gYume->pWorkSystem.Get() : 0),
+		depthStencil_(0),
+		viewport_(IntRect::ZERO),
+		scissorRect_(IntRect::ZERO),
+		scissorTest_(false),
+		blendMode_(BLEND_REPLACE),
+		colorWrite_(true),
+		cullMode_(CULL_CCW),
+		depthTestMode_(CMP_LESSEQUAL),
+		depthWrite_(true),
+		stencilTest_(false),
+		stencilTestMode_(CMP_ALWAYS),
+		stencilPass_(OP_KEEP),
+		stencilFail_(OP_KEEP),
+		stencilZFail_(OP_KEEP),
+		stencilZFailBack_(OP_KEEP),
+		stencilRef_(0),
+		stencilCompareMask_(M_MAX_UNSIGNED),
+		stencilWriteMask_(M_MAX_UNSIGNED),
+		vertexShader_(0),
+		pixelShader_(0),
+		numVaryings_(0),
+		constants_(0),
+		vertexData_(0),
+		vertexSize_(0),
+		instanceData_(0),
+		instanceSize_(0),
+		indexData_(0),
+		indexSize_(2),
+		targetWidth_(0),
+		targetHeight_(0),
+		tilesX_(0),
+		tilesY_(0),
+		fullscreen_(false),
+		numTriangles_(0),
+		numPixels_(0)
+	{
+		for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+			renderTargets_[i] = 0;
+		for(unsigned i = 0; i < MAX_VERTEX_STREAMS; ++i)
+			SetVertexStream(i,0,0,false);
+	}
+
+	void SoftwareRasterizer::SetNumThreads(unsigned threads)
+	{
+		if(!threads)
+			threads = std::thread::hardware_concurrency();
+		numThreads_ = threads ? threads : 1;
+	}
+
+	void SoftwareRasterizer::SetRenderTarget(unsigned index,SoftwareSurface* surface)
+	{
+		if(index < MAX_RENDERTARGETS)
+			renderTargets_[index] = surface;
+	}
+
+	void SoftwareRasterizer::SetDepthStencil(SoftwareSurface* surface)
+	{
+		depthStencil_ = surface;
+	}
+
+	void SoftwareRasterizer::SetViewport(const IntRect& rect)
+	{
+		viewport_ = rect;
+	}
+
+	void SoftwareRasterizer::SetScissorTest(bool enable,const IntRect& rect)
+	{
+		scissorTest_ = enable;
+		scissorRect_ = rect;
+	}
+
+	void SoftwareRasterizer::SetBlendMode(BlendMode mode)
+	{
+		blendMode_ = mode < MAX_BLENDMODES ? mode : BLEND_REPLACE;
+	}
+
+	void SoftwareRasterizer::SetColorWrite(bool enable)
+	{
+		colorWrite_ = enable;
+	}
+
+	void SoftwareRasterizer::SetCullMode(CullMode mode)
+	{
+		cullMode_ = mode;
+	}
+
+	void SoftwareRasterizer::SetDepthTest(CompareMode mode)
+	{
+		depthTestMode_ = mode;
+	}
+
+	void SoftwareRasterizer::SetDepthWrite(bool enable)
+	{
+		depthWrite_ = enable;
+	}
+
+	void SoftwareRasterizer::SetStencilTest(bool enable,CompareMode mode,StencilOp pass,StencilOp fail,StencilOp zFail,StencilOp zFailBack,unsigned stencilRef,
+		unsigned compareMask,unsigned writeMask)
+	{
+		stencilTest_ = enable;
+		stencilTestMode_ = mode;
+		stencilPass_ = pass;
+		stencilFail_ = fail;
+		stencilZFail_ = zFail;
+		stencilZFailBack_ = zFailBack;
+		stencilRef_ = stencilRef & 0xff;
+		stencilCompareMask_ = compareMask & 0xff;
+		stencilWriteMask_ = writeMask & 0xff;
+	}
+
+	void SoftwareRasterizer::SetShaders(SoftwareVertexShader vertexShader,SoftwarePixelShader pixelShader,unsigned numVaryings)
+	{
+		vertexShader_ = vertexShader;
+		pixelShader_ = pixelShader;
+		numVaryings_ = numVaryings < MAX_SOFTWARE_VARYINGS ? numVaryings : MAX_SOFTWARE_VARYINGS;
+	}
+
+	void SoftwareRasterizer::SetConstants(const void* constants)
+	{
+		constants_ = constants;
+	}
+
+	void SoftwareRasterizer::SetVertexData(const void* data,unsigned vertexSize)
+	{
+		vertexData_ = (const unsigned char*)data;
+		vertexSize_ = vertexSize;
+	}
+
+	void SoftwareRasterizer::SetInstanceData(const void* data,unsigned instanceSize)
+	{
+		instanceData_ = (const unsigned char*)data;
+		instanceSize_ = instanceSize;
+	}
+
+	void SoftwareRasterizer::SetVertexStream(unsigned index,const void* data,unsigned stride,bool perInstance)
+	{
+		if(index >= MAX_VERTEX_STREAMS)
+			return;
+		streamData_[index] = (const unsigned char*)data;
+		streamStrides_[index] = stride;
+		streamPerInstance_[index] = perInstance;
+	}
+
+	void SoftwareRasterizer::SetIndexData(const void* data,unsigned indexSize)
+	{
+		indexData_ = (const unsigned char*)data;
+		indexSize_ = indexSize;
+	}
+
+	void SoftwareRasterizer::ResetStats()
+	{
+		numTriangles_ = 0;
+		numPixels_ = 0;
+	}
+
+	void SoftwareRasterizer::Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount,unsigned instanceCount)
+	{
+		if(!vertexCount || !vertexShader_ || !BeginDraw())
+			return;
+
+		for(unsigned i = 0; i < instanceCount; ++i)
+			DrawPrimitives(type,vertexStart,vertexCount,false,i);
+
+		RasterizeTiles();
+	}
+
+	void SoftwareRasterizer::DrawIndexed(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned instanceCount)
+	{
+		if(!indexCount || !indexData_ || !vertexShader_ || !BeginDraw())
+			return;
+
+		for(unsigned i = 0; i < instanceCount; ++i)
+			DrawPrimitives(type,indexStart,indexCount,true,i);
+
+		RasterizeTiles();
+	}
+
+	void SoftwareRasterizer::DrawFullscreen()
+	{
+		if(!pixelShader_ || !BeginDraw())
+			return;
+
+		fullscreen_ = true;
+		RasterizeTiles();
+		fullscreen_ = false;
+	}
+
+	bool SoftwareRasterizer::BeginDraw()
+	{
+		//Like the RHI the first render target decides the size, the depth stencil when drawing depth only
+		SoftwareSurface* first = renderTargets_[0] ? renderTargets_[0] : depthStencil_;
+		if(!first || !first->GetWidth() || !first->GetHeight())
+			return false;
+
+		targetWidth_ = first->GetWidth();
+		targetHeight_ = first->GetHeight();
+
+		if(viewport_.Width() > 0 && viewport_.Height() > 0)
+		{
+			viewRect_.left_ = Clamp(viewport_.left_,0,targetWidth_);
+			viewRect_.top_ = Clamp(viewport_.top_,0,targetHeight_);
+			viewRect_.right_ = Clamp(viewport_.right_,0,targetWidth_);
+			viewRect_.bottom_ = Clamp(viewport_.bottom_,0,targetHeight_);
+		}
+		else
+			viewRect_ = IntRect(0,0,targetWidth_,targetHeight_);
+
+		clipRect_ = viewRect_;
+		if(scissorTest_)
+		{
+			clipRect_.left_ = Max(clipRect_.left_,scissorRect_.left_);
+			clipRect_.top_ = Max(clipRect_.top_,scissorRect_.top_);
+			clipRect_.right_ = Min(clipRect_.right_,scissorRect_.right_);
+			clipRect_.bottom_ = Min(clipRect_.bottom_,scissorRect_.bottom_);
+		}
+
+		if(clipRect_.Width() <= 0 || clipRect_.Height() <= 0)
+			return false;
+
+		tilesX_ = (targetWidth_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+		tilesY_ = (targetHeight_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+
+		bins_.resize(tilesX_ * tilesY_);
+		for(unsigned i = 0; i < bins_.size(); ++i)
+			bins_[i].clear();
+		triangles_.clear();
+
+		return true;
+	}
+
+	void SoftwareRasterizer::DrawPrimitives(PrimitiveType type,unsigned first,unsigned count,bool indexed,unsigned instance)
+	{
+		//Every vertex the draw uses goes through the callback once, the primitives index into the results
+		unsigned minVertex = first;
+		unsigned maxVertex = first + count - 1;
+		if(indexed)
+		{
+			minVertex = M_MAX_UNSIGNED;
+			maxVertex = 0;
+			for(unsigned i = first; i < first + count; ++i)
+			{
+				unsigned index = ReadIndex(indexData_,indexSize_,i);
+				if(index < minVertex)
+					minVertex = index;
+				if(index > maxVertex)
+					maxVertex = index;
+			}
+		}
+
+		vertices_.resize(maxVertex - minVertex + 1);
+		for(unsigned i = 0; i < vertices_.size(); ++i)
+			TransformVertex(minVertex + i,instance,vertices_[i]);
+
+		YumePodVector<unsigned>::type order;
+		order.resize(count);
+		for(unsigned i = 0; i < count; ++i)
+			order[i] = (indexed ? ReadIndex(indexData_,indexSize_,first + i) : first + i) - minVertex;
+
+		switch(type)
+		{
+		case TRIANGLE_LIST:
+			for(unsigned i = 0; i + 2 < count; i += 3)
+				AddTriangle(vertices_[order[i]],vertices_[order[i + 1]],vertices_[order[i + 2]]);
+			break;
+
+		case TRIANGLE_STRIP:
+			//Every other triangle is flipped back to the winding of the first
+			for(unsigned i = 0; i + 2 < count; ++i)
+			{
+				if(i & 1)
+					AddTriangle(vertices_[order[i + 1]],vertices_[order[i]],vertices_[order[i + 2]]);
+				else
+					AddTriangle(vertices_[order[i]],vertices_[order[i + 1]],vertices_[order[i + 2]]);
+			}
+			break;
+
+		case TRIANGLE_FAN:
+			for(unsigned i = 1; i + 1 < count; ++i)
+				AddTriangle(vertices_[order[0]],vertices_[order[i]],vertices_[order[i + 1]]);
+			break;
+
+		case POINT_LIST:
+			for(unsigned i = 0; i < count; ++i)
+				DrawPoint(vertices_[order[i]]);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void SoftwareRasterizer::TransformVertex(unsigned vertexId,unsigned instance,SoftwareVertex& vertex) const
+	{
+		SoftwareVertexInput input;
+		input.Data = vertexData_ ? vertexData_ + vertexId * vertexSize_ : 0;
+		input.InstanceData = instanceData_ ? instanceData_ + instance * instanceSize_ : 0;
+		input.VertexId = vertexId;
+		input.InstanceId = instance;
+		for(unsigned i = 0; i < MAX_VERTEX_STREAMS; ++i)
+			input.Streams[i] = streamData_[i] ? streamData_[i] + (streamPerInstance_[i] ? instance : vertexId) * streamStrides_[i] : 0;
+
+		vertex.Position = Vector4(0.0f,0.0f,0.0f,1.0f);
+		for(unsigned i = 0; i < numVaryings_; ++i)
+			vertex.Varyings[i] = 0;
+
+		vertexShader_(input,constants_,vertex);
+	}
+
+	void SoftwareRasterizer::AddTriangle(const SoftwareVertex& a,const SoftwareVertex& b,const SoftwareVertex& c)
+	{
+		const SoftwareVertex* in[3] ={&a,&b,&c};
+
+		//Clipped at the near plane, z >= 0, which leaves a triangle or a quad
+		SoftwareVertex out[4];
+		unsigned numOut = 0;
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			const SoftwareVertex& p = *in[i];
+			const SoftwareVertex& q = *in[(i + 1) % 3];
+
+			if(p.Position.z_ >= 0)
+				out[numOut++] = p;
+			if((p.Position.z_ >= 0) != (q.Position.z_ >= 0))
+				LerpVertex(p,q,p.Position.z_ / (p.Position.z_ - q.Position.z_),numVaryings_,out[numOut++]);
+		}
+
+		if(numOut >= 3)
+			SetupTriangle(out[0],out[1],out[2]);
+		if(numOut == 4)
+			SetupTriangle(out[0],out[2],out[3]);
+	}
+
+	void SoftwareRasterizer::SetupTriangle(const SoftwareVertex& a,const SoftwareVertex& b,const SoftwareVertex& c)
+	{
+		const SoftwareVertex* v[3] ={&a,&b,&c};
+
+		SoftwareTriangle triangle;
+		float x[3];
+		float y[3];
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			const Vector4& position = v[i]->Position;
+			if(position.w_ <= M_EPSILON)
+				return;
+
+			float invW = 1.0f / position.w_;
+			x[i] = (position.x_ * invW * 0.5f + 0.5f) * viewRect_.Width() + viewRect_.left_;
+			y[i] = (0.5f - position.y_ * invW * 0.5f) * viewRect_.Height() + viewRect_.top_;
+			triangle.Z[i] = position.z_ * invW;
+			triangle.InvW[i] = invW;
+
+			for(unsigned j = 0; j < numVaryings_; ++j)
+				triangle.Varyings[i][j] = v[i]->Varyings[j] * invW;
+		}
+
+		//Positive when clockwise on the screen, y goes down
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if(area == 0)
+			return;
+
+		triangle.FrontFace = area > 0;
+		if((cullMode_ == CULL_CCW && !triangle.FrontFace) || (cullMode_ == CULL_CW && triangle.FrontFace))
+			return;
+
+		float sign = triangle.FrontFace ? 1.0f : -1.0f;
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			unsigned j = (i + 1) % 3;
+			unsigned k = (i + 2) % 3;
+			triangle.EdgeA[i] = (y[j] - y[k]) * sign;
+			triangle.EdgeB[i] = (x[k] - x[j]) * sign;
+			triangle.EdgeC[i] = (x[j] * y[k] - x[k] * y[j]) * sign;
+			//Inside is to the right of a left edge and below a top one
+			triangle.EdgeOwned[i] = triangle.EdgeA[i] > 0 || (triangle.EdgeA[i] == 0 && triangle.EdgeB[i] > 0);
+		}
+		triangle.InvArea = 1.0f / (area * sign);
+
+		//Clamped as floats first, far outside the screen would not fit an int
+		float minX = Clamp(Min(Min(x[0],x[1]),x[2]),(float)clipRect_.left_,(float)clipRect_.right_);
+		float maxX = Clamp(Max(Max(x[0],x[1]),x[2]),(float)clipRect_.left_,(float)clipRect_.right_);
+		float minY = Clamp(Min(Min(y[0],y[1]),y[2]),(float)clipRect_.top_,(float)clipRect_.bottom_);
+		float maxY = Clamp(Max(Max(y[0],y[1]),y[2]),(float)clipRect_.top_,(float)clipRect_.bottom_);
+
+		triangle.MinX = (int)floorf(minX);
+		triangle.MaxX = Min((int)ceilf(maxX),clipRect_.right_ - 1);
+		triangle.MinY = (int)floorf(minY);
+		triangle.MaxY = Min((int)ceilf(maxY),clipRect_.bottom_ - 1);
+		if(triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+			return;
+
+		unsigned index = triangles_.size();
+		triangles_.push_back(triangle);
+		++numTriangles_;
+
+		for(int ty = triangle.MinY / SOFTWARE_TILE_SIZE; ty <= triangle.MaxY / SOFTWARE_TILE_SIZE; ++ty)
+		{
+			for(int tx = triangle.MinX / SOFTWARE_TILE_SIZE; tx <= triangle.MaxX / SOFTWARE_TILE_SIZE; ++tx)
+				bins_[ty * tilesX_ + tx].push_back(index);
+		}
+	}
+
+	void SoftwareRasterizer::DrawPoint(const SoftwareVertex& vertex)
+	{
+		const Vector4& position = vertex.Position;
+		if(position.w_ <= M_EPSILON || position.z_ < 0 || position.z_ > position.w_)
+			return;
+
+		float invW = 1.0f / position.w_;
+		float x = (position.x_ * invW * 0.5f + 0.5f) * viewRect_.Width() + viewRect_.left_;
+		float y = (0.5f - position.y_ * invW * 0.5f) * viewRect_.Height() + viewRect_.top_;
+		if(x < clipRect_.left_ || x >= clipRect_.right_ || y < clipRect_.top_ || y >= clipRect_.bottom_)
+			return;
+
+		SoftwarePixel pixel;
+		pixel.X = (int)x;
+		pixel.Y = (int)y;
+		pixel.Depth = position.z_ * invW;
+		pixel.FrontFace = true;
+		for(unsigned i = 0; i < numVaryings_; ++i)
+			pixel.Varyings[i] = vertex.Varyings[i];
+
+		//Points are drawn in order on the calling thread, they are what scatters into histograms
+		if(ShadePixel(pixel,true))
+			++numPixels_;
+	}
+
+	void SoftwareRasterizer::RasterizeTiles()
+	{
+		activeTiles_.clear();
+		for(int ty = 0; ty < tilesY_; ++ty)
+		{
+			for(int tx = 0; tx < tilesX_; ++tx)
+			{
+				unsigned tile = ty * tilesX_ + tx;
+				if(fullscreen_)
+				{
+					int left = tx * SOFTWARE_TILE_SIZE;
+					int top = ty * SOFTWARE_TILE_SIZE;
+					if(left + SOFTWARE_TILE_SIZE > clipRect_.left_ && left < clipRect_.right_ && top + SOFTWARE_TILE_SIZE > clipRect_.top_ && top < clipRect_.bottom_)
+						activeTiles_.push_back(tile);
+				}
+				else if(bins_[tile].size())
+					activeTiles_.push_back(tile);
+			}
+		}
+
+		if(activeTiles_.empty())
+			return;
+
+		tilePixels_.resize(activeTiles_.size());
+
+		//Every tile belongs to one work item, nothing is written by two of them
+		unsigned numTiles = activeTiles_.size();
+		unsigned numRanges = Min((int)(numThreads_ * TILE_RANGES_PER_THREAD),(int)numTiles);
+		if(workQueue_ && numThreads_ > 1 && numTiles >= MIN_THREADED_TILES)
+		{
+			for(unsigned r = 0; r < numRanges; ++r)
+			{
+				SharedPtr<WorkItem> item = workQueue_->GetFreeItem();
+				item->priority_ = M_MAX_UNSIGNED;
+				item->workFunction_ = RasterizeTilesWork;
+				item->aux_ = this;
+				item->start_ = &activeTiles_[0] + numTiles * r / numRanges;
+				item->end_ = &activeTiles_[0] + numTiles * (r + 1) / numRanges;
+				workQueue_->AddWorkItem(item);
+			}
+			workQueue_->Complete(M_MAX_UNSIGNED);
+		}
+		else
+			RasterizeTileRange(0,numTiles);
+
+		for(unsigned i = 0; i < tilePixels_.size(); ++i)
+			numPixels_ += tilePixels_[i];
+	}
+
+	void SoftwareRasterizer::RasterizeTileRange(unsigned first,unsigned last)
+	{
+		for(unsigned i = first; i < last; ++i)
+			tilePixels_[i] = RasterizeTile(activeTiles_[i]);
+	}
+
+	void SoftwareRasterizer::RasterizeTilesWork(const WorkItem* item,unsigned threadIndex)
+	{
+		SoftwareRasterizer* rasterizer = reinterpret_cast<SoftwareRasterizer*>(item->aux_);
+		const unsigned* tiles = &rasterizer->activeTiles_[0];
+		unsigned first = reinterpret_cast<const unsigned*>(item->start_) - tiles;
+		unsigned last = reinterpret_cast<const unsigned*>(item->end_) - tiles;
+		rasterizer->RasterizeTileRange(first,last);
+	}
+
+	unsigned SoftwareRasterizer::RasterizeTile(unsigned tile)
+	{
+		int tileLeft = (tile % tilesX_) * SOFTWARE_TILE_SIZE;
+		int tileTop = (tile / tilesX_) * SOFTWARE_TILE_SIZE;
+		int left = Max(tileLeft,clipRect_.left_);
+		int top = Max(tileTop,clipRect_.top_);
+		int right = Min(tileLeft + SOFTWARE_TILE_SIZE,clipRect_.right_) - 1;
+		int bottom = Min(tileTop + SOFTWARE_TILE_SIZE,clipRect_.bottom_) - 1;
+
+		unsigned written = 0;
+		SoftwarePixel pixel;
+
+		if(fullscreen_)
+		{
+			pixel.Depth = 0;
+			pixel.FrontFace = true;
+			for(int y = top; y <= bottom; ++y)
+			{
+				for(int x = left; x <= right; ++x)
+				{
+					pixel.X = x;
+					pixel.Y = y;
+					pixel.Varyings[0] = (x + 0.5f - viewRect_.left_) / viewRect_.Width();
+					pixel.Varyings[1] = (y + 0.5f - viewRect_.top_) / viewRect_.Height();
+					if(ShadePixel(pixel,false))
+						++written;
+				}
+			}
+			return written;
+		}
+
+		const YumePodVector<unsigned>::type& bin = bins_[tile];
+		for(unsigned i = 0; i < bin.size(); ++i)
+		{
+			const SoftwareTriangle& triangle = triangles_[bin[i]];
+			pixel.FrontFace = triangle.FrontFace;
+
+			int minX = Max(triangle.MinX,left);
+			int maxX = Min(triangle.MaxX,right);
+			int minY = Max(triangle.MinY,top);
+			int maxY = Min(triangle.MaxY,bottom);
+
+			for(int y = minY; y <= maxY; ++y)
+			{
+				float py = y + 0.5f;
+				for(int x = minX; x <= maxX; ++x)
+				{
+					float px = x + 0.5f;
+
+					float e[3];
+					bool inside = true;
+					for(unsigned k = 0; k < 3 && inside; ++k)
+					{
+						e[k] = triangle.EdgeA[k] * px + triangle.EdgeB[k] * py + triangle.EdgeC[k];
+						inside = e[k] > 0 || (e[k] == 0 && triangle.EdgeOwned[k]);
+					}
+					if(!inside)
+						continue;
+
+					float b0 = e[0] * triangle.InvArea;
+					float b1 = e[1] * triangle.InvArea;
+					float b2 = e[2] * triangle.InvArea;
+
+					//z / w is linear on the screen, the varyings are not
+					pixel.Depth = b0 * triangle.Z[0] + b1 * triangle.Z[1] + b2 * triangle.Z[2];
+					if(pixel.Depth < 0 || pixel.Depth > 1)
+						continue;
+
+					float w = 1.0f / (b0 * triangle.InvW[0] + b1 * triangle.InvW[1] + b2 * triangle.InvW[2]);
+					for(unsigned j = 0; j < numVaryings_; ++j)
+						pixel.Varyings[j] = (b0 * triangle.Varyings[0][j] + b1 * triangle.Varyings[1][j] + b2 * triangle.Varyings[2][j]) * w;
+
+					pixel.X = x;
+					pixel.Y = y;
+					if(ShadePixel(pixel,true))
+						++written;
+				}
+			}
+		}
+
+		return written;
+	}
+
+	bool SoftwareRasterizer::ShadePixel(SoftwarePixel& pixel,bool depthStencilTest)
+	{
+		int x = pixel.X;
+		int y = pixel.Y;
+
+		SoftwareSurface* depthStencil = depthStencilTest ? depthStencil_ : 0;
+		if(depthStencil && (!depthStencil->IsDepthStencil() || x >= depthStencil->GetWidth() || y >= depthStencil->GetHeight()))
+			depthStencil = 0;
+
+		unsigned stencil = 0;
+		if(depthStencil && stencilTest_)
+		{
+			stencil = depthStencil->GetStencil(x,y);
+			if(!PassesCompare(stencilTestMode_,stencilRef_ & stencilCompareMask_,stencil & stencilCompareMask_))
+			{
+				WriteStencil(depthStencil,x,y,stencil,ApplyStencilOp(stencilFail_,stencil,stencilRef_),stencilWriteMask_);
+				return false;
+			}
+		}
+
+		if(depthStencil && !PassesCompare(depthTestMode_,pixel.Depth,depthStencil->GetDepth(x,y)))
+		{
+			if(stencilTest_)
+				WriteStencil(depthStencil,x,y,stencil,ApplyStencilOp(pixel.FrontFace ? stencilZFail_ : stencilZFailBack_,stencil,stencilRef_),stencilWriteMask_);
+			return false;
+		}
+
+		Vector4 colors[MAX_RENDERTARGETS];
+		if(pixelShader_ && !pixelShader_(pixel,constants_,colors))
+			return false;
+
+		if(depthStencil)
+		{
+			if(stencilTest_)
+				WriteStencil(depthStencil,x,y,stencil,ApplyStencilOp(stencilPass_,stencil,stencilRef_),stencilWriteMask_);
+			if(depthWrite_)
+				depthStencil->SetDepth(x,y,pixel.Depth);
+		}
+
+		if(pixelShader_ && colorWrite_)
+		{
+			for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+			{
+				SoftwareSurface* target = renderTargets_[i];
+				if(!target || target->IsDepthStencil() || x >= target->GetWidth() || y >= target->GetHeight())
+					continue;
+
+				target->SetPixel(x,y,BlendColor(blendMode_,colors[i],target->GetPixel(x,y),target->IsNormalized()));
+			}
+		}
+
+		return true;
+	}
+}
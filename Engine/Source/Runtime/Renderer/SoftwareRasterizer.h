@@ -0,0 +1,283 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : SoftwareRasterizer.h
+// Date : <Date>
+// Comments : CPU rasterizer behind the Software backend
+//
+//----------------------------------------------------------------------------
+#ifndef __SoftwareRasterizer_h__
+#define __SoftwareRasterizer_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeRect.h"
+#include "Math/YumeVector2.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeVector4.h"
+#include "Math/YumeColor.h"
+#include "Renderer/YumeRendererDefs.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class YumeWorkQueue;
+	struct WorkItem;
+
+	//Pixels on a side of the screen tiles the threads share out
+	static const int SOFTWARE_TILE_SIZE = 32;
+	//Floats a vertex callback can hand to the pixels
+	static const unsigned MAX_SOFTWARE_VARYINGS = 16;
+
+	//What the vertex callback reads. Data is null for draws without a vertex buffer, VertexId is what
+	//SV_VertexID would be then. Streams holds the element of every bound vertex stream, null where
+	//nothing is bound, for geometry split over several buffers.
+	struct SoftwareVertexInput
+	{
+		const unsigned char* Data;
+		const unsigned char* InstanceData;
+		const unsigned char* Streams[MAX_VERTEX_STREAMS];
+		unsigned VertexId;
+		unsigned InstanceId;
+	};
+
+	//What the vertex callback writes, the clip space position and the values interpolated over the primitive
+	struct SoftwareVertex
+	{
+		Vector4 Position;
+		float Varyings[MAX_SOFTWARE_VARYINGS];
+	};
+
+	//What the pixel callback reads. Depth is z / w, 0 near and 1 far. The varyings are perspective correct,
+	//for DrawFullscreen the first two are the texture coordinate.
+	struct SoftwarePixel
+	{
+		int X;
+		int Y;
+		float Depth;
+		bool FrontFace;
+		float Varyings[MAX_SOFTWARE_VARYINGS];
+	};
+
+	typedef void(*SoftwareVertexShader)(const SoftwareVertexInput& input,const void* constants,SoftwareVertex& output);
+	//Writes one color per render target, false discards the pixel
+	typedef bool(*SoftwarePixelShader)(const SoftwarePixel& pixel,const void* constants,Vector4* colors);
+
+	//Render target or depth stencil of the rasterizer, also what the callbacks sample textures from.
+	//Color is float RGBA whatever the format it stands for, depth stencil is a float depth and an 8 bit stencil.
+	class YumeAPIExport SoftwareSurface
+	{
+	public:
+		SoftwareSurface();
+
+		void SetSize(int width,int height,bool depthStencil = false);
+		//Colors written are clamped to 0-1 like a UNORM target
+		void SetNormalized(bool enable) { normalized_ = enable; }
+
+		void Clear(const Vector4& color);
+		//CLEAR_DEPTH and CLEAR_STENCIL
+		void ClearDepthStencil(unsigned flags,float depth,unsigned stencil);
+
+		int GetWidth() const { return width_; }
+		int GetHeight() const { return height_; }
+		bool IsDepthStencil() const { return depthStencil_; }
+		bool IsNormalized() const { return normalized_; }
+
+		const Vector4& GetPixel(int x,int y) const { return color_[y * width_ + x]; }
+		void SetPixel(int x,int y,const Vector4& color) { color_[y * width_ + x] = color; }
+		float GetDepth(int x,int y) const { return depth_[y * width_ + x]; }
+		unsigned GetStencil(int x,int y) const { return stencil_[y * width_ + x]; }
+		void SetDepth(int x,int y,float depth) { depth_[y * width_ + x] = depth; }
+		void SetStencil(int x,int y,unsigned stencil) { stencil_[y * width_ + x] = (unsigned char)stencil; }
+
+		//Clamped to the edges. A depth stencil reads as (depth,stencil,0,1).
+		Vector4 Load(int x,int y) const;
+		//Bilinear and clamped to the edges, texel centers at half coordinates like D3D
+		Vector4 Sample(const Vector2& uv) const;
+
+		//Pixels with a channel further apart than tolerance, all of them when the sizes differ.
+		//What image regression tests check a frame against its reference with.
+		unsigned Compare(const SoftwareSurface& other,float tolerance) const;
+
+	private:
+		int width_;
+		int height_;
+		bool depthStencil_;
+		bool normalized_;
+
+		YumePodVector<Vector4>::type color_;
+		YumePodVector<float>::type depth_;
+		YumePodVector<unsigned char>::type stencil_;
+	};
+
+	//Screen space triangle with its edge functions and what is interpolated over it
+	struct SoftwareTriangle
+	{
+		//Edge i is opposite vertex i, a * x + b * y + c is positive inside
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		//The edge owns the pixels exactly on it, the top left rule
+		bool EdgeOwned[3];
+		float InvArea;
+		float Z[3];
+		float InvW[3];
+		//Divided by w
+		float Varyings[3][MAX_SOFTWARE_VARYINGS];
+		//Pixel rectangle, inclusive
+		int MinX;
+		int MaxX;
+		int MinY;
+		int MaxY;
+		bool FrontFace;
+	};
+
+	//Immediate mode rasterizer with the fixed function state of the RHI and C++ callbacks for the shaders:
+	//	Draw           - vertices go through the vertex callback, triangles are clipped at the near plane, set
+	//	                 up in screen space and binned to SOFTWARE_TILE_SIZE tiles
+	//	               - tiles are shared out over the work queue, each walks its triangles in submission order,
+	//	                 so the result is the same for any number of threads
+	//	per pixel      - scissor, stencil, depth, pixel callback, then blending into every bound target
+	//	DrawFullscreen - the pixel callback over the viewport, no vertices, no depth or stencil
+	//Triangle lists and strips and point lists are drawn, lines are not. Depth bias and fill modes are ignored.
+	//Clip space is D3D's, depth 0 to 1 and y up. Clockwise triangles on the screen are front facing.
+	class YumeAPIExport SoftwareRasterizer
+	{
+	public:
+		SoftwareRasterizer();
+
+		//Ranges the tiles of a draw are split into, 0 uses every hardware thread
+		void SetNumThreads(unsigned threads);
+		//Runs the tile ranges, the engine's by default. Null draws on the calling thread.
+		void SetWorkQueue(YumeWorkQueue* queue) { workQueue_ = queue; }
+
+		void SetRenderTarget(unsigned index,SoftwareSurface* surface);
+		void SetDepthStencil(SoftwareSurface* surface);
+		//Clamped to the targets when drawing, an empty one is the whole target
+		void SetViewport(const IntRect& rect);
+		void SetScissorTest(bool enable,const IntRect& rect = IntRect::ZERO);
+
+		void SetBlendMode(BlendMode mode);
+		void SetColorWrite(bool enable);
+		void SetCullMode(CullMode mode);
+		void SetDepthTest(CompareMode mode);
+		void SetDepthWrite(bool enable);
+		//zFailBack is for the back faces, the rest is shared like the RHI
+		void SetStencilTest(bool enable,CompareMode mode = CMP_ALWAYS,StencilOp pass = OP_KEEP,StencilOp fail = OP_KEEP,StencilOp zFail = OP_KEEP,StencilOp zFailBack = OP_KEEP,unsigned stencilRef = 0,unsigned compareMask = M_MAX_UNSIGNED,unsigned writeMask = M_MAX_UNSIGNED);
+
+		//The first numVaryings of SoftwareVertex::Varyings are interpolated. A null pixel callback draws depth and stencil only.
+		void SetShaders(SoftwareVertexShader vertexShader,SoftwarePixelShader pixelShader,unsigned numVaryings);
+		//Handed to both callbacks untouched
+		void SetConstants(const void* constants);
+
+		//Not copied, they must live until the draw returns. Null vertex data draws vertex ids only.
+		void SetVertexData(const void* data,unsigned vertexSize);
+		void SetInstanceData(const void* data,unsigned instanceSize);
+		//Per instance streams step once per instance, the others once per vertex
+		void SetVertexStream(unsigned index,const void* data,unsigned stride,bool perInstance);
+		//indexSize is 2 or 4
+		void SetIndexData(const void* data,unsigned indexSize);
+
+		void Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount,unsigned instanceCount = 1);
+		void DrawIndexed(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned instanceCount = 1);
+		void DrawFullscreen();
+
+		unsigned GetNumThreads() const { return numThreads_; }
+		YumeWorkQueue* GetWorkQueue() const { return workQueue_; }
+		SoftwareSurface* GetRenderTarget(unsigned index) const { return renderTargets_[index]; }
+		SoftwareSurface* GetDepthStencil() const { return depthStencil_; }
+		const IntRect& GetViewport() const { return viewport_; }
+		BlendMode GetBlendMode() const { return blendMode_; }
+		//Since the last ResetStats, after clipping and culling
+		unsigned GetNumTriangles() const { return numTriangles_; }
+		//Since the last ResetStats, that passed every test
+		unsigned GetNumPixels() const { return numPixels_; }
+		void ResetStats();
+
+	private:
+		bool BeginDraw();
+		void DrawPrimitives(PrimitiveType type,unsigned first,unsigned count,bool indexed,unsigned instance);
+		void TransformVertex(unsigned vertexId,unsigned instance,SoftwareVertex& vertex) const;
+		void AddTriangle(const SoftwareVertex& a,const SoftwareVertex& b,const SoftwareVertex& c);
+		void SetupTriangle(const SoftwareVertex& a,const SoftwareVertex& b,const SoftwareVertex& c);
+		void DrawPoint(const SoftwareVertex& vertex);
+		void RasterizeTiles();
+		void RasterizeTileRange(unsigned first,unsigned last);
+		static void RasterizeTilesWork(const WorkItem* item,unsigned threadIndex);
+		unsigned RasterizeTile(unsigned tile);
+		bool ShadePixel(SoftwarePixel& pixel,bool depthStencilTest);
+
+		unsigned numThreads_;
+		YumeWorkQueue* workQueue_;
+
+		SoftwareSurface* renderTargets_[MAX_RENDERTARGETS];
+		SoftwareSurface* depthStencil_;
+		IntRect viewport_;
+		IntRect scissorRect_;
+		bool scissorTest_;
+
+		BlendMode blendMode_;
+		bool colorWrite_;
+		CullMode cullMode_;
+		CompareMode depthTestMode_;
+		bool depthWrite_;
+		bool stencilTest_;
+		CompareMode stencilTestMode_;
+		StencilOp stencilPass_;
+		StencilOp stencilFail_;
+		StencilOp stencilZFail_;
+		StencilOp stencilZFailBack_;
+		unsigned stencilRef_;
+		unsigned stencilCompareMask_;
+		unsigned stencilWriteMask_;
+
+		SoftwareVertexShader vertexShader_;
+		SoftwarePixelShader pixelShader_;
+		unsigned numVaryings_;
+		const void* constants_;
+
+		const unsigned char* vertexData_;
+		unsigned vertexSize_;
+		const unsigned char* instanceData_;
+		unsigned instanceSize_;
+		const unsigned char* streamData_[MAX_VERTEX_STREAMS];
+		unsigned streamStrides_[MAX_VERTEX_STREAMS];
+		bool streamPerInstance_[MAX_VERTEX_STREAMS];
+		const unsigned char* indexData_;
+		unsigned indexSize_;
+
+		//Set up by BeginDraw for the draw in flight
+		int targetWidth_;
+		int targetHeight_;
+		IntRect viewRect_;
+		IntRect clipRect_;
+		int tilesX_;
+		int tilesY_;
+		bool fullscreen_;
+
+		YumePodVector<SoftwareVertex>::type vertices_;
+		YumePodVector<SoftwareTriangle>::type triangles_;
+		YumeVector<YumePodVector<unsigned>::type>::type bins_;
+		YumePodVector<unsigned>::type activeTiles_;
+		//Pixels written per active tile, each thread counts its own
+		YumePodVector<unsigned>::type tilePixels_;
+
+		unsigned numTriangles_;
+		unsigned numPixels_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
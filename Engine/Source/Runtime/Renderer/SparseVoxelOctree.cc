@@ -28,11 +28,18 @@
 #include "RenderCall.h"
 #include "Light.h"
 #include "Scene.h"
+#include "StaticModel.h"
+#include "Core/YumeProfiler.h"
+#include "Logging/logging.h"
 namespace YumeEngine
 {
 	SparseVoxelOctree::SparseVoxelOctree()
-		:last_bound_(0)
+		:last_bound_(0),
+		buildOctree_(false),
+		octreeDirty_(false),
+		fragmentChanges_(M_MAX_UNSIGNED)
 	{
+		DirectX::XMStoreFloat4x4(&fragmentsToSvo_,DirectX::XMMatrixIdentity());
 	}
 
 	SparseVoxelOctree::~SparseVoxelOctree()
@@ -54,12 +61,30 @@ namespace YumeEngine
 
 	void SparseVoxelOctree::Filter()
 	{
+		YUME_PROFILE("SparseVoxelOctree::Filter");
 		gYume->pRHI->GenerateMips(vNormal);
 		gYume->pRHI->GenerateMips(vRho);
+
+		if(buildOctree_ && octreeDirty_)
+		{
+			YUME_PROFILE("SparseVoxelOctree::BuildOctree");
+
+			unsigned levels = 0;
+			while((1 << (levels + 1)) <= volume_size_)
+				++levels;
+
+			octree_.Build(fragments_,levels);
+			octree_.FilterBricks();
+			octreeDirty_ = false;
+
+			YUMELOG_DEBUG("Sparse voxel octree: " << fragments_.size() << " fragments, " << octree_.GetNumNodes() << " nodes, " <<
+				octree_.GetMemoryUse() / 1024 << " KB against " << octree_.GetDenseMemoryUse() / 1024 << " KB dense");
+		}
 	}
 
 	void SparseVoxelOctree::Inject()
 	{
+		YUME_PROFILE("SparseVoxelOctree::Inject");
 		RHIEvent e("SvoInject");
 
 		TexturePtr uavs[] ={vRho};
@@ -76,7 +101,7 @@ namespace YumeEngine
 		TexturePtr rsmColors = d->GetTextureByName("RSM_COLORS");
 		TexturePtr rsmNormals = d->GetTextureByName("RSM_NORMALS");
 
-		YumeVector<TexturePtr>::type allTextures = gYume->pRenderer->GetFreeTextures();
+		YumeVector<TexturePtr>::type& allTextures = gYume->pRenderer->GetFreeTextures();
 		allTextures[6] = rsmDepth;
 		allTextures[7] = rsmColors;
 		allTextures[8] = rsmNormals;
@@ -126,6 +151,7 @@ namespace YumeEngine
 
 	void SparseVoxelOctree::Voxelize(RenderCall* call,YumeGeometry* geo,bool clear)
 	{
+		YUME_PROFILE("SparseVoxelOctree::Voxelize");
 		ClearPs();
 
 		YumeRHI* r = gYume->pRHI;
@@ -166,6 +192,85 @@ namespace YumeEngine
 		TexturePtr clearUavs[2] ={0,0};
 		r->SetRenderTargetsAndUAVs(0,1,2,clearUavs);
 
+		//The CPU side walks the whole scene each time, it only has to when something moved
+		unsigned changes = gYume->pRenderer->GetScene()->GetChangeCount();
+		if(buildOctree_ && (changes != fragmentChanges_ || memcmp(&fragmentsToSvo_,&worldToSvo_,sizeof worldToSvo_)))
+		{
+			fragments_.clear();
+			GatherFragments();
+			octreeDirty_ = true;
+			fragmentChanges_ = changes;
+			fragmentsToSvo_ = worldToSvo_;
+		}
+	}
+
+	void SparseVoxelOctree::GatherFragments()
+	{
+		YUME_PROFILE("SparseVoxelOctree::GatherFragments");
+
+		//Same transform as vs_svo_voxelize, then from [0,1] to voxels. Normals go through untouched like there.
+		DirectX::XMMATRIX toSvo = DirectX::XMLoadFloat4x4(&worldToSvo_) * DirectX::XMMatrixScaling((float)volume_size_,(float)volume_size_,(float)volume_size_);
+
+		const SceneNodes::type& renderables = gYume->pRenderer->GetScene()->GetRenderables();
+
+		for(unsigned i = 0; i < renderables.size(); ++i)
+		{
+			if(renderables[i]->GetType() != GT_STATIC)
+				continue;
+
+			StaticModel* model = static_cast<StaticModel*>(renderables[i]);
+			DirectX::XMMATRIX toVoxel = model->GetTransformation() * toSvo;
+
+			const YumeVector<SharedPtr<RenderBatch> >::type& batches = model->GetBatches();
+			for(unsigned b = 0; b < batches.size(); ++b)
+			{
+				YumeGeometry* geometry = batches[b]->geo_;
+				Material* material = batches[b]->material_;
+
+				const unsigned char* vertexData;
+				const unsigned char* indexData;
+				unsigned vertexSize,indexSize,elementMask;
+				geometry->GetRawData(vertexData,vertexSize,indexData,indexSize,elementMask);
+				if(!vertexData || !indexData || !(elementMask & MASK_POSITION))
+					continue;
+
+				//Only emissive surfaces put light into rho, the way splat() does without textures
+				Vector4 rho = Vector4::ZERO;
+				const YumeMap<YumeHash,DirectX::XMFLOAT4>::type& vectors = material->GetShaderVectors4();
+				YumeMap<YumeHash,DirectX::XMFLOAT4>::const_iterator emissive = vectors.find("EmissiveColor");
+				YumeMap<YumeHash,DirectX::XMFLOAT4>::const_iterator diffuse = vectors.find("DiffuseColor");
+				if(emissive != vectors.end() && (emissive->second.x > 0 || emissive->second.y > 0 || emissive->second.z > 0))
+				{
+					rho = Vector4(emissive->second.x,emissive->second.y,emissive->second.z,emissive->second.w);
+					if(diffuse != vectors.end())
+						rho += Vector4(diffuse->second.x,diffuse->second.y,diffuse->second.z,diffuse->second.w);
+				}
+
+				unsigned start = geometry->GetIndexStart();
+				unsigned end = start + geometry->GetIndexCount();
+
+				for(unsigned index = start; index + 2 < end; index += 3)
+				{
+					Vector3 positions[3];
+					Vector3 normals[3];
+
+					for(unsigned v = 0; v < 3; ++v)
+					{
+						unsigned vertex = indexSize == sizeof(unsigned) ? ((const unsigned*)indexData)[index + v] : ((const unsigned short*)indexData)[index + v];
+						const float* data = (const float*)(vertexData + vertex * vertexSize);
+
+						DirectX::XMFLOAT3 position(data[0],data[1],data[2]);
+						DirectX::XMStoreFloat3(&position,DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&position),toVoxel));
+						positions[v] = Vector3(position.x,position.y,position.z);
+
+						//Normal follows the position in the vertex layout
+						normals[v] = (elementMask & MASK_NORMAL) ? Vector3(data[3],data[4],data[5]) : Vector3::ZERO;
+					}
+
+					VoxelizeTriangle(positions[0],positions[1],positions[2],normals[0],normals[1],normals[2],rho,volume_size_,fragments_);
+				}
+			}
+		}
 	}
 
 	void SparseVoxelOctree::ClearPs()
@@ -25,6 +25,7 @@
 #include "YumeRequired.h"
 #include "YumeTexture3D.h"
 #include "GlobalIlluminationVolume.h"
+#include "VoxelOctree.h"
 //----------------------------------------------------------------------------
 namespace YumeEngine
 {
@@ -47,7 +48,17 @@ namespace YumeEngine
 		virtual YumeGeometry* GetVolumeGeometry() { return 0; }
 
 		void ClearPs();
+
+		//Voxelize also walks the scene on the CPU and Filter builds the sparse octree from it, again only
+		//when the scene or the volume changed. Off by default, this is the reference the lighting bakes read.
+		void SetBuildOctree(bool enable) { buildOctree_ = enable; }
+		bool GetBuildOctree() const { return buildOctree_; }
+
+		const YumeVector<VoxelFragment>::type& GetFragments() const { return fragments_; }
+		const VoxelOctree& GetOctree() const { return octree_; }
 	private:
+		void GatherFragments();
+
 		TexturePtr vNormal;
 		TexturePtr vRho;
 
@@ -55,6 +66,14 @@ namespace YumeEngine
 		int last_bound_;
 		DirectX::XMFLOAT4X4 worldToSvo_;
 		DirectX::XMFLOAT3			svo_min_, svo_max_;
+
+		bool buildOctree_;
+		bool octreeDirty_;
+		//Scene change count and volume transform the fragments were gathered with
+		unsigned fragmentChanges_;
+		DirectX::XMFLOAT4X4 fragmentsToSvo_;
+		YumeVector<VoxelFragment>::type fragments_;
+		VoxelOctree octree_;
 	};
 }
 
@@ -33,10 +33,16 @@
 
 namespace YumeEngine
 {
+	//Batches above this cost more to rasterize for occlusion than they usually save
+	static const unsigned MAX_OCCLUDER_TRIANGLES = 2048;
+
 	StaticModel::StaticModel(const YumeString& model)
-		: SceneNode(GT_STATIC),modelName_(model)
+		: SceneNode(GT_STATIC),modelName_(model),
+		occluder_(true)
 	{
-		LoadFromFile(model);
+		//No file gives an empty model, batches are added to it by hand
+		if(model.length())
+			LoadFromFile(model);
 
 	}
 
@@ -65,6 +71,9 @@ namespace YumeEngine
 		YumeString fileType = f->GetFileExtension();
 		unsigned meshCount = f->ReadUInt();
 
+		//Texture names of each material, reused across meshes
+		SmallString<128> diffuse_tex,alpha_tex,emissive_tex,specular_tex,normal_tex,roughness_tex;
+
 		for(int i=0; i < meshCount; ++i)
 		{
 			//Read this mesh's vertex buffer
@@ -99,6 +108,9 @@ namespace YumeEngine
 			geo->SetIndexBuffer(ib);
 			geo->SetDrawRange(TRIANGLE_LIST,0,ib->GetIndexCount());
 
+			if(indexCount / 3 <= MAX_OCCLUDER_TRIANGLES && (elementMask & MASK_POSITION))
+				AddOccluderTriangles(vb->GetShadowData(),vertexCount,vertexSize,ib->GetShadowData(),indexCount,indexSize);
+
 
 
 
@@ -129,12 +141,12 @@ namespace YumeEngine
 
 			roughness = 1;
 
-			YumeString diffuse_tex = m->ReadString();
-			YumeString alpha_tex = m->ReadString();
-			YumeString emissive_tex = m->ReadString();
-			YumeString specular_tex = m->ReadString();
-			YumeString normal_tex = m->ReadString();
-			YumeString roughness_tex = m->ReadString();
+			m->ReadString(diffuse_tex);
+			m->ReadString(alpha_tex);
+			m->ReadString(emissive_tex);
+			m->ReadString(specular_tex);
+			m->ReadString(normal_tex);
+			m->ReadString(roughness_tex);
 
 			SharedPtr<Material> material(new Material);
 
@@ -229,6 +241,27 @@ namespace YumeEngine
 		SetWorld(DirectX::XMMatrixIdentity());
 	}
 
+	void StaticModel::AddOccluderTriangles(const unsigned char* vertexData,unsigned vertexCount,unsigned vertexSize,const unsigned char* indexData,unsigned indexCount,unsigned indexSize)
+	{
+		if(!vertexData || !indexData)
+			return;
+
+		//Position is the first element of every vertex
+		unsigned start = occluderVertices_.size();
+		for(unsigned i = 0; i < vertexCount; ++i)
+		{
+			const float* pos = reinterpret_cast<const float*>(vertexData + i * vertexSize);
+			occluderVertices_.push_back(Vector3(pos[0],pos[1],pos[2]));
+		}
+
+		for(unsigned i = 0; i < indexCount; ++i)
+		{
+			unsigned index = indexSize == sizeof(unsigned) ? reinterpret_cast<const unsigned*>(indexData)[i] :
+				reinterpret_cast<const unsigned short*>(indexData)[i];
+			occluderIndices_.push_back(start + index);
+		}
+	}
+
 	void StaticModel::UpdateBb(const DirectX::XMFLOAT3& V)
 	{
 		SetBoundingBox(dmin(V,GetBbMin()),dmax(V,GetBbMax())); //on LPV bb_min_ doesnt work fix
@@ -25,6 +25,7 @@
 #include "YumeRequired.h"
 #include "SceneNode.h"
 #include "Batch.h"
+#include "Math/YumeVector3.h"
 //----------------------------------------------------------------------------
 namespace YumeEngine
 {
@@ -51,12 +52,26 @@ namespace YumeEngine
 
 		void SetFloorRoughness(float f);
 
+		//On by default, only batches with few enough triangles take part
+		void SetOccluder(bool enable) { occluder_ = enable; }
+		bool IsOccluder() const { return occluder_ && occluderIndices_.size(); }
+		//Model space triangle list of the batches drawn into the occlusion buffer
+		const YumePodVector<Vector3>::type& GetOccluderVertices() const { return occluderVertices_; }
+		const YumePodVector<unsigned>::type& GetOccluderIndices() const { return occluderIndices_; }
+
 	public:
 		YumeVector<SharedPtr<RenderBatch> >::type batches_;
 		YumeString modelName_;
 
 		MaterialPtr floorMaterial_;
 
+	private:
+		void AddOccluderTriangles(const unsigned char* vertexData,unsigned vertexCount,unsigned vertexSize,const unsigned char* indexData,unsigned indexCount,unsigned indexSize);
+
+		bool occluder_;
+		YumePodVector<Vector3>::type occluderVertices_;
+		YumePodVector<unsigned>::type occluderIndices_;
+
 
 	};
 }
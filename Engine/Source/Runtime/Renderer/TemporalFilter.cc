@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : TemporalFilter.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "TemporalFilter.h"
+
+#include "Math/YumeMath.h"
+#include "Math/YumeVector4.h"
+
+namespace YumeEngine
+{
+	//Below this the upsample weights count as none of the texels being on the surface
+	static const float MIN_UPSAMPLE_WEIGHT = 0.0001f;
+
+	TemporalFilter::TemporalFilter()
+		: maxHistory_(8.0f),
+		depthTolerance_(0.05f)
+	{
+	}
+
+	void TemporalFilter::SetMaxHistory(float frames)
+	{
+		maxHistory_ = Max(frames,1.0f);
+	}
+
+	void TemporalFilter::SetDepthTolerance(float tolerance)
+	{
+		depthTolerance_ = Max(tolerance,M_EPSILON);
+	}
+
+	Vector2 TemporalFilter::Reproject(const Vector3& position,const Matrix4& previousViewProj)
+	{
+		Vector4 clip = previousViewProj * Vector4(position,1.0f);
+
+		//Behind last frame's camera, there is nothing to reuse
+		if(clip.w_ <= M_EPSILON)
+			return Vector2(-1.0f,-1.0f);
+
+		return Vector2(clip.x_ / clip.w_ * 0.5f + 0.5f,clip.y_ / clip.w_ * -0.5f + 0.5f);
+	}
+
+	//Unset scale means full resolution
+	static float ScaleOrOne(float scale)
+	{
+		return scale > 0.0f ? scale : 1.0f;
+	}
+
+	Vector2 TemporalFilter::GetHistoryUv(const Vector2& previousUv,float previousScale)
+	{
+		return previousUv * ScaleOrOne(previousScale);
+	}
+
+	float TemporalFilter::GetHistoryLength(const Vector2& previousUv,float expectedDepth,float previousDepth,float previousLength,
+		float previousScale,float currentScale) const
+	{
+		float scale = ScaleOrOne(previousScale);
+
+		//The history texels cover other pixels at another scale, start over
+		if(scale != ScaleOrOne(currentScale))
+			return 1.0f;
+
+		if(previousUv.x_ < 0.0f || previousUv.x_ > scale || previousUv.y_ < 0.0f || previousUv.y_ > scale)
+			return 1.0f;
+
+		//Something else was there, a disocclusion
+		if(GetDepthWeight(previousDepth,expectedDepth) <= 0.0f)
+			return 1.0f;
+
+		return Min(previousLength + 1.0f,maxHistory_);
+	}
+
+	float TemporalFilter::Accumulate(float history,float current,float historyLength)
+	{
+		return history + (current - history) / Max(historyLength,1.0f);
+	}
+
+	float TemporalFilter::GetDepthWeight(float sampleDepth,float depth) const
+	{
+		return Clamp(1.0f - Abs(sampleDepth - depth) / (depthTolerance_ * Max(depth,M_EPSILON)),0.0f,1.0f);
+	}
+
+	void TemporalFilter::GetUpsampleWeights(const Vector2& fraction,const float* lowDepths,float depth,float* weights) const
+	{
+		float bilinear[4] =
+		{
+			(1.0f - fraction.x_) * (1.0f - fraction.y_),
+			fraction.x_ * (1.0f - fraction.y_),
+			(1.0f - fraction.x_) * fraction.y_,
+			fraction.x_ * fraction.y_
+		};
+
+		float total = 0;
+		for(unsigned i = 0; i < 4; ++i)
+		{
+			weights[i] = bilinear[i] * GetDepthWeight(lowDepths[i],depth);
+			total += weights[i];
+		}
+
+		if(total > MIN_UPSAMPLE_WEIGHT)
+		{
+			for(unsigned i = 0; i < 4; ++i)
+				weights[i] /= total;
+			return;
+		}
+
+		unsigned closest = 0;
+		for(unsigned i = 1; i < 4; ++i)
+		{
+			if(Abs(lowDepths[i] - depth) < Abs(lowDepths[closest] - depth))
+				closest = i;
+		}
+
+		for(unsigned i = 0; i < 4; ++i)
+			weights[i] = i == closest ? 1.0f : 0.0f;
+	}
+}
@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : TemporalFilter.h
+// Date : <Date>
+// Comments : CPU side of the half resolution effects, the same math as TemporalFilter.hlsl
+//
+//----------------------------------------------------------------------------
+#ifndef __TemporalFilter_h__
+#define __TemporalFilter_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector2.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeMatrix4.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//SSAO and SSLR render at half resolution (full with the FullResScreenEffects variant), blend into a history reprojected with last frame's camera
+	//and are brought back to full resolution with weights that skip texels across a depth edge.
+	//A pixel keeps averaging over more frames until the history falls off screen or its depth does not
+	//match, then it starts over from the current frame.
+	class YumeAPIExport TemporalFilter
+	{
+	public:
+		TemporalFilter();
+
+		//Frames the history averages at most, more is smoother but follows changes slower
+		void SetMaxHistory(float frames);
+		//Share of the depth two samples may differ by and still be the same surface
+		void SetDepthTolerance(float tolerance);
+
+		//Texture coordinate the position had with last frame's camera, outside 0-1 when it was off screen
+		static Vector2 Reproject(const Vector3& position,const Matrix4& previousViewProj);
+
+		//Where the reprojected coordinate is in the history target. With dynamic resolution last frame only wrote
+		//the part of it its scale covered
+		static Vector2 GetHistoryUv(const Vector2& previousUv,float previousScale);
+
+		//Frames in the history once this one is in, 1 when the history is dropped.
+		//previousUv is the history coordinate, expectedDepth the distance of the position to last frame's camera,
+		//previousDepth what was stored there. A change of the resolution scale drops the history too
+		float GetHistoryLength(const Vector2& previousUv,float expectedDepth,float previousDepth,float previousLength,
+			float previousScale = 1.0f,float currentScale = 1.0f) const;
+		//Each frame of the history weighs the same
+		static float Accumulate(float history,float current,float historyLength);
+
+		//Weights of the low resolution texels at (0,0) (1,0) (0,1) (1,1) around a full resolution pixel.
+		//Bilinear, scaled down by how far their depth is from the pixel. When none of them is close
+		//the one closest in depth takes it all, so edges never blend across.
+		void GetUpsampleWeights(const Vector2& fraction,const float* lowDepths,float depth,float* weights) const;
+
+		float GetMaxHistory() const { return maxHistory_; }
+		float GetDepthTolerance() const { return depthTolerance_; }
+
+	private:
+		float GetDepthWeight(float sampleDepth,float depth) const;
+
+		float maxHistory_;
+		float depthTolerance_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
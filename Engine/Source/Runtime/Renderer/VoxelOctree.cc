@@ -0,0 +1,329 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : VoxelOctree.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "VoxelOctree.h"
+
+#include "Math/YumeMath.h"
+
+namespace YumeEngine
+{
+	//Deeper than this the node indices and the dense comparison stop fitting
+	static const unsigned MAX_OCTREE_LEVELS = 10;
+
+	//Twice the signed area of abp, positive when p is left of ab
+	static float Edge(float ax,float ay,float bx,float by,float px,float py)
+	{
+		return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+	}
+
+	void VoxelizeTriangle(const Vector3& a,const Vector3& b,const Vector3& c,
+		const Vector3& na,const Vector3& nb,const Vector3& nc,const Vector4& rho,unsigned resolution,YumeVector<VoxelFragment>::type& dest)
+	{
+		Vector3 normal = (b - a).CrossProduct(c - a).Abs();
+
+		//Same order as the geometry shader, z wins ties, then y
+		unsigned axis;
+		float dominant = Max(normal.x_,Max(normal.y_,normal.z_));
+		if(dominant == normal.z_)
+			axis = 2;
+		else if(dominant == normal.y_)
+			axis = 1;
+		else
+			axis = 0;
+
+		//Projected onto the plane of the other two axes, the dominant one becomes depth
+		Vector3 p[3] ={a,b,c};
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			if(axis == 1)
+				p[i] = Vector3(p[i].x_,p[i].z_,p[i].y_);
+			else if(axis == 0)
+				p[i] = Vector3(p[i].z_,p[i].y_,p[i].x_);
+		}
+
+		float area = Edge(p[0].x_,p[0].y_,p[1].x_,p[1].y_,p[2].x_,p[2].y_);
+		if(Abs(area) < M_EPSILON)
+			return;
+
+		int size = (int)resolution;
+		int minX = Max((int)floorf(Min(p[0].x_,Min(p[1].x_,p[2].x_))),0);
+		int minY = Max((int)floorf(Min(p[0].y_,Min(p[1].y_,p[2].y_))),0);
+		int maxX = Min((int)floorf(Max(p[0].x_,Max(p[1].x_,p[2].x_))),size - 1);
+		int maxY = Min((int)floorf(Max(p[0].y_,Max(p[1].y_,p[2].y_))),size - 1);
+
+		float invArea = 1.0f / area;
+
+		for(int y = minY; y <= maxY; ++y)
+		{
+			for(int x = minX; x <= maxX; ++x)
+			{
+				//One sample at the center of the voxel column, like the rasterizer
+				float sx = x + 0.5f;
+				float sy = y + 0.5f;
+
+				float w0 = Edge(p[1].x_,p[1].y_,p[2].x_,p[2].y_,sx,sy) * invArea;
+				float w1 = Edge(p[2].x_,p[2].y_,p[0].x_,p[0].y_,sx,sy) * invArea;
+				float w2 = Edge(p[0].x_,p[0].y_,p[1].x_,p[1].y_,sx,sy) * invArea;
+				if(w0 < 0 || w1 < 0 || w2 < 0)
+					continue;
+
+				float depth = w0 * p[0].z_ + w1 * p[1].z_ + w2 * p[2].z_;
+				int z = (int)floorf(depth);
+				if(z < 0 || z >= size)
+					continue;
+
+				VoxelFragment fragment;
+				if(axis == 2)
+				{
+					fragment.X = x;
+					fragment.Y = y;
+					fragment.Z = z;
+				}
+				else if(axis == 1)
+				{
+					fragment.X = x;
+					fragment.Y = z;
+					fragment.Z = y;
+				}
+				else
+				{
+					fragment.X = z;
+					fragment.Y = y;
+					fragment.Z = x;
+				}
+
+				//Interpolated but not renormalized, the pixel shader does not either
+				Vector3 n = na * w0 + nb * w1 + nc * w2;
+				fragment.Normal = Vector4(n * 0.5f + Vector3(0.5f,0.5f,0.5f),0.5f);
+				fragment.Rho = rho;
+				dest.push_back(fragment);
+			}
+		}
+	}
+
+	VoxelOctree::VoxelOctree()
+		: levels_(0)
+	{
+		Clear();
+	}
+
+	void VoxelOctree::Clear()
+	{
+		nodes_.clear();
+		levelStart_.clear();
+		brickNormal_.clear();
+		brickRho_.clear();
+
+		//Lone root, so lookups on an empty tree find empty space instead of nothing
+		nodes_.push_back(0);
+		levelStart_.push_back(0);
+		levelStart_.push_back(1);
+		brickNormal_.resize(8);
+		brickRho_.resize(8);
+		for(unsigned i = 0; i < 8; ++i)
+		{
+			brickNormal_[i] = Vector4::ZERO;
+			brickRho_[i] = Vector4::ZERO;
+		}
+	}
+
+	unsigned VoxelOctree::Octant(unsigned x,unsigned y,unsigned z,unsigned level) const
+	{
+		unsigned shift = levels_ - 1 - level;
+		return ((x >> shift) & 1) | (((y >> shift) & 1) << 1) | (((z >> shift) & 1) << 2);
+	}
+
+	unsigned VoxelOctree::Descend(unsigned x,unsigned y,unsigned z,unsigned level) const
+	{
+		unsigned node = 0;
+		for(unsigned l = 0; l < level; ++l)
+		{
+			unsigned children = GetChildren(node);
+			if(!children)
+				return 0;
+			node = children + Octant(x,y,z,l);
+		}
+		return node;
+	}
+
+	void VoxelOctree::Build(const YumeVector<VoxelFragment>::type& fragments,unsigned levels)
+	{
+		Clear();
+
+		levels_ = Clamp((int)levels,1,(int)MAX_OCTREE_LEVELS);
+		unsigned resolution = GetResolution();
+
+		YumePodVector<unsigned>::type inside;
+		inside.reserve(fragments.size());
+		for(unsigned i = 0; i < fragments.size(); ++i)
+		{
+			const VoxelFragment& f = fragments[i];
+			if(f.X < resolution && f.Y < resolution && f.Z < resolution)
+				inside.push_back(i);
+		}
+
+		for(unsigned level = 0; level + 1 < levels_; ++level)
+		{
+			//Flag
+			for(unsigned i = 0; i < inside.size(); ++i)
+			{
+				const VoxelFragment& f = fragments[inside[i]];
+				nodes_[Descend(f.X,f.Y,f.Z,level)] |= NODE_FLAG;
+			}
+
+			//Allocate, the new tiles are the next level and come out contiguous
+			unsigned begin = levelStart_[level];
+			unsigned end = levelStart_[level + 1];
+			for(unsigned node = begin; node < end; ++node)
+			{
+				if(!(nodes_[node] & NODE_FLAG))
+					continue;
+
+				nodes_[node] = nodes_.size();
+				for(unsigned i = 0; i < 8; ++i)
+					nodes_.push_back(0);
+			}
+			levelStart_.push_back(nodes_.size());
+		}
+
+		unsigned numVoxels = nodes_.size() * 8;
+		brickNormal_.resize(numVoxels);
+		brickRho_.resize(numVoxels);
+		for(unsigned i = 0; i < numVoxels; ++i)
+		{
+			brickNormal_[i] = Vector4::ZERO;
+			brickRho_[i] = Vector4::ZERO;
+		}
+
+		//Leaf bricks, every fragment of a voxel counts the same
+		YumePodVector<unsigned>::type counts(numVoxels);
+		for(unsigned i = 0; i < numVoxels; ++i)
+			counts[i] = 0;
+
+		for(unsigned i = 0; i < inside.size(); ++i)
+		{
+			const VoxelFragment& f = fragments[inside[i]];
+			unsigned voxel = Descend(f.X,f.Y,f.Z,levels_ - 1) * 8 + Octant(f.X,f.Y,f.Z,levels_ - 1);
+			brickNormal_[voxel] += f.Normal;
+			brickRho_[voxel] += f.Rho;
+			++counts[voxel];
+		}
+
+		unsigned leafBegin = levelStart_[levels_ - 1] * 8;
+		for(unsigned i = leafBegin; i < numVoxels; ++i)
+		{
+			if(counts[i] > 1)
+			{
+				brickNormal_[i] /= (float)counts[i];
+				brickRho_[i] /= (float)counts[i];
+			}
+		}
+	}
+
+	void VoxelOctree::FilterBricks()
+	{
+		if(levels_ < 2)
+			return;
+
+		//Bottom up so every child brick is final before its parent reads it
+		for(int level = (int)levels_ - 2; level >= 0; --level)
+		{
+			for(unsigned node = levelStart_[level]; node < levelStart_[level + 1]; ++node)
+			{
+				unsigned children = GetChildren(node);
+				if(!children)
+					continue;
+
+				for(unsigned octant = 0; octant < 8; ++octant)
+				{
+					const Vector4* normal = GetBrickNormals(children + octant);
+					const Vector4* rho = GetBrickRho(children + octant);
+
+					Vector4 normalSum = Vector4::ZERO;
+					Vector4 rhoSum = Vector4::ZERO;
+					for(unsigned i = 0; i < 8; ++i)
+					{
+						normalSum += normal[i];
+						rhoSum += rho[i];
+					}
+
+					brickNormal_[node * 8 + octant] = normalSum * 0.125f;
+					brickRho_[node * 8 + octant] = rhoSum * 0.125f;
+				}
+			}
+		}
+	}
+
+	bool VoxelOctree::Lookup(unsigned x,unsigned y,unsigned z,unsigned mip,Vector4& normal,Vector4& rho) const
+	{
+		normal = Vector4::ZERO;
+		rho = Vector4::ZERO;
+
+		if(!levels_ || mip > levels_)
+			return false;
+
+		unsigned size = GetResolution() >> mip;
+		if(x >= size || y >= size || z >= size)
+			return false;
+
+		if(mip == levels_)
+		{
+			//Above the root, the average of its brick
+			for(unsigned i = 0; i < 8; ++i)
+			{
+				normal += brickNormal_[i];
+				rho += brickRho_[i];
+			}
+			normal *= 0.125f;
+			rho *= 0.125f;
+			return normal.w_ > 0;
+		}
+
+		//Back to full resolution coordinates, the octant bits below the mip are zero and unused
+		x <<= mip;
+		y <<= mip;
+		z <<= mip;
+
+		unsigned level = levels_ - 1 - mip;
+		unsigned node = Descend(x,y,z,level);
+		if(!node && level)
+			return false;
+
+		unsigned voxel = node * 8 + Octant(x,y,z,level);
+		normal = brickNormal_[voxel];
+		rho = brickRho_[voxel];
+		return normal.w_ > 0;
+	}
+
+	unsigned VoxelOctree::GetMemoryUse() const
+	{
+		return nodes_.size() * sizeof(unsigned) + (brickNormal_.size() + brickRho_.size()) * sizeof(Vector4);
+	}
+
+	unsigned long long VoxelOctree::GetDenseMemoryUse() const
+	{
+		unsigned long long voxels = 0;
+		for(unsigned size = GetResolution(); size; size >>= 1)
+			voxels += (unsigned long long)size * size * size;
+		return voxels * 2 * sizeof(Vector4);
+	}
+}
@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : VoxelOctree.h
+// Date : <Date>
+// Comments : Sparse voxel octree built from a voxel fragment list, CPU reference of the SVO build
+//
+//----------------------------------------------------------------------------
+#ifndef __VoxelOctree_h__
+#define __VoxelOctree_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeVector4.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//One voxel touched by one triangle, what the voxelize pixel shader splats.
+	//Normal is stored the way the volume texture holds it, N * 0.5 + 0.5 with 0.5 in w.
+	struct VoxelFragment
+	{
+		unsigned X;
+		unsigned Y;
+		unsigned Z;
+		Vector4 Normal;
+		Vector4 Rho;
+	};
+
+	//Rasterizes a triangle given in voxel space [0,resolution) along its dominant axis with one sample
+	//per voxel column, same as svo_voxelize.hlsl does through the geometry shader. Appends to dest.
+	YumeAPIExport void VoxelizeTriangle(const Vector3& a,const Vector3& b,const Vector3& c,
+		const Vector3& na,const Vector3& nb,const Vector3& nc,const Vector4& rho,unsigned resolution,YumeVector<VoxelFragment>::type& dest);
+
+	//Node pool plus brick pool, built top-down one level at a time:
+	//	flag     - every fragment walks from the root to the level and flags the node it ends in
+	//	allocate - every flagged node of the level gets a tile of 8 children at the end of the pool
+	//Nodes of the last level do not subdivide, their bricks hold the fragments averaged per voxel.
+	//Every node owns one brick of 2x2x2 voxels, one per octant, at the resolution of its children.
+	//FilterBricks fills the bricks of interior nodes from their children's bricks, bottom up, which
+	//gives the same mips as box filtering the dense volume with empty voxels at zero.
+	class YumeAPIExport VoxelOctree
+	{
+	public:
+		VoxelOctree();
+
+		//Resolution is 2^levels on each axis. Fragments outside it are dropped.
+		void Build(const YumeVector<VoxelFragment>::type& fragments,unsigned levels);
+		void FilterBricks();
+		void Clear();
+
+		//Mip 0 is the full resolution, mip levels is the single voxel covering the volume.
+		//Returns false for empty space, normal and rho are zero then.
+		bool Lookup(unsigned x,unsigned y,unsigned z,unsigned mip,Vector4& normal,Vector4& rho) const;
+
+		unsigned GetLevels() const { return levels_; }
+		unsigned GetResolution() const { return 1U << levels_; }
+		unsigned GetNumNodes() const { return nodes_.size(); }
+		//Nodes of one level, the root is level 0
+		unsigned GetNumNodes(unsigned level) const { return levelStart_[level + 1] - levelStart_[level]; }
+		//Bytes for the node and brick pools
+		unsigned GetMemoryUse() const;
+		//Bytes the two dense float4 volumes with their mip chains would take at the same resolution
+		unsigned long long GetDenseMemoryUse() const;
+
+		//Child tile of a node, 0 for none. The root is never anyone's child.
+		unsigned GetChildren(unsigned node) const { return nodes_[node] & ~NODE_FLAG; }
+		const Vector4* GetBrickNormals(unsigned node) const { return &brickNormal_[node * 8]; }
+		const Vector4* GetBrickRho(unsigned node) const { return &brickRho_[node * 8]; }
+
+	private:
+		static const unsigned NODE_FLAG = 0x80000000;
+
+		//Node of the given level containing the voxel, 0 if the path stops before that
+		unsigned Descend(unsigned x,unsigned y,unsigned z,unsigned level) const;
+		unsigned Octant(unsigned x,unsigned y,unsigned z,unsigned level) const;
+
+		unsigned levels_;
+		YumePodVector<unsigned>::type nodes_;
+		YumePodVector<unsigned>::type levelStart_;
+		YumePodVector<Vector4>::type brickNormal_;
+		YumePodVector<Vector4>::type brickRho_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -28,7 +28,14 @@
 namespace YumeEngine
 {
 
+	static const unsigned DYNAMIC_UPLOADS_PER_FRAME = 4;
+
 	YumeConstantBuffer::YumeConstantBuffer()
+		: size_(0),
+		dirty_(false),
+		dynamic_(false),
+		uploadFrame_(0),
+		uploadsInFrame_(0)
 	{
 	}
 
@@ -37,6 +44,18 @@ namespace YumeEngine
 
 	}
 
+	void YumeConstantBuffer::RecordUpload(unsigned frameNumber)
+	{
+		if(frameNumber != uploadFrame_)
+		{
+			uploadFrame_ = frameNumber;
+			uploadsInFrame_ = 0;
+		}
+
+		if(++uploadsInFrame_ > DYNAMIC_UPLOADS_PER_FRAME)
+			dynamic_ = true;
+	}
+
 	void YumeConstantBuffer::SetParameter(unsigned offset,unsigned size,const void* data)
 	{
 		if(offset + size > size_)
@@ -54,6 +54,15 @@ namespace YumeEngine
 		
 		bool IsDirty() const { return dirty_; }
 
+		//Counts uploads, a buffer written more than a few times per frame is per draw data
+		void RecordUpload(unsigned frameNumber);
+		bool IsDynamic() const { return dynamic_; }
+
+		//For backends that upload the shadow copy somewhere else than the buffer itself
+		const unsigned char* GetShadowData() const { return shadowData_.get(); }
+		void MarkDirty() { dirty_ = true; }
+		void ClearDirty() { dirty_ = false; }
+
 	protected:
 		
 		boost::shared_array<unsigned char> shadowData_;
@@ -61,6 +70,10 @@ namespace YumeEngine
 		unsigned size_;
 		
 		bool dirty_;
+
+		bool dynamic_;
+		unsigned uploadFrame_;
+		unsigned uploadsInFrame_;
 	};
 }
 
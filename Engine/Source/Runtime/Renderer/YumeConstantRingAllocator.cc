@@ -0,0 +1,128 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeConstantRingAllocator.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeConstantRingAllocator.h"
+
+#include "Math/YumeMath.h"
+
+namespace YumeEngine
+{
+	ConstantRingStats::ConstantRingStats()
+		: FrameBytes(0),
+		FrameAllocations(0),
+		PeakFrameBytes(0),
+		Wraps(0),
+		Failures(0)
+	{
+	}
+
+	YumeConstantRingAllocator::YumeConstantRingAllocator()
+		: capacity_(0),
+		alignment_(CONSTANT_RING_ALIGNMENT),
+		framesInFlight_(CONSTANT_RING_FRAMES_IN_FLIGHT)
+	{
+		Reset();
+	}
+
+	void YumeConstantRingAllocator::SetSize(unsigned capacity,unsigned alignment,unsigned framesInFlight)
+	{
+		alignment_ = alignment ? alignment : 1;
+		capacity_ = capacity - capacity % alignment_;
+		framesInFlight_ = Clamp((int)framesInFlight,1,(int)MAX_CONSTANT_RING_FRAMES);
+
+		Reset();
+	}
+
+	void YumeConstantRingAllocator::Reset()
+	{
+		head_ = 0;
+		used_ = 0;
+		frameNumber_ = 0;
+
+		for(unsigned i = 0; i < MAX_CONSTANT_RING_FRAMES; ++i)
+			frameBytes_[i] = 0;
+
+		stats_ = ConstantRingStats();
+	}
+
+	void YumeConstantRingAllocator::BeginFrame()
+	{
+		++frameNumber_;
+
+		//The slot we are about to reuse belongs to the frame the GPU finished last
+		unsigned slot = frameNumber_ % framesInFlight_;
+		used_ -= frameBytes_[slot];
+		frameBytes_[slot] = 0;
+
+		stats_.FrameBytes = 0;
+		stats_.FrameAllocations = 0;
+	}
+
+	unsigned YumeConstantRingAllocator::Allocate(unsigned size,bool& wrapped)
+	{
+		wrapped = false;
+
+		unsigned alignedSize = (size + alignment_ - 1) / alignment_ * alignment_;
+
+		if(!alignedSize || alignedSize > capacity_)
+		{
+			++stats_.Failures;
+			return M_MAX_UNSIGNED;
+		}
+
+		//Skipping the tail of the ring costs the bytes up to the end
+		unsigned waste = 0;
+		if(head_ + alignedSize > capacity_)
+		{
+			waste = capacity_ - head_;
+			wrapped = true;
+		}
+
+		if(used_ + waste + alignedSize > capacity_)
+		{
+			wrapped = false;
+			++stats_.Failures;
+			return M_MAX_UNSIGNED;
+		}
+
+		if(wrapped)
+		{
+			head_ = 0;
+			++stats_.Wraps;
+		}
+
+		//A full ring leaves head at the end so the next allocation reports the wrap
+		unsigned offset = head_;
+		head_ += alignedSize;
+
+		unsigned consumed = waste + alignedSize;
+		used_ += consumed;
+		frameBytes_[frameNumber_ % framesInFlight_] += consumed;
+
+		stats_.FrameBytes += consumed;
+		++stats_.FrameAllocations;
+		if(stats_.FrameBytes > stats_.PeakFrameBytes)
+			stats_.PeakFrameBytes = stats_.FrameBytes;
+
+		return offset;
+	}
+}
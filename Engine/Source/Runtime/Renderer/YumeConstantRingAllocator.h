@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeConstantRingAllocator.h
+// Date : <Date>
+// Comments : Linear sub allocator for per draw constants streamed through one big buffer
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeConstantRingAllocator_h__
+#define __YumeConstantRingAllocator_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//D3D11.1 binds constant ranges in units of 16 constants
+	static const unsigned CONSTANT_RING_ALIGNMENT = 256;
+	static const unsigned CONSTANT_RING_FRAMES_IN_FLIGHT = 3;
+	static const unsigned MAX_CONSTANT_RING_FRAMES = 8;
+
+	struct YumeAPIExport ConstantRingStats
+	{
+		ConstantRingStats();
+
+		unsigned FrameBytes;
+		unsigned FrameAllocations;
+		unsigned PeakFrameBytes;
+		unsigned Wraps;
+		unsigned Failures;
+	};
+
+	//Only does the bookkeeping, the backend owns the actual buffer.
+	//Memory written in a frame stays reserved until framesInFlight more frames have begun.
+	class YumeAPIExport YumeConstantRingAllocator
+	{
+	public:
+		YumeConstantRingAllocator();
+
+		void SetSize(unsigned capacity,unsigned alignment = CONSTANT_RING_ALIGNMENT,unsigned framesInFlight = CONSTANT_RING_FRAMES_IN_FLIGHT);
+		void Reset();
+
+		void BeginFrame();
+
+		//Returns the byte offset or M_MAX_UNSIGNED when the ring is full.
+		//wrapped is set when the allocation restarted at the beginning of the ring.
+		unsigned Allocate(unsigned size,bool& wrapped);
+
+		unsigned GetCapacity() const { return capacity_; }
+		unsigned GetAlignment() const { return alignment_; }
+		unsigned GetUsedBytes() const { return used_; }
+		unsigned GetFrameNumber() const { return frameNumber_; }
+
+		const ConstantRingStats& GetStats() const { return stats_; }
+
+	private:
+		unsigned capacity_;
+		unsigned alignment_;
+		unsigned framesInFlight_;
+
+		unsigned head_;
+		unsigned used_;
+		unsigned frameNumber_;
+		unsigned frameBytes_[MAX_CONSTANT_RING_FRAMES];
+
+		ConstantRingStats stats_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeDynamicResolution.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeDynamicResolution.h"
+
+#include "Math/YumeMath.h"
+
+#include <cmath>
+
+namespace YumeEngine
+{
+	YumeDynamicResolution::YumeDynamicResolution()
+		: enabled_(false),
+		targetFrameTime_(1000.0f / 60.0f),
+		minScale_(0.5f),
+		maxScale_(1.0f),
+		scaleStep_(0.05f),
+		lowerThreshold_(0.8f),
+		upperThreshold_(0.95f),
+		smoothing_(0.1f),
+		maxStepUp_(0.05f),
+		maxStepDown_(0.15f),
+		cooldownFrames_(8),
+		scale_(1.0f),
+		smoothedFrameTime_(0.0f),
+		framesSinceChange_(0),
+		numScaleChanges_(0)
+	{
+	}
+
+	YumeDynamicResolution::~YumeDynamicResolution()
+	{
+	}
+
+	void YumeDynamicResolution::SetEnabled(bool enabled)
+	{
+		if(enabled_ == enabled)
+			return;
+
+		enabled_ = enabled;
+		Reset();
+	}
+
+	void YumeDynamicResolution::SetScaleBounds(float minScale,float maxScale)
+	{
+		minScale_ = Clamp(minScale,0.1f,1.0f);
+		maxScale_ = Clamp(maxScale,minScale_,1.0f);
+		scale_ = Clamp(scale_,minScale_,maxScale_);
+	}
+
+	void YumeDynamicResolution::Reset()
+	{
+		scale_ = maxScale_;
+		smoothedFrameTime_ = 0.0f;
+		framesSinceChange_ = 0;
+		numScaleChanges_ = 0;
+	}
+
+	float YumeDynamicResolution::Update(float cpuFrameTime,float gpuFrameTime)
+	{
+		if(!enabled_)
+			return 1.0f;
+
+		//Resolution only buys back GPU time, prefer it when we have it
+		float frameTime = gpuFrameTime > 0.0f ? gpuFrameTime : cpuFrameTime;
+
+		if(smoothedFrameTime_ <= 0.0f)
+			smoothedFrameTime_ = frameTime;
+		else
+			smoothedFrameTime_ += (frameTime - smoothedFrameTime_) * smoothing_;
+
+		++framesSinceChange_;
+
+		if(framesSinceChange_ < cooldownFrames_ || smoothedFrameTime_ <= 0.0f)
+			return scale_;
+
+		float low = targetFrameTime_ * lowerThreshold_;
+		float high = targetFrameTime_ * upperThreshold_;
+
+		if(smoothedFrameTime_ >= low && smoothedFrameTime_ <= high)
+			return scale_;
+
+		//Pixel cost grows with the square of the scale, aim for the middle of the band
+		float desiredTime = (low + high) * 0.5f;
+		float desired = scale_ * sqrtf(desiredTime / smoothedFrameTime_);
+
+		desired = Clamp(desired,scale_ - maxStepDown_,scale_ + maxStepUp_);
+		desired = Quantize(desired);
+
+		//Always move at least one step out of the band
+		if(smoothedFrameTime_ > high)
+			desired = Min(desired,scale_ - scaleStep_);
+		else
+			desired = Max(desired,scale_ + scaleStep_);
+
+		desired = Clamp(desired,minScale_,maxScale_);
+
+		if(Abs(desired - scale_) > M_EPSILON)
+		{
+			//Expect the frame time to follow the pixel count until new samples come in
+			smoothedFrameTime_ *= (desired * desired) / (scale_ * scale_);
+
+			scale_ = desired;
+			framesSinceChange_ = 0;
+			++numScaleChanges_;
+		}
+
+		return scale_;
+	}
+
+	IntVector2 YumeDynamicResolution::GetRenderSize(int width,int height) const
+	{
+		float scale = GetScale();
+
+		return IntVector2(Max((int)(width * scale + 0.5f),1),Max((int)(height * scale + 0.5f),1));
+	}
+
+	float YumeDynamicResolution::Quantize(float scale) const
+	{
+		if(scaleStep_ <= 0.0f)
+			return scale;
+
+		return floorf(scale / scaleStep_ + 0.5f) * scaleStep_;
+	}
+}
@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeDynamicResolution.h
+// Date : <Date>
+// Comments : Picks the internal render resolution from measured frame times
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeDynamicResolution_h__
+#define __YumeDynamicResolution_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Math/YumeVector2.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class YumeAPIExport YumeDynamicResolution : public YumeBase
+	{
+	public:
+		YumeDynamicResolution();
+		virtual ~YumeDynamicResolution();
+
+		//Feeds one frame of timings in milliseconds and returns the scale for the next frame.
+		//gpuFrameTime may be zero when no GPU timing is available, the cpu time is used then.
+		float Update(float cpuFrameTime,float gpuFrameTime = 0.0f);
+		void Reset();
+
+		void SetEnabled(bool enabled);
+		bool GetEnabled() const { return enabled_; }
+
+		void SetTargetFrameTime(float ms) { targetFrameTime_ = ms; }
+		float GetTargetFrameTime() const { return targetFrameTime_; }
+
+		void SetScaleBounds(float minScale,float maxScale);
+		float GetMinScale() const { return minScale_; }
+		float GetMaxScale() const { return maxScale_; }
+
+		//Scale changes are quantized to this step so transient targets get reused
+		void SetScaleStep(float step) { scaleStep_ = step; }
+		float GetScaleStep() const { return scaleStep_; }
+
+		//Frame time is kept inside [lower,upper] * target before anything changes
+		void SetHeadroom(float lower,float upper) { lowerThreshold_ = lower; upperThreshold_ = upper; }
+		void SetSmoothing(float factor) { smoothing_ = factor; }
+		void SetCooldownFrames(unsigned frames) { cooldownFrames_ = frames; }
+
+		float GetScale() const { return enabled_ ? scale_ : 1.0f; }
+		float GetSmoothedFrameTime() const { return smoothedFrameTime_; }
+		unsigned GetNumScaleChanges() const { return numScaleChanges_; }
+
+		IntVector2 GetRenderSize(int width,int height) const;
+
+	private:
+		float Quantize(float scale) const;
+
+		bool enabled_;
+
+		float targetFrameTime_;
+		float minScale_;
+		float maxScale_;
+		float scaleStep_;
+		float lowerThreshold_;
+		float upperThreshold_;
+		float smoothing_;
+		float maxStepUp_;
+		float maxStepDown_;
+		unsigned cooldownFrames_;
+
+		float scale_;
+		float smoothedFrameTime_;
+		unsigned framesSinceChange_;
+		unsigned numScaleChanges_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,342 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeGpuTimer.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeGpuTimer.h"
+
+#include "Core/YumeProfiler.h"
+#include "Math/YumeMath.h"
+
+namespace YumeEngine
+{
+	static const unsigned long long SYNTHETIC_FREQUENCY = 1000000;
+
+	//Pass names come from the render path XML and the profiler holds on to name pointers, so they are kept for good.
+	//Render thread only.
+	static const char* InternScopeName(const YumeString& name)
+	{
+		static YumeOpenMap<YumeString,const char*>::type* names = new YumeOpenMap<YumeString,const char*>::type;
+
+		YumeOpenMap<YumeString,const char*>::iterator i = names->find(name);
+		if(i != names->end())
+			return i->second;
+
+		char* interned = new char[name.length() + 1];
+		memcpy(interned,name.c_str(),name.length() + 1);
+		(*names)[name] = interned;
+		return interned;
+	}
+
+	SyntheticTimestampSource::SyntheticTimestampSource(double stepMs,unsigned latency)
+		: stepMs_(stepMs),
+		latency_(latency),
+		disjoint_(false),
+		frameNumber_(0),
+		clockMs_(0)
+	{
+		for(unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+		{
+			slotFrame_[i] = 0;
+			slotDisjoint_[i] = false;
+		}
+	}
+
+	void SyntheticTimestampSource::BeginFrame(unsigned slot)
+	{
+		++frameNumber_;
+		slotFrame_[slot] = frameNumber_;
+		slotDisjoint_[slot] = disjoint_;
+	}
+
+	void SyntheticTimestampSource::EndFrame(unsigned slot)
+	{
+	}
+
+	void SyntheticTimestampSource::Timestamp(unsigned slot,unsigned index)
+	{
+		ticks_[slot][index] = (unsigned long long)(clockMs_ * (SYNTHETIC_FREQUENCY / 1000) + 0.5);
+		clockMs_ += stepMs_;
+	}
+
+	GpuTimestampResult SyntheticTimestampSource::GetTimestamps(unsigned slot,unsigned count,unsigned long long* ticks,unsigned long long& frequency)
+	{
+		if(frameNumber_ - slotFrame_[slot] < latency_)
+			return GPU_TIMESTAMPS_PENDING;
+		if(slotDisjoint_[slot])
+			return GPU_TIMESTAMPS_DISJOINT;
+
+		memcpy(ticks,ticks_[slot],count * sizeof(unsigned long long));
+		frequency = SYNTHETIC_FREQUENCY;
+		return GPU_TIMESTAMPS_READY;
+	}
+
+	GpuScopeStats::GpuScopeStats()
+		: Name(0),
+		Depth(0),
+		FrameMs(0),
+		MinMs(0),
+		AvgMs(0),
+		MaxMs(0)
+	{
+	}
+
+	YumeGpuTimer::YumeGpuTimer()
+		: source_(0),
+		recording_(false),
+		frameNumber_(0),
+		resolveNumber_(0),
+		statsInterval_(60),
+		intervalFrames_(0),
+		frameMs_(0),
+		numResolved_(0),
+		numDropped_(0),
+		numDisjoint_(0)
+	{
+		for(unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+		{
+			frames_[i].NumTimestamps = 0;
+			frames_[i].CpuBegin = 0;
+			frames_[i].Pending = false;
+		}
+	}
+
+	void YumeGpuTimer::SetSource(GpuTimestampSource* source)
+	{
+		source_ = source;
+
+		//Queries of the old source are gone
+		for(unsigned i = 0; i < GPU_TIMER_FRAMES; ++i)
+			frames_[i].Pending = false;
+		resolveNumber_ = frameNumber_;
+		open_.clear();
+		recording_ = false;
+	}
+
+	void YumeGpuTimer::BeginFrame()
+	{
+		if(!source_)
+			return;
+
+		if(recording_)
+			EndFrame();
+
+		Resolve();
+
+		unsigned slot = frameNumber_ % GPU_TIMER_FRAMES;
+		Frame& frame = frames_[slot];
+		frame.Scopes.clear();
+		frame.CpuBegin = YumeProfiler::GetTicks();
+		frame.Pending = false;
+
+		source_->BeginFrame(slot);
+		source_->Timestamp(slot,0);
+		frame.NumTimestamps = 1;
+
+		recording_ = true;
+	}
+
+	void YumeGpuTimer::EndFrame()
+	{
+		if(!source_ || !recording_)
+			return;
+
+		//Scopes left open are not timed
+		while(!open_.empty())
+			EndScope();
+
+		unsigned slot = frameNumber_ % GPU_TIMER_FRAMES;
+		Frame& frame = frames_[slot];
+
+		source_->Timestamp(slot,frame.NumTimestamps++);
+		source_->EndFrame(slot);
+		frame.Pending = true;
+
+		++frameNumber_;
+		recording_ = false;
+	}
+
+	void YumeGpuTimer::BeginScope(const YumeString& name)
+	{
+		if(!recording_)
+			return;
+
+		unsigned slot = frameNumber_ % GPU_TIMER_FRAMES;
+		Frame& frame = frames_[slot];
+
+		//Room for this begin, the ends of every open scope including this one and the end of the frame
+		if(frame.NumTimestamps + (unsigned)open_.size() + 3 > MAX_GPU_TIMESTAMPS)
+		{
+			open_.push_back(M_MAX_UNSIGNED);
+			return;
+		}
+
+		GpuScopeRecord scope;
+		scope.Name = InternScopeName(name.length() ? name : YumeString("Unnamed"));
+		scope.Depth = (unsigned)open_.size();
+		scope.Begin = frame.NumTimestamps++;
+		scope.End = M_MAX_UNSIGNED;
+
+		open_.push_back((unsigned)frame.Scopes.size());
+		frame.Scopes.push_back(scope);
+
+		source_->Timestamp(slot,scope.Begin);
+	}
+
+	void YumeGpuTimer::EndScope()
+	{
+		if(!recording_ || open_.empty())
+			return;
+
+		unsigned index = open_.back();
+		open_.Pop();
+		if(index == M_MAX_UNSIGNED)
+			return;
+
+		unsigned slot = frameNumber_ % GPU_TIMER_FRAMES;
+		Frame& frame = frames_[slot];
+
+		frame.Scopes[index].End = frame.NumTimestamps++;
+		source_->Timestamp(slot,frame.Scopes[index].End);
+	}
+
+	void YumeGpuTimer::Resolve()
+	{
+		unsigned long long ticks[MAX_GPU_TIMESTAMPS];
+
+		for(; resolveNumber_ != frameNumber_; ++resolveNumber_)
+		{
+			unsigned slot = resolveNumber_ % GPU_TIMER_FRAMES;
+			Frame& frame = frames_[slot];
+			if(!frame.Pending)
+				continue;
+
+			unsigned long long frequency = 0;
+			GpuTimestampResult result = source_->GetTimestamps(slot,frame.NumTimestamps,ticks,frequency);
+			if(result == GPU_TIMESTAMPS_PENDING)
+			{
+				//Still in flight, wait unless the slot is about to be recorded into again
+				if(frameNumber_ - resolveNumber_ < GPU_TIMER_FRAMES)
+					break;
+				++numDropped_;
+			}
+			else if(result == GPU_TIMESTAMPS_DISJOINT || !frequency)
+				++numDisjoint_;
+			else
+				Accumulate(frame,ticks,frequency);
+
+			frame.Pending = false;
+		}
+	}
+
+	void YumeGpuTimer::Accumulate(const Frame& frame,const unsigned long long* ticks,unsigned long long frequency)
+	{
+		double tickMs = 1000.0 / (double)frequency;
+
+		frameMs_ = (double)(ticks[frame.NumTimestamps - 1] - ticks[0]) * tickMs;
+		++numResolved_;
+
+		for(unsigned i = 0; i < frame.Scopes.size(); ++i)
+		{
+			const GpuScopeRecord& scope = frame.Scopes[i];
+			if(scope.End == M_MAX_UNSIGNED)
+				continue;
+
+			double ms = (double)(ticks[scope.End] - ticks[scope.Begin]) * tickMs;
+
+			GpuScopeNode& node = nodes_[FindOrAddNode(scope.Name,scope.Depth)];
+			node.FrameTime += ms;
+			++node.FrameCalls;
+
+#if YUME_PROFILING
+			//GPU and CPU clocks are not synchronized, the track starts where the frame was recorded on the CPU
+			long long begin = frame.CpuBegin + (long long)((double)(ticks[scope.Begin] - ticks[0]) * tickMs * 1000000.0);
+			YumeProfiler::Get().AddZone("GPU",scope.Name,scope.Depth,begin,begin + (long long)(ms * 1000000.0));
+#endif
+		}
+
+		bool publish = ++intervalFrames_ >= statsInterval_;
+		if(publish)
+			intervalFrames_ = 0;
+
+		for(unsigned i = 0; i < nodes_.size(); ++i)
+		{
+			GpuScopeNode& node = nodes_[i];
+
+			node.Stats.FrameMs = node.FrameTime;
+			if(node.FrameCalls)
+			{
+				if(!node.IntervalFrames || node.FrameTime < node.IntervalMin)
+					node.IntervalMin = node.FrameTime;
+				if(node.FrameTime > node.IntervalMax)
+					node.IntervalMax = node.FrameTime;
+				node.IntervalTotal += node.FrameTime;
+				++node.IntervalFrames;
+			}
+			node.FrameTime = 0;
+			node.FrameCalls = 0;
+
+			if(publish)
+			{
+				node.Stats.MinMs = node.IntervalMin;
+				node.Stats.AvgMs = node.IntervalFrames ? node.IntervalTotal / node.IntervalFrames : 0;
+				node.Stats.MaxMs = node.IntervalMax;
+
+				node.IntervalTotal = 0;
+				node.IntervalMin = 0;
+				node.IntervalMax = 0;
+				node.IntervalFrames = 0;
+			}
+		}
+	}
+
+	unsigned YumeGpuTimer::FindOrAddNode(const char* name,unsigned depth)
+	{
+		for(unsigned i = 0; i < nodes_.size(); ++i)
+		{
+			if(nodes_[i].Stats.Name == name && nodes_[i].Stats.Depth == depth)
+				return i;
+		}
+
+		GpuScopeNode node;
+		node.FrameTime = 0;
+		node.FrameCalls = 0;
+		node.IntervalTotal = 0;
+		node.IntervalMin = 0;
+		node.IntervalMax = 0;
+		node.IntervalFrames = 0;
+		node.Stats.Name = name;
+		node.Stats.Depth = depth;
+		nodes_.push_back(node);
+		return (unsigned)nodes_.size() - 1;
+	}
+
+	void YumeGpuTimer::SetStatsInterval(unsigned frames)
+	{
+		statsInterval_ = frames ? frames : 1;
+	}
+
+	void YumeGpuTimer::GetStats(YumeVector<GpuScopeStats>::type& dest) const
+	{
+		dest.clear();
+		for(unsigned i = 0; i < nodes_.size(); ++i)
+			dest.push_back(nodes_[i].Stats);
+	}
+}
@@ -0,0 +1,202 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeGpuTimer.h
+// Date : <Date>
+// Comments : Timestamp queries around render calls, read back a few frames late
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeGpuTimer_h__
+#define __YumeGpuTimer_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Query sets in flight. A frame whose results are not back by the time its set is reused is dropped.
+	static const unsigned GPU_TIMER_FRAMES = 4;
+	//Per frame, two per scope and two for the frame itself
+	static const unsigned MAX_GPU_TIMESTAMPS = 256;
+
+	enum GpuTimestampResult
+	{
+		GPU_TIMESTAMPS_PENDING = 0,
+		GPU_TIMESTAMPS_READY,
+		//The GPU clock changed frequency or was reset during the frame, the ticks are meaningless
+		GPU_TIMESTAMPS_DISJOINT
+	};
+
+	//Implemented by the backends. Every frame in flight has its own queries, addressed by slot.
+	class YumeAPIExport GpuTimestampSource
+	{
+	public:
+		virtual ~GpuTimestampSource() {}
+
+		virtual void BeginFrame(unsigned slot) = 0;
+		virtual void EndFrame(unsigned slot) = 0;
+		virtual void Timestamp(unsigned slot,unsigned index) = 0;
+
+		//Must not block. Fills count ticks and the tick frequency in Hz once the whole frame is READY.
+		virtual GpuTimestampResult GetTimestamps(unsigned slot,unsigned count,unsigned long long* ticks,unsigned long long& frequency) = 0;
+	};
+
+	//Used by the Null backend and the tests. Every timestamp moves a fake clock on by a fixed step,
+	//results become ready latency frames after they were recorded.
+	class YumeAPIExport SyntheticTimestampSource : public GpuTimestampSource
+	{
+	public:
+		SyntheticTimestampSource(double stepMs = 0.1,unsigned latency = 2);
+
+		void SetStepMs(double stepMs) { stepMs_ = stepMs; }
+		void SetLatency(unsigned latency) { latency_ = latency; }
+		//Frames begun while set come back disjoint
+		void SetDisjoint(bool disjoint) { disjoint_ = disjoint; }
+
+		virtual void BeginFrame(unsigned slot);
+		virtual void EndFrame(unsigned slot);
+		virtual void Timestamp(unsigned slot,unsigned index);
+		virtual GpuTimestampResult GetTimestamps(unsigned slot,unsigned count,unsigned long long* ticks,unsigned long long& frequency);
+
+	private:
+		double stepMs_;
+		unsigned latency_;
+		bool disjoint_;
+
+		unsigned frameNumber_;
+		double clockMs_;
+		unsigned slotFrame_[GPU_TIMER_FRAMES];
+		bool slotDisjoint_[GPU_TIMER_FRAMES];
+		unsigned long long ticks_[GPU_TIMER_FRAMES][MAX_GPU_TIMESTAMPS];
+	};
+
+	//Times in milliseconds over the last completed interval
+	struct YumeAPIExport GpuScopeStats
+	{
+		GpuScopeStats();
+
+		const char* Name;
+		unsigned Depth;
+		//Latest frame read back
+		double FrameMs;
+		double MinMs;
+		double AvgMs;
+		double MaxMs;
+	};
+
+	struct GpuScopeRecord
+	{
+		const char* Name;
+		unsigned Depth;
+		unsigned Begin;
+		//M_MAX_UNSIGNED while open or when there was no room left for the end
+		unsigned End;
+	};
+
+	struct GpuScopeNode
+	{
+		double FrameTime;
+		unsigned FrameCalls;
+
+		double IntervalTotal;
+		double IntervalMin;
+		double IntervalMax;
+		unsigned IntervalFrames;
+
+		GpuScopeStats Stats;
+	};
+
+	//Backend independent. The backend hands its query source in and calls BeginFrame/EndFrame,
+	//scopes in between are timed. Results reach the stats and the profiler's "GPU" track once read back.
+	class YumeAPIExport YumeGpuTimer
+	{
+	public:
+		YumeGpuTimer();
+
+		//Not owned, null turns timing off
+		void SetSource(GpuTimestampSource* source);
+		GpuTimestampSource* GetSource() const { return source_; }
+
+		//Reads back every finished frame, then starts the next
+		void BeginFrame();
+		void EndFrame();
+
+		//Scopes nest. Names are interned, the same name at the same depth adds up within a frame.
+		void BeginScope(const YumeString& name);
+		void EndScope();
+
+		void SetStatsInterval(unsigned frames);
+		unsigned GetStatsInterval() const { return statsInterval_; }
+
+		//In the order the scopes were first seen
+		void GetStats(YumeVector<GpuScopeStats>::type& dest) const;
+
+		//Whole frame, latest read back
+		double GetFrameMs() const { return frameMs_; }
+		unsigned GetNumResolved() const { return numResolved_; }
+		unsigned GetNumDropped() const { return numDropped_; }
+		unsigned GetNumDisjoint() const { return numDisjoint_; }
+
+	private:
+		struct Frame
+		{
+			YumeVector<GpuScopeRecord>::type Scopes;
+			unsigned NumTimestamps;
+			//Profiler clock when the frame was recorded, the GPU track is lined up against it
+			long long CpuBegin;
+			bool Pending;
+		};
+
+		void Resolve();
+		void Accumulate(const Frame& frame,const unsigned long long* ticks,unsigned long long frequency);
+		unsigned FindOrAddNode(const char* name,unsigned depth);
+
+		GpuTimestampSource* source_;
+		Frame frames_[GPU_TIMER_FRAMES];
+		//Scope indices, innermost last
+		YumeVector<unsigned>::type open_;
+		bool recording_;
+
+		unsigned frameNumber_;
+		unsigned resolveNumber_;
+		unsigned statsInterval_;
+		unsigned intervalFrames_;
+
+		YumeVector<GpuScopeNode>::type nodes_;
+		double frameMs_;
+		unsigned numResolved_;
+		unsigned numDropped_;
+		unsigned numDisjoint_;
+	};
+
+	//Times the rest of the scope, does nothing without a source
+	class YumeAPIExport GpuTimerScope
+	{
+	public:
+		GpuTimerScope(YumeGpuTimer& timer,const YumeString& name):
+			timer_(timer)
+		{
+			timer_.BeginScope(name);
+		}
+		~GpuTimerScope() { timer_.EndScope(); }
+
+	private:
+		YumeGpuTimer& timer_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -41,10 +41,13 @@
 #include "LightPropagationVolume.h"
 #include "GlobalIlluminationVolume.h"
 #include "StaticModel.h"
+#include "LuminanceHistogram.h"
 
 #include "YumeTextureCube.h"
 
 #include "Logging/logging.h"
+#include "Core/YumeProfiler.h"
+#include "Core/YumeFrameArena.h"
 using namespace DirectX;
 
 
@@ -53,6 +56,7 @@ using namespace DirectX;
 
 
 #define CAMERA_MOVE_SPEED 75
+#define REFLECTION_PROBE_SIZE 256
 
 
 
@@ -140,6 +144,28 @@ namespace YumeEngine
 		DirectX::XMFLOAT3 V;
 	};
 
+	//Row vector XMMATRIX to the column vector matrices of Math
+	static Matrix3x4 ToMatrix3x4(const DirectX::XMMATRIX& m)
+	{
+		DirectX::XMFLOAT4X4 f;
+		DirectX::XMStoreFloat4x4(&f,m);
+		return Matrix3x4(
+			f._11,f._21,f._31,f._41,
+			f._12,f._22,f._32,f._42,
+			f._13,f._23,f._33,f._43);
+	}
+
+	static Matrix4 ToMatrix4(const DirectX::XMMATRIX& m)
+	{
+		DirectX::XMFLOAT4X4 f;
+		DirectX::XMStoreFloat4x4(&f,m);
+		return Matrix4(
+			f._11,f._21,f._31,f._41,
+			f._12,f._22,f._32,f._42,
+			f._13,f._23,f._33,f._43,
+			f._14,f._24,f._34,f._44);
+	}
+
 	YumeMiscRenderer::YumeMiscRenderer()
 		:
 		zNear(.2f),
@@ -147,14 +173,21 @@ namespace YumeEngine
 		giEnabled_(true),
 		updateRsm_(true),
 		rsmSize(1024),
+		cascadedShadows_(false),
+		occlusionCulling_(false),
+		numOccluded_(0),
+		frameRenderScale_(1.0f),
+		prevRenderScale_(1.0f),
+		frameIndex_(0),
 		num_propagations_(64),
 		disableFrustumCull_(true),
-		updateCubemap_(true),
 		currentAdaptedLuminance_(true),
 		backbufferModified_(false),
 		usedResolve_(false),
 		currentRenderTarget_(0),
-		cameraMoveSpeed_(CAMERA_MOVE_SPEED)
+		renderScale_(1.0f),
+		cameraMoveSpeed_(CAMERA_MOVE_SPEED),
+		envType_(Env_Static)
 	{
 		rhi_ = gYume->pRHI ;
 
@@ -163,6 +196,8 @@ namespace YumeEngine
 
 		scene_ = YumeAPINew Scene;
 
+		renderTargetPool_ = YumeAPINew YumeRenderTargetPool;
+		dynamicResolution_ = YumeAPINew YumeDynamicResolution;
 
 
 		giParams_.DebugView = false;
@@ -175,6 +210,13 @@ namespace YumeEngine
 
 	YumeMiscRenderer::~YumeMiscRenderer()
 	{
+		const RenderTargetPoolStats& poolStats = renderTargetPool_->GetStats();
+
+		YUMELOG_INFO("Transient render targets: " << poolStats.NumTargets <<
+			" Peak bytes: " << poolStats.PeakBytes <<
+			" Requests: " << poolStats.Requests <<
+			" Hit rate: " << poolStats.GetHitRate() <<
+			" Evictions: " << poolStats.Evictions);
 	}
 
 	void YumeMiscRenderer::Initialize(GISolution gi)
@@ -195,6 +237,7 @@ namespace YumeEngine
 		if(gi_ == LPV || gi_ == Dyn_Lpv)
 		{
 			defaultPass_->Load("RenderCalls/ReflectiveShadowMap.xml");
+			defaultPass_->Load("RenderCalls/CascadedShadowMap.xml");
 			defaultPass_->Load("RenderCalls/LightPropagationVolume.xml");
 			defaultPass_->Load("RenderCalls/DeferredGI.xml");
 
@@ -203,6 +246,12 @@ namespace YumeEngine
 
 			giVolume_->Create(32);
 
+			if(gi_ == LPV)
+				lpvBakeFile_ = gYume->pEnv->GetVariant("LpvBakeFile").Get<YumeString>();
+
+			//Propagation iterations per frame after an injection, 0 runs them all at once
+			giVolume_->GetUpdate().SetIterationBudget(atoi((gYume->pEnv->GetVariant("GIIterationsPerFrame").Get<YumeString>()).c_str()));
+
 			curr_ = 0;
 			next_ = 1;
 
@@ -212,12 +261,16 @@ namespace YumeEngine
 		if(gi_ == SVO || gi_ == Dyn_Svo)
 		{
 			defaultPass_->Load("RenderCalls/ReflectiveShadowMap.xml");
+			defaultPass_->Load("RenderCalls/CascadedShadowMap.xml");
 			defaultPass_->Load("RenderCalls/SparseVoxelOctree.xml");
 			defaultPass_->Load("RenderCalls/DeferredGISVO.xml");
 
-			giVolume_ = new SparseVoxelOctree();
+			SparseVoxelOctree* svo = new SparseVoxelOctree();
+			svo->Create(256);
+			//CPU octree alongside the volumes, for bakes and for checking the GPU path
+			svo->SetBuildOctree(gYume->pEnv->GetVariant("SvoOctree").Get<bool>());
 
-			giVolume_->Create(256);
+			giVolume_ = svo;
 		}
 		if(gi_ == NoGI)
 		{
@@ -226,6 +279,33 @@ namespace YumeEngine
 			defaultPass_->Load("RenderCalls/Deferred.xml");
 		}
 
+		//The final passes take the directional shadow from the cascades, the RSM is then only there to inject GI.
+		//ShadowCascades set to 0 goes back to the RSM shadow.
+		if(gi_ != NoGI)
+		{
+			//A missing variant comes back as false, only an int or a string sets the count
+			const Variant& cascades = gYume->pEnv->GetVariant("ShadowCascades");
+			unsigned numCascades = MAX_SHADOW_CASCADES;
+			if(cascades.GetType() == VAR_INT)
+				numCascades = (unsigned)Max(cascades.GetInt(),0);
+			else if(cascades.GetType() == VAR_STRING)
+				numCascades = (unsigned)Max(atoi(cascades.GetString().c_str()),0);
+
+			cascadedShadows_ = numCascades > 0;
+			if(cascadedShadows_)
+			{
+				//2x2 atlas
+				shadowCascades_.SetResolution(defaultPass_->GetTextureByName("CSM_ATLAS")->GetWidth() / 2);
+				shadowCascades_.SetNumCascades(numCascades);
+				shadowCascades_.SetShadowDistance((float)atof(gYume->pEnv->GetVariant("ShadowDistance").Get<YumeString>().c_str()));
+			}
+			else
+				defaultPass_->DisableRenderCalls("CSM");
+		}
+
+		//Setup adds the scene wide probe, which is dynamic with DynEnv
+		envType_ = (EnvironmentMapType)atoi((gYume->pEnv->GetVariant("DynEnv").Get<YumeString>()).c_str());
+
 		Setup();
 		
 
@@ -287,18 +367,7 @@ namespace YumeEngine
 		fullscreenTriangle_->SetVertexBuffer(0,triangleVb);
 		fullscreenTriangle_->SetDrawRange(TRIANGLE_LIST,0,0,0,3);
 
-		/*pp_ = YumeAPINew YumePostProcess(this);
-		pp_->Setup();*/
-
-
-		screenBuffers_.clear();
-		screenBufferAllocations_.clear();
-
-		envType_ = (EnvironmentMapType)atoi((gYume->pEnv->GetVariant("DynEnv").Get<YumeString>()).c_str());
-	}
-
-	void YumeMiscRenderer::Setup()
-	{
+		//Light volume of the deferred point lights, needed by every render path
 		SharedPtr<YumeVertexBuffer> plvb(gYume->pRHI->CreateVertexBuffer());
 		plvb->SetShadowed(true);
 		plvb->SetSize(24,MASK_POSITION);
@@ -314,6 +383,25 @@ namespace YumeEngine
 		pointLightGeometry_->SetIndexBuffer(plib);
 		pointLightGeometry_->SetDrawRange(TRIANGLE_LIST,0,plib->GetIndexCount());
 
+		/*pp_ = YumeAPINew YumePostProcess(this);
+		pp_->Setup();*/
+
+
+		renderTargetPool_->Clear();
+
+		int targetFrameRate = gYume->pEnv->GetVariant("TargetFrameRate").Get<int>();
+		if(targetFrameRate > 0)
+			dynamicResolution_->SetTargetFrameTime(1000.0f / targetFrameRate);
+		dynamicResolution_->SetEnabled(gYume->pEnv->GetVariant("DynamicResolution").Get<bool>());
+
+		//Same aspect as the view, a quarter of a 1024 wide one is plenty to find what walls hide
+		occlusionCulling_ = gYume->pEnv->GetVariant("OcclusionCulling").Get<bool>();
+		occlusionBuffer_.SetSize(256,(unsigned)Max(256.0f * height / Max(width,1.0f),1.0f));
+		occlusionBuffer_.SetNumThreads(0);
+	}
+
+	void YumeMiscRenderer::Setup()
+	{
 		pointLightAttTexture_ = gYume->pResourceManager->PrepareResource<YumeTexture2D>("Textures/Ramp.png");
 
 		lightMap = rhi_->CreateTexture2D();
@@ -326,27 +414,50 @@ namespace YumeEngine
 		backBufferSub_ = rhi_->CreateTexture2D();
 		backBufferSub_->SetSize(1600,900,rhi_->GetRGBAFloat16FormatNs(),TEXTURE_RENDERTARGET);
 
-		unsigned CubemapSize = 256;
-		cubemapRt_ = (rhi_->CreateTextureCube());
-		cubemapRt_->SetNumLevels(9);
-		cubemapRt_->SetName("CubeMap");
-		cubemapRt_->SetSize(CubemapSize,rhi_->GetRGBAFormatNs(),TEXTURE_RENDERTARGET);
-
 		cubemapDsv_ = (rhi_->CreateTexture2D());
 		cubemapDsv_->SetName("DSCubeMap");
-		cubemapDsv_->SetSize(CubemapSize,CubemapSize,39,TEXTURE_DEPTHSTENCIL);
+		cubemapDsv_->SetSize(REFLECTION_PROBE_SIZE,REFLECTION_PROBE_SIZE,39,TEXTURE_DEPTHSTENCIL);
 
-
-		CreateCubemapCameras(0,15,0);
+		//The scene wide probe, used wherever no other probe reaches
+		AddReflectionProbe(Vector3(0,15,0),M_INFINITY,envType_ == Env_Dynamic);
 
 		cameraMoveSpeed_ = (float)gYume->pEnv->GetVariant("CamMoveSpeed").Get<int>();
 		if(cameraMoveSpeed_ == 0)
 			cameraMoveSpeed_ = CAMERA_MOVE_SPEED;
 	}
 
-	void YumeMiscRenderer::CreateCubemapCameras(float x,float y,float z)
+	unsigned YumeMiscRenderer::AddReflectionProbe(const Vector3& position,float radius,bool dynamic)
+	{
+		unsigned probe = reflectionProbes_.AddProbe(position,radius,dynamic);
+		if(probe == M_MAX_UNSIGNED)
+			return probe;
+
+		if(!probeCubes_[probe])
+		{
+			probeCubes_[probe] = rhi_->CreateTextureCube();
+			probeCubes_[probe]->SetNumLevels(9);
+			probeCubes_[probe]->SetName("CubeMap");
+			probeCubes_[probe]->SetSize(REFLECTION_PROBE_SIZE,rhi_->GetRGBAFormatNs(),TEXTURE_RENDERTARGET);
+		}
+
+		return probe;
+	}
+
+	YumeTextureCube* YumeMiscRenderer::GetEnvironmentMap() const
+	{
+		DirectX::XMFLOAT3 cameraPos;
+		DirectX::XMStoreFloat3(&cameraPos,camera_->Position());
+
+		unsigned probe = reflectionProbes_.GetProbeAt(Vector3(cameraPos.x,cameraPos.y,cameraPos.z));
+		return probeCubes_[probe == M_MAX_UNSIGNED ? 0 : probe];
+	}
+
+	void YumeMiscRenderer::PlaceCubemapCameras(const Vector3& position)
 	{
 		// Generate the cube map about the given position.
+		float x = position.x_;
+		float y = position.y_;
+		float z = position.z_;
 		XMFLOAT3 center(x,y,z);
 		XMFLOAT3 worldUp(0.0f,1.0f,0.0f);
 
@@ -373,14 +484,15 @@ namespace YumeEngine
 			XMFLOAT3(0.0f,1.0f,0.0f)	 // -Z
 		};
 
-		for(int i=0; i < 6; ++i)
+		if(cubemapCams_.empty())
 		{
-			YumeCamera* cam(new FirstPersonCamera(1,M_PI * 0.5f,0.1f,1000.0f));
-			cam->SetLookAt(center,targets[i],ups[i]);
-
-			cubemapCams_.push_back(cam);
+			for(int i=0; i < 6; ++i)
+				cubemapCams_.push_back(new FirstPersonCamera(1,M_PI * 0.5f,0.1f,1000.0f));
 		}
 
+		for(int i=0; i < 6; ++i)
+			cubemapCams_[i]->SetLookAt(center,targets[i],ups[i]);
+
 	}
 
 	void YumeMiscRenderer::Update(float timeStep)
@@ -397,8 +509,8 @@ namespace YumeEngine
 
 	void YumeMiscRenderer::ApplyShaderParameters(RenderCall* call)
 	{
-		const YumeMap<YumeHash,Variant>::type& variants = call->GetShaderVariants();
-		YumeMap<YumeHash,Variant>::const_iterator It = variants.begin();
+		const YumeOpenMap<YumeHash,Variant>::type& variants = call->GetShaderVariants();
+		YumeOpenMap<YumeHash,Variant>::const_iterator It = variants.begin();
 
 		for(It; It != variants.end(); ++It)
 		{
@@ -406,24 +518,24 @@ namespace YumeEngine
 		}
 
 		////Matrices
-		const YumeMap<YumeHash,DirectX::XMMATRIX>::type& matrices = call->GetShaderMatrices();
-		YumeMap<YumeHash,DirectX::XMMATRIX>::const_iterator mIt = matrices.begin();
+		const YumeOpenMap<YumeHash,DirectX::XMMATRIX>::type& matrices = call->GetShaderMatrices();
+		YumeOpenMap<YumeHash,DirectX::XMMATRIX>::const_iterator mIt = matrices.begin();
 
 		for(mIt; mIt != matrices.end(); ++mIt)
 		{
 			rhi_->SetShaderParameter(mIt->first,mIt->second);
 		}
 
-		const YumeMap<YumeHash,DirectX::XMFLOAT4>::type& vectors = call->GetShaderVectors4();
-		YumeMap<YumeHash,DirectX::XMFLOAT4>::const_iterator vIt = vectors.begin();
+		const YumeOpenMap<YumeHash,DirectX::XMFLOAT4>::type& vectors = call->GetShaderVectors4();
+		YumeOpenMap<YumeHash,DirectX::XMFLOAT4>::const_iterator vIt = vectors.begin();
 
 		for(vIt; vIt != vectors.end(); ++vIt)
 		{
 			rhi_->SetShaderParameter(vIt->first,vIt->second);
 		}
 
-		const YumeMap<YumeHash,DirectX::XMFLOAT3>::type& vectors3 = call->GetShaderVectors3();
-		YumeMap<YumeHash,DirectX::XMFLOAT3>::const_iterator vIt3 = vectors3.begin();
+		const YumeOpenMap<YumeHash,DirectX::XMFLOAT3>::type& vectors3 = call->GetShaderVectors3();
+		YumeOpenMap<YumeHash,DirectX::XMFLOAT3>::const_iterator vIt3 = vectors3.begin();
 
 		for(vIt3; vIt3 != vectors3.end(); ++vIt3)
 		{
@@ -433,118 +545,42 @@ namespace YumeEngine
 
 	void YumeMiscRenderer::RemoveUnusedBuffers()
 	{
-		for(YumeMap<long long,YumeVector<SharedPtr<YumeTexture> >::type >::iterator i = screenBuffers_.begin(); i != screenBuffers_.end();)
-		{
-			HashMap<long long,Vector<SharedPtr<YumeTexture> > >::Iterator current = i++;
-			YumeVector<SharedPtr<YumeTexture> >::type& buffers = current->second;
-			for(unsigned j = buffers.size() - 1; j < buffers.size(); --j)
-			{
-				TexturePtr buffer = buffers[j];
-				if(buffer->GetUseTimer() > 1000U)
-				{
-					YUMELOG_DEBUG("Removed unused screen buffer size " << String(buffer->GetWidth()).c_str() << "x" << String(buffer->GetHeight()).c_str() <<
-						" format " << String(buffer->GetFormat()).c_str());
-					buffers.erase(j);
-				}
-			}
-			if(buffers.empty())
-			{
-				screenBufferAllocations_.erase(current->first);
-				screenBuffers_.erase(current);
-			}
-		}
+		renderTargetPool_->EndFrame();
 	}
+
 	TexturePtr YumeMiscRenderer::AllocateAdditionalBuffers(int width,int height,unsigned format,bool cubemap,bool filtered,bool srgb,bool mips,
 		unsigned persistentKey)
 	{
-		bool depthStencil = false;
-
-		if(depthStencil)
-		{
-			filtered = false;
-			srgb = false;
-		}
-
-		if(cubemap)
-			height = width;
+		unsigned flags = 0;
 
-		long long searchKey = ((long long)format << 32) | (width << 16) | height;
 		if(filtered)
-			searchKey |= 0x8000000000000000LL;
+			flags |= TTF_FILTERED;
 		if(srgb)
-			searchKey |= 0x4000000000000000LL;
+			flags |= TTF_SRGB;
 		if(cubemap)
-			searchKey |= 0x2000000000000000LL;
+			flags |= TTF_CUBEMAP;
 		if(mips)
-			searchKey |= 0x160000000000000LL;
-
-		// Add persistent key if defined
-		if(persistentKey)
-			searchKey += ((long long)persistentKey << 32);
+			flags |= TTF_MIPS;
 
-		if(screenBuffers_.find(searchKey) == screenBuffers_.end())
-			screenBufferAllocations_[searchKey] = 0;
-
-		// Reuse depth-stencil buffers whenever the size matches, instead of allocating new
-		unsigned allocations = screenBufferAllocations_[searchKey];
-		if(!depthStencil)
-			++screenBufferAllocations_[searchKey];
-
-		if(allocations >= screenBuffers_[searchKey].size())
-		{
-			SharedPtr<YumeTexture> newBuffer;
-
-			if(!cubemap)
-			{
-				SharedPtr<YumeTexture2D> newTex2D(rhi_->CreateTexture2D());
-				YumeString name = "AllocBuffer_";
-				name.AppendWithFormat("%i",searchKey);
-				newTex2D->SetName(name);
-				RenderTargetDesc desc;
-				desc.Name = name;
-				desc.Usage = depthStencil ? TEXTURE_DEPTHSTENCIL : TEXTURE_RENDERTARGET;
-				desc.Index = 0;
-				desc.Type = RT_INPUT | RT_OUTPUT;
-				newTex2D->SetDesc(desc);
-				newTex2D->SetSRGB(true);
-				newTex2D->SetSize(width,height,format,depthStencil ? TEXTURE_DEPTHSTENCIL : TEXTURE_RENDERTARGET,1,mips ? 0 : 1);
-
-
-				newBuffer = newTex2D;
-
-			}
-			else
-			{
-				//Cube
-			}
-
-			newBuffer->SetSRGB(srgb);
-			newBuffer->SetFilterMode(filtered ? FILTER_BILINEAR : FILTER_NEAREST);
-			newBuffer->ResetUseTimer();
-			screenBuffers_[searchKey].push_back(newBuffer);
+		return renderTargetPool_->Acquire(TransientTargetDesc(width,height,format,flags,1,persistentKey));
+	}
 
-			YUMELOG_DEBUG("Allocated new screen buffer size " << YumeString(width).c_str() << "x" << YumeString(height).c_str() << " format " << YumeString(format).c_str());
-			return newBuffer;
-		}
-		else
-		{
-			TexturePtr buffer = screenBuffers_[searchKey][allocations];
-			return buffer;
-		}
+	void YumeMiscRenderer::ReleaseAdditionalBuffer(TexturePtr buffer)
+	{
+		renderTargetPool_->Release(buffer);
 	}
 
 	void YumeMiscRenderer::PrepareRendering()
 	{
+		YUME_PROFILE("YumeMiscRenderer::PrepareRendering");
 
-		//Reset allocations
-		for(YumeMap<long long,unsigned>::iterator i = screenBufferAllocations_.begin(); i != screenBufferAllocations_.end(); ++i)
-			i->second = 0;
+		//Targets handed out last frame become available again
+		renderTargetPool_->BeginFrame(gYume->pTimer->GetFrameNumber());
 
 
 		bool hasBackbufferRead = false;
 		bool hasPingpong = false;
 		bool needSubstitute = false;
-		bool hasPostProcess = false;
 
 		unsigned numViewportTextures = 0;
 
@@ -560,9 +596,6 @@ namespace YumeEngine
 
 			if(!hasPingpong && CheckPingPong(call,i))
 				hasPingpong = true;
-
-			if(!hasPostProcess && call->GetPostProcessPass())
-				hasPostProcess = true;
 		}
 
 
@@ -578,16 +611,14 @@ namespace YumeEngine
 				viewportTextures_[i] = i < numViewportTextures ? AllocateAdditionalBuffers(rhi_->GetWidth(),rhi_->GetHeight(),rhi_->GetRGBAFormatNs(),false,true,true,false) : (TexturePtr)0;
 			}
 		}
-
-		if(hasPostProcess)
-		{
-			viewportTextures_[numViewportTextures] = AllocateAdditionalBuffers(rhi_->GetWidth(),rhi_->GetHeight(),rhi_->GetRGBA16FormatNs(),false,true,true,true);
-			++numViewportTextures;
-		}
 	}
 
 	void YumeMiscRenderer::Render()
 	{
+		YUME_PROFILE("YumeMiscRenderer::Render");
+		renderScale_ = dynamicResolution_->Update(gYume->pEngine->GetFrameWorkTime(),(float)rhi_->GetGpuTimer().GetFrameMs());
+		UpdateFrameCamera();
+
 		if(!defaultPass_->calls_.size())
 		{
 			rhi_->BindBackbuffer();
@@ -597,18 +628,12 @@ namespace YumeEngine
 		{
 			PrepareRendering();
 
-			if(updateCubemap_)
-			{
-				RenderIntoCubemap();
-
-				if(envType_ == Env_Static)
-					updateCubemap_ = false;
-				else
-					updateCubemap_ = true;
-			}
+			RenderReflectionProbes();
 
 			currentRenderTarget_ = 0;
 
+			if(occlusionCulling_)
+				UpdateOcclusion();
 
 			bool isPingPonging = false;
 
@@ -625,8 +650,7 @@ namespace YumeEngine
 			{
 				RenderCallPtr call = defaultPass_->calls_[i];
 
-				//Debugging purposes,no use
-				YumeString callName = call->GetPassName();
+				const YumeString& callName = call->GetPassName();
 
 				if(!call->GetEnabled())
 					continue;
@@ -651,7 +675,7 @@ namespace YumeEngine
 					{
 						if(!currentRenderTarget_)
 						{
-							rhi_->ResolveToTexture(dynamic_cast<Texture2DPtr>(viewportTextures_[0]),IntRect(0,0,rhi_->GetWidth(),rhi_->GetHeight()));
+							rhi_->ResolveToTexture(dynamic_cast<Texture2DPtr>(viewportTextures_[0]),GetRenderViewport(0));
 							currentViewportTexture_ = viewportTextures_[0];
 							backbufferModified_ = false;
 							usedResolve_ = true;
@@ -703,10 +727,14 @@ namespace YumeEngine
 					}
 				}
 
+				//Timed on the GPU under the name given in the render path, read back a few frames later
+				GpuTimerScope gpuScope(rhi_->GetGpuTimer(),callName.length() ? callName : call->GetIdentifier());
+
 				switch(call->GetType())
 				{
 				case CallType::CLEAR:
 				{
+					YUME_PROFILE("RenderCall::Clear");
 					RHIEvent e("RenderCall::Clear");
 
 					if(call->IsShadowPass())
@@ -739,6 +767,7 @@ namespace YumeEngine
 				break;
 				case CallType::SCENE:
 				{
+					YUME_PROFILE("RenderCall::Scene");
 					RHIEvent ev;
 					if(call->GetPassName().length())
 					{
@@ -747,7 +776,11 @@ namespace YumeEngine
 					else
 						ev.BeginEvent("RenderCall::Scene");
 
-					if(call->IsShadowPass())
+					if(call->IsCascadePass())
+					{
+						RenderShadowCascades(call);
+					}
+					else if(call->IsShadowPass())
 					{
 						if(GetGIEnabled())
 						{
@@ -820,7 +853,7 @@ namespace YumeEngine
 										rhi_->SetStencilTest(true,CMP_ALWAYS,OP_REF,OP_KEEP,OP_KEEP,OP_KEEP,1);
 								}
 
-								rhi_->SetViewport(IntRect(0,0,rhi_->GetWidth(),rhi_->GetHeight()));
+								rhi_->SetViewport(GetRenderViewport(0));
 
 								rhi_->Clear(CLEAR_COLOR | CLEAR_DEPTH,YumeColor(0,0,0,0));
 
@@ -846,7 +879,7 @@ namespace YumeEngine
 
 								SetSamplers(call);
 								SetCameraParameters(false,camera_);
-								RenderScene();
+								RenderScene(true);
 								rhi_->BindResetRenderTargets(0);
 							}
 						}
@@ -895,7 +928,7 @@ namespace YumeEngine
 
 
 
-							rhi_->SetViewport(IntRect(0,0,rhi_->GetWidth(),rhi_->GetHeight()));
+							rhi_->SetViewport(GetRenderViewport(colors));
 
 
 							rhi_->ClearRenderTarget(0,CLEAR_COLOR | CLEAR_DEPTH,YumeColor(0,0,0,0));
@@ -915,7 +948,7 @@ namespace YumeEngine
 
 							//rhi_->BindSampler(PS,0,1,0); //0 is standard filter
 							SetCameraParameters(false,camera_);
-							RenderScene();
+							RenderScene(true);
 							rhi_->BindResetRenderTargets(0);
 						}
 					}
@@ -924,11 +957,28 @@ namespace YumeEngine
 				break;
 				case CallType::LPV_INJECT:
 				{
+					YUME_PROFILE("RenderCall::LPV_INJECT");
+					if(!updateRsm_)
+						break;
+
 					curr_ = 0;
 					next_ = 1;
 
-					if(!updateRsm_)
-						break;
+					//Static lighting comes from the bake, the rest of the LPV and RSM calls are not needed
+					if(lpvBakeFile_.length())
+					{
+						LightPropagationVolume* lpv = static_cast<LightPropagationVolume*>(giVolume_);
+						if(lpv->LoadBake(lpvBakeFile_,num_propagations_,giParams_.LPVFlux) ||
+							lpv->Bake(lpvBakeFile_,num_propagations_,giParams_.LPVFlux))
+						{
+							updateRsm_ = false;
+							defaultPass_->DisableRenderCalls("RSM");
+							defaultPass_->DisableRenderCalls("LPVPropagate");
+							break;
+						}
+					}
+
+					giVolume_->GetUpdate().BeginPropagation(num_propagations_);
 
 					RHIEvent ev;
 					if(call->GetPassName().length())
@@ -961,7 +1011,8 @@ namespace YumeEngine
 					}
 
 					unsigned inputSize = call->GetNumInputs();
-					YumeVector<TexturePtr>::type inputs;
+					YumeFrameVector<TexturePtr>::type inputs(FrameArenaSTLAllocator<TexturePtr>(gYume->pFrameArena.Get()));
+					inputs.reserve(MAX_TEXTURE_UNITS);
 
 					unsigned startIndex = M_MAX_UNSIGNED;
 
@@ -990,6 +1041,7 @@ namespace YumeEngine
 				break;
 				case SVO_INJECT:
 				{
+					YUME_PROFILE("RenderCall::SVO_INJECT");
 					RHIEvent ev;
 					if(call->GetPassName().length())
 					{
@@ -1044,14 +1096,11 @@ namespace YumeEngine
 
 					giVolume_->Filter();
 
-					if(gi_ != Dyn_Svo)
-					{
-						defaultPass_->DisableRenderCalls("RSM");
-						defaultPass_->DisableRenderCalls("RSMVoxelize");
-						defaultPass_->DisableRenderCalls("RSMInject");
-						updateRsm_ = false;
-
-					}
+					//Dynamic GI turns these back on from UpdateLights once the light or the scene changes
+					defaultPass_->DisableRenderCalls("RSM");
+					defaultPass_->DisableRenderCalls("RSMVoxelize");
+					defaultPass_->DisableRenderCalls("RSMInject");
+					updateRsm_ = false;
 
 					rhi_->BindResetTextures(6,3);
 				}
@@ -1061,6 +1110,7 @@ namespace YumeEngine
 					if(!updateRsm_)
 						break;
 
+					YUME_PROFILE("RenderCall::LPV_NORMALIZE");
 					RHIEvent ev;
 					if(call->GetPassName().length())
 					{
@@ -1130,9 +1180,11 @@ namespace YumeEngine
 				break;
 				case LPV_PROPAGATE:
 				{
-					if(!updateRsm_)
+					GIVolumeUpdate& update = giVolume_->GetUpdate();
+					if(update.IsConverged())
 						break;
 
+					YUME_PROFILE("RenderCall::LPV_PROPAGATE");
 					RHIEvent ev;
 					if(call->GetPassName().length())
 					{
@@ -1179,21 +1231,26 @@ namespace YumeEngine
 
 					rhi_->SetShaders(call->GetVs(),call->GetPs(),call->GetGs());
 
-					for(int i=0; i < num_propagations_; ++i)
+					//Picks up where the last frame stopped, curr_ and next_ still point at its last iteration
+					unsigned first = update.GetIteration();
+					unsigned count = update.GetFrameIterations();
+					for(unsigned i = first; i < first + count; ++i)
 					{
 						rhi_->SetShaderParameter("iteration",(float)i);
 						LPVPropagate(call,i);
 					}
-					if(gi_ != Dyn_Lpv)
-					{
-						updateRsm_ = false;
-						defaultPass_->DisableRenderCalls("RSM");
-					}
+					update.Advance(count);
+
+					updateRsm_ = false;
+					defaultPass_->DisableRenderCalls("RSM");
+					if(update.IsConverged())
+						defaultPass_->DisableRenderCalls("LPVPropagate");
 
 				}
 				break;
 				case CallType::GENERATEMIPS:
 				{
+					YUME_PROFILE("RenderCall::GENERATEMIPS");
 					RHIEvent ev;
 					if(call->GetPassName().length())
 					{
@@ -1212,89 +1269,85 @@ namespace YumeEngine
 				break;
 				case ADAPT_LUMINANCE:
 				{
-					TexturePtr target = currentViewportTexture_;
-					TexturePtr ppInput = viewportTextures_[2];
-					BlitRenderTarget(target,ppInput,false);
-					/*TexturePtr ppInput = target;*/
-
-
-
-					rhi_->GenerateMips(ppInput);
+					YUME_PROFILE("RenderCall::ADAPT_LUMINANCE");
+					//The scene pyramid the render path built, the histogram reads one of its small levels
+					TexturePtr ppInput = call->GetInput(0);
+					TexturePtr histogram = defaultPass_->GetTextureByName("LuminanceHistogram");
 
 					currentAdaptedLuminance_= !currentAdaptedLuminance_;
 
-					gYume->pRHI->SetViewport(IntRect(0,0,1,1));
-
 					TexturePtr adaptLum1 = defaultPass_->GetTextureByName("RT_ADAPT_LUMINANCE_1");
 					TexturePtr adaptLum0 = defaultPass_->GetTextureByName("RT_ADAPT_LUMINANCE_0");
 
-					TexturePtr bloomFull = defaultPass_->GetTextureByName("BloomTarget");
-
 					adaptLuminance[0] = adaptLum0;
 					adaptLuminance[1] = adaptLum1;
 
-					YumeShaderVariation* fsTriangle = rhi_->GetShader(VS,"LPV/fs_triangle","","fs_triangle_vs");
 					{
-						RHIEvent e("Adapt Luminance");
+						RHIEvent e("Luminance Histogram");
 
+						gYume->pRHI->SetRenderTarget(0,histogram);
+						gYume->pRHI->SetViewport(IntRect(0,0,LUMINANCE_HISTOGRAM_BINS,1));
+						gYume->pRHI->ClearRenderTarget(0,CLEAR_COLOR);
+						gYume->pRHI->SetBlendMode(BLEND_ADD);
 
-						YumeShaderVariation* ps = gYume->pRHI->GetShader(PS,"Bloom","","ps_adapt_exposure");
-
-						gYume->pRHI->SetShaders(fsTriangle,ps,0);
-						SetCameraParameters(false,camera_);
-
-						YumeGeometry* fs = GetFsTriangle();
-
-						auto textures = gYume->pRenderer->GetFreeTextures();
-						textures[0] = ppInput;
-						textures[5] = adaptLuminance[!currentAdaptedLuminance_];
-						gYume->pRHI->PSBindSRV(0,1,textures);
+						YumeShaderVariation* vs = gYume->pRHI->GetShader(VS,"Bloom","","vs_luminance_histogram");
+						YumeShaderVariation* ps = gYume->pRHI->GetShader(PS,"Bloom","","ps_luminance_histogram");
+						gYume->pRHI->SetShaders(vs,ps,0);
 
 						ApplyShaderParameters(call);
-						SetPerFrameConstants();
 
-						gYume->pRHI->SetRenderTarget(0,adaptLuminance[currentAdaptedLuminance_]);
+						TexturePtr vsInputs[] ={ppInput};
+						gYume->pRHI->VSBindSRV(0,1,vsInputs);
 
-						fs->Draw(gYume->pRHI);
+						//A point per texel, each adds one to the bin of its luminance. Only the part
+						//dynamic resolution rendered to, the rest of the level is stale
+						IntRect viewport = GetRenderViewport(ppInput);
+						unsigned width = Max(viewport.Width() >> LUMINANCE_HISTOGRAM_LEVEL,1);
+						unsigned height = Max(viewport.Height() >> LUMINANCE_HISTOGRAM_LEVEL,1);
+						gYume->pRHI->SetShaderParameter("histogram_size",Vector2((float)width,(float)height));
 
+						gYume->pRHI->BindPsuedoBuffer();
+						gYume->pRHI->Draw(POINT_LIST,0,width * height);
 
+						gYume->pRHI->SetBlendMode(BLEND_REPLACE);
 						gYume->pRHI->BindResetRenderTargets(0);
-						gYume->pRHI->BindResetTextures(0,1);
 					}
 
+					gYume->pRHI->SetViewport(IntRect(0,0,1,1));
 
+					YumeShaderVariation* fsTriangle = rhi_->GetShader(VS,"LPV/fs_triangle","","fs_triangle_vs");
 					{
-						RHIEvent e("Bloom Threshold");
+						RHIEvent e("Adapt Luminance");
 
-						gYume->pRHI->SetViewport(IntRect(0,0,rhi_->GetWidth(),rhi_->GetHeight()));
-						YumeShaderVariation* threshold = gYume->pRHI->GetShader(PS,"Bloom","BLOOM_THRESHOLD","ps_bloom_treshold");
 
-						gYume->pRHI->SetShaders(fsTriangle,threshold,0);
+						YumeShaderVariation* ps = gYume->pRHI->GetShader(PS,"Bloom","","ps_adapt_exposure");
+
+						gYume->pRHI->SetShaders(fsTriangle,ps,0);
 						SetCameraParameters(false,camera_);
 
 						YumeGeometry* fs = GetFsTriangle();
 
-						auto textures = gYume->pRenderer->GetFreeTextures();
-						textures[0] = ppInput;
+						YumeVector<TexturePtr>::type& textures = gYume->pRenderer->GetFreeTextures();
+						textures[0] = histogram;
 						textures[5] = adaptLuminance[!currentAdaptedLuminance_];
-						gYume->pRHI->PSBindSRV(0,2,textures);
+						gYume->pRHI->PSBindSRV(0,1,textures);
 
 						ApplyShaderParameters(call);
 						SetPerFrameConstants();
 
-						gYume->pRHI->SetRenderTarget(0,bloomFull);
-
+						gYume->pRHI->SetRenderTarget(0,adaptLuminance[currentAdaptedLuminance_]);
 
 						fs->Draw(gYume->pRHI);
 
-						gYume->pRHI->BindResetTextures(0,13);
+
 						gYume->pRHI->BindResetRenderTargets(0);
+						gYume->pRHI->BindResetTextures(0,1);
 					}
-
 				}
 				break;
 				case CallType::FSTRIANGLE:
 				{
+					YUME_PROFILE("RenderCall::FSTRIANGLE");
 					RHIEvent ev;
 					if(call->GetPassName().length())
 					{
@@ -1338,10 +1391,11 @@ namespace YumeEngine
 						}
 					}
 
-					if(call->GetPassName() == "BloomFinal")
+					//Exposure of this frame for the bloom threshold and the tonemapping
+					if(call->GetPassName() == "BloomPrefilter" || call->GetPassName() == "PostUber")
 						inputs[5] = adaptLuminance[currentAdaptedLuminance_];
 
-					inputs[14] = cubemapRt_; //Change this,noise texture conflict
+					inputs[14] = GetEnvironmentMap(); //Change this,noise texture conflict
 
 
 					//Variants
@@ -1404,14 +1458,14 @@ namespace YumeEngine
 
 					if(!output && !currentRenderTarget_)
 					{
-						gYume->pRHI->SetViewport(IntRect(0,0,rhi_->GetWidth(),rhi_->GetHeight()));
+						gYume->pRHI->SetViewport(GetRenderViewport(0));
 						rhi_->SetRenderTarget(0,(YumeTexture*)0);
 						rhi_->Clear(CLEAR_COLOR,YumeColor(0,0,0,1));
 
 					}
 					else if(output)
 					{
-						gYume->pRHI->SetViewport(IntRect(0,0,output->GetWidth(),output->GetHeight()));
+						gYume->pRHI->SetViewport(GetRenderViewport(output));
 						rhi_->SetRenderTarget(0,output);
 						/*rhi_->ClearRenderTarget(0,CLEAR_COLOR);*/
 
@@ -1420,7 +1474,7 @@ namespace YumeEngine
 					}
 					else if(currentRenderTarget_)
 					{
-						gYume->pRHI->SetViewport(IntRect(0,0,currentRenderTarget_->GetWidth(),currentRenderTarget_->GetHeight()));
+						gYume->pRHI->SetViewport(GetRenderViewport(currentRenderTarget_->GetParentTexture()));
 						rhi_->SetRenderTarget(0,currentRenderTarget_);
 
 						if(call->GetRendererFlags() & RF_CLEAR)
@@ -1477,6 +1531,8 @@ namespace YumeEngine
 				if(backbufferWrite)
 					backbufferModified_ = true;
 			}
+
+			UpscaleToBackbuffer();
 		}
 		RemoveUnusedBuffers();
 	}
@@ -1524,8 +1580,8 @@ namespace YumeEngine
 		IntVector2 destSize = destination ? IntVector2(destination->GetWidth(),destination->GetHeight()) : IntVector2(
 			rhi_->GetWidth(),rhi_->GetHeight());
 
-		IntRect srcRect = IntRect(0,0,srcSize.x_,srcSize.y_);
-		IntRect destRect = IntRect(0,0,destSize.x_,destSize.y_);
+		IntRect srcRect = GetRenderViewport(source);
+		IntRect destRect = GetRenderViewport(destination);
 
 
 		rhi_->SetRenderTarget(0,destination);
@@ -1537,10 +1593,11 @@ namespace YumeEngine
 		static const String shaderName("Copy");
 		YumeShaderVariation* triangle = rhi_->GetShader(VS,"LPV/fs_triangle","","fs_triangle_vs");
 		rhi_->SetShaders(triangle,rhi_->GetShader(PS,shaderName,shaderName,"ps_copy"));
+		rhi_->SetShaderParameter("resolution_scale",renderScale_);
 
 		SetGBufferShaderParameters(srcSize,srcRect);
 
-		auto textures = GetFreeTextures();
+		YumeVector<TexturePtr>::type& textures = GetFreeTextures();
 		textures[0] = source;
 
 		rhi_->PSBindSRV(0,1,textures);
@@ -1554,8 +1611,62 @@ namespace YumeEngine
 		rhi_->BindResetRenderTargets(1);
 	}
 
+	IntRect YumeMiscRenderer::GetRenderViewport(TexturePtr target) const
+	{
+		int width = target ? target->GetWidth() : rhi_->GetWidth();
+		int height = target ? target->GetHeight() : rhi_->GetHeight();
+
+		bool screenSized = !target || target->GetDesc().ScreenRelative || (width == rhi_->GetWidth() && height == rhi_->GetHeight());
+
+		if(!screenSized || renderScale_ >= 1.0f)
+			return IntRect(0,0,width,height);
+
+		IntVector2 size = dynamicResolution_->GetRenderSize(width,height);
+		return IntRect(0,0,size.x_,size.y_);
+	}
+
+	void YumeMiscRenderer::UpscaleToBackbuffer()
+	{
+		YUME_PROFILE("YumeMiscRenderer::UpscaleToBackbuffer");
+		if(renderScale_ >= 1.0f)
+			return;
+
+		RHIEvent e("Upscale");
+
+		//Everything so far went into the top left corner of the backbuffer, stretch it over the whole window before the UI
+		TexturePtr scaled = AllocateAdditionalBuffers(rhi_->GetWidth(),rhi_->GetHeight(),rhi_->GetRGBAFormatNs(),false,true,true,false);
+		rhi_->ResolveToTexture(static_cast<Texture2DPtr>(scaled),GetRenderViewport(0));
+
+		rhi_->SetRenderTarget(0,(YumeTexture*)0);
+		for(unsigned i = 1; i < MAX_RENDERTARGETS; ++i)
+			rhi_->SetRenderTarget(i,(YumeRenderable*)0);
+		rhi_->SetViewport(IntRect(0,0,rhi_->GetWidth(),rhi_->GetHeight()));
+		rhi_->SetNoDepthStencil(true);
+		rhi_->SetBlendMode(BLEND_REPLACE);
+
+		YumeShaderVariation* triangle = rhi_->GetShader(VS,"LPV/fs_triangle","","fs_triangle_vs");
+		rhi_->SetShaders(triangle,rhi_->GetShader(PS,"Copy","Copy","ps_copy"));
+		rhi_->SetShaderParameter("resolution_scale",renderScale_);
+
+		YumeVector<TexturePtr>::type& textures = GetFreeTextures();
+		textures[0] = scaled;
+		rhi_->PSBindSRV(0,1,textures);
+
+		unsigned sampler = defaultPass_->GetSamplerByName("ShadowFilter").second;
+		unsigned samplers[2] ={0,sampler};
+		rhi_->BindSampler(PS,0,2,samplers);
+
+		GetFsTriangle()->Draw(rhi_);
+
+		rhi_->BindResetTextures(0,1);
+		rhi_->BindResetRenderTargets(1);
+
+		ReleaseAdditionalBuffer(scaled);
+	}
+
 	void YumeMiscRenderer::RenderReflectiveShadowMap(RenderCall* call)
 	{
+		YUME_PROFILE("YumeMiscRenderer::RenderReflectiveShadowMap");
 		if(GetGIEnabled() && call->IsShadowPass() && updateRsm_)
 		{
 			//Set RSM Render targets
@@ -1589,6 +1700,93 @@ namespace YumeEngine
 		}
 	}
 
+	void YumeMiscRenderer::UpdateShadowCascades()
+	{
+		Light* dirLight = static_cast<Light*>(scene_->GetDirectionalLight());
+		const DirectX::XMFLOAT4& dir = dirLight->GetDirection();
+
+		BoundingBox sceneBox(Vector3(bbMin.x,bbMin.y,bbMin.z),Vector3(bbMax.x,bbMax.y,bbMax.z));
+
+		//Without a shadow distance the cascades end where the scene does, not at the far clip
+		float nearClip = camera_->NearClip();
+		float farClip = camera_->FarClip();
+		if(shadowCascades_.GetShadowDistance() <= 0)
+			farClip = Max(nearClip,Min(farClip,(sceneBox.max_ - sceneBox.min_).Length()));
+
+		Frustum frustum;
+		frustum.Define(camera_->FieldOfView() * M_RADTODEG,camera_->AspectRatio(),1.0f,nearClip,farClip,ToMatrix3x4(camera_->WorldMatrix()));
+
+		shadowCascades_.Update(frustum,nearClip,farClip,Vector3(dir.x,dir.y,dir.z),sceneBox,scene_->GetChangeCount());
+
+		static const char* cascadeParams[MAX_SHADOW_CASCADES] ={"cascade_vp_tex0","cascade_vp_tex1","cascade_vp_tex2","cascade_vp_tex3"};
+		for(unsigned i = 0; i < shadowCascades_.GetNumCascades(); ++i)
+			defaultPass_->SetShaderParameter(cascadeParams[i],DirectX::XMMATRIX(shadowCascades_.GetTextureMatrix(i).Transpose().Data()));
+		defaultPass_->SetShaderParameter("num_cascades",Variant((float)shadowCascades_.GetNumCascades()));
+	}
+
+	void YumeMiscRenderer::RenderShadowCascades(RenderCall* call)
+	{
+		YUME_PROFILE("YumeMiscRenderer::RenderShadowCascades");
+
+		unsigned size = shadowCascades_.GetResolution();
+
+		rhi_->SetRenderTarget(0,call->GetOutput(0));
+		rhi_->SetDepthStencil((Texture2DPtr)call->GetDepthStencil());
+		rhi_->SetBlendMode(BLEND_REPLACE);
+		rhi_->SetColorWrite(true);
+		rhi_->SetDepthWrite(true);
+		rhi_->SetFillMode(FILL_SOLID);
+		rhi_->SetClipPlane(false);
+		rhi_->SetScissorTest(false);
+		rhi_->SetStencilTest(false);
+
+		YumeShaderVariation* triangle = rhi_->GetShader(VS,"LPV/fs_triangle","","fs_triangle_vs");
+		YumeShaderVariation* clear = rhi_->GetShader(PS,"ShadowCascade","","CascadeClearPs");
+
+		const SceneNodes::type& renderables = scene_->GetRenderables();
+
+		for(unsigned c = 0; c < shadowCascades_.GetNumCascades(); ++c)
+		{
+			//Cached cascades keep what they had in the atlas
+			if(!shadowCascades_.NeedsRender(c))
+				continue;
+
+			rhi_->SetViewport(IntRect((c % 2) * size,(c / 2) * size,(c % 2 + 1) * size,(c / 2 + 1) * size));
+
+			//Only this cascade's quarter of the atlas is cleared, the triangle sits on the far plane
+			rhi_->SetDepthTest(CMP_ALWAYS);
+			rhi_->SetShaders(triangle,clear,0);
+			rhi_->SetShaderParameter("resolution_scale",1.0f);
+			fullscreenTriangle_->Draw(rhi_);
+
+			rhi_->SetDepthTest(CMP_LESS);
+			rhi_->SetShaders(call->GetVs(),call->GetPs(),0);
+			rhi_->SetShaderParameter("vp",DirectX::XMMATRIX(shadowCascades_.GetCascade(c).ViewProj.Transpose().Data()));
+
+			for(int i=0; i < renderables.size(); ++i)
+			{
+				StaticModel* mesh = static_cast<StaticModel*>(renderables[i]);
+
+				//The box is in model space, same as RenderScene it is moved to the world before the test
+				const DirectX::XMFLOAT3& min = mesh->GetBbMin();
+				const DirectX::XMFLOAT3& max = mesh->GetBbMax();
+				BoundingBox box(Vector3(min.x,min.y,min.z),Vector3(max.x,max.y,max.z));
+				if(box.Size() != Vector3::ZERO && !shadowCascades_.IsCaster(c,box.Transformed(ToMatrix3x4(mesh->GetTransformation()))))
+					continue;
+
+				rhi_->SetShaderParameter("world",mesh->GetTransformation());
+
+				const YumeVector<SharedPtr<RenderBatch> >::type& batch = mesh->GetBatches();
+				for(int b = 0; b < batch.size(); ++b)
+					batch[b]->geo_->Draw(rhi_);
+			}
+
+			shadowCascades_.MarkRendered(c);
+		}
+
+		rhi_->BindResetRenderTargets(1);
+	}
+
 	void YumeMiscRenderer::SetSamplers(RenderCall* call)
 	{
 		if(call->HasVertexSampler())
@@ -1596,7 +1794,9 @@ namespace YumeEngine
 			unsigned num = call->GetNumVertexSamplers();
 			unsigned startIndex = 0;
 
-			YumeVector<unsigned>::type vsSamplers;
+			//Runs for every call each frame, the ids only live until they are bound
+			YumeFrameVector<unsigned>::type vsSamplers(FrameArenaSTLAllocator<unsigned>(gYume->pFrameArena.Get()));
+			vsSamplers.reserve(MAX_TEXTURE_UNITS);
 			for(int k=0; k < MAX_TEXTURE_UNITS; ++k)
 			{
 				unsigned samplerId = call->GetVertexSampler(k);
@@ -1615,7 +1815,8 @@ namespace YumeEngine
 		if(call->HasPixelSampler())
 		{
 			unsigned num = call->GetNumPixelSamplers();
-			YumeVector<unsigned>::type psSamplers;
+			YumeFrameVector<unsigned>::type psSamplers(FrameArenaSTLAllocator<unsigned>(gYume->pFrameArena.Get()));
+			psSamplers.reserve(MAX_TEXTURE_UNITS);
 			unsigned startIndex = M_MAX_UNSIGNED;
 
 			for(int k=0; k < MAX_TEXTURE_UNITS; ++k)
@@ -1678,7 +1879,7 @@ namespace YumeEngine
 		rhi_->ClearRenderTarget(1,CLEAR_COLOR);
 		rhi_->ClearRenderTarget(2,CLEAR_COLOR);
 
-		YumeVector<TexturePtr>::type textures = GetFreeTextures();
+		YumeVector<TexturePtr>::type& textures = GetFreeTextures();
 		textures[7] = lpvr_curr;
 		textures[8] = lpvg_curr;
 		textures[9] = lpvb_curr;
@@ -1704,12 +1905,13 @@ namespace YumeEngine
 		defaultPass_->EnableRenderCalls("RSM");
 		defaultPass_->EnableRenderCalls("RSMVoxelize");
 		defaultPass_->EnableRenderCalls("RSMInject");
+		defaultPass_->EnableRenderCalls("LPVPropagate");
 		updateRsm_ = true;
 	}
 
 	void YumeMiscRenderer::SetFloorRoughness(float f)
 	{
-		SceneNodes::type& renderables = scene_->GetRenderables();
+		const SceneNodes::type& renderables = scene_->GetRenderables();
 
 		SceneNode* floorNode = 0;
 		for(int i=0; i < renderables.size(); ++i)
@@ -1755,7 +1957,7 @@ namespace YumeEngine
 
 	void YumeMiscRenderer::RenderFullScreenTexture(const IntRect& rect,YumeTexture2D* overlaytexture)
 	{
-		YumeVector<TexturePtr>::type texture = GetFreeTextures();
+		YumeVector<TexturePtr>::type& texture = GetFreeTextures();
 		texture[10] = overlaytexture;
 		rhi_->PSBindSRV(10,1,texture);
 
@@ -1770,6 +1972,7 @@ namespace YumeEngine
 		rhi_->BindSampler(PS,0,2,samplers); //Standard
 
 		rhi_->SetShaders(triangle,overlay,0);
+		rhi_->SetShaderParameter("resolution_scale",renderScale_);
 		rhi_->SetNoDepthStencil(true);
 
 
@@ -1836,7 +2039,8 @@ namespace YumeEngine
 
 	void YumeMiscRenderer::RenderLights(RenderCall* call,TexturePtr t)
 	{
-		SceneNodes::type& renderables = scene_->GetLights();
+		YUME_PROFILE("YumeMiscRenderer::RenderLights");
+		const SceneNodes::type& renderables = scene_->GetLights();
 
 		TexturePtr target = call->GetOutput(0);
 		TexturePtr stencil = defaultPass_->GetTextureByName("LightDSV");
@@ -1932,16 +2136,16 @@ namespace YumeEngine
 			TexturePtr spec = defaultPass_->GetTextureByName("SCENE_SPECULAR");
 			TexturePtr ld = defaultPass_->GetTextureByName("SCENE_LINEARDEPTH");
 
-			YumeVector<TexturePtr>::type inputs = GetFreeTextures();
+			YumeVector<TexturePtr>::type& inputs = GetFreeTextures();
 
 			inputs[2] = colors;
 			inputs[3] = spec;
 			inputs[4] = normals;
 			inputs[5] = ld;
-			inputs[14] = cubemapRt_;
+			inputs[14] = GetEnvironmentMap();
 			rhi_->PSBindSRV(2,4,inputs);
 
-			SetGBufferShaderParameters(IntVector2(gYume->pRHI->GetWidth(),gYume->pRHI->GetHeight()),IntRect(0,0,gYume->pRHI->GetWidth(),gYume->pRHI->GetHeight()));
+			SetGBufferShaderParameters(IntVector2(gYume->pRHI->GetWidth(),gYume->pRHI->GetHeight()),GetRenderViewport(0));
 
 
 			if(light->GetType() == LT_POINT)
@@ -1966,23 +2170,38 @@ namespace YumeEngine
 		rhi_->SetBindReadOnlyDepthStencil(false);
 	}
 
-	void YumeMiscRenderer::RenderIntoCubemap()
+	void YumeMiscRenderer::RenderReflectionProbes()
 	{
-		//setup camera
+		YUME_PROFILE("YumeMiscRenderer::RenderReflectionProbes");
+
+		DirectX::XMFLOAT3 cameraPos;
+		DirectX::XMStoreFloat3(&cameraPos,camera_->Position());
+		reflectionProbes_.Update(Vector3(cameraPos.x,cameraPos.y,cameraPos.z),scene_->GetChangeCount());
+
+		if(!reflectionProbes_.GetNumFrameFaces())
+			return;
 
-		//Render cubemap
-		unsigned CubemapSize = 256;
-		rhi_->SetViewport(IntRect(0,0,CubemapSize,CubemapSize));
+		rhi_->SetViewport(IntRect(0,0,REFLECTION_PROBE_SIZE,REFLECTION_PROBE_SIZE));
 		rhi_->SetStencilTest(true,CMP_ALWAYS,OP_REF,OP_KEEP,OP_KEEP,OP_KEEP,1);
 
 		RHIEvent e("RenderCubemap");
 
-		for(int i=0; i < MAX_CUBEMAP_FACES; ++i)
+		unsigned placedProbe = M_MAX_UNSIGNED;
+		for(unsigned i=0; i < reflectionProbes_.GetNumFrameFaces(); ++i)
 		{
 			RHIEvent ev("RenderFace");
-			CubeMapFace cube = (CubeMapFace)i;
+			const ReflectionProbeFace& face = reflectionProbes_.GetFrameFace(i);
+			const ReflectionProbe& probe = reflectionProbes_.GetProbe(face.Probe);
+			CubeMapFace cube = face.Face;
 
-			YumeRenderable* target = cubemapRt_->GetRenderSurface(cube);
+			if(face.Probe != placedProbe)
+			{
+				PlaceCubemapCameras(probe.Position);
+				placedProbe = face.Probe;
+			}
+			YumeCamera* cam = cubemapCams_[cube];
+
+			YumeRenderable* target = probeCubes_[face.Probe]->GetRenderSurface(cube);
 
 			rhi_->SetRenderTarget(0,target);
 			rhi_->SetDepthStencil(cubemapDsv_);
@@ -1997,19 +2216,57 @@ namespace YumeEngine
 			unsigned samplers[2] ={0,sampler};
 			rhi_->BindSampler(PS,0,2,samplers); //Standard
 
-			SetCameraParameters(false,cubemapCams_[i]);
-			RenderScene();
+			//Only what the face sees
+			Frustum frustum = reflectionProbes_.GetFaceFrustum(face.Probe,cube,cam->NearClip(),cam->FarClip());
+
+			SetCameraParameters(false,cam);
+			RenderScene(false,&frustum);
+
+			RenderSky(target,cam);
+
+			reflectionProbes_.MarkRendered(face.Probe,cube);
+		}
+
+		//Rougher surfaces read the smaller mips, build them once a probe has all of its faces
+		for(unsigned i=0; i < reflectionProbes_.GetNumProbes(); ++i)
+		{
+			if(!reflectionProbes_.GetProbe(i).NeedsFilter)
+				continue;
+
+			rhi_->GenerateMips(probeCubes_[i]);
+			reflectionProbes_.MarkFiltered(i);
+		}
+	}
+
+	void YumeMiscRenderer::UpdateOcclusion()
+	{
+		YUME_PROFILE("YumeMiscRenderer::UpdateOcclusion");
 
-			RenderSky(target,cubemapCams_[i]);
+		occlusionBuffer_.SetView(ToMatrix4(camera_->ViewMatrix() * camera_->ProjectionMatrix()));
+		occlusionBuffer_.Clear();
+
+		const SceneNodes::type& renderables = scene_->GetRenderables();
+		for(int i=0; i < renderables.size(); ++i)
+		{
+			StaticModel* mesh = static_cast<StaticModel*>(renderables[i]);
+			if(!mesh->IsOccluder())
+				continue;
+
+			const YumePodVector<Vector3>::type& vertices = mesh->GetOccluderVertices();
+			const YumePodVector<unsigned>::type& indices = mesh->GetOccluderIndices();
+			occlusionBuffer_.AddOccluder(&vertices[0],vertices.size(),&indices[0],indices.size(),ToMatrix3x4(mesh->GetTransformation()));
 		}
 
-		rhi_->GenerateMips(cubemapRt_);
-		//
+		occlusionBuffer_.Rasterize();
+		numOccluded_ = 0;
 	}
 
-	void YumeMiscRenderer::RenderScene()
+	void YumeMiscRenderer::RenderScene(bool occlusionCull,const Frustum* frustum)
 	{
-		SceneNodes::type& renderables = scene_->GetRenderables();
+		YUME_PROFILE("YumeMiscRenderer::RenderScene");
+		const SceneNodes::type& renderables = scene_->GetRenderables();
+
+		occlusionCull = occlusionCull && occlusionCulling_;
 
 		for(int i=0; i < renderables.size(); ++i)
 		{
@@ -2019,11 +2276,37 @@ namespace YumeEngine
 
 			const YumeVector<SharedPtr<RenderBatch> >::type& batch = mesh->GetBatches();
 
+			Matrix3x4 world;
+			if(occlusionCull || frustum)
+				world = ToMatrix3x4(node->GetTransformation());
+
 			for(int b = 0; b < batch.size(); ++b)
 			{
 				YumeGeometry* geometry = batch[b]->geo_;
 				Material* material = batch[b]->material_;
 
+				if(occlusionCull || frustum)
+				{
+					const DirectX::XMFLOAT3& geoMin = geometry->GetBbMin();
+					const DirectX::XMFLOAT3& geoMax = geometry->GetBbMax();
+					BoundingBox box(Vector3(geoMin.x,geoMin.y,geoMin.z),Vector3(geoMax.x,geoMax.y,geoMax.z));
+
+					//Geometry without a box is never culled
+					if(box.Size() != Vector3::ZERO)
+					{
+						BoundingBox worldBox = box.Transformed(world);
+
+						if(frustum && frustum->IsInsideFast(worldBox) == OUTSIDE)
+							continue;
+
+						if(occlusionCull && !occlusionBuffer_.IsVisible(worldBox))
+						{
+							++numOccluded_;
+							continue;
+						}
+					}
+				}
+
 				DirectX::XMFLOAT3 max = mesh->GetBbMax();
 				DirectX::XMFLOAT3 min = mesh->GetBbMin();
 
@@ -2046,7 +2329,8 @@ namespace YumeEngine
 
 				float fsize = bbSize.x;
 
-				if(!disableFrustumCull_)
+				//The planes are the main camera's, a given frustum already culled the batch
+				if(!disableFrustumCull_ && !frustum)
 				{
 					if(!CheckBB(bbCenter.x,bbCenter.y,bbCenter.z,len))
 						continue;
@@ -2089,7 +2373,7 @@ namespace YumeEngine
 					TexturePtr alpha = material->GetTexture(MT_ALPHA);
 					TexturePtr roughness = material->GetTexture(MT_ROUGHNESS);
 
-					YumeVector<TexturePtr>::type textures = GetFreeTextures();
+					YumeVector<TexturePtr>::type& textures = GetFreeTextures();
 
 					textures[MT_DIFFUSE] = diffuse;
 					textures[MT_NORMAL] = normal;
@@ -2109,14 +2393,14 @@ namespace YumeEngine
 		}
 	}
 
-	YumeVector<TexturePtr>::type YumeMiscRenderer::GetFreeTextures()
+	YumeVector<TexturePtr>::type& YumeMiscRenderer::GetFreeTextures()
 	{
-		YumeVector<TexturePtr>::type textures;
+		//Reuses the same storage every pass instead of allocating a table per call
+		freeTextures_.resize(MAX_TEXTURE_UNITS);
+		for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+			freeTextures_[i] = 0;
 
-		for(int i=0; i < 16; ++i)
-			textures.push_back(0);
-
-		return textures;
+		return freeTextures_;
 	}
 
 	void YumeMiscRenderer::SetGBufferShaderParameters(const IntVector2& texSize,const IntRect& viewRect)
@@ -2352,6 +2636,21 @@ namespace YumeEngine
 		Light* dirLight = static_cast<Light*>(scene_->GetDirectionalLight());
 		dirLight->UpdateLightParameters();
 
+		if(giEnabled_)
+		{
+			//Static GI only updates when asked to, dynamic GI whenever what it was injected from changed
+			const DirectX::XMFLOAT4& pos = dirLight->GetPosition();
+			const DirectX::XMFLOAT4& dir = dirLight->GetDirection();
+			bool changed = giVolume_->GetUpdate().CheckInject(Vector3(pos.x,pos.y,pos.z),Vector3(dir.x,dir.y,dir.z),
+				dirLight->GetColor(),scene_->GetChangeCount());
+
+			if(changed && (gi_ == Dyn_Lpv || gi_ == Dyn_Svo))
+				UpdateGI();
+		}
+
+		if(cascadedShadows_)
+			UpdateShadowCascades();
+
 		//abort variant matrices
 		defaultPass_->SetShaderParameter("scene_dim_max",XMFLOAT4(GetMaxBb().x,GetMaxBb().y,GetMaxBb().z,1.0f));
 		defaultPass_->SetShaderParameter("scene_dim_min",XMFLOAT4(GetMinBb().x,GetMinBb().y,GetMinBb().z,1.0f));
@@ -2381,8 +2680,7 @@ namespace YumeEngine
 	void YumeMiscRenderer::SetLPVFluxAmp(float f)
 	{
 		giParams_.LPVFlux = f;
-		updateRsm_ = true;
-		defaultPass_->EnableRenderCalls("RSM");
+		UpdateGI();
 	}
 
 	void YumeMiscRenderer::SetLPVPos(float x,float y,float z)
@@ -2398,8 +2696,7 @@ namespace YumeEngine
 	void YumeMiscRenderer::SetLPVNumberIterations(int num)
 	{
 		num_propagations_ = num;
-		updateRsm_ = true;
-		defaultPass_->EnableRenderCalls("RSM");
+		UpdateGI();
 	}
 
 	void YumeMiscRenderer::SetMainLight()
@@ -2427,6 +2724,29 @@ namespace YumeEngine
 
 		rhi_->SetShaderParameter("time_delta",timeStep);
 		rhi_->SetShaderParameter("time",totalTime);
+		//Wraps so it stays exact as a float, the noise patterns repeat well before that
+		rhi_->SetShaderParameter("frame_index",(float)(frameIndex_ & 1023));
+	}
+
+	void YumeMiscRenderer::UpdateFrameCamera()
+	{
+		prevViewProj_ = viewProj_;
+		prevCameraPos_ = frameCameraPos_;
+		prevRenderScale_ = frameRenderScale_;
+
+		XMStoreFloat4x4(&viewProj_,camera_->ViewMatrix() * camera_->ProjectionMatrix());
+		XMStoreFloat3(&frameCameraPos_,camera_->Position());
+		frameRenderScale_ = renderScale_;
+
+		//No last frame yet, the history starts empty anyway
+		if(!frameIndex_)
+		{
+			prevViewProj_ = viewProj_;
+			prevCameraPos_ = frameCameraPos_;
+			prevRenderScale_ = frameRenderScale_;
+		}
+
+		++frameIndex_;
 	}
 
 	void YumeMiscRenderer::UpdateMeshBb(SceneNode* mesh,const DirectX::XMMATRIX& world)
@@ -2497,6 +2817,11 @@ namespace YumeEngine
 		gYume->pRHI->SetShaderParameter("camera_pos",cameraPos);
 		gYume->pRHI->SetShaderParameter("camera_pos_ps",cameraPos); // ¯\_(ツ)_/¯
 		gYume->pRHI->SetShaderParameter("z_far",zFar);
+		gYume->pRHI->SetShaderParameter("resolution_scale",renderScale_);
+		gYume->pRHI->SetShaderParameter("prev_vp",XMLoadFloat4x4(&prevViewProj_));
+		gYume->pRHI->SetShaderParameter("prev_camera_pos",prevCameraPos_);
+		gYume->pRHI->SetShaderParameter("prev_resolution_scale",prevRenderScale_);
+		gYume->pRHI->SetShaderParameter("current_resolution_scale",frameRenderScale_);
 
 		DirectX::XMMATRIX tex
 			(
@@ -30,8 +30,13 @@
 #include "RenderCall.h"
 #include "LightPropagationVolume.h"
 #include "SparseVoxelOctree.h"
+#include "ShadowCascades.h"
+#include "OcclusionBuffer.h"
+#include "ReflectionProbes.h"
 
 #include "RenderPass.h"
+#include "YumeRenderTargetPool.h"
+#include "YumeDynamicResolution.h"
 //----------------------------------------------------------------------------
 namespace YumeEngine
 {
@@ -72,6 +77,7 @@ namespace YumeEngine
 		//New era starts here
 		void ApplyRendererFlags(RenderCallPtr call);
 		void RenderReflectiveShadowMap(RenderCall* call);
+		void RenderShadowCascades(RenderCall* call);
 
 		bool GetGIEnabled() { return giEnabled_; }
 
@@ -93,6 +99,8 @@ namespace YumeEngine
 		unsigned curr_;
 		unsigned next_;
 		unsigned num_propagations_;
+		//Static LPV lighting is loaded from here, or baked to it on the first frame
+		YumeString lpvBakeFile_;
 
 		RenderPass* GetDefaultPass() const { return defaultPass_; }
 		void SetDefaultPass(SharedPtr<RenderPass> p) { defaultPass_ = p; }
@@ -118,12 +126,14 @@ namespace YumeEngine
 		void PrepareRendering();
 		TexturePtr AllocateAdditionalBuffers(int width,int height,unsigned format,bool cubemap,bool filtered,bool srgb,bool mips,
 		unsigned persistentKey = 0);
+		void ReleaseAdditionalBuffer(TexturePtr buffer);
 
 		void BlitRenderTarget(TexturePtr source,TexturePtr dest,bool depthWrite);
 
 		DirectX::XMVECTOR frustumPlanes_[6];
 
-		YumeVector<TexturePtr>::type GetFreeTextures();
+		//Returns the renderer's slot table cleared to MAX_TEXTURE_UNITS nulls, bind it before asking again
+		YumeVector<TexturePtr>::type& GetFreeTextures();
 
 		bool disableFrustumCull_;
 
@@ -139,30 +149,47 @@ namespace YumeEngine
 
 		bool CheckPingPong(RenderCall* call,unsigned index);
 
-		TexturePtr viewportTextures_[3];
+		TexturePtr viewportTextures_[2];
 		TexturePtr currentViewportTexture_;
-		YumeMap<long long, YumeVector<SharedPtr<YumeTexture> >::type >::type screenBuffers_;
-		YumeMap<long long, unsigned>::type screenBufferAllocations_;
+		SharedPtr<YumeRenderTargetPool> renderTargetPool_;
+		YumeRenderTargetPool* GetRenderTargetPool() const { return renderTargetPool_; }
 
 		void RemoveUnusedBuffers();
 
+		SharedPtr<YumeDynamicResolution> dynamicResolution_;
+		YumeDynamicResolution* GetDynamicResolution() const { return dynamicResolution_; }
+		float GetRenderScale() const { return renderScale_; }
+
+		//Viewport to use when rendering into target, null means the backbuffer
+		IntRect GetRenderViewport(TexturePtr target) const;
+		void UpscaleToBackbuffer();
+		float renderScale_;
+
 		YumeRenderable* currentRenderTarget_;
 
 		SharedPtr<YumeGeometry> skyGeometry_;
 
 		void SetFloorRoughness(float f);
 
-		void RenderIntoCubemap();
-		void CreateCubemapCameras(float x,float y,float z);
-		bool updateCubemap_;
+		//Renders the probe faces scheduled for this frame
+		void RenderReflectionProbes();
+		void PlaceCubemapCameras(const Vector3& center);
+		//Closest probe around the camera, the scene wide one when it is in none of the others
+		YumeTextureCube* GetEnvironmentMap() const;
+
+		//M_MAX_UNSIGNED when all MAX_REFLECTION_PROBES are in use
+		unsigned AddReflectionProbe(const Vector3& position,float radius,bool dynamic);
+		ReflectionProbes& GetReflectionProbes() { return reflectionProbes_; }
 
 		YumeVector<YumeCamera*>::type cubemapCams_;
 
-		SharedPtr<YumeTextureCube> cubemapRt_;
+		ReflectionProbes reflectionProbes_;
+		SharedPtr<YumeTextureCube> probeCubes_[MAX_REFLECTION_PROBES];
 		SharedPtr<YumeTexture2D> cubemapDsv_;
 
 		void UpdateCamera(float dt);
 		void UpdateLights();
+		void UpdateShadowCascades();
 
 		float cameraMoveSpeed_;
 		void SetCameraMoveSpeed(float f) {cameraMoveSpeed_ = f; };
@@ -171,11 +198,18 @@ namespace YumeEngine
 		EnvironmentMapType envType_;
 
 		void SetFrustumCulling(bool b) { disableFrustumCull_ = !b; }
+		void SetOcclusionCulling(bool b) { occlusionCulling_ = b; }
+		//Batches the occlusion buffer skipped this frame
+		unsigned GetNumOccluded() const { return numOccluded_; }
+		const OcclusionBuffer& GetOcclusionBuffer() const { return occlusionBuffer_; }
  		//~
 
 		void Render();
 		void RenderSky(YumeRenderable* target,YumeCamera* cam);
-		void RenderScene();
+		//Main view passes cull against the occlusion buffer, the light and cubemap views can not.
+		//frustum culls the batches by their world box, for views other than the camera's.
+		void RenderScene(bool occlusionCull = false,const Frustum* frustum = 0);
+		void UpdateOcclusion();
 
 		void RenderFullScreenTexture(const IntRect& rect,YumeTexture2D*);
 
@@ -220,8 +254,27 @@ namespace YumeEngine
 	private:
 		unsigned rsmSize;
 
+		ShadowCascades shadowCascades_;
+		bool cascadedShadows_;
+
+		OcclusionBuffer occlusionBuffer_;
+		bool occlusionCulling_;
+		unsigned numOccluded_;
+
+		//Camera of this and the last frame, the temporal passes reproject their history with it
+		void UpdateFrameCamera();
+		DirectX::XMFLOAT4X4 viewProj_;
+		DirectX::XMFLOAT4X4 prevViewProj_;
+		DirectX::XMFLOAT3 frameCameraPos_;
+		DirectX::XMFLOAT3 prevCameraPos_;
+		//Dynamic resolution scale the history was rendered at
+		float frameRenderScale_;
+		float prevRenderScale_;
+		unsigned frameIndex_;
+
 	private: //Renderer stuff
 		YumeRHI* rhi_;
+		YumeVector<TexturePtr>::type freeTextures_;
 		SharedPtr<YumePostProcess> pp_;
 
 		SharedPtr<RenderPass> defaultPass_;
@@ -29,6 +29,7 @@
 
 #include "YumeTexture3D.h"
 #include "RenderPass.h"
+#include "Core/YumeProfiler.h"
 
 namespace YumeEngine
 {
@@ -138,6 +139,7 @@ namespace YumeEngine
 
 	void YumePostProcess::Render()
 	{
+		YUME_PROFILE("YumePostProcess::Render");
 		TexturePtr target = misc_->GetDefaultPass()->GetTextureByName("SSAOTarget");
 		gYume->pRHI->GenerateMips(target);
 
@@ -148,7 +150,7 @@ namespace YumeEngine
 
 		gYume->pRHI->SetViewport(IntRect(0,0,1,1));
 
-		auto textures = gYume->pRenderer->GetFreeTextures();
+		YumeVector<TexturePtr>::type& textures = gYume->pRenderer->GetFreeTextures();
 		textures[11] = adaptadLuminanceRt_[!current];
 		gYume->pRHI->PSBindSRV(11,1,textures);
 
@@ -161,7 +163,7 @@ namespace YumeEngine
 			Bloom(target);
 
 
-		auto textures2 = gYume->pRenderer->GetFreeTextures();
+		YumeVector<TexturePtr>::type& textures2 = gYume->pRenderer->GetFreeTextures();
 		textures2[11] = adaptadLuminanceRt_[current];
 		textures2[12] = bloomFull_;
 		gYume->pRHI->PSBindSRV(11,2,textures2);
@@ -200,6 +202,7 @@ namespace YumeEngine
 
 	void YumePostProcess::Bloom(TexturePtr frontbuffer)
 	{
+		YUME_PROFILE("YumePostProcess::Bloom");
 		RHIEvent e("Bloom Pass");
 
 		SetViewport(bloomFull_);
@@ -249,6 +252,7 @@ namespace YumeEngine
 
 	void YumePostProcess::DoF(TexturePtr in,TexturePtr out)
 	{
+		YUME_PROFILE("YumePostProcess::DoF");
 		//RHIEvent e("DoF");
 
 		//if(dof_enabled)
@@ -294,6 +298,7 @@ namespace YumeEngine
 
 	void YumePostProcess::Godrays(TexturePtr in,TexturePtr out)
 	{
+		YUME_PROFILE("YumePostProcess::Godrays");
 		//RHIEvent e("Godrays");
 
 		//if(godrays_enabled)
@@ -349,7 +354,7 @@ namespace YumeEngine
 
 		YumeGeometry* fs = misc_->GetFsTriangle();
 
-		auto textures = gYume->pRenderer->GetFreeTextures();
+		YumeVector<TexturePtr>::type& textures = gYume->pRenderer->GetFreeTextures();
 		textures[10] = in;
 		gYume->pRHI->PSBindSRV(10,1,textures);
 
@@ -374,6 +379,7 @@ namespace YumeEngine
 
 	void YumePostProcess::SSAO(TexturePtr target)
 	{
+		YUME_PROFILE("YumePostProcess::SSAO");
 		RHIEvent e("SSAO Pass");
 		
 	}
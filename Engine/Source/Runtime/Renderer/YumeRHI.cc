@@ -28,6 +28,7 @@
 
 #include "Renderer/YumeShaderVariation.h"
 #include "Renderer/YumeConstantBuffer.h"
+#include "Renderer/YumeRHICommandBuffer.h"
 #include "Renderer/YumeTexture.h"
 
 #include "YumeRenderable.h"
@@ -262,6 +263,14 @@ namespace YumeEngine
 		maxScratchBufferRequest_ = 0;
 	}
 
+	void YumeRHI::ExecuteCommandBuffer(const YumeRHICommandBuffer& buffer)
+	{
+		if(!buffer.IsClosed())
+			YUMELOG_WARN("Executing a command buffer that is still being recorded");
+
+		buffer.Execute(this);
+	}
+
 
 	void YumeRHI::ResetRenderTargets()
 	{
@@ -38,6 +38,9 @@
 #include "Renderer/YumeShaderVariation.h"
 #include "Renderer/YumeInputLayout.h"
 #include "Renderer/YumeConstantBuffer.h"
+#include "Renderer/YumeRHIStateCache.h"
+#include "Renderer/YumeConstantRingAllocator.h"
+#include "Renderer/YumeGpuTimer.h"
 
 #ifdef _WIN32
 #include <DirectXMath.h>
@@ -59,6 +62,7 @@ namespace YumeEngine
 	class YumeTexture;
 	class YumeIndexBuffer;
 	class YumeTextureCube;
+	class YumeRHICommandBuffer;
 	class YumeRHI;
 
 	struct ScratchBuffer
@@ -101,7 +105,7 @@ namespace YumeEngine
 
 		//
 		virtual void							BindSampler(ShaderType type,unsigned start,unsigned count,unsigned* samplers) { };
-		virtual void							PSBindSRV(unsigned start,unsigned count,YumeVector<YumeTexture*>::type textures) {};
+		virtual void							PSBindSRV(unsigned start,unsigned count,const YumeVector<YumeTexture*>::type& textures) {};
 		virtual void							VSBindSRV(unsigned start,unsigned count,YumeTexture** textures) {};
 		virtual void							BindBackbuffer() { };
 		virtual void							CreateStandardSampler() { };
@@ -270,6 +274,9 @@ namespace YumeEngine
 		void									FreeScratchBuffer(void* buffer);
 		void									CleanupScratchBuffers();
 
+		//Replays a closed command buffer, render thread only
+		void									ExecuteCommandBuffer(const YumeRHICommandBuffer& buffer);
+
 		void 									SetRenderTarget(unsigned index,YumeTexture* texture);
 		void 									SetTextureAnisotropy(unsigned level);
 		void									SetDefaultTextureFilterMode(TextureFilterMode mode);
@@ -295,6 +302,10 @@ namespace YumeEngine
 		bool									GetFlushGPU() const { return flushGpu_; }
 		unsigned								GetNumPrimitives() const { return numPrimitives_; }
 		unsigned								GetNumBatches() const { return numBatches_; }
+		const RHIStateStats&					GetStateStats() const { return stateCache_.GetFrameStats(); }
+		const RHIStateStats&					GetTotalStateStats() const { return stateCache_.GetStats(); }
+		const ConstantRingStats&				GetConstantRingStats() const { return constantRing_.GetStats(); }
+		YumeGpuTimer&							GetGpuTimer() { return gpuTimer_; }
 		int										GetWidth() const { return windowWidth_; }
 		int										GetHeight() const { return windowHeight_; }
 		unsigned								GetHiresShadowMapFormat() const { return hiresShadowMapFormat_; }
@@ -349,6 +360,11 @@ namespace YumeEngine
 		int										numPrimitives_;
 		int										numBatches_;
 
+		YumeRHIStateCache						stateCache_;
+		YumeConstantRingAllocator				constantRing_;
+		//Timing is off until the backend sets a timestamp source
+		YumeGpuTimer							gpuTimer_;
+
 	protected:
 		Mutex							gpuResourceMutex_;
 		GpuResourceVector::type			gpuResources_;
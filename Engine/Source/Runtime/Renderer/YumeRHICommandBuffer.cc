@@ -0,0 +1,820 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeRHICommandBuffer.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeRHICommandBuffer.h"
+#include "YumeRHI.h"
+
+#include "Core/YumeStreamWriter.h"
+#include "Math/YumeVector4.h"
+#include "Math/YumeMatrix3x4.h"
+#include "Math/YumeMatrix4.h"
+
+#include "Logging/logging.h"
+
+namespace YumeEngine
+{
+	static const unsigned COMMAND_STREAM_VERSION = 1;
+
+	enum ParameterKind
+	{
+		PARAM_FLOATS = 0,
+		PARAM_VECTOR4,
+		PARAM_MATRIX3X4,
+		PARAM_MATRIX4
+	};
+
+	//Floats a typed parameter holds, 0 for PARAM_FLOATS and unknown kinds
+	static unsigned GetParameterSize(unsigned kind)
+	{
+		switch(kind)
+		{
+		case PARAM_VECTOR4: return 4;
+		case PARAM_MATRIX3X4: return 12;
+		case PARAM_MATRIX4: return 16;
+		default: return 0;
+		}
+	}
+
+	struct CommandHeader
+	{
+		unsigned Type;
+		//Payload size in bytes, the header is not included
+		unsigned Size;
+	};
+
+	struct SetShadersCommand { YumeShaderVariation* Shaders[3]; };
+	struct SetStateCommand { unsigned Value; };
+	struct SetDepthBiasCommand { float ConstantBias; float SlopeScaledBias; };
+	struct SetViewportCommand { IntRect Rect; };
+	struct SetRenderTargetCommand { unsigned Index; YumeRenderable* Target; };
+	struct SetTextureCommand { unsigned Index; YumeTexture* Texture; };
+	//Followed by Count resource pointers or sampler ids
+	struct BindRangeCommand { unsigned Type; unsigned Start; unsigned Count; };
+	struct SetResourceCommand { void* Resource; };
+	//Followed by Count floats
+	struct SetParameterCommand { unsigned Param; unsigned Kind; unsigned Count; };
+	struct ClearCommand { unsigned Flags; float Color[4]; float Depth; unsigned Stencil; };
+	struct DrawCommand { unsigned Type; unsigned Start; unsigned Count; unsigned MinVertex; unsigned VertexCount; unsigned InstanceCount; };
+	struct ResolveCommand { YumeTexture2D* Destination; IntRect Viewport; };
+
+	//Minimum payload size of each command, variable sized ones append data after it
+	static const unsigned commandSizes[] =
+	{
+		sizeof(SetShadersCommand),
+		sizeof(SetStateCommand),
+		sizeof(SetStateCommand),
+		sizeof(SetStateCommand),
+		sizeof(SetDepthBiasCommand),
+		sizeof(SetStateCommand),
+		sizeof(SetStateCommand),
+		sizeof(SetStateCommand),
+		sizeof(SetViewportCommand),
+		sizeof(SetRenderTargetCommand),
+		sizeof(SetResourceCommand),
+		sizeof(SetTextureCommand),
+		sizeof(BindRangeCommand),
+		sizeof(BindRangeCommand),
+		sizeof(BindRangeCommand),
+		sizeof(SetResourceCommand),
+		sizeof(SetResourceCommand),
+		sizeof(SetParameterCommand),
+		sizeof(ClearCommand),
+		sizeof(DrawCommand),
+		sizeof(DrawCommand),
+		sizeof(DrawCommand),
+		sizeof(ResolveCommand)
+	};
+
+	static const char* commandNames[] =
+	{
+		"SetShaders",
+		"SetBlendMode",
+		"SetColorWrite",
+		"SetCullMode",
+		"SetDepthBias",
+		"SetDepthTest",
+		"SetDepthWrite",
+		"SetFillMode",
+		"SetViewport",
+		"SetRenderTarget",
+		"SetDepthStencil",
+		"SetTexture",
+		"PSBindSRV",
+		"VSBindSRV",
+		"BindSampler",
+		"SetVertexBuffer",
+		"SetIndexBuffer",
+		"SetShaderParameter",
+		"Clear",
+		"Draw",
+		"DrawIndexed",
+		"DrawInstanced",
+		"ResolveToTexture"
+	};
+
+	//Hands out ids to resources in order of first use
+	class ResourceIdMap
+	{
+	public:
+		unsigned GetId(const void* resource)
+		{
+			if(!resource)
+				return 0;
+
+			YumeMap<const void*,unsigned>::iterator i = ids_.find(resource);
+			if(i != ids_.end())
+				return i->second;
+
+			unsigned id = ids_.size() + 1;
+			ids_[resource] = id;
+			return id;
+		}
+
+	private:
+		YumeMap<const void*,unsigned>::type ids_;
+	};
+
+	YumeRHICommandBuffer::YumeRHICommandBuffer()
+		: numCommands_(0),
+		numDraws_(0),
+		closed_(false)
+	{
+	}
+
+	YumeRHICommandBuffer::~YumeRHICommandBuffer()
+	{
+	}
+
+	void YumeRHICommandBuffer::Reset()
+	{
+		data_.clear();
+		numCommands_ = 0;
+		numDraws_ = 0;
+		closed_ = false;
+	}
+
+	void YumeRHICommandBuffer::Close()
+	{
+		closed_ = true;
+	}
+
+	void* YumeRHICommandBuffer::Allocate(RHICommandType type,unsigned size)
+	{
+#if YUME_DEBUG_MODE
+		if(closed_)
+		{
+			YUMELOG_ERROR("Recording " << commandNames[type] << " into a closed command buffer");
+			return 0;
+		}
+#endif
+
+		CommandHeader header;
+		header.Type = type;
+		header.Size = size;
+
+		unsigned offset = data_.size();
+		data_.resize(offset + sizeof(CommandHeader) + size);
+		memcpy(&data_[offset],&header,sizeof(CommandHeader));
+
+		++numCommands_;
+		return &data_[offset + sizeof(CommandHeader)];
+	}
+
+	void YumeRHICommandBuffer::Push(RHICommandType type,const void* command,unsigned size)
+	{
+		void* dest = Allocate(type,size);
+		if(dest)
+			memcpy(dest,command,size);
+	}
+
+	void YumeRHICommandBuffer::SetShaders(YumeShaderVariation* vs,YumeShaderVariation* ps,YumeShaderVariation* gs)
+	{
+		SetShadersCommand command;
+		command.Shaders[VS] = vs;
+		command.Shaders[PS] = ps;
+		command.Shaders[GS] = gs;
+		Push(RHICMD_SET_SHADERS,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetBlendMode(BlendMode mode)
+	{
+		SetStateCommand command = { (unsigned)mode };
+		Push(RHICMD_SET_BLEND_MODE,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetColorWrite(bool enable)
+	{
+		SetStateCommand command = { enable ? 1U : 0U };
+		Push(RHICMD_SET_COLOR_WRITE,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetCullMode(CullMode mode)
+	{
+		SetStateCommand command = { (unsigned)mode };
+		Push(RHICMD_SET_CULL_MODE,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetDepthBias(float constantBias,float slopeScaledBias)
+	{
+		SetDepthBiasCommand command = { constantBias,slopeScaledBias };
+		Push(RHICMD_SET_DEPTH_BIAS,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetDepthTest(CompareMode mode)
+	{
+		SetStateCommand command = { (unsigned)mode };
+		Push(RHICMD_SET_DEPTH_TEST,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetDepthWrite(bool enable)
+	{
+		SetStateCommand command = { enable ? 1U : 0U };
+		Push(RHICMD_SET_DEPTH_WRITE,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetFillMode(FillMode mode)
+	{
+		SetStateCommand command = { (unsigned)mode };
+		Push(RHICMD_SET_FILL_MODE,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetViewport(const IntRect& rect)
+	{
+		SetViewportCommand command;
+		command.Rect = rect;
+		Push(RHICMD_SET_VIEWPORT,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetRenderTarget(unsigned index,YumeRenderable* renderTarget)
+	{
+		SetRenderTargetCommand command = { index,renderTarget };
+		Push(RHICMD_SET_RENDER_TARGET,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetDepthStencil(YumeRenderable* depthStencil)
+	{
+		SetResourceCommand command = { depthStencil };
+		Push(RHICMD_SET_DEPTH_STENCIL,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetTexture(unsigned index,YumeTexture* texture)
+	{
+		SetTextureCommand command = { index,texture };
+		Push(RHICMD_SET_TEXTURE,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::PSBindSRV(unsigned start,unsigned count,const YumeVector<YumeTexture*>::type& textures)
+	{
+		//PSBindSRV indexes textures by slot, keep every slot from start on
+		unsigned end = textures.size();
+		if(end > MAX_TEXTURE_UNITS)
+			end = MAX_TEXTURE_UNITS;
+		unsigned numTextures = end > start ? end - start : 0;
+
+		BindRangeCommand command = { PS,start,numTextures };
+		unsigned char* dest = (unsigned char*)Allocate(RHICMD_PS_BIND_SRV,sizeof command + numTextures * sizeof(YumeTexture*));
+		if(!dest)
+			return;
+
+		memcpy(dest,&command,sizeof command);
+		if(numTextures)
+			memcpy(dest + sizeof command,&textures[start],numTextures * sizeof(YumeTexture*));
+	}
+
+	void YumeRHICommandBuffer::VSBindSRV(unsigned start,unsigned count,YumeTexture** textures)
+	{
+		if(count > MAX_TEXTURE_UNITS)
+			count = MAX_TEXTURE_UNITS;
+
+		BindRangeCommand command = { VS,start,count };
+		unsigned char* dest = (unsigned char*)Allocate(RHICMD_VS_BIND_SRV,sizeof command + count * sizeof(YumeTexture*));
+		if(!dest)
+			return;
+
+		memcpy(dest,&command,sizeof command);
+		if(count)
+			memcpy(dest + sizeof command,textures,count * sizeof(YumeTexture*));
+	}
+
+	void YumeRHICommandBuffer::BindSampler(ShaderType type,unsigned start,unsigned count,unsigned* samplers)
+	{
+		if(count > MAX_TEXTURE_UNITS)
+			count = MAX_TEXTURE_UNITS;
+
+		BindRangeCommand command = { (unsigned)type,start,count };
+		unsigned char* dest = (unsigned char*)Allocate(RHICMD_BIND_SAMPLER,sizeof command + count * sizeof(unsigned));
+		if(!dest)
+			return;
+
+		memcpy(dest,&command,sizeof command);
+		if(count)
+			memcpy(dest + sizeof command,samplers,count * sizeof(unsigned));
+	}
+
+	void YumeRHICommandBuffer::SetVertexBuffer(YumeVertexBuffer* buffer)
+	{
+		SetResourceCommand command = { buffer };
+		Push(RHICMD_SET_VERTEX_BUFFER,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::SetIndexBuffer(YumeIndexBuffer* buffer)
+	{
+		SetResourceCommand command = { buffer };
+		Push(RHICMD_SET_INDEX_BUFFER,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::PushParameter(YumeHash param,unsigned kind,const float* data,unsigned count)
+	{
+		SetParameterCommand command = { param.Value(),kind,count };
+		unsigned char* dest = (unsigned char*)Allocate(RHICMD_SET_SHADER_PARAMETER,sizeof command + count * sizeof(float));
+		if(!dest)
+			return;
+
+		memcpy(dest,&command,sizeof command);
+		if(count)
+			memcpy(dest + sizeof command,data,count * sizeof(float));
+	}
+
+	void YumeRHICommandBuffer::SetShaderParameter(YumeHash param,const float* data,unsigned count)
+	{
+		PushParameter(param,PARAM_FLOATS,data,count);
+	}
+
+	void YumeRHICommandBuffer::SetShaderParameter(YumeHash param,const Vector4& vector)
+	{
+		PushParameter(param,PARAM_VECTOR4,vector.Data(),4);
+	}
+
+	void YumeRHICommandBuffer::SetShaderParameter(YumeHash param,const Matrix3x4& matrix)
+	{
+		PushParameter(param,PARAM_MATRIX3X4,matrix.Data(),12);
+	}
+
+	void YumeRHICommandBuffer::SetShaderParameter(YumeHash param,const Matrix4& matrix)
+	{
+		PushParameter(param,PARAM_MATRIX4,matrix.Data(),16);
+	}
+
+	void YumeRHICommandBuffer::Clear(unsigned flags,const YumeColor& color,float depth,unsigned stencil)
+	{
+		ClearCommand command;
+		command.Flags = flags;
+		command.Color[0] = color.r_;
+		command.Color[1] = color.g_;
+		command.Color[2] = color.b_;
+		command.Color[3] = color.a_;
+		command.Depth = depth;
+		command.Stencil = stencil;
+		Push(RHICMD_CLEAR,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount)
+	{
+		DrawCommand command = { (unsigned)type,vertexStart,vertexCount,0,vertexCount,1 };
+		Push(RHICMD_DRAW,&command,sizeof command);
+		++numDraws_;
+	}
+
+	void YumeRHICommandBuffer::Draw(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount)
+	{
+		DrawCommand command = { (unsigned)type,indexStart,indexCount,minVertex,vertexCount,1 };
+		Push(RHICMD_DRAW_INDEXED,&command,sizeof command);
+		++numDraws_;
+	}
+
+	void YumeRHICommandBuffer::DrawInstanced(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount,unsigned instanceCount)
+	{
+		DrawCommand command = { (unsigned)type,indexStart,indexCount,minVertex,vertexCount,instanceCount };
+		Push(RHICMD_DRAW_INSTANCED,&command,sizeof command);
+		++numDraws_;
+	}
+
+	void YumeRHICommandBuffer::ResolveToTexture(YumeTexture2D* destination,const IntRect& viewport)
+	{
+		ResolveCommand command;
+		command.Destination = destination;
+		command.Viewport = viewport;
+		Push(RHICMD_RESOLVE,&command,sizeof command);
+	}
+
+	void YumeRHICommandBuffer::Execute(YumeRHI* rhi) const
+	{
+#if YUME_DEBUG_MODE
+		if(!Validate(rhi))
+			return;
+#endif
+
+		YumeVector<YumeTexture*>::type textures(MAX_TEXTURE_UNITS);
+		YumeTexture* vsTextures[MAX_TEXTURE_UNITS];
+		unsigned samplers[MAX_TEXTURE_UNITS];
+		float parameter[16];
+
+		unsigned offset = 0;
+		while(offset < data_.size())
+		{
+			CommandHeader header;
+			memcpy(&header,&data_[offset],sizeof header);
+			const unsigned char* payload = &data_[offset + sizeof header];
+			offset += sizeof header + header.Size;
+
+			switch(header.Type)
+			{
+			case RHICMD_SET_SHADERS:
+				{
+					SetShadersCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->SetShaders(command.Shaders[VS],command.Shaders[PS],command.Shaders[GS]);
+				}
+				break;
+
+			case RHICMD_SET_BLEND_MODE:
+			case RHICMD_SET_COLOR_WRITE:
+			case RHICMD_SET_CULL_MODE:
+			case RHICMD_SET_DEPTH_TEST:
+			case RHICMD_SET_DEPTH_WRITE:
+			case RHICMD_SET_FILL_MODE:
+				{
+					SetStateCommand command;
+					memcpy(&command,payload,sizeof command);
+
+					if(header.Type == RHICMD_SET_BLEND_MODE)
+						rhi->SetBlendMode((BlendMode)command.Value);
+					else if(header.Type == RHICMD_SET_COLOR_WRITE)
+						rhi->SetColorWrite(command.Value != 0);
+					else if(header.Type == RHICMD_SET_CULL_MODE)
+						rhi->SetCullMode((CullMode)command.Value);
+					else if(header.Type == RHICMD_SET_DEPTH_TEST)
+						rhi->SetDepthTest((CompareMode)command.Value);
+					else if(header.Type == RHICMD_SET_DEPTH_WRITE)
+						rhi->SetDepthWrite(command.Value != 0);
+					else
+						rhi->SetFillMode((FillMode)command.Value);
+				}
+				break;
+
+			case RHICMD_SET_DEPTH_BIAS:
+				{
+					SetDepthBiasCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->SetDepthBias(command.ConstantBias,command.SlopeScaledBias);
+				}
+				break;
+
+			case RHICMD_SET_VIEWPORT:
+				{
+					SetViewportCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->SetViewport(command.Rect);
+				}
+				break;
+
+			case RHICMD_SET_RENDER_TARGET:
+				{
+					SetRenderTargetCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->SetRenderTarget(command.Index,command.Target);
+				}
+				break;
+
+			case RHICMD_SET_DEPTH_STENCIL:
+				{
+					SetResourceCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->SetDepthStencil((YumeRenderable*)command.Resource);
+				}
+				break;
+
+			case RHICMD_SET_TEXTURE:
+				{
+					SetTextureCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->SetTexture(command.Index,command.Texture);
+				}
+				break;
+
+			case RHICMD_PS_BIND_SRV:
+				{
+					BindRangeCommand command;
+					memcpy(&command,payload,sizeof command);
+
+					for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+						textures[i] = 0;
+					if(command.Count)
+						memcpy(&textures[command.Start],payload + sizeof command,command.Count * sizeof(YumeTexture*));
+
+					rhi->PSBindSRV(command.Start,command.Count,textures);
+				}
+				break;
+
+			case RHICMD_VS_BIND_SRV:
+				{
+					BindRangeCommand command;
+					memcpy(&command,payload,sizeof command);
+					memcpy(vsTextures,payload + sizeof command,command.Count * sizeof(YumeTexture*));
+					rhi->VSBindSRV(command.Start,command.Count,vsTextures);
+				}
+				break;
+
+			case RHICMD_BIND_SAMPLER:
+				{
+					BindRangeCommand command;
+					memcpy(&command,payload,sizeof command);
+					memcpy(samplers,payload + sizeof command,command.Count * sizeof(unsigned));
+					rhi->BindSampler((ShaderType)command.Type,command.Start,command.Count,samplers);
+				}
+				break;
+
+			case RHICMD_SET_VERTEX_BUFFER:
+			case RHICMD_SET_INDEX_BUFFER:
+				{
+					SetResourceCommand command;
+					memcpy(&command,payload,sizeof command);
+
+					if(header.Type == RHICMD_SET_VERTEX_BUFFER)
+						rhi->SetVertexBuffer((YumeVertexBuffer*)command.Resource);
+					else
+						rhi->SetIndexBuffer((YumeIndexBuffer*)command.Resource);
+				}
+				break;
+
+			case RHICMD_SET_SHADER_PARAMETER:
+				{
+					SetParameterCommand command;
+					memcpy(&command,payload,sizeof command);
+					const unsigned char* data = payload + sizeof command;
+					YumeHash param(command.Param);
+
+					if(command.Kind == PARAM_FLOATS)
+					{
+						//Parameter data may be unaligned in the stream, only short arrays are copied out
+						if(command.Count <= 16)
+						{
+							memcpy(parameter,data,command.Count * sizeof(float));
+							rhi->SetShaderParameter(param,parameter,command.Count);
+						}
+						else
+						{
+							YumePodVector<float>::type floats;
+							floats.resize(command.Count);
+							memcpy(&floats[0],data,command.Count * sizeof(float));
+							rhi->SetShaderParameter(param,&floats[0],command.Count);
+						}
+						break;
+					}
+
+					//Release builds do not validate, never copy more than the type holds
+					unsigned size = GetParameterSize(command.Kind);
+					if(!size)
+						break;
+
+					unsigned count = command.Count < size ? command.Count : size;
+					memcpy(parameter,data,count * sizeof(float));
+					for(unsigned i = count; i < size; ++i)
+						parameter[i] = 0.0f;
+
+					if(command.Kind == PARAM_VECTOR4)
+						rhi->SetShaderParameter(param,Vector4(parameter));
+					else if(command.Kind == PARAM_MATRIX3X4)
+						rhi->SetShaderParameter(param,Matrix3x4(parameter));
+					else
+						rhi->SetShaderParameter(param,Matrix4(parameter));
+				}
+				break;
+
+			case RHICMD_CLEAR:
+				{
+					ClearCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->Clear(command.Flags,YumeColor(command.Color[0],command.Color[1],command.Color[2],command.Color[3]),command.Depth,command.Stencil);
+				}
+				break;
+
+			case RHICMD_DRAW:
+			case RHICMD_DRAW_INDEXED:
+			case RHICMD_DRAW_INSTANCED:
+				{
+					DrawCommand command;
+					memcpy(&command,payload,sizeof command);
+
+					if(header.Type == RHICMD_DRAW)
+						rhi->Draw((PrimitiveType)command.Type,command.Start,command.Count);
+					else if(header.Type == RHICMD_DRAW_INDEXED)
+						rhi->Draw((PrimitiveType)command.Type,command.Start,command.Count,command.MinVertex,command.VertexCount);
+					else
+						rhi->DrawInstanced((PrimitiveType)command.Type,command.Start,command.Count,command.MinVertex,command.VertexCount,command.InstanceCount);
+				}
+				break;
+
+			case RHICMD_RESOLVE:
+				{
+					ResolveCommand command;
+					memcpy(&command,payload,sizeof command);
+					rhi->ResolveToTexture(command.Destination,command.Viewport);
+				}
+				break;
+			}
+		}
+	}
+
+	bool YumeRHICommandBuffer::Validate(const YumeRHI* rhi) const
+	{
+		bool hasShaders = rhi && rhi->GetVertexShader() && rhi->GetPixelShader();
+		unsigned index = 0;
+		unsigned offset = 0;
+
+		while(offset < data_.size())
+		{
+			if(offset + sizeof(CommandHeader) > data_.size())
+			{
+				YUMELOG_ERROR("Command buffer truncated after command " << index);
+				return false;
+			}
+
+			CommandHeader header;
+			memcpy(&header,&data_[offset],sizeof header);
+			const unsigned char* payload = &data_[offset + sizeof header];
+
+			if(header.Type >= MAX_RHI_COMMANDS)
+			{
+				YUMELOG_ERROR("Unknown command type " << header.Type << " at command " << index);
+				return false;
+			}
+
+			if(header.Size < commandSizes[header.Type] || offset + sizeof header + header.Size > data_.size())
+			{
+				YUMELOG_ERROR(commandNames[header.Type] << " at command " << index << " has a bad size " << header.Size);
+				return false;
+			}
+
+			switch(header.Type)
+			{
+			case RHICMD_SET_SHADERS:
+				{
+					SetShadersCommand command;
+					memcpy(&command,payload,sizeof command);
+					hasShaders = command.Shaders[VS] && command.Shaders[PS];
+				}
+				break;
+
+			case RHICMD_PS_BIND_SRV:
+			case RHICMD_VS_BIND_SRV:
+			case RHICMD_BIND_SAMPLER:
+				{
+					BindRangeCommand command;
+					memcpy(&command,payload,sizeof command);
+
+					unsigned elementSize = header.Type == RHICMD_BIND_SAMPLER ? sizeof(unsigned) : sizeof(YumeTexture*);
+					if(command.Start + command.Count > MAX_TEXTURE_UNITS || header.Size != sizeof command + command.Count * elementSize)
+					{
+						YUMELOG_ERROR(commandNames[header.Type] << " at command " << index << " binds outside the texture units");
+						return false;
+					}
+				}
+				break;
+
+			case RHICMD_SET_SHADER_PARAMETER:
+				{
+					SetParameterCommand command;
+					memcpy(&command,payload,sizeof command);
+
+					if(header.Size != sizeof command + command.Count * sizeof(float))
+					{
+						YUMELOG_ERROR("Shader parameter at command " << index << " has a bad size");
+						return false;
+					}
+
+					if(command.Kind != PARAM_FLOATS && command.Count != GetParameterSize(command.Kind))
+					{
+						YUMELOG_ERROR("Shader parameter at command " << index << " does not fit its type");
+						return false;
+					}
+				}
+				break;
+
+			case RHICMD_DRAW:
+			case RHICMD_DRAW_INDEXED:
+			case RHICMD_DRAW_INSTANCED:
+				if(!hasShaders)
+				{
+					YUMELOG_ERROR(commandNames[header.Type] << " at command " << index << " has no shaders bound");
+					return false;
+				}
+				break;
+			}
+
+			offset += sizeof header + header.Size;
+			++index;
+		}
+
+		return true;
+	}
+
+	void YumeRHICommandBuffer::Serialize(StreamWriter& dest) const
+	{
+		ResourceIdMap ids;
+
+		dest.WriteFileID("YRCB");
+		dest.WriteUInt(COMMAND_STREAM_VERSION);
+		dest.WriteUInt(numCommands_);
+
+		unsigned offset = 0;
+		while(offset < data_.size())
+		{
+			CommandHeader header;
+			memcpy(&header,&data_[offset],sizeof header);
+			const unsigned char* payload = &data_[offset + sizeof header];
+			offset += sizeof header + header.Size;
+
+			dest.WriteUByte((unsigned char)header.Type);
+
+			switch(header.Type)
+			{
+			case RHICMD_SET_SHADERS:
+				{
+					SetShadersCommand command;
+					memcpy(&command,payload,sizeof command);
+					for(unsigned i = 0; i < 3; ++i)
+						dest.WriteUInt(ids.GetId(command.Shaders[i]));
+				}
+				break;
+
+			case RHICMD_SET_RENDER_TARGET:
+				{
+					SetRenderTargetCommand command;
+					memcpy(&command,payload,sizeof command);
+					dest.WriteUInt(command.Index);
+					dest.WriteUInt(ids.GetId(command.Target));
+				}
+				break;
+
+			case RHICMD_SET_TEXTURE:
+				{
+					SetTextureCommand command;
+					memcpy(&command,payload,sizeof command);
+					dest.WriteUInt(command.Index);
+					dest.WriteUInt(ids.GetId(command.Texture));
+				}
+				break;
+
+			case RHICMD_SET_DEPTH_STENCIL:
+			case RHICMD_SET_VERTEX_BUFFER:
+			case RHICMD_SET_INDEX_BUFFER:
+				{
+					SetResourceCommand command;
+					memcpy(&command,payload,sizeof command);
+					dest.WriteUInt(ids.GetId(command.Resource));
+				}
+				break;
+
+			case RHICMD_PS_BIND_SRV:
+			case RHICMD_VS_BIND_SRV:
+				{
+					BindRangeCommand command;
+					memcpy(&command,payload,sizeof command);
+					dest.Write(&command,sizeof command);
+
+					for(unsigned i = 0; i < command.Count; ++i)
+					{
+						YumeTexture* texture;
+						memcpy(&texture,payload + sizeof command + i * sizeof(YumeTexture*),sizeof texture);
+						dest.WriteUInt(ids.GetId(texture));
+					}
+				}
+				break;
+
+			case RHICMD_RESOLVE:
+				{
+					ResolveCommand command;
+					memcpy(&command,payload,sizeof command);
+					dest.WriteUInt(ids.GetId(command.Destination));
+					dest.WriteIntRect(command.Viewport);
+				}
+				break;
+
+			default:
+				//Everything else is plain values
+				dest.Write(payload,header.Size);
+				break;
+			}
+		}
+	}
+}
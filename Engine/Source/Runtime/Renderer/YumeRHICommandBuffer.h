@@ -0,0 +1,139 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeRHICommandBuffer.h
+// Date : <Date>
+// Comments : Recorded stream of RHI calls, replayed later on the render thread
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeRHICommandBuffer_h__
+#define __YumeRHICommandBuffer_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Renderer/YumeRendererDefs.h"
+#include "Math/YumeRect.h"
+#include "Math/YumeColor.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class YumeRHI;
+	class YumeRenderable;
+	class YumeTexture;
+	class YumeTexture2D;
+	class YumeVertexBuffer;
+	class YumeIndexBuffer;
+	class StreamWriter;
+
+	enum RHICommandType
+	{
+		RHICMD_SET_SHADERS = 0,
+		RHICMD_SET_BLEND_MODE,
+		RHICMD_SET_COLOR_WRITE,
+		RHICMD_SET_CULL_MODE,
+		RHICMD_SET_DEPTH_BIAS,
+		RHICMD_SET_DEPTH_TEST,
+		RHICMD_SET_DEPTH_WRITE,
+		RHICMD_SET_FILL_MODE,
+		RHICMD_SET_VIEWPORT,
+		RHICMD_SET_RENDER_TARGET,
+		RHICMD_SET_DEPTH_STENCIL,
+		RHICMD_SET_TEXTURE,
+		RHICMD_PS_BIND_SRV,
+		RHICMD_VS_BIND_SRV,
+		RHICMD_BIND_SAMPLER,
+		RHICMD_SET_VERTEX_BUFFER,
+		RHICMD_SET_INDEX_BUFFER,
+		RHICMD_SET_SHADER_PARAMETER,
+		RHICMD_CLEAR,
+		RHICMD_DRAW,
+		RHICMD_DRAW_INDEXED,
+		RHICMD_DRAW_INSTANCED,
+		RHICMD_RESOLVE,
+		MAX_RHI_COMMANDS
+	};
+
+	//Records with the same signatures as YumeRHI so call sites can target either.
+	//A buffer is recorded by one thread at a time, any number of buffers can be recorded in parallel.
+	//Resources are referenced, not owned, they must outlive the replay.
+	class YumeAPIExport YumeRHICommandBuffer : public YumeBase
+	{
+	public:
+		YumeRHICommandBuffer();
+		virtual ~YumeRHICommandBuffer();
+
+		//Drops the recorded commands but keeps the memory for the next recording
+		void Reset();
+		//No more commands can be recorded until Reset
+		void Close();
+		bool IsClosed() const { return closed_; }
+
+		void SetShaders(YumeShaderVariation* vs,YumeShaderVariation* ps,YumeShaderVariation* gs = 0);
+		void SetBlendMode(BlendMode mode);
+		void SetColorWrite(bool enable);
+		void SetCullMode(CullMode mode);
+		void SetDepthBias(float constantBias,float slopeScaledBias);
+		void SetDepthTest(CompareMode mode);
+		void SetDepthWrite(bool enable);
+		void SetFillMode(FillMode mode);
+		void SetViewport(const IntRect& rect);
+		void SetRenderTarget(unsigned index,YumeRenderable* renderTarget);
+		void SetDepthStencil(YumeRenderable* depthStencil);
+		void SetTexture(unsigned index,YumeTexture* texture);
+		void PSBindSRV(unsigned start,unsigned count,const YumeVector<YumeTexture*>::type& textures);
+		void VSBindSRV(unsigned start,unsigned count,YumeTexture** textures);
+		void BindSampler(ShaderType type,unsigned start,unsigned count,unsigned* samplers);
+		void SetVertexBuffer(YumeVertexBuffer* buffer);
+		void SetIndexBuffer(YumeIndexBuffer* buffer);
+
+		void SetShaderParameter(YumeHash param,const float* data,unsigned count);
+		void SetShaderParameter(YumeHash param,const Vector4& vector);
+		void SetShaderParameter(YumeHash param,const Matrix3x4& matrix);
+		void SetShaderParameter(YumeHash param,const Matrix4& matrix);
+
+		void Clear(unsigned flags,const YumeColor& color = YumeColor(0.0f,0.0f,0.0f,0.0f),float depth = 1.0f,unsigned stencil = 0);
+		void Draw(PrimitiveType type,unsigned vertexStart,unsigned vertexCount);
+		void Draw(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount);
+		void DrawInstanced(PrimitiveType type,unsigned indexStart,unsigned indexCount,unsigned minVertex,unsigned vertexCount,unsigned instanceCount);
+		void ResolveToTexture(YumeTexture2D* destination,const IntRect& viewport);
+
+		//Replays every command against the rhi in recording order, must be called on the render thread
+		void Execute(YumeRHI* rhi) const;
+
+		//Checks the stream is well formed and draws have shaders bound, either recorded or already on the rhi
+		bool Validate(const YumeRHI* rhi = 0) const;
+
+		//Resources are written as ids in order of first use so equal recordings give equal bytes across runs
+		void Serialize(StreamWriter& dest) const;
+
+		unsigned GetNumCommands() const { return numCommands_; }
+		unsigned GetNumDraws() const { return numDraws_; }
+		unsigned GetSize() const { return data_.size(); }
+
+	private:
+		void* Allocate(RHICommandType type,unsigned size);
+		void Push(RHICommandType type,const void* command,unsigned size);
+		void PushParameter(YumeHash param,unsigned kind,const float* data,unsigned count);
+
+		YumePodVector<unsigned char>::type data_;
+		unsigned numCommands_;
+		unsigned numDraws_;
+		bool closed_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,209 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeRHIStateCache.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeRHIStateCache.h"
+
+#include "Math/YumeMath.h"
+
+namespace YumeEngine
+{
+	//Never a valid handle, marks a slot whose device state is unknown
+	static const void* const UNKNOWN_STATE = (const void*)~(size_t)0;
+
+	RHIStateStats::RHIStateStats()
+	{
+		Reset();
+	}
+
+	void RHIStateStats::Reset()
+	{
+		for(unsigned i = 0; i < MAX_RHISTATE_CATEGORIES; ++i)
+		{
+			Issued[i] = 0;
+			Filtered[i] = 0;
+		}
+	}
+
+	unsigned RHIStateStats::GetTotalIssued() const
+	{
+		unsigned total = 0;
+		for(unsigned i = 0; i < MAX_RHISTATE_CATEGORIES; ++i)
+			total += Issued[i];
+		return total;
+	}
+
+	unsigned RHIStateStats::GetTotalFiltered() const
+	{
+		unsigned total = 0;
+		for(unsigned i = 0; i < MAX_RHISTATE_CATEGORIES; ++i)
+			total += Filtered[i];
+		return total;
+	}
+
+	YumeRHIStateCache::YumeRHIStateCache()
+	{
+		Invalidate();
+	}
+
+	void YumeRHIStateCache::BeginFrame()
+	{
+		frameStats_.Reset();
+	}
+
+	void YumeRHIStateCache::Invalidate()
+	{
+		for(unsigned stage = 0; stage < MAX_CACHED_SHADER_STAGES; ++stage)
+		{
+			shaders_[stage] = UNKNOWN_STATE;
+
+			for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+				samplers_[stage][i] = UNKNOWN_STATE;
+
+			for(unsigned i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
+				constantBuffers_[stage][i] = UNKNOWN_STATE;
+		}
+
+		InvalidateShaderResources();
+		InvalidateRenderTargets();
+		InvalidateViewport();
+	}
+
+	void YumeRHIStateCache::InvalidateShaderResources()
+	{
+		for(unsigned stage = 0; stage < MAX_CACHED_SHADER_STAGES; ++stage)
+		{
+			for(unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+				shaderResources_[stage][i] = UNKNOWN_STATE;
+		}
+	}
+
+	void YumeRHIStateCache::InvalidateRenderTargets()
+	{
+		for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+			renderTargets_[i] = UNKNOWN_STATE;
+		depthStencil_ = UNKNOWN_STATE;
+	}
+
+	void YumeRHIStateCache::InvalidateViewport()
+	{
+		viewportValid_ = false;
+	}
+
+	bool YumeRHIStateCache::SetShaders(const void* vs,const void* ps,const void* gs)
+	{
+		bool changed = shaders_[VS] != vs || shaders_[PS] != ps || shaders_[GS] != gs;
+
+		shaders_[VS] = vs;
+		shaders_[PS] = ps;
+		shaders_[GS] = gs;
+
+		Record(RHISTATE_SHADER,changed);
+		return changed;
+	}
+
+	bool YumeRHIStateCache::SetShaderResources(ShaderType type,unsigned start,unsigned count,const void* const* views,unsigned& first,unsigned& numChanged)
+	{
+		return FilterSlots(RHISTATE_SRV,shaderResources_[type],MAX_TEXTURE_UNITS,start,count,views,first,numChanged);
+	}
+
+	bool YumeRHIStateCache::SetSamplers(ShaderType type,unsigned start,unsigned count,const void* const* samplers,unsigned& first,unsigned& numChanged)
+	{
+		return FilterSlots(RHISTATE_SAMPLER,samplers_[type],MAX_TEXTURE_UNITS,start,count,samplers,first,numChanged);
+	}
+
+	bool YumeRHIStateCache::SetConstantBuffers(ShaderType type,unsigned start,unsigned count,const void* const* buffers,unsigned& first,unsigned& numChanged)
+	{
+		return FilterSlots(RHISTATE_CONSTANTBUFFER,constantBuffers_[type],MAX_SHADER_PARAMETER_GROUPS,start,count,buffers,first,numChanged);
+	}
+
+	bool YumeRHIStateCache::SetRenderTargets(unsigned count,const void* const* views,const void* depthStencil)
+	{
+		bool changed = depthStencil_ != depthStencil;
+
+		for(unsigned i = 0; i < MAX_RENDERTARGETS; ++i)
+		{
+			const void* view = i < count ? views[i] : 0;
+			if(renderTargets_[i] != view)
+			{
+				renderTargets_[i] = view;
+				changed = true;
+			}
+		}
+
+		depthStencil_ = depthStencil;
+
+		Record(RHISTATE_RENDERTARGET,changed);
+		return changed;
+	}
+
+	bool YumeRHIStateCache::SetViewport(const IntRect& rect)
+	{
+		bool changed = !viewportValid_ || viewport_ != rect;
+
+		viewport_ = rect;
+		viewportValid_ = true;
+
+		Record(RHISTATE_VIEWPORT,changed);
+		return changed;
+	}
+
+	bool YumeRHIStateCache::FilterSlots(RHIStateCategory category,const void** current,unsigned numSlots,unsigned start,unsigned count,
+		const void* const* requested,unsigned& first,unsigned& numChanged)
+	{
+		unsigned last = 0;
+		first = M_MAX_UNSIGNED;
+
+		for(unsigned i = 0; i < count && start + i < numSlots; ++i)
+		{
+			unsigned slot = start + i;
+
+			if(current[slot] == requested[i])
+				continue;
+
+			current[slot] = requested[i];
+
+			if(first == M_MAX_UNSIGNED)
+				first = slot;
+			last = slot;
+		}
+
+		bool changed = first != M_MAX_UNSIGNED;
+		numChanged = changed ? last - first + 1 : 0;
+
+		Record(category,changed);
+		return changed;
+	}
+
+	void YumeRHIStateCache::Record(RHIStateCategory category,bool issued)
+	{
+		if(issued)
+		{
+			++stats_.Issued[category];
+			++frameStats_.Issued[category];
+		}
+		else
+		{
+			++stats_.Filtered[category];
+			++frameStats_.Filtered[category];
+		}
+	}
+}
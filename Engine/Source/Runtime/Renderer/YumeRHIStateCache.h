@@ -0,0 +1,110 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeRHIStateCache.h
+// Date : <Date>
+// Comments : Shadow copy of the bound pipeline state, filters redundant binds
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeRHIStateCache_h__
+#define __YumeRHIStateCache_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Renderer/YumeRendererDefs.h"
+#include "Math/YumeRect.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	enum RHIStateCategory
+	{
+		RHISTATE_SHADER = 0,
+		RHISTATE_SRV,
+		RHISTATE_SAMPLER,
+		RHISTATE_CONSTANTBUFFER,
+		RHISTATE_RENDERTARGET,
+		RHISTATE_VIEWPORT,
+		MAX_RHISTATE_CATEGORIES
+	};
+
+	static const unsigned MAX_CACHED_SHADER_STAGES = 3;
+
+	struct YumeAPIExport RHIStateStats
+	{
+		RHIStateStats();
+
+		void Reset();
+
+		unsigned GetTotalIssued() const;
+		unsigned GetTotalFiltered() const;
+
+		//Calls forwarded to the backend
+		unsigned Issued[MAX_RHISTATE_CATEGORIES];
+		//Calls dropped because the state was already bound
+		unsigned Filtered[MAX_RHISTATE_CATEGORIES];
+	};
+
+	//Backend independent, bound objects are tracked as opaque native handles.
+	//Every Set* call returns whether the backend has to be called at all.
+	class YumeAPIExport YumeRHIStateCache
+	{
+	public:
+		YumeRHIStateCache();
+
+		//Resets the per frame counters
+		void BeginFrame();
+
+		//Forgets everything, the next bind of each slot is always forwarded
+		void Invalidate();
+		void InvalidateShaderResources();
+		void InvalidateRenderTargets();
+		void InvalidateViewport();
+
+		bool SetShaders(const void* vs,const void* ps,const void* gs);
+
+		//Arrays are indexed from start. On change first/numChanged hold the smallest absolute slot range
+		//covering every changed slot, the backend binds array[first - start] onwards
+		bool SetShaderResources(ShaderType type,unsigned start,unsigned count,const void* const* views,unsigned& first,unsigned& numChanged);
+		bool SetSamplers(ShaderType type,unsigned start,unsigned count,const void* const* samplers,unsigned& first,unsigned& numChanged);
+		bool SetConstantBuffers(ShaderType type,unsigned start,unsigned count,const void* const* buffers,unsigned& first,unsigned& numChanged);
+
+		bool SetRenderTargets(unsigned count,const void* const* views,const void* depthStencil);
+		bool SetViewport(const IntRect& rect);
+
+		const RHIStateStats& GetFrameStats() const { return frameStats_; }
+		const RHIStateStats& GetStats() const { return stats_; }
+
+	private:
+		bool FilterSlots(RHIStateCategory category,const void** current,unsigned numSlots,unsigned start,unsigned count,
+			const void* const* requested,unsigned& first,unsigned& numChanged);
+		void Record(RHIStateCategory category,bool issued);
+
+		const void* shaders_[MAX_CACHED_SHADER_STAGES];
+		const void* shaderResources_[MAX_CACHED_SHADER_STAGES][MAX_TEXTURE_UNITS];
+		const void* samplers_[MAX_CACHED_SHADER_STAGES][MAX_TEXTURE_UNITS];
+		const void* constantBuffers_[MAX_CACHED_SHADER_STAGES][MAX_SHADER_PARAMETER_GROUPS];
+		const void* renderTargets_[MAX_RENDERTARGETS];
+		const void* depthStencil_;
+		IntRect viewport_;
+		bool viewportValid_;
+
+		RHIStateStats stats_;
+		RHIStateStats frameStats_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,327 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeRenderTargetPool.cc
+// Date : <Date>
+// Comments :
+//
+//----------------------------------------------------------------------------
+#include "YumeHeaders.h"
+#include "YumeRenderTargetPool.h"
+
+#include "YumeRHI.h"
+#include "YumeTexture2D.h"
+#include "YumeTextureCube.h"
+
+#include "Logging/logging.h"
+
+namespace YumeEngine
+{
+	static const unsigned long long DEFAULT_POOL_BUDGET = 256 * 1024 * 1024;
+	static const unsigned DEFAULT_MAX_UNUSED_FRAMES = 120;
+
+	TransientTargetDesc::TransientTargetDesc()
+		: Width(0),
+		Height(0),
+		Format(0),
+		Flags(0),
+		MultiSample(1),
+		PersistentKey(0)
+	{
+	}
+
+	TransientTargetDesc::TransientTargetDesc(int width,int height,unsigned format,unsigned flags,unsigned multiSample,unsigned persistentKey)
+		: Width(width),
+		Height(height),
+		Format(format),
+		Flags(flags),
+		MultiSample(multiSample ? multiSample : 1),
+		PersistentKey(persistentKey)
+	{
+		//Depth stencil targets can't be filtered or sRGB
+		if(Flags & TTF_DEPTHSTENCIL)
+			Flags &= ~(TTF_FILTERED | TTF_SRGB);
+
+		if(Flags & TTF_CUBEMAP)
+			Height = Width;
+	}
+
+	bool TransientTargetDesc::operator ==(const TransientTargetDesc& rhs) const
+	{
+		return Width == rhs.Width && Height == rhs.Height && Format == rhs.Format && Flags == rhs.Flags &&
+			MultiSample == rhs.MultiSample && PersistentKey == rhs.PersistentKey;
+	}
+
+	unsigned TransientTargetDesc::ToHash() const
+	{
+		unsigned hash = Format;
+		hash = hash * 31 + (unsigned)Width;
+		hash = hash * 31 + (unsigned)Height;
+		hash = hash * 31 + Flags;
+		hash = hash * 31 + MultiSample;
+		hash = hash * 31 + PersistentKey;
+		return hash;
+	}
+
+	RenderTargetPoolStats::RenderTargetPoolStats()
+		: AllocatedBytes(0),
+		PeakBytes(0),
+		NumTargets(0),
+		NumInUse(0),
+		Requests(0),
+		Hits(0),
+		Misses(0),
+		Evictions(0)
+	{
+	}
+
+	YumeRenderTargetPool::YumeRenderTargetPool()
+		: frameNumber_(0),
+		maxUnusedFrames_(DEFAULT_MAX_UNUSED_FRAMES),
+		memoryBudget_(DEFAULT_POOL_BUDGET)
+	{
+	}
+
+	YumeRenderTargetPool::~YumeRenderTargetPool()
+	{
+		Clear();
+	}
+
+	void YumeRenderTargetPool::BeginFrame(unsigned frameNumber)
+	{
+		frameNumber_ = frameNumber;
+
+		for(unsigned i = 0; i < targets_.size(); ++i)
+		{
+			if(targets_[i].LastUsedFrame != frameNumber_)
+				targets_[i].InUse = false;
+		}
+
+		frameStats_.Requests = 0;
+		frameStats_.Hits = 0;
+		frameStats_.Misses = 0;
+		frameStats_.Evictions = 0;
+		frameStats_.PeakBytes = 0;
+
+		UpdateStats();
+	}
+
+	void YumeRenderTargetPool::EndFrame()
+	{
+		for(unsigned i = targets_.size() - 1; i < targets_.size(); --i)
+		{
+			const PooledTarget& target = targets_[i];
+
+			if(!target.InUse && frameNumber_ - target.LastUsedFrame > maxUnusedFrames_)
+				Evict(i);
+		}
+
+		Trim(memoryBudget_);
+	}
+
+	TexturePtr YumeRenderTargetPool::Acquire(const TransientTargetDesc& desc)
+	{
+		++stats_.Requests;
+		++frameStats_.Requests;
+
+		for(unsigned i = 0; i < targets_.size(); ++i)
+		{
+			PooledTarget& target = targets_[i];
+
+			if(target.InUse || target.Desc != desc)
+				continue;
+
+			target.InUse = true;
+			target.LastUsedFrame = frameNumber_;
+			target.Texture->ResetUseTimer();
+
+			++stats_.Hits;
+			++frameStats_.Hits;
+			UpdateStats();
+			return target.Texture;
+		}
+
+		++stats_.Misses;
+		++frameStats_.Misses;
+
+		SharedPtr<YumeTexture> texture = CreateTarget(desc);
+
+		if(!texture)
+			return 0;
+
+		PooledTarget target;
+		target.Texture = texture;
+		target.Desc = desc;
+		target.Bytes = GetTargetSize(texture,desc);
+		target.LastUsedFrame = frameNumber_;
+		target.InUse = true;
+		targets_.push_back(target);
+
+		UpdateStats();
+
+		YUMELOG_DEBUG("Allocated new transient target size " << desc.Width << "x" << desc.Height << " format " << desc.Format <<
+			" bytes " << target.Bytes << " pool total " << stats_.AllocatedBytes);
+
+		return texture;
+	}
+
+	void YumeRenderTargetPool::Release(TexturePtr texture)
+	{
+		if(!texture)
+			return;
+
+		for(unsigned i = 0; i < targets_.size(); ++i)
+		{
+			if(targets_[i].Texture == texture)
+			{
+				targets_[i].InUse = false;
+				break;
+			}
+		}
+
+		UpdateStats();
+	}
+
+	void YumeRenderTargetPool::Trim(unsigned long long budget)
+	{
+		//Evict the least recently used free targets until we fit into the budget
+		while(stats_.AllocatedBytes > budget)
+		{
+			unsigned oldest = M_MAX_UNSIGNED;
+
+			for(unsigned i = 0; i < targets_.size(); ++i)
+			{
+				const PooledTarget& target = targets_[i];
+
+				if(target.InUse)
+					continue;
+
+				if(oldest == M_MAX_UNSIGNED || target.LastUsedFrame < targets_[oldest].LastUsedFrame)
+					oldest = i;
+			}
+
+			if(oldest == M_MAX_UNSIGNED)
+				break;
+
+			Evict(oldest);
+		}
+	}
+
+	void YumeRenderTargetPool::Clear()
+	{
+		targets_.clear();
+		UpdateStats();
+	}
+
+	SharedPtr<YumeTexture> YumeRenderTargetPool::CreateTarget(const TransientTargetDesc& desc)
+	{
+		YumeRHI* rhi = gYume->pRHI;
+
+		bool depthStencil = (desc.Flags & TTF_DEPTHSTENCIL) != 0;
+		TextureUsage usage = depthStencil ? TEXTURE_DEPTHSTENCIL : TEXTURE_RENDERTARGET;
+
+		YumeString name = "TransientTarget_";
+		name.AppendWithFormat("%u_%u",desc.ToHash(),targets_.size());
+
+		RenderTargetDesc rtDesc;
+		rtDesc.Name = name;
+		rtDesc.Usage = usage;
+		rtDesc.Index = 0;
+		rtDesc.Type = depthStencil ? RT_DEPTHSTENCIL : RT_INPUT | RT_OUTPUT;
+
+		SharedPtr<YumeTexture> texture;
+
+		if(desc.Flags & TTF_CUBEMAP)
+		{
+			SharedPtr<YumeTextureCube> cube(rhi->CreateTextureCube());
+			cube->SetName(name);
+			cube->SetDesc(rtDesc);
+			if(desc.Flags & TTF_MIPS)
+				cube->SetNumLevels(0);
+			cube->SetSize(desc.Width,desc.Format,usage);
+			texture = cube;
+		}
+		else
+		{
+			SharedPtr<YumeTexture2D> tex2D(rhi->CreateTexture2D());
+			tex2D->SetName(name);
+			tex2D->SetDesc(rtDesc);
+			tex2D->SetSRGB(true);
+			tex2D->SetSize(desc.Width,desc.Height,desc.Format,usage,1,(desc.Flags & TTF_MIPS) ? 0 : 1);
+			texture = tex2D;
+		}
+
+		if(!texture)
+		{
+			YUMELOG_ERROR("Could not create transient target size " << desc.Width << "x" << desc.Height << " format " << desc.Format);
+			return texture;
+		}
+
+		texture->SetSRGB((desc.Flags & TTF_SRGB) != 0);
+		texture->SetFilterMode((desc.Flags & TTF_FILTERED) ? FILTER_BILINEAR : FILTER_NEAREST);
+		texture->ResetUseTimer();
+
+		return texture;
+	}
+
+	unsigned long long YumeRenderTargetPool::GetTargetSize(YumeTexture* texture,const TransientTargetDesc& desc) const
+	{
+		unsigned long long bytes = texture->GetDataSize(desc.Width,desc.Height);
+
+		//Full mip chain adds roughly a third
+		if(desc.Flags & TTF_MIPS)
+			bytes += bytes / 3;
+		if(desc.Flags & TTF_CUBEMAP)
+			bytes *= 6;
+
+		return bytes * desc.MultiSample;
+	}
+
+	void YumeRenderTargetPool::Evict(unsigned index)
+	{
+		const PooledTarget& target = targets_[index];
+
+		YUMELOG_DEBUG("Removed unused transient target size " << target.Desc.Width << "x" << target.Desc.Height <<
+			" format " << target.Desc.Format << " unused for " << (frameNumber_ - target.LastUsedFrame) << " frames");
+
+		targets_.erase(index);
+
+		++stats_.Evictions;
+		++frameStats_.Evictions;
+
+		UpdateStats();
+	}
+
+	void YumeRenderTargetPool::UpdateStats()
+	{
+		unsigned long long bytes = 0;
+		unsigned inUse = 0;
+
+		for(unsigned i = 0; i < targets_.size(); ++i)
+		{
+			bytes += targets_[i].Bytes;
+			if(targets_[i].InUse)
+				++inUse;
+		}
+
+		stats_.AllocatedBytes = frameStats_.AllocatedBytes = bytes;
+		stats_.NumTargets = frameStats_.NumTargets = targets_.size();
+		stats_.NumInUse = frameStats_.NumInUse = inUse;
+
+		stats_.PeakBytes = std::max(stats_.PeakBytes,bytes);
+		frameStats_.PeakBytes = std::max(frameStats_.PeakBytes,bytes);
+	}
+}
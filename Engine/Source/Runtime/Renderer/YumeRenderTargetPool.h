@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------
+//Yume Engine
+//Copyright (C) 2015  arkenthera
+//This program is free software; you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation; either version 2 of the License, or
+//(at your option) any later version.
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//You should have received a copy of the GNU General Public License along
+//with this program; if not, write to the Free Software Foundation, Inc.,
+//51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.*/
+//----------------------------------------------------------------------------
+//
+// File : YumeRenderTargetPool.h
+// Date : <Date>
+// Comments : Pool of transient render targets shared between render calls
+//
+//----------------------------------------------------------------------------
+#ifndef __YumeRenderTargetPool_h__
+#define __YumeRenderTargetPool_h__
+//----------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "YumeTexture.h"
+//----------------------------------------------------------------------------
+namespace YumeEngine
+{
+	enum TransientTargetFlags
+	{
+		TTF_FILTERED = 0x1,
+		TTF_SRGB = 0x2,
+		TTF_CUBEMAP = 0x4,
+		TTF_MIPS = 0x8,
+		TTF_DEPTHSTENCIL = 0x10
+	};
+
+	struct YumeAPIExport TransientTargetDesc
+	{
+		TransientTargetDesc();
+		TransientTargetDesc(int width,int height,unsigned format,unsigned flags = 0,unsigned multiSample = 1,unsigned persistentKey = 0);
+
+		bool operator ==(const TransientTargetDesc& rhs) const;
+		bool operator !=(const TransientTargetDesc& rhs) const { return !(*this == rhs); }
+
+		unsigned ToHash() const;
+
+		int Width;
+		int Height;
+		unsigned Format;
+		unsigned Flags;
+		unsigned MultiSample;
+		//Targets with different persistent keys never alias each other
+		unsigned PersistentKey;
+	};
+
+	struct YumeAPIExport RenderTargetPoolStats
+	{
+		RenderTargetPoolStats();
+
+		float GetHitRate() const { return Requests ? (float)Hits / (float)Requests : 1.0f; }
+
+		unsigned long long AllocatedBytes;
+		unsigned long long PeakBytes;
+		unsigned NumTargets;
+		unsigned NumInUse;
+		unsigned Requests;
+		unsigned Hits;
+		unsigned Misses;
+		unsigned Evictions;
+	};
+
+	class YumeAPIExport YumeRenderTargetPool : public YumeBase
+	{
+	public:
+		YumeRenderTargetPool();
+		virtual ~YumeRenderTargetPool();
+
+		//Releases every target acquired in an earlier frame
+		void BeginFrame(unsigned frameNumber);
+		//Drops targets idle for too long, then trims down to the memory budget
+		void EndFrame();
+
+		TexturePtr Acquire(const TransientTargetDesc& desc);
+		//Gives a target back before the frame ends so later calls can alias it
+		void Release(TexturePtr texture);
+
+		void Trim(unsigned long long budget);
+		void Clear();
+
+		void SetMemoryBudget(unsigned long long bytes) { memoryBudget_ = bytes; }
+		unsigned long long GetMemoryBudget() const { return memoryBudget_; }
+
+		void SetMaxUnusedFrames(unsigned frames) { maxUnusedFrames_ = frames; }
+		unsigned GetMaxUnusedFrames() const { return maxUnusedFrames_; }
+
+		unsigned GetFrameNumber() const { return frameNumber_; }
+
+		//Totals since the pool was created, counters are reset each frame
+		const RenderTargetPoolStats& GetStats() const { return stats_; }
+		const RenderTargetPoolStats& GetFrameStats() const { return frameStats_; }
+
+	private:
+		struct PooledTarget
+		{
+			SharedPtr<YumeTexture> Texture;
+			TransientTargetDesc Desc;
+			unsigned long long Bytes;
+			unsigned LastUsedFrame;
+			bool InUse;
+		};
+
+		typedef YumeVector<PooledTarget> PooledTargets;
+
+		SharedPtr<YumeTexture> CreateTarget(const TransientTargetDesc& desc);
+		unsigned long long GetTargetSize(YumeTexture* texture,const TransientTargetDesc& desc) const;
+		void Evict(unsigned index);
+		void UpdateStats();
+
+		PooledTargets::type targets_;
+
+		unsigned frameNumber_;
+		unsigned maxUnusedFrames_;
+		unsigned long long memoryBudget_;
+
+		RenderTargetPoolStats stats_;
+		RenderTargetPoolStats frameStats_;
+	};
+}
+
+
+//----------------------------------------------------------------------------
+#endif
@@ -264,6 +264,20 @@ namespace YumeEngine
 
 	struct RenderTargetDesc
 	{
+		RenderTargetDesc()
+			: Index(0),
+			Width(0),
+			Height(0),
+			Depth(0),
+			Format(0),
+			ArraySize(0),
+			Mips(0),
+			Usage(TEXTURE_STATIC),
+			Type(0),
+			ScreenRelative(false)
+		{
+		}
+
 		unsigned Index;
 		unsigned Width;
 		unsigned Height;
@@ -279,6 +293,9 @@ namespace YumeEngine
 
 		unsigned Type;
 		YumeColor ClearColor;
+
+		//Sized relative to the backbuffer, follows the dynamic resolution scale
+		bool ScreenRelative;
 	};
 
 	enum TextureFilterModes
@@ -99,8 +99,26 @@ namespace YumeEngine
 
 	YumeString YumeShader::NormalizeDefines(const YumeString& defines)
 	{
-		Vector<String> definesVec = defines.ToUpper().Split(' ');
+		SmallStringVector::type definesVec;
+		ParseFlags(defines.c_str(),definesVec);
+
+		for(unsigned i = 0; i < definesVec.size(); ++i)
+		{
+			YumeSmallString& define = definesVec[i];
+			for(unsigned j = 0; j < define.length(); ++j)
+				define[j] = (char)toupper(define[j]);
+		}
+
 		Sort(definesVec.begin(),definesVec.end());
-		return String::Joined(definesVec," ");
+
+		YumeString ret;
+		ret.Reserve(defines.length() + 1);
+		for(unsigned i = 0; i < definesVec.size(); ++i)
+		{
+			if(i)
+				ret += ' ';
+			ret += definesVec[i];
+		}
+		return ret;
 	}
 }
@@ -45,6 +45,8 @@ namespace YumeEngine
 
 		virtual bool SetSize(int width,int height,unsigned format,TextureUsage usage = TEXTURE_STATIC,int arraySize = 1,int mips = 1) = 0;
 		virtual bool SetData(unsigned level,int x,int y,int width,int height,const void* data) = 0;
+		//One slice of an array texture
+		virtual bool SetSliceData(unsigned level,unsigned slice,int x,int y,int width,int height,const void* data) = 0;
 		virtual bool SetData(unsigned level,int x,int y,int width,int height,unsigned f1,unsigned f2,unsigned f3,const void* data) = 0;
 		virtual bool SetData(SharedPtr<YumeImage> image,bool useAlpha = false) = 0;
 		virtual bool GetData(unsigned level,void* dest) const = 0;
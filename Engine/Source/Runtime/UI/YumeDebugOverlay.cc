@@ -25,6 +25,7 @@
 #include "Renderer/YumeRHI.h"
 #include "Engine/YumeEngine.h"
 #include "Core/YumeDefaults.h"
+#include "Core/YumeProfiler.h"
 
 #include "Renderer/YumeMiscRenderer.h"
 #include "Renderer/YumeLPVCamera.h"
@@ -277,6 +278,7 @@ namespace YumeEngine
 		float fps = 1.0f / gYume->pEngine->GetSmoothedTimestep();
 		int batchCount = gYume->pRHI->GetNumBatches();
 		int primitives = gYume->pRHI->GetNumPrimitives();
+		const RHIStateStats& stateStats = gYume->pRHI->GetStateStats();
 
 		unsigned long long totalMemory = gYume->pResourceManager->GetTotalMemoryUse();
 
@@ -286,7 +288,9 @@ namespace YumeEngine
 		ret.AppendWithFormat("\"ElapsedTime\": \"%f\",",elapsedTime);
 		ret.AppendWithFormat("\"FrameRate\": \"%f\",",fps);
 		ret.AppendWithFormat("\"PrimitiveCount\": \"%i\",",primitives);
-		ret.AppendWithFormat("\"BatchCount\": \"%i\"",batchCount);
+		ret.AppendWithFormat("\"BatchCount\": \"%i\",",batchCount);
+		ret.AppendWithFormat("\"StateChanges\": \"%u\",",stateStats.GetTotalIssued());
+		ret.AppendWithFormat("\"StatesFiltered\": \"%u\"",stateStats.GetTotalFiltered());
 
 
 
@@ -294,6 +298,44 @@ namespace YumeEngine
 		ret.append("}");
 		gYume->pUI->SendEvent("setFrameInfo",ret);
 
+#if YUME_PROFILING
+		//Main thread zones two levels deep, the full tree is in the trace capture
+		YumeVector<ProfilerZoneStats>::type zones;
+		YumeProfiler::Get().GetStats(zones,2);
+
+		YumeString profiler;
+		profiler.append("{\"Zones\": [");
+		for(unsigned i = 0; i < zones.size(); ++i)
+		{
+			const ProfilerZoneStats& zone = zones[i];
+			if(zone.Thread || !zone.Depth)
+				continue;
+
+			if(profiler.Back() != '[')
+				profiler.append(",");
+			profiler.AppendWithFormat("{\"Name\": \"%s\", \"Depth\": %u, \"Avg\": \"%f\", \"Min\": \"%f\", \"Max\": \"%f\"}",
+				zone.Name,zone.Depth,zone.AvgMs,zone.MinMs,zone.MaxMs);
+		}
+
+		//Render calls on the GPU, a few frames behind
+		YumeGpuTimer& gpuTimer = gYume->pRHI->GetGpuTimer();
+		YumeVector<GpuScopeStats>::type scopes;
+		gpuTimer.GetStats(scopes);
+
+		profiler.AppendWithFormat("], \"GpuFrame\": \"%f\", \"Gpu\": [",gpuTimer.GetFrameMs());
+		for(unsigned i = 0; i < scopes.size(); ++i)
+		{
+			const GpuScopeStats& scope = scopes[i];
+
+			if(profiler.Back() != '[')
+				profiler.append(",");
+			profiler.AppendWithFormat("{\"Name\": \"%s\", \"Depth\": %u, \"Avg\": \"%f\", \"Min\": \"%f\", \"Max\": \"%f\"}",
+				scope.Name,scope.Depth + 1,scope.AvgMs,scope.MinMs,scope.MaxMs);
+		}
+		profiler.append("]}");
+		gYume->pUI->SendEvent("setProfilerInfo",profiler);
+#endif
+
 #ifndef SOMETHING_STRANGE
 		YumeCamera* cam = gYume->pRenderer->GetViewport(0)->GetCamera();
 		YumeString camera;
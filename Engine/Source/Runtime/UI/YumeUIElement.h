@@ -37,7 +37,8 @@ namespace YumeEngine
 	};
 
 	class YumeAPIExport YumeUIElement :
-		public YumeBase
+		public YumeBase,
+		public UIObjAlloc
 	{
 	public:
 		YumeUIElement(int width,int height,UIElementType type = Overlay,const YumeString& name = "UIElement");
@@ -0,0 +1,235 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//Benchmark.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "Benchmark.h"
+#include "Logging/logging.h"
+#include "Core/YumeMain.h"
+
+#include "Core/YumeDefaults.h"
+#include "Core/YumeEnvironment.h"
+#include "Core/YumeIO.h"
+#include "Core/YumeXmlFile.h"
+
+#include "Engine/YumeEngine.h"
+
+#include "Renderer/YumeResourceManager.h"
+#include "Renderer/YumeMiscRenderer.h"
+
+YUME_DEFINE_ENTRY_POINT(YumeEngine::BenchmarkApplication);
+
+namespace YumeEngine
+{
+	static bool WriteTextFile(const YumeString& fileName,const YumeString& text)
+	{
+		FILE* file = fopen(fileName.c_str(),"wb");
+		if(!file)
+			return false;
+
+		bool written = fwrite(text.c_str(),1,text.length(),file) == text.length();
+		fclose(file);
+		return written;
+	}
+
+	static bool ReadTextFile(const YumeString& fileName,YumeString& text)
+	{
+		FILE* file = fopen(fileName.c_str(),"rb");
+		if(!file)
+			return false;
+
+		text.Clear();
+		char buffer[4096];
+		size_t read = 0;
+		while((read = fread(buffer,1,sizeof buffer,file)) > 0)
+			text.append(buffer,(unsigned)read);
+		fclose(file);
+		return true;
+	}
+
+	BenchmarkApplication::BenchmarkApplication()
+		: scenarioFile_("Benchmarks/Scenarios.xml"),
+		updateBaseline_(false)
+	{
+	}
+
+	BenchmarkApplication::~BenchmarkApplication()
+	{
+	}
+
+	void BenchmarkApplication::Setup()
+	{
+		engineVariants_["ResourceTree"] = YumeString("Engine/Assets");
+		//The scene scenarios drive the deferred renderer, rasterized on the CPU
+		engineVariants_["Renderer"] = YumeString("Software");
+		engineVariants_["GI"] = NoGI;
+		engineVariants_["WindowWidth"] = 640;
+		engineVariants_["WindowHeight"] = 360;
+		engineVariants_["NoUI"] = YumeString("1");
+
+		YumeVector<YumeString>::type params = GetArguments();
+
+		for(unsigned i = 1; i < params.size(); ++i)
+		{
+			YumeString param = params[i];
+
+			if(param.Contains('='))
+			{
+				YumeVector<YumeString>::type split = param.Split('=');
+				YumeString left = split[0];
+				YumeString right = split.size() > 1 ? split[1] : YumeString();
+
+				if(left == "Scenarios")
+					scenarioFile_ = right;
+				if(left == "Output")
+					outputFile_ = right;
+				if(left == "Baseline")
+					baselineFile_ = right;
+				if(left == "Filter")
+					filter_ = right;
+				if(left == "UpdateBaseline")
+					updateBaseline_ = atoi(right.c_str()) != 0;
+			}
+		}
+	}
+
+	void BenchmarkApplication::Start()
+	{
+		if(outputFile_.empty())
+			outputFile_ = (gYume->pEnv->GetLogFile().parent_path() / "Benchmark.json").generic_string().c_str();
+		if(baselineFile_.empty())
+			baselineFile_ = (gYume->pIO->GetBinaryRoot() / "Engine/Assets/Benchmarks/Baseline.json").generic_string().c_str();
+
+		YumeVector<BenchmarkResult>::type results;
+		unsigned failed = RunScenarios(results);
+
+		YumeVector<BenchmarkComparison>::type comparisons;
+		unsigned regressions = 0;
+
+		if(updateBaseline_)
+		{
+			YumeString baseline;
+			WriteBenchmarkBaseline(results,baseline);
+			if(WriteTextFile(baselineFile_,baseline))
+				YUMELOG_INFO("Benchmark baseline written to " << baselineFile_.c_str());
+			else
+			{
+				YUMELOG_ERROR("Could not write benchmark baseline " << baselineFile_.c_str());
+				++failed;
+			}
+		}
+		else
+			regressions = CompareBaseline(results,comparisons);
+
+		YumeString json;
+		WriteBenchmarkJson(results,comparisons,json);
+		if(WriteTextFile(outputFile_,json))
+			YUMELOG_INFO("Benchmark results written to " << outputFile_.c_str());
+		else
+		{
+			YUMELOG_ERROR("Could not write benchmark results " << outputFile_.c_str());
+			++failed;
+		}
+
+		YUMELOG_INFO("Benchmark finished: " << results.size() << " scenarios, " << failed << " failed, " << regressions << " regressions");
+
+		//Nothing to render, the main loop never runs
+		engine_->Exit();
+		exitCode_ = (failed || regressions) ? 1 : 0;
+	}
+
+	unsigned BenchmarkApplication::RunScenarios(YumeVector<BenchmarkResult>::type& results)
+	{
+		YumeXmlFile* file = gYume->pResourceManager->PrepareResource<YumeXmlFile>(scenarioFile_);
+		if(!file)
+		{
+			YUMELOG_ERROR("Could not load benchmark scenarios " << scenarioFile_.c_str());
+			return 1;
+		}
+
+		pugi::xml_document doc;
+		if(!doc.load(file->GetXml().c_str()))
+		{
+			YUMELOG_ERROR("Could not parse benchmark scenarios " << scenarioFile_.c_str());
+			return 1;
+		}
+
+		unsigned failed = 0;
+
+		for(pugi::xml_node node = doc.child("Benchmarks").child("Scenario"); node; node = node.next_sibling("Scenario"))
+		{
+			YumeString name = node.attribute("Name").as_string();
+			if(!filter_.empty() && !name.Contains(filter_,false))
+				continue;
+
+			SharedPtr<BenchmarkScenario> scenario(BenchmarkScenario::Create(node.attribute("Type").as_string()));
+			if(!scenario)
+			{
+				YUMELOG_ERROR("Benchmark scenario " << name.c_str() << " has an unknown type " << node.attribute("Type").as_string());
+				++failed;
+				continue;
+			}
+
+			if(!scenario->Load(node))
+			{
+				++failed;
+				continue;
+			}
+
+			YUMELOG_INFO("Running benchmark " << name.c_str() << "...");
+
+			BenchmarkResult result;
+			if(!scenario->Run(result))
+			{
+				++failed;
+				continue;
+			}
+
+			for(unsigned i = 0; i < result.Metrics.size(); ++i)
+				YUMELOG_INFO("    " << result.Metrics[i].Name.c_str() << ": " << result.Metrics[i].Value);
+
+			results.push_back(result);
+		}
+
+		return failed;
+	}
+
+	unsigned BenchmarkApplication::CompareBaseline(const YumeVector<BenchmarkResult>::type& results,YumeVector<BenchmarkComparison>::type& comparisons)
+	{
+		YumeString baseline;
+		if(!ReadTextFile(baselineFile_,baseline))
+		{
+			//Baselines are per machine, the first run on a new one has nothing to compare against
+			YUMELOG_WARN("No benchmark baseline at " << baselineFile_.c_str() << ", run with UpdateBaseline=1 to record one");
+			return 0;
+		}
+
+		if(!CompareBenchmarkBaseline(baseline,results,comparisons))
+			return 1;
+
+		unsigned regressions = 0;
+		for(unsigned i = 0; i < comparisons.size(); ++i)
+		{
+			const BenchmarkComparison& comparison = comparisons[i];
+			if(comparison.Verdict == BENCHMARK_WITHIN)
+				continue;
+
+			if(comparison.Verdict == BENCHMARK_IMPROVED)
+			{
+				YUMELOG_INFO(comparison.Scenario.c_str() << "." << comparison.Metric.c_str() << " improved: " <<
+					comparison.Measured << " against " << comparison.Baseline);
+				continue;
+			}
+
+			YUMELOG_ERROR(comparison.Scenario.c_str() << "." << comparison.Metric.c_str() << " " << GetBenchmarkVerdictName(comparison.Verdict) << ": " <<
+				comparison.Measured << " against " << comparison.Baseline << " with tolerance " << comparison.Tolerance);
+			++regressions;
+		}
+
+		return regressions;
+	}
+}
@@ -0,0 +1,45 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//Benchmark.h
+//--------------------------------------------------------------------------------
+#ifndef __Benchmark_h__
+#define __Benchmark_h__
+//--------------------------------------------------------------------------------
+#include "Engine/YumeApplication.h"
+#include "BenchmarkReport.h"
+//--------------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Headless on the Software renderer, no window. Runs the scenario script, writes the results as JSON and
+	//compares them against a stored baseline. Exits with 1 on a regression so it can gate a build.
+	//
+	//Arguments: Scenarios=<resource> Output=<file> Baseline=<file> Filter=<name part> UpdateBaseline=1
+	class BenchmarkApplication : public YumeApplication
+	{
+	public:
+		BenchmarkApplication();
+		~BenchmarkApplication();
+
+		virtual void Setup();
+		virtual void Start();
+
+	private:
+		//Returns the number of scenarios that failed to load or run
+		unsigned RunScenarios(YumeVector<BenchmarkResult>::type& results);
+		//Returns the number of regressions, missing metrics count as regressions
+		unsigned CompareBaseline(const YumeVector<BenchmarkResult>::type& results,YumeVector<BenchmarkComparison>::type& comparisons);
+
+		YumeString scenarioFile_;
+		YumeString outputFile_;
+		YumeString baselineFile_;
+		YumeString filter_;
+		bool updateBaseline_;
+	};
+}
+
+//--------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,216 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchmarkReport.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "BenchmarkReport.h"
+#include "Logging/logging.h"
+
+#include <sstream>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+namespace YumeEngine
+{
+	static const char* verdictNames[] =
+	{
+		"Within",
+		"Improved",
+		"Regressed",
+		"Missing"
+	};
+
+	const char* GetBenchmarkVerdictName(BenchmarkVerdict verdict)
+	{
+		return verdictNames[verdict];
+	}
+
+	static void AppendJsonString(YumeString& dest,const YumeString& value)
+	{
+		dest += '"';
+		for(unsigned i = 0; i < value.length(); ++i)
+		{
+			char c = value[i];
+			if(c == '"' || c == '\\')
+				dest += '\\';
+			if((unsigned char)c >= 0x20)
+				dest += c;
+		}
+		dest += '"';
+	}
+
+	//AppendWithFormat has no precision
+	static void AppendJsonNumber(YumeString& dest,double value)
+	{
+		char buffer[64];
+		sprintf(buffer,"%.4f",value);
+		dest.append(buffer);
+	}
+
+	void WriteBenchmarkJson(const YumeVector<BenchmarkResult>::type& results,const YumeVector<BenchmarkComparison>::type& comparisons,YumeString& dest)
+	{
+		dest.Clear();
+		dest += "{\n\t\"Scenarios\": [";
+
+		for(unsigned i = 0; i < results.size(); ++i)
+		{
+			const BenchmarkResult& result = results[i];
+
+			dest += i ? ",\n\t\t{\n\t\t\t\"Name\": " : "\n\t\t{\n\t\t\t\"Name\": ";
+			AppendJsonString(dest,result.Name);
+			dest += ",\n\t\t\t\"Type\": ";
+			AppendJsonString(dest,result.Type);
+			dest.AppendWithFormat(",\n\t\t\t\"Frames\": %u,\n\t\t\t\"Metrics\": {",result.Frames);
+
+			for(unsigned j = 0; j < result.Metrics.size(); ++j)
+			{
+				dest += j ? ",\n\t\t\t\t" : "\n\t\t\t\t";
+				AppendJsonString(dest,result.Metrics[j].Name);
+				dest += ": ";
+				AppendJsonNumber(dest,result.Metrics[j].Value);
+			}
+
+			dest += "\n\t\t\t}\n\t\t}";
+		}
+
+		dest += "\n\t],\n\t\"Comparison\": [";
+
+		for(unsigned i = 0; i < comparisons.size(); ++i)
+		{
+			const BenchmarkComparison& comparison = comparisons[i];
+
+			dest += i ? ",\n\t\t{ \"Scenario\": " : "\n\t\t{ \"Scenario\": ";
+			AppendJsonString(dest,comparison.Scenario);
+			dest += ", \"Metric\": ";
+			AppendJsonString(dest,comparison.Metric);
+			dest += ", \"Baseline\": ";
+			AppendJsonNumber(dest,comparison.Baseline);
+			dest += ", \"Measured\": ";
+			AppendJsonNumber(dest,comparison.Measured);
+			dest += ", \"Tolerance\": ";
+			AppendJsonNumber(dest,comparison.Tolerance);
+			dest += ", \"Verdict\": ";
+			AppendJsonString(dest,verdictNames[comparison.Verdict]);
+			dest += " }";
+		}
+
+		dest += "\n\t]\n}\n";
+	}
+
+	void WriteBenchmarkBaseline(const YumeVector<BenchmarkResult>::type& results,YumeString& dest)
+	{
+		dest.Clear();
+		dest += "{\n\t\"Scenarios\": {";
+
+		for(unsigned i = 0; i < results.size(); ++i)
+		{
+			const BenchmarkResult& result = results[i];
+
+			dest += i ? ",\n\t\t" : "\n\t\t";
+			AppendJsonString(dest,result.Name);
+			dest += ": {";
+
+			for(unsigned j = 0; j < result.Metrics.size(); ++j)
+			{
+				const BenchmarkMetric& metric = result.Metrics[j];
+
+				dest += j ? ",\n\t\t\t" : "\n\t\t\t";
+				AppendJsonString(dest,metric.Name);
+				dest += ": { \"Value\": ";
+				AppendJsonNumber(dest,metric.Value);
+				dest += ", \"Tolerance\": ";
+				AppendJsonNumber(dest,metric.Kind == BENCHMARK_METRIC_TIME ? result.TimeTolerance : result.CountTolerance);
+				dest += " }";
+			}
+
+			dest += "\n\t\t}";
+		}
+
+		dest += "\n\t}\n}\n";
+	}
+
+	bool CompareBenchmarkBaseline(const YumeString& baseline,const YumeVector<BenchmarkResult>::type& results,YumeVector<BenchmarkComparison>::type& dest)
+	{
+		typedef boost::property_tree::ptree Tree;
+
+		dest.clear();
+
+		Tree tree;
+		try
+		{
+			std::istringstream stream(std::string(baseline.c_str(),baseline.length()));
+			boost::property_tree::read_json(stream,tree);
+		}
+		catch(const boost::property_tree::json_parser_error& e)
+		{
+			YUMELOG_ERROR("Could not parse benchmark baseline: " << e.what());
+			return false;
+		}
+
+		//Metric names are matched on the child keys directly, ptree paths would split them on dots
+		boost::optional<Tree&> scenarios = tree.get_child_optional("Scenarios");
+		if(!scenarios)
+			return true;
+
+		for(Tree::const_iterator s = scenarios->begin(); s != scenarios->end(); ++s)
+		{
+			YumeString scenarioName = s->first.c_str();
+
+			const BenchmarkResult* result = 0;
+			for(unsigned i = 0; i < results.size(); ++i)
+			{
+				if(results[i].Name == scenarioName)
+					result = &results[i];
+			}
+
+			for(Tree::const_iterator m = s->second.begin(); m != s->second.end(); ++m)
+			{
+				BenchmarkComparison comparison;
+				comparison.Scenario = scenarioName;
+				comparison.Metric = m->first.c_str();
+				comparison.Baseline = m->second.get<double>("Value",0.0);
+				comparison.Tolerance = m->second.get<double>("Tolerance",0.0);
+				comparison.Measured = 0;
+				comparison.Verdict = BENCHMARK_MISSING;
+
+				const BenchmarkMetric* metric = 0;
+				if(result)
+				{
+					for(unsigned i = 0; i < result->Metrics.size(); ++i)
+					{
+						if(result->Metrics[i].Name == comparison.Metric)
+							metric = &result->Metrics[i];
+					}
+				}
+
+				if(metric)
+				{
+					double slack = metric->Kind == BENCHMARK_METRIC_TIME ? BENCHMARK_TIME_SLACK_MS : BENCHMARK_COUNT_SLACK;
+					double upper = comparison.Baseline * (1.0 + comparison.Tolerance) + slack;
+					double lower = comparison.Baseline * (1.0 - comparison.Tolerance) - slack;
+
+					comparison.Measured = metric->Value;
+					if(metric->Value > upper)
+						comparison.Verdict = BENCHMARK_REGRESSED;
+					else if(metric->Value < lower)
+						comparison.Verdict = BENCHMARK_IMPROVED;
+					else
+						comparison.Verdict = BENCHMARK_WITHIN;
+				}
+				else if(!result)
+				{
+					//A scenario filtered out of this run is not a failure
+					continue;
+				}
+
+				dest.push_back(comparison);
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchmarkReport.h
+//--------------------------------------------------------------------------------
+#ifndef __BenchmarkReport_h__
+#define __BenchmarkReport_h__
+//--------------------------------------------------------------------------------
+#include "BenchmarkScenario.h"
+//--------------------------------------------------------------------------------
+namespace YumeEngine
+{
+	//Time metrics closer than this to the baseline never fail, sub-frame phases are mostly timer noise
+	static const double BENCHMARK_TIME_SLACK_MS = 0.02;
+	//Baselines are written with four decimals, per frame averages do not come back exactly
+	static const double BENCHMARK_COUNT_SLACK = 0.001;
+
+	enum BenchmarkVerdict
+	{
+		BENCHMARK_WITHIN = 0,
+		BENCHMARK_IMPROVED,
+		BENCHMARK_REGRESSED,
+		//In the baseline but not measured, the scenario failed or the metric is gone
+		BENCHMARK_MISSING
+	};
+
+	struct BenchmarkComparison
+	{
+		YumeString Scenario;
+		YumeString Metric;
+		double Baseline;
+		double Measured;
+		double Tolerance;
+		BenchmarkVerdict Verdict;
+	};
+
+	//{"Scenarios":[{"Name":..,"Type":..,"Frames":..,"Metrics":{..}}],"Comparison":[..]}
+	void WriteBenchmarkJson(const YumeVector<BenchmarkResult>::type& results,const YumeVector<BenchmarkComparison>::type& comparisons,YumeString& dest);
+
+	//{"Scenarios":{"<Name>":{"<Metric>":{"Value":..,"Tolerance":..}}}}, tolerances come from the scenario script
+	//and can be edited by hand afterwards
+	void WriteBenchmarkBaseline(const YumeVector<BenchmarkResult>::type& results,YumeString& dest);
+
+	//Every metric of the baseline gets one entry, lower is better for all of them. Scenarios that are
+	//only on one side are skipped, the caller knows which failed. Returns false if the baseline can not be parsed.
+	bool CompareBenchmarkBaseline(const YumeString& baseline,const YumeVector<BenchmarkResult>::type& results,YumeVector<BenchmarkComparison>::type& dest);
+
+	const char* GetBenchmarkVerdictName(BenchmarkVerdict verdict);
+}
+
+//--------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,789 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchmarkScenario.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "BenchmarkScenario.h"
+#include "Logging/logging.h"
+
+#include "Core/YumeDefaults.h"
+#include "Core/YumeEnvironment.h"
+#include "Core/YumeFrameArena.h"
+#include "Core/YumeProfiler.h"
+#include "Core/YumeTimer.h"
+#include "Core/YumeXmlFile.h"
+
+#include "Math/YumeMath.h"
+
+#include "Renderer/Batch.h"
+#include "Renderer/Light.h"
+#include "Renderer/Material.h"
+#include "Renderer/Scene.h"
+#include "Renderer/StaticModel.h"
+#include "Renderer/YumeGeometry.h"
+#include "Renderer/YumeIndexBuffer.h"
+#include "Renderer/YumeMiscRenderer.h"
+#include "Renderer/YumeLPVCamera.h"
+#include "Renderer/YumeResourceManager.h"
+#include "Renderer/YumeRHI.h"
+#include "Renderer/YumeVertexBuffer.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+
+using namespace DirectX;
+
+namespace YumeEngine
+{
+	static const char* phaseNames[] =
+	{
+		"Update",
+		"Render",
+		"Load"
+	};
+
+	//Position, normal, texcoord and tangent, the mesh layout the G-buffer shader takes
+	static const unsigned BOX_VERTEX_FLOATS = 11;
+
+	//Seeded explicitly so every run builds the same scene on every platform
+	static float RandomRange(unsigned& seed,float min,float max)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return min + (max - min) * (float)(seed >> 8) / 16777216.0f;
+	}
+
+	static float GetKindExtent(unsigned kind)
+	{
+		return 0.5f + (kind % 4) * 0.25f;
+	}
+
+	//Four vertices per face so every face has its own normal, clockwise seen from outside
+	static YumeGeometry* CreateBox(float extent)
+	{
+		//Normal and tangent of each face
+		static const float faces[6][6] =
+		{
+			{1,0,0,0,0,1},
+			{-1,0,0,0,0,-1},
+			{0,1,0,1,0,0},
+			{0,-1,0,-1,0,0},
+			{0,0,1,-1,0,0},
+			{0,0,-1,1,0,0}
+		};
+		static const float corners[4][2] ={{-1,-1},{-1,1},{1,1},{1,-1}};
+		static const unsigned short faceIndices[6] ={0,2,1,0,3,2};
+
+		float vertices[24 * BOX_VERTEX_FLOATS];
+		unsigned short indices[36];
+
+		for(unsigned f = 0; f < 6; ++f)
+		{
+			Vector3 normal(faces[f][0],faces[f][1],faces[f][2]);
+			Vector3 tangent(faces[f][3],faces[f][4],faces[f][5]);
+			Vector3 bitangent = normal.CrossProduct(tangent);
+
+			for(unsigned c = 0; c < 4; ++c)
+			{
+				Vector3 position = (normal + tangent * corners[c][0] + bitangent * corners[c][1]) * extent;
+
+				float* v = vertices + (f * 4 + c) * BOX_VERTEX_FLOATS;
+				v[0] = position.x_;
+				v[1] = position.y_;
+				v[2] = position.z_;
+				v[3] = normal.x_;
+				v[4] = normal.y_;
+				v[5] = normal.z_;
+				v[6] = (corners[c][0] + 1.0f) * 0.5f;
+				v[7] = (1.0f - corners[c][1]) * 0.5f;
+				v[8] = tangent.x_;
+				v[9] = tangent.y_;
+				v[10] = tangent.z_;
+			}
+
+			for(unsigned i = 0; i < 6; ++i)
+				indices[f * 6 + i] = (unsigned short)(f * 4 + faceIndices[i]);
+		}
+
+		SharedPtr<YumeVertexBuffer> vb(gYume->pRHI->CreateVertexBuffer());
+		vb->SetShadowed(true);
+		vb->SetSize(24,MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT);
+		vb->SetData(vertices);
+
+		SharedPtr<YumeIndexBuffer> ib(gYume->pRHI->CreateIndexBuffer());
+		ib->SetShadowed(true);
+		ib->SetSize(36,false);
+		ib->SetData(indices);
+
+		YumeGeometry* geometry = new YumeGeometry;
+		geometry->SetVertexBuffer(0,vb);
+		geometry->SetIndexBuffer(ib);
+		geometry->SetDrawRange(TRIANGLE_LIST,0,36);
+		geometry->SetBoundingBox(XMFLOAT3(-extent,-extent,-extent),XMFLOAT3(extent,extent,extent));
+		return geometry;
+	}
+
+	static Vector3 ParseVector3(const char* value)
+	{
+		Vector3 v(Vector3::ZERO);
+		sscanf(value,"%f %f %f",&v.x_,&v.y_,&v.z_);
+		return v;
+	}
+
+	BenchmarkCameraPath::BenchmarkCameraPath()
+		: center_(Vector3::ZERO),
+		radius_(1.0f),
+		height_(0),
+		orbit_(true)
+	{
+	}
+
+	bool BenchmarkCameraPath::Load(const pugi::xml_node& node,const Vector3& center,float radius)
+	{
+		center_ = center;
+		radius_ = node.attribute("CameraRadius").as_float(radius);
+		height_ = node.attribute("CameraHeight").as_float(radius * 0.25f);
+
+		points_.clear();
+		for(pugi::xml_node point = node.child("Point"); point; point = point.next_sibling("Point"))
+			points_.push_back(ParseVector3(point.attribute("Position").as_string()));
+
+		YumeString camera = node.attribute("Camera").as_string("Orbit");
+		if(camera == "Orbit")
+		{
+			orbit_ = true;
+			return true;
+		}
+
+		if(camera == "Path" && points_.size() >= 2)
+		{
+			orbit_ = false;
+			return true;
+		}
+
+		YUMELOG_ERROR("Benchmark camera " << camera.c_str() << " needs to be Orbit or a Path with at least two points");
+		return false;
+	}
+
+	Vector3 BenchmarkCameraPath::Evaluate(float t) const
+	{
+		t -= floorf(t);
+
+		if(orbit_)
+		{
+			float angle = t * 360.0f;
+			return center_ + Vector3(Cos(angle) * radius_,height_,Sin(angle) * radius_);
+		}
+
+		//Closed Catmull-Rom through every point
+		unsigned count = points_.size();
+		float segment = t * count;
+		unsigned i = Min((unsigned)segment,count - 1);
+		float f = segment - (float)i;
+
+		const Vector3& p0 = points_[(i + count - 1) % count];
+		const Vector3& p1 = points_[i];
+		const Vector3& p2 = points_[(i + 1) % count];
+		const Vector3& p3 = points_[(i + 2) % count];
+
+		float f2 = f * f;
+		float f3 = f2 * f;
+		return (p1 * 2.0f + (p2 - p0) * f + (p0 * 2.0f - p1 * 5.0f + p2 * 4.0f - p3) * f2 + (p1 * 3.0f - p0 - p2 * 3.0f + p3) * f3) * 0.5f;
+	}
+
+	void BenchmarkCameraPath::Sample(float t,Vector3& position,Quaternion& rotation) const
+	{
+		position = Evaluate(t);
+
+		Vector3 target = orbit_ ? center_ : Evaluate(t + 0.01f);
+		Vector3 direction = target - position;
+		if(direction.LengthSquared() < M_EPSILON)
+			direction = Vector3::FORWARD;
+
+		rotation = Quaternion::IDENTITY;
+		rotation.FromLookRotation(direction.Normalized());
+	}
+
+	BenchmarkScenario::BenchmarkScenario()
+		: frames_(600),
+		warmupFrames_(30),
+		timeStep_(1.0f / 60.0f),
+		timeTolerance_(0.15),
+		countTolerance_(0),
+		measuring_(false)
+	{
+		ResetStats();
+	}
+
+	BenchmarkScenario::~BenchmarkScenario()
+	{
+	}
+
+	BenchmarkScenario* BenchmarkScenario::Create(const YumeString& type)
+	{
+		if(type == "Scene")
+			return new SceneScenario;
+		if(type == "LoadStorm")
+			return new LoadStormScenario;
+		return 0;
+	}
+
+	const char* BenchmarkScenario::GetPhaseName(BenchmarkPhase phase)
+	{
+		return phaseNames[phase];
+	}
+
+	bool BenchmarkScenario::Load(const pugi::xml_node& node)
+	{
+		name_ = node.attribute("Name").as_string();
+		type_ = node.attribute("Type").as_string();
+		frames_ = Max(node.attribute("Frames").as_uint(frames_),1U);
+		warmupFrames_ = node.attribute("WarmupFrames").as_uint(warmupFrames_);
+		timeStep_ = 1.0f / Max(node.attribute("FrameRate").as_float(60.0f),1.0f);
+		timeTolerance_ = node.attribute("TimeTolerance").as_double(timeTolerance_);
+		countTolerance_ = node.attribute("CountTolerance").as_double(countTolerance_);
+
+		if(name_.empty())
+		{
+			YUMELOG_ERROR("Benchmark scenario of type " << type_.c_str() << " has no name");
+			return false;
+		}
+
+		return LoadParameters(node);
+	}
+
+	void BenchmarkScenario::ResetStats()
+	{
+		for(unsigned i = 0; i < MAX_BENCHMARK_PHASES; ++i)
+		{
+			phaseBegin_[i] = 0;
+			phaseFrame_[i] = 0;
+			phaseTotal_[i] = 0;
+			phaseMax_[i] = 0;
+			phaseFrames_[i] = 0;
+			phaseActive_[i] = false;
+		}
+
+		for(unsigned i = 0; i < counters_.size(); ++i)
+			counters_[i] = 0;
+	}
+
+	unsigned BenchmarkScenario::AddCounter(const YumeString& name)
+	{
+		counterNames_.push_back(name);
+		counters_.push_back(0);
+		return counters_.size() - 1;
+	}
+
+	void BenchmarkScenario::Count(unsigned counter,unsigned long long value)
+	{
+		if(measuring_)
+			counters_[counter] += value;
+	}
+
+	void BenchmarkScenario::BeginPhase(BenchmarkPhase phase)
+	{
+		phaseBegin_[phase] = YumeProfiler::GetTicks();
+	}
+
+	void BenchmarkScenario::EndPhase(BenchmarkPhase phase)
+	{
+		phaseFrame_[phase] += YumeProfiler::GetTicks() - phaseBegin_[phase];
+		phaseActive_[phase] = true;
+	}
+
+	bool BenchmarkScenario::Run(BenchmarkResult& result)
+	{
+		result.Name = name_;
+		result.Type = type_;
+		result.Frames = frames_;
+		result.TimeTolerance = timeTolerance_;
+		result.CountTolerance = countTolerance_;
+		result.Metrics.clear();
+
+		counterNames_.clear();
+		counters_.clear();
+		measuring_ = false;
+
+		if(!Setup())
+		{
+			YUMELOG_ERROR("Benchmark scenario " << name_.c_str() << " could not be set up");
+			Teardown();
+			return false;
+		}
+
+		YumeVector<double>::type frameMs;
+		frameMs.reserve(frames_);
+		unsigned long long allocations = 0;
+		unsigned long long allocatedBytes = 0;
+		unsigned arenaPeak = 0;
+
+		for(unsigned i = 0; i < warmupFrames_ + frames_; ++i)
+		{
+			bool measure = i >= warmupFrames_;
+			if(measure && !measuring_)
+			{
+				ResetStats();
+				measuring_ = true;
+			}
+
+			gYume->pTimer->BeginFrame(timeStep_);
+			gYume->pFrameArena->BeginFrame();
+#if YUME_MEMORY_TRACKING
+			YumeMemoryTracker::Get().BeginFrame();
+#endif
+
+			long long begin = YumeProfiler::GetTicks();
+			{
+				YUME_PROFILE("BenchmarkFrame");
+				RunFrame(measure ? i - warmupFrames_ : M_MAX_UNSIGNED,timeStep_);
+			}
+			long long end = YumeProfiler::GetTicks();
+
+			if(measure)
+			{
+				frameMs.push_back((double)(end - begin) / 1000000.0);
+
+				for(unsigned p = 0; p < MAX_BENCHMARK_PHASES; ++p)
+				{
+					if(!phaseActive_[p])
+						continue;
+					phaseTotal_[p] += phaseFrame_[p];
+					phaseMax_[p] = Max(phaseMax_[p],phaseFrame_[p]);
+					++phaseFrames_[p];
+				}
+
+#if YUME_MEMORY_TRACKING
+				for(unsigned c = 0; c < MAX_MEMORY_CATEGORIES; ++c)
+				{
+					MemoryCategoryStats stats = YumeMemoryTracker::Get().GetStats((MemoryCategory)c);
+					allocations += stats.FrameAllocations;
+					allocatedBytes += stats.FrameBytes;
+				}
+#endif
+				arenaPeak = Max(arenaPeak,gYume->pFrameArena->GetUsed());
+			}
+
+			for(unsigned p = 0; p < MAX_BENCHMARK_PHASES; ++p)
+			{
+				phaseFrame_[p] = 0;
+				phaseActive_[p] = false;
+			}
+
+			gYume->pTimer->EndFrame();
+			YUME_PROFILE_END_FRAME();
+		}
+
+		measuring_ = false;
+		Teardown();
+
+		double total = 0;
+		for(unsigned i = 0; i < frameMs.size(); ++i)
+			total += frameMs[i];
+		std::sort(&frameMs[0],&frameMs[0] + frameMs.size());
+
+		BenchmarkMetric metric;
+		metric.Kind = BENCHMARK_METRIC_TIME;
+
+		metric.Name = "FrameAvgMs";
+		metric.Value = total / frameMs.size();
+		result.Metrics.push_back(metric);
+
+		metric.Name = "FrameMedianMs";
+		metric.Value = frameMs[frameMs.size() / 2];
+		result.Metrics.push_back(metric);
+
+		metric.Name = "FrameP95Ms";
+		metric.Value = frameMs[Min((unsigned)(frameMs.size() * 95 / 100),frameMs.size() - 1)];
+		result.Metrics.push_back(metric);
+
+		metric.Name = "FrameMaxMs";
+		metric.Value = frameMs.back();
+		result.Metrics.push_back(metric);
+
+		for(unsigned p = 0; p < MAX_BENCHMARK_PHASES; ++p)
+		{
+			if(!phaseFrames_[p])
+				continue;
+
+			metric.Name = YumeString(phaseNames[p]) + "AvgMs";
+			metric.Value = (double)phaseTotal_[p] / phaseFrames_[p] / 1000000.0;
+			result.Metrics.push_back(metric);
+
+			metric.Name = YumeString(phaseNames[p]) + "MaxMs";
+			metric.Value = (double)phaseMax_[p] / 1000000.0;
+			result.Metrics.push_back(metric);
+		}
+
+		metric.Kind = BENCHMARK_METRIC_COUNT;
+
+#if YUME_MEMORY_TRACKING
+		metric.Name = "AllocationsPerFrame";
+		metric.Value = (double)allocations / frames_;
+		result.Metrics.push_back(metric);
+
+		metric.Name = "AllocatedBytesPerFrame";
+		metric.Value = (double)allocatedBytes / frames_;
+		result.Metrics.push_back(metric);
+#endif
+
+		metric.Name = "FrameArenaPeakBytes";
+		metric.Value = arenaPeak;
+		result.Metrics.push_back(metric);
+
+		for(unsigned i = 0; i < counters_.size(); ++i)
+		{
+			metric.Name = counterNames_[i] + "PerFrame";
+			metric.Value = (double)counters_[i] / frames_;
+			result.Metrics.push_back(metric);
+		}
+
+		return true;
+	}
+
+	BenchmarkPhaseScope::BenchmarkPhaseScope(BenchmarkScenario& scenario,BenchmarkPhase phase)
+		: scenario_(scenario),
+		phase_(phase)
+	{
+#if YUME_PROFILING
+		YumeProfiler::Get().BeginZone(phaseNames[phase]);
+#endif
+		scenario_.BeginPhase(phase_);
+	}
+
+	BenchmarkPhaseScope::~BenchmarkPhaseScope()
+	{
+		scenario_.EndPhase(phase_);
+#if YUME_PROFILING
+		YumeProfiler::Get().EndZone();
+#endif
+	}
+
+	SceneScenario::SceneScenario()
+		: numModels_(1024),
+		numKinds_(8),
+		numLights_(16),
+		spacing_(4.0f),
+		farClip_(1000.0f),
+		seed_(1),
+		directionalLight_(0),
+		time_(0)
+	{
+	}
+
+	SceneScenario::~SceneScenario()
+	{
+		Teardown();
+	}
+
+	bool SceneScenario::LoadParameters(const pugi::xml_node& node)
+	{
+		numModels_ = node.attribute("Models").as_uint(numModels_);
+		numKinds_ = Max(node.attribute("Kinds").as_uint(numKinds_),1U);
+		numLights_ = node.attribute("Lights").as_uint(numLights_);
+		spacing_ = node.attribute("Spacing").as_float(spacing_);
+		farClip_ = node.attribute("FarClip").as_float(farClip_);
+		seed_ = node.attribute("Seed").as_uint(seed_);
+
+		unsigned side = Max((unsigned)ceilf(sqrtf((float)numModels_)),1U);
+		float extent = side * spacing_ * 0.5f;
+		return camera_.Load(node,Vector3(0,spacing_ * 0.5f,0),extent * 1.2f);
+	}
+
+	bool SceneScenario::Setup()
+	{
+		Teardown();
+
+		YumeMiscRenderer* renderer = gYume->pRenderer;
+		if(!renderer || !gYume->pRHI)
+		{
+			YUMELOG_ERROR("Scene benchmarks need the renderer, it is not running");
+			return false;
+		}
+
+		Scene* scene = renderer->GetScene();
+		renderer->GetCamera()->SetFarClip(farClip_);
+
+		unsigned seed = seed_;
+		unsigned side = Max((unsigned)ceilf(sqrtf((float)numModels_)),1U);
+		float halfSide = side * 0.5f;
+
+		//Kind decides the mesh and the material, so the renderer switches both between kinds
+		geometries_.reserve(numKinds_);
+		materials_.reserve(numKinds_);
+		for(unsigned k = 0; k < numKinds_; ++k)
+		{
+			geometries_.push_back(SharedPtr<YumeGeometry>(CreateBox(GetKindExtent(k))));
+
+			SharedPtr<Material> material(new Material);
+			material->SetShaderParameter("DiffuseColor",XMFLOAT4(RandomRange(seed,0.2f,1.0f),RandomRange(seed,0.2f,1.0f),RandomRange(seed,0.2f,1.0f),1.0f));
+			material->SetShaderParameter("EmissiveColor",XMFLOAT4(0,0,0,0));
+			material->SetShaderParameter("SpecularColor",XMFLOAT4(0.04f,0.04f,0.04f,1.0f));
+			material->SetShaderParameter("ShadingMode",0.0f);
+			material->SetShaderParameter("Roughness",RandomRange(seed,0.2f,0.9f));
+			material->SetShaderParameter("has_diffuse_tex",false);
+			materials_.push_back(material);
+		}
+
+		models_.reserve(numModels_);
+		spin_.reserve(numModels_);
+		for(unsigned i = 0; i < numModels_; ++i)
+		{
+			unsigned kind = i % numKinds_;
+			float extent = GetKindExtent(kind);
+			float scale = RandomRange(seed,0.5f,1.5f);
+
+			SharedPtr<RenderBatch> batch(new RenderBatch);
+			batch->geo_ = geometries_[kind];
+			batch->material_ = materials_[kind];
+
+			StaticModel* model = new StaticModel("");
+			model->batches_.push_back(batch);
+			model->Initialize();
+			model->SetBoundingBox(XMFLOAT3(-extent,-extent,-extent),XMFLOAT3(extent,extent,extent));
+			model->SetScale(scale,scale,scale);
+			model->SetRotation(XMVectorSet(0,RandomRange(seed,0,XM_2PI),0,0));
+			model->SetPosition(XMVectorSet(
+				((float)(i % side) - halfSide) * spacing_,
+				RandomRange(seed,0,spacing_),
+				((float)(i / side) - halfSide) * spacing_,
+				0),true);
+
+			scene->AddNode(model);
+			models_.push_back(model);
+			//One in eight keeps turning so the update phase has work
+			spin_.push_back(i % 8 ? 0.0f : RandomRange(seed,0.5f,2.0f));
+		}
+
+		directionalLight_ = new Light;
+		directionalLight_->SetType(LT_DIRECTIONAL);
+		directionalLight_->SetPosition(XMVectorSet(0,spacing_ * 8.0f,0,0));
+		directionalLight_->SetDirection(XMVectorSet(0,-1,0,0));
+		directionalLight_->SetRotation(XMVectorSet(-1,0,0,0));
+		directionalLight_->SetColor(YumeColor(1,1,1,1));
+		scene->AddNode(directionalLight_);
+
+		lights_.reserve(numLights_);
+		lightOrigin_.reserve(numLights_);
+		for(unsigned i = 0; i < numLights_; ++i)
+		{
+			Vector3 origin(
+				RandomRange(seed,-halfSide,halfSide) * spacing_,
+				RandomRange(seed,1.0f,spacing_ * 2.0f),
+				RandomRange(seed,-halfSide,halfSide) * spacing_);
+
+			Light* light = new Light;
+			light->SetType(LT_POINT);
+			light->SetRange(RandomRange(seed,spacing_,spacing_ * 4.0f));
+			light->SetColor(YumeColor(RandomRange(seed,0,1),RandomRange(seed,0,1),RandomRange(seed,0,1)));
+			light->SetPosition(XMVectorSet(origin.x_,origin.y_,origin.z_,0),true);
+
+			scene->AddNode(light);
+			lights_.push_back(light);
+			lightOrigin_.push_back(origin);
+		}
+
+		time_ = 0;
+
+		drawsCounter_ = AddCounter("Draws");
+		primitivesCounter_ = AddCounter("Primitives");
+		occludedCounter_ = AddCounter("Occluded");
+		return true;
+	}
+
+	void SceneScenario::Teardown()
+	{
+		//The scene does not own its nodes
+		Scene* scene = gYume->pRenderer ? gYume->pRenderer->GetScene() : 0;
+
+		for(unsigned i = 0; i < models_.size(); ++i)
+		{
+			if(scene)
+				scene->RemoveNode(models_[i]);
+			delete models_[i];
+		}
+		for(unsigned i = 0; i < lights_.size(); ++i)
+		{
+			if(scene)
+				scene->RemoveNode(lights_[i]);
+			delete lights_[i];
+		}
+		if(directionalLight_)
+		{
+			if(scene)
+				scene->RemoveNode(directionalLight_);
+			delete directionalLight_;
+			directionalLight_ = 0;
+		}
+
+		models_.clear();
+		spin_.clear();
+		lights_.clear();
+		lightOrigin_.clear();
+		//Batches only point at the geometry, they went with the models
+		materials_.clear();
+		geometries_.clear();
+	}
+
+	void SceneScenario::RunFrame(unsigned frame,float timeStep)
+	{
+		time_ += timeStep;
+
+		YumeMiscRenderer* renderer = gYume->pRenderer;
+
+		{
+			BenchmarkPhaseScope phase(*this,BENCHMARK_PHASE_UPDATE);
+
+			for(unsigned i = 0; i < models_.size(); ++i)
+			{
+				if(spin_[i] != 0.0f)
+					models_[i]->SetRotation(XMVectorSet(0,time_ * spin_[i],0,0));
+			}
+
+			for(unsigned i = 0; i < lights_.size(); ++i)
+			{
+				float angle = time_ * 0.5f + i * 0.37f;
+				const Vector3& origin = lightOrigin_[i];
+				lights_[i]->SetPosition(XMVectorSet(origin.x_ + sinf(angle) * spacing_,origin.y_,origin.z_ + cosf(angle) * spacing_,0));
+			}
+
+			//Warmup frames stay at the start of the path
+			float t = frame == M_MAX_UNSIGNED ? 0.0f : (float)frame / GetNumFrames();
+
+			Vector3 position;
+			Quaternion rotation;
+			camera_.Sample(t,position,rotation);
+
+			Vector3 target = position + rotation * Vector3::FORWARD;
+			Vector3 up = rotation * Vector3::UP;
+			renderer->GetCamera()->SetLookAt(XMFLOAT3(position.x_,position.y_,position.z_),XMFLOAT3(target.x_,target.y_,target.z_),
+				XMFLOAT3(up.x_,up.y_,up.z_));
+
+			renderer->Update(timeStep);
+		}
+
+		{
+			BenchmarkPhaseScope phase(*this,BENCHMARK_PHASE_RENDER);
+
+			YumeRHI* rhi = gYume->pRHI;
+			if(rhi->BeginFrame())
+			{
+				renderer->Render();
+
+				//The next BeginFrame resets them
+				Count(drawsCounter_,rhi->GetNumBatches());
+				Count(primitivesCounter_,rhi->GetNumPrimitives());
+				Count(occludedCounter_,renderer->GetNumOccluded());
+
+				rhi->EndFrame();
+			}
+		}
+	}
+
+	LoadStormScenario::LoadStormScenario()
+		: numResources_(128),
+		loadsPerFrame_(8),
+		fileSize_(16384),
+		nextLoad_(0)
+	{
+	}
+
+	LoadStormScenario::~LoadStormScenario()
+	{
+		Teardown();
+	}
+
+	bool LoadStormScenario::LoadParameters(const pugi::xml_node& node)
+	{
+		numResources_ = Max(node.attribute("Resources").as_uint(numResources_),1U);
+		loadsPerFrame_ = node.attribute("LoadsPerFrame").as_uint(loadsPerFrame_);
+		fileSize_ = node.attribute("FileSize").as_uint(fileSize_);
+		return true;
+	}
+
+	bool LoadStormScenario::Setup()
+	{
+		//Unique per scenario, cached resources of an earlier storm must not be picked up
+		directory_ = gYume->pEnv->GetLogFile().parent_path() / ("Benchmark" + GetName()).c_str();
+		boost::filesystem::remove_all(directory_);
+		if(!gYume->pEnv->CreateDirectory(directory_))
+		{
+			YUMELOG_ERROR("Could not create " << directory_.generic_string().c_str());
+			return false;
+		}
+
+		for(unsigned i = 0; i < numResources_; ++i)
+		{
+			YumeString xml;
+			xml.AppendWithFormat("<LoadStorm Index=\"%u\">\n",i);
+			for(unsigned item = 0; xml.length() < fileSize_; ++item)
+				xml.AppendWithFormat("\t<Item Index=\"%u\" Value=\"%u\" Name=\"LoadStormItem\"/>\n",item,item * 2654435761u);
+			xml += "</LoadStorm>\n";
+
+			YumeString fileName;
+			fileName.AppendWithFormat("LoadStorm%u.xml",i);
+
+			FILE* file = fopen((directory_ / fileName.c_str()).generic_string().c_str(),"wb");
+			if(!file)
+			{
+				YUMELOG_ERROR("Could not write " << fileName.c_str());
+				return false;
+			}
+			fwrite(xml.c_str(),1,xml.length(),file);
+			fclose(file);
+		}
+
+		gYume->pResourceManager->AddResourcePath(directory_);
+		nextLoad_ = 0;
+
+		loadsCounter_ = AddCounter("Loads");
+		bytesCounter_ = AddCounter("LoadedBytes");
+		failedCounter_ = AddCounter("FailedLoads");
+		return true;
+	}
+
+	void LoadStormScenario::Teardown()
+	{
+		if(!directory_.empty())
+		{
+			boost::filesystem::remove_all(directory_);
+			directory_.clear();
+		}
+	}
+
+	void LoadStormScenario::RunFrame(unsigned frame,float timeStep)
+	{
+		BenchmarkPhaseScope phase(*this,BENCHMARK_PHASE_LOAD);
+
+		for(unsigned i = 0; i < loadsPerFrame_; ++i)
+		{
+			YumeString name;
+			name.AppendWithFormat("LoadStorm%u.xml",nextLoad_ % numResources_);
+
+			//Every other load goes through the cache, the rest are read and parsed from disk each time
+			unsigned long long bytes = 0;
+			bool loaded = false;
+			if(nextLoad_ & 1)
+			{
+				YumeXmlFile* xml = gYume->pResourceManager->PrepareResource<YumeXmlFile>(name);
+				loaded = xml != 0;
+				bytes = loaded ? xml->GetXml().length() : 0;
+			}
+			else
+			{
+				SharedPtr<YumeXmlFile> xml = gYume->pResourceManager->GetTempResource<YumeXmlFile>(name);
+				loaded = xml.NotNull();
+				bytes = loaded ? xml->GetXml().length() : 0;
+			}
+			++nextLoad_;
+
+			Count(loadsCounter_,1);
+			Count(bytesCounter_,bytes);
+			if(!loaded)
+				Count(failedCounter_,1);
+		}
+	}
+}
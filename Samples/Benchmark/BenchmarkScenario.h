@@ -0,0 +1,219 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchmarkScenario.h
+//--------------------------------------------------------------------------------
+#ifndef __BenchmarkScenario_h__
+#define __BenchmarkScenario_h__
+//--------------------------------------------------------------------------------
+#include "YumeRequired.h"
+#include "Core/YumeIO.h"
+#include "Math/YumeVector3.h"
+#include "Math/YumeQuaternion.h"
+
+#include <pugixml/src/pugixml.hpp>
+//--------------------------------------------------------------------------------
+namespace YumeEngine
+{
+	class Light;
+	class Material;
+	class StaticModel;
+	class YumeGeometry;
+
+	enum BenchmarkPhase
+	{
+		BENCHMARK_PHASE_UPDATE = 0,
+		BENCHMARK_PHASE_RENDER,
+		BENCHMARK_PHASE_LOAD,
+		MAX_BENCHMARK_PHASES
+	};
+
+	enum BenchmarkMetricKind
+	{
+		//Noisy, compared with the scenario's TimeTolerance
+		BENCHMARK_METRIC_TIME = 0,
+		//Should not move between runs of the same build, compared with CountTolerance
+		BENCHMARK_METRIC_COUNT
+	};
+
+	struct BenchmarkMetric
+	{
+		YumeString Name;
+		double Value;
+		BenchmarkMetricKind Kind;
+	};
+
+	struct BenchmarkResult
+	{
+		YumeString Name;
+		YumeString Type;
+		unsigned Frames;
+		double TimeTolerance;
+		double CountTolerance;
+		YumeVector<BenchmarkMetric>::type Metrics;
+	};
+
+	//Orbits the scene or loops through Point children with a Catmull-Rom spline
+	class BenchmarkCameraPath
+	{
+	public:
+		BenchmarkCameraPath();
+
+		bool Load(const pugi::xml_node& node,const Vector3& center,float radius);
+
+		//t goes from 0 to 1 over the measured frames
+		void Sample(float t,Vector3& position,Quaternion& rotation) const;
+
+	private:
+		Vector3 Evaluate(float t) const;
+
+		YumeVector<Vector3>::type points_;
+		Vector3 center_;
+		float radius_;
+		float height_;
+		bool orbit_;
+	};
+
+	//One scripted workload. Runs for a fixed number of frames with a fixed time step so two runs of the
+	//same build do the same work, only the clock differs.
+	class BenchmarkScenario : public RefCounted
+	{
+		friend class BenchmarkPhaseScope;
+	public:
+		BenchmarkScenario();
+		virtual ~BenchmarkScenario();
+
+		//Returns 0 for unknown types
+		static BenchmarkScenario* Create(const YumeString& type);
+
+		bool Load(const pugi::xml_node& node);
+
+		//Warmup frames first, then the measured ones
+		bool Run(BenchmarkResult& result);
+
+		const YumeString& GetName() const { return name_; }
+		const YumeString& GetType() const { return type_; }
+
+		static const char* GetPhaseName(BenchmarkPhase phase);
+
+	protected:
+		virtual bool LoadParameters(const pugi::xml_node& node) = 0;
+		virtual bool Setup() = 0;
+		//frame counts measured frames only, warmup frames get M_MAX_UNSIGNED
+		virtual void RunFrame(unsigned frame,float timeStep) = 0;
+		virtual void Teardown() {}
+
+		//Reported per measured frame as <name>PerFrame
+		unsigned AddCounter(const YumeString& name);
+		void Count(unsigned counter,unsigned long long value);
+
+		unsigned GetNumFrames() const { return frames_; }
+
+	private:
+		void BeginPhase(BenchmarkPhase phase);
+		void EndPhase(BenchmarkPhase phase);
+		void ResetStats();
+
+		YumeString name_;
+		YumeString type_;
+		unsigned frames_;
+		unsigned warmupFrames_;
+		float timeStep_;
+		double timeTolerance_;
+		double countTolerance_;
+
+		bool measuring_;
+		long long phaseBegin_[MAX_BENCHMARK_PHASES];
+		long long phaseFrame_[MAX_BENCHMARK_PHASES];
+		long long phaseTotal_[MAX_BENCHMARK_PHASES];
+		long long phaseMax_[MAX_BENCHMARK_PHASES];
+		unsigned phaseFrames_[MAX_BENCHMARK_PHASES];
+		bool phaseActive_[MAX_BENCHMARK_PHASES];
+
+		YumeVector<YumeString>::type counterNames_;
+		YumeVector<unsigned long long>::type counters_;
+	};
+
+	//Times the rest of the scope as one phase, also shows up in profiler captures
+	class BenchmarkPhaseScope
+	{
+	public:
+		BenchmarkPhaseScope(BenchmarkScenario& scenario,BenchmarkPhase phase);
+		~BenchmarkPhaseScope();
+
+	private:
+		BenchmarkScenario& scenario_;
+		BenchmarkPhase phase_;
+	};
+
+	//N models of a few kinds on a grid, M point lights moving around, a camera following a path.
+	//Everything goes into the renderer's scene and each frame is a whole frame of the deferred renderer,
+	//the counts are the draws and primitives it sent to the RHI.
+	class SceneScenario : public BenchmarkScenario
+	{
+	public:
+		SceneScenario();
+		virtual ~SceneScenario();
+
+	protected:
+		virtual bool LoadParameters(const pugi::xml_node& node);
+		virtual bool Setup();
+		virtual void RunFrame(unsigned frame,float timeStep);
+		virtual void Teardown();
+
+	private:
+		unsigned numModels_;
+		unsigned numKinds_;
+		unsigned numLights_;
+		float spacing_;
+		float farClip_;
+		unsigned seed_;
+		BenchmarkCameraPath camera_;
+
+		//One box and one material per kind
+		YumeVector<SharedPtr<YumeGeometry> >::type geometries_;
+		YumeVector<SharedPtr<Material> >::type materials_;
+		YumeVector<StaticModel*>::type models_;
+		YumeVector<float>::type spin_;
+		//The light pass needs one
+		Light* directionalLight_;
+		YumeVector<Light*>::type lights_;
+		YumeVector<Vector3>::type lightOrigin_;
+		float time_;
+
+		unsigned drawsCounter_;
+		unsigned primitivesCounter_;
+		unsigned occludedCounter_;
+	};
+
+	//Generated XML files loaded through the resource manager every frame, half of them cached
+	class LoadStormScenario : public BenchmarkScenario
+	{
+	public:
+		LoadStormScenario();
+		virtual ~LoadStormScenario();
+
+	protected:
+		virtual bool LoadParameters(const pugi::xml_node& node);
+		virtual bool Setup();
+		virtual void RunFrame(unsigned frame,float timeStep);
+		virtual void Teardown();
+
+	private:
+		unsigned numResources_;
+		unsigned loadsPerFrame_;
+		unsigned fileSize_;
+		unsigned nextLoad_;
+		FsPath directory_;
+
+		unsigned loadsCounter_;
+		unsigned bytesCounter_;
+		unsigned failedCounter_;
+	};
+}
+
+//--------------------------------------------------------------------------------
+#endif
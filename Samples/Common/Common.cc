@@ -86,6 +86,12 @@ namespace YumeEngine
 						engineVariants_["GI"] = atoi(right.c_str());
 					if(left == "CamMoveSpeed")
 						engineVariants_["CamMoveSpeed"] = atoi(right.c_str());
+					if(left == "DynamicResolution")
+						engineVariants_["DynamicResolution"] = atoi(right.c_str()) != 0;
+					if(left == "OcclusionCulling")
+						engineVariants_["OcclusionCulling"] = atoi(right.c_str()) != 0;
+					if(left == "TargetFrameRate")
+						engineVariants_["TargetFrameRate"] = atoi(right.c_str());
 				}
 
 			}
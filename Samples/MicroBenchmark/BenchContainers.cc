@@ -0,0 +1,428 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchContainers.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include "Container/HashMap.h"
+#include "Container/HashSet.h"
+#include "Container/List.h"
+#include "Container/OpenHashMap.h"
+#include "Container/SmallVector.h"
+#include "Math/YumeHash.h"
+
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace YumeEngine
+{
+	using Benchmark::State;
+	using Benchmark::DoNotOptimize;
+
+	//Scattered like resource and parameter hashes, not sequential
+	static unsigned MakeKey(unsigned i)
+	{
+		return i * 2654435761u;
+	}
+
+	//--------------------------------------------------------------------------------
+	//Vectors
+	//--------------------------------------------------------------------------------
+	static void VectorPushBack(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeVector<unsigned>::type v;
+		while(state.KeepRunning())
+		{
+			v.clear();
+			for(unsigned i = 0; i < count; ++i)
+				v.push_back(i);
+			DoNotOptimize(v.back());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(VectorPushBack)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void PODVectorPushBack(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumePodVector<unsigned>::type v;
+		while(state.KeepRunning())
+		{
+			v.clear();
+			for(unsigned i = 0; i < count; ++i)
+				v.push_back(i);
+			DoNotOptimize(v.back());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(PODVectorPushBack)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void SmallVectorPushBack(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			//Fresh each time, the point is skipping the heap while it fits
+			YumeSmallVector<unsigned,16>::type v;
+			for(unsigned i = 0; i < count; ++i)
+				v.push_back(i);
+			DoNotOptimize(v.back());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(SmallVectorPushBack)->Arg(8)->Arg(16)->Arg(64);
+
+	static void VectorPushBackFresh(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			YumeVector<unsigned>::type v;
+			for(unsigned i = 0; i < count; ++i)
+				v.push_back(i);
+			DoNotOptimize(v.back());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(VectorPushBackFresh)->Arg(8)->Arg(16)->Arg(64);
+
+	static void StdVectorPushBack(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		std::vector<unsigned> v;
+		while(state.KeepRunning())
+		{
+			v.clear();
+			for(unsigned i = 0; i < count; ++i)
+				v.push_back(i);
+			DoNotOptimize(v.back());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdVectorPushBack)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void VectorIterate(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeVector<unsigned>::type v;
+		for(unsigned i = 0; i < count; ++i)
+			v.push_back(MakeKey(i));
+
+		while(state.KeepRunning())
+		{
+			unsigned sum = 0;
+			for(YumeVector<unsigned>::const_iterator i = v.begin(); i != v.end(); ++i)
+				sum += *i;
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(VectorIterate)->Arg(1024)->Arg(65536);
+
+	static void StdVectorIterate(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		std::vector<unsigned> v;
+		for(unsigned i = 0; i < count; ++i)
+			v.push_back(MakeKey(i));
+
+		while(state.KeepRunning())
+		{
+			unsigned sum = 0;
+			for(std::vector<unsigned>::const_iterator i = v.begin(); i != v.end(); ++i)
+				sum += *i;
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdVectorIterate)->Arg(1024)->Arg(65536);
+
+	//--------------------------------------------------------------------------------
+	//Maps, unsigned keys the way YumeHash values are used
+	//--------------------------------------------------------------------------------
+	static void HashMapInsert(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			YumeMap<unsigned,unsigned>::type map;
+			for(unsigned i = 0; i < count; ++i)
+				map[MakeKey(i)] = i;
+			DoNotOptimize(map.size());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(HashMapInsert)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void OpenHashMapInsert(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			YumeOpenMap<unsigned,unsigned>::type map;
+			for(unsigned i = 0; i < count; ++i)
+				map[MakeKey(i)] = i;
+			DoNotOptimize(map.size());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(OpenHashMapInsert)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void StdUnorderedMapInsert(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			std::unordered_map<unsigned,unsigned> map;
+			for(unsigned i = 0; i < count; ++i)
+				map[MakeKey(i)] = i;
+			DoNotOptimize(map.size());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdUnorderedMapInsert)->Arg(16)->Arg(1024)->Arg(65536);
+
+	//Every other lookup misses
+	static void HashMapFind(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeMap<unsigned,unsigned>::type map;
+		for(unsigned i = 0; i < count; ++i)
+			map[MakeKey(i * 2)] = i;
+
+		while(state.KeepRunning())
+		{
+			unsigned found = 0;
+			for(unsigned i = 0; i < count; ++i)
+				found += map.find(MakeKey(i)) != map.end();
+			DoNotOptimize(found);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(HashMapFind)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void OpenHashMapFind(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeOpenMap<unsigned,unsigned>::type map;
+		for(unsigned i = 0; i < count; ++i)
+			map[MakeKey(i * 2)] = i;
+
+		while(state.KeepRunning())
+		{
+			unsigned found = 0;
+			for(unsigned i = 0; i < count; ++i)
+				found += map.find(MakeKey(i)) != map.end();
+			DoNotOptimize(found);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(OpenHashMapFind)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void StdUnorderedMapFind(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		std::unordered_map<unsigned,unsigned> map;
+		for(unsigned i = 0; i < count; ++i)
+			map[MakeKey(i * 2)] = i;
+
+		while(state.KeepRunning())
+		{
+			unsigned found = 0;
+			for(unsigned i = 0; i < count; ++i)
+				found += map.find(MakeKey(i)) != map.end();
+			DoNotOptimize(found);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdUnorderedMapFind)->Arg(16)->Arg(1024)->Arg(65536);
+
+	//Shader parameter lookups, YumeHash keys
+	static void HashMapFindYumeHash(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeMap<YumeHash,float>::type map;
+		YumeVector<YumeHash>::type keys;
+		for(unsigned i = 0; i < count; ++i)
+		{
+			YumeString name;
+			name.AppendWithFormat("Parameter%u",i);
+			keys.push_back(YumeHash(name));
+			map[keys.back()] = (float)i;
+		}
+
+		while(state.KeepRunning())
+		{
+			float sum = 0;
+			for(unsigned i = 0; i < count; ++i)
+				sum += map[keys[i]];
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(HashMapFindYumeHash)->Arg(16)->Arg(128);
+
+	static void OpenHashMapFindYumeHash(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeOpenMap<YumeHash,float>::type map;
+		YumeVector<YumeHash>::type keys;
+		for(unsigned i = 0; i < count; ++i)
+		{
+			YumeString name;
+			name.AppendWithFormat("Parameter%u",i);
+			keys.push_back(YumeHash(name));
+			map[keys.back()] = (float)i;
+		}
+
+		while(state.KeepRunning())
+		{
+			float sum = 0;
+			for(unsigned i = 0; i < count; ++i)
+				sum += map[keys[i]];
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(OpenHashMapFindYumeHash)->Arg(16)->Arg(128);
+
+	static void HashMapIterate(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeMap<unsigned,unsigned>::type map;
+		for(unsigned i = 0; i < count; ++i)
+			map[MakeKey(i)] = i;
+
+		while(state.KeepRunning())
+		{
+			unsigned sum = 0;
+			for(YumeMap<unsigned,unsigned>::const_iterator i = map.begin(); i != map.end(); ++i)
+				sum += i->second;
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(HashMapIterate)->Arg(1024)->Arg(65536);
+
+	static void OpenHashMapIterate(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeOpenMap<unsigned,unsigned>::type map;
+		for(unsigned i = 0; i < count; ++i)
+			map[MakeKey(i)] = i;
+
+		while(state.KeepRunning())
+		{
+			unsigned sum = 0;
+			for(YumeOpenMap<unsigned,unsigned>::const_iterator i = map.begin(); i != map.end(); ++i)
+				sum += i->second;
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(OpenHashMapIterate)->Arg(1024)->Arg(65536);
+
+	static void StdUnorderedMapIterate(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		std::unordered_map<unsigned,unsigned> map;
+		for(unsigned i = 0; i < count; ++i)
+			map[MakeKey(i)] = i;
+
+		while(state.KeepRunning())
+		{
+			unsigned sum = 0;
+			for(std::unordered_map<unsigned,unsigned>::const_iterator i = map.begin(); i != map.end(); ++i)
+				sum += i->second;
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdUnorderedMapIterate)->Arg(1024)->Arg(65536);
+
+	//--------------------------------------------------------------------------------
+	//Sets
+	//--------------------------------------------------------------------------------
+	static void HashSetInsertContains(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			YumeHashSet<unsigned>::type set;
+			for(unsigned i = 0; i < count; ++i)
+				set.insert(MakeKey(i));
+
+			unsigned found = 0;
+			for(unsigned i = 0; i < count; ++i)
+				found += set.Contains(MakeKey(i * 2));
+			DoNotOptimize(found);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count * 2);
+	}
+	YUME_BENCHMARK(HashSetInsertContains)->Arg(16)->Arg(1024)->Arg(65536);
+
+	static void StdUnorderedSetInsertContains(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			std::unordered_set<unsigned> set;
+			for(unsigned i = 0; i < count; ++i)
+				set.insert(MakeKey(i));
+
+			unsigned found = 0;
+			for(unsigned i = 0; i < count; ++i)
+				found += (unsigned)set.count(MakeKey(i * 2));
+			DoNotOptimize(found);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count * 2);
+	}
+	YUME_BENCHMARK(StdUnorderedSetInsertContains)->Arg(16)->Arg(1024)->Arg(65536);
+
+	//--------------------------------------------------------------------------------
+	//Lists
+	//--------------------------------------------------------------------------------
+	static void ListPushIterate(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			List<unsigned> list;
+			for(unsigned i = 0; i < count; ++i)
+				list.Push(i);
+
+			unsigned sum = 0;
+			for(List<unsigned>::ConstIterator i = list.Begin(); i != list.End(); ++i)
+				sum += *i;
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(ListPushIterate)->Arg(16)->Arg(1024);
+
+	static void StdListPushIterate(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			std::list<unsigned> list;
+			for(unsigned i = 0; i < count; ++i)
+				list.push_back(i);
+
+			unsigned sum = 0;
+			for(std::list<unsigned>::const_iterator i = list.begin(); i != list.end(); ++i)
+				sum += *i;
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdListPushIterate)->Arg(16)->Arg(1024);
+}
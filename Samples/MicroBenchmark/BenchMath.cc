@@ -0,0 +1,197 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchMath.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include "Math/YumeMatrix3x4.h"
+#include "Math/YumeMatrix4.h"
+#include "Math/YumeQuaternion.h"
+#include "Math/YumeVector3.h"
+
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+namespace YumeEngine
+{
+	using Benchmark::State;
+	using Benchmark::DoNotOptimize;
+
+	//Scene node chains, a handful of transforms multiplied in sequence
+	static const unsigned MATRIX_COUNT = 64;
+
+	static Matrix3x4 MakeTransform(unsigned i)
+	{
+		return Matrix3x4(Vector3((float)i,1.0f,-(float)i),Quaternion(i * 11.0f,i * 3.0f,i * 7.0f),1.0f + i * 0.01f);
+	}
+
+	//--------------------------------------------------------------------------------
+	//Matrix multiply
+	//--------------------------------------------------------------------------------
+	static void Matrix3x4Multiply(State& state)
+	{
+		YumeVector<Matrix3x4>::type matrices;
+		for(unsigned i = 0; i < MATRIX_COUNT; ++i)
+			matrices.push_back(MakeTransform(i));
+
+		while(state.KeepRunning())
+		{
+			Matrix3x4 result = Matrix3x4::IDENTITY;
+			for(unsigned i = 0; i < MATRIX_COUNT; ++i)
+				result = result * matrices[i];
+			DoNotOptimize(result);
+		}
+		state.SetItemsProcessed(state.GetIterations() * MATRIX_COUNT);
+	}
+	YUME_BENCHMARK(Matrix3x4Multiply);
+
+	static void Matrix4Multiply(State& state)
+	{
+		YumeVector<Matrix4>::type matrices;
+		for(unsigned i = 0; i < MATRIX_COUNT; ++i)
+			matrices.push_back(MakeTransform(i).ToMatrix4());
+
+		while(state.KeepRunning())
+		{
+			Matrix4 result = Matrix4::IDENTITY;
+			for(unsigned i = 0; i < MATRIX_COUNT; ++i)
+				result = result * matrices[i];
+			DoNotOptimize(result);
+		}
+		state.SetItemsProcessed(state.GetIterations() * MATRIX_COUNT);
+	}
+	YUME_BENCHMARK(Matrix4Multiply);
+
+	static void XMMatrixMultiplyChain(State& state)
+	{
+		YumePodVector<XMFLOAT4X4>::type matrices;
+		for(unsigned i = 0; i < MATRIX_COUNT; ++i)
+		{
+			//Row vectors on the DirectX side, so the transpose
+			Matrix4 m = MakeTransform(i).ToMatrix4().Transpose();
+			XMFLOAT4X4 stored;
+			memcpy(&stored,&m,sizeof stored);
+			matrices.push_back(stored);
+		}
+
+		while(state.KeepRunning())
+		{
+			XMMATRIX result = XMMatrixIdentity();
+			for(unsigned i = 0; i < MATRIX_COUNT; ++i)
+				result = XMMatrixMultiply(result,XMLoadFloat4x4(&matrices[i]));
+			DoNotOptimize(result);
+		}
+		state.SetItemsProcessed(state.GetIterations() * MATRIX_COUNT);
+	}
+	YUME_BENCHMARK(XMMatrixMultiplyChain);
+
+	//--------------------------------------------------------------------------------
+	//Transforming point arrays, skinning and bounding box corners
+	//--------------------------------------------------------------------------------
+	static void Matrix3x4TransformPoints(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumePodVector<Vector3>::type points(count);
+		YumePodVector<Vector3>::type result(count);
+		for(unsigned i = 0; i < count; ++i)
+			points[i] = Vector3((float)i,(float)(i & 15),-(float)i);
+
+		Matrix3x4 transform = MakeTransform(5);
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < count; ++i)
+				result[i] = transform * points[i];
+			DoNotOptimize(result[count - 1]);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(Matrix3x4TransformPoints)->Arg(64)->Arg(4096);
+
+	static void Matrix4TransformPoints(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumePodVector<Vector3>::type points(count);
+		YumePodVector<Vector3>::type result(count);
+		for(unsigned i = 0; i < count; ++i)
+			points[i] = Vector3((float)i,(float)(i & 15),-(float)i);
+
+		Matrix4 transform = MakeTransform(5).ToMatrix4();
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < count; ++i)
+				result[i] = transform * points[i];
+			DoNotOptimize(result[count - 1]);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(Matrix4TransformPoints)->Arg(64)->Arg(4096);
+
+	static void XMVector3TransformCoordStreamPoints(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumePodVector<XMFLOAT3>::type points(count);
+		YumePodVector<XMFLOAT3>::type result(count);
+		for(unsigned i = 0; i < count; ++i)
+			points[i] = XMFLOAT3((float)i,(float)(i & 15),-(float)i);
+
+		Matrix4 m = MakeTransform(5).ToMatrix4().Transpose();
+		XMFLOAT4X4 stored;
+		memcpy(&stored,&m,sizeof stored);
+		XMMATRIX transform = XMLoadFloat4x4(&stored);
+
+		while(state.KeepRunning())
+		{
+			XMVector3TransformCoordStream(&result[0],sizeof(XMFLOAT3),&points[0],sizeof(XMFLOAT3),count,transform);
+			DoNotOptimize(result[count - 1]);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(XMVector3TransformCoordStreamPoints)->Arg(64)->Arg(4096);
+
+	//--------------------------------------------------------------------------------
+	//Rotations
+	//--------------------------------------------------------------------------------
+	static void QuaternionRotatePoints(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumePodVector<Vector3>::type points(count);
+		YumePodVector<Vector3>::type result(count);
+		for(unsigned i = 0; i < count; ++i)
+			points[i] = Vector3((float)i,(float)(i & 15),-(float)i);
+
+		Quaternion rotation(30.0f,45.0f,60.0f);
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < count; ++i)
+				result[i] = rotation * points[i];
+			DoNotOptimize(result[count - 1]);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(QuaternionRotatePoints)->Arg(64)->Arg(4096);
+
+	static void XMVector3RotatePoints(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumePodVector<XMFLOAT3>::type points(count);
+		YumePodVector<XMFLOAT3>::type result(count);
+		for(unsigned i = 0; i < count; ++i)
+			points[i] = XMFLOAT3((float)i,(float)(i & 15),-(float)i);
+
+		XMVECTOR rotation = XMQuaternionRotationRollPitchYaw(XMConvertToRadians(30.0f),XMConvertToRadians(45.0f),XMConvertToRadians(60.0f));
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < count; ++i)
+				XMStoreFloat3(&result[i],XMVector3Rotate(XMLoadFloat3(&points[i]),rotation));
+			DoNotOptimize(result[count - 1]);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(XMVector3RotatePoints)->Arg(64)->Arg(4096);
+}
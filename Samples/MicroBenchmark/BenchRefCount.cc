@@ -0,0 +1,86 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchRefCount.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include "Core/SharedPtr.h"
+
+#include <memory>
+#include <vector>
+
+namespace YumeEngine
+{
+	using Benchmark::State;
+	using Benchmark::DoNotOptimize;
+
+	class BenchRefCountObject : public RefCounted
+	{
+	public:
+		BenchRefCountObject(RefCountMode mode)
+			: RefCounted(mode)
+		{
+		}
+	};
+
+	//Copies a frame's worth of shared pointers the way batches are gathered
+	static void SharedPtrCopy(State& state,RefCountMode mode)
+	{
+		unsigned count = (unsigned)state.GetArg();
+
+		YumeVector<SharedPtr<BenchRefCountObject> >::type objects;
+		for(unsigned i = 0; i < count; ++i)
+			objects.push_back(SharedPtr<BenchRefCountObject>(new BenchRefCountObject(mode)));
+
+		YumeVector<SharedPtr<BenchRefCountObject> >::type batches;
+		batches.reserve(count);
+
+		while(state.KeepRunning())
+		{
+			batches.clear();
+			for(unsigned i = 0; i < count; ++i)
+				batches.push_back(objects[i]);
+			DoNotOptimize(batches.back());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+
+	static void SharedPtrCopyAtomic(State& state)
+	{
+		SharedPtrCopy(state,REFCOUNT_ATOMIC);
+	}
+	YUME_BENCHMARK(SharedPtrCopyAtomic)->Arg(1024);
+
+	static void SharedPtrCopyThreadLocal(State& state)
+	{
+		SharedPtrCopy(state,REFCOUNT_THREAD_LOCAL);
+	}
+	YUME_BENCHMARK(SharedPtrCopyThreadLocal)->Arg(1024);
+
+	static void StdSharedPtrCopy(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+
+		std::vector<std::shared_ptr<int> > objects;
+		for(unsigned i = 0; i < count; ++i)
+			objects.push_back(std::make_shared<int>((int)i));
+
+		std::vector<std::shared_ptr<int> > batches;
+		batches.reserve(count);
+
+		while(state.KeepRunning())
+		{
+			batches.clear();
+			for(unsigned i = 0; i < count; ++i)
+				batches.push_back(objects[i]);
+			DoNotOptimize(batches.back());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdSharedPtrCopy)->Arg(1024);
+}
@@ -0,0 +1,129 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchStreams.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include "Core/YumeVectorBuffer.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace YumeEngine
+{
+	using Benchmark::State;
+	using Benchmark::DoNotOptimize;
+
+	//--------------------------------------------------------------------------------
+	//Floats, vertex and animation data
+	//--------------------------------------------------------------------------------
+	static void VectorBufferWriteReadFloat(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		VectorBuffer buffer;
+
+		while(state.KeepRunning())
+		{
+			buffer.Clear();
+			for(unsigned i = 0; i < count; ++i)
+				buffer.WriteFloat((float)i);
+
+			buffer.Seek(0);
+			float sum = 0;
+			for(unsigned i = 0; i < count; ++i)
+				sum += buffer.ReadFloat();
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+		state.SetBytesProcessed(state.GetIterations() * count * sizeof(float) * 2);
+	}
+	YUME_BENCHMARK(VectorBufferWriteReadFloat)->Arg(64)->Arg(16384);
+
+	//What the buffer does minus the virtual Write/Read and the bounds checks
+	static void StdVectorWriteReadFloat(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		std::vector<unsigned char> buffer;
+
+		while(state.KeepRunning())
+		{
+			buffer.clear();
+			for(unsigned i = 0; i < count; ++i)
+			{
+				float value = (float)i;
+				size_t position = buffer.size();
+				buffer.resize(position + sizeof value);
+				memcpy(&buffer[position],&value,sizeof value);
+			}
+
+			float sum = 0;
+			for(unsigned i = 0; i < count; ++i)
+			{
+				float value;
+				memcpy(&value,&buffer[i * sizeof value],sizeof value);
+				sum += value;
+			}
+			DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+		state.SetBytesProcessed(state.GetIterations() * count * sizeof(float) * 2);
+	}
+	YUME_BENCHMARK(StdVectorWriteReadFloat)->Arg(64)->Arg(16384);
+
+	//--------------------------------------------------------------------------------
+	//Strings, scene and material names
+	//--------------------------------------------------------------------------------
+	static void VectorBufferWriteReadString(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		YumeString value = "Engine/Assets/Models/Sponza/Sponza.yume";
+		VectorBuffer buffer;
+
+		while(state.KeepRunning())
+		{
+			buffer.Clear();
+			for(unsigned i = 0; i < count; ++i)
+				buffer.WriteString(value);
+
+			buffer.Seek(0);
+			unsigned length = 0;
+			for(unsigned i = 0; i < count; ++i)
+				length += buffer.ReadString().length();
+			DoNotOptimize(length);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+		state.SetBytesProcessed(state.GetIterations() * count * (value.length() + 1) * 2);
+	}
+	YUME_BENCHMARK(VectorBufferWriteReadString)->Arg(64)->Arg(4096);
+
+	static void StdStringStreamWriteReadString(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		std::string value = "Engine/Assets/Models/Sponza/Sponza.yume";
+
+		while(state.KeepRunning())
+		{
+			std::stringstream stream;
+			for(unsigned i = 0; i < count; ++i)
+				stream << value << '\0';
+
+			unsigned length = 0;
+			std::string read;
+			for(unsigned i = 0; i < count; ++i)
+			{
+				std::getline(stream,read,'\0');
+				length += (unsigned)read.length();
+			}
+			DoNotOptimize(length);
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+		state.SetBytesProcessed(state.GetIterations() * count * (value.length() + 1) * 2);
+	}
+	YUME_BENCHMARK(StdStringStreamWriteReadString)->Arg(64)->Arg(4096);
+}
@@ -0,0 +1,184 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchStrings.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include "Math/YumeHash.h"
+
+#include <functional>
+#include <string>
+
+namespace YumeEngine
+{
+	using Benchmark::State;
+	using Benchmark::DoNotOptimize;
+
+	//Shader and resource names, length picked by the argument
+	static YumeString MakeName(unsigned length,unsigned seed)
+	{
+		YumeString name;
+		for(unsigned i = 0; i < length; ++i)
+			name += (char)('a' + (i * 7 + seed) % 26);
+		return name;
+	}
+
+	static const unsigned NAME_COUNT = 64;
+
+	//--------------------------------------------------------------------------------
+	//Hashing
+	//--------------------------------------------------------------------------------
+	static void YumeHashString(State& state)
+	{
+		YumeVector<YumeString>::type names;
+		for(unsigned i = 0; i < NAME_COUNT; ++i)
+			names.push_back(MakeName((unsigned)state.GetArg(),i));
+
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < NAME_COUNT; ++i)
+				DoNotOptimize(YumeHash(names[i]).Value());
+		}
+		state.SetItemsProcessed(state.GetIterations() * NAME_COUNT);
+		state.SetBytesProcessed(state.GetIterations() * NAME_COUNT * state.GetArg());
+	}
+	YUME_BENCHMARK(YumeHashString)->Arg(8)->Arg(32)->Arg(128);
+
+	static void YumeHashCString(State& state)
+	{
+		YumeVector<YumeString>::type names;
+		for(unsigned i = 0; i < NAME_COUNT; ++i)
+			names.push_back(MakeName((unsigned)state.GetArg(),i));
+
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < NAME_COUNT; ++i)
+				DoNotOptimize(YumeHash(names[i].c_str()).Value());
+		}
+		state.SetItemsProcessed(state.GetIterations() * NAME_COUNT);
+		state.SetBytesProcessed(state.GetIterations() * NAME_COUNT * state.GetArg());
+	}
+	YUME_BENCHMARK(YumeHashCString)->Arg(8)->Arg(32)->Arg(128);
+
+	static void StdHashString(State& state)
+	{
+		std::vector<std::string> names;
+		for(unsigned i = 0; i < NAME_COUNT; ++i)
+			names.push_back(MakeName((unsigned)state.GetArg(),i).c_str());
+
+		std::hash<std::string> hasher;
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < NAME_COUNT; ++i)
+				DoNotOptimize(hasher(names[i]));
+		}
+		state.SetItemsProcessed(state.GetIterations() * NAME_COUNT);
+		state.SetBytesProcessed(state.GetIterations() * NAME_COUNT * state.GetArg());
+	}
+	YUME_BENCHMARK(StdHashString)->Arg(8)->Arg(32)->Arg(128);
+
+	//--------------------------------------------------------------------------------
+	//Comparing, pairs share a prefix and differ in the last character half the time
+	//--------------------------------------------------------------------------------
+	static void StringEquals(State& state)
+	{
+		YumeVector<YumeString>::type lhs,rhs;
+		for(unsigned i = 0; i < NAME_COUNT; ++i)
+		{
+			lhs.push_back(MakeName((unsigned)state.GetArg(),0));
+			rhs.push_back(lhs.back());
+			if(i & 1)
+				rhs.back()[rhs.back().length() - 1] = '_';
+		}
+
+		while(state.KeepRunning())
+		{
+			unsigned equal = 0;
+			for(unsigned i = 0; i < NAME_COUNT; ++i)
+				equal += lhs[i] == rhs[i];
+			DoNotOptimize(equal);
+		}
+		state.SetItemsProcessed(state.GetIterations() * NAME_COUNT);
+	}
+	YUME_BENCHMARK(StringEquals)->Arg(8)->Arg(32)->Arg(128);
+
+	static void StringCompareNoCase(State& state)
+	{
+		YumeVector<YumeString>::type lhs,rhs;
+		for(unsigned i = 0; i < NAME_COUNT; ++i)
+		{
+			lhs.push_back(MakeName((unsigned)state.GetArg(),0));
+			rhs.push_back(lhs.back().ToUpper());
+			if(i & 1)
+				rhs.back()[rhs.back().length() - 1] = '_';
+		}
+
+		while(state.KeepRunning())
+		{
+			unsigned equal = 0;
+			for(unsigned i = 0; i < NAME_COUNT; ++i)
+				equal += !lhs[i].Compare(rhs[i],false);
+			DoNotOptimize(equal);
+		}
+		state.SetItemsProcessed(state.GetIterations() * NAME_COUNT);
+	}
+	YUME_BENCHMARK(StringCompareNoCase)->Arg(8)->Arg(32)->Arg(128);
+
+	static void StdStringEquals(State& state)
+	{
+		std::vector<std::string> lhs,rhs;
+		for(unsigned i = 0; i < NAME_COUNT; ++i)
+		{
+			lhs.push_back(MakeName((unsigned)state.GetArg(),0).c_str());
+			rhs.push_back(lhs.back());
+			if(i & 1)
+				rhs.back()[rhs.back().length() - 1] = '_';
+		}
+
+		while(state.KeepRunning())
+		{
+			unsigned equal = 0;
+			for(unsigned i = 0; i < NAME_COUNT; ++i)
+				equal += lhs[i] == rhs[i];
+			DoNotOptimize(equal);
+		}
+		state.SetItemsProcessed(state.GetIterations() * NAME_COUNT);
+	}
+	YUME_BENCHMARK(StdStringEquals)->Arg(8)->Arg(32)->Arg(128);
+
+	//--------------------------------------------------------------------------------
+	//Building, the way paths and log lines are put together
+	//--------------------------------------------------------------------------------
+	static void StringAppend(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			YumeString s;
+			for(unsigned i = 0; i < count; ++i)
+				s.append("Engine/Assets/");
+			DoNotOptimize(s.length());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StringAppend)->Arg(4)->Arg(64);
+
+	static void StdStringAppend(State& state)
+	{
+		unsigned count = (unsigned)state.GetArg();
+		while(state.KeepRunning())
+		{
+			std::string s;
+			for(unsigned i = 0; i < count; ++i)
+				s.append("Engine/Assets/");
+			DoNotOptimize(s.length());
+		}
+		state.SetItemsProcessed(state.GetIterations() * count);
+	}
+	YUME_BENCHMARK(StdStringAppend)->Arg(4)->Arg(64);
+}
@@ -0,0 +1,155 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//BenchVariant.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include "Core/YumeVariant.h"
+
+namespace YumeEngine
+{
+	using Benchmark::State;
+	using Benchmark::DoNotOptimize;
+
+	//Engine and material parameters, one of each kind that goes through the heap or not
+	static const unsigned VARIANT_COUNT = 64;
+
+	static void VariantConstructInt(State& state)
+	{
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+			{
+				Variant v((int)i);
+				DoNotOptimize(v);
+			}
+		}
+		state.SetItemsProcessed(state.GetIterations() * VARIANT_COUNT);
+	}
+	YUME_BENCHMARK(VariantConstructInt);
+
+	static void VariantConstructFloat(State& state)
+	{
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+			{
+				Variant v((float)i);
+				DoNotOptimize(v);
+			}
+		}
+		state.SetItemsProcessed(state.GetIterations() * VARIANT_COUNT);
+	}
+	YUME_BENCHMARK(VariantConstructFloat);
+
+	static void VariantConstructString(State& state)
+	{
+		YumeString value = "Engine/Assets/Textures/Default.dds";
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+			{
+				Variant v(value);
+				DoNotOptimize(v);
+			}
+		}
+		state.SetItemsProcessed(state.GetIterations() * VARIANT_COUNT);
+	}
+	YUME_BENCHMARK(VariantConstructString);
+
+	static void VariantConstructMatrix3x4(State& state)
+	{
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+			{
+				Variant v(Matrix3x4::IDENTITY);
+				DoNotOptimize(v);
+			}
+		}
+		state.SetItemsProcessed(state.GetIterations() * VARIANT_COUNT);
+	}
+	YUME_BENCHMARK(VariantConstructMatrix3x4);
+
+	static void FillVariants(YumeVector<Variant>::type& variants)
+	{
+		for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+		{
+			switch(i & 3)
+			{
+			case 0:
+				variants.push_back(Variant((int)i));
+				break;
+			case 1:
+				variants.push_back(Variant((float)i));
+				break;
+			case 2:
+				variants.push_back(Variant(YumeString("Engine/Assets/Textures/Default.dds")));
+				break;
+			default:
+				variants.push_back(Variant(Matrix3x4::IDENTITY));
+				break;
+			}
+		}
+	}
+
+	static void VariantCopy(State& state)
+	{
+		YumeVector<Variant>::type source;
+		FillVariants(source);
+		YumeVector<Variant>::type dest(VARIANT_COUNT);
+
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+				dest[i] = source[i];
+			DoNotOptimize(dest[VARIANT_COUNT - 1]);
+
+			//Back to empty so every copy is a type change
+			state.PauseTiming();
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+				dest[i] = Variant::EMPTY;
+			state.ResumeTiming();
+		}
+		state.SetItemsProcessed(state.GetIterations() * VARIANT_COUNT);
+	}
+	YUME_BENCHMARK(VariantCopy);
+
+	static void VariantCopySameType(State& state)
+	{
+		YumeVector<Variant>::type source;
+		FillVariants(source);
+		YumeVector<Variant>::type dest = source;
+
+		while(state.KeepRunning())
+		{
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+				dest[i] = source[i];
+			DoNotOptimize(dest[VARIANT_COUNT - 1]);
+		}
+		state.SetItemsProcessed(state.GetIterations() * VARIANT_COUNT);
+	}
+	YUME_BENCHMARK(VariantCopySameType);
+
+	static void VariantCompare(State& state)
+	{
+		YumeVector<Variant>::type lhs;
+		FillVariants(lhs);
+		YumeVector<Variant>::type rhs = lhs;
+
+		while(state.KeepRunning())
+		{
+			unsigned equal = 0;
+			for(unsigned i = 0; i < VARIANT_COUNT; ++i)
+				equal += lhs[i] == rhs[i];
+			DoNotOptimize(equal);
+		}
+		state.SetItemsProcessed(state.GetIterations() * VARIANT_COUNT);
+	}
+	YUME_BENCHMARK(VariantCompare);
+}
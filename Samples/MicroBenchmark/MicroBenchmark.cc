@@ -0,0 +1,46 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//MicroBenchmark.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace YumeEngine;
+
+//No engine, the suites only touch containers, math and streams
+//
+//	MicroBenchmark Filter=HashMap MinTime=0.5 Repetitions=5 Output=MicroBenchmark.json
+int main(int argc,char** argv)
+{
+	Benchmark::RunOptions options;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		YumeString param = argv[i];
+
+		if(param.Contains('='))
+		{
+			YumeVector<YumeString>::type split = param.Split('=');
+			YumeString left = split[0];
+			YumeString right = split.size() > 1 ? split[1] : YumeString();
+
+			if(left == "Filter")
+				options.Filter = right;
+			if(left == "MinTime")
+				options.MinTime = atof(right.c_str());
+			if(left == "Repetitions")
+				options.Repetitions = std::max(atoi(right.c_str()),1);
+			if(left == "Output")
+				options.Output = right;
+		}
+	}
+
+	return Benchmark::RunBenchmarks(options) ? 0 : 1;
+}
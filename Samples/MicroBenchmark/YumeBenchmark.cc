@@ -0,0 +1,288 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//YumeBenchmark.cpp
+//--------------------------------------------------------------------------------
+#include "Core/YumeHeaders.h"
+#include "YumeBenchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace YumeEngine
+{
+	namespace Benchmark
+	{
+		//Calibration stops growing here even if MinTime has not passed
+		static const unsigned long long MAX_ITERATIONS = 1000000000ULL;
+
+		static YumeVector<Family*>::type& GetFamilies()
+		{
+			static YumeVector<Family*>::type* families = new YumeVector<Family*>::type;
+			return *families;
+		}
+
+#if defined(_MSC_VER)
+		void UseCharPointer(char const volatile*)
+		{
+		}
+#endif
+
+		State::State(unsigned long long maxIterations,long long arg)
+			: maxIterations_(maxIterations),
+			iterations_(0),
+			arg_(arg),
+			running_(false),
+			seconds_(0),
+			itemsProcessed_(0),
+			bytesProcessed_(0)
+		{
+		}
+
+		void State::PauseTiming()
+		{
+			if(!running_)
+				return;
+
+			std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_;
+			seconds_ += elapsed.count();
+			running_ = false;
+		}
+
+		void State::ResumeTiming()
+		{
+			if(running_)
+				return;
+
+			running_ = true;
+			start_ = std::chrono::high_resolution_clock::now();
+		}
+
+		Family::Family(const char* name,BenchmarkFunction function)
+			: name_(name),
+			function_(function)
+		{
+		}
+
+		Family* Family::Arg(long long arg)
+		{
+			args_.push_back(arg);
+			return this;
+		}
+
+		Family* Family::Range(long long start,long long limit,long long multiplier)
+		{
+			for(long long arg = start; arg < limit; arg *= multiplier)
+				args_.push_back(arg);
+			args_.push_back(limit);
+			return this;
+		}
+
+		Family* RegisterBenchmark(const char* name,BenchmarkFunction function)
+		{
+			Family* family = new Family(name,function);
+			GetFamilies().push_back(family);
+			return family;
+		}
+
+		RunOptions::RunOptions()
+			: MinTime(0.1),
+			Repetitions(3)
+		{
+		}
+
+		struct RunResult
+		{
+			YumeString Name;
+			YumeString Label;
+			unsigned long long Iterations;
+			double MedianNs;
+			double MinNs;
+			double ItemsPerSecond;
+			double BytesPerSecond;
+		};
+
+		//What one run at a fixed iteration count reported
+		struct Sample
+		{
+			double Seconds;
+			long long Items;
+			long long Bytes;
+			YumeString Label;
+		};
+
+		static void RunOnce(BenchmarkFunction function,long long arg,unsigned long long iterations,Sample& sample)
+		{
+			State state(iterations,arg);
+			function(state);
+
+			sample.Seconds = state.GetSeconds();
+			sample.Items = state.GetItemsProcessed();
+			sample.Bytes = state.GetBytesProcessed();
+			sample.Label = state.GetLabel();
+		}
+
+		static RunResult RunOne(const Family& family,long long arg,const YumeString& name,const RunOptions& options)
+		{
+			Sample sample;
+
+			//Grow the count until one run takes MinTime, the way Google Benchmark does
+			unsigned long long iterations = 1;
+			for(;;)
+			{
+				RunOnce(family.GetFunction(),arg,iterations,sample);
+				if(sample.Seconds >= options.MinTime || iterations >= MAX_ITERATIONS)
+					break;
+
+				double multiplier = sample.Seconds / options.MinTime > 0.1 ? options.MinTime * 1.4 / sample.Seconds : 10.0;
+				unsigned long long next = (unsigned long long)(iterations * std::min(multiplier,100.0));
+				iterations = std::min(std::max(next,iterations + 1),MAX_ITERATIONS);
+			}
+
+			YumeVector<double>::type seconds;
+			seconds.push_back(sample.Seconds);
+			for(unsigned i = 1; i < options.Repetitions; ++i)
+			{
+				RunOnce(family.GetFunction(),arg,iterations,sample);
+				seconds.push_back(sample.Seconds);
+			}
+			std::sort(&seconds[0],&seconds[0] + seconds.size());
+
+			double median = seconds[seconds.size() / 2];
+
+			RunResult result;
+			result.Name = name;
+			result.Label = sample.Label;
+			result.Iterations = iterations;
+			result.MedianNs = median * 1e9 / iterations;
+			result.MinNs = seconds[0] * 1e9 / iterations;
+			result.ItemsPerSecond = median > 0 ? sample.Items / median : 0;
+			result.BytesPerSecond = median > 0 ? sample.Bytes / median : 0;
+			return result;
+		}
+
+		static void AppendJsonNumber(YumeString& dest,double value)
+		{
+			char buffer[64];
+			sprintf(buffer,"%.3f",value);
+			dest.append(buffer);
+		}
+
+		static void WriteJson(const YumeVector<RunResult>::type& results,const RunOptions& options)
+		{
+			YumeString json = "{\n\t\"context\": {\n";
+			json.AppendWithFormat("\t\t\"repetitions\": %u,\n",options.Repetitions);
+#ifdef YUME_SSE
+			json += "\t\t\"yume_sse\": true,\n";
+#else
+			json += "\t\t\"yume_sse\": false,\n";
+#endif
+#ifdef _DEBUG
+			json += "\t\t\"library_build_type\": \"debug\"\n";
+#else
+			json += "\t\t\"library_build_type\": \"release\"\n";
+#endif
+			json += "\t},\n\t\"benchmarks\": [";
+
+			for(unsigned i = 0; i < results.size(); ++i)
+			{
+				const RunResult& result = results[i];
+
+				json += i ? ",\n\t\t{\n" : "\n\t\t{\n";
+				json += "\t\t\t\"name\": \"" + result.Name + "\",\n";
+				json.AppendWithFormat("\t\t\t\"iterations\": %u,\n",(unsigned)std::min(result.Iterations,(unsigned long long)M_MAX_UNSIGNED));
+				json += "\t\t\t\"real_time\": ";
+				AppendJsonNumber(json,result.MedianNs);
+				json += ",\n\t\t\t\"real_time_min\": ";
+				AppendJsonNumber(json,result.MinNs);
+				json += ",\n\t\t\t\"time_unit\": \"ns\"";
+				if(result.ItemsPerSecond > 0)
+				{
+					json += ",\n\t\t\t\"items_per_second\": ";
+					AppendJsonNumber(json,result.ItemsPerSecond);
+				}
+				if(result.BytesPerSecond > 0)
+				{
+					json += ",\n\t\t\t\"bytes_per_second\": ";
+					AppendJsonNumber(json,result.BytesPerSecond);
+				}
+				if(!result.Label.empty())
+					json += ",\n\t\t\t\"label\": \"" + result.Label + "\"";
+				json += "\n\t\t}";
+			}
+
+			json += "\n\t]\n}\n";
+
+			FILE* file = fopen(options.Output.c_str(),"wb");
+			if(!file)
+			{
+				printf("Could not write %s\n",options.Output.c_str());
+				return;
+			}
+			fwrite(json.c_str(),1,json.length(),file);
+			fclose(file);
+		}
+
+		static void PrintRate(double perSecond,const char* unit)
+		{
+			if(perSecond >= 1e9)
+				printf(" %9.2f G%s/s",perSecond / 1e9,unit);
+			else if(perSecond >= 1e6)
+				printf(" %9.2f M%s/s",perSecond / 1e6,unit);
+			else if(perSecond >= 1e3)
+				printf(" %9.2f k%s/s",perSecond / 1e3,unit);
+			else
+				printf(" %9.2f  %s/s",perSecond,unit);
+		}
+
+		unsigned RunBenchmarks(const RunOptions& options)
+		{
+			YumeVector<RunResult>::type results;
+
+			printf("%-48s %14s %14s %12s\n","Benchmark","Time","Min","Iterations");
+			printf("--------------------------------------------------------------------------------------------------\n");
+
+			const YumeVector<Family*>::type& families = GetFamilies();
+			for(unsigned i = 0; i < families.size(); ++i)
+			{
+				const Family& family = *families[i];
+
+				YumeVector<long long>::type args = family.GetArgs();
+				bool hasArgs = !args.empty();
+				if(!hasArgs)
+					args.push_back(0);
+
+				for(unsigned a = 0; a < args.size(); ++a)
+				{
+					YumeString name = family.GetName();
+					if(hasArgs)
+						name.AppendWithFormat("/%d",(int)args[a]);
+
+					if(!options.Filter.empty() && !name.Contains(options.Filter,false))
+						continue;
+
+					RunResult result = RunOne(family,args[a],name,options);
+
+					printf("%-48s %11.1f ns %11.1f ns %12u",name.c_str(),result.MedianNs,result.MinNs,(unsigned)std::min(result.Iterations,(unsigned long long)M_MAX_UNSIGNED));
+					if(result.ItemsPerSecond > 0)
+						PrintRate(result.ItemsPerSecond,"items");
+					if(result.BytesPerSecond > 0)
+						PrintRate(result.BytesPerSecond,"B");
+					if(!result.Label.empty())
+						printf(" %s",result.Label.c_str());
+					printf("\n");
+
+					results.push_back(result);
+				}
+			}
+
+			if(!options.Output.empty())
+				WriteJson(results,options);
+
+			return results.size();
+		}
+	}
+}
@@ -0,0 +1,164 @@
+//--------------------------------------------------------------------------------
+//This is a file from Arkengine
+//
+//
+//Copyright (c) arkenthera.All rights reserved.
+//
+//YumeBenchmark.h
+//--------------------------------------------------------------------------------
+#ifndef __YumeBenchmark_h__
+#define __YumeBenchmark_h__
+//--------------------------------------------------------------------------------
+#include "YumeRequired.h"
+
+#include <chrono>
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+//--------------------------------------------------------------------------------
+//Small in-tree take on Google Benchmark. Same shape so the benchmarks read the same:
+//
+//	static void VectorPushBack(Benchmark::State& state)
+//	{
+//		while(state.KeepRunning())
+//			...
+//		state.SetItemsProcessed(state.GetIterations() * state.GetArg());
+//	}
+//	YUME_BENCHMARK(VectorPushBack)->Arg(64)->Arg(4096);
+//
+//Every benchmark runs until MinTime has passed, the iteration count found there is run Repetitions
+//more times and the median is reported. Results go to the console and to JSON in Google Benchmark's
+//layout, so the usual compare scripts work on them.
+//--------------------------------------------------------------------------------
+namespace YumeEngine
+{
+	namespace Benchmark
+	{
+		class State
+		{
+		public:
+			State(unsigned long long maxIterations,long long arg);
+
+			//Starts the clock on the first call, stops it once the iterations are done
+			bool KeepRunning()
+			{
+				if(iterations_ < maxIterations_)
+				{
+					if(!iterations_)
+						ResumeTiming();
+					++iterations_;
+					return true;
+				}
+
+				if(running_)
+					PauseTiming();
+				return false;
+			}
+
+			//For setup inside the loop that should not be measured
+			void PauseTiming();
+			void ResumeTiming();
+
+			long long GetArg() const { return arg_; }
+			unsigned long long GetIterations() const { return iterations_; }
+			double GetSeconds() const { return seconds_; }
+
+			void SetItemsProcessed(long long items) { itemsProcessed_ = items; }
+			void SetBytesProcessed(long long bytes) { bytesProcessed_ = bytes; }
+			long long GetItemsProcessed() const { return itemsProcessed_; }
+			long long GetBytesProcessed() const { return bytesProcessed_; }
+
+			void SetLabel(const YumeString& label) { label_ = label; }
+			const YumeString& GetLabel() const { return label_; }
+
+		private:
+			unsigned long long maxIterations_;
+			unsigned long long iterations_;
+			long long arg_;
+
+			bool running_;
+			std::chrono::high_resolution_clock::time_point start_;
+			double seconds_;
+
+			long long itemsProcessed_;
+			long long bytesProcessed_;
+			YumeString label_;
+		};
+
+		typedef void (*BenchmarkFunction)(State& state);
+
+		//One function, run once per argument
+		class Family
+		{
+		public:
+			Family(const char* name,BenchmarkFunction function);
+
+			//None means a single run with 0
+			Family* Arg(long long arg);
+			//Powers of multiplier from start to limit, both included
+			Family* Range(long long start,long long limit,long long multiplier = 8);
+
+			const char* GetName() const { return name_; }
+			BenchmarkFunction GetFunction() const { return function_; }
+			const YumeVector<long long>::type& GetArgs() const { return args_; }
+
+		private:
+			const char* name_;
+			BenchmarkFunction function_;
+			YumeVector<long long>::type args_;
+		};
+
+		//The registry is never freed, benchmarks register from static initializers
+		Family* RegisterBenchmark(const char* name,BenchmarkFunction function);
+
+		struct RunOptions
+		{
+			RunOptions();
+
+			//Substring of the full name, Name/Arg
+			YumeString Filter;
+			double MinTime;
+			unsigned Repetitions;
+			//JSON output, empty for console only
+			YumeString Output;
+		};
+
+		//Returns the number of benchmarks run
+		unsigned RunBenchmarks(const RunOptions& options);
+
+#if defined(_MSC_VER)
+		void UseCharPointer(char const volatile* pointer);
+
+		//Forces value to be computed and stored, the compiler can not drop the work leading to it
+		template <class T> inline void DoNotOptimize(const T& value)
+		{
+			UseCharPointer(&reinterpret_cast<char const volatile&>(value));
+			_ReadWriteBarrier();
+		}
+
+		//Every pending write reaches memory
+		inline void ClobberMemory()
+		{
+			_ReadWriteBarrier();
+		}
+#else
+		template <class T> inline void DoNotOptimize(const T& value)
+		{
+			asm volatile("" : : "r,m"(value) : "memory");
+		}
+
+		inline void ClobberMemory()
+		{
+			asm volatile("" : : : "memory");
+		}
+#endif
+	}
+}
+
+#define YUME_BENCHMARK_JOIN_IMPL(a, b) a##b
+#define YUME_BENCHMARK_JOIN(a, b) YUME_BENCHMARK_JOIN_IMPL(a, b)
+#define YUME_BENCHMARK(function) static ::YumeEngine::Benchmark::Family* YUME_BENCHMARK_JOIN(benchmark_, __LINE__) = ::YumeEngine::Benchmark::RegisterBenchmark(#function, function)
+
+//--------------------------------------------------------------------------------
+#endif
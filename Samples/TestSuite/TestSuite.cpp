@@ -20,13 +20,51 @@
 
 #include "Renderer/YumeTexture2D.h"
 
-#include "Renderer/YumeRenderPass.h"
-
 #include "Renderer/YumeResourceManager.h"
 
 #include "Core/YumeVariant.h"
+#include "Core/YumeXmlFile.h"
+
+#include "Renderer/YumeDynamicResolution.h"
+#include "Renderer/YumeRHIStateCache.h"
+#include "Renderer/YumeConstantRingAllocator.h"
+#include "Renderer/YumeRHICommandBuffer.h"
+#include "Core/YumeVectorBuffer.h"
+#include "Core/YumeFrameArena.h"
+#include "Core/YumeDefaults.h"
+#include "Logging/logqueue.h"
+#include "Core/YumeProfiler.h"
+#include "Renderer/YumeGpuTimer.h"
+#include "Renderer/VoxelOctree.h"
+#include "Renderer/LightPropagationGrid.h"
+#include "Renderer/GIVolumeUpdate.h"
+#include "Renderer/ShadowCascades.h"
+#include "Renderer/OcclusionBuffer.h"
+#include "Renderer/ReflectionProbes.h"
+#include "Renderer/LuminanceHistogram.h"
+#include "Renderer/TemporalFilter.h"
+#include "Renderer/PostUber.h"
+#include "Renderer/SoftwareRasterizer.h"
+#include "Renderer/YumeRHI.h"
+#include "Renderer/YumeVertexBuffer.h"
+#include "Renderer/YumeIndexBuffer.h"
+#include "Renderer/YumeRenderTargetPool.h"
+#include "Core/YumeWorkQueue.h"
 
-#include "Renderer/YumeRenderPipeline.h"
+#ifdef YUME_TEST_SOFTWARE_RHI
+#include "YumeSoftwareRenderer.h"
+#include "Renderer/YumeMiscRenderer.h"
+#include "Renderer/YumeLPVCamera.h"
+#include "Renderer/YumeGeometry.h"
+#include "Renderer/RenderPass.h"
+#include "Renderer/StaticModel.h"
+#include "Renderer/Material.h"
+#include "Renderer/Light.h"
+#include "Renderer/Scene.h"
+#endif
+
+#include <thread>
+#include <chrono>
 
 #define BOOST_TEST_MODULE YumeTest
 #include <boost/test/included/unit_test.hpp>
@@ -58,17 +96,26 @@ namespace YumeEngine
 			engineVariants_["turnOffLogging"] = true;
 			engineVariants_["ResourceTree"] = YumeString("Engine/Assets");
 		}
+		//Headless on the Software renderer, for the cases that need an RHI
+		bool InitializeTesting()
+		{
+			Initialize();
+			engineVariants_["testing"] = true;
+			engineVariants_["WindowWidth"] = 64;
+			engineVariants_["WindowHeight"] = 64;
+			return engine_->Initialize(engineVariants_);
+		}
 		void Destroy()
 		{
 			engine_->Run();
 
 			engine_->Exit();
 
-			engine_.reset();
+			engine_.Reset();
 		}
 
 
-		VariantMap engineVariants_;
+		VariantMap::type engineVariants_;
 		SharedPtr<YumeEngine::YumeEngine3D> engine_;
 	};
 	BOOST_FIXTURE_TEST_SUITE(YumeTestSuite,YumePerTestSuiteFixture);
@@ -78,13 +125,2215 @@ namespace YumeEngine
 		Initialize();
 		BOOST_REQUIRE(engine_->Initialize(engineVariants_) == true);
 
-		YumeResourceManager* rm = engine_->GetResourceManager();
+		YumeResourceManager* rm = gYume->pResourceManager;
 
 		assert(rm);
 
-		SharedPtr<YumeRenderTechnique> tech1 = rm->PrepareResource<YumeRenderTechnique>("Shaders/Techniques/Default.xml");
+		YumeXmlFile* deferred = rm->PrepareResource<YumeXmlFile>("RenderCalls/Deferred.xml");
+		BOOST_REQUIRE(deferred && deferred->GetXml().length());
+
+	}
+
+	//Synthetic GPU load, cost follows the pixel count
+	static float RunResolutionTrace(YumeDynamicResolution& controller,float fullResTime,unsigned frames)
+	{
+		for(unsigned i = 0; i < frames; ++i)
+		{
+			float scale = controller.GetScale();
+			float noise = (i % 2) ? 0.05f : -0.05f;
+			controller.Update(0.0f,fullResTime * scale * scale * (1.0f + noise));
+		}
+		return controller.GetScale();
+	}
+
+	BOOST_AUTO_TEST_CASE(DynamicResolutionLightLoad)
+	{
+		YumeDynamicResolution controller;
+		controller.SetEnabled(true);
+		controller.SetTargetFrameTime(16.0f);
+
+		BOOST_REQUIRE(RunResolutionTrace(controller,8.0f,600) == 1.0f);
+		BOOST_REQUIRE(controller.GetNumScaleChanges() == 0);
+	}
+
+	BOOST_AUTO_TEST_CASE(DynamicResolutionHeavyLoad)
+	{
+		YumeDynamicResolution controller;
+		controller.SetEnabled(true);
+		controller.SetTargetFrameTime(16.0f);
+		controller.SetScaleBounds(0.5f,1.0f);
+
+		//Too heavy even at the lower bound
+		BOOST_REQUIRE(Equals(RunResolutionTrace(controller,100.0f,600),0.5f));
+
+		//Load goes away, resolution recovers
+		BOOST_REQUIRE(Equals(RunResolutionTrace(controller,8.0f,600),1.0f));
+	}
+
+	BOOST_AUTO_TEST_CASE(DynamicResolutionConverges)
+	{
+		YumeDynamicResolution controller;
+		controller.SetEnabled(true);
+		controller.SetTargetFrameTime(16.0f);
+
+		float scale = RunResolutionTrace(controller,25.0f,600);
+		unsigned changes = controller.GetNumScaleChanges();
+
+		BOOST_REQUIRE(scale < 1.0f && scale > 0.5f);
+		BOOST_REQUIRE(25.0f * scale * scale <= 16.0f);
+
+		//Settled, no oscillation afterwards
+		RunResolutionTrace(controller,25.0f,600);
+		BOOST_REQUIRE(controller.GetNumScaleChanges() == changes);
+	}
+
+	BOOST_AUTO_TEST_CASE(DynamicResolutionIgnoresSpikes)
+	{
+		YumeDynamicResolution controller;
+		controller.SetEnabled(true);
+		controller.SetTargetFrameTime(16.0f);
+
+		RunResolutionTrace(controller,8.0f,100);
+		controller.Update(0.0f,60.0f);
+		RunResolutionTrace(controller,8.0f,100);
+
+		BOOST_REQUIRE(controller.GetScale() == 1.0f);
+		BOOST_REQUIRE(controller.GetNumScaleChanges() == 0);
+	}
+
+	BOOST_AUTO_TEST_CASE(DynamicResolutionDisabled)
+	{
+		YumeDynamicResolution controller;
+
+		BOOST_REQUIRE(controller.Update(100.0f) == 1.0f);
+		BOOST_REQUIRE(controller.GetRenderSize(1600,900) == IntVector2(1600,900));
+	}
+
+	BOOST_AUTO_TEST_CASE(DynamicResolutionVsyncBound)
+	{
+		//60Hz with vsync, the GPU needs 4ms and the CPU 3ms up to Present
+		SyntheticTimestampSource timestamps(4.0,2);
+		YumeGpuTimer gpuTimer;
+		gpuTimer.SetSource(&timestamps);
+
+		YumeDynamicResolution controller;
+		controller.SetEnabled(true);
+		controller.SetTargetFrameTime(1000.0f / 60.0f);
+
+		//Wall clock frame time, Present and the vsync wait included
+		YumeDynamicResolution wallClock;
+		wallClock.SetEnabled(true);
+		wallClock.SetTargetFrameTime(1000.0f / 60.0f);
+
+		for(unsigned i = 0; i < 600; ++i)
+		{
+			gpuTimer.BeginFrame();
+			gpuTimer.EndFrame();
+
+			controller.Update(3.0f,(float)gpuTimer.GetFrameMs());
+			wallClock.Update(1000.0f / 60.0f);
+		}
+
+		BOOST_REQUIRE(Equals((float)gpuTimer.GetFrameMs(),4.0f));
+		BOOST_REQUIRE(controller.GetScale() == 1.0f);
+		BOOST_REQUIRE(controller.GetNumScaleChanges() == 0);
+
+		//An idle GPU would be pushed all the way down
+		BOOST_REQUIRE(Equals(wallClock.GetScale(),wallClock.GetMinScale()));
+	}
+
+	BOOST_AUTO_TEST_CASE(StateCacheFiltersRedundantBinds)
+	{
+		YumeRHIStateCache cache;
+		int a,b,c;
+		const void* views[4] = { &a,&b,0,0 };
+		unsigned first,numChanged;
+
+		BOOST_REQUIRE(cache.SetShaderResources(PS,0,4,views,first,numChanged));
+		BOOST_REQUIRE(first == 0 && numChanged == 4);
+		BOOST_REQUIRE(!cache.SetShaderResources(PS,0,4,views,first,numChanged));
+
+		//Only the changed slot is forwarded
+		views[2] = &c;
+		BOOST_REQUIRE(cache.SetShaderResources(PS,0,4,views,first,numChanged));
+		BOOST_REQUIRE(first == 2 && numChanged == 1);
+
+		//Stages are tracked separately
+		BOOST_REQUIRE(cache.SetShaderResources(VS,0,4,views,first,numChanged));
+
+		BOOST_REQUIRE(cache.SetShaders(&a,&b,0));
+		BOOST_REQUIRE(!cache.SetShaders(&a,&b,0));
+		BOOST_REQUIRE(cache.SetShaders(&a,&b,&c));
+
+		BOOST_REQUIRE(cache.SetViewport(IntRect(0,0,1600,900)));
+		BOOST_REQUIRE(!cache.SetViewport(IntRect(0,0,1600,900)));
+
+		const RHIStateStats& stats = cache.GetFrameStats();
+		BOOST_REQUIRE(stats.Issued[RHISTATE_SRV] == 3 && stats.Filtered[RHISTATE_SRV] == 1);
+		BOOST_REQUIRE(stats.Issued[RHISTATE_SHADER] == 2 && stats.Filtered[RHISTATE_SHADER] == 1);
+		BOOST_REQUIRE(stats.GetTotalIssued() == 6 && stats.GetTotalFiltered() == 3);
+
+		cache.BeginFrame();
+		BOOST_REQUIRE(cache.GetFrameStats().GetTotalIssued() == 0);
+		BOOST_REQUIRE(cache.GetStats().GetTotalIssued() == 6);
+	}
+
+	BOOST_AUTO_TEST_CASE(StateCacheInvalidate)
+	{
+		YumeRHIStateCache cache;
+		int a;
+		const void* targets[1] = { &a };
+		const void* samplers[2] = { &a,0 };
+		unsigned first,numChanged;
+
+		BOOST_REQUIRE(cache.SetRenderTargets(1,targets,0));
+		BOOST_REQUIRE(!cache.SetRenderTargets(1,targets,0));
+		BOOST_REQUIRE(cache.SetRenderTargets(1,targets,&a));
+
+		//Offset binds report absolute slots
+		BOOST_REQUIRE(cache.SetSamplers(PS,3,2,samplers,first,numChanged));
+		BOOST_REQUIRE(first == 3 && numChanged == 2);
+
+		cache.InvalidateRenderTargets();
+		BOOST_REQUIRE(cache.SetRenderTargets(1,targets,&a));
+		BOOST_REQUIRE(!cache.SetSamplers(PS,3,2,samplers,first,numChanged));
+
+		cache.Invalidate();
+		BOOST_REQUIRE(cache.SetSamplers(PS,3,2,samplers,first,numChanged));
+	}
+
+	BOOST_AUTO_TEST_CASE(ConstantRingAlignment)
+	{
+		YumeConstantRingAllocator ring;
+		ring.SetSize(4096);
+		ring.BeginFrame();
+
+		bool wrapped;
+		BOOST_REQUIRE(ring.Allocate(64,wrapped) == 0);
+		BOOST_REQUIRE(ring.Allocate(64,wrapped) == 256);
+		BOOST_REQUIRE(ring.Allocate(300,wrapped) == 512);
+		BOOST_REQUIRE(ring.Allocate(16,wrapped) == 1024);
+		BOOST_REQUIRE(!wrapped);
+
+		BOOST_REQUIRE(ring.GetStats().FrameAllocations == 4);
+		BOOST_REQUIRE(ring.GetStats().FrameBytes == 1280);
+		BOOST_REQUIRE(ring.Allocate(8192,wrapped) == M_MAX_UNSIGNED);
+		BOOST_REQUIRE(ring.GetStats().Failures == 1);
+	}
+
+	BOOST_AUTO_TEST_CASE(ConstantRingFramesInFlight)
+	{
+		YumeConstantRingAllocator ring;
+		ring.SetSize(4096,256,2);
+
+		bool wrapped;
+
+		//Each frame takes 3/8 of the ring
+		ring.BeginFrame();
+		for(int i = 0; i < 6; ++i)
+			BOOST_REQUIRE(ring.Allocate(256,wrapped) != M_MAX_UNSIGNED);
+
+		ring.BeginFrame();
+		for(int i = 0; i < 6; ++i)
+			BOOST_REQUIRE(ring.Allocate(256,wrapped) != M_MAX_UNSIGNED);
+
+		//Both frames are still in flight, only the last quarter is free
+		BOOST_REQUIRE(ring.Allocate(1024,wrapped) == 3072);
+		BOOST_REQUIRE(ring.Allocate(256,wrapped) == M_MAX_UNSIGNED);
+
+		//The first frame retires, the next allocation wraps into its space
+		ring.BeginFrame();
+		BOOST_REQUIRE(ring.Allocate(512,wrapped) == 0);
+		BOOST_REQUIRE(wrapped);
+		BOOST_REQUIRE(ring.Allocate(1024,wrapped) == 512);
+		BOOST_REQUIRE(ring.Allocate(1024,wrapped) == M_MAX_UNSIGNED);
+		BOOST_REQUIRE(ring.GetStats().Wraps == 1);
+
+		//Retire everything, the whole ring is usable again
+		ring.BeginFrame();
+		ring.BeginFrame();
+		BOOST_REQUIRE(ring.GetUsedBytes() == 0);
+	}
+
+	static void RecordTestPass(YumeRHICommandBuffer& buffer,unsigned base)
+	{
+		YumeShaderVariation* vs = (YumeShaderVariation*)(size_t)(base + 0x10);
+		YumeShaderVariation* ps = (YumeShaderVariation*)(size_t)(base + 0x20);
+		YumeTexture* diffuse = (YumeTexture*)(size_t)(base + 0x30);
+		YumeVertexBuffer* vb = (YumeVertexBuffer*)(size_t)(base + 0x40);
+
+		YumeVector<YumeTexture*>::type textures(2);
+		textures[0] = diffuse;
+		textures[1] = diffuse;
+		float params[4] = { 1.0f,2.0f,3.0f,4.0f };
+
+		buffer.SetViewport(IntRect(0,0,1280,720));
+		buffer.SetShaders(vs,ps);
+		buffer.PSBindSRV(0,2,textures);
+		buffer.SetVertexBuffer(vb);
+		buffer.SetShaderParameter(YumeHash("Params"),params,4);
+		buffer.SetBlendMode(BLEND_REPLACE);
+		buffer.Draw(TRIANGLE_LIST,0,3);
+		buffer.Draw(TRIANGLE_LIST,0,6);
+		buffer.Close();
+	}
+
+	BOOST_AUTO_TEST_CASE(CommandBufferSerializeIsDeterministic)
+	{
+		YumeRHICommandBuffer first;
+		YumeRHICommandBuffer second;
+		RecordTestPass(first,0x1000);
+		RecordTestPass(second,0x8000);
+
+		BOOST_REQUIRE(first.GetNumCommands() == 8);
+		BOOST_REQUIRE(first.GetNumDraws() == 2);
+		BOOST_REQUIRE(first.Validate());
+
+		//Different resource addresses, same recording
+		VectorBuffer a;
+		VectorBuffer b;
+		first.Serialize(a);
+		second.Serialize(b);
+		BOOST_REQUIRE(a.GetSize() == b.GetSize());
+		BOOST_REQUIRE(memcmp(a.GetData(),b.GetData(),a.GetSize()) == 0);
+
+		//Recycling keeps the stream empty until recorded again
+		first.Reset();
+		BOOST_REQUIRE(first.GetNumCommands() == 0);
+		BOOST_REQUIRE(first.GetSize() == 0);
+		BOOST_REQUIRE(!first.IsClosed());
+	}
+
+	BOOST_AUTO_TEST_CASE(CommandBufferValidateRequiresShaders)
+	{
+		YumeRHICommandBuffer buffer;
+		buffer.SetBlendMode(BLEND_REPLACE);
+		buffer.Draw(TRIANGLE_LIST,0,3);
+		buffer.Close();
+
+		BOOST_REQUIRE(!buffer.Validate());
+	}
+
+	BOOST_AUTO_TEST_CASE(LinearAllocatorGrowsAfterOverflow)
+	{
+		YumeLinearAllocator allocator;
+		allocator.SetCapacity(256);
+
+		void* a = allocator.Allocate(3,1);
+		void* b = allocator.Allocate(64,64);
+		BOOST_REQUIRE(((size_t)b & 63) == 0);
+		BOOST_REQUIRE((unsigned char*)b > (unsigned char*)a);
+
+		//Does not fit, spills to the heap
+		void* c = allocator.Allocate(512);
+		BOOST_REQUIRE(c != 0);
+		BOOST_REQUIRE(allocator.GetNumOverflows() == 1);
+		unsigned highWater = allocator.GetHighWater();
+		BOOST_REQUIRE(highWater >= 512 + 64);
+
+		//Reset grows the block past the high water mark so the same frame fits
+		allocator.Reset();
+		BOOST_REQUIRE(allocator.GetUsed() == 0);
+		BOOST_REQUIRE(allocator.GetCapacity() >= highWater);
+
+		allocator.Allocate(3,1);
+		allocator.Allocate(64,64);
+		allocator.Allocate(512);
+		BOOST_REQUIRE(allocator.GetNumOverflows() == 1);
+	}
+
+	BOOST_AUTO_TEST_CASE(FrameArenaDoubleBuffered)
+	{
+		YumeFrameArena arena(1024);
+
+		unsigned* previous = arena.Allocate<unsigned>(4);
+		for(unsigned i = 0; i < 4; ++i)
+			previous[i] = i;
+
+		//Frame N allocations survive into frame N + 1
+		arena.BeginFrame();
+		unsigned* current = arena.Allocate<unsigned>(4);
+		BOOST_REQUIRE(current != previous);
+		BOOST_REQUIRE(previous[3] == 3);
+
+		//And the buffer is recycled the frame after
+		arena.BeginFrame();
+		BOOST_REQUIRE(arena.Allocate<unsigned>(4) == previous);
+
+		YumeFrameVector<int>::type values((FrameArenaSTLAllocator<int>(&arena)));
+		for(int i = 0; i < 100; ++i)
+			values.push_back(i);
+		BOOST_REQUIRE(values[99] == 99);
+		BOOST_REQUIRE(arena.GetUsed() >= 100 * sizeof(int));
+	}
+
+	BOOST_AUTO_TEST_CASE(MemoryTrackerCategories)
+	{
+		YumeMemoryTracker& tracker = YumeMemoryTracker::Get();
+		MemoryCategoryStats before = tracker.GetStats(YUME_MEM_SCENE);
+
+		//Only the addresses matter, nothing is dereferenced
+		char blocks[2];
+		tracker.RecordAlloc(&blocks[0],1000,YUME_MEM_SCENE);
+		tracker.RecordAlloc(&blocks[1],24,YUME_MEM_SCENE);
+
+		MemoryCategoryStats stats = tracker.GetStats(YUME_MEM_SCENE);
+		BOOST_REQUIRE(stats.LiveBytes == before.LiveBytes + 1024);
+		BOOST_REQUIRE(stats.LiveAllocations == before.LiveAllocations + 2);
+		BOOST_REQUIRE(stats.PeakBytes >= before.LiveBytes + 1024);
+
+		tracker.RecordDealloc(&blocks[0]);
+		//Unknown pointers are ignored
+		tracker.RecordDealloc(&stats);
+
+		stats = tracker.GetStats(YUME_MEM_SCENE);
+		BOOST_REQUIRE(stats.LiveBytes == before.LiveBytes + 24);
+		BOOST_REQUIRE(stats.PeakBytes >= before.LiveBytes + 1024);
+
+		tracker.BeginFrame();
+		BOOST_REQUIRE(tracker.GetStats(YUME_MEM_SCENE).FrameAllocations == 0);
+
+		tracker.RecordDealloc(&blocks[1]);
+		BOOST_REQUIRE(tracker.GetStats(YUME_MEM_SCENE).LiveBytes == before.LiveBytes);
+	}
+
+	BOOST_AUTO_TEST_CASE(OpenHashMapMatchesHashMap)
+	{
+		OpenHashMap<unsigned,unsigned> open;
+		HashMap<unsigned,unsigned> chained;
+
+		//Sequential keys and a stride that collides in the low bits
+		for(unsigned i = 0; i < 2000; ++i)
+		{
+			unsigned key = i < 1000 ? i : i * 4096;
+			open[key] = i;
+			chained[key] = i;
+		}
+		BOOST_REQUIRE(open.size() == chained.size());
+
+		for(unsigned i = 0; i < 2000; i += 3)
+		{
+			unsigned key = i < 1000 ? i : i * 4096;
+			BOOST_REQUIRE(open.erase(key) == chained.erase(key));
+		}
+		BOOST_REQUIRE(open.size() == chained.size());
+		BOOST_REQUIRE(!open.erase(3));
+
+		for(HashMap<unsigned,unsigned>::ConstIterator i = chained.begin(); i != chained.end(); ++i)
+		{
+			OpenHashMap<unsigned,unsigned>::ConstIterator found = open.find(i->first);
+			BOOST_REQUIRE(found != open.end());
+			BOOST_REQUIRE(found->second == i->second);
+		}
+
+		unsigned visited = 0;
+		for(OpenHashMap<unsigned,unsigned>::Iterator i = open.begin(); i != open.end(); ++i)
+			++visited;
+		BOOST_REQUIRE(visited == open.size());
+
+		//Erase everything odd while iterating
+		for(OpenHashMap<unsigned,unsigned>::Iterator i = open.begin(); i != open.end();)
+		{
+			if(i->second & 1)
+				i = open.erase(i);
+			else
+				++i;
+		}
+		for(OpenHashMap<unsigned,unsigned>::Iterator i = open.begin(); i != open.end(); ++i)
+			BOOST_REQUIRE(!(i->second & 1));
+
+		OpenHashMap<unsigned,unsigned> copy(open);
+		BOOST_REQUIRE(copy == open);
+		copy.clear();
+		BOOST_REQUIRE(copy.empty());
+		BOOST_REQUIRE(copy != open);
+	}
+
+	BOOST_AUTO_TEST_CASE(SmallStringStaysInline)
+	{
+		YumeSmallString name("DiffuseColor");
+		BOOST_REQUIRE(name.IsInline());
+		BOOST_REQUIRE(name == "DiffuseColor");
+
+		YumeSmallString copy(name);
+		BOOST_REQUIRE(copy.IsInline());
+		BOOST_REQUIRE(copy == name);
+
+		name += "_and_a_suffix_past_the_inline_storage";
+		BOOST_REQUIRE(!name.IsInline());
+		BOOST_REQUIRE(name == "DiffuseColor_and_a_suffix_past_the_inline_storage");
+
+		//Inline on one side swaps by copy
+		YumeString plain("Roughness");
+		copy.Swap(plain);
+		BOOST_REQUIRE(copy.IsInline());
+		BOOST_REQUIRE(copy == "Roughness");
+		BOOST_REQUIRE(plain == "DiffuseColor");
+
+		copy.Clear();
+		BOOST_REQUIRE(copy.IsInline());
+		BOOST_REQUIRE(copy.empty());
+	}
+
+	BOOST_AUTO_TEST_CASE(SmallVectorSpillsAndCompacts)
+	{
+		SmallVector<YumeString,4> names;
+		for(unsigned i = 0; i < 4; ++i)
+			names.push_back(YumeString(i));
+		BOOST_REQUIRE(names.IsInline());
+
+		//The pushed element lives in the buffer being replaced
+		names.push_back(names[0]);
+		BOOST_REQUIRE(!names.IsInline());
+		BOOST_REQUIRE(names.size() == 5);
+		BOOST_REQUIRE(names[4] == "0");
+
+		names.erase(0,2);
+		names.Compact();
+		BOOST_REQUIRE(names.IsInline());
+		BOOST_REQUIRE(names.size() == 3);
+		BOOST_REQUIRE(names[0] == "2" && names[2] == "0");
+
+		SmallStringVector::type flags;
+		ParseFlags("  NOBLEND   CLEAR_DEPTH DEFERRED ",flags);
+		BOOST_REQUIRE(flags.size() == 3);
+		BOOST_REQUIRE(flags[0] == "NOBLEND");
+		BOOST_REQUIRE(flags[1] == "CLEAR_DEPTH");
+		BOOST_REQUIRE(flags[2] == "DEFERRED");
+		BOOST_REQUIRE(flags[2].IsInline());
+	}
+
+	class RefCountTestObject : public RefCounted
+	{
+	public:
+		RefCountTestObject(RefCountMode mode = REFCOUNT_ATOMIC)
+			: RefCounted(mode)
+		{
+		}
+	};
+
+	BOOST_AUTO_TEST_CASE(RefCountedAtomicUnderContention)
+	{
+		SharedPtr<RefCountTestObject> object(new RefCountTestObject);
+		WeakPtr<RefCountTestObject> weak(object);
+
+		std::vector<std::thread> threads;
+		for(unsigned i = 0; i < 4; ++i)
+		{
+			threads.push_back(std::thread([&object,&weak]()
+			{
+				for(unsigned j = 0; j < 100000; ++j)
+				{
+					SharedPtr<RefCountTestObject> copy(object);
+					WeakPtr<RefCountTestObject> weakCopy(weak);
+				}
+			}));
+		}
+		for(unsigned i = 0; i < threads.size(); ++i)
+			threads[i].join();
+
+		BOOST_REQUIRE(object.Refs() == 1);
+		BOOST_REQUIRE(weak.WeakRefs() == 1);
+
+		object.Reset();
+		BOOST_REQUIRE(weak.Expired());
+	}
+
+	BOOST_AUTO_TEST_CASE(WeakPtrLockRacesLastRelease)
+	{
+		//An object no shared pointer owns yet, or one being released, can not be revived
+		RefCountTestObject* unowned = new RefCountTestObject;
+		BOOST_REQUIRE(!unowned->RefCountPtr()->TryAddRef());
+		BOOST_REQUIRE(WeakPtr<RefCountTestObject>(unowned).Lock().Null());
+		delete unowned;
+
+		for(unsigned round = 0; round < 1000; ++round)
+		{
+			SharedPtr<RefCountTestObject> object(new RefCountTestObject);
+			WeakPtr<RefCountTestObject> weak(object);
+			std::atomic<bool> start(false);
+			std::atomic<unsigned> revived(0);
+
+			std::vector<std::thread> threads;
+			for(unsigned i = 0; i < 3; ++i)
+			{
+				threads.push_back(std::thread([&weak,&start,&revived]()
+				{
+					while(!start.load())
+						;
+					for(unsigned j = 0; j < 100; ++j)
+					{
+						//A lock that succeeds must hold a live reference
+						SharedPtr<RefCountTestObject> locked = weak.Lock();
+						if(locked.NotNull() && locked.Refs() <= 0)
+							++revived;
+					}
+				}));
+			}
+
+			start.store(true);
+			object.Reset();
+			for(unsigned i = 0; i < threads.size(); ++i)
+				threads[i].join();
+
+			BOOST_REQUIRE(revived == 0);
+			BOOST_REQUIRE(weak.Expired());
+			BOOST_REQUIRE(weak.Lock().Null());
+		}
+	}
+
+	BOOST_AUTO_TEST_CASE(LogRingWrapsInOrder)
+	{
+		Log::LogRing ring(256);
+		char message[64];
+
+		//Records are larger than a quarter of the ring so the writes keep wrapping
+		for(unsigned i = 0; i < 32; ++i)
+		{
+			unsigned length = (unsigned)sprintf(message,"message %u padded to take some room",i);
+			BOOST_REQUIRE(ring.Push(Log::LogLevel_Info,i,message,length,__FILE__,__LINE__,"test"));
+
+			const Log::LogRecord* record = ring.Peek();
+			BOOST_REQUIRE(record);
+			BOOST_REQUIRE(record->Sequence == i);
+			BOOST_REQUIRE(record->Length == length);
+			BOOST_REQUIRE(!strcmp(reinterpret_cast<const char*>(record + 1),message));
+			ring.Advance();
+			BOOST_REQUIRE(ring.Empty());
+		}
+
+		unsigned pushed = 0;
+		while(ring.Push(Log::LogLevel_Info,pushed,message,16,__FILE__,__LINE__,"test"))
+			++pushed;
+		BOOST_REQUIRE(pushed > 0 && pushed < 8);
+
+		for(unsigned i = 0; i < pushed; ++i)
+		{
+			BOOST_REQUIRE(ring.Peek()->Sequence == i);
+			ring.Advance();
+		}
+		BOOST_REQUIRE(!ring.Peek());
+	}
+
+	static std::vector<unsigned> loggedLevels;
+
+	static void RecordLevel(const Log::LogRecord& record,const char*)
+	{
+		loggedLevels.push_back(record.Level);
+	}
+
+	BOOST_AUTO_TEST_CASE(LogQueueDropsOnlyBelowErrors)
+	{
+		loggedLevels.clear();
+
+		//Not started, the ring is only written out on Flush or when an error needs room
+		Log::LogQueue queue(RecordLevel);
+		std::string message(Log::MAX_LOG_MESSAGE,'x');
+
+		unsigned numInfo = 2 * Log::LOG_RING_SIZE / Log::MAX_LOG_MESSAGE;
+		for(unsigned i = 0; i < numInfo; ++i)
+			queue.Push(Log::LogLevel_Info,message.c_str(),(unsigned)message.length(),__FILE__,__LINE__,"test");
+		BOOST_REQUIRE(queue.GetNumDropped() > 0);
+		BOOST_REQUIRE(loggedLevels.empty());
+
+		queue.Push(Log::LogLevel_Error,message.c_str(),(unsigned)message.length(),__FILE__,__LINE__,"test");
+		BOOST_REQUIRE(queue.Flush());
+
+		//The error made room by writing out the kept infos and the drop report ahead of it
+		BOOST_REQUIRE(loggedLevels.size() == numInfo - queue.GetNumDropped() + 2);
+		BOOST_REQUIRE(loggedLevels[loggedLevels.size() - 2] == Log::LogLevel_Warn);
+		BOOST_REQUIRE(loggedLevels.back() == Log::LogLevel_Error);
+	}
+
+	BOOST_AUTO_TEST_CASE(LogQueueOutlivedByProducer)
+	{
+		loggedLevels.clear();
+		std::atomic<int> step(0);
+
+		Log::LogQueue* first = new Log::LogQueue(RecordLevel);
+		Log::LogQueue second(RecordLevel);
+
+		//The producer still owns its ring of the first queue when that queue goes away,
+		//its next message moves it to the second queue and the old ring is freed then
+		std::thread producer([&]()
+		{
+			first->Push(Log::LogLevel_Info,"first",5,__FILE__,__LINE__,"test");
+			step.store(1);
+			while(step.load() != 2)
+				;
+			second.Push(Log::LogLevel_Warn,"second",6,__FILE__,__LINE__,"test");
+		});
+
+		while(step.load() != 1)
+			;
+		delete first;
+		BOOST_REQUIRE(loggedLevels.size() == 1);
+
+		step.store(2);
+		producer.join();
+
+		BOOST_REQUIRE(second.Flush());
+		BOOST_REQUIRE(loggedLevels.size() == 2);
+		BOOST_REQUIRE(loggedLevels.back() == Log::LogLevel_Warn);
+	}
+
+	BOOST_AUTO_TEST_CASE(ProfilerAggregatesNestedZones)
+	{
+		static const char* outerName = "ProfilerTestOuter";
+		static const char* innerName = "ProfilerTestInner";
+
+		YumeProfiler& profiler = YumeProfiler::Get();
+		profiler.SetStatsInterval(4);
+		profiler.ResetStats();
+		profiler.BeginCapture(4);
+
+		for(unsigned frame = 0; frame < 4; ++frame)
+		{
+			{
+				YumeProfileScope outer(outerName);
+				for(unsigned i = 0; i < 2; ++i)
+				{
+					YumeProfileScope inner(innerName);
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+			profiler.EndFrame();
+		}
+		BOOST_REQUIRE(!profiler.IsCapturing());
+
+		YumeVector<ProfilerZoneStats>::type stats;
+		profiler.GetStats(stats);
+
+		int outer = -1;
+		int inner = -1;
+		for(unsigned i = 0; i < stats.size(); ++i)
+		{
+			if(stats[i].Name == outerName)
+				outer = i;
+			if(stats[i].Name == innerName)
+				inner = i;
+		}
+		BOOST_REQUIRE(outer >= 0 && inner > outer);
+		BOOST_REQUIRE(stats[inner].Depth == stats[outer].Depth + 1);
+		BOOST_REQUIRE(stats[outer].Calls == 1 && stats[inner].Calls == 2);
+		BOOST_REQUIRE(stats[inner].MinMs >= 2.0);
+		BOOST_REQUIRE(stats[inner].MinMs <= stats[inner].AvgMs && stats[inner].AvgMs <= stats[inner].MaxMs);
+		BOOST_REQUIRE(stats[outer].AvgMs >= stats[inner].AvgMs);
+
+		YumeString trace;
+		profiler.GetChromeTrace(trace);
+		unsigned numInner = 0;
+		for(unsigned pos = trace.find(innerName); pos != String::NPOS; pos = trace.find(innerName,pos + 1))
+			++numInner;
+		BOOST_REQUIRE(numInner == 8);
+		BOOST_REQUIRE(trace.find("\"ph\":\"X\"") != String::NPOS);
+	}
+
+	static void RunGpuTimerFrame(YumeGpuTimer& timer)
+	{
+		timer.BeginFrame();
+		{
+			GpuTimerScope gbuffer(timer,"GBuffer");
+		}
+		{
+			GpuTimerScope lighting(timer,"Lighting");
+			GpuTimerScope shadows(timer,"Shadows");
+		}
+		timer.EndFrame();
+	}
+
+	BOOST_AUTO_TEST_CASE(GpuTimerReadsBackLate)
+	{
+		//Every timestamp is half a millisecond apart, results come back two frames late
+		SyntheticTimestampSource source(0.5,2);
+		YumeGpuTimer timer;
+		timer.SetSource(&source);
+		timer.SetStatsInterval(4);
+
+		for(unsigned i = 0; i < 3; ++i)
+			RunGpuTimerFrame(timer);
+		BOOST_REQUIRE(timer.GetNumResolved() == 0);
+
+		for(unsigned i = 0; i < 5; ++i)
+			RunGpuTimerFrame(timer);
+		BOOST_REQUIRE(timer.GetNumResolved() == 5);
+		BOOST_REQUIRE(Equals((float)timer.GetFrameMs(),3.5f));
+
+		YumeVector<GpuScopeStats>::type stats;
+		timer.GetStats(stats);
+		BOOST_REQUIRE(stats.size() == 3);
+		BOOST_REQUIRE(YumeString(stats[0].Name) == "GBuffer" && stats[0].Depth == 0);
+		BOOST_REQUIRE(YumeString(stats[1].Name) == "Lighting" && stats[1].Depth == 0);
+		BOOST_REQUIRE(YumeString(stats[2].Name) == "Shadows" && stats[2].Depth == 1);
+		BOOST_REQUIRE(Equals((float)stats[0].AvgMs,0.5f) && Equals((float)stats[0].MaxMs,0.5f));
+		BOOST_REQUIRE(Equals((float)stats[1].MinMs,1.5f) && Equals((float)stats[1].AvgMs,1.5f));
+		BOOST_REQUIRE(Equals((float)stats[2].AvgMs,0.5f));
+
+		//A disjoint frame is skipped, a frame still in flight when its queries are reused is dropped
+		source.SetDisjoint(true);
+		RunGpuTimerFrame(timer);
+		source.SetDisjoint(false);
+		for(unsigned i = 0; i < 3; ++i)
+			RunGpuTimerFrame(timer);
+		BOOST_REQUIRE(timer.GetNumDisjoint() == 1);
+		BOOST_REQUIRE(timer.GetNumDropped() == 0);
+
+		source.SetLatency(GPU_TIMER_FRAMES + 2);
+		for(unsigned i = 0; i < GPU_TIMER_FRAMES + 2; ++i)
+			RunGpuTimerFrame(timer);
+		BOOST_REQUIRE(timer.GetNumDropped() > 0);
+	}
+
+	//Brute force reference for the octree: dense grid, fragments averaged per voxel, then box filtered with empty at zero
+	static void BuildDenseVoxels(const YumeVector<VoxelFragment>::type& fragments,unsigned levels,YumeVector<YumeVector<Vector4>::type>::type& mips)
+	{
+		unsigned size = 1 << levels;
+
+		mips.clear();
+		mips.push_back(YumeVector<Vector4>::type(size * size * size));
+		YumeVector<unsigned>::type counts(size * size * size);
+		for(unsigned i = 0; i < counts.size(); ++i)
+		{
+			mips[0][i] = Vector4::ZERO;
+			counts[i] = 0;
+		}
+
+		for(unsigned i = 0; i < fragments.size(); ++i)
+		{
+			unsigned index = (fragments[i].Z * size + fragments[i].Y) * size + fragments[i].X;
+			mips[0][index] += fragments[i].Normal;
+			++counts[index];
+		}
+		for(unsigned i = 0; i < counts.size(); ++i)
+		{
+			if(counts[i])
+				mips[0][i] /= (float)counts[i];
+		}
+
+		for(unsigned mip = 1; mip <= levels; ++mip)
+		{
+			unsigned parent = size >> (mip - 1);
+			unsigned child = size >> mip;
+			const YumeVector<Vector4>::type& src = mips[mip - 1];
+
+			YumeVector<Vector4>::type dest(child * child * child);
+			for(unsigned z = 0; z < child; ++z)
+			{
+				for(unsigned y = 0; y < child; ++y)
+				{
+					for(unsigned x = 0; x < child; ++x)
+					{
+						Vector4 sum = Vector4::ZERO;
+						for(unsigned i = 0; i < 8; ++i)
+							sum += src[((z * 2 + (i >> 2)) * parent + y * 2 + ((i >> 1) & 1)) * parent + x * 2 + (i & 1)];
+						dest[(z * child + y) * child + x] = sum * 0.125f;
+					}
+				}
+			}
+			mips.push_back(dest);
+		}
+	}
+
+	BOOST_AUTO_TEST_CASE(VoxelOctreeMatchesDenseMips)
+	{
+		const unsigned levels = 4;
+		const unsigned size = 1 << levels;
+
+		//Clustered in one corner so whole subtrees stay empty, with repeats to exercise the averaging
+		YumeVector<VoxelFragment>::type fragments;
+		unsigned seed = 1;
+		for(unsigned i = 0; i < 600; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			VoxelFragment fragment;
+			fragment.X = (seed >> 8) % 11;
+			fragment.Y = (seed >> 14) % 9;
+			fragment.Z = (seed >> 20) % size;
+			fragment.Normal = Vector4((seed & 255) / 255.0f,((seed >> 4) & 255) / 255.0f,0.25f,0.5f);
+			fragment.Rho = fragment.Normal;
+			fragments.push_back(fragment);
+		}
+
+		VoxelOctree octree;
+		octree.Build(fragments,levels);
+		octree.FilterBricks();
+
+		YumeVector<YumeVector<Vector4>::type>::type dense;
+		BuildDenseVoxels(fragments,levels,dense);
+
+		for(unsigned mip = 0; mip <= levels; ++mip)
+		{
+			unsigned mipSize = size >> mip;
+			for(unsigned z = 0; z < mipSize; ++z)
+			{
+				for(unsigned y = 0; y < mipSize; ++y)
+				{
+					for(unsigned x = 0; x < mipSize; ++x)
+					{
+						Vector4 normal,rho;
+						bool occupied = octree.Lookup(x,y,z,mip,normal,rho);
+
+						const Vector4& expected = dense[mip][(z * mipSize + y) * mipSize + x];
+						BOOST_REQUIRE(occupied == (expected.w_ > 0));
+						BOOST_REQUIRE(normal.Equals(expected));
+						BOOST_REQUIRE(rho.Equals(expected));
+					}
+				}
+			}
+		}
+	}
+
+	BOOST_AUTO_TEST_CASE(VoxelOctreeStaysSparse)
+	{
+		const unsigned levels = 6;
+		const unsigned size = 1 << levels;
+
+		VoxelOctree octree;
+		Vector4 normal,rho;
+		BOOST_REQUIRE(!octree.Lookup(0,0,0,0,normal,rho));
+
+		//A floor, one voxel thick
+		YumeVector<VoxelFragment>::type fragments;
+		for(unsigned z = 0; z < size; ++z)
+		{
+			for(unsigned x = 0; x < size; ++x)
+			{
+				VoxelFragment fragment;
+				fragment.X = x;
+				fragment.Y = 5;
+				fragment.Z = z;
+				fragment.Normal = Vector4(0.5f,1.0f,0.5f,0.5f);
+				fragment.Rho = Vector4::ZERO;
+				fragments.push_back(fragment);
+			}
+		}
+
+		octree.Build(fragments,levels);
+		octree.FilterBricks();
+
+		//Only the nodes on the floor subdivide, four times as many each level instead of eight
+		BOOST_REQUIRE(octree.GetNumNodes(1) == 8);
+		for(unsigned level = 2; level < levels; ++level)
+			BOOST_REQUIRE(octree.GetNumNodes(level) == 4 * octree.GetNumNodes(level - 1));
+		BOOST_REQUIRE(octree.GetMemoryUse() * 8 < octree.GetDenseMemoryUse());
+
+		BOOST_REQUIRE(octree.Lookup(17,5,40,0,normal,rho));
+		BOOST_REQUIRE(normal.Equals(Vector4(0.5f,1.0f,0.5f,0.5f)));
+		BOOST_REQUIRE(!octree.Lookup(17,6,40,0,normal,rho));
+		BOOST_REQUIRE(!octree.Lookup(17,60,40,0,normal,rho));
+	}
+
+	BOOST_AUTO_TEST_CASE(VoxelizeTriangleMatchesRasterizer)
+	{
+		const unsigned size = 8;
+
+		//A quad facing +y across the whole volume, the y axis is dominant so it is rasterized in xz
+		YumeVector<VoxelFragment>::type fragments;
+		Vector3 up(0,1,0);
+		Vector4 rho(1,0.5f,0.25f,1);
+		VoxelizeTriangle(Vector3(0,3.5f,0),Vector3(8,3.5f,0),Vector3(8,3.5f,8),up,up,up,rho,size,fragments);
+		VoxelizeTriangle(Vector3(0,3.5f,0),Vector3(8,3.5f,8),Vector3(0,3.5f,8),up,up,up,rho,size,fragments);
+
+		YumeVector<bool>::type covered(size * size);
+		for(unsigned i = 0; i < covered.size(); ++i)
+			covered[i] = false;
+
+		for(unsigned i = 0; i < fragments.size(); ++i)
+		{
+			const VoxelFragment& fragment = fragments[i];
+			BOOST_REQUIRE(fragment.Y == 3);
+			BOOST_REQUIRE(fragment.Normal.Equals(Vector4(0.5f,1.0f,0.5f,0.5f)));
+			BOOST_REQUIRE(fragment.Rho.Equals(rho));
+			covered[fragment.Z * size + fragment.X] = true;
+		}
+
+		//Samples on the shared diagonal land in both triangles, everything else exactly once
+		BOOST_REQUIRE(fragments.size() == size * size + size);
+		for(unsigned i = 0; i < covered.size(); ++i)
+			BOOST_REQUIRE(covered[i]);
+
+		//Edge on, nothing to rasterize
+		fragments.clear();
+		VoxelizeTriangle(Vector3(0,0,0),Vector3(8,0,0),Vector3(8,0,0),up,up,up,rho,size,fragments);
+		BOOST_REQUIRE(fragments.empty());
+	}
+
+	BOOST_AUTO_TEST_CASE(LightPropagationInjectNormalizes)
+	{
+		LightPropagationGrid grid;
+		grid.Create(4);
+		grid.SetBounds(Vector3::ZERO,Vector3(4,4,4));
+
+		//Two VPLs facing the light straight on, both shifted half a cell up into cell (1,2,1)
+		Vector3 lightPos(1.5f,10,1.5f);
+		LpvVpl vpls[4];
+		vpls[0].Position = Vector3(1.5f,1.9f,1.5f);
+		vpls[0].Normal = Vector3(0,1,0);
+		vpls[0].Flux = Vector3(M_PI,0,0);
+		vpls[1] = vpls[0];
+		vpls[1].Flux = Vector3(0,M_PI,0);
+		//Facing away from the light and an RSM texel without geometry, neither injects
+		vpls[2] = vpls[0];
+		vpls[2].Normal = Vector3(0,-1,0);
+		vpls[3] = vpls[0];
+		vpls[3].Normal = Vector3::ZERO;
+		grid.Inject(vpls,4,lightPos);
+
+		unsigned cell = grid.GetCellIndex(1,2,1);
+		BOOST_REQUIRE(grid.GetInjectCount(cell) == 2);
+		float total = 0;
+		for(unsigned i = 0; i < grid.GetNumCells(); ++i)
+			total += grid.GetInjectCount(i);
+		BOOST_REQUIRE(total == 2);
+
+		grid.Normalize();
+
+		Vector4 lobe = LpvShClampedCosine(Vector3(0,1,0));
+		BOOST_REQUIRE(grid.GetCells(0)[cell].Equals(lobe * 0.5f));
+		BOOST_REQUIRE(grid.GetCells(1)[cell].Equals(lobe * 0.5f));
+		BOOST_REQUIRE(grid.GetCells(2)[cell].Equals(Vector4::ZERO));
+	}
+
+	//LPVPropagatePs written out for one cell
+	static Vector4 PropagateCellLikeShader(const LightPropagationGrid& grid,const Vector4* cells,int x,int y,int z,bool firstIteration)
+	{
+		static const Vector3 offsets[6] ={Vector3(0,0,1),Vector3(1,0,0),Vector3(0,0,-1),Vector3(-1,0,0),Vector3(0,1,0),Vector3(0,-1,0)};
+		int size = (int)grid.GetSize();
+		float famp = grid.GetFluxAmplifier();
+
+		Vector4 result = Vector4::ZERO;
+		for(unsigned neighbor = 0; neighbor < 6; ++neighbor)
+		{
+			int nx = x + (int)offsets[neighbor].x_;
+			int ny = y + (int)offsets[neighbor].y_;
+			int nz = z + (int)offsets[neighbor].z_;
+			if(nx < 0 || ny < 0 || nz < 0 || nx >= size || ny >= size || nz >= size)
+				continue;
+			const Vector4& old = cells[grid.GetCellIndex(nx,ny,nz)];
+
+			for(unsigned face = 0; face < 6; ++face)
+			{
+				Vector3 dir = offsets[face] * 0.5f - offsets[neighbor];
+				float len = dir.Length();
+				dir /= len;
+
+				float solidAngle = 0;
+				if(len > 0.5f)
+					solidAngle = len >= 1.5f ? 22.95668f / (4 * 180.0f) : 24.26083f / (4 * 180.0f);
+
+				Vector4 dirSh = LpvShBasis(dir);
+				float flux = famp * solidAngle * (old.x_ * dirSh.x_ + old.y_ * dirSh.y_ + old.z_ * dirSh.z_ + old.w_ * dirSh.w_);
+				result += LpvShClampedCosine(offsets[face]) * Max(flux,0.0f);
+			}
+		}
+
+		if(firstIteration)
+			result += cells[grid.GetCellIndex(x,y,z)] * famp;
+		return result;
+	}
+
+	static bool NearlyEquals(const Vector4& lhs,const Vector4& rhs)
+	{
+		const float eps = 1e-4f;
+		return Abs(lhs.x_ - rhs.x_) < eps && Abs(lhs.y_ - rhs.y_) < eps && Abs(lhs.z_ - rhs.z_) < eps && Abs(lhs.w_ - rhs.w_) < eps;
+	}
+
+	static void InjectTestLights(LightPropagationGrid& grid)
+	{
+		grid.Create(5);
+		grid.SetBounds(Vector3::ZERO,Vector3(5,5,5));
+		grid.SetFluxAmplifier(4);
+
+		LpvVpl vpls[3];
+		vpls[0].Position = Vector3(2.5f,0.2f,2.5f);
+		vpls[0].Normal = Vector3(0,1,0);
+		vpls[0].Flux = Vector3(1,0.5f,0.25f);
+		vpls[1].Position = Vector3(0.2f,3.5f,1.5f);
+		vpls[1].Normal = Vector3(1,0,0);
+		vpls[1].Flux = Vector3(0.2f,1,0.2f);
+		vpls[2].Position = Vector3(4.5f,4.5f,4.8f);
+		vpls[2].Normal = Vector3(-0.6f,0,-0.8f);
+		vpls[2].Flux = Vector3(0,0,2);
+		grid.Inject(vpls,3,Vector3(2.5f,2.5f,2.5f));
+		grid.Normalize();
+	}
+
+	BOOST_AUTO_TEST_CASE(LightPropagationMatchesShader)
+	{
+		LightPropagationGrid grid;
+		grid.SetNumThreads(1);
+		InjectTestLights(grid);
+
+		//Two iterations by hand, the first adds the cell itself, the second does not
+		YumeVector<YumeVector<Vector4>::type>::type expected(3);
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			YumeVector<Vector4>::type first(grid.GetNumCells());
+			YumeVector<Vector4>::type second(grid.GetNumCells());
+			int size = (int)grid.GetSize();
+			for(int z = 0; z < size; ++z)
+				for(int y = 0; y < size; ++y)
+					for(int x = 0; x < size; ++x)
+						first[grid.GetCellIndex(x,y,z)] = PropagateCellLikeShader(grid,grid.GetCells(c),x,y,z,true);
+			for(int z = 0; z < size; ++z)
+				for(int y = 0; y < size; ++y)
+					for(int x = 0; x < size; ++x)
+						second[grid.GetCellIndex(x,y,z)] = PropagateCellLikeShader(grid,&first[0],x,y,z,false);
+
+			expected[c].resize(grid.GetNumCells());
+			for(unsigned i = 0; i < grid.GetNumCells(); ++i)
+				expected[c][i] = first[i] + second[i];
+		}
+
+		grid.Propagate(2);
+		BOOST_REQUIRE(grid.GetIterations() == 2);
+
+		bool lit = false;
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			for(unsigned i = 0; i < grid.GetNumCells(); ++i)
+			{
+				BOOST_REQUIRE(NearlyEquals(grid.GetAccumulated(c)[i],expected[c][i]));
+				lit |= !expected[c][i].Equals(Vector4::ZERO);
+			}
+		}
+		BOOST_REQUIRE(lit);
+	}
+
+	BOOST_AUTO_TEST_CASE(LightPropagationThreadsAndBakeAgree)
+	{
+		LightPropagationGrid single;
+		single.SetNumThreads(1);
+		InjectTestLights(single);
+		single.Propagate(8);
+
+		//Every slice only reads the previous iteration, so the split can not change a single bit
+		LightPropagationGrid threaded;
+		threaded.SetNumThreads(3);
+		YumeWorkQueue queue;
+		queue.CreateThreads(2);
+		threaded.SetWorkQueue(&queue);
+		InjectTestLights(threaded);
+		threaded.Propagate(8);
+		threaded.SetLight(Vector3(-1,-1,0),YumeColor(1,0.9f,0.8f));
+
+		for(unsigned c = 0; c < 3; ++c)
+			BOOST_REQUIRE(memcmp(single.GetAccumulated(c),threaded.GetAccumulated(c),single.GetNumCells() * sizeof(Vector4)) == 0);
+
+		VectorBuffer buffer;
+		BOOST_REQUIRE(threaded.Save(buffer));
+
+		LightPropagationGrid loaded;
+		buffer.Seek(0);
+		BOOST_REQUIRE(loaded.Load(buffer));
+		BOOST_REQUIRE(loaded.GetSize() == 5);
+		BOOST_REQUIRE(loaded.GetIterations() == 8);
+		BOOST_REQUIRE(loaded.GetFluxAmplifier() == 4);
+		BOOST_REQUIRE(loaded.GetMax() == Vector3(5,5,5));
+		BOOST_REQUIRE(loaded.GetLightDirection() == Vector3(-1,-1,0));
+		BOOST_REQUIRE(loaded.GetLightColor() == YumeColor(1,0.9f,0.8f));
+		for(unsigned c = 0; c < 3; ++c)
+			BOOST_REQUIRE(memcmp(single.GetAccumulated(c),loaded.GetAccumulated(c),single.GetNumCells() * sizeof(Vector4)) == 0);
+
+		//Truncated files do not load
+		VectorBuffer truncated(buffer.GetData(),buffer.GetSize() - 4);
+		BOOST_REQUIRE(!loaded.Load(truncated));
+	}
+
+	BOOST_AUTO_TEST_CASE(GIVolumeUpdateSkipsUnchangedInjects)
+	{
+		GIVolumeUpdate update;
+		Vector3 pos(0,20,0);
+		Vector3 dir(-1,0,0);
+
+		BOOST_REQUIRE(update.CheckInject(pos,dir,YumeColor::WHITE,3));
+		BOOST_REQUIRE(!update.CheckInject(pos,dir,YumeColor::WHITE,3));
+		BOOST_REQUIRE(update.CheckInject(pos,Vector3(-1,-0.1f,0),YumeColor::WHITE,3));
+		BOOST_REQUIRE(update.CheckInject(pos,Vector3(-1,-0.1f,0),YumeColor::RED,3));
+		BOOST_REQUIRE(update.CheckInject(pos,Vector3(-1,-0.1f,0),YumeColor::RED,4));
+		BOOST_REQUIRE(!update.CheckInject(pos,Vector3(-1,-0.1f,0),YumeColor::RED,4));
+
+		update.Invalidate();
+		BOOST_REQUIRE(update.CheckInject(pos,Vector3(-1,-0.1f,0),YumeColor::RED,4));
+
+		//Nothing to propagate until something was injected
+		BOOST_REQUIRE(update.IsConverged());
+		BOOST_REQUIRE(update.GetFrameIterations() == 0);
+	}
+
+	BOOST_AUTO_TEST_CASE(LightPropagationSpreadOverFrames)
+	{
+		LightPropagationGrid whole;
+		whole.SetNumThreads(1);
+		InjectTestLights(whole);
+		whole.Propagate(8);
+
+		//Three iterations a frame, the last frame gets the two that are left
+		LightPropagationGrid spread;
+		spread.SetNumThreads(1);
+		InjectTestLights(spread);
+		spread.Propagate(0);
+
+		GIVolumeUpdate update;
+		update.SetIterationBudget(3);
+		update.BeginPropagation(8);
+
+		unsigned frames = 0;
+		while(!update.IsConverged())
+		{
+			unsigned count = update.GetFrameIterations();
+			BOOST_REQUIRE(update.GetIteration() == spread.GetIterations());
+			BOOST_REQUIRE(count == (frames < 2 ? 3U : 2U));
+			spread.ContinuePropagation(count);
+			update.Advance(count);
+			++frames;
+		}
+		BOOST_REQUIRE(frames == 3);
+		BOOST_REQUIRE(spread.GetIterations() == 8);
+
+		for(unsigned c = 0; c < 3; ++c)
+			BOOST_REQUIRE(memcmp(whole.GetAccumulated(c),spread.GetAccumulated(c),whole.GetNumCells() * sizeof(Vector4)) == 0);
+
+		//With the energy known it stops as soon as an iteration moves little enough
+		LightPropagationGrid converging;
+		converging.SetNumThreads(1);
+		InjectTestLights(converging);
+		converging.Propagate(0);
+
+		update.SetIterationBudget(1);
+		update.SetConvergenceThreshold(0.5f);
+		update.BeginPropagation(64);
+
+		float first = 0;
+		float last = 0;
+		while(!update.IsConverged())
+		{
+			converging.ContinuePropagation(update.GetFrameIterations());
+			last = converging.GetEnergy();
+			if(!first)
+				first = last;
+			update.Advance(1,last);
+		}
+		BOOST_REQUIRE(update.GetIteration() < 64);
+		BOOST_REQUIRE(last <= first * 0.5f);
+		BOOST_REQUIRE(last > 0);
+	}
+
+	BOOST_AUTO_TEST_CASE(ShadowCascadeSplits)
+	{
+		const float n = 1.0f;
+		const float f = 1000.0f;
+
+		for(unsigned i = 0; i <= 4; ++i)
+		{
+			float t = i / 4.0f;
+			BOOST_REQUIRE(Equals(ShadowCascades::GetSplitDistance(i,4,n,f,0),n + (f - n) * t));
+			BOOST_REQUIRE(Abs(ShadowCascades::GetSplitDistance(i,4,n,f,1) - n * powf(f / n,t)) < 1e-3f);
+		}
+
+		//The practical scheme lands in between and the splits keep growing
+		float last = n;
+		for(unsigned i = 1; i <= 4; ++i)
+		{
+			float split = ShadowCascades::GetSplitDistance(i,4,n,f,0.5f);
+			BOOST_REQUIRE(split > last);
+			BOOST_REQUIRE(split <= ShadowCascades::GetSplitDistance(i,4,n,f,0) + 1e-3f);
+			BOOST_REQUIRE(split >= ShadowCascades::GetSplitDistance(i,4,n,f,1) - 1e-3f);
+			last = split;
+		}
+		BOOST_REQUIRE(ShadowCascades::GetSplitDistance(4,4,n,f,0.5f) == f);
+	}
+
+	static Frustum MakeCascadeCamera(const Vector3& position,float yaw)
+	{
+		Frustum frustum;
+		frustum.Define(60.0f,16.0f / 9.0f,1.0f,0.5f,200.0f,Matrix3x4(position,Quaternion(yaw,Vector3::UP),1.0f));
+		return frustum;
+	}
+
+	BOOST_AUTO_TEST_CASE(ShadowCascadeStableFit)
+	{
+		Vector3 lightDir = Vector3(0.3f,-1,0.2f).Normalized();
+		BoundingBox scene(Vector3(-300,-10,-300),Vector3(300,60,300));
+
+		ShadowCascades cascades;
+		cascades.SetResolution(1024);
+		cascades.SetShadowDistance(150);
+		cascades.Update(MakeCascadeCamera(Vector3(3,2,1),0),0.5f,200.0f,lightDir,scene,0);
+
+		//Every receiver in a slice is inside its cascade, depth included
+		Frustum camera = MakeCascadeCamera(Vector3(3,2,1),0);
+		for(unsigned i = 0; i < cascades.GetNumCascades(); ++i)
+		{
+			const ShadowCascade& c = cascades.GetCascade(i);
+			for(unsigned k = 0; k < 8; ++k)
+			{
+				float t = ((k < 4 ? c.Near : c.Far) - 0.5f) / 199.5f;
+				Vector3 corner = camera.vertices_[k % 4].Lerp(camera.vertices_[k % 4 + 4],t);
+				Vector3 clip = c.ViewProj * corner;
+				BOOST_REQUIRE(Abs(clip.x_) <= 1.0f && Abs(clip.y_) <= 1.0f);
+				BOOST_REQUIRE(clip.z_ >= 0 && clip.z_ <= 1.0f);
+			}
+		}
+
+		//Turning around does not change the size of any cascade
+		float radius[MAX_SHADOW_CASCADES];
+		for(unsigned i = 0; i < cascades.GetNumCascades(); ++i)
+			radius[i] = cascades.GetCascade(i).Radius;
+		for(float yaw = 10; yaw < 360; yaw += 37)
+		{
+			cascades.Update(MakeCascadeCamera(Vector3(3,2,1),yaw),0.5f,200.0f,lightDir,scene,0);
+			for(unsigned i = 0; i < cascades.GetNumCascades(); ++i)
+				BOOST_REQUIRE(cascades.GetCascade(i).Radius == radius[i]);
+		}
+
+		//Moving only ever shifts the shadow map by whole texels, a fixed point keeps its sub-texel position
+		Vector3 point(4,0,9);
+		cascades.Update(MakeCascadeCamera(Vector3(3,2,1),0),0.5f,200.0f,lightDir,scene,0);
+		Vector3 before = cascades.GetTextureMatrix(0) * point * (float)cascades.GetResolution();
+		cascades.Update(MakeCascadeCamera(Vector3(3.37f,2,1.61f),0),0.5f,200.0f,lightDir,scene,0);
+		Vector3 after = cascades.GetTextureMatrix(0) * point * (float)cascades.GetResolution();
+		Vector3 moved = after - before;
+		BOOST_REQUIRE(Abs(moved.x_ - floorf(moved.x_ + 0.5f)) < 1e-2f);
+		BOOST_REQUIRE(Abs(moved.y_ - floorf(moved.y_ + 0.5f)) < 1e-2f);
+	}
+
+	BOOST_AUTO_TEST_CASE(ShadowCascadeCastersAndCaching)
+	{
+		Vector3 lightDir(0,-1,0);
+		BoundingBox scene(Vector3(-100,0,-100),Vector3(100,50,100));
+
+		ShadowCascades cascades;
+		cascades.SetNumCascades(3);
+		cascades.SetFirstCachedCascade(1);
+		cascades.SetShadowDistance(100);
+		cascades.Update(MakeCascadeCamera(Vector3(0,2,0),0),0.5f,200.0f,lightDir,scene,7);
+
+		//High above the receivers casts even though the camera never sees it, off to the side does not
+		BOOST_REQUIRE(cascades.IsCaster(0,BoundingBox(Vector3(-1,45,2),Vector3(1,48,4))));
+		BOOST_REQUIRE(!cascades.IsCaster(0,BoundingBox(Vector3(60,0,2),Vector3(62,48,4))));
+		//Below everything the cascade receives on, it can only shadow what is further down
+		BOOST_REQUIRE(!cascades.IsCaster(0,BoundingBox(Vector3(-1,-80,2),Vector3(1,-70,4))));
+
+		for(unsigned i = 0; i < cascades.GetNumCascades(); ++i)
+		{
+			BOOST_REQUIRE(cascades.NeedsRender(i));
+			cascades.MarkRendered(i);
+		}
+		BOOST_REQUIRE(!cascades.NeedsRender(3));
+
+		//A small step keeps the cached fits, the first cascade renders every frame anyway
+		cascades.Update(MakeCascadeCamera(Vector3(0.3f,2,0.2f),0),0.5f,200.0f,lightDir,scene,7);
+		BOOST_REQUIRE(cascades.NeedsRender(0));
+		BOOST_REQUIRE(!cascades.NeedsRender(1));
+		BOOST_REQUIRE(!cascades.NeedsRender(2));
+
+		//Changes in the scene invalidate them
+		cascades.Update(MakeCascadeCamera(Vector3(0.3f,2,0.2f),0),0.5f,200.0f,lightDir,scene,8);
+		BOOST_REQUIRE(cascades.NeedsRender(1));
+		BOOST_REQUIRE(cascades.NeedsRender(2));
+		cascades.MarkRendered(1);
+		cascades.MarkRendered(2);
+
+		//So does walking out of the margin
+		cascades.Update(MakeCascadeCamera(Vector3(40,2,0.2f),0),0.5f,200.0f,lightDir,scene,8);
+		BOOST_REQUIRE(cascades.NeedsRender(1));
+	}
+
+	//Camera at the origin looking down +z with a 90 degree field of view, depth like D3D
+	static Matrix4 MakeOcclusionProjection(float nearClip,float farClip)
+	{
+		float q = farClip / (farClip - nearClip);
+		return Matrix4(
+			1,0,0,0,
+			0,1,0,0,
+			0,0,q,-nearClip * q,
+			0,0,1,0);
+	}
+
+	static void AddOcclusionQuad(OcclusionBuffer& buffer,const Vector3& a,const Vector3& b,const Vector3& c,const Vector3& d)
+	{
+		Vector3 vertices[4] ={a,b,c,d};
+		unsigned indices[6] ={0,1,2,0,2,3};
+		buffer.AddOccluder(vertices,4,indices,6,Matrix3x4::IDENTITY);
+	}
+
+	BOOST_AUTO_TEST_CASE(OcclusionBufferHidesBehindWall)
+	{
+		OcclusionBuffer buffer;
+		buffer.SetSize(64,64);
+		buffer.SetNumThreads(1);
+		buffer.SetView(MakeOcclusionProjection(0.5f,100.0f));
+
+		//Nothing drawn yet hides nothing
+		BOOST_REQUIRE(buffer.IsVisible(BoundingBox(Vector3(-1,-1,20),Vector3(1,1,22))));
+
+		//Covers the middle half of the screen
+		AddOcclusionQuad(buffer,Vector3(-5,-5,10),Vector3(5,-5,10),Vector3(5,5,10),Vector3(-5,5,10));
+		buffer.Rasterize();
+		BOOST_REQUIRE(buffer.GetNumTriangles() == 2);
+		BOOST_REQUIRE(buffer.GetDepth(32,32) < 1.0f);
+		BOOST_REQUIRE(buffer.GetDepth(2,32) == 1.0f);
+
+		BOOST_REQUIRE(!buffer.IsVisible(BoundingBox(Vector3(-1,-1,20),Vector3(1,1,22))));
+		BOOST_REQUIRE(buffer.IsVisible(BoundingBox(Vector3(-1,-1,4),Vector3(1,1,6))));
+		BOOST_REQUIRE(buffer.IsVisible(BoundingBox(Vector3(12,-1,20),Vector3(14,1,22))));
+		//Sticking out past the edge of the wall
+		BOOST_REQUIRE(buffer.IsVisible(BoundingBox(Vector3(-1,-1,20),Vector3(12,1,22))));
+		//The wall does not hide itself
+		BOOST_REQUIRE(buffer.IsVisible(BoundingBox(Vector3(-5,-5,10),Vector3(5,5,10))));
+		//Nor anything the camera is inside of
+		BOOST_REQUIRE(buffer.IsVisible(BoundingBox(Vector3(-1,-1,-1),Vector3(1,1,30))));
+
+		buffer.Clear();
+		BOOST_REQUIRE(buffer.IsVisible(BoundingBox(Vector3(-1,-1,20),Vector3(1,1,22))));
+	}
+
+	BOOST_AUTO_TEST_CASE(OcclusionBufferThreadsAndPyramid)
+	{
+		OcclusionBuffer single;
+		single.SetSize(90,50);
+		BOOST_REQUIRE(single.GetWidth() == 92);
+		single.SetNumThreads(1);
+
+		OcclusionBuffer threaded;
+		threaded.SetSize(90,50);
+		threaded.SetNumThreads(4);
+		YumeWorkQueue queue;
+		queue.CreateThreads(3);
+		threaded.SetWorkQueue(&queue);
+
+		OcclusionBuffer* buffers[2] ={&single,&threaded};
+		for(unsigned b = 0; b < 2; ++b)
+		{
+			OcclusionBuffer& buffer = *buffers[b];
+			buffer.SetView(MakeOcclusionProjection(0.5f,100.0f));
+
+			for(unsigned i = 0; i < 12; ++i)
+			{
+				float angle = i * 30.0f;
+				float depth = 5.0f + i * 3.0f;
+				Vector3 center(Cos(angle) * depth * 0.4f,Sin(angle) * depth * 0.3f,depth);
+				AddOcclusionQuad(buffer,center + Vector3(-2,-1,-1),center + Vector3(2,-1,1),center + Vector3(2,1.5f,1),center + Vector3(-2,1.5f,-1));
+			}
+			//Crosses the near plane, the part in front of the camera still counts
+			AddOcclusionQuad(buffer,Vector3(-1,-1,-3),Vector3(1,-1,-3),Vector3(1,-1,4),Vector3(-1,-1,4));
+
+			buffer.Rasterize();
+		}
+
+		BOOST_REQUIRE(single.GetNumTriangles() == threaded.GetNumTriangles());
+		for(unsigned y = 0; y < single.GetHeight(); ++y)
+		{
+			for(unsigned x = 0; x < single.GetWidth(); ++x)
+				BOOST_REQUIRE(single.GetDepth(x,y) == threaded.GetDepth(x,y));
+		}
+
+		//Every texel is the farthest of the ones below it, down to a single one
+		float farthest = 0;
+		float nearest = 1;
+		for(unsigned y = 0; y < single.GetHeight(); ++y)
+		{
+			for(unsigned x = 0; x < single.GetWidth(); ++x)
+			{
+				farthest = Max(farthest,single.GetDepth(x,y));
+				nearest = Min(nearest,single.GetDepth(x,y));
+			}
+		}
+		BOOST_REQUIRE(nearest < 0.9f);
+
+		for(unsigned level = 1; level < single.GetNumLevels(); ++level)
+		{
+			for(unsigned y = 0; y < single.GetLevelHeight(level); ++y)
+			{
+				for(unsigned x = 0; x < single.GetLevelWidth(level); ++x)
+				{
+					float depth = single.GetDepth(x,y,level);
+					BOOST_REQUIRE(depth >= single.GetDepth(x * 2,y * 2,level - 1));
+					if(x * 2 + 1 < single.GetLevelWidth(level - 1) && y * 2 + 1 < single.GetLevelHeight(level - 1))
+						BOOST_REQUIRE(depth >= single.GetDepth(x * 2 + 1,y * 2 + 1,level - 1));
+				}
+			}
+		}
+
+		unsigned top = single.GetNumLevels() - 1;
+		BOOST_REQUIRE(single.GetLevelWidth(top) == 1 && single.GetLevelHeight(top) == 1);
+		BOOST_REQUIRE(single.GetDepth(0,0,top) == farthest);
+	}
+
+	BOOST_AUTO_TEST_CASE(ReflectionProbeTimeSlicing)
+	{
+		ReflectionProbes probes;
+		unsigned nearProbe = probes.AddProbe(Vector3(0,0,0),10,true);
+		unsigned farProbe = probes.AddProbe(Vector3(50,0,0),10,true);
+		unsigned still = probes.AddProbe(Vector3(0,0,50),10,false);
+		BOOST_REQUIRE(probes.GetNumProbes() == 3);
+
+		//Nothing is filled yet, all of them render whole
+		probes.Update(Vector3::ZERO,0);
+		BOOST_REQUIRE(probes.GetNumFrameFaces() == 3 * MAX_CUBEMAP_FACES);
+		for(unsigned i = 0; i < probes.GetNumFrameFaces(); ++i)
+			probes.MarkRendered(probes.GetFrameFace(i).Probe,probes.GetFrameFace(i).Face);
+		for(unsigned i = 0; i < probes.GetNumProbes(); ++i)
+		{
+			BOOST_REQUIRE(probes.GetProbe(i).NeedsFilter);
+			probes.MarkFiltered(i);
+			BOOST_REQUIRE(probes.GetProbe(i).Valid);
+		}
+
+		//From then on one face a frame, mostly for the close one but the far one still gets its turn
+		unsigned faces[3] ={0,0,0};
+		for(unsigned frame = 0; frame < 120; ++frame)
+		{
+			probes.Update(Vector3::ZERO,0);
+			BOOST_REQUIRE(probes.GetNumFrameFaces() == 1);
+
+			const ReflectionProbeFace& face = probes.GetFrameFace(0);
+			++faces[face.Probe];
+			probes.MarkRendered(face.Probe,face.Face);
+			if(probes.GetProbe(face.Probe).NeedsFilter)
+				probes.MarkFiltered(face.Probe);
+		}
+		BOOST_REQUIRE(faces[nearProbe] > faces[farProbe] * 4);
+		BOOST_REQUIRE(faces[farProbe] > 0);
+		BOOST_REQUIRE(faces[still] == 0);
+
+		//The static one follows changes in the scene, a face at a time as it still has its old image
+		probes.SetFacesPerFrame(2);
+		probes.Update(Vector3(0,0,50),1);
+		BOOST_REQUIRE(probes.GetNumFrameFaces() == 2);
+		BOOST_REQUIRE(probes.GetFrameFace(0).Probe == still);
+		BOOST_REQUIRE(probes.GetFrameFace(1).Probe != still);
+		BOOST_REQUIRE(probes.GetProbe(still).Valid);
+	}
+
+	BOOST_AUTO_TEST_CASE(ReflectionProbeFacesAndLookup)
+	{
+		ReflectionProbes probes;
+		probes.AddProbe(Vector3(0,0,0),100,false);
+		probes.AddProbe(Vector3(20,0,0),5,false);
+
+		//Not filled, not used
+		BOOST_REQUIRE(probes.GetProbeAt(Vector3(1,0,0)) == M_MAX_UNSIGNED);
+
+		probes.Update(Vector3::ZERO,0);
+		for(unsigned i = 0; i < probes.GetNumFrameFaces(); ++i)
+			probes.MarkRendered(probes.GetFrameFace(i).Probe,probes.GetFrameFace(i).Face);
+		probes.MarkFiltered(0);
+		probes.MarkFiltered(1);
+
+		BOOST_REQUIRE(probes.GetProbeAt(Vector3(1,0,0)) == 0);
+		BOOST_REQUIRE(probes.GetProbeAt(Vector3(18,0,0)) == 1);
+		BOOST_REQUIRE(probes.GetProbeAt(Vector3(200,0,0)) == M_MAX_UNSIGNED);
+
+		//Every face sees down its own axis and nowhere else
+		const Vector3 axes[MAX_CUBEMAP_FACES] ={Vector3(1,0,0),Vector3(-1,0,0),Vector3(0,1,0),Vector3(0,-1,0),Vector3(0,0,1),Vector3(0,0,-1)};
+		for(unsigned f = 0; f < MAX_CUBEMAP_FACES; ++f)
+		{
+			Frustum frustum = probes.GetFaceFrustum(1,(CubeMapFace)f,0.1f,100.0f);
+			for(unsigned a = 0; a < MAX_CUBEMAP_FACES; ++a)
+			{
+				Vector3 point = Vector3(20,0,0) + axes[a] * 10.0f;
+				BOOST_REQUIRE((frustum.IsInside(point) != OUTSIDE) == (a == f));
+			}
+			//The faces share edges, a box on the diagonal shows in more than one
+			BOOST_REQUIRE(frustum.IsInsideFast(BoundingBox(Vector3(20,0,0),Vector3(30,10,10))) != OUTSIDE || (f != 0 && f != 2 && f != 4));
+		}
+
+		//Up vectors like the cube map cameras
+		BOOST_REQUIRE((ReflectionProbes::GetFaceRotation(FACE_POSITIVE_Y) * Vector3::UP).Equals(Vector3(0,0,-1)));
+		BOOST_REQUIRE((ReflectionProbes::GetFaceRotation(FACE_POSITIVE_X) * Vector3::FORWARD).Equals(Vector3(1,0,0)));
+	}
+
+	BOOST_AUTO_TEST_CASE(LuminanceHistogramBinsAndPercentiles)
+	{
+		LuminanceHistogram histogram;
+		histogram.SetRange(-8.0f,8.0f);
+		histogram.SetPercentiles(0.1f,0.9f);
+
+		//Quarter of a stop per bin, out of range and black pixels go to the ends
+		BOOST_REQUIRE(histogram.GetBin(1.0f) == LUMINANCE_HISTOGRAM_BINS / 2);
+		BOOST_REQUIRE(histogram.GetBin(2.0f) == LUMINANCE_HISTOGRAM_BINS / 2 + 4);
+		BOOST_REQUIRE(histogram.GetBin(0) == 0);
+		BOOST_REQUIRE(histogram.GetBin(100000.0f) == LUMINANCE_HISTOGRAM_BINS - 1);
+		BOOST_REQUIRE(Equals(histogram.GetBinLogLuminance(LUMINANCE_HISTOGRAM_BINS / 2),0.125f));
+
+		BOOST_REQUIRE(histogram.GetAverageLuminance() == 0);
+		BOOST_REQUIRE(histogram.GetAdaptedLuminance(0.3f,0.016f,1.0f) == 0.3f);
+
+		//A grey frame with a few lamps, the clipped end does not move the average
+		YumeVector<float>::type frame;
+		for(unsigned i = 0; i < 90; ++i)
+			frame.push_back(0.25f);
+		for(unsigned i = 0; i < 10; ++i)
+			frame.push_back(5000.0f);
+		histogram.AddSamples(&frame[0],frame.size());
+
+		BOOST_REQUIRE(Equals(histogram.GetTotal(),100.0f));
+		float average = histogram.GetAverageLuminance();
+		BOOST_REQUIRE(Abs(log2f(average) - histogram.GetBinLogLuminance(histogram.GetBin(0.25f))) < 0.001f);
+
+		//Without clipping the lamps pull it up by almost a stop
+		histogram.SetPercentiles(0,1);
+		BOOST_REQUIRE(histogram.GetAverageLuminance() > average * 1.5f);
+
+		//Counts read back from the histogram target give the same answer as the samples
+		LuminanceHistogram readback;
+		readback.SetRange(-8.0f,8.0f);
+		readback.SetPercentiles(0,1);
+		for(unsigned i = 0; i < LUMINANCE_HISTOGRAM_BINS; ++i)
+			readback.SetCount(i,histogram.GetCount(i));
+		BOOST_REQUIRE(Equals(readback.GetAverageLuminance(),histogram.GetAverageLuminance()));
+	}
+
+	BOOST_AUTO_TEST_CASE(LuminanceHistogramAdaptation)
+	{
+		LuminanceHistogram histogram;
+		float bright = 4.0f;
+		for(unsigned i = 0; i < 64; ++i)
+			histogram.AddSample(bright);
+		float target = histogram.GetAverageLuminance();
+
+		//Eases in the same share of the way each second however the frames are split
+		float adapted = 0.1f;
+		for(unsigned frame = 0; frame < 60; ++frame)
+			adapted = histogram.GetAdaptedLuminance(adapted,1.0f / 60.0f,0.4f);
+
+		float once = LuminanceHistogram::Adapt(0.1f,target,1.0f,0.4f);
+		BOOST_REQUIRE(Abs(adapted - once) < 0.001f);
+		BOOST_REQUIRE(adapted > 0.1f && adapted < target);
+
+		for(unsigned frame = 0; frame < 60 * 30; ++frame)
+			adapted = histogram.GetAdaptedLuminance(adapted,1.0f / 60.0f,0.4f);
+		BOOST_REQUIRE(Abs(adapted - target) < 0.001f);
+
+		//Brighter scene, shorter exposure, with the same floor as calc_exposed_color
+		BOOST_REQUIRE(LuminanceHistogram::GetExposure(target,0.05f) < LuminanceHistogram::GetExposure(0.1f,0.05f));
+		BOOST_REQUIRE(Abs(LuminanceHistogram::GetExposure(0,0.05f) - 50.0f) < 0.001f);
+	}
+
+	BOOST_AUTO_TEST_CASE(TemporalFilterReprojection)
+	{
+		//90 degree projection looking down +z, w is the view depth
+		Matrix4 projection(
+			1,0,0,0,
+			0,1,0,0,
+			0,0,1,-0.1f,
+			0,0,1,0);
+
+		BOOST_REQUIRE(TemporalFilter::Reproject(Vector3(0,0,4),projection).Equals(Vector2(0.5f,0.5f)));
+		BOOST_REQUIRE(TemporalFilter::Reproject(Vector3(2,2,4),projection).Equals(Vector2(0.75f,0.25f)));
+		BOOST_REQUIRE(TemporalFilter::Reproject(Vector3(0,0,-1),projection).x_ < 0);
+
+		//Last frame the camera was one unit to the right, the point was in the middle then
+		Matrix4 view(Matrix3x4(Vector3(1,0,0),Quaternion::IDENTITY,1.0f).Inverse().ToMatrix4());
+		BOOST_REQUIRE(TemporalFilter::Reproject(Vector3(1,0,4),projection * view).Equals(Vector2(0.5f,0.5f)));
+
+		TemporalFilter filter;
+		filter.SetMaxHistory(4);
+		filter.SetDepthTolerance(0.1f);
+
+		//Grows up to the limit, starts over off screen and on a disocclusion
+		BOOST_REQUIRE(filter.GetHistoryLength(Vector2(0.5f,0.5f),10.0f,10.2f,1.0f) == 2.0f);
+		BOOST_REQUIRE(filter.GetHistoryLength(Vector2(0.5f,0.5f),10.0f,10.2f,4.0f) == 4.0f);
+		BOOST_REQUIRE(filter.GetHistoryLength(Vector2(1.2f,0.5f),10.0f,10.0f,3.0f) == 1.0f);
+		BOOST_REQUIRE(filter.GetHistoryLength(Vector2(0.5f,0.5f),10.0f,12.0f,3.0f) == 1.0f);
+		//Cleared history, nothing was stored yet
+		BOOST_REQUIRE(filter.GetHistoryLength(Vector2(0.5f,0.5f),10.0f,0,0) == 1.0f);
+
+		//Every frame weighs the same, four noisy frames average out
+		const float frames[4] ={0,1,0,1};
+		float history = 0;
+		float length = 0;
+		for(unsigned i = 0; i < 4; ++i)
+		{
+			length = filter.GetHistoryLength(Vector2(0.5f,0.5f),10.0f,10.0f,length);
+			history = TemporalFilter::Accumulate(history,frames[i],length);
+		}
+		BOOST_REQUIRE(Equals(history,0.5f));
+	}
+
+	BOOST_AUTO_TEST_CASE(TemporalFilterDynamicResolution)
+	{
+		TemporalFilter filter;
+		filter.SetMaxHistory(4);
+		filter.SetDepthTolerance(0.1f);
+
+		//At half scale last frame only wrote the top left quarter of the history
+		Vector2 uv = TemporalFilter::GetHistoryUv(Vector2(0.8f,0.6f),0.5f);
+		BOOST_REQUIRE(uv.Equals(Vector2(0.4f,0.3f)));
+		BOOST_REQUIRE(filter.GetHistoryLength(uv,10.0f,10.0f,1.0f,0.5f,0.5f) == 2.0f);
+
+		//Past the scaled part is off screen, even though it is inside the target
+		BOOST_REQUIRE(filter.GetHistoryLength(Vector2(0.6f,0.3f),10.0f,10.0f,1.0f,0.5f,0.5f) == 1.0f);
+
+		//The scale changed, the history is dropped
+		BOOST_REQUIRE(filter.GetHistoryLength(uv,10.0f,10.0f,3.0f,0.5f,0.75f) == 1.0f);
+
+		//Unset scale is full resolution
+		BOOST_REQUIRE(TemporalFilter::GetHistoryUv(Vector2(0.8f,0.6f),0).Equals(Vector2(0.8f,0.6f)));
+		BOOST_REQUIRE(filter.GetHistoryLength(Vector2(0.8f,0.6f),10.0f,10.0f,1.0f,0,1.0f) == 2.0f);
+	}
+
+	BOOST_AUTO_TEST_CASE(TemporalFilterUpsampleWeights)
+	{
+		TemporalFilter filter;
+		filter.SetDepthTolerance(0.1f);
+		float weights[4];
+
+		//One surface, plain bilinear
+		const float flat[4] ={10,10,10,10};
+		filter.GetUpsampleWeights(Vector2(0.25f,0.5f),flat,10.0f,weights);
+		BOOST_REQUIRE(Equals(weights[0],0.375f) && Equals(weights[1],0.125f));
+		BOOST_REQUIRE(Equals(weights[2],0.375f) && Equals(weights[3],0.125f));
+
+		//An edge through the middle, the far texels do not bleed in
+		const float edge[4] ={10,10,50,50};
+		filter.GetUpsampleWeights(Vector2(0.5f,0.5f),edge,10.0f,weights);
+		BOOST_REQUIRE(Equals(weights[0],0.5f) && Equals(weights[1],0.5f));
+		BOOST_REQUIRE(weights[2] == 0 && weights[3] == 0);
+
+		//Thin geometry none of the texels saw, the closest in depth takes it
+		const float thin[4] ={100,40,300,400};
+		filter.GetUpsampleWeights(Vector2(0.1f,0.1f),thin,10.0f,weights);
+		BOOST_REQUIRE(weights[0] == 0 && weights[1] == 1.0f && weights[2] == 0 && weights[3] == 0);
+	}
+
+	BOOST_AUTO_TEST_CASE(PostUberCircleOfConfusion)
+	{
+		PostUber uber;
+
+		//The defaults Bloom.xml sets, the near field stays sharp and the far field blurs
+		BOOST_REQUIRE(uber.GetCircleOfConfusion(0.0f) == 0);
+		BOOST_REQUIRE(uber.GetCircleOfConfusion(100.0f) < 0.1f);
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(5000.0f),1.5f));
+
+		uber.SetFocus(100.0f,50.0f);
+		uber.SetCocScale(1.0f);
+
+		//Sharp on the plane, grows the same way in front of and behind it
+		BOOST_REQUIRE(uber.GetCircleOfConfusion(100.0f) == 0);
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(125.0f),0.5f));
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(75.0f),0.5f));
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(150.0f),1.0f));
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(1000.0f),1.0f));
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(0.0f),1.0f));
+
+		//The scale applies after the range saturates
+		uber.SetCocScale(1.5f);
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(125.0f),0.75f));
+		BOOST_REQUIRE(Equals(uber.GetCircleOfConfusion(1000.0f),1.5f));
+
+		//A pyramid of 8 mips stops at DOF_MAX_LEVEL, a scaled coc never reads past it
+		BOOST_REQUIRE(Equals(PostUber::GetDofLevel(0.5f,8),2.5f));
+		BOOST_REQUIRE(Equals(PostUber::GetDofLevel(1.5f,8),5.0f));
+		BOOST_REQUIRE(Equals(PostUber::GetDofLevel(1.0f,3),2.0f));
+
+		YumeColor sharp(1,0,0,1);
+		YumeColor blurred(0,0,1,1);
+		BOOST_REQUIRE(PostUber::ApplyDepthOfField(sharp,blurred,0).Equals(sharp));
+		BOOST_REQUIRE(PostUber::ApplyDepthOfField(sharp,blurred,0.25f).Equals(YumeColor(0.75f,0,0.25f,1)));
+		BOOST_REQUIRE(PostUber::ApplyDepthOfField(sharp,blurred,1.5f).Equals(blurred));
+	}
+
+	BOOST_AUTO_TEST_CASE(PostUberComposition)
+	{
+		PostUber uber;
+		uber.SetBloomIntensity(0.5f);
+		uber.SetVignette(0.5f,1.0f);
+		uber.SetGrading(1.0f,1.0f,YumeColor(1,1,1,1));
+
+		//No vignette in the center, bloom adds on top of the tonemapped color
+		YumeColor center = uber.Compose(YumeColor(0.2f,0.2f,0.2f,1),YumeColor(0.4f,0.2f,0,1),Vector2(0.5f,0.5f));
+		BOOST_REQUIRE(center.Equals(YumeColor(0.4f,0.3f,0.2f,1)));
+
+		//The corners are half a unit from the center, dot * 2 saturates to the full intensity
+		BOOST_REQUIRE(Equals(uber.GetVignette(Vector2(0,0)),0.5f));
+		BOOST_REQUIRE(Equals(uber.GetVignette(Vector2(1,0.5f)),0.75f));
+		YumeColor corner = uber.Compose(YumeColor(0.2f,0.2f,0.2f,1),YumeColor(0.4f,0.2f,0,1),Vector2(1,1));
+		BOOST_REQUIRE(corner.Equals(YumeColor(0.2f,0.15f,0.1f,1)));
+
+		//No saturation leaves the luminance, contrast pivots around the middle gray, tint scales and clamps at 0
+		uber.SetVignette(0,1.0f);
+		uber.SetGrading(0,1.0f,YumeColor(1,1,1,1));
+		BOOST_REQUIRE(uber.Grade(YumeColor(1,0,0,1)).Equals(YumeColor(0.3f,0.3f,0.3f,1)));
+		uber.SetGrading(1.0f,2.0f,YumeColor(1,1,1,1));
+		BOOST_REQUIRE(uber.Grade(YumeColor(0.75f,0.5f,0.25f,1)).Equals(YumeColor(1.0f,0.5f,0,1)));
+		uber.SetGrading(1.0f,2.0f,YumeColor(0.5f,1,1,1));
+		BOOST_REQUIRE(uber.Grade(YumeColor(0.75f,0.5f,0.1f,1)).Equals(YumeColor(0.5f,0.5f,0,1)));
+
+		//Grading runs last, on the bloomed and vignetted color
+		uber.SetVignette(0.5f,1.0f);
+		uber.SetGrading(0,1.0f,YumeColor(1,1,1,1));
+		YumeColor graded = uber.Compose(YumeColor(0.2f,0.2f,0.2f,1),YumeColor(0.4f,0.2f,0,1),Vector2(1,1));
+		float luma = 0.2f * 0.3f + 0.15f * 0.59f + 0.1f * 0.11f;
+		BOOST_REQUIRE(graded.Equals(YumeColor(luma,luma,luma,1)));
+	}
+
+	//Position and color, what the software rasterizer tests draw
+	static void SoftwareColorVS(const SoftwareVertexInput& input,const void* constants,SoftwareVertex& output)
+	{
+		const float* data = (const float*)input.Data;
+		output.Position = Vector4(data[0],data[1],data[2],1.0f);
+		for(unsigned i = 0; i < 4; ++i)
+			output.Varyings[i] = data[3 + i];
+	}
+
+	static bool SoftwareColorPS(const SoftwarePixel& pixel,const void* constants,Vector4* colors)
+	{
+		colors[0] = Vector4(pixel.Varyings[0],pixel.Varyings[1],pixel.Varyings[2],pixel.Varyings[3]);
+		return true;
+	}
+
+	//Samples the surface in constants over the screen, every other column discarded when asked
+	static bool SoftwareCopyPS(const SoftwarePixel& pixel,const void* constants,Vector4* colors)
+	{
+		colors[0] = ((const SoftwareSurface*)constants)->Sample(Vector2(pixel.Varyings[0],pixel.Varyings[1]));
+		return true;
+	}
+
+	static bool SoftwareDiscardPS(const SoftwarePixel& pixel,const void* constants,Vector4* colors)
+	{
+		colors[0] = Vector4::ONE;
+		return (pixel.X & 1) == 0;
+	}
+
+	//Bottom left, top left, top right, bottom right, clockwise on the screen
+	static void SetSoftwareQuad(float* vertices,float left,float bottom,float right,float top,float z,const Vector4& color)
+	{
+		const float corners[4][2] ={{left,bottom},{left,top},{right,top},{right,bottom}};
+		for(unsigned i = 0; i < 4; ++i)
+		{
+			float* v = vertices + i * 7;
+			v[0] = corners[i][0];
+			v[1] = corners[i][1];
+			v[2] = z;
+			v[3] = color.x_;
+			v[4] = color.y_;
+			v[5] = color.z_;
+			v[6] = color.w_;
+		}
+	}
+
+	static void DrawSoftwareScene(SoftwareRasterizer& rasterizer,SoftwareSurface& color,SoftwareSurface& depth)
+	{
+		static const unsigned short indices[6] ={0,1,2,0,2,3};
+		float vertices[4 * 7];
+
+		color.Clear(Vector4(0,0,0,1));
+		depth.ClearDepthStencil(CLEAR_DEPTH | CLEAR_STENCIL,1.0f,0);
+		rasterizer.SetRenderTarget(0,&color);
+		rasterizer.SetDepthStencil(&depth);
+		rasterizer.SetShaders(SoftwareColorVS,SoftwareColorPS,4);
+		rasterizer.SetVertexData(vertices,7 * sizeof(float));
+		rasterizer.SetIndexData(indices,sizeof(unsigned short));
+
+		//Red over the screen, green behind it and blue in front on a quarter each
+		SetSoftwareQuad(vertices,-1,-1,1,1,0.5f,Vector4(1,0,0,1));
+		rasterizer.DrawIndexed(TRIANGLE_LIST,0,6);
+		SetSoftwareQuad(vertices,-1,-1,0,0,0.8f,Vector4(0,1,0,1));
+		rasterizer.DrawIndexed(TRIANGLE_LIST,0,6);
+		SetSoftwareQuad(vertices,0,0,1,1,0.2f,Vector4(0,0,1,1));
+		rasterizer.DrawIndexed(TRIANGLE_LIST,0,6);
+
+		//Marks the top left quarter in stencil only, then blends white where it is marked
+		rasterizer.SetColorWrite(false);
+		rasterizer.SetDepthWrite(false);
+		rasterizer.SetDepthTest(CMP_ALWAYS);
+		rasterizer.SetStencilTest(true,CMP_ALWAYS,OP_REF,OP_KEEP,OP_KEEP,OP_KEEP,1);
+		SetSoftwareQuad(vertices,-1,0,0,1,0.0f,Vector4::ONE);
+		rasterizer.DrawIndexed(TRIANGLE_LIST,0,6);
+
+		rasterizer.SetColorWrite(true);
+		rasterizer.SetBlendMode(BLEND_ALPHA);
+		rasterizer.SetStencilTest(true,CMP_EQUAL,OP_KEEP,OP_KEEP,OP_KEEP,OP_KEEP,1);
+		SetSoftwareQuad(vertices,-1,-1,1,1,0.0f,Vector4(1,1,1,0.5f));
+		rasterizer.DrawIndexed(TRIANGLE_LIST,0,6);
+
+		rasterizer.SetBlendMode(BLEND_REPLACE);
+		rasterizer.SetStencilTest(false);
+		rasterizer.SetDepthTest(CMP_LESSEQUAL);
+		rasterizer.SetDepthWrite(true);
+	}
+
+	BOOST_AUTO_TEST_CASE(SoftwareRasterizerDepthStencilBlend)
+	{
+		SoftwareSurface color;
+		color.SetSize(64,64);
+		color.SetNormalized(true);
+		SoftwareSurface depth;
+		depth.SetSize(64,64,true);
+
+		SoftwareRasterizer rasterizer;
+		DrawSoftwareScene(rasterizer,color,depth);
+
+		//The shared diagonal is drawn once, 5 quads of 2 triangles
+		BOOST_REQUIRE(rasterizer.GetNumTriangles() == 10);
+		BOOST_REQUIRE(rasterizer.GetNumPixels() == 64 * 64 + 3 * 32 * 32);
+
+		BOOST_REQUIRE(color.GetPixel(50,50) == Vector4(1,0,0,1));
+		BOOST_REQUIRE(color.GetPixel(10,50) == Vector4(1,0,0,1));
+		BOOST_REQUIRE(color.GetPixel(50,10) == Vector4(0,0,1,1));
+		BOOST_REQUIRE(color.GetPixel(10,10).Equals(Vector4(1,0.5f,0.5f,0.75f)));
+		BOOST_REQUIRE(Equals(depth.GetDepth(50,10),0.2f) && Equals(depth.GetDepth(10,50),0.5f));
+		BOOST_REQUIRE(depth.GetStencil(10,10) == 1 && depth.GetStencil(50,50) == 0);
+		BOOST_REQUIRE(depth.Load(10,10) == Vector4(depth.GetDepth(10,10),1,0,1));
+
+		//Counter clockwise is the back face, culled by default like the RHI
+		static const unsigned short reversed[3] ={0,2,1};
+		float vertices[4 * 7];
+		SetSoftwareQuad(vertices,-1,-1,1,1,0.0f,Vector4::ONE);
+		rasterizer.SetVertexData(vertices,7 * sizeof(float));
+		rasterizer.SetIndexData(reversed,sizeof(unsigned short));
+		rasterizer.ResetStats();
+		rasterizer.DrawIndexed(TRIANGLE_LIST,0,3);
+		BOOST_REQUIRE(rasterizer.GetNumTriangles() == 0 && rasterizer.GetNumPixels() == 0);
+		rasterizer.SetCullMode(CULL_NONE);
+		rasterizer.DrawIndexed(TRIANGLE_LIST,0,3);
+		BOOST_REQUIRE(rasterizer.GetNumTriangles() == 1 && rasterizer.GetNumPixels() > 0);
+		rasterizer.SetCullMode(CULL_CCW);
+
+		//Threads only split the tiles, the frame comes out the same
+		SoftwareSurface threadedColor;
+		threadedColor.SetSize(64,64);
+		threadedColor.SetNormalized(true);
+		SoftwareSurface threadedDepth;
+		threadedDepth.SetSize(64,64,true);
+		YumeWorkQueue queue;
+		queue.CreateThreads(3);
+		SoftwareRasterizer threaded;
+		threaded.SetNumThreads(4);
+		threaded.SetWorkQueue(&queue);
+		DrawSoftwareScene(threaded,threadedColor,threadedDepth);
+		DrawSoftwareScene(rasterizer,color,depth);
+
+		BOOST_REQUIRE(threaded.GetNumPixels() == 64 * 64 + 3 * 32 * 32);
+		BOOST_REQUIRE(color.Compare(threadedColor,0) == 0);
+		BOOST_REQUIRE(depth.Compare(threadedDepth,0) == 0);
+
+		threadedColor.SetPixel(3,3,Vector4::ZERO);
+		BOOST_REQUIRE(color.Compare(threadedColor,0.01f) == 1);
+	}
+
+	BOOST_AUTO_TEST_CASE(SoftwareRasterizerFullscreenPasses)
+	{
+		SoftwareSurface source;
+		source.SetSize(4,4);
+		for(int y = 0; y < 4; ++y)
+		{
+			for(int x = 0; x < 4; ++x)
+				source.SetPixel(x,y,Vector4((float)x,(float)y,0,1));
+		}
+
+		//Texel centers are exact, between them bilinear, past the edges clamped
+		BOOST_REQUIRE(source.Sample(Vector2(0.375f,0.625f)) == Vector4(1,2,0,1));
+		BOOST_REQUIRE(source.Sample(Vector2(0.5f,0.5f)).Equals(Vector4(1.5f,1.5f,0,1)));
+		BOOST_REQUIRE(source.Sample(Vector2(-1.0f,2.0f)) == Vector4(0,3,0,1));
+
+		SoftwareSurface target;
+		target.SetSize(8,8);
+
+		SoftwareRasterizer rasterizer;
+		rasterizer.SetRenderTarget(0,&target);
+		rasterizer.SetShaders(0,SoftwareCopyPS,0);
+		rasterizer.SetConstants(&source);
+
+		//A quarter of the target, nothing around it is touched
+		rasterizer.SetViewport(IntRect(4,4,8,8));
+		rasterizer.DrawFullscreen();
+		BOOST_REQUIRE(rasterizer.GetNumPixels() == 16);
+		BOOST_REQUIRE(target.GetPixel(4,4) == Vector4(0,0,0,1));
+		BOOST_REQUIRE(target.GetPixel(7,5) == Vector4(3,1,0,1));
+		BOOST_REQUIRE(target.GetPixel(3,3) == Vector4::ZERO);
+
+		//Scissor on top of the viewport and discarded pixels are not counted
+		rasterizer.SetViewport(IntRect::ZERO);
+		rasterizer.SetScissorTest(true,IntRect(0,0,2,2));
+		rasterizer.ResetStats();
+		rasterizer.DrawFullscreen();
+		BOOST_REQUIRE(rasterizer.GetNumPixels() == 4);
+
+		rasterizer.SetScissorTest(false);
+		rasterizer.SetShaders(0,SoftwareDiscardPS,0);
+		rasterizer.SetNumThreads(0);
+		rasterizer.ResetStats();
+		rasterizer.DrawFullscreen();
+		BOOST_REQUIRE(rasterizer.GetNumPixels() == 32);
+		BOOST_REQUIRE(target.GetPixel(0,7) == Vector4::ONE && target.GetPixel(1,7) == Vector4::ZERO);
+
+		//Nothing to draw into
+		rasterizer.SetRenderTarget(0,0);
+		rasterizer.ResetStats();
+		rasterizer.DrawFullscreen();
+		BOOST_REQUIRE(rasterizer.GetNumPixels() == 0);
+
+		BOOST_REQUIRE(target.Compare(source,0) == 64);
+	}
+
+#ifdef YUME_TEST_SOFTWARE_RHI
+	//Position in the first stream and color in the second, geometry split over two buffers
+	static void SoftwareStreamsVS(const SoftwareVertexInput& input,const void* constants,SoftwareVertex& output)
+	{
+		const float* position = (const float*)input.Streams[0];
+		const float* color = (const float*)input.Streams[1];
+		output.Position = Vector4(position[0],position[1],position[2],1.0f);
+		for(unsigned i = 0; i < 4; ++i)
+			output.Varyings[i] = color[i];
+	}
+
+	BOOST_AUTO_TEST_CASE(SoftwareRHIDrawAndReadBack)
+	{
+		BOOST_REQUIRE(InitializeTesting() == true);
+		BOOST_REQUIRE(engine_->GetRendererName() == "Software");
+
+		YumeRHI* rhi = gYume->pRHI;
+		YumeSoftwareRenderer* software = static_cast<YumeSoftwareRenderer*>(rhi);
+		software->RegisterVertexShader("TestStreams","VS",SoftwareStreamsVS,4);
+		software->RegisterPixelShader("TestStreams","PS",SoftwareColorPS);
+
+		SharedPtr<YumeTexture2D> target(rhi->CreateTexture2D());
+		BOOST_REQUIRE(target->SetSize(64,64,SWFMT_RGBA8,TEXTURE_RENDERTARGET));
+
+		//Green over the left half, cleared to red around it
+		static const float positions[4 * 3] ={-1,-1,0.5f,-1,1,0.5f,0,1,0.5f,0,-1,0.5f};
+		static const float colors[4 * 4] ={0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1};
+		static const unsigned short indices[6] ={0,1,2,0,2,3};
+
+		SharedPtr<YumeVertexBuffer> positionBuffer(rhi->CreateVertexBuffer());
+		BOOST_REQUIRE(positionBuffer->SetSize(4,MASK_POSITION) && positionBuffer->SetData(positions));
+		SharedPtr<YumeVertexBuffer> colorBuffer(rhi->CreateVertexBuffer());
+		BOOST_REQUIRE(colorBuffer->SetSize(4,MASK_BLENDWEIGHTS) && colorBuffer->SetData(colors));
+		SharedPtr<YumeIndexBuffer> indexBuffer(rhi->CreateIndexBuffer());
+		BOOST_REQUIRE(indexBuffer->SetSize(6,false) && indexBuffer->SetData(indices));
+
+		YumeVector<YumeVertexBuffer*>::type buffers;
+		buffers.push_back(positionBuffer);
+		buffers.push_back(colorBuffer);
+		YumeVector<unsigned>::type elementMasks;
+		elementMasks.push_back(MASK_POSITION);
+		elementMasks.push_back(MASK_BLENDWEIGHTS);
+
+		rhi->SetRenderTarget(0,target.Get());
+		rhi->SetViewport(IntRect(0,0,64,64));
+		rhi->Clear(CLEAR_COLOR | CLEAR_DEPTH,YumeColor(1,0,0,1));
+		rhi->SetShaders(rhi->GetShader(VS,"TestStreams","","VS"),rhi->GetShader(PS,"TestStreams","","PS"));
+		BOOST_REQUIRE(rhi->SetVertexBuffers(buffers,elementMasks));
+		rhi->SetIndexBuffer(indexBuffer);
+		rhi->Draw(TRIANGLE_LIST,0,6,0,4);
+
+		YumePodVector<unsigned char>::type pixels(64 * 64 * 4);
+		BOOST_REQUIRE(target->GetData(0,&pixels[0]));
+		const unsigned char* left = &pixels[(40 * 64 + 10) * 4];
+		const unsigned char* right = &pixels[(40 * 64 + 50) * 4];
+		BOOST_REQUIRE(left[0] == 0 && left[1] == 255 && left[2] == 0 && left[3] == 255);
+		BOOST_REQUIRE(right[0] == 255 && right[1] == 0 && right[2] == 0 && right[3] == 255);
+
+		//Depth only, the color stays what was drawn
+		rhi->ClearRenderTarget(0,CLEAR_DEPTH,YumeColor(0,0,1,1),0.25f);
+		BOOST_REQUIRE(target->GetData(0,&pixels[0]));
+		BOOST_REQUIRE(left[1] == 255 && left[2] == 0);
+		BOOST_REQUIRE(Equals(software->GetRasterizer().GetDepthStencil()->GetDepth(10,40),0.25f));
+
+		rhi->ClearRenderTarget(0,CLEAR_COLOR,YumeColor(0,0,1,1));
+		BOOST_REQUIRE(target->GetData(0,&pixels[0]));
+		BOOST_REQUIRE(left[1] == 0 && left[2] == 255);
+
+		rhi->ResetRenderTargets();
+		rhi->SetVertexBuffer(0);
+		rhi->SetIndexBuffer(0);
+		target.Reset();
+		positionBuffer.Reset();
+		colorBuffer.Reset();
+		indexBuffer.Reset();
+		Destroy();
+	}
+
+	BOOST_AUTO_TEST_CASE(SoftwareRHIRendersDeferredFrame)
+	{
+		BOOST_REQUIRE(InitializeTesting() == true);
+		BOOST_REQUIRE(engine_->GetRendererName() == "Software");
+
+		YumeRHI* rhi = gYume->pRHI;
+		YumeSoftwareRenderer* software = static_cast<YumeSoftwareRenderer*>(rhi);
+		YumeMiscRenderer* renderer = gYume->pRenderer;
+
+		//The G-buffer fill, the lights and the copy resolve to the callbacks the renderer registers
+		BOOST_REQUIRE(rhi->GetShader(VS,"DeferredSolid","MeshVs","MeshVs") && rhi->GetShader(PS,"DeferredSolid","MeshPs","MeshPs"));
+		BOOST_REQUIRE(rhi->GetShader(VS,"NoShadows/FsTriangle","","fs_triangle_vs"));
+		BOOST_REQUIRE(rhi->GetShader(PS,"NoShadows/DeferredLightPS","DIRECTIONALLIGHT","ps_df_pbr"));
+		BOOST_REQUIRE(rhi->GetShader(VS,"NoShadows/DeferredLightVS","NoShadows/DeferredLightVS","vs_df") && rhi->GetShader(PS,"NoShadows/DeferredLightPS","POINTLIGHT_BRDF","ps_df"));
+		BOOST_REQUIRE(rhi->GetShader(VS,"LPV/fs_triangle","","fs_triangle_vs") && rhi->GetShader(PS,"Copy","Copy","ps_copy"));
+
+		//A red 2x2 quad at the origin facing +z, both windings so the cull mode does not matter.
+		//Position, normal, texcoord and tangent, the layout of the G-buffer shader's input.
+		static const float vertices[4 * 11] ={
+			-1,-1,0,0,0,1,0,1,1,0,0,
+			-1,1,0,0,0,1,0,0,1,0,0,
+			1,1,0,0,0,1,1,0,1,0,0,
+			1,-1,0,0,0,1,1,1,1,0,0
+		};
+		static const unsigned short indices[12] ={0,1,2,0,2,3,0,2,1,0,3,2};
+
+		SharedPtr<YumeVertexBuffer> vb(rhi->CreateVertexBuffer());
+		BOOST_REQUIRE(vb->SetSize(4,MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT) && vb->SetData(vertices));
+		SharedPtr<YumeIndexBuffer> ib(rhi->CreateIndexBuffer());
+		BOOST_REQUIRE(ib->SetSize(12,false) && ib->SetData(indices));
+
+		//Kept for the engine's lifetime like the geometry of loaded models, the scene never frees its nodes
+		YumeGeometry* geometry = new YumeGeometry;
+		geometry->SetVertexBuffer(0,vb);
+		geometry->SetIndexBuffer(ib);
+		geometry->SetDrawRange(TRIANGLE_LIST,0,12);
+
+		SharedPtr<Material> material(new Material);
+		material->SetShaderParameter("DiffuseColor",DirectX::XMFLOAT4(1,0,0,1));
+		material->SetShaderParameter("EmissiveColor",DirectX::XMFLOAT4(0,0,0,0));
+		material->SetShaderParameter("SpecularColor",DirectX::XMFLOAT4(0,0,0,0));
+		material->SetShaderParameter("ShadingMode",0.0f);
+		material->SetShaderParameter("Roughness",0.5f);
+		material->SetShaderParameter("has_diffuse_tex",false);
+
+		SharedPtr<RenderBatch> batch(new RenderBatch);
+		batch->geo_ = geometry;
+		batch->material_ = material;
+
+		StaticModel* quad = new StaticModel("");
+		quad->batches_.push_back(batch);
+		quad->Initialize();
+		renderer->GetScene()->AddNode(quad);
+
+		Light* light = new Light;
+		light->SetType(LT_DIRECTIONAL);
+		light->SetPosition(DirectX::XMVectorSet(0,20,0,0));
+		light->SetDirection(DirectX::XMVectorSet(0,-1,0,0));
+		light->SetRotation(DirectX::XMVectorSet(-1,0,0,0));
+		light->SetColor(YumeColor(1,1,1,1));
+		renderer->GetScene()->AddNode(light);
+
+		renderer->GetCamera()->SetLookAt(DirectX::XMFLOAT3(0,0,5),DirectX::XMFLOAT3(0,0,0),DirectX::XMFLOAT3(0,1,0));
+
+		engine_->Render();
+
+		//The deferred light pass wrote the quad lit from (1,1,1) normalized, the rest was never in the stencil
+		const SoftwareSurface& backbuffer = software->GetBackbuffer();
+		const Vector4& lit = backbuffer.GetPixel(32,32);
+		const Vector4& outside = backbuffer.GetPixel(2,2);
+		BOOST_REQUIRE(Abs(lit.x_ - 0.57735f) < 0.01f && lit.y_ < 0.01f && lit.z_ < 0.01f);
+		BOOST_REQUIRE(outside.x_ < 0.01f && outside.y_ < 0.01f && outside.z_ < 0.01f);
+
+		//The copy pass brings the unlit albedo of the G-buffer to the backbuffer
+		renderer->BlitRenderTarget(renderer->GetDefaultPass()->GetTextureByName("SCENE_COLORS"),0,false);
+		BOOST_REQUIRE(Abs(backbuffer.GetPixel(32,32).x_ - 1.0f) < 0.01f && backbuffer.GetPixel(32,32).y_ < 0.01f);
+		BOOST_REQUIRE(backbuffer.GetPixel(2,2).x_ < 0.01f);
+
+		Destroy();
+	}
+
+	BOOST_AUTO_TEST_CASE(RenderTargetPoolHitsAndReuse)
+	{
+		BOOST_REQUIRE(InitializeTesting() == true);
+		unsigned rgba = gYume->pRHI->GetRGBAFormatNs();
+
+		YumeRenderTargetPool pool;
+		TransientTargetDesc desc(64,64,rgba,TTF_FILTERED);
+
+		//Still in use, the same descriptor needs a second target
+		pool.BeginFrame(1);
+		TexturePtr first = pool.Acquire(desc);
+		TexturePtr second = pool.Acquire(desc);
+		BOOST_REQUIRE(first && second && first != second);
+		BOOST_REQUIRE(pool.GetFrameStats().Misses == 2 && pool.GetFrameStats().Hits == 0);
+		pool.EndFrame();
+
+		//BeginFrame gives everything back, an equal descriptor hits
+		pool.BeginFrame(2);
+		BOOST_REQUIRE(pool.GetStats().NumTargets == 2 && pool.GetStats().NumInUse == 0);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(64,64,rgba,TTF_FILTERED)) == first);
+		BOOST_REQUIRE(pool.GetFrameStats().Hits == 1 && pool.GetFrameStats().Misses == 0);
+
+		//Size, format, flags, samples and persistent key each miss although second is free
+		TexturePtr keyed = pool.Acquire(TransientTargetDesc(64,64,rgba,TTF_FILTERED,1,7));
+		BOOST_REQUIRE(keyed && keyed != second);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(32,64,rgba,TTF_FILTERED)) != second);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(64,64,gYume->pRHI->GetRGBAFloat16FormatNs(),TTF_FILTERED)) != second);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(64,64,rgba)) != second);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(64,64,rgba,TTF_FILTERED,4)) != second);
+		BOOST_REQUIRE(pool.GetFrameStats().Misses == 5);
+		//Depth stencil targets drop filtering, so these are the same descriptor
+		BOOST_REQUIRE(TransientTargetDesc(64,64,rgba,TTF_DEPTHSTENCIL | TTF_FILTERED) == TransientTargetDesc(64,64,rgba,TTF_DEPTHSTENCIL));
+
+		//Released in the middle of the frame, the next pass aliases it
+		unsigned numTargets = pool.GetStats().NumTargets;
+		pool.Release(keyed);
+		BOOST_REQUIRE(pool.GetStats().NumInUse == numTargets - 2);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(64,64,rgba,TTF_FILTERED,1,7)) == keyed);
+		BOOST_REQUIRE(pool.Acquire(desc) == second);
+		BOOST_REQUIRE(pool.GetStats().NumTargets == numTargets && pool.GetStats().NumInUse == numTargets);
+		BOOST_REQUIRE(pool.GetStats().Requests == 10 && pool.GetStats().Hits == 3 && pool.GetStats().Misses == 7);
+		pool.EndFrame();
+
+		pool.Clear();
+		Destroy();
+	}
+
+	BOOST_AUTO_TEST_CASE(RenderTargetPoolEvictionAndTrim)
+	{
+		BOOST_REQUIRE(InitializeTesting() == true);
+		unsigned rgba = gYume->pRHI->GetRGBAFormatNs();
+
+		YumeRenderTargetPool pool;
+		BOOST_REQUIRE(pool.GetMaxUnusedFrames() == 120);
+
+		pool.BeginFrame(1);
+		pool.Acquire(TransientTargetDesc(64,64,rgba));
+		pool.EndFrame();
+		unsigned long long targetBytes = pool.GetStats().AllocatedBytes;
+		BOOST_REQUIRE(targetBytes > 0);
+
+		//Kept while idle for 120 frames, dropped on the one after
+		for(unsigned frame = 2; frame <= 121; ++frame)
+		{
+			pool.BeginFrame(frame);
+			pool.EndFrame();
+		}
+		BOOST_REQUIRE(pool.GetStats().NumTargets == 1 && pool.GetStats().Evictions == 0);
+		pool.BeginFrame(122);
+		pool.EndFrame();
+		BOOST_REQUIRE(pool.GetStats().NumTargets == 0 && pool.GetStats().Evictions == 1);
+		BOOST_REQUIRE(pool.GetStats().AllocatedBytes == 0 && pool.GetStats().PeakBytes == targetBytes);
+
+		//Keys 0, 1 and 2 last used in frames 200, 201 and 202
+		pool.SetMaxUnusedFrames(1000);
+		TexturePtr keyed[3];
+		for(unsigned i = 0; i < 3; ++i)
+		{
+			pool.BeginFrame(200 + i);
+			keyed[i] = pool.Acquire(TransientTargetDesc(64,64,rgba,0,1,i));
+			pool.EndFrame();
+		}
+
+		//Over budget by one target: the oldest is in use again, so the next oldest free one goes
+		pool.BeginFrame(203);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(64,64,rgba,0,1,0)) == keyed[0]);
+		pool.SetMemoryBudget(targetBytes * 2);
+		pool.EndFrame();
+		BOOST_REQUIRE(pool.GetStats().NumTargets == 2 && pool.GetStats().AllocatedBytes == targetBytes * 2);
+
+		pool.BeginFrame(204);
+		BOOST_REQUIRE(pool.Acquire(TransientTargetDesc(64,64,rgba,0,1,2)) == keyed[2]);
+		BOOST_REQUIRE(pool.GetFrameStats().Hits == 1);
+		pool.Acquire(TransientTargetDesc(64,64,rgba,0,1,1));
+		BOOST_REQUIRE(pool.GetFrameStats().Misses == 1);
+
+		//Nothing in use is ever trimmed, whatever the budget
+		pool.Trim(0);
+		BOOST_REQUIRE(pool.GetStats().NumTargets == 2 && pool.GetStats().NumInUse == 2);
+		pool.EndFrame();
 
+		pool.Clear();
+		Destroy();
 	}
+#endif
 
 //	BOOST_AUTO_TEST_CASE(InitializeEngine)
 //	{
@@ -104,7 +2353,7 @@ namespace YumeEngine
 //		BOOST_REQUIRE(engine_->GetRendererName() == "libYumeNull");
 //#endif
 //
-//		YumeResourceManager* rm = engine_->GetResourceManager();
+//		YumeResourceManager* rm = gYume->pResourceManager;
 //
 //		SharedPtr<YumeImage> appIcon = rm->PrepareResource<YumeImage>("Textures/appIcon.png");
 //